@@ -0,0 +1,174 @@
+/**
+ * @file ContactGraph.h
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * The ContactGraph class is an immutable, preprocessed form of a contact plan, built once when the plan is loaded
+ * and then shared by every route computation until the next plan.
+ * Nodes get dense indices (in node id order), and the contacts leaving each node are stored contiguously
+ * (CSR adjacency arrays), sorted by start time.  The contacts arriving at each node are indexed the same way.
+ * The ContactGraphSearch class holds the per-query working area of an earliest arrival search over a ContactGraph.
+ * It is reused from one search to the next, so a search neither allocates (once sized for the graph) nor copies the plan,
+ * unlike dijkstra and cmr_dijkstra which rebuild their graph and clear the working areas of a copy of the plan on every call.
+ * After a one_to_all search, repair updates its search tree when time advances or contacts are suppressed or unsuppressed
+ * (e.g. on contact start/end or link up/down events), recomputing only the nodes whose routes are affected
+ * (a dynamic shortest path repair: the affected subtrees are reset, then searched again from their unaffected in-neighbors).
+ * Volume already booked on a contact (bundles sent or queued during it) delays the first transmission of new traffic
+ * on that contact, so the searches prefer idle contacts to oversubscribed ones, and leave out fully booked contacts.
+ */
+
+#ifndef CGR_CONTACT_GRAPH_H
+#define CGR_CONTACT_GRAPH_H 1
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include "libcgr.h"
+#include "cgr_lib_export.h"
+
+namespace cgr {
+
+class ContactGraph {
+public:
+    typedef uint32_t node_index_t;
+    typedef uint32_t contact_index_t;
+    static constexpr node_index_t INVALID_NODE_INDEX = UINT32_MAX;
+
+    struct CompiledContact {
+        time_t start;
+        time_t end;
+        time_t owlt;
+        uint64_t rate; //as in the contact plan (bits per second when loaded by cp_load)
+        node_index_t from_index;
+        node_index_t to_index;
+        contact_index_t plan_index; //index of the contact in the contact plan the graph was built from
+    };
+
+    /// An empty graph (no contact plan loaded)
+    CGR_LIB_EXPORT ContactGraph();
+    /**
+     * Build the graph of a contact plan.  Contacts from a node to itself, and contacts without any available volume, are left out.
+     * @param contact_plan The contact plan, which must be kept (unchanged) for as long as plan indices are looked up in it.
+     */
+    CGR_LIB_EXPORT explicit ContactGraph(const std::vector<Contact>& contact_plan);
+
+    /// @return The dense index of the node, or INVALID_NODE_INDEX if the node is not in the graph.
+    CGR_LIB_EXPORT node_index_t get_node_index(const nodeId_t node_id) const noexcept;
+    CGR_LIB_EXPORT nodeId_t get_node_id(const node_index_t node_index) const noexcept;
+    CGR_LIB_EXPORT std::size_t get_num_nodes() const noexcept;
+    CGR_LIB_EXPORT std::size_t get_num_contacts() const noexcept;
+
+    /// The contacts leaving a node are [contacts_begin(node_index), contacts_end(node_index)), sorted by start time.
+    CGR_LIB_EXPORT contact_index_t contacts_begin(const node_index_t node_index) const noexcept;
+    CGR_LIB_EXPORT contact_index_t contacts_end(const node_index_t node_index) const noexcept;
+    CGR_LIB_EXPORT const CompiledContact& get_contact(const contact_index_t contact_index) const noexcept;
+    /// The contacts arriving at a node are get_incoming_contact(i) for i in [incoming_begin(node_index), incoming_end(node_index)).
+    CGR_LIB_EXPORT contact_index_t incoming_begin(const node_index_t node_index) const noexcept;
+    CGR_LIB_EXPORT contact_index_t incoming_end(const node_index_t node_index) const noexcept;
+    CGR_LIB_EXPORT contact_index_t get_incoming_contact(const contact_index_t i) const noexcept;
+
+private:
+    std::vector<nodeId_t> m_nodeIds; //dense index to node id
+    std::unordered_map<nodeId_t, node_index_t> m_nodeIdToIndexMap;
+    std::vector<contact_index_t> m_adjacencyOffsets; //num nodes + 1
+    std::vector<CompiledContact> m_contacts;
+    std::vector<contact_index_t> m_incomingOffsets; //num nodes + 1
+    std::vector<contact_index_t> m_incomingContacts; //indices in m_contacts
+};
+
+class ContactGraphSearch {
+public:
+    CGR_LIB_EXPORT ContactGraphSearch();
+
+    /// Exclude a contact from the searches until clear_suppressed_contacts (e.g. a contact whose link is down).
+    CGR_LIB_EXPORT void suppress_contact(const ContactGraph& graph, const ContactGraph::contact_index_t contact_index);
+    CGR_LIB_EXPORT void clear_suppressed_contacts() noexcept;
+    /**
+     * Set the volume already booked on a contact (sent or queued during it), until clear_booked_volumes.
+     * New traffic is transmitted once the booked volume is, from the contact start at the contact rate,
+     * so the contact is left out once fully booked.
+     * @param volume The booked volume, in the units of the contact rate times seconds (bits for cp_load plans).
+     */
+    CGR_LIB_EXPORT void book_volume(const ContactGraph& graph, const ContactGraph::contact_index_t contact_index, const uint64_t volume);
+    CGR_LIB_EXPORT void clear_booked_volumes() noexcept;
+
+    /**
+     * One-to-all earliest arrival search from the source node, starting at start_time.
+     * @return False if the source node is not in the graph (then nothing is reached).
+     */
+    CGR_LIB_EXPORT bool one_to_all(const ContactGraph& graph, const nodeId_t source, const time_t start_time);
+    /**
+     * Earliest arrival search from the source node to the destination node, which stops once the destination is reached.
+     * @return True if the destination was reached.
+     */
+    CGR_LIB_EXPORT bool one_to_one(const ContactGraph& graph, const nodeId_t source, const nodeId_t destination, const time_t start_time);
+    /**
+     * Update the results of the last one_to_all search (same graph and source) to a later start time and to the contacts
+     * suppressed (and volumes booked) now, recomputing only the routes that departed the source before start_time, or that used
+     * a contact suppressed or rebooked since, or that can improve through a contact unsuppressed or rebooked since.
+     * Without such a search to repair, this is a one_to_all search.
+     * @return False if the source node is not in the graph (then nothing is reached).
+     */
+    CGR_LIB_EXPORT bool repair(const ContactGraph& graph, const nodeId_t source, const time_t start_time);
+    /// @return The number of nodes (re)settled by the last search or repair.
+    CGR_LIB_EXPORT std::size_t get_num_nodes_searched() const noexcept;
+
+    /// The results of the last search, valid until the next search (or until the graph is destroyed).
+    CGR_LIB_EXPORT bool reached(const ContactGraph::node_index_t node_index) const noexcept;
+    /// @return True if the node was reached and is not the source node (i.e. it has a next node).
+    CGR_LIB_EXPORT bool has_route(const ContactGraph::node_index_t node_index) const noexcept;
+    CGR_LIB_EXPORT time_t get_arrival_time(const ContactGraph::node_index_t node_index) const noexcept;
+    /// @return The first hop node id of the earliest arrival route to the node (only if reached and not the source).
+    CGR_LIB_EXPORT nodeId_t get_next_node(const ContactGraph::node_index_t node_index) const noexcept;
+    /// @return The last contact (graph contact index) of the earliest arrival route to the node (only if reached and not the source).
+    CGR_LIB_EXPORT ContactGraph::contact_index_t get_predecessor_contact(const ContactGraph::node_index_t node_index) const noexcept;
+    /**
+     * Build the Route to a destination reached by the last search.
+     * @param contact_plan The contact plan the graph was built from.
+     * @return The route, not valid() if the destination was not reached.
+     */
+    CGR_LIB_EXPORT Route get_route(const std::vector<Contact>& contact_plan, const nodeId_t destination) const;
+
+private:
+    CGR_LIB_NO_EXPORT void reset(const ContactGraph& graph, const nodeId_t source);
+    CGR_LIB_NO_EXPORT bool search(const ContactGraph& graph, const nodeId_t source, const ContactGraph::node_index_t destination_index, const time_t start_time);
+    CGR_LIB_NO_EXPORT bool is_suppressed(const ContactGraph::contact_index_t contact_index) const noexcept;
+    CGR_LIB_NO_EXPORT uint64_t get_booked_volume(const ContactGraph::contact_index_t contact_index) const noexcept;
+    CGR_LIB_NO_EXPORT bool is_rebooked(const ContactGraph::contact_index_t contact_index) const noexcept; //since the last search or repair
+    CGR_LIB_NO_EXPORT void save_searched_contact_states();
+    CGR_LIB_NO_EXPORT void relax(const ContactGraph& graph, const ContactGraph::contact_index_t contact_index);
+    CGR_LIB_NO_EXPORT void run(const ContactGraph& graph, const ContactGraph::node_index_t destination_index);
+
+    typedef std::pair<time_t, ContactGraph::node_index_t> arrival_time_plus_node_index_pair_t;
+    const ContactGraph* m_graphPtr;
+    ContactGraph::node_index_t m_sourceIndex;
+    bool m_isOneToAllTree; //the results are a complete one_to_all search tree that repair can update
+    time_t m_startTime;
+    std::size_t m_numNodesSearched;
+    std::vector<time_t> m_arrivalTimes;
+    std::vector<ContactGraph::node_index_t> m_nextHopIndices;
+    std::vector<ContactGraph::contact_index_t> m_predecessorContacts;
+    std::vector<uint8_t> m_visited;
+    std::vector<time_t> m_departureTimes; //from the source, of the route to each node
+    std::vector<uint8_t> m_suppressedContacts;
+    std::vector<ContactGraph::contact_index_t> m_suppressedContactIndices;
+    std::vector<ContactGraph::contact_index_t> m_searchedSuppressedContactIndices; //as suppressed at the last search or repair
+    std::vector<uint64_t> m_bookedVolumes;
+    std::vector<ContactGraph::contact_index_t> m_bookedContactIndices;
+    std::vector<uint8_t> m_bookedContactsListed; //in m_bookedContactIndices
+    std::vector<uint64_t> m_searchedBookedVolumes; //as booked at the last search or repair
+    std::vector<ContactGraph::contact_index_t> m_searchedBookedContactIndices;
+    std::vector<uint8_t> m_repairStates;
+    std::vector<ContactGraph::node_index_t> m_repairStack;
+    std::vector<arrival_time_plus_node_index_pair_t> m_heap; //min heap ordered by arrival time (smaller index, i.e. smaller id, breaks tie)
+};
+
+} // namespace cgr
+
+#endif // CGR_CONTACT_GRAPH_H
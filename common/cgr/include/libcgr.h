@@ -147,6 +147,32 @@ CGR_LIB_EXPORT Route dijkstra(Contact *root_contact, nodeId_t destination, std::
 
 CGR_LIB_EXPORT Route cmr_dijkstra(Contact* root_contact, nodeId_t destination, const std::vector<Contact> & contact_plan);
 
+// First hop of the earliest arrival route to a destination
+struct NextHop {
+    nodeId_t next_node;
+    time_t best_delivery_time;
+};
+typedef std::unordered_map<nodeId_t, NextHop> next_hop_table_t;
+
+/**
+ * One-to-all earliest arrival search: unlike dijkstra and cmr_dijkstra, which stop at one destination,
+ * a single search from the source node (root_contact->to, starting at root_contact->arrival_time)
+ * finds the earliest arrival route to every node reachable from it.
+ * This builds a ContactGraph of the plan on every call (see ContactGraph.h to build it once and reuse it).
+ * @param root_contact The root contact (from and to the source node).
+ * @param contact_plan The contact plan (not copied nor modified).
+ * @return The next hop of each reachable destination node (the source node is not included).
+ */
+CGR_LIB_EXPORT next_hop_table_t dijkstra_one_to_all(const Contact& root_contact, const std::vector<Contact>& contact_plan);
+
+/**
+ * Yen's K shortest (earliest arrival) loopless routes: each route after the first branches off (at a spur node)
+ * from the previous route, with a dijkstra search from the spur node in which the next hops taken from that node
+ * by the routes already found (with the same path up to it) are suppressed (Contact::suppressed_next_hop).
+ * @param currTime The time the routes start.
+ * @param numRoutes The maximum number of routes (K).
+ * @return Up to numRoutes routes, ordered by delivery time (from currTime), then by number of hops.
+ */
 CGR_LIB_EXPORT std::vector<Route> yen(nodeId_t source, nodeId_t destination, int currTime, std::vector<Contact> contactPlan, int numRoutes);
     
 template <typename T>   bool vector_contains(std::vector<T> vec, T& ele);
@@ -0,0 +1,436 @@
+/**
+ * @file ContactGraph.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include "ContactGraph.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace cgr {
+
+static constexpr ContactGraph::contact_index_t INVALID_CONTACT_INDEX = std::numeric_limits<ContactGraph::contact_index_t>::max();
+
+ContactGraph::ContactGraph() : m_adjacencyOffsets(1, 0), m_incomingOffsets(1, 0) {}
+
+ContactGraph::ContactGraph(const std::vector<Contact>& contact_plan) {
+    std::vector<contact_index_t> usablePlanIndices;
+    usablePlanIndices.reserve(contact_plan.size());
+    m_nodeIds.reserve(contact_plan.size() * 2);
+    for (std::size_t i = 0; i < contact_plan.size(); ++i) {
+        const Contact& contact = contact_plan[i];
+        if ((contact.frm == contact.to) || (*std::max_element(contact.mav.begin(), contact.mav.end()) <= 0)) {
+            continue;
+        }
+        usablePlanIndices.push_back(static_cast<contact_index_t>(i));
+        m_nodeIds.push_back(contact.frm);
+        m_nodeIds.push_back(contact.to);
+    }
+
+    //dense node indices in node id order, so that a smaller index breaks arrival time ties like a smaller id does
+    std::sort(m_nodeIds.begin(), m_nodeIds.end());
+    m_nodeIds.erase(std::unique(m_nodeIds.begin(), m_nodeIds.end()), m_nodeIds.end());
+    m_nodeIds.shrink_to_fit();
+    m_nodeIdToIndexMap.reserve(m_nodeIds.size());
+    for (std::size_t i = 0; i < m_nodeIds.size(); ++i) {
+        m_nodeIdToIndexMap.emplace(m_nodeIds[i], static_cast<node_index_t>(i));
+    }
+
+    //CSR adjacency: count the contacts leaving each node, then place them (sorted by start time)
+    m_adjacencyOffsets.assign(m_nodeIds.size() + 1, 0);
+    std::vector<node_index_t> fromIndices(usablePlanIndices.size());
+    for (std::size_t i = 0; i < usablePlanIndices.size(); ++i) {
+        fromIndices[i] = m_nodeIdToIndexMap[contact_plan[usablePlanIndices[i]].frm];
+        ++m_adjacencyOffsets[fromIndices[i] + 1];
+    }
+    for (std::size_t i = 1; i < m_adjacencyOffsets.size(); ++i) {
+        m_adjacencyOffsets[i] += m_adjacencyOffsets[i - 1];
+    }
+    std::vector<contact_index_t> nextPosition(m_adjacencyOffsets.begin(), m_adjacencyOffsets.end() - 1);
+    m_contacts.resize(usablePlanIndices.size());
+    for (std::size_t i = 0; i < usablePlanIndices.size(); ++i) {
+        const Contact& contact = contact_plan[usablePlanIndices[i]];
+        CompiledContact& compiledContact = m_contacts[nextPosition[fromIndices[i]]++];
+        compiledContact.start = contact.start;
+        compiledContact.end = contact.end;
+        compiledContact.owlt = contact.owlt;
+        compiledContact.rate = contact.rate;
+        compiledContact.from_index = fromIndices[i];
+        compiledContact.to_index = m_nodeIdToIndexMap[contact.to];
+        compiledContact.plan_index = usablePlanIndices[i];
+    }
+    for (std::size_t n = 0; n < m_nodeIds.size(); ++n) {
+        std::sort(m_contacts.begin() + m_adjacencyOffsets[n], m_contacts.begin() + m_adjacencyOffsets[n + 1],
+            [](const CompiledContact& a, const CompiledContact& b) {
+                return (a.start == b.start) ? (a.plan_index < b.plan_index) : (a.start < b.start);
+            });
+    }
+
+    //the contacts arriving at each node (indices in m_contacts), in the same CSR form
+    m_incomingOffsets.assign(m_nodeIds.size() + 1, 0);
+    for (std::size_t c = 0; c < m_contacts.size(); ++c) {
+        ++m_incomingOffsets[m_contacts[c].to_index + 1];
+    }
+    for (std::size_t i = 1; i < m_incomingOffsets.size(); ++i) {
+        m_incomingOffsets[i] += m_incomingOffsets[i - 1];
+    }
+    nextPosition.assign(m_incomingOffsets.begin(), m_incomingOffsets.end() - 1);
+    m_incomingContacts.resize(m_contacts.size());
+    for (std::size_t c = 0; c < m_contacts.size(); ++c) {
+        m_incomingContacts[nextPosition[m_contacts[c].to_index]++] = static_cast<contact_index_t>(c);
+    }
+}
+
+ContactGraph::node_index_t ContactGraph::get_node_index(const nodeId_t node_id) const noexcept {
+    std::unordered_map<nodeId_t, node_index_t>::const_iterator it = m_nodeIdToIndexMap.find(node_id);
+    return (it == m_nodeIdToIndexMap.cend()) ? INVALID_NODE_INDEX : it->second;
+}
+nodeId_t ContactGraph::get_node_id(const node_index_t node_index) const noexcept {
+    return m_nodeIds[node_index];
+}
+std::size_t ContactGraph::get_num_nodes() const noexcept {
+    return m_nodeIds.size();
+}
+std::size_t ContactGraph::get_num_contacts() const noexcept {
+    return m_contacts.size();
+}
+ContactGraph::contact_index_t ContactGraph::contacts_begin(const node_index_t node_index) const noexcept {
+    return m_adjacencyOffsets[node_index];
+}
+ContactGraph::contact_index_t ContactGraph::contacts_end(const node_index_t node_index) const noexcept {
+    return m_adjacencyOffsets[node_index + 1];
+}
+const ContactGraph::CompiledContact& ContactGraph::get_contact(const contact_index_t contact_index) const noexcept {
+    return m_contacts[contact_index];
+}
+ContactGraph::contact_index_t ContactGraph::incoming_begin(const node_index_t node_index) const noexcept {
+    return m_incomingOffsets[node_index];
+}
+ContactGraph::contact_index_t ContactGraph::incoming_end(const node_index_t node_index) const noexcept {
+    return m_incomingOffsets[node_index + 1];
+}
+ContactGraph::contact_index_t ContactGraph::get_incoming_contact(const contact_index_t i) const noexcept {
+    return m_incomingContacts[i];
+}
+
+
+ContactGraphSearch::ContactGraphSearch() :
+    m_graphPtr(NULL),
+    m_sourceIndex(ContactGraph::INVALID_NODE_INDEX),
+    m_isOneToAllTree(false),
+    m_startTime(0),
+    m_numNodesSearched(0) {}
+
+void ContactGraphSearch::suppress_contact(const ContactGraph& graph, const ContactGraph::contact_index_t contact_index) {
+    if (m_suppressedContacts.size() < graph.get_num_contacts()) {
+        m_suppressedContacts.resize(graph.get_num_contacts(), 0);
+    }
+    if (!m_suppressedContacts[contact_index]) {
+        m_suppressedContacts[contact_index] = 1;
+        m_suppressedContactIndices.push_back(contact_index);
+    }
+}
+
+void ContactGraphSearch::clear_suppressed_contacts() noexcept {
+    for (std::size_t i = 0; i < m_suppressedContactIndices.size(); ++i) {
+        m_suppressedContacts[m_suppressedContactIndices[i]] = 0;
+    }
+    m_suppressedContactIndices.clear();
+}
+
+bool ContactGraphSearch::is_suppressed(const ContactGraph::contact_index_t contact_index) const noexcept {
+    return (contact_index < m_suppressedContacts.size()) && m_suppressedContacts[contact_index];
+}
+
+void ContactGraphSearch::book_volume(const ContactGraph& graph, const ContactGraph::contact_index_t contact_index, const uint64_t volume) {
+    if (m_bookedVolumes.size() < graph.get_num_contacts()) {
+        m_bookedVolumes.resize(graph.get_num_contacts(), 0);
+        m_bookedContactsListed.resize(graph.get_num_contacts(), 0);
+    }
+    if (!m_bookedContactsListed[contact_index]) {
+        m_bookedContactsListed[contact_index] = 1;
+        m_bookedContactIndices.push_back(contact_index);
+    }
+    m_bookedVolumes[contact_index] = volume;
+}
+
+void ContactGraphSearch::clear_booked_volumes() noexcept {
+    for (std::size_t i = 0; i < m_bookedContactIndices.size(); ++i) {
+        m_bookedVolumes[m_bookedContactIndices[i]] = 0;
+        m_bookedContactsListed[m_bookedContactIndices[i]] = 0;
+    }
+    m_bookedContactIndices.clear();
+}
+
+uint64_t ContactGraphSearch::get_booked_volume(const ContactGraph::contact_index_t contact_index) const noexcept {
+    return (contact_index < m_bookedVolumes.size()) ? m_bookedVolumes[contact_index] : 0;
+}
+
+bool ContactGraphSearch::is_rebooked(const ContactGraph::contact_index_t contact_index) const noexcept {
+    const uint64_t searchedBookedVolume = (contact_index < m_searchedBookedVolumes.size()) ? m_searchedBookedVolumes[contact_index] : 0;
+    return get_booked_volume(contact_index) != searchedBookedVolume;
+}
+
+void ContactGraphSearch::save_searched_contact_states() {
+    m_searchedSuppressedContactIndices.assign(m_suppressedContactIndices.begin(), m_suppressedContactIndices.end());
+    for (std::size_t i = 0; i < m_searchedBookedContactIndices.size(); ++i) {
+        m_searchedBookedVolumes[m_searchedBookedContactIndices[i]] = 0;
+    }
+    m_searchedBookedContactIndices.clear();
+    if (m_searchedBookedVolumes.size() < m_bookedVolumes.size()) {
+        m_searchedBookedVolumes.resize(m_bookedVolumes.size(), 0);
+    }
+    for (std::size_t i = 0; i < m_bookedContactIndices.size(); ++i) {
+        const ContactGraph::contact_index_t c = m_bookedContactIndices[i];
+        if (m_bookedVolumes[c]) {
+            m_searchedBookedVolumes[c] = m_bookedVolumes[c];
+            m_searchedBookedContactIndices.push_back(c);
+        }
+    }
+}
+
+bool ContactGraphSearch::one_to_all(const ContactGraph& graph, const nodeId_t source, const time_t start_time) {
+    return search(graph, source, ContactGraph::INVALID_NODE_INDEX, start_time);
+}
+
+bool ContactGraphSearch::one_to_one(const ContactGraph& graph, const nodeId_t source, const nodeId_t destination, const time_t start_time) {
+    const ContactGraph::node_index_t destinationIndex = graph.get_node_index(destination);
+    if (destinationIndex == ContactGraph::INVALID_NODE_INDEX) {
+        reset(graph, source);
+        return false;
+    }
+    return search(graph, source, destinationIndex, start_time) && reached(destinationIndex);
+}
+
+void ContactGraphSearch::reset(const ContactGraph& graph, const nodeId_t source) {
+    //assign() only allocates the first time (or when the graph grows)
+    const std::size_t numNodes = graph.get_num_nodes();
+    m_arrivalTimes.assign(numNodes, MAX_TIME_T);
+    m_nextHopIndices.assign(numNodes, ContactGraph::INVALID_NODE_INDEX);
+    m_predecessorContacts.assign(numNodes, INVALID_CONTACT_INDEX);
+    m_visited.assign(numNodes, 0);
+    m_departureTimes.assign(numNodes, MAX_TIME_T);
+    m_heap.clear();
+    m_graphPtr = &graph;
+    m_sourceIndex = graph.get_node_index(source);
+    m_isOneToAllTree = false;
+    m_numNodesSearched = 0;
+}
+
+bool ContactGraphSearch::search(const ContactGraph& graph, const nodeId_t source, const ContactGraph::node_index_t destination_index, const time_t start_time) {
+    reset(graph, source);
+    if (m_sourceIndex == ContactGraph::INVALID_NODE_INDEX) {
+        return false;
+    }
+    m_isOneToAllTree = (destination_index == ContactGraph::INVALID_NODE_INDEX);
+    m_startTime = start_time;
+    save_searched_contact_states();
+    m_arrivalTimes[m_sourceIndex] = start_time;
+    m_heap.emplace_back(start_time, m_sourceIndex);
+    run(graph, destination_index);
+    return true;
+}
+
+bool ContactGraphSearch::repair(const ContactGraph& graph, const nodeId_t source, const time_t start_time) {
+    const std::size_t numNodes = graph.get_num_nodes();
+    if ((!m_isOneToAllTree) || (m_graphPtr != &graph) || (m_arrivalTimes.size() != numNodes)
+        || (m_sourceIndex != graph.get_node_index(source)) || (start_time < m_startTime))
+    {
+        return one_to_all(graph, source, start_time);
+    }
+    m_numNodesSearched = 0;
+    m_heap.clear();
+
+    //A route is affected if it departed the source before start_time (it would now depart later),
+    //or if it uses a contact suppressed or rebooked since.  The routes through an affected node (its subtree) are affected too.
+    static constexpr uint8_t UNKNOWN = 0;
+    static constexpr uint8_t UNAFFECTED = 1;
+    static constexpr uint8_t AFFECTED = 2;
+    m_repairStates.assign(numNodes, UNKNOWN);
+    m_repairStates[m_sourceIndex] = UNAFFECTED;
+    for (ContactGraph::node_index_t v = 0; v < numNodes; ++v) {
+        if ((!m_visited[v]) || (m_repairStates[v] != UNKNOWN)) {
+            continue;
+        }
+        m_repairStack.clear();
+        ContactGraph::node_index_t u = v;
+        while (m_repairStates[u] == UNKNOWN) { //walk up the tree until a node whose state is known
+            const ContactGraph::contact_index_t c = m_predecessorContacts[u];
+            if (is_suppressed(c) || is_rebooked(c) || (m_departureTimes[u] < start_time)) {
+                m_repairStates[u] = AFFECTED;
+                break;
+            }
+            m_repairStack.push_back(u);
+            u = graph.get_contact(c).from_index;
+        }
+        const uint8_t state = m_repairStates[u];
+        for (std::size_t i = 0; i < m_repairStack.size(); ++i) {
+            m_repairStates[m_repairStack[i]] = state;
+        }
+    }
+    for (ContactGraph::node_index_t v = 0; v < numNodes; ++v) {
+        if (m_repairStates[v] == AFFECTED) {
+            m_arrivalTimes[v] = MAX_TIME_T;
+            m_nextHopIndices[v] = ContactGraph::INVALID_NODE_INDEX;
+            m_predecessorContacts[v] = INVALID_CONTACT_INDEX;
+            m_visited[v] = 0;
+            m_departureTimes[v] = MAX_TIME_T;
+        }
+    }
+    m_arrivalTimes[m_sourceIndex] = start_time;
+    m_startTime = start_time;
+
+    //search the affected nodes again from their unaffected in-neighbors
+    for (ContactGraph::node_index_t v = 0; v < numNodes; ++v) {
+        if (m_repairStates[v] == AFFECTED) {
+            const ContactGraph::contact_index_t end = graph.incoming_end(v);
+            for (ContactGraph::contact_index_t i = graph.incoming_begin(v); i < end; ++i) {
+                const ContactGraph::contact_index_t c = graph.get_incoming_contact(i);
+                if (m_repairStates[graph.get_contact(c).from_index] == UNAFFECTED) {
+                    relax(graph, c);
+                }
+            }
+        }
+    }
+    //and improve the routes through the contacts unsuppressed or rebooked since
+    for (std::size_t i = 0; i < m_searchedSuppressedContactIndices.size(); ++i) {
+        const ContactGraph::contact_index_t c = m_searchedSuppressedContactIndices[i];
+        if ((c < graph.get_num_contacts()) && (!is_suppressed(c)) && (m_repairStates[graph.get_contact(c).from_index] == UNAFFECTED)) {
+            relax(graph, c);
+        }
+    }
+    for (unsigned int pass = 0; pass < 2; ++pass) {
+        const std::vector<ContactGraph::contact_index_t>& bookedContactIndices = (pass == 0) ? m_searchedBookedContactIndices : m_bookedContactIndices;
+        for (std::size_t i = 0; i < bookedContactIndices.size(); ++i) {
+            const ContactGraph::contact_index_t c = bookedContactIndices[i];
+            if ((c < graph.get_num_contacts()) && is_rebooked(c) && (m_repairStates[graph.get_contact(c).from_index] == UNAFFECTED)) {
+                relax(graph, c);
+            }
+        }
+    }
+    save_searched_contact_states();
+    run(graph, ContactGraph::INVALID_NODE_INDEX);
+    return true;
+}
+
+void ContactGraphSearch::relax(const ContactGraph& graph, const ContactGraph::contact_index_t contact_index) {
+    if (is_suppressed(contact_index)) {
+        return;
+    }
+    const ContactGraph::CompiledContact& contact = graph.get_contact(contact_index);
+    const ContactGraph::node_index_t u = contact.from_index;
+    const ContactGraph::node_index_t v = contact.to_index;
+    const time_t arrivalTimeU = m_arrivalTimes[u];
+    if (contact.end <= arrivalTimeU) {
+        return;
+    }
+    time_t firstTransmissionTime = contact.start;
+    const uint64_t bookedVolume = get_booked_volume(contact_index);
+    if (bookedVolume) { //new traffic waits for the booked volume, transmitted from the contact start at the contact rate
+        const uint64_t bookedSeconds = (contact.rate) ? ((bookedVolume / contact.rate) + ((bookedVolume % contact.rate) != 0)) : UINT64_MAX;
+        if (bookedSeconds >= static_cast<uint64_t>(contact.end - contact.start)) {
+            return; //fully booked
+        }
+        firstTransmissionTime += static_cast<time_t>(bookedSeconds);
+    }
+    firstTransmissionTime = std::max(firstTransmissionTime, arrivalTimeU);
+    if (contact.end <= firstTransmissionTime) {
+        return;
+    }
+    time_t arrvl_time = firstTransmissionTime;
+    if (arrvl_time <= (MAX_TIME_T - contact.owlt)) {
+        arrvl_time += contact.owlt;
+    }
+    const bool fromSource = (u == m_sourceIndex);
+    const ContactGraph::node_index_t nextHopIndex = (fromSource) ? v : m_nextHopIndices[u];
+    const time_t departureTime = (fromSource) ? firstTransmissionTime : m_departureTimes[u];
+    //a tree child of a node whose route was repaired (at no later arrival time) follows its new route
+    if ((arrvl_time < m_arrivalTimes[v]) || ((m_predecessorContacts[v] == contact_index) && (arrvl_time == m_arrivalTimes[v])
+        && ((m_nextHopIndices[v] != nextHopIndex) || (m_departureTimes[v] != departureTime))))
+    {
+        m_arrivalTimes[v] = arrvl_time;
+        m_nextHopIndices[v] = nextHopIndex;
+        m_departureTimes[v] = departureTime;
+        m_predecessorContacts[v] = contact_index;
+        m_heap.emplace_back(arrvl_time, v);
+        std::push_heap(m_heap.begin(), m_heap.end(), std::greater<arrival_time_plus_node_index_pair_t>());
+    }
+}
+
+void ContactGraphSearch::run(const ContactGraph& graph, const ContactGraph::node_index_t destination_index) {
+    const std::greater<arrival_time_plus_node_index_pair_t> heapCompare;
+    while (!m_heap.empty()) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), heapCompare);
+        const arrival_time_plus_node_index_pair_t top = m_heap.back();
+        m_heap.pop_back();
+        const ContactGraph::node_index_t u = top.second;
+        if (top.first != m_arrivalTimes[u]) {
+            continue; //stale entry (lazy deletion)
+        }
+        m_visited[u] = 1;
+        ++m_numNodesSearched;
+        if (u == destination_index) {
+            break;
+        }
+        const ContactGraph::contact_index_t end = graph.contacts_end(u);
+        for (ContactGraph::contact_index_t c = graph.contacts_begin(u); c < end; ++c) {
+            relax(graph, c);
+        }
+    }
+}
+
+std::size_t ContactGraphSearch::get_num_nodes_searched() const noexcept {
+    return m_numNodesSearched;
+}
+
+bool ContactGraphSearch::reached(const ContactGraph::node_index_t node_index) const noexcept {
+    return (node_index < m_visited.size()) && m_visited[node_index];
+}
+
+bool ContactGraphSearch::has_route(const ContactGraph::node_index_t node_index) const noexcept {
+    return reached(node_index) && (node_index != m_sourceIndex);
+}
+
+time_t ContactGraphSearch::get_arrival_time(const ContactGraph::node_index_t node_index) const noexcept {
+    return m_arrivalTimes[node_index];
+}
+
+nodeId_t ContactGraphSearch::get_next_node(const ContactGraph::node_index_t node_index) const noexcept {
+    return m_graphPtr->get_node_id(m_nextHopIndices[node_index]);
+}
+
+ContactGraph::contact_index_t ContactGraphSearch::get_predecessor_contact(const ContactGraph::node_index_t node_index) const noexcept {
+    return m_predecessorContacts[node_index];
+}
+
+Route ContactGraphSearch::get_route(const std::vector<Contact>& contact_plan, const nodeId_t destination) const {
+    Route route;
+    if (m_graphPtr == NULL) {
+        return route;
+    }
+    ContactGraph::node_index_t nodeIndex = m_graphPtr->get_node_index(destination);
+    if ((nodeIndex == ContactGraph::INVALID_NODE_INDEX) || (!has_route(nodeIndex))) {
+        return route;
+    }
+    std::vector<const Contact*> hops;
+    while (nodeIndex != m_sourceIndex) {
+        const ContactGraph::CompiledContact& contact = m_graphPtr->get_contact(m_predecessorContacts[nodeIndex]);
+        const Contact& planContact = contact_plan[contact.plan_index];
+        hops.push_back(&planContact);
+        nodeIndex = m_graphPtr->get_node_index(planContact.frm);
+    }
+    route = Route(*(hops.back()));
+    hops.pop_back();
+    while (!hops.empty()) {
+        route.append(*(hops.back()));
+        hops.pop_back();
+    }
+    return route;
+}
+
+} // namespace cgr
@@ -1,6 +1,8 @@
 #include "libcgr.h"
+#include "ContactGraph.h"
 
 #include <queue>
+#include <algorithm>
 #include "Logger.h"
 #include "JsonSerializable.h"
 #include <boost/format.hpp>
@@ -490,6 +492,98 @@ Route dijkstra(Contact* root_contact, nodeId_t destination, std::vector<Contact>
     return route;
 }
 
+// Earliest arrival time at the end of a sequence of hops, leaving at departure_time
+static time_t get_hops_arrival_time(const std::vector<Contact>& hops, std::size_t num_hops, time_t departure_time) {
+    time_t arrival_time = departure_time;
+    for (std::size_t i = 0; i < num_hops; ++i) {
+        arrival_time = std::max(arrival_time, hops[i].start) + hops[i].owlt;
+    }
+    return arrival_time;
+}
+
+std::vector<Route> yen(nodeId_t source, nodeId_t destination, int currTime, std::vector<Contact> contactPlan, int numRoutes) {
+    std::vector<Route> routes;
+    if (numRoutes <= 0) {
+        return routes;
+    }
+    Contact rootContact(source, source, 0, MAX_TIME_T, 100, 1.0, 0);
+    rootContact.arrival_time = currTime;
+    {
+        Contact root = rootContact; //dijkstra modifies the working area of its root contact
+        Route route = dijkstra(&root, destination, contactPlan);
+        if (!route.valid()) {
+            return routes;
+        }
+        routes.push_back(route);
+    }
+    std::vector<std::vector<Contact> > routesHops(1, routes.back().get_hops());
+
+    // Candidate routes (not yet selected), with their hops and delivery time
+    struct Candidate {
+        Route route;
+        std::vector<Contact> hops;
+        time_t arrival_time;
+    };
+    std::vector<Candidate> candidates;
+    while (routes.size() < static_cast<std::size_t>(numRoutes)) {
+        const std::vector<Contact>& lastHops = routesHops.back();
+        // The spur node of the root path lastHops[0, i) is the source (i == 0) or the node reached by lastHops[i - 1]
+        for (std::size_t i = 0; i < lastHops.size(); ++i) {
+            Contact spurContact = (i == 0) ? rootContact : lastHops[i - 1];
+            spurContact.clear_dijkstra_working_area();
+            spurContact.suppressed_next_hop.clear();
+            spurContact.arrival_time = get_hops_arrival_time(lastHops, i, currTime);
+            // The spur route must not loop back through the root path
+            spurContact.visited_nodes.push_back(source);
+            for (std::size_t j = 0; j < i; ++j) {
+                spurContact.visited_nodes.push_back(lastHops[j].to);
+            }
+            // nor leave the spur node like a route already found with the same root path
+            for (const std::vector<Contact>& hops : routesHops) {
+                if ((hops.size() > i) && std::equal(lastHops.begin(), lastHops.begin() + i, hops.begin())) {
+                    spurContact.suppressed_next_hop.push_back(hops[i]);
+                }
+            }
+            Route spurRoute = dijkstra(&spurContact, destination, contactPlan);
+            if (!spurRoute.valid()) {
+                continue;
+            }
+            std::vector<Contact> hops(lastHops.begin(), lastHops.begin() + i);
+            const std::vector<Contact> spurHops = spurRoute.get_hops();
+            hops.insert(hops.end(), spurHops.begin(), spurHops.end());
+            bool isDuplicate = false;
+            for (const Candidate& candidate : candidates) {
+                isDuplicate = isDuplicate || (candidate.hops == hops);
+            }
+            if (isDuplicate) {
+                continue;
+            }
+            Route route(hops[0]);
+            for (std::size_t j = 1; j < hops.size(); ++j) {
+                route.append(hops[j]);
+            }
+            const time_t arrivalTime = get_hops_arrival_time(hops, hops.size(), currTime);
+            candidates.push_back(Candidate{ std::move(route), std::move(hops), arrivalTime });
+        }
+        if (candidates.empty()) {
+            break;
+        }
+        // The next best route arrives first, then has the fewest hops (then was found first)
+        std::size_t best = 0;
+        for (std::size_t i = 1; i < candidates.size(); ++i) {
+            if ((candidates[i].arrival_time < candidates[best].arrival_time) ||
+                ((candidates[i].arrival_time == candidates[best].arrival_time) && (candidates[i].hops.size() < candidates[best].hops.size())))
+            {
+                best = i;
+            }
+        }
+        routes.push_back(std::move(candidates[best].route));
+        routesHops.push_back(std::move(candidates[best].hops));
+        candidates.erase(candidates.begin() + best);
+    }
+    return routes;
+}
+
 /*
  * Helper functions
  */
@@ -765,4 +859,21 @@ Route cmr_dijkstra(Contact* root_contact, nodeId_t destination, const std::vecto
     return route;
 }
 
+next_hop_table_t dijkstra_one_to_all(const Contact& root_contact, const std::vector<Contact>& contact_plan) {
+    // For repeated searches over the same plan, build the ContactGraph once and reuse a ContactGraphSearch instead
+    const ContactGraph graph(contact_plan);
+    ContactGraphSearch search;
+    next_hop_table_t next_hop_table;
+    if (!search.one_to_all(graph, root_contact.to, root_contact.arrival_time)) {
+        return next_hop_table;
+    }
+    next_hop_table.reserve(graph.get_num_nodes());
+    for (ContactGraph::node_index_t i = 0; i < graph.get_num_nodes(); ++i) {
+        if (search.has_route(i)) {
+            next_hop_table.emplace(graph.get_node_id(i), NextHop{ search.get_next_node(i), search.get_arrival_time(i) });
+        }
+    }
+    return next_hop_table;
+}
+
 } // namespace cgr
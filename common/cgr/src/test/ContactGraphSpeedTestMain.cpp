@@ -0,0 +1,150 @@
+/**
+ * @file ContactGraphSpeedTestMain.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * Benchmark of route computations on synthetic contact plans (10k to 100k contacts by default):
+ * one cmr_dijkstra per destination (which rebuilds its multigraph from the plan on every call),
+ * dijkstra_one_to_all on the plan (which builds a ContactGraph on every call),
+ * and searches on a ContactGraph built once (as the router does when a contact plan is loaded),
+ * including repairs of a one_to_all search tree as time advances.
+ */
+
+#include <string>
+#include <vector>
+#include <random>
+#include <boost/program_options.hpp>
+#include <boost/timer/timer.hpp>
+#include "libcgr.h"
+#include "ContactGraph.h"
+#include "Logger.h"
+
+static constexpr hdtn::Logger::SubProcess subprocess = hdtn::Logger::SubProcess::router;
+
+static std::vector<cgr::Contact> GenerateContactPlan(const uint64_t numContacts, const uint64_t numNodes, const time_t horizonSeconds) {
+    std::mt19937_64 rng(numContacts); //repeatable
+    std::uniform_int_distribution<uint64_t> nodeDistribution(1, numNodes);
+    std::uniform_int_distribution<time_t> startDistribution(0, horizonSeconds);
+    std::uniform_int_distribution<time_t> durationDistribution(60, 600);
+    std::uniform_int_distribution<time_t> owltDistribution(0, 2);
+    std::vector<cgr::Contact> contactPlan;
+    contactPlan.reserve(numContacts);
+    while (contactPlan.size() < numContacts) {
+        const cgr::nodeId_t frm = nodeDistribution(rng);
+        const cgr::nodeId_t to = nodeDistribution(rng);
+        if (frm == to) {
+            continue;
+        }
+        const time_t start = startDistribution(rng);
+        contactPlan.emplace_back(frm, to, start, start + durationDistribution(rng), 1000000, 1.f, owltDistribution(rng));
+        contactPlan.back().id = contactPlan.size();
+    }
+    return contactPlan;
+}
+
+static double ElapsedMicroseconds(const boost::timer::cpu_timer& timer) {
+    return static_cast<double>(timer.elapsed().wall) * 1e-3;
+}
+
+int main(int argc, const char* argv[]) {
+    hdtn::Logger::initializeWithProcess(hdtn::Logger::Process::router);
+
+    std::vector<uint64_t> numContactsList;
+    uint64_t numNodes;
+    uint64_t numDestinations;
+    uint64_t numSearches;
+    boost::program_options::options_description desc("Allowed options");
+    try {
+        desc.add_options()
+            ("help", "Produce help message.")
+            ("num-contacts", boost::program_options::value<std::vector<uint64_t> >()->multitoken()->default_value(std::vector<uint64_t>({ 10000, 50000, 100000 }), "10000 50000 100000"), "Contact plan sizes to test.")
+            ("num-nodes", boost::program_options::value<uint64_t>()->default_value(1000), "Number of nodes in the contact plans.")
+            ("num-destinations", boost::program_options::value<uint64_t>()->default_value(20), "Number of destinations routed with one cmr_dijkstra each.")
+            ("num-searches", boost::program_options::value<uint64_t>()->default_value(100), "Number of searches on the ContactGraph (from different sources).");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc, boost::program_options::command_line_style::unix_style | boost::program_options::command_line_style::case_insensitive), vm);
+        boost::program_options::notify(vm);
+
+        if (vm.count("help")) {
+            LOG_INFO(subprocess) << desc;
+            return 1;
+        }
+        numContactsList = vm["num-contacts"].as<std::vector<uint64_t> >();
+        numNodes = std::max<uint64_t>(vm["num-nodes"].as<uint64_t>(), 2);
+        numDestinations = std::max<uint64_t>(vm["num-destinations"].as<uint64_t>(), 1);
+        numSearches = std::max<uint64_t>(vm["num-searches"].as<uint64_t>(), 1);
+    }
+    catch (std::exception& e) {
+        LOG_ERROR(subprocess) << "error: " << e.what();
+        return 1;
+    }
+
+    for (std::size_t i = 0; i < numContactsList.size(); ++i) {
+        const uint64_t numContacts = std::max<uint64_t>(numContactsList[i], 1);
+        const std::vector<cgr::Contact> contactPlan = GenerateContactPlan(numContacts, numNodes, 86400);
+        static constexpr cgr::nodeId_t SOURCE = 1;
+        cgr::Contact rootContact(SOURCE, SOURCE, 0, cgr::MAX_TIME_T, 100, 1.0, 0);
+        rootContact.arrival_time = 0;
+
+        //one cmr_dijkstra per destination
+        boost::timer::cpu_timer cmrTimer;
+        uint64_t cmrNumReached = 0;
+        for (uint64_t d = 0; d < numDestinations; ++d) {
+            const cgr::nodeId_t destination = 2 + (d % (numNodes - 1));
+            cgr::Contact root = rootContact;
+            cmrNumReached += cgr::cmr_dijkstra(&root, destination, contactPlan).valid();
+        }
+        cmrTimer.stop();
+
+        //dijkstra_one_to_all building its ContactGraph
+        boost::timer::cpu_timer oneToAllTimer;
+        const cgr::next_hop_table_t nextHopTable = cgr::dijkstra_one_to_all(rootContact, contactPlan);
+        oneToAllTimer.stop();
+
+        //ContactGraph built once, then searched
+        boost::timer::cpu_timer buildTimer;
+        const cgr::ContactGraph contactGraph(contactPlan);
+        buildTimer.stop();
+        cgr::ContactGraphSearch search;
+        boost::timer::cpu_timer oneToAllSearchTimer;
+        for (uint64_t s = 0; s < numSearches; ++s) {
+            search.one_to_all(contactGraph, 1 + (s % numNodes), 0);
+        }
+        oneToAllSearchTimer.stop();
+        boost::timer::cpu_timer oneToOneSearchTimer;
+        uint64_t oneToOneNumReached = 0;
+        for (uint64_t d = 0; d < numDestinations; ++d) {
+            oneToOneNumReached += search.one_to_one(contactGraph, SOURCE, 2 + (d % (numNodes - 1)), 0);
+        }
+        oneToOneSearchTimer.stop();
+        //repairs of a one_to_all search tree as time advances (by a minute per repair)
+        search.one_to_all(contactGraph, SOURCE, 0);
+        boost::timer::cpu_timer repairTimer;
+        uint64_t repairNumNodesSearched = 0;
+        for (uint64_t s = 1; s <= numSearches; ++s) {
+            search.repair(contactGraph, SOURCE, static_cast<time_t>(s * 60));
+            repairNumNodesSearched += search.get_num_nodes_searched();
+        }
+        repairTimer.stop();
+        if (oneToOneNumReached != cmrNumReached) { //cmr_dijkstra assumes that the contacts between two nodes do not overlap
+            LOG_WARNING(subprocess) << "ContactGraph one_to_one reached " << oneToOneNumReached << " destinations but cmr_dijkstra reached " << cmrNumReached;
+        }
+
+        LOG_INFO(subprocess) << numContacts << " contacts, " << contactGraph.get_num_nodes() << " nodes, "
+            << nextHopTable.size() << " destinations reachable from node " << SOURCE << ":";
+        LOG_INFO(subprocess) << "  cmr_dijkstra per destination: " << (ElapsedMicroseconds(cmrTimer) / numDestinations) << " us";
+        LOG_INFO(subprocess) << "  dijkstra_one_to_all (all destinations, graph built per call): " << ElapsedMicroseconds(oneToAllTimer) << " us";
+        LOG_INFO(subprocess) << "  ContactGraph build (once per contact plan): " << ElapsedMicroseconds(buildTimer) << " us";
+        LOG_INFO(subprocess) << "  ContactGraphSearch one_to_all (all destinations): " << (ElapsedMicroseconds(oneToAllSearchTimer) / numSearches) << " us";
+        LOG_INFO(subprocess) << "  ContactGraphSearch one_to_one per destination: " << (ElapsedMicroseconds(oneToOneSearchTimer) / numDestinations) << " us";
+        LOG_INFO(subprocess) << "  ContactGraphSearch repair (all destinations, one minute later): " << (ElapsedMicroseconds(repairTimer) / numSearches) << " us, "
+            << (repairNumNodesSearched / numSearches) << " nodes searched";
+    }
+    return 0;
+}
@@ -0,0 +1,251 @@
+/**
+ * @file TestContactGraph.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "ContactGraph.h"
+#include "Environment.h"
+#include <set>
+
+BOOST_AUTO_TEST_CASE(ContactGraphRoutingTestCase)
+{
+	const boost::filesystem::path contactRootDir = Environment::GetPathHdtnSourceRoot() / "module" / "router" / "contact_plans";
+	const boost::filesystem::path contactFile = contactRootDir / "contactPlan_RoutingTest.json";
+	const std::vector<cgr::Contact> contactPlan = cgr::cp_load(contactFile);
+	BOOST_REQUIRE_EQUAL(contactPlan.size(), 8);
+
+	const cgr::ContactGraph graph(contactPlan);
+	BOOST_REQUIRE_EQUAL(graph.get_num_nodes(), 6); //1, 2, 3, 4, 100, 200
+	BOOST_REQUIRE_EQUAL(graph.get_num_contacts(), 8);
+	BOOST_REQUIRE_EQUAL(graph.get_node_index(5), cgr::ContactGraph::INVALID_NODE_INDEX);
+	const cgr::ContactGraph::node_index_t node1 = graph.get_node_index(1);
+	const cgr::ContactGraph::node_index_t node4 = graph.get_node_index(4);
+	BOOST_REQUIRE_EQUAL(graph.get_node_id(node1), 1);
+	BOOST_REQUIRE_LT(node1, node4); //dense indices in node id order
+
+	//the contacts leaving node 1, sorted by start time
+	BOOST_REQUIRE_EQUAL(graph.contacts_end(node1) - graph.contacts_begin(node1), 3);
+	const cgr::ContactGraph::contact_index_t first = graph.contacts_begin(node1);
+	BOOST_REQUIRE_EQUAL(graph.get_contact(first).plan_index, 1); //1->2 at 0
+	BOOST_REQUIRE_EQUAL(graph.get_contact(first + 1).plan_index, 4); //1->3 at 11
+	BOOST_REQUIRE_EQUAL(graph.get_contact(first + 2).plan_index, 5); //1->2 at 17
+
+	cgr::ContactGraphSearch search;
+	BOOST_REQUIRE(search.one_to_all(graph, 1, 0));
+	BOOST_REQUIRE(search.has_route(node4));
+	BOOST_REQUIRE(!search.has_route(node1)); //the source
+	BOOST_REQUIRE(search.reached(node1));
+	BOOST_REQUIRE(!search.reached(graph.get_node_index(100))); //no contact to node 100
+	BOOST_REQUIRE_EQUAL(search.get_next_node(node4), 2);
+	BOOST_REQUIRE_EQUAL(search.get_arrival_time(node4), 12);
+	//same route as CMR_DijkstraRoutingTestCase
+	const cgr::Route route = search.get_route(contactPlan, 4);
+	BOOST_REQUIRE(route.valid());
+	const std::vector<cgr::Contact> hops = static_cast<cgr::Route>(route).get_hops();
+	BOOST_REQUIRE_EQUAL(hops.size(), 2);
+	BOOST_REQUIRE(hops[0] == contactPlan[1]);
+	BOOST_REQUIRE(hops[1] == contactPlan[2]);
+	BOOST_REQUIRE(!search.get_route(contactPlan, 100).valid());
+
+	//suppressed contacts are routed around until cleared
+	search.suppress_contact(graph, first);
+	BOOST_REQUIRE(search.one_to_one(graph, 1, 4, 0));
+	BOOST_REQUIRE_EQUAL(search.get_next_node(node4), 2); //the later 1->2 contact
+	BOOST_REQUIRE_EQUAL(search.get_arrival_time(node4), 19);
+	search.suppress_contact(graph, first + 2);
+	BOOST_REQUIRE(search.one_to_one(graph, 1, 4, 0));
+	BOOST_REQUIRE_EQUAL(search.get_next_node(node4), 3);
+	BOOST_REQUIRE_EQUAL(search.get_arrival_time(node4), 26);
+	search.clear_suppressed_contacts();
+	BOOST_REQUIRE(search.one_to_one(graph, 1, 4, 0));
+	BOOST_REQUIRE_EQUAL(search.get_arrival_time(node4), 12);
+
+	//no route from 4 to 1, and unknown nodes
+	BOOST_REQUIRE(!search.one_to_one(graph, 4, 1, 0));
+	BOOST_REQUIRE(!search.one_to_one(graph, 1, 5, 0));
+	BOOST_REQUIRE(!search.one_to_all(graph, 5, 0));
+
+	//an empty graph
+	const cgr::ContactGraph emptyGraph;
+	BOOST_REQUIRE_EQUAL(emptyGraph.get_num_nodes(), 0);
+	BOOST_REQUIRE(!search.one_to_all(emptyGraph, 1, 0));
+}
+
+BOOST_AUTO_TEST_CASE(ContactGraph50NodesTestCase)
+{
+	// Searches reusing one ContactGraphSearch must find the same best delivery times as a dijkstra search to each destination
+	const boost::filesystem::path contactRootDir = Environment::GetPathHdtnSourceRoot() / "module" / "router" / "contact_plans";
+	const boost::filesystem::path contactFile = contactRootDir / "50nodes.json";
+	const std::vector<cgr::Contact> contactPlan = cgr::cp_load(contactFile);
+	const cgr::ContactGraph graph(contactPlan);
+	cgr::ContactGraphSearch oneToAllSearch;
+	BOOST_REQUIRE(oneToAllSearch.one_to_all(graph, 20, 0));
+	cgr::ContactGraphSearch oneToOneSearch;
+
+	std::set<cgr::nodeId_t> destinations;
+	for (const cgr::Contact& contact : contactPlan) {
+		destinations.insert(contact.to);
+	}
+	destinations.erase(20);
+	for (const cgr::nodeId_t destination : destinations) {
+		cgr::Contact rootContact = cgr::Contact(20, 20, 0, cgr::MAX_TIME_T, 100, 1.0, 0);
+		rootContact.arrival_time = 0;
+		const cgr::Route bestRoute = cgr::dijkstra(&rootContact, destination, contactPlan);
+		const cgr::ContactGraph::node_index_t destinationIndex = graph.get_node_index(destination);
+		BOOST_REQUIRE_EQUAL(bestRoute.valid(), oneToAllSearch.has_route(destinationIndex));
+		BOOST_REQUIRE_EQUAL(bestRoute.valid(), oneToOneSearch.one_to_one(graph, 20, destination, 0));
+		if (bestRoute.valid()) {
+			BOOST_CHECK_EQUAL(bestRoute.best_delivery_time, oneToAllSearch.get_arrival_time(destinationIndex));
+			BOOST_CHECK_EQUAL(bestRoute.best_delivery_time, oneToOneSearch.get_arrival_time(destinationIndex));
+			BOOST_CHECK_EQUAL(oneToOneSearch.get_route(contactPlan, destination).best_delivery_time, bestRoute.best_delivery_time);
+		}
+	}
+}
+
+static void CheckRepairedSearch(const cgr::ContactGraph& graph, const std::vector<cgr::Contact>& contactPlan,
+	const cgr::ContactGraphSearch& repairedSearch, const cgr::ContactGraphSearch& freshSearch)
+{
+	for (cgr::ContactGraph::node_index_t n = 0; n < graph.get_num_nodes(); ++n) {
+		BOOST_REQUIRE_EQUAL(repairedSearch.reached(n), freshSearch.reached(n));
+		BOOST_REQUIRE_EQUAL(repairedSearch.has_route(n), freshSearch.has_route(n));
+		if (repairedSearch.has_route(n)) {
+			BOOST_REQUIRE_EQUAL(repairedSearch.get_arrival_time(n), freshSearch.get_arrival_time(n));
+			//the repaired next node is the first hop of the repaired route
+			const cgr::Route route = repairedSearch.get_route(contactPlan, graph.get_node_id(n));
+			BOOST_REQUIRE(route.valid());
+			BOOST_REQUIRE_EQUAL(route.next_node, repairedSearch.get_next_node(n));
+			BOOST_REQUIRE_EQUAL(route.to_node, graph.get_node_id(n));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(ContactGraphRepairTestCase)
+{
+	const boost::filesystem::path contactRootDir = Environment::GetPathHdtnSourceRoot() / "module" / "router" / "contact_plans";
+	{
+		const std::vector<cgr::Contact> contactPlan = cgr::cp_load(contactRootDir / "contactPlan_RoutingTest.json");
+		const cgr::ContactGraph graph(contactPlan);
+		const cgr::ContactGraph::node_index_t node4 = graph.get_node_index(4);
+		const cgr::ContactGraph::contact_index_t first = graph.contacts_begin(graph.get_node_index(1));
+		cgr::ContactGraphSearch search;
+		BOOST_REQUIRE(search.repair(graph, 1, 0)); //nothing to repair: a one_to_all search
+		BOOST_REQUIRE_EQUAL(search.get_arrival_time(node4), 12);
+		const std::size_t numNodesSearched = search.get_num_nodes_searched();
+		BOOST_REQUIRE_GT(numNodesSearched, 0);
+
+		//the same start time and contacts: nothing to recompute
+		BOOST_REQUIRE(search.repair(graph, 1, 0));
+		BOOST_REQUIRE_EQUAL(search.get_num_nodes_searched(), 0);
+		BOOST_REQUIRE_EQUAL(search.get_arrival_time(node4), 12);
+
+		//link down then up again
+		search.suppress_contact(graph, first);
+		BOOST_REQUIRE(search.repair(graph, 1, 0));
+		BOOST_REQUIRE_LT(search.get_num_nodes_searched(), numNodesSearched);
+		BOOST_REQUIRE_EQUAL(search.get_next_node(node4), 2);
+		BOOST_REQUIRE_EQUAL(search.get_arrival_time(node4), 19);
+		search.clear_suppressed_contacts();
+		BOOST_REQUIRE(search.repair(graph, 1, 0));
+		BOOST_REQUIRE_EQUAL(search.get_arrival_time(node4), 12);
+
+		//time advances: still the first 2->4 contact, which starts at 11
+		BOOST_REQUIRE(search.repair(graph, 1, 10));
+		BOOST_REQUIRE_EQUAL(search.get_arrival_time(node4), 12);
+		//the first 1->2 contact ends at 120
+		BOOST_REQUIRE(search.repair(graph, 1, 130));
+		BOOST_REQUIRE_EQUAL(search.get_next_node(node4), 2);
+		BOOST_REQUIRE_EQUAL(search.get_arrival_time(node4), 132);
+		BOOST_REQUIRE_EQUAL(search.get_route(contactPlan, 4).get_hops()[0].id, 6);
+
+		//an earlier start time or another source is a new search
+		BOOST_REQUIRE(search.repair(graph, 1, 0));
+		BOOST_REQUIRE_EQUAL(search.get_arrival_time(node4), 12);
+		BOOST_REQUIRE(!search.repair(graph, 5, 0));
+	}
+	{
+		// Repairs through advancing time and changing suppressed contacts must match fresh one_to_all searches
+		const std::vector<cgr::Contact> contactPlan = cgr::cp_load(contactRootDir / "50nodes.json");
+		const cgr::ContactGraph graph(contactPlan);
+		cgr::ContactGraphSearch repairedSearch;
+		cgr::ContactGraphSearch freshSearch;
+		std::set<cgr::ContactGraph::contact_index_t> suppressedContacts;
+		const cgr::ContactGraph::node_index_t sourceIndex = graph.get_node_index(20);
+		const cgr::ContactGraph::contact_index_t sourceContactsBegin = graph.contacts_begin(sourceIndex);
+		const cgr::ContactGraph::contact_index_t numSourceContacts = graph.contacts_end(sourceIndex) - sourceContactsBegin;
+		BOOST_REQUIRE_GT(numSourceContacts, 0);
+		time_t startTime = 0;
+		for (unsigned int step = 0; step < 40; ++step) {
+			//toggle a contact leaving the source and one anywhere in the graph
+			const cgr::ContactGraph::contact_index_t toggledContacts[2] = {
+				sourceContactsBegin + ((step * 7) % numSourceContacts),
+				static_cast<cgr::ContactGraph::contact_index_t>((step * 131) % graph.get_num_contacts())
+			};
+			for (const cgr::ContactGraph::contact_index_t c : toggledContacts) {
+				if (!suppressedContacts.insert(c).second) {
+					suppressedContacts.erase(c);
+				}
+			}
+			repairedSearch.clear_suppressed_contacts();
+			freshSearch.clear_suppressed_contacts();
+			for (const cgr::ContactGraph::contact_index_t c : suppressedContacts) {
+				repairedSearch.suppress_contact(graph, c);
+				freshSearch.suppress_contact(graph, c);
+			}
+			//and book volume (up to the whole contact) on another contact leaving the source
+			const cgr::ContactGraph::contact_index_t bookedContact = sourceContactsBegin + ((step * 3) % numSourceContacts);
+			const cgr::ContactGraph::CompiledContact& compiledContact = graph.get_contact(bookedContact);
+			const uint64_t bookedVolume = compiledContact.rate * static_cast<uint64_t>(compiledContact.end - compiledContact.start) * (step % 4) / 3;
+			repairedSearch.book_volume(graph, bookedContact, bookedVolume);
+			freshSearch.book_volume(graph, bookedContact, bookedVolume);
+			BOOST_REQUIRE(repairedSearch.repair(graph, 20, startTime));
+			BOOST_REQUIRE(freshSearch.one_to_all(graph, 20, startTime));
+			CheckRepairedSearch(graph, contactPlan, repairedSearch, freshSearch);
+			startTime += (step % 3) * 60;
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(ContactGraphBookedVolumeTestCase)
+{
+	const boost::filesystem::path contactRootDir = Environment::GetPathHdtnSourceRoot() / "module" / "router" / "contact_plans";
+	const std::vector<cgr::Contact> contactPlan = cgr::cp_load(contactRootDir / "contactPlan_RoutingTest.json");
+	const cgr::ContactGraph graph(contactPlan);
+	const cgr::ContactGraph::node_index_t node4 = graph.get_node_index(4);
+	const cgr::ContactGraph::contact_index_t first = graph.contacts_begin(graph.get_node_index(1)); //1->2 from 0 to 120
+	const uint64_t rate = graph.get_contact(first).rate;
+	BOOST_REQUIRE_EQUAL(rate, 1000000000);
+	cgr::ContactGraphSearch search;
+
+	//a backlog of 15 seconds: the first 1->2 contact now departs at 15
+	search.book_volume(graph, first, 15 * rate);
+	BOOST_REQUIRE(search.one_to_all(graph, 1, 0));
+	BOOST_REQUIRE_EQUAL(search.get_next_node(node4), 2);
+	BOOST_REQUIRE_EQUAL(search.get_arrival_time(node4), 17);
+	BOOST_REQUIRE_EQUAL(search.get_arrival_time(graph.get_node_index(3)), 12); //the idle 1->3 contact is unaffected
+	//part of a second still waits a second
+	search.book_volume(graph, first, 10 * rate + 1);
+	BOOST_REQUIRE(search.repair(graph, 1, 0));
+	BOOST_REQUIRE_EQUAL(search.get_arrival_time(graph.get_node_index(2)), 12);
+	BOOST_REQUIRE_EQUAL(search.get_arrival_time(node4), 13);
+
+	//fully booked: the later 1->2 contact
+	search.book_volume(graph, first, 120 * rate);
+	BOOST_REQUIRE(search.repair(graph, 1, 0));
+	BOOST_REQUIRE_EQUAL(search.get_arrival_time(node4), 19);
+	BOOST_REQUIRE_EQUAL(search.get_route(contactPlan, 4).get_hops()[0].id, 6);
+	//a backlog transmitted by the start time no longer delays
+	search.book_volume(graph, first, 15 * rate);
+	BOOST_REQUIRE(search.repair(graph, 1, 16));
+	BOOST_REQUIRE_EQUAL(search.get_arrival_time(node4), 18);
+
+	search.clear_booked_volumes();
+	BOOST_REQUIRE(search.repair(graph, 1, 16));
+	BOOST_REQUIRE_EQUAL(search.get_arrival_time(node4), 18);
+	BOOST_REQUIRE(search.repair(graph, 1, 20));
+	BOOST_REQUIRE_EQUAL(search.get_arrival_time(node4), 22);
+}
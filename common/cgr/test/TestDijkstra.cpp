@@ -3,6 +3,7 @@
 #include "Environment.h"
 #include <boost/algorithm/string.hpp>
 #include <iostream>
+#include <set>
 
 #include <chrono>
 
@@ -611,3 +612,50 @@ BOOST_AUTO_TEST_CASE(TimingTest_CMConstruction, *boost::unit_test::disabled())
 
 	std::cout << "Construction avg: " << times / 100 << std::endl;
 }
+
+BOOST_AUTO_TEST_CASE(DijkstraOneToAllRoutingTestCase)
+{
+	// One search from node 1 finds node 4 (next hop 2, as DijkstraRoutingTestCase) and no route back from node 4 to node 1
+	const boost::filesystem::path contactRootDir = Environment::GetPathHdtnSourceRoot() / "module" / "router" / "contact_plans";
+	const boost::filesystem::path contactFile = contactRootDir / "contactPlan_RoutingTest.json";
+	std::vector<cgr::Contact> contactPlan = cgr::cp_load(contactFile);
+
+	cgr::Contact rootContact = cgr::Contact(1, 1, 0, cgr::MAX_TIME_T, 100, 1.0, 0);
+	rootContact.arrival_time = 0;
+	const cgr::next_hop_table_t nextHopTable = cgr::dijkstra_one_to_all(rootContact, contactPlan);
+	BOOST_REQUIRE(nextHopTable.count(4));
+	BOOST_CHECK_EQUAL(nextHopTable.at(4).next_node, 2);
+	BOOST_CHECK(!nextHopTable.count(1)); // the source is not a destination
+
+	cgr::Contact rootContact4 = cgr::Contact(4, 4, 0, cgr::MAX_TIME_T, 100, 1.0, 0);
+	rootContact4.arrival_time = 0;
+	BOOST_CHECK(!cgr::dijkstra_one_to_all(rootContact4, contactPlan).count(1));
+}
+
+BOOST_AUTO_TEST_CASE(DijkstraOneToAll50NodesTestCase)
+{
+	// The one-to-all search must find the same best delivery time as a dijkstra search to each destination
+	const boost::filesystem::path contactRootDir = Environment::GetPathHdtnSourceRoot() / "module" / "router" / "contact_plans";
+	const boost::filesystem::path contactFile = contactRootDir / "50nodes.json";
+	std::vector<cgr::Contact> contactPlan = cgr::cp_load(contactFile);
+
+	cgr::Contact rootContact = cgr::Contact(20, 20, 0, cgr::MAX_TIME_T, 100, 1.0, 0);
+	rootContact.arrival_time = 0;
+	const cgr::next_hop_table_t nextHopTable = cgr::dijkstra_one_to_all(rootContact, contactPlan);
+	BOOST_REQUIRE(nextHopTable.count(40));
+
+	std::set<cgr::nodeId_t> destinations;
+	for (const cgr::Contact& contact : contactPlan) {
+		destinations.insert(contact.to);
+	}
+	destinations.erase(20);
+	for (const cgr::nodeId_t destination : destinations) {
+		cgr::Contact root = rootContact;
+		const cgr::Route bestRoute = cgr::dijkstra(&root, destination, contactPlan);
+		cgr::next_hop_table_t::const_iterator it = nextHopTable.find(destination);
+		BOOST_REQUIRE_EQUAL(bestRoute.valid(), (it != nextHopTable.cend()));
+		if (bestRoute.valid()) {
+			BOOST_CHECK_EQUAL(bestRoute.best_delivery_time, it->second.best_delivery_time);
+		}
+	}
+}
@@ -7,7 +7,7 @@
 BOOST_AUTO_TEST_CASE(YenPyCGRTutorialTestCase)
 {
 	std::cout << "Reading contact plan..." << std::endl;
-	const boost::filesystem::path contactRootDir = Environment::GetPathHdtnSourceRoot() / "common" / "cgr" / "test";
+	const boost::filesystem::path contactRootDir = Environment::GetPathHdtnSourceRoot() / "module" / "router" / "contact_plans";
 	const boost::filesystem::path contactFile = contactRootDir / "cgrTutorial.json";
 
 	std::vector<cgr::Contact> contactPlan = cgr::cp_load(contactFile);
@@ -16,21 +16,26 @@ BOOST_AUTO_TEST_CASE(YenPyCGRTutorialTestCase)
 	BOOST_CHECK(numContacts == 16);
 
 	int max = 10;
-	int expected = 7; // data in cgrTutorial.json should give 7 possible paths from 1->5
+	const std::size_t expected = 7; // data in cgrTutorial.json should give 7 possible paths from 1->5
 	std::cout << "Finding up to " << max << " best paths using yen's..." << std::endl;
 	std::vector<cgr::Route> routes = yen(1, 5, 0, contactPlan, max);
-	BOOST_CHECK(routes.size() == expected);
+	BOOST_REQUIRE(routes.size() == expected);
 
-	// exact bdt depends on owlt so it should be calculated rather than hard coded
-	// instead of checking all the bdts let's just check the first three hops
-	//int[] bdts = { 3, 4, 11, 31, 31, 51, 51 };
+	// with an owlt of 1 on every contact, routes are ordered by delivery time (then by number of hops)
+	const time_t bdts[] = { 3, 4, 11, 31, 31, 51, 51 };
 	std::cout << "Found " << routes.size() << " routes with best delivery times:";
-	for (int i = 0; i < expected; ++i) {
-		//BOOST_CHECK(routes[i].best_delivery_time = bdts[i]);
+	for (std::size_t i = 0; i < expected; ++i) {
+		BOOST_CHECK_EQUAL(routes[i].best_delivery_time, bdts[i]);
 		std::cout << ' ' << routes[i].best_delivery_time;
 	}
 	std::cout << std::endl;
 	BOOST_CHECK(routes[0].next_node == 3);
 	BOOST_CHECK(routes[1].next_node == 2);
 	BOOST_CHECK(routes[2].next_node == 5);
+	BOOST_CHECK(routes[3].get_hops().size() == 3);
+	BOOST_CHECK(routes[4].get_hops().size() == 4);
+
+	// no more routes than asked for, and none to an unknown node
+	BOOST_CHECK(yen(1, 5, 0, contactPlan, 2).size() == 2);
+	BOOST_CHECK(yen(1, 99, 0, contactPlan, max).empty());
 }
\ No newline at end of file
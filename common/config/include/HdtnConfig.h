@@ -80,6 +80,15 @@ public:
     uint64_t m_maxBundleSizeBytes;
     uint64_t m_maxIngressBundleWaitOnEgressMilliseconds;
     bool m_bufferRxToStorageOnLinkUpSaturation;
+    uint64_t m_numIngressWorkerThreads; //0 => bundles are processed on the induct threads
+    uint64_t m_maxIngressBatchBundles; //0 or 1 => ingress sends one bundle per zmq message to egress and storage
+    uint64_t m_ingressBatchLatencyMicroseconds; //max time a bundle waits in a partially filled batch
+    bool m_egressWorkerThreadPerOutduct; //true => each outduct is given bundles by its own egress worker thread
+    bool m_oneProcessDirectOutductForward; //true => hdtn-one-process ingress gives non-custody cut-through bundles straight to the outduct
+    bool m_ingressAdmissionControl; //true => ingress drops expired bundles, and low priority bundles early when overloaded (see IngressAdmissionController)
+    uint64_t m_ingressAdmissionStorageFullPercent; //bundles that are not expedited are not sent to storage once this full
+    uint64_t m_ingressAdmissionMaxBundlesPerSecondPerSource; //0 => no limit, otherwise normal priority bundles above this rate do not wait
+    uint64_t m_routerMaxMultipathRoutes; //0 or 1 => one next hop per final destination, otherwise egress splits bulk flows across the next hops of up to this many routes
     uint64_t m_maxLtpReceiveUdpPacketSizeBytes;
 
     uint64_t m_neighborDepletedStorageDelaySeconds;
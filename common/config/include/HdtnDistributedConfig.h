@@ -102,6 +102,13 @@ public:
     uint16_t m_zmqConnectingTelemToFromBoundEgressPortPath;
     uint16_t m_zmqConnectingTelemToFromBoundStoragePortPath;
     uint16_t m_zmqConnectingTelemToFromBoundRouterPortPath;
+
+    //true => ingress (to egress and storage) and storage (to egress) send bundles through shared memory (modules must be on the same host)
+    bool m_sharedMemoryBundleTransport;
+    //per sending module, the number of bundles in flight through shared memory (more go through the zmq sockets)
+    uint32_t m_sharedMemoryNumSlots;
+    //larger bundles go through the zmq sockets
+    uint64_t m_sharedMemorySlotSizeBytes;
 };
 
 #endif // HDTN_DISTRIBUTED_CONFIG_H
@@ -41,6 +41,11 @@ struct outduct_element_config_t {
     uint16_t remotePort;
     uint32_t maxNumberOfBundlesInPipeline;
     uint64_t maxSumOfBundleBytesInPipeline;
+
+    //egress scheduler in front of the outduct's Forward (only used with an egress worker thread for this outduct)
+    std::string egressScheduler; //"fifo" (default, arrival order), "priority" (strict by bundle priority) or "drr" (weighted deficit round robin over flows)
+    uint64_t egressSchedulerQuantumBytes; //drr only: bytes per round of a bulk priority flow (normal = 2x, expedited = 4x)
+    uint32_t egressSchedulerMaxBundlesInOutduct; //bundles given to the outduct but not yet sent, beyond which the scheduler holds them (0 => half of maxNumberOfBundlesInPipeline)
     
     //specific to bp over encap
     std::string bpEncapLocalSocketOrPipePath;
@@ -35,11 +35,12 @@
 struct storage_disk_config_t {
     std::string name;
     std::string storeFilePath;
+    bool useDirectIo; //bypass the OS page cache for this disk (O_DIRECT on Linux)
 
     CONFIG_LIB_EXPORT storage_disk_config_t();
     CONFIG_LIB_EXPORT ~storage_disk_config_t();
 
-    CONFIG_LIB_EXPORT storage_disk_config_t(const std::string & paramName, const std::string & paramStoreFilePath);
+    CONFIG_LIB_EXPORT storage_disk_config_t(const std::string & paramName, const std::string & paramStoreFilePath, bool paramUseDirectIo = false);
     CONFIG_LIB_EXPORT bool operator==(const storage_disk_config_t & other) const;
 
 
@@ -90,7 +91,7 @@ public:
     CONFIG_LIB_EXPORT virtual boost::property_tree::ptree GetNewPropertyTree() const override;
     CONFIG_LIB_EXPORT virtual bool SetValuesFromPropertyTree(const boost::property_tree::ptree & pt) override;
 
-    CONFIG_LIB_EXPORT void AddDisk(const std::string & name, const std::string & storeFilePath);
+    CONFIG_LIB_EXPORT void AddDisk(const std::string & name, const std::string & storeFilePath, bool useDirectIo = false);
 public:
 
     std::string m_storageImplementation;
@@ -99,6 +100,9 @@ public:
     uint64_t m_totalStorageCapacityBytes;
     std::string m_storageDeletionPolicy;
     storage_disk_config_vector_t m_storageDiskConfigVector;
+    std::string m_catalogJournalFilePath; //empty to disable, else the catalog journal path (the snapshot is stored alongside it with a .snapshot extension)
+    uint64_t m_catalogSnapshotIntervalRecords; //compact the catalog journal into a new snapshot after this many journal records
+    uint64_t m_ramCacheCapacityBytes; //0 to disable, else the maximum bundle bytes held in RAM before being written to disk (custody bundles always go to disk)
 };
 
 #endif // STORAGE_CONFIG_H
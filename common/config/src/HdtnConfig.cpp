@@ -38,6 +38,15 @@ HdtnConfig::HdtnConfig() :
     m_maxBundleSizeBytes(10000000), //10MB
     m_maxIngressBundleWaitOnEgressMilliseconds(2000),
     m_bufferRxToStorageOnLinkUpSaturation(false),
+    m_numIngressWorkerThreads(0),
+    m_maxIngressBatchBundles(0),
+    m_ingressBatchLatencyMicroseconds(1000),
+    m_egressWorkerThreadPerOutduct(false),
+    m_oneProcessDirectOutductForward(false),
+    m_ingressAdmissionControl(false),
+    m_ingressAdmissionStorageFullPercent(90),
+    m_ingressAdmissionMaxBundlesPerSecondPerSource(0),
+    m_routerMaxMultipathRoutes(0),
     m_maxLtpReceiveUdpPacketSizeBytes(65536),
     m_neighborDepletedStorageDelaySeconds(0),
     m_fragmentBundlesLargerThanBytes(0),
@@ -69,6 +78,15 @@ HdtnConfig::HdtnConfig(const HdtnConfig& o) :
     m_maxBundleSizeBytes(o.m_maxBundleSizeBytes),
     m_maxIngressBundleWaitOnEgressMilliseconds(o.m_maxIngressBundleWaitOnEgressMilliseconds),
     m_bufferRxToStorageOnLinkUpSaturation(o.m_bufferRxToStorageOnLinkUpSaturation),
+    m_numIngressWorkerThreads(o.m_numIngressWorkerThreads),
+    m_maxIngressBatchBundles(o.m_maxIngressBatchBundles),
+    m_ingressBatchLatencyMicroseconds(o.m_ingressBatchLatencyMicroseconds),
+    m_egressWorkerThreadPerOutduct(o.m_egressWorkerThreadPerOutduct),
+    m_oneProcessDirectOutductForward(o.m_oneProcessDirectOutductForward),
+    m_ingressAdmissionControl(o.m_ingressAdmissionControl),
+    m_ingressAdmissionStorageFullPercent(o.m_ingressAdmissionStorageFullPercent),
+    m_ingressAdmissionMaxBundlesPerSecondPerSource(o.m_ingressAdmissionMaxBundlesPerSecondPerSource),
+    m_routerMaxMultipathRoutes(o.m_routerMaxMultipathRoutes),
     m_maxLtpReceiveUdpPacketSizeBytes(o.m_maxLtpReceiveUdpPacketSizeBytes),
     m_neighborDepletedStorageDelaySeconds(o.m_neighborDepletedStorageDelaySeconds),
     m_fragmentBundlesLargerThanBytes(o.m_fragmentBundlesLargerThanBytes),
@@ -97,6 +115,15 @@ HdtnConfig::HdtnConfig(HdtnConfig&& o) noexcept :
     m_maxBundleSizeBytes(o.m_maxBundleSizeBytes),
     m_maxIngressBundleWaitOnEgressMilliseconds(o.m_maxIngressBundleWaitOnEgressMilliseconds),
     m_bufferRxToStorageOnLinkUpSaturation(o.m_bufferRxToStorageOnLinkUpSaturation),
+    m_numIngressWorkerThreads(o.m_numIngressWorkerThreads),
+    m_maxIngressBatchBundles(o.m_maxIngressBatchBundles),
+    m_ingressBatchLatencyMicroseconds(o.m_ingressBatchLatencyMicroseconds),
+    m_egressWorkerThreadPerOutduct(o.m_egressWorkerThreadPerOutduct),
+    m_oneProcessDirectOutductForward(o.m_oneProcessDirectOutductForward),
+    m_ingressAdmissionControl(o.m_ingressAdmissionControl),
+    m_ingressAdmissionStorageFullPercent(o.m_ingressAdmissionStorageFullPercent),
+    m_ingressAdmissionMaxBundlesPerSecondPerSource(o.m_ingressAdmissionMaxBundlesPerSecondPerSource),
+    m_routerMaxMultipathRoutes(o.m_routerMaxMultipathRoutes),
     m_maxLtpReceiveUdpPacketSizeBytes(o.m_maxLtpReceiveUdpPacketSizeBytes),
     m_neighborDepletedStorageDelaySeconds(o.m_neighborDepletedStorageDelaySeconds),
     m_fragmentBundlesLargerThanBytes(o.m_fragmentBundlesLargerThanBytes),
@@ -125,6 +152,15 @@ HdtnConfig& HdtnConfig::operator=(const HdtnConfig& o) {
     m_maxBundleSizeBytes = o.m_maxBundleSizeBytes;
     m_maxIngressBundleWaitOnEgressMilliseconds = o.m_maxIngressBundleWaitOnEgressMilliseconds;
     m_bufferRxToStorageOnLinkUpSaturation = o.m_bufferRxToStorageOnLinkUpSaturation;
+    m_numIngressWorkerThreads = o.m_numIngressWorkerThreads;
+    m_maxIngressBatchBundles = o.m_maxIngressBatchBundles;
+    m_ingressBatchLatencyMicroseconds = o.m_ingressBatchLatencyMicroseconds;
+    m_egressWorkerThreadPerOutduct = o.m_egressWorkerThreadPerOutduct;
+    m_oneProcessDirectOutductForward = o.m_oneProcessDirectOutductForward;
+    m_ingressAdmissionControl = o.m_ingressAdmissionControl;
+    m_ingressAdmissionStorageFullPercent = o.m_ingressAdmissionStorageFullPercent;
+    m_ingressAdmissionMaxBundlesPerSecondPerSource = o.m_ingressAdmissionMaxBundlesPerSecondPerSource;
+    m_routerMaxMultipathRoutes = o.m_routerMaxMultipathRoutes;
     m_maxLtpReceiveUdpPacketSizeBytes = o.m_maxLtpReceiveUdpPacketSizeBytes;
     m_neighborDepletedStorageDelaySeconds = o.m_neighborDepletedStorageDelaySeconds;
     m_fragmentBundlesLargerThanBytes = o.m_fragmentBundlesLargerThanBytes;
@@ -154,6 +190,15 @@ HdtnConfig& HdtnConfig::operator=(HdtnConfig&& o) noexcept {
     m_maxBundleSizeBytes = o.m_maxBundleSizeBytes;
     m_maxIngressBundleWaitOnEgressMilliseconds = o.m_maxIngressBundleWaitOnEgressMilliseconds;
     m_bufferRxToStorageOnLinkUpSaturation = o.m_bufferRxToStorageOnLinkUpSaturation;
+    m_numIngressWorkerThreads = o.m_numIngressWorkerThreads;
+    m_maxIngressBatchBundles = o.m_maxIngressBatchBundles;
+    m_ingressBatchLatencyMicroseconds = o.m_ingressBatchLatencyMicroseconds;
+    m_egressWorkerThreadPerOutduct = o.m_egressWorkerThreadPerOutduct;
+    m_oneProcessDirectOutductForward = o.m_oneProcessDirectOutductForward;
+    m_ingressAdmissionControl = o.m_ingressAdmissionControl;
+    m_ingressAdmissionStorageFullPercent = o.m_ingressAdmissionStorageFullPercent;
+    m_ingressAdmissionMaxBundlesPerSecondPerSource = o.m_ingressAdmissionMaxBundlesPerSecondPerSource;
+    m_routerMaxMultipathRoutes = o.m_routerMaxMultipathRoutes;
     m_maxLtpReceiveUdpPacketSizeBytes = o.m_maxLtpReceiveUdpPacketSizeBytes;
     m_neighborDepletedStorageDelaySeconds = o.m_neighborDepletedStorageDelaySeconds;
     m_fragmentBundlesLargerThanBytes = o.m_fragmentBundlesLargerThanBytes;
@@ -182,6 +227,15 @@ bool HdtnConfig::operator==(const HdtnConfig & o) const {
         (m_maxBundleSizeBytes == o.m_maxBundleSizeBytes) &&
         (m_maxIngressBundleWaitOnEgressMilliseconds == o.m_maxIngressBundleWaitOnEgressMilliseconds) &&
         (m_bufferRxToStorageOnLinkUpSaturation == o.m_bufferRxToStorageOnLinkUpSaturation) &&
+        (m_numIngressWorkerThreads == o.m_numIngressWorkerThreads) &&
+        (m_maxIngressBatchBundles == o.m_maxIngressBatchBundles) &&
+        (m_ingressBatchLatencyMicroseconds == o.m_ingressBatchLatencyMicroseconds) &&
+        (m_egressWorkerThreadPerOutduct == o.m_egressWorkerThreadPerOutduct) &&
+        (m_oneProcessDirectOutductForward == o.m_oneProcessDirectOutductForward) &&
+        (m_ingressAdmissionControl == o.m_ingressAdmissionControl) &&
+        (m_ingressAdmissionStorageFullPercent == o.m_ingressAdmissionStorageFullPercent) &&
+        (m_ingressAdmissionMaxBundlesPerSecondPerSource == o.m_ingressAdmissionMaxBundlesPerSecondPerSource) &&
+        (m_routerMaxMultipathRoutes == o.m_routerMaxMultipathRoutes) &&
         (m_maxLtpReceiveUdpPacketSizeBytes == o.m_maxLtpReceiveUdpPacketSizeBytes) &&
         (m_neighborDepletedStorageDelaySeconds == o.m_neighborDepletedStorageDelaySeconds) &&
         (m_fragmentBundlesLargerThanBytes == o.m_fragmentBundlesLargerThanBytes) &&
@@ -218,6 +272,15 @@ bool HdtnConfig::SetValuesFromPropertyTree(const boost::property_tree::ptree & p
         m_maxBundleSizeBytes = pt.get<uint64_t>("maxBundleSizeBytes");
         m_maxIngressBundleWaitOnEgressMilliseconds = pt.get<uint64_t>("maxIngressBundleWaitOnEgressMilliseconds");
         m_bufferRxToStorageOnLinkUpSaturation = pt.get<bool>("bufferRxToStorageOnLinkUpSaturation");
+        m_numIngressWorkerThreads = pt.get<uint64_t>("numIngressWorkerThreads", 0); //optional, 0 processes bundles on the induct threads
+        m_maxIngressBatchBundles = pt.get<uint64_t>("maxIngressBatchBundles", 0); //optional, 0 or 1 sends one bundle per zmq message
+        m_ingressBatchLatencyMicroseconds = pt.get<uint64_t>("ingressBatchLatencyMicroseconds", 1000); //optional
+        m_egressWorkerThreadPerOutduct = pt.get<bool>("egressWorkerThreadPerOutduct", false); //optional, false forwards every bundle on the egress reader thread
+        m_oneProcessDirectOutductForward = pt.get<bool>("oneProcessDirectOutductForward", false); //optional, only used by hdtn-one-process
+        m_ingressAdmissionControl = pt.get<bool>("ingressAdmissionControl", false); //optional, false => every bundle waits for the pipelines
+        m_ingressAdmissionStorageFullPercent = pt.get<uint64_t>("ingressAdmissionStorageFullPercent", 90); //optional
+        m_ingressAdmissionMaxBundlesPerSecondPerSource = pt.get<uint64_t>("ingressAdmissionMaxBundlesPerSecondPerSource", 0); //optional
+        m_routerMaxMultipathRoutes = pt.get<uint64_t>("routerMaxMultipathRoutes", 0); //optional, 0 or 1 routes every bundle to a final destination through one next hop
         m_maxLtpReceiveUdpPacketSizeBytes = pt.get<uint64_t>("maxLtpReceiveUdpPacketSizeBytes");
         m_neighborDepletedStorageDelaySeconds = pt.get<uint64_t>("neighborDepletedStorageDelaySeconds");
         m_fragmentBundlesLargerThanBytes = pt.get<uint64_t>("fragmentBundlesLargerThanBytes");
@@ -318,6 +381,15 @@ boost::property_tree::ptree HdtnConfig::GetNewPropertyTree() const {
     pt.put("maxBundleSizeBytes", m_maxBundleSizeBytes);
     pt.put("maxIngressBundleWaitOnEgressMilliseconds", m_maxIngressBundleWaitOnEgressMilliseconds);
     pt.put("bufferRxToStorageOnLinkUpSaturation", m_bufferRxToStorageOnLinkUpSaturation);
+    pt.put("numIngressWorkerThreads", m_numIngressWorkerThreads);
+    pt.put("maxIngressBatchBundles", m_maxIngressBatchBundles);
+    pt.put("ingressBatchLatencyMicroseconds", m_ingressBatchLatencyMicroseconds);
+    pt.put("egressWorkerThreadPerOutduct", m_egressWorkerThreadPerOutduct);
+    pt.put("oneProcessDirectOutductForward", m_oneProcessDirectOutductForward);
+    pt.put("ingressAdmissionControl", m_ingressAdmissionControl);
+    pt.put("ingressAdmissionStorageFullPercent", m_ingressAdmissionStorageFullPercent);
+    pt.put("ingressAdmissionMaxBundlesPerSecondPerSource", m_ingressAdmissionMaxBundlesPerSecondPerSource);
+    pt.put("routerMaxMultipathRoutes", m_routerMaxMultipathRoutes);
     pt.put("maxLtpReceiveUdpPacketSizeBytes", m_maxLtpReceiveUdpPacketSizeBytes);
     pt.put("neighborDepletedStorageDelaySeconds", m_neighborDepletedStorageDelaySeconds);
     pt.put("fragmentBundlesLargerThanBytes", m_fragmentBundlesLargerThanBytes);
@@ -40,7 +40,10 @@ HdtnDistributedConfig::HdtnDistributedConfig() :
     m_zmqConnectingTelemToFromBoundIngressPortPath(10301),
     m_zmqConnectingTelemToFromBoundEgressPortPath(10302),
     m_zmqConnectingTelemToFromBoundStoragePortPath(10303),
-    m_zmqConnectingTelemToFromBoundRouterPortPath(10304)
+    m_zmqConnectingTelemToFromBoundRouterPortPath(10304),
+    m_sharedMemoryBundleTransport(false),
+    m_sharedMemoryNumSlots(128),
+    m_sharedMemorySlotSizeBytes(1048576)
 {}
 
 HdtnDistributedConfig::~HdtnDistributedConfig() {
@@ -65,7 +68,10 @@ HdtnDistributedConfig::HdtnDistributedConfig(const HdtnDistributedConfig& o) :
     m_zmqConnectingTelemToFromBoundIngressPortPath(o.m_zmqConnectingTelemToFromBoundIngressPortPath),
     m_zmqConnectingTelemToFromBoundEgressPortPath(o.m_zmqConnectingTelemToFromBoundEgressPortPath),
     m_zmqConnectingTelemToFromBoundStoragePortPath(o.m_zmqConnectingTelemToFromBoundStoragePortPath),
-    m_zmqConnectingTelemToFromBoundRouterPortPath(o.m_zmqConnectingTelemToFromBoundRouterPortPath)
+    m_zmqConnectingTelemToFromBoundRouterPortPath(o.m_zmqConnectingTelemToFromBoundRouterPortPath),
+    m_sharedMemoryBundleTransport(o.m_sharedMemoryBundleTransport),
+    m_sharedMemoryNumSlots(o.m_sharedMemoryNumSlots),
+    m_sharedMemorySlotSizeBytes(o.m_sharedMemorySlotSizeBytes)
 { }
 
 //a move constructor: X(X&&)
@@ -87,7 +93,10 @@ HdtnDistributedConfig::HdtnDistributedConfig(HdtnDistributedConfig&& o) noexcept
     m_zmqConnectingTelemToFromBoundIngressPortPath(o.m_zmqConnectingTelemToFromBoundIngressPortPath),
     m_zmqConnectingTelemToFromBoundEgressPortPath(o.m_zmqConnectingTelemToFromBoundEgressPortPath),
     m_zmqConnectingTelemToFromBoundStoragePortPath(o.m_zmqConnectingTelemToFromBoundStoragePortPath),
-    m_zmqConnectingTelemToFromBoundRouterPortPath(o.m_zmqConnectingTelemToFromBoundRouterPortPath)
+    m_zmqConnectingTelemToFromBoundRouterPortPath(o.m_zmqConnectingTelemToFromBoundRouterPortPath),
+    m_sharedMemoryBundleTransport(o.m_sharedMemoryBundleTransport),
+    m_sharedMemoryNumSlots(o.m_sharedMemoryNumSlots),
+    m_sharedMemorySlotSizeBytes(o.m_sharedMemorySlotSizeBytes)
 { }
 
 //a copy assignment: operator=(const X&)
@@ -110,6 +119,9 @@ HdtnDistributedConfig& HdtnDistributedConfig::operator=(const HdtnDistributedCon
     m_zmqConnectingTelemToFromBoundEgressPortPath = o.m_zmqConnectingTelemToFromBoundEgressPortPath;
     m_zmqConnectingTelemToFromBoundStoragePortPath = o.m_zmqConnectingTelemToFromBoundStoragePortPath;
     m_zmqConnectingTelemToFromBoundRouterPortPath = o.m_zmqConnectingTelemToFromBoundRouterPortPath;
+    m_sharedMemoryBundleTransport = o.m_sharedMemoryBundleTransport;
+    m_sharedMemoryNumSlots = o.m_sharedMemoryNumSlots;
+    m_sharedMemorySlotSizeBytes = o.m_sharedMemorySlotSizeBytes;
     return *this;
 }
 
@@ -133,6 +145,9 @@ HdtnDistributedConfig& HdtnDistributedConfig::operator=(HdtnDistributedConfig&&
     m_zmqConnectingTelemToFromBoundEgressPortPath = o.m_zmqConnectingTelemToFromBoundEgressPortPath;
     m_zmqConnectingTelemToFromBoundStoragePortPath = o.m_zmqConnectingTelemToFromBoundStoragePortPath;
     m_zmqConnectingTelemToFromBoundRouterPortPath = o.m_zmqConnectingTelemToFromBoundRouterPortPath;
+    m_sharedMemoryBundleTransport = o.m_sharedMemoryBundleTransport;
+    m_sharedMemoryNumSlots = o.m_sharedMemoryNumSlots;
+    m_sharedMemorySlotSizeBytes = o.m_sharedMemorySlotSizeBytes;
     return *this;
 }
 
@@ -155,7 +170,10 @@ bool HdtnDistributedConfig::operator==(const HdtnDistributedConfig& o) const {
         (m_zmqConnectingTelemToFromBoundIngressPortPath == o.m_zmqConnectingTelemToFromBoundIngressPortPath) &&
         (m_zmqConnectingTelemToFromBoundEgressPortPath == o.m_zmqConnectingTelemToFromBoundEgressPortPath) &&
         (m_zmqConnectingTelemToFromBoundStoragePortPath == o.m_zmqConnectingTelemToFromBoundStoragePortPath) &&
-        (m_zmqConnectingTelemToFromBoundRouterPortPath == o.m_zmqConnectingTelemToFromBoundRouterPortPath);
+        (m_zmqConnectingTelemToFromBoundRouterPortPath == o.m_zmqConnectingTelemToFromBoundRouterPortPath) &&
+        (m_sharedMemoryBundleTransport == o.m_sharedMemoryBundleTransport) &&
+        (m_sharedMemoryNumSlots == o.m_sharedMemoryNumSlots) &&
+        (m_sharedMemorySlotSizeBytes == o.m_sharedMemorySlotSizeBytes);
 }
 
 bool HdtnDistributedConfig::SetValuesFromPropertyTree(const boost::property_tree::ptree & pt) {
@@ -178,11 +196,19 @@ bool HdtnDistributedConfig::SetValuesFromPropertyTree(const boost::property_tree
         m_zmqConnectingTelemToFromBoundEgressPortPath = pt.get<uint16_t>("zmqConnectingTelemToFromBoundEgressPortPath");
         m_zmqConnectingTelemToFromBoundStoragePortPath = pt.get<uint16_t>("zmqConnectingTelemToFromBoundStoragePortPath");
         m_zmqConnectingTelemToFromBoundRouterPortPath = pt.get<uint16_t>("zmqConnectingTelemToFromBoundRouterPortPath");
+        //optional, so that existing distributed configs need no change
+        m_sharedMemoryBundleTransport = pt.get<bool>("sharedMemoryBundleTransport", false);
+        m_sharedMemoryNumSlots = pt.get<uint32_t>("sharedMemoryNumSlots", 128);
+        m_sharedMemorySlotSizeBytes = pt.get<uint64_t>("sharedMemorySlotSizeBytes", 1048576);
     }
     catch (const boost::property_tree::ptree_error & e) {
         LOG_ERROR(subprocess) << "parsing JSON HDTN config: " << e.what();
         return false;
     }
+    if (m_sharedMemoryBundleTransport && ((m_sharedMemoryNumSlots == 0) || (m_sharedMemorySlotSizeBytes == 0))) {
+        LOG_ERROR(subprocess) << "parsing JSON HDTN distributed config: sharedMemoryNumSlots and sharedMemorySlotSizeBytes must be non-zero";
+        return false;
+    }
 
     return true;
 }
@@ -255,6 +281,9 @@ boost::property_tree::ptree HdtnDistributedConfig::GetNewPropertyTree() const {
     pt.put("zmqConnectingTelemToFromBoundEgressPortPath", m_zmqConnectingTelemToFromBoundEgressPortPath);
     pt.put("zmqConnectingTelemToFromBoundStoragePortPath", m_zmqConnectingTelemToFromBoundStoragePortPath);
     pt.put("zmqConnectingTelemToFromBoundRouterPortPath", m_zmqConnectingTelemToFromBoundRouterPortPath);
+    pt.put("sharedMemoryBundleTransport", m_sharedMemoryBundleTransport);
+    pt.put("sharedMemoryNumSlots", m_sharedMemoryNumSlots);
+    pt.put("sharedMemorySlotSizeBytes", m_sharedMemorySlotSizeBytes);
 
     return pt;
 }
@@ -15,6 +15,7 @@
 #include "OutductsConfig.h"
 #include "Logger.h"
 #include <memory>
+#include <algorithm>
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
 #include "Uri.h"
@@ -31,6 +32,9 @@ static const std::vector<std::string> VALID_CONVERGENCE_LAYER_NAMES = {
 
 static const uint64_t DEFAULT_RATE_LIMIT_PRECISION = 100000;
 
+static const std::vector<std::string> VALID_EGRESS_SCHEDULER_NAMES = { "fifo", "priority", "drr" };
+static const uint64_t DEFAULT_EGRESS_SCHEDULER_QUANTUM_BYTES = 1048576;
+
 outduct_element_config_t::outduct_element_config_t() :
     name(""),
     convergenceLayer(""),
@@ -39,6 +43,9 @@ outduct_element_config_t::outduct_element_config_t() :
     remotePort(0),
     maxNumberOfBundlesInPipeline(0),
     maxSumOfBundleBytesInPipeline(0),
+    egressScheduler("fifo"),
+    egressSchedulerQuantumBytes(DEFAULT_EGRESS_SCHEDULER_QUANTUM_BYTES),
+    egressSchedulerMaxBundlesInOutduct(0),
 
     bpEncapLocalSocketOrPipePath(""),
     
@@ -89,6 +96,9 @@ outduct_element_config_t::outduct_element_config_t(const outduct_element_config_
     remotePort(o.remotePort),
     maxNumberOfBundlesInPipeline(o.maxNumberOfBundlesInPipeline),
     maxSumOfBundleBytesInPipeline(o.maxSumOfBundleBytesInPipeline),
+    egressScheduler(o.egressScheduler),
+    egressSchedulerQuantumBytes(o.egressSchedulerQuantumBytes),
+    egressSchedulerMaxBundlesInOutduct(o.egressSchedulerMaxBundlesInOutduct),
 
     bpEncapLocalSocketOrPipePath(o.bpEncapLocalSocketOrPipePath),
     
@@ -136,6 +146,9 @@ outduct_element_config_t::outduct_element_config_t(outduct_element_config_t&& o)
     remotePort(o.remotePort),
     maxNumberOfBundlesInPipeline(o.maxNumberOfBundlesInPipeline),
     maxSumOfBundleBytesInPipeline(o.maxSumOfBundleBytesInPipeline),
+    egressScheduler(std::move(o.egressScheduler)),
+    egressSchedulerQuantumBytes(o.egressSchedulerQuantumBytes),
+    egressSchedulerMaxBundlesInOutduct(o.egressSchedulerMaxBundlesInOutduct),
 
     bpEncapLocalSocketOrPipePath(std::move(o.bpEncapLocalSocketOrPipePath)),
     
@@ -183,6 +196,9 @@ outduct_element_config_t& outduct_element_config_t::operator=(const outduct_elem
     remotePort = o.remotePort;
     maxNumberOfBundlesInPipeline = o.maxNumberOfBundlesInPipeline;
     maxSumOfBundleBytesInPipeline = o.maxSumOfBundleBytesInPipeline;
+    egressScheduler = o.egressScheduler;
+    egressSchedulerQuantumBytes = o.egressSchedulerQuantumBytes;
+    egressSchedulerMaxBundlesInOutduct = o.egressSchedulerMaxBundlesInOutduct;
 
     bpEncapLocalSocketOrPipePath = o.bpEncapLocalSocketOrPipePath;
     
@@ -233,6 +249,9 @@ outduct_element_config_t& outduct_element_config_t::operator=(outduct_element_co
     remotePort = o.remotePort;
     maxNumberOfBundlesInPipeline = o.maxNumberOfBundlesInPipeline;
     maxSumOfBundleBytesInPipeline = o.maxSumOfBundleBytesInPipeline;
+    egressScheduler = std::move(o.egressScheduler);
+    egressSchedulerQuantumBytes = o.egressSchedulerQuantumBytes;
+    egressSchedulerMaxBundlesInOutduct = o.egressSchedulerMaxBundlesInOutduct;
 
     bpEncapLocalSocketOrPipePath = std::move(o.bpEncapLocalSocketOrPipePath);
 
@@ -282,6 +301,9 @@ bool outduct_element_config_t::operator==(const outduct_element_config_t & o) co
         (remotePort == o.remotePort) &&
         (maxNumberOfBundlesInPipeline == o.maxNumberOfBundlesInPipeline) &&
         (maxSumOfBundleBytesInPipeline == o.maxSumOfBundleBytesInPipeline) &&
+        (egressScheduler == o.egressScheduler) &&
+        (egressSchedulerQuantumBytes == o.egressSchedulerQuantumBytes) &&
+        (egressSchedulerMaxBundlesInOutduct == o.egressSchedulerMaxBundlesInOutduct) &&
 
         (bpEncapLocalSocketOrPipePath == o.bpEncapLocalSocketOrPipePath) &&
         
@@ -403,6 +425,25 @@ bool OutductsConfig::SetValuesFromPropertyTree(const boost::property_tree::ptree
             }
             outductElementConfig.maxNumberOfBundlesInPipeline = outductElementConfigPt.second.get<uint32_t>("maxNumberOfBundlesInPipeline");
             outductElementConfig.maxSumOfBundleBytesInPipeline = outductElementConfigPt.second.get<uint64_t>("maxSumOfBundleBytesInPipeline");
+            outductElementConfig.egressScheduler = outductElementConfigPt.second.get<std::string>("egressScheduler", "fifo");
+            if (std::find(VALID_EGRESS_SCHEDULER_NAMES.cbegin(), VALID_EGRESS_SCHEDULER_NAMES.cend(), outductElementConfig.egressScheduler) == VALID_EGRESS_SCHEDULER_NAMES.cend()) {
+                LOG_ERROR(subprocess) << "error parsing JSON outductVector[" << (vectorIndex - 1) << "]: " << "invalid egressScheduler " << outductElementConfig.egressScheduler
+                    << ", must be fifo, priority, or drr";
+                return false;
+            }
+            if (outductElementConfig.egressScheduler != "fifo") {
+                outductElementConfig.egressSchedulerQuantumBytes = outductElementConfigPt.second.get<uint64_t>("egressSchedulerQuantumBytes", DEFAULT_EGRESS_SCHEDULER_QUANTUM_BYTES);
+                if (outductElementConfig.egressSchedulerQuantumBytes == 0) {
+                    LOG_ERROR(subprocess) << "error parsing JSON outductVector[" << (vectorIndex - 1) << "]: egressSchedulerQuantumBytes must be greater than 0";
+                    return false;
+                }
+                outductElementConfig.egressSchedulerMaxBundlesInOutduct = outductElementConfigPt.second.get<uint32_t>("egressSchedulerMaxBundlesInOutduct", 0);
+            }
+            else if ((outductElementConfigPt.second.count("egressSchedulerQuantumBytes") != 0) || (outductElementConfigPt.second.count("egressSchedulerMaxBundlesInOutduct") != 0)) {
+                LOG_ERROR(subprocess) << "error parsing JSON outductVector[" << (vectorIndex - 1) << "]: egressSchedulerQuantumBytes and egressSchedulerMaxBundlesInOutduct"
+                    << " are only used when egressScheduler is not fifo.. please remove";
+                return false;
+            }
 
             if ((outductElementConfig.convergenceLayer == "ltp_over_udp")
                 || (outductElementConfig.convergenceLayer == "ltp_over_ipc")
@@ -623,6 +664,11 @@ boost::property_tree::ptree OutductsConfig::GetNewPropertyTree() const {
         }
         outductElementConfigPt.put("maxNumberOfBundlesInPipeline", outductElementConfig.maxNumberOfBundlesInPipeline);
         outductElementConfigPt.put("maxSumOfBundleBytesInPipeline", outductElementConfig.maxSumOfBundleBytesInPipeline);
+        if (outductElementConfig.egressScheduler != "fifo") { //fifo (the default) is omitted
+            outductElementConfigPt.put("egressScheduler", outductElementConfig.egressScheduler);
+            outductElementConfigPt.put("egressSchedulerQuantumBytes", outductElementConfig.egressSchedulerQuantumBytes);
+            outductElementConfigPt.put("egressSchedulerMaxBundlesInOutduct", outductElementConfig.egressSchedulerMaxBundlesInOutduct);
+        }
         
         if ((outductElementConfig.convergenceLayer == "ltp_over_udp")
             || (outductElementConfig.convergenceLayer == "ltp_over_ipc")
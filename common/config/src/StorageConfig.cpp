@@ -19,27 +19,32 @@
 
 static constexpr hdtn::Logger::SubProcess subprocess = hdtn::Logger::SubProcess::none;
 
-static const std::vector<std::string> VALID_STORAGE_IMPLEMENTATION_NAMES = { "stdio_multi_threaded", "asio_single_threaded" };
+static const std::vector<std::string> VALID_STORAGE_IMPLEMENTATION_NAMES = { "stdio_multi_threaded", "asio_single_threaded"
+#ifdef STORAGE_IO_URING_ENABLED
+    , "io_uring_multi_threaded"
+#endif
+};
 static const std::vector<std::string> VALID_STORAGE_DELETION_POLICIES = { "never", "on_expiration", "on_storage_full" };
 
-storage_disk_config_t::storage_disk_config_t() : name(""), storeFilePath("") {}
+storage_disk_config_t::storage_disk_config_t() : name(""), storeFilePath(""), useDirectIo(false) {}
 storage_disk_config_t::~storage_disk_config_t() {}
 
-storage_disk_config_t::storage_disk_config_t(const std::string & paramName, const std::string & paramStoreFilePath) :
-    name(paramName), storeFilePath(paramStoreFilePath) {}
+storage_disk_config_t::storage_disk_config_t(const std::string & paramName, const std::string & paramStoreFilePath, bool paramUseDirectIo) :
+    name(paramName), storeFilePath(paramStoreFilePath), useDirectIo(paramUseDirectIo) {}
 
 //a copy constructor: X(const X&)
 storage_disk_config_t::storage_disk_config_t(const storage_disk_config_t& o) :
-    name(o.name), storeFilePath(o.storeFilePath) { }
+    name(o.name), storeFilePath(o.storeFilePath), useDirectIo(o.useDirectIo) { }
 
 //a move constructor: X(X&&)
 storage_disk_config_t::storage_disk_config_t(storage_disk_config_t&& o) noexcept :
-    name(std::move(o.name)), storeFilePath(std::move(o.storeFilePath)) { }
+    name(std::move(o.name)), storeFilePath(std::move(o.storeFilePath)), useDirectIo(o.useDirectIo) { }
 
 //a copy assignment: operator=(const X&)
 storage_disk_config_t& storage_disk_config_t::operator=(const storage_disk_config_t& o) {
     name = o.name;
     storeFilePath = o.storeFilePath;
+    useDirectIo = o.useDirectIo;
     return *this;
 }
 
@@ -47,11 +52,12 @@ storage_disk_config_t& storage_disk_config_t::operator=(const storage_disk_confi
 storage_disk_config_t& storage_disk_config_t::operator=(storage_disk_config_t&& o) noexcept {
     name = std::move(o.name);
     storeFilePath = std::move(o.storeFilePath);
+    useDirectIo = o.useDirectIo;
     return *this;
 }
 
 bool storage_disk_config_t::operator==(const storage_disk_config_t & other) const {
-    return (name == other.name) && (storeFilePath == other.storeFilePath);
+    return (name == other.name) && (storeFilePath == other.storeFilePath) && (useDirectIo == other.useDirectIo);
 }
 
 StorageConfig::StorageConfig() :
@@ -60,7 +66,10 @@ StorageConfig::StorageConfig() :
     m_autoDeleteFilesOnExit(true),
     m_totalStorageCapacityBytes(1),
     m_storageDeletionPolicy("never"),
-    m_storageDiskConfigVector() { }
+    m_storageDiskConfigVector(),
+    m_catalogJournalFilePath(""),
+    m_catalogSnapshotIntervalRecords(100000),
+    m_ramCacheCapacityBytes(0) { }
 
 StorageConfig::~StorageConfig() {
 }
@@ -72,7 +81,10 @@ StorageConfig::StorageConfig(const StorageConfig& o) :
     m_autoDeleteFilesOnExit(o.m_autoDeleteFilesOnExit),
     m_totalStorageCapacityBytes(o.m_totalStorageCapacityBytes),
     m_storageDeletionPolicy(o.m_storageDeletionPolicy),
-    m_storageDiskConfigVector(o.m_storageDiskConfigVector) { }
+    m_storageDiskConfigVector(o.m_storageDiskConfigVector),
+    m_catalogJournalFilePath(o.m_catalogJournalFilePath),
+    m_catalogSnapshotIntervalRecords(o.m_catalogSnapshotIntervalRecords),
+    m_ramCacheCapacityBytes(o.m_ramCacheCapacityBytes) { }
 
 //a move constructor: X(X&&)
 StorageConfig::StorageConfig(StorageConfig&& o) noexcept :
@@ -81,7 +93,10 @@ StorageConfig::StorageConfig(StorageConfig&& o) noexcept :
     m_autoDeleteFilesOnExit(o.m_autoDeleteFilesOnExit),
     m_totalStorageCapacityBytes(o.m_totalStorageCapacityBytes),
     m_storageDeletionPolicy(std::move(o.m_storageDeletionPolicy)),
-    m_storageDiskConfigVector(std::move(o.m_storageDiskConfigVector)) { }
+    m_storageDiskConfigVector(std::move(o.m_storageDiskConfigVector)),
+    m_catalogJournalFilePath(std::move(o.m_catalogJournalFilePath)),
+    m_catalogSnapshotIntervalRecords(o.m_catalogSnapshotIntervalRecords),
+    m_ramCacheCapacityBytes(o.m_ramCacheCapacityBytes) { }
 
 //a copy assignment: operator=(const X&)
 StorageConfig& StorageConfig::operator=(const StorageConfig& o) {
@@ -91,6 +106,9 @@ StorageConfig& StorageConfig::operator=(const StorageConfig& o) {
     m_totalStorageCapacityBytes = o.m_totalStorageCapacityBytes;
     m_storageDeletionPolicy = o.m_storageDeletionPolicy;
     m_storageDiskConfigVector = o.m_storageDiskConfigVector;
+    m_catalogJournalFilePath = o.m_catalogJournalFilePath;
+    m_catalogSnapshotIntervalRecords = o.m_catalogSnapshotIntervalRecords;
+    m_ramCacheCapacityBytes = o.m_ramCacheCapacityBytes;
     return *this;
 }
 
@@ -102,6 +120,9 @@ StorageConfig& StorageConfig::operator=(StorageConfig&& o) noexcept {
     m_totalStorageCapacityBytes = o.m_totalStorageCapacityBytes;
     m_storageDeletionPolicy = std::move(o.m_storageDeletionPolicy);
     m_storageDiskConfigVector = std::move(o.m_storageDiskConfigVector);
+    m_catalogJournalFilePath = std::move(o.m_catalogJournalFilePath);
+    m_catalogSnapshotIntervalRecords = o.m_catalogSnapshotIntervalRecords;
+    m_ramCacheCapacityBytes = o.m_ramCacheCapacityBytes;
     return *this;
 }
 
@@ -112,7 +133,10 @@ bool StorageConfig::operator==(const StorageConfig & other) const {
         (m_autoDeleteFilesOnExit == other.m_autoDeleteFilesOnExit) &&
         (m_totalStorageCapacityBytes == other.m_totalStorageCapacityBytes) &&
         (m_storageDeletionPolicy == other.m_storageDeletionPolicy) &&
-        (m_storageDiskConfigVector == other.m_storageDiskConfigVector);
+        (m_storageDiskConfigVector == other.m_storageDiskConfigVector) &&
+        (m_catalogJournalFilePath == other.m_catalogJournalFilePath) &&
+        (m_catalogSnapshotIntervalRecords == other.m_catalogSnapshotIntervalRecords) &&
+        (m_ramCacheCapacityBytes == other.m_ramCacheCapacityBytes);
 }
 
 bool StorageConfig::SetValuesFromPropertyTree(const boost::property_tree::ptree & pt) {
@@ -127,6 +151,13 @@ bool StorageConfig::SetValuesFromPropertyTree(const boost::property_tree::ptree
                 }
             }
             if (!found) {
+#ifndef STORAGE_IO_URING_ENABLED
+                if (m_storageImplementation == "io_uring_multi_threaded") {
+                    LOG_ERROR(subprocess) << "error parsing JSON Storage config:: storage implementation " << m_storageImplementation
+                        << " requires a Linux build with liburing (STORAGE_IO_URING_ENABLED)";
+                    return false;
+                }
+#endif
                 LOG_ERROR(subprocess) << "error parsing JSON Storage config:: invalid storage implementation " << m_storageImplementation;
                 return false;
             }
@@ -148,6 +179,9 @@ bool StorageConfig::SetValuesFromPropertyTree(const boost::property_tree::ptree
         m_tryToRestoreFromDisk = pt.get<bool>("tryToRestoreFromDisk");
         m_autoDeleteFilesOnExit = pt.get<bool>("autoDeleteFilesOnExit");
         m_totalStorageCapacityBytes = pt.get<uint64_t>("totalStorageCapacityBytes");
+        m_catalogJournalFilePath = pt.get<std::string>("catalogJournalFilePath", ""); //optional, empty disables the catalog journal
+        m_catalogSnapshotIntervalRecords = pt.get<uint64_t>("catalogSnapshotIntervalRecords", 100000); //optional
+        m_ramCacheCapacityBytes = pt.get<uint64_t>("ramCacheCapacityBytes", 0); //optional, 0 disables the RAM cache
     }
     catch (const boost::property_tree::ptree_error & e) {
         LOG_ERROR(subprocess) << "error parsing JSON Storage config: " << e.what();
@@ -158,6 +192,10 @@ bool StorageConfig::SetValuesFromPropertyTree(const boost::property_tree::ptree
         LOG_ERROR(subprocess) << "error parsing JSON Storage config: totalStorageCapacityBytes must be defined and non-zero";
         return false;
     }
+    if (m_catalogSnapshotIntervalRecords == 0) {
+        LOG_ERROR(subprocess) << "error parsing JSON Storage config: catalogSnapshotIntervalRecords must be non-zero";
+        return false;
+    }
 
     //for non-throw versions of get_child which return a reference to the second parameter
     static const boost::property_tree::ptree EMPTY_PTREE;
@@ -170,6 +208,7 @@ bool StorageConfig::SetValuesFromPropertyTree(const boost::property_tree::ptree
         try {
             storageDiskConfig.name = storageDiskConfigPt.second.get<std::string>("name");
             storageDiskConfig.storeFilePath = storageDiskConfigPt.second.get<std::string>("storeFilePath");
+            storageDiskConfig.useDirectIo = storageDiskConfigPt.second.get<bool>("useDirectIo", false); //optional, defaults to page cached I/O
         }
         catch (const boost::property_tree::ptree_error & e) {
             LOG_ERROR(subprocess) << "error parsing JSON storageDiskConfigVector[" << (storageDiskConfigVectorIndex - 1) << "]: " << e.what();
@@ -234,18 +273,22 @@ boost::property_tree::ptree StorageConfig::GetNewPropertyTree() const {
     pt.put("autoDeleteFilesOnExit", m_autoDeleteFilesOnExit);
     pt.put("totalStorageCapacityBytes", m_totalStorageCapacityBytes);
     pt.put("storageDeletionPolicy", m_storageDeletionPolicy);
+    pt.put("catalogJournalFilePath", m_catalogJournalFilePath);
+    pt.put("catalogSnapshotIntervalRecords", m_catalogSnapshotIntervalRecords);
+    pt.put("ramCacheCapacityBytes", m_ramCacheCapacityBytes);
     boost::property_tree::ptree & storageDiskConfigVectorPt = pt.put_child("storageDiskConfigVector", m_storageDiskConfigVector.empty() ? boost::property_tree::ptree("[]") : boost::property_tree::ptree());
     for (storage_disk_config_vector_t::const_iterator storageDiskConfigVectorIt = m_storageDiskConfigVector.cbegin(); storageDiskConfigVectorIt != m_storageDiskConfigVector.cend(); ++storageDiskConfigVectorIt) {
         const storage_disk_config_t & storageDiskConfig = *storageDiskConfigVectorIt;
         boost::property_tree::ptree & storageDiskConfigPt = (storageDiskConfigVectorPt.push_back(std::make_pair("", boost::property_tree::ptree())))->second; //using "" as key creates json array
         storageDiskConfigPt.put("name", storageDiskConfig.name);
         storageDiskConfigPt.put("storeFilePath", storageDiskConfig.storeFilePath);
+        storageDiskConfigPt.put("useDirectIo", storageDiskConfig.useDirectIo);
     }
 
     return pt;
 }
 
 
-void StorageConfig::AddDisk(const std::string & name, const std::string & storeFilePath) {
-    m_storageDiskConfigVector.push_back(storage_disk_config_t(name, storeFilePath));
+void StorageConfig::AddDisk(const std::string & name, const std::string & storeFilePath, bool useDirectIo) {
+    m_storageDiskConfigVector.push_back(storage_disk_config_t(name, storeFilePath, useDirectIo));
 }
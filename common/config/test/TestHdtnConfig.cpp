@@ -50,5 +50,68 @@ BOOST_AUTO_TEST_CASE(HdtnConfigTestCase)
     BOOST_REQUIRE(hdtnConfig == *hdtnConfigFromJsonPtr);
     BOOST_REQUIRE_EQUAL(hdtnJson, hdtnConfigFromJsonPtr->ToJson());
     BOOST_REQUIRE(boost::filesystem::remove(jsonFileToCreate));
+
+    //ingress bundle processing stays on the induct threads by default
+    BOOST_REQUIRE_EQUAL(hdtnConfigFromJsonPtr->m_numIngressWorkerThreads, 0);
+    hdtnConfig.m_numIngressWorkerThreads = 4;
+    BOOST_REQUIRE(!(hdtnConfig == *hdtnConfigFromJsonPtr));
+    hdtnConfigFromJsonPtr = HdtnConfig::CreateFromJson(hdtnConfig.ToJson());
+    BOOST_REQUIRE(hdtnConfigFromJsonPtr);
+    BOOST_REQUIRE(hdtnConfig == *hdtnConfigFromJsonPtr);
+    BOOST_REQUIRE_EQUAL(hdtnConfigFromJsonPtr->m_numIngressWorkerThreads, 4);
+
+    //ingress batching is disabled by default
+    BOOST_REQUIRE_EQUAL(hdtnConfigFromJsonPtr->m_maxIngressBatchBundles, 0);
+    BOOST_REQUIRE_EQUAL(hdtnConfigFromJsonPtr->m_ingressBatchLatencyMicroseconds, 1000);
+    hdtnConfig.m_maxIngressBatchBundles = 16;
+    hdtnConfig.m_ingressBatchLatencyMicroseconds = 500;
+    BOOST_REQUIRE(!(hdtnConfig == *hdtnConfigFromJsonPtr));
+    hdtnConfigFromJsonPtr = HdtnConfig::CreateFromJson(hdtnConfig.ToJson());
+    BOOST_REQUIRE(hdtnConfigFromJsonPtr);
+    BOOST_REQUIRE(hdtnConfig == *hdtnConfigFromJsonPtr);
+    BOOST_REQUIRE_EQUAL(hdtnConfigFromJsonPtr->m_maxIngressBatchBundles, 16);
+    BOOST_REQUIRE_EQUAL(hdtnConfigFromJsonPtr->m_ingressBatchLatencyMicroseconds, 500);
+
+    //egress forwards on its reader thread by default
+    BOOST_REQUIRE(!hdtnConfigFromJsonPtr->m_egressWorkerThreadPerOutduct);
+    hdtnConfig.m_egressWorkerThreadPerOutduct = true;
+    BOOST_REQUIRE(!(hdtnConfig == *hdtnConfigFromJsonPtr));
+    hdtnConfigFromJsonPtr = HdtnConfig::CreateFromJson(hdtnConfig.ToJson());
+    BOOST_REQUIRE(hdtnConfigFromJsonPtr);
+    BOOST_REQUIRE(hdtnConfig == *hdtnConfigFromJsonPtr);
+    BOOST_REQUIRE(hdtnConfigFromJsonPtr->m_egressWorkerThreadPerOutduct);
+
+    //hdtn-one-process cut-through bundles go through the egress thread by default
+    BOOST_REQUIRE(!hdtnConfigFromJsonPtr->m_oneProcessDirectOutductForward);
+    hdtnConfig.m_oneProcessDirectOutductForward = true;
+    BOOST_REQUIRE(!(hdtnConfig == *hdtnConfigFromJsonPtr));
+    hdtnConfigFromJsonPtr = HdtnConfig::CreateFromJson(hdtnConfig.ToJson());
+    BOOST_REQUIRE(hdtnConfigFromJsonPtr);
+    BOOST_REQUIRE(hdtnConfig == *hdtnConfigFromJsonPtr);
+    BOOST_REQUIRE(hdtnConfigFromJsonPtr->m_oneProcessDirectOutductForward);
+
+    //every bundle waits for the ingress pipelines by default
+    BOOST_REQUIRE(!hdtnConfigFromJsonPtr->m_ingressAdmissionControl);
+    BOOST_REQUIRE_EQUAL(hdtnConfigFromJsonPtr->m_ingressAdmissionStorageFullPercent, 90);
+    BOOST_REQUIRE_EQUAL(hdtnConfigFromJsonPtr->m_ingressAdmissionMaxBundlesPerSecondPerSource, 0);
+    hdtnConfig.m_ingressAdmissionControl = true;
+    hdtnConfig.m_ingressAdmissionStorageFullPercent = 80;
+    hdtnConfig.m_ingressAdmissionMaxBundlesPerSecondPerSource = 1000;
+    BOOST_REQUIRE(!(hdtnConfig == *hdtnConfigFromJsonPtr));
+    hdtnConfigFromJsonPtr = HdtnConfig::CreateFromJson(hdtnConfig.ToJson());
+    BOOST_REQUIRE(hdtnConfigFromJsonPtr);
+    BOOST_REQUIRE(hdtnConfig == *hdtnConfigFromJsonPtr);
+    BOOST_REQUIRE(hdtnConfigFromJsonPtr->m_ingressAdmissionControl);
+    BOOST_REQUIRE_EQUAL(hdtnConfigFromJsonPtr->m_ingressAdmissionStorageFullPercent, 80);
+    BOOST_REQUIRE_EQUAL(hdtnConfigFromJsonPtr->m_ingressAdmissionMaxBundlesPerSecondPerSource, 1000);
+
+    //one next hop per final destination by default
+    BOOST_REQUIRE_EQUAL(hdtnConfigFromJsonPtr->m_routerMaxMultipathRoutes, 0);
+    hdtnConfig.m_routerMaxMultipathRoutes = 3;
+    BOOST_REQUIRE(!(hdtnConfig == *hdtnConfigFromJsonPtr));
+    hdtnConfigFromJsonPtr = HdtnConfig::CreateFromJson(hdtnConfig.ToJson());
+    BOOST_REQUIRE(hdtnConfigFromJsonPtr);
+    BOOST_REQUIRE(hdtnConfig == *hdtnConfigFromJsonPtr);
+    BOOST_REQUIRE_EQUAL(hdtnConfigFromJsonPtr->m_routerMaxMultipathRoutes, 3);
 }
 
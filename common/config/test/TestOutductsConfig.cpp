@@ -55,3 +55,33 @@ BOOST_AUTO_TEST_CASE(OutductsConfigRatePrecisionMicroSecTestCase)
     BOOST_REQUIRE_EQUAL(oc1->m_outductElementConfigVector[i].rateLimitPrecisionMicroSec, 100000);
   }
 }
+
+BOOST_AUTO_TEST_CASE(OutductsConfigEgressSchedulerTestCase)
+{
+    const boost::filesystem::path jsonRootDir = Environment::GetPathHdtnSourceRoot() / "common" / "config" / "test";
+    const boost::filesystem::path jsonFileName = jsonRootDir / "outducts.json";
+    OutductsConfig_ptr oc1 = OutductsConfig::CreateFromJsonFilePath(jsonFileName);
+    BOOST_REQUIRE(oc1);
+    BOOST_REQUIRE_EQUAL(oc1->m_outductElementConfigVector.size(), 8);
+
+    //o4 sets the drr scheduler, every other outduct defaults to fifo
+    for (std::size_t i = 0; i < oc1->m_outductElementConfigVector.size(); ++i) {
+        const outduct_element_config_t& oec = oc1->m_outductElementConfigVector[i];
+        if (i == 3) {
+            BOOST_REQUIRE_EQUAL(oec.egressScheduler, "drr");
+            BOOST_REQUIRE_EQUAL(oec.egressSchedulerQuantumBytes, 65536);
+            BOOST_REQUIRE_EQUAL(oec.egressSchedulerMaxBundlesInOutduct, 10);
+        }
+        else {
+            BOOST_REQUIRE_EQUAL(oec.egressScheduler, "fifo");
+            BOOST_REQUIRE_EQUAL(oec.egressSchedulerQuantumBytes, 1048576);
+            BOOST_REQUIRE_EQUAL(oec.egressSchedulerMaxBundlesInOutduct, 0);
+        }
+    }
+
+    std::string json = oc1->ToJson();
+    boost::replace_first(json, "\"drr\"", "\"wfq\"");
+    BOOST_REQUIRE(!OutductsConfig::CreateFromJson(json));
+    boost::replace_first(json, "\"wfq\"", "\"fifo\"");
+    BOOST_REQUIRE(!OutductsConfig::CreateFromJson(json)); //quantum and max bundles are not used by fifo
+}
@@ -52,6 +52,40 @@ BOOST_AUTO_TEST_CASE(StorageConfigTestCase)
     BOOST_REQUIRE(sc1Json == sc1_fromJson->ToJson());
     BOOST_REQUIRE_EQUAL(sc1_fromJson->m_storageDiskConfigVector.size(), 2);
     BOOST_REQUIRE_EQUAL(sc1_fromJson->m_totalStorageCapacityBytes, 100000);
+    BOOST_REQUIRE(!sc1_fromJson->m_storageDiskConfigVector[0].useDirectIo);
+
+    //direct I/O is a per-disk setting
+    StorageConfig_ptr sc3 = std::make_shared< StorageConfig>();
+    sc3->m_totalStorageCapacityBytes = 100000;
+    sc3->AddDisk("d1", "/mnt/d1/d1.bin", true);
+    sc3->AddDisk("d2", "/mnt/d2/d2.bin");
+    BOOST_REQUIRE(!(*sc1 == *sc3));
+    StorageConfig_ptr sc3_fromJson = StorageConfig::CreateFromJson(sc3->ToJson());
+    BOOST_REQUIRE(sc3_fromJson); //not null
+    BOOST_REQUIRE(*sc3 == *sc3_fromJson);
+    BOOST_REQUIRE(sc3_fromJson->m_storageDiskConfigVector[0].useDirectIo);
+    BOOST_REQUIRE(!sc3_fromJson->m_storageDiskConfigVector[1].useDirectIo);
+
+    //the catalog journal is disabled by default
+    BOOST_REQUIRE(sc1_fromJson->m_catalogJournalFilePath.empty());
+    StorageConfig_ptr sc4 = std::make_shared< StorageConfig>(*sc1);
+    sc4->m_catalogJournalFilePath = "/mnt/d1/catalog.journal";
+    sc4->m_catalogSnapshotIntervalRecords = 1000;
+    BOOST_REQUIRE(!(*sc1 == *sc4));
+    StorageConfig_ptr sc4_fromJson = StorageConfig::CreateFromJson(sc4->ToJson());
+    BOOST_REQUIRE(sc4_fromJson); //not null
+    BOOST_REQUIRE(*sc4 == *sc4_fromJson);
+    BOOST_REQUIRE_EQUAL(sc4_fromJson->m_catalogSnapshotIntervalRecords, 1000);
+
+    //the RAM cache is disabled by default
+    BOOST_REQUIRE_EQUAL(sc1_fromJson->m_ramCacheCapacityBytes, 0);
+    StorageConfig_ptr sc5 = std::make_shared< StorageConfig>(*sc1);
+    sc5->m_ramCacheCapacityBytes = 50000000;
+    BOOST_REQUIRE(!(*sc1 == *sc5));
+    StorageConfig_ptr sc5_fromJson = StorageConfig::CreateFromJson(sc5->ToJson());
+    BOOST_REQUIRE(sc5_fromJson); //not null
+    BOOST_REQUIRE(*sc5 == *sc5_fromJson);
+    BOOST_REQUIRE_EQUAL(sc5_fromJson->m_ramCacheCapacityBytes, 50000000);
 
 }
 
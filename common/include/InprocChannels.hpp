@@ -0,0 +1,74 @@
+/**
+ * @file InprocChannels.hpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * The InprocChannels.hpp defines the messages carried by the InprocMessageChannel instances
+ * that replace ZeroMQ inproc sockets between the modules of hdtn-one-process.
+ * Each message is the same fixed-sized header that would have been the first ZeroMQ message part
+ * followed by the (possibly empty) bundle that would have been the second part.
+ * It also defines the DirectOutductForwarder, which lets ingress skip the egress thread altogether.
+ */
+
+#ifndef _HDTN_INPROC_CHANNELS_H
+#define _HDTN_INPROC_CHANNELS_H 1
+
+#include "message.hpp"
+#include "InprocMessageChannel.h"
+#include "zmq.hpp"
+#include <boost/core/noncopyable.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace hdtn {
+
+/// Ingress to egress (cut-through bundles, bundles for the router, and opportunistic link changes)
+struct ToEgressInprocMessage {
+    ToEgressHdr toEgressHdr;
+    zmq::message_t bundle; //empty for opportunistic link changes
+};
+typedef InprocMessageChannel<ToEgressInprocMessage> ToEgressInprocChannel;
+
+static constexpr uint32_t TO_EGRESS_INPROC_CHANNEL_CAPACITY = 4096;
+
+/// Optional (oneProcessDirectOutductForward) cut-through fast path from ingress straight to an outduct owned by egress.
+/// Egress sets the forward function and ingress sets the on successful send function, both in their Init.
+/// The EgressAckHdr of a bundle forwarded this way has HDTN_EGRESS_ACK_FLAG_DIRECT_FORWARD set, and its successful send
+/// is given back to ingress by a direct call instead of over zmq (failures still take the zmq path with their error).
+class DirectOutductForwarder : private boost::noncopyable {
+public:
+    typedef boost::function<bool(const ToEgressHdr& toEgressHdr, zmq::message_t& zmqMessageBundle)> forward_function_t;
+    typedef boost::function<void(const EgressAckHdr& egressAckHdr)> on_successful_send_function_t;
+
+    void SetForwardFunction(const forward_function_t& forwardFunction) {
+        m_forwardFunction = forwardFunction;
+    }
+    void SetOnSuccessfulSendFunction(const on_successful_send_function_t& onSuccessfulSendFunction) {
+        boost::mutex::scoped_lock lock(m_onSuccessfulSendMutex);
+        m_onSuccessfulSendFunction = onSuccessfulSendFunction;
+    }
+    /// Called by ingress.  Returns true if the outduct took the bundle, otherwise zmqMessageBundle is not moved.
+    bool Forward(const ToEgressHdr& toEgressHdr, zmq::message_t& zmqMessageBundle) const {
+        return m_forwardFunction && m_forwardFunction(toEgressHdr, zmqMessageBundle);
+    }
+    /// Called by egress (from an outduct thread).  Thread safe with ingress clearing the function when it stops.
+    void OnSuccessfulSend(const EgressAckHdr& egressAckHdr) {
+        boost::mutex::scoped_lock lock(m_onSuccessfulSendMutex);
+        if (m_onSuccessfulSendFunction) {
+            m_onSuccessfulSendFunction(egressAckHdr);
+        }
+    }
+private:
+    forward_function_t m_forwardFunction;
+    on_successful_send_function_t m_onSuccessfulSendFunction;
+    boost::mutex m_onSuccessfulSendMutex;
+};
+
+}  // namespace hdtn
+
+#endif //_HDTN_INPROC_CHANNELS_H
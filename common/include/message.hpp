@@ -39,6 +39,8 @@
 #define HDTN_MSGTYPE_STORAGE_REMOVE_OPPORTUNISTIC_LINK (0x0009)
 #define HDTN_MSGTYPE_BUNDLES_TO_ROUTER (0x000A)
 #define HDTN_MSGTYPE_BUNDLES_FROM_ROUTER (0x000B)
+#define HDTN_MSGTYPE_EGRESS_BATCH (0x000C) //ToEgressHdr, then a part of ToEgressHdr[N], then N bundle parts
+#define HDTN_MSGTYPE_STORE_BATCH (0x000D) //ToStorageHdr, then a part of ToStorageHdr[N], then N bundle parts
 
 // Egress Messages range is 0xE000 to 0xEAFF
 #define HDTN_MSGTYPE_ENOTIMPL (0xE000)  // convergence layer type not  // implemented
@@ -75,8 +77,13 @@
 #define HDTN_MSGTYPE_STORAGE_ACK_TO_INGRESS (0x5557)
 #define HDTN_MSGTYPE_ALL_OUTDUCT_CAPABILITIES_TELEMETRY (0x5558)
 #define HDTN_MSGTYPE_DEPLETED_STORAGE_REPORT (0x5559)
+#define HDTN_MSGTYPE_STORAGE_ACK_BATCH_TO_INGRESS (0x555A) //StorageAckHdr, then a part of IngressUniqueIdAckRange[N]
+
+//EgressAckHdr base.flags
+#define HDTN_EGRESS_ACK_FLAG_DIRECT_FORWARD (0x0001) //bundle given to the outduct by ingress (see DirectOutductForwarder)
 
 #define HDTN_NOROUTE (UINT64_MAX) // no route available
+#define HDTN_MAX_MULTIPATH_NEXT_HOPS (4) // max next hops of a RouteUpdateHdr
 
 namespace hdtn {
 enum class EGRESS_ACK_ERROR_TYPE : uint8_t {
@@ -142,13 +149,29 @@ struct ToStorageHdr {
 struct StorageAckHdr {
     CommonHdr base;
     uint8_t error;
-    uint8_t unused1;
+    uint8_t storageUsedPercent; //of the storage capacity when the ack was created (for ingress admission control)
     uint8_t unused2;
     uint8_t unused3;
     uint64_t ingressUniqueId;
     uint64_t outductIndex; //for bundle pipeline limiting on a per outduct basis
 };
 
+//a run of consecutive ingress unique ids (all sent to the same outduct index) acked at once
+struct IngressUniqueIdAckRange {
+    uint64_t firstIngressUniqueId;
+    uint64_t numIngressUniqueIds;
+    uint64_t outductIndex; //for bundle pipeline limiting on a per outduct basis
+
+    //extends this range by one id if possible (the next consecutive id to the same outductIndex)
+    bool TryAppend(const uint64_t ingressUniqueId, const uint64_t paramOutductIndex) noexcept {
+        if ((paramOutductIndex == outductIndex) && (ingressUniqueId == (firstIngressUniqueId + numIngressUniqueIds))) {
+            ++numIngressUniqueIds;
+            return true;
+        }
+        return false;
+    }
+};
+
 struct TelemStorageHdr {
     CommonHdr base;
     StorageStats stats;
@@ -199,6 +222,11 @@ struct RouteUpdateHdr {
     uint8_t unused4;
     uint64_t nextHopNodeId;
     uint64_t finalDestNodeId;
+    //multipath: when numMultipathNextHops >= 2, egress splits the bulk flows to the final destination across these next hops
+    //(the first being nextHopNodeId) in proportion to their weights, otherwise every bundle goes to nextHopNodeId
+    uint64_t numMultipathNextHops;
+    uint64_t multipathNextHopNodeIds[HDTN_MAX_MULTIPATH_NEXT_HOPS];
+    uint64_t multipathWeights[HDTN_MAX_MULTIPATH_NEXT_HOPS];
 };
 
 struct LinkStatusHdr {
@@ -24,6 +24,7 @@
 #include <map>
 #include <memory>
 #include <vector>
+#include <atomic>
 #include <zmq.hpp>
 #include <boost/thread.hpp>
 #include "codec/bpv6.h"
@@ -46,6 +47,16 @@ public:
     OUTDUCT_MANAGER_LIB_EXPORT Outduct * GetOutductByFinalDestinationEid_ThreadSafe(const cbhe_eid_t & finalDestEid);
     OUTDUCT_MANAGER_LIB_EXPORT Outduct * GetOutductByOutductUuid(const uint64_t uuid);
     OUTDUCT_MANAGER_LIB_EXPORT bool Reroute_ThreadSafe(const uint64_t finalDestNodeId, const uint64_t newNextHopNodeId);
+    /**
+     * Split the flows to a final destination across the outducts of several next hops (multipath), in proportion to their weights.
+     * Fewer than two next hops stops splitting them (they all go to the outduct set by Reroute_ThreadSafe).
+     * @return False if a next hop has no outduct (then the flows are no longer split).
+     */
+    OUTDUCT_MANAGER_LIB_EXPORT bool SetMultipathNextHops_ThreadSafe(const uint64_t finalDestNodeId, const uint64_t* nextHopNodeIds, const uint64_t* weights, const std::size_t numNextHops);
+    /// @return The outduct of the flow if its final destination's flows are split across next hops, otherwise NULL.
+    OUTDUCT_MANAGER_LIB_EXPORT Outduct * GetMultipathOutductByFlow_ThreadSafe(const cbhe_eid_t & sourceEid, const cbhe_eid_t & finalDestEid);
+    /// @return True if the flows to any final destination are split across next hops.
+    OUTDUCT_MANAGER_LIB_EXPORT bool HasMultipathNextHops() const noexcept;
     OUTDUCT_MANAGER_LIB_EXPORT void GetAllOutductCapabilitiesTelemetry_ThreadSafe(AllOutductCapabilitiesTelemetry_t & allOutductCapabilitiesTelemetry);
     OUTDUCT_MANAGER_LIB_EXPORT std::shared_ptr<Outduct> GetOutductSharedPtrByOutductUuid(const uint64_t uuid);
     OUTDUCT_MANAGER_LIB_EXPORT Outduct * GetOutductByNextHopNodeId(const uint64_t nextHopNodeId);
@@ -56,8 +67,14 @@ public:
 
     OUTDUCT_MANAGER_LIB_EXPORT void PopulateAllOutductTelemetry(AllOutductTelemetry_t& allOutductTelem);
 private:
+    struct MultipathOutducts {
+        std::vector<std::shared_ptr<Outduct> > outducts;
+        std::vector<uint64_t> cumulativeWeights;
+    };
 
     std::map<uint64_t, std::shared_ptr<Outduct> > m_finalDestNodeIdToOutductMap;
+    std::map<uint64_t, MultipathOutducts> m_finalDestNodeIdToMultipathOutductsMap; //also guarded by m_finalDestNodeIdToOutductMapMutex
+    std::atomic<bool> m_hasMultipathNextHops;
     boost::mutex m_finalDestNodeIdToOutductMapMutex;
     std::map<uint64_t, std::shared_ptr<Outduct> > m_nextHopNodeIdToOutductMap;
     std::vector<std::shared_ptr<Outduct> > m_outductsVec;
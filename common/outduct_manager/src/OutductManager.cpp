@@ -16,6 +16,7 @@
 #include "Logger.h"
 #include <boost/make_unique.hpp>
 #include <memory>
+#include <algorithm>
 #include "TcpclOutduct.h"
 #include "TcpclV4Outduct.h"
 #include "StcpOutduct.h"
@@ -30,7 +31,7 @@
 
 static constexpr hdtn::Logger::SubProcess subprocess = hdtn::Logger::SubProcess::none;
 
-OutductManager::OutductManager() : m_numEventsTooManyUnackedBundles(0) {}
+OutductManager::OutductManager() : m_hasMultipathNextHops(false), m_numEventsTooManyUnackedBundles(0) {}
 
 OutductManager::~OutductManager() {
     // The outducts run threads that call callbacks which may
@@ -51,6 +52,8 @@ bool OutductManager::LoadOutductsFromConfig(const OutductsConfig & outductsConfi
 {
     LtpUdpEngineManager::SetMaxUdpRxPacketSizeBytesForAllLtp(maxUdpRxPacketSizeBytesForAllLtp); //MUST BE CALLED BEFORE ANY USAGE OF LTP
     m_finalDestNodeIdToOutductMap.clear();
+    m_finalDestNodeIdToMultipathOutductsMap.clear();
+    m_hasMultipathNextHops = false;
     m_nextHopNodeIdToOutductMap.clear();
     m_outductsVec.clear();
     uint64_t nextOutductUuidIndex = 0;
@@ -252,6 +255,63 @@ bool OutductManager::Reroute_ThreadSafe(const uint64_t finalDestNodeId, const ui
     return true;
 }
 
+bool OutductManager::SetMultipathNextHops_ThreadSafe(const uint64_t finalDestNodeId, const uint64_t* nextHopNodeIds, const uint64_t* weights, const std::size_t numNextHops) {
+
+    boost::mutex::scoped_lock lock(m_finalDestNodeIdToOutductMapMutex);
+
+    m_finalDestNodeIdToMultipathOutductsMap.erase(finalDestNodeId);
+    bool success = true;
+    if (numNextHops >= 2) {
+        MultipathOutducts multipathOutducts;
+        uint64_t totalWeight = 0;
+        for (std::size_t i = 0; i < numNextHops; ++i) {
+            std::map<uint64_t, std::shared_ptr<Outduct> >::iterator itNextHopNodeId = m_nextHopNodeIdToOutductMap.find(nextHopNodeIds[i]);
+            if (itNextHopNodeId == m_nextHopNodeIdToOutductMap.end()) {
+                LOG_ERROR(subprocess) << "OutductManager::SetMultipathNextHops_ThreadSafe: nextHopNodeId " << nextHopNodeIds[i] << " not found in HDTN's outducts";
+                success = false;
+                break;
+            }
+            totalWeight += std::max<uint64_t>(weights[i], 1); //a zero weight still gets some flows
+            multipathOutducts.outducts.push_back(itNextHopNodeId->second);
+            multipathOutducts.cumulativeWeights.push_back(totalWeight);
+        }
+        if (success) {
+            m_finalDestNodeIdToMultipathOutductsMap[finalDestNodeId] = std::move(multipathOutducts);
+        }
+    }
+    m_hasMultipathNextHops = !m_finalDestNodeIdToMultipathOutductsMap.empty();
+    return success;
+}
+
+//splitmix64 finalizer, so that consecutive node and service numbers still spread the flows evenly
+static uint64_t MixFlowHash(uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+Outduct * OutductManager::GetMultipathOutductByFlow_ThreadSafe(const cbhe_eid_t & sourceEid, const cbhe_eid_t & finalDestEid) {
+    //a flow always hashes to the same outduct (while the next hops are unchanged), which keeps its bundles in order
+    const uint64_t flowHash = MixFlowHash(MixFlowHash(MixFlowHash(sourceEid.nodeId) ^ sourceEid.serviceId) ^ finalDestEid.serviceId);
+    boost::mutex::scoped_lock lock(m_finalDestNodeIdToOutductMapMutex);
+    std::map<uint64_t, MultipathOutducts>::const_iterator it = m_finalDestNodeIdToMultipathOutductsMap.find(finalDestEid.nodeId);
+    if (it == m_finalDestNodeIdToMultipathOutductsMap.cend()) {
+        return NULL;
+    }
+    const MultipathOutducts & multipathOutducts = it->second;
+    const uint64_t point = flowHash % multipathOutducts.cumulativeWeights.back();
+    const std::size_t i = std::upper_bound(multipathOutducts.cumulativeWeights.cbegin(), multipathOutducts.cumulativeWeights.cend(), point)
+        - multipathOutducts.cumulativeWeights.cbegin();
+    return multipathOutducts.outducts[i].get();
+}
+
+bool OutductManager::HasMultipathNextHops() const noexcept {
+    return m_hasMultipathNextHops.load(std::memory_order_relaxed);
+}
+
 void OutductManager::GetAllOutductCapabilitiesTelemetry_ThreadSafe(AllOutductCapabilitiesTelemetry_t& allOutductCapabilitiesTelemetry) {
     std::vector<OutductCapabilityTelemetry_t> octVec(m_outductsVec.size());
     allOutductCapabilitiesTelemetry.outductCapabilityTelemetryList.clear();
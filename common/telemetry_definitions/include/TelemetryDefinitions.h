@@ -39,6 +39,25 @@
 #  endif
 #endif
 
+struct CLASS_VISIBILITY_TELEMETRY_DEFINITIONS StorageDiskRestoreTelemetry_t : public JsonSerializable {
+    TELEMETRY_DEFINITIONS_EXPORT StorageDiskRestoreTelemetry_t();
+    TELEMETRY_DEFINITIONS_EXPORT ~StorageDiskRestoreTelemetry_t();
+    TELEMETRY_DEFINITIONS_EXPORT bool operator==(const StorageDiskRestoreTelemetry_t& o) const; //operator ==
+    TELEMETRY_DEFINITIONS_EXPORT bool operator!=(const StorageDiskRestoreTelemetry_t& o) const;
+
+    TELEMETRY_DEFINITIONS_EXPORT virtual boost::property_tree::ptree GetNewPropertyTree() const override;
+    TELEMETRY_DEFINITIONS_EXPORT virtual bool SetValuesFromPropertyTree(const boost::property_tree::ptree& pt) override;
+
+    uint64_t m_diskIndex;
+    uint64_t m_bytesScanned; //restore progress: m_bytesScanned out of m_totalBytesToScan (the disk's file size)
+    uint64_t m_totalBytesToScan;
+    //bundles whose head segment resides on this disk
+    uint64_t m_bundlesRestored;
+    uint64_t m_bundleBytesRestored;
+    uint64_t m_segmentsRestored;
+    bool m_restoreCompleted;
+};
+
 struct CLASS_VISIBILITY_TELEMETRY_DEFINITIONS StorageTelemetry_t : public JsonSerializable {
     TELEMETRY_DEFINITIONS_EXPORT StorageTelemetry_t();
     TELEMETRY_DEFINITIONS_EXPORT ~StorageTelemetry_t();
@@ -74,6 +93,17 @@ struct CLASS_VISIBILITY_TELEMETRY_DEFINITIONS StorageTelemetry_t : public JsonSe
     //from BundleStorageManagerBase's MemoryManager
     uint64_t m_usedSpaceBytes;
     uint64_t m_freeSpaceBytes;
+
+    //from BundleStorageManagerBase's RAM cache tier (hits and misses are counted per bundle read)
+    uint64_t m_numBundlesInRamCache;
+    uint64_t m_numBundleBytesInRamCache;
+    uint64_t m_totalRamCacheHits;
+    uint64_t m_totalRamCacheMisses;
+    uint64_t m_totalBundlesFlushedFromRamCacheToDisk;
+    uint64_t m_totalBundlesErasedFromRamCacheBeforeFlush; //bundles that never had to be written to disk
+
+    //from BundleStorageManagerBase's RestoreFromDisk (one per disk, empty if no restore was attempted)
+    std::vector<StorageDiskRestoreTelemetry_t> m_diskRestoreTelemetryVec;
 };
 
 
@@ -101,6 +131,8 @@ struct CLASS_VISIBILITY_TELEMETRY_DEFINITIONS OutductCapabilityTelemetry_t : pub
     uint64_t maxBundleSizeBytesInPipeline;
     uint64_t nextHopNodeId;
     bool assumedInitiallyDown;
+    uint64_t totalBundleBytesGivenToOutduct; //since egress started, for the router's contact volume accounting
+    uint64_t bundleBytesInEgressQueue; //backlog waiting in egress for the outduct
     std::list<cbhe_eid_t> finalDestinationEidList;
     std::list<uint64_t> finalDestinationNodeIdList;
 
@@ -311,6 +343,13 @@ struct CLASS_VISIBILITY_TELEMETRY_DEFINITIONS AllInductTelemetry_t : public Json
     uint64_t m_bundleCountStorage;
     uint64_t m_bundleByteCountEgress;
     uint64_t m_bundleByteCountStorage;
+    //bundle buffer pool (all 0 unless built with USE_PADDED_BUFFER_POOL); hit rate = hits / allocations
+    uint64_t m_bufferPoolNumAllocations;
+    uint64_t m_bufferPoolNumHits;
+    uint64_t m_bufferPoolNumBytesCached;
+    //bundles dropped by ingress admission control (all 0 unless ingressAdmissionControl)
+    uint64_t m_admissionControlNumBundlesDropped;
+    uint64_t m_admissionControlNumBytesDropped;
     //inducts specific
     std::list<InductTelemetry_t> m_listAllInducts;
 };
@@ -335,6 +374,11 @@ struct CLASS_VISIBILITY_TELEMETRY_DEFINITIONS OutductTelemetry_t : public JsonSe
     uint64_t m_totalBundlesFailedToSend;
     bool m_linkIsUpPhysically;
     bool m_linkIsUpPerTimeSchedule;
+    //egress per-outduct worker queue (all 0 unless egressWorkerThreadPerOutduct is enabled)
+    uint64_t m_numBundlesInEgressQueue;
+    uint64_t m_averageEgressQueueTimeMicroseconds;
+    uint64_t m_maxEgressQueueTimeMicroseconds;
+    uint64_t m_numFlowsInEgressScheduler; //0 unless the outduct's egressScheduler is priority or drr
 
     TELEMETRY_DEFINITIONS_EXPORT uint64_t GetTotalBundlesQueued() const;
     TELEMETRY_DEFINITIONS_EXPORT uint64_t GetTotalBundleBytesQueued() const;
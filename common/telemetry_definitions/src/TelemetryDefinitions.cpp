@@ -28,6 +28,60 @@ static constexpr hdtn::Logger::SubProcess subprocess = hdtn::Logger::SubProcess:
 static const boost::property_tree::ptree EMPTY_PTREE;
 
 
+/////////////////////////////////////
+//StorageDiskRestoreTelemetry_t
+/////////////////////////////////////
+StorageDiskRestoreTelemetry_t::StorageDiskRestoreTelemetry_t() :
+    m_diskIndex(0),
+    m_bytesScanned(0),
+    m_totalBytesToScan(0),
+    m_bundlesRestored(0),
+    m_bundleBytesRestored(0),
+    m_segmentsRestored(0),
+    m_restoreCompleted(false) {}
+StorageDiskRestoreTelemetry_t::~StorageDiskRestoreTelemetry_t() {}
+bool StorageDiskRestoreTelemetry_t::operator==(const StorageDiskRestoreTelemetry_t& o) const {
+    return (m_diskIndex == o.m_diskIndex)
+        && (m_bytesScanned == o.m_bytesScanned)
+        && (m_totalBytesToScan == o.m_totalBytesToScan)
+        && (m_bundlesRestored == o.m_bundlesRestored)
+        && (m_bundleBytesRestored == o.m_bundleBytesRestored)
+        && (m_segmentsRestored == o.m_segmentsRestored)
+        && (m_restoreCompleted == o.m_restoreCompleted);
+}
+bool StorageDiskRestoreTelemetry_t::operator!=(const StorageDiskRestoreTelemetry_t& o) const {
+    return !(*this == o);
+}
+
+bool StorageDiskRestoreTelemetry_t::SetValuesFromPropertyTree(const boost::property_tree::ptree& pt) {
+    try {
+        m_diskIndex = pt.get<uint64_t>("diskIndex");
+        m_bytesScanned = pt.get<uint64_t>("bytesScanned");
+        m_totalBytesToScan = pt.get<uint64_t>("totalBytesToScan");
+        m_bundlesRestored = pt.get<uint64_t>("bundlesRestored");
+        m_bundleBytesRestored = pt.get<uint64_t>("bundleBytesRestored");
+        m_segmentsRestored = pt.get<uint64_t>("segmentsRestored");
+        m_restoreCompleted = pt.get<bool>("restoreCompleted");
+    }
+    catch (const boost::property_tree::ptree_error& e) {
+        LOG_ERROR(subprocess) << "parsing JSON StorageDiskRestoreTelemetry_t: " << e.what();
+        return false;
+    }
+    return true;
+}
+
+boost::property_tree::ptree StorageDiskRestoreTelemetry_t::GetNewPropertyTree() const {
+    boost::property_tree::ptree pt;
+    pt.put("diskIndex", m_diskIndex);
+    pt.put("bytesScanned", m_bytesScanned);
+    pt.put("totalBytesToScan", m_totalBytesToScan);
+    pt.put("bundlesRestored", m_bundlesRestored);
+    pt.put("bundleBytesRestored", m_bundleBytesRestored);
+    pt.put("segmentsRestored", m_segmentsRestored);
+    pt.put("restoreCompleted", m_restoreCompleted);
+    return pt;
+}
+
 /////////////////////////////////////
 //StorageTelemetry_t
 /////////////////////////////////////
@@ -54,7 +108,14 @@ StorageTelemetry_t::StorageTelemetry_t() :
     m_totalBundleByteEraseOperationsFromDisk(0),
     //from BundleStorageManagerBase's MemoryManager
     m_usedSpaceBytes(0),
-    m_freeSpaceBytes(0) {}
+    m_freeSpaceBytes(0),
+    //from BundleStorageManagerBase's RAM cache tier
+    m_numBundlesInRamCache(0),
+    m_numBundleBytesInRamCache(0),
+    m_totalRamCacheHits(0),
+    m_totalRamCacheMisses(0),
+    m_totalBundlesFlushedFromRamCacheToDisk(0),
+    m_totalBundlesErasedFromRamCacheBeforeFlush(0) {}
 StorageTelemetry_t::~StorageTelemetry_t() {}
 bool StorageTelemetry_t::operator==(const StorageTelemetry_t& o) const {
     return (m_timestampMilliseconds == o.m_timestampMilliseconds)
@@ -76,7 +137,14 @@ bool StorageTelemetry_t::operator==(const StorageTelemetry_t& o) const {
         && (m_totalBundleEraseOperationsFromDisk == o.m_totalBundleEraseOperationsFromDisk)
         && (m_totalBundleByteEraseOperationsFromDisk == o.m_totalBundleByteEraseOperationsFromDisk)
         && (m_usedSpaceBytes == o.m_usedSpaceBytes)
-        && (m_freeSpaceBytes == o.m_freeSpaceBytes);
+        && (m_freeSpaceBytes == o.m_freeSpaceBytes)
+        && (m_numBundlesInRamCache == o.m_numBundlesInRamCache)
+        && (m_numBundleBytesInRamCache == o.m_numBundleBytesInRamCache)
+        && (m_totalRamCacheHits == o.m_totalRamCacheHits)
+        && (m_totalRamCacheMisses == o.m_totalRamCacheMisses)
+        && (m_totalBundlesFlushedFromRamCacheToDisk == o.m_totalBundlesFlushedFromRamCacheToDisk)
+        && (m_totalBundlesErasedFromRamCacheBeforeFlush == o.m_totalBundlesErasedFromRamCacheBeforeFlush)
+        && (m_diskRestoreTelemetryVec == o.m_diskRestoreTelemetryVec);
 }
 bool StorageTelemetry_t::operator!=(const StorageTelemetry_t& o) const {
     return !(*this == o);
@@ -104,6 +172,22 @@ bool StorageTelemetry_t::SetValuesFromPropertyTree(const boost::property_tree::p
         m_totalBundleByteEraseOperationsFromDisk = pt.get<uint64_t>("totalBundleByteEraseOperationsFromDisk");
         m_usedSpaceBytes = pt.get<uint64_t>("usedSpaceBytes");
         m_freeSpaceBytes = pt.get<uint64_t>("freeSpaceBytes");
+        m_numBundlesInRamCache = pt.get<uint64_t>("numBundlesInRamCache");
+        m_numBundleBytesInRamCache = pt.get<uint64_t>("numBundleBytesInRamCache");
+        m_totalRamCacheHits = pt.get<uint64_t>("totalRamCacheHits");
+        m_totalRamCacheMisses = pt.get<uint64_t>("totalRamCacheMisses");
+        m_totalBundlesFlushedFromRamCacheToDisk = pt.get<uint64_t>("totalBundlesFlushedFromRamCacheToDisk");
+        m_totalBundlesErasedFromRamCacheBeforeFlush = pt.get<uint64_t>("totalBundlesErasedFromRamCacheBeforeFlush");
+
+        const boost::property_tree::ptree& diskRestoreTelemetryListPt = pt.get_child("diskRestoreTelemetryList", EMPTY_PTREE); //non-throw version
+        m_diskRestoreTelemetryVec.clear();
+        m_diskRestoreTelemetryVec.reserve(diskRestoreTelemetryListPt.size());
+        BOOST_FOREACH(const boost::property_tree::ptree::value_type & diskRestoreTelemetryValuePt, diskRestoreTelemetryListPt) {
+            m_diskRestoreTelemetryVec.emplace_back();
+            if (!m_diskRestoreTelemetryVec.back().SetValuesFromPropertyTree(diskRestoreTelemetryValuePt.second)) {
+                return false;
+            }
+        }
     }
     catch (const boost::property_tree::ptree_error& e) {
         LOG_ERROR(subprocess) << "parsing JSON StorageTelemetry_t: " << e.what();
@@ -134,6 +218,17 @@ boost::property_tree::ptree StorageTelemetry_t::GetNewPropertyTree() const {
     pt.put("totalBundleByteEraseOperationsFromDisk", m_totalBundleByteEraseOperationsFromDisk);
     pt.put("usedSpaceBytes", m_usedSpaceBytes);
     pt.put("freeSpaceBytes", m_freeSpaceBytes);
+    pt.put("numBundlesInRamCache", m_numBundlesInRamCache);
+    pt.put("numBundleBytesInRamCache", m_numBundleBytesInRamCache);
+    pt.put("totalRamCacheHits", m_totalRamCacheHits);
+    pt.put("totalRamCacheMisses", m_totalRamCacheMisses);
+    pt.put("totalBundlesFlushedFromRamCacheToDisk", m_totalBundlesFlushedFromRamCacheToDisk);
+    pt.put("totalBundlesErasedFromRamCacheBeforeFlush", m_totalBundlesErasedFromRamCacheBeforeFlush);
+    boost::property_tree::ptree& diskRestoreTelemetryListPt = pt.put_child("diskRestoreTelemetryList",
+        m_diskRestoreTelemetryVec.empty() ? boost::property_tree::ptree("[]") : boost::property_tree::ptree());
+    for (std::vector<StorageDiskRestoreTelemetry_t>::const_iterator it = m_diskRestoreTelemetryVec.cbegin(); it != m_diskRestoreTelemetryVec.cend(); ++it) {
+        diskRestoreTelemetryListPt.push_back(std::make_pair("", it->GetNewPropertyTree())); //using "" as key creates json array
+    }
     return pt;
 }
 
@@ -207,13 +302,17 @@ OutductCapabilityTelemetry_t::OutductCapabilityTelemetry_t() :
     outductArrayIndex(0),
     maxBundlesInPipeline(0),
     maxBundleSizeBytesInPipeline(0),
-    nextHopNodeId(0), assumedInitiallyDown(false) {}
+    nextHopNodeId(0), assumedInitiallyDown(false),
+    totalBundleBytesGivenToOutduct(0),
+    bundleBytesInEgressQueue(0) {}
 bool OutductCapabilityTelemetry_t::operator==(const OutductCapabilityTelemetry_t& o) const {
     return (outductArrayIndex == o.outductArrayIndex)
         && (maxBundlesInPipeline == o.maxBundlesInPipeline)
         && (maxBundleSizeBytesInPipeline == o.maxBundleSizeBytesInPipeline)
         && (nextHopNodeId == o.nextHopNodeId)
         && (assumedInitiallyDown == o.assumedInitiallyDown)
+        && (totalBundleBytesGivenToOutduct == o.totalBundleBytesGivenToOutduct)
+        && (bundleBytesInEgressQueue == o.bundleBytesInEgressQueue)
         && (finalDestinationEidList == o.finalDestinationEidList)
         && (finalDestinationNodeIdList == o.finalDestinationNodeIdList);
 }
@@ -226,6 +325,8 @@ OutductCapabilityTelemetry_t::OutductCapabilityTelemetry_t(const OutductCapabili
     maxBundleSizeBytesInPipeline(o.maxBundleSizeBytesInPipeline),
     nextHopNodeId(o.nextHopNodeId),
     assumedInitiallyDown(o.assumedInitiallyDown),
+    totalBundleBytesGivenToOutduct(o.totalBundleBytesGivenToOutduct),
+    bundleBytesInEgressQueue(o.bundleBytesInEgressQueue),
     finalDestinationEidList(o.finalDestinationEidList),
     finalDestinationNodeIdList(o.finalDestinationNodeIdList) { } //a copy constructor: X(const X&)
 OutductCapabilityTelemetry_t::OutductCapabilityTelemetry_t(OutductCapabilityTelemetry_t&& o) noexcept :
@@ -234,6 +335,8 @@ OutductCapabilityTelemetry_t::OutductCapabilityTelemetry_t(OutductCapabilityTele
     maxBundleSizeBytesInPipeline(o.maxBundleSizeBytesInPipeline),
     nextHopNodeId(o.nextHopNodeId),
     assumedInitiallyDown(o.assumedInitiallyDown),
+    totalBundleBytesGivenToOutduct(o.totalBundleBytesGivenToOutduct),
+    bundleBytesInEgressQueue(o.bundleBytesInEgressQueue),
     finalDestinationEidList(std::move(o.finalDestinationEidList)),
     finalDestinationNodeIdList(std::move(o.finalDestinationNodeIdList)) { } //a move constructor: X(X&&)
 OutductCapabilityTelemetry_t& OutductCapabilityTelemetry_t::operator=(const OutductCapabilityTelemetry_t& o) { //a copy assignment: operator=(const X&)
@@ -242,6 +345,8 @@ OutductCapabilityTelemetry_t& OutductCapabilityTelemetry_t::operator=(const Outd
     maxBundleSizeBytesInPipeline = o.maxBundleSizeBytesInPipeline;
     nextHopNodeId = o.nextHopNodeId;
     assumedInitiallyDown = o.assumedInitiallyDown,
+    totalBundleBytesGivenToOutduct = o.totalBundleBytesGivenToOutduct;
+    bundleBytesInEgressQueue = o.bundleBytesInEgressQueue;
     finalDestinationEidList = o.finalDestinationEidList;
     finalDestinationNodeIdList = o.finalDestinationNodeIdList;
     return *this;
@@ -252,6 +357,8 @@ OutductCapabilityTelemetry_t& OutductCapabilityTelemetry_t::operator=(OutductCap
     maxBundleSizeBytesInPipeline = o.maxBundleSizeBytesInPipeline;
     nextHopNodeId = o.nextHopNodeId;
     assumedInitiallyDown = o.assumedInitiallyDown,
+    totalBundleBytesGivenToOutduct = o.totalBundleBytesGivenToOutduct;
+    bundleBytesInEgressQueue = o.bundleBytesInEgressQueue;
     finalDestinationEidList = std::move(o.finalDestinationEidList);
     finalDestinationNodeIdList = std::move(o.finalDestinationNodeIdList);
     return *this;
@@ -263,6 +370,8 @@ bool OutductCapabilityTelemetry_t::SetValuesFromPropertyTree(const boost::proper
         maxBundleSizeBytesInPipeline = pt.get<uint64_t>("maxBundleSizeBytesInPipeline");
         nextHopNodeId = pt.get<uint64_t>("nextHopNodeId");
         assumedInitiallyDown = pt.get<bool>("assumedInitiallyDown");
+        totalBundleBytesGivenToOutduct = pt.get<uint64_t>("totalBundleBytesGivenToOutduct", 0); //optional
+        bundleBytesInEgressQueue = pt.get<uint64_t>("bundleBytesInEgressQueue", 0); //optional
 
         const boost::property_tree::ptree& finalDestinationEidsListPt = pt.get_child("finalDestinationEidsList", EMPTY_PTREE); //non-throw version
         finalDestinationEidList.clear();
@@ -297,6 +406,8 @@ boost::property_tree::ptree OutductCapabilityTelemetry_t::GetNewPropertyTree() c
     pt.put("maxBundleSizeBytesInPipeline", maxBundleSizeBytesInPipeline);
     pt.put("nextHopNodeId", nextHopNodeId);
     pt.put("assumedInitiallyDown", assumedInitiallyDown);
+    pt.put("totalBundleBytesGivenToOutduct", totalBundleBytesGivenToOutduct);
+    pt.put("bundleBytesInEgressQueue", bundleBytesInEgressQueue);
     boost::property_tree::ptree& eidListPt = pt.put_child("finalDestinationEidsList",
         (finalDestinationEidList.empty() && finalDestinationNodeIdList.empty()) ? boost::property_tree::ptree("[]") : boost::property_tree::ptree());
     for (std::list<cbhe_eid_t>::const_iterator it = finalDestinationEidList.cbegin(); it != finalDestinationEidList.cend(); ++it) {
@@ -910,14 +1021,24 @@ AllInductTelemetry_t::AllInductTelemetry_t() :
     m_bundleCountEgress(0),
     m_bundleCountStorage(0),
     m_bundleByteCountEgress(0),
-    m_bundleByteCountStorage(0) {}
+    m_bundleByteCountStorage(0),
+    m_bufferPoolNumAllocations(0),
+    m_bufferPoolNumHits(0),
+    m_bufferPoolNumBytesCached(0),
+    m_admissionControlNumBundlesDropped(0),
+    m_admissionControlNumBytesDropped(0) {}
 bool AllInductTelemetry_t::operator==(const AllInductTelemetry_t& o) const {
     return (m_listAllInducts == o.m_listAllInducts)
         && (m_timestampMilliseconds == o.m_timestampMilliseconds)
         && (m_bundleCountEgress == o.m_bundleCountEgress)
         && (m_bundleCountStorage == o.m_bundleCountStorage)
         && (m_bundleByteCountEgress == o.m_bundleByteCountEgress)
-        && (m_bundleByteCountStorage == o.m_bundleByteCountStorage);
+        && (m_bundleByteCountStorage == o.m_bundleByteCountStorage)
+        && (m_bufferPoolNumAllocations == o.m_bufferPoolNumAllocations)
+        && (m_bufferPoolNumHits == o.m_bufferPoolNumHits)
+        && (m_bufferPoolNumBytesCached == o.m_bufferPoolNumBytesCached)
+        && (m_admissionControlNumBundlesDropped == o.m_admissionControlNumBundlesDropped)
+        && (m_admissionControlNumBytesDropped == o.m_admissionControlNumBytesDropped);
 }
 bool AllInductTelemetry_t::operator!=(const AllInductTelemetry_t& o) const {
     return !(*this == o);
@@ -929,6 +1050,11 @@ bool AllInductTelemetry_t::SetValuesFromPropertyTree(const boost::property_tree:
         m_bundleCountStorage = pt.get<uint64_t>("bundleCountStorage");
         m_bundleByteCountEgress = pt.get<uint64_t>("bundleByteCountEgress");
         m_bundleByteCountStorage = pt.get<uint64_t>("bundleByteCountStorage");
+        m_bufferPoolNumAllocations = pt.get<uint64_t>("bufferPoolNumAllocations", 0);
+        m_bufferPoolNumHits = pt.get<uint64_t>("bufferPoolNumHits", 0);
+        m_bufferPoolNumBytesCached = pt.get<uint64_t>("bufferPoolNumBytesCached", 0);
+        m_admissionControlNumBundlesDropped = pt.get<uint64_t>("admissionControlNumBundlesDropped", 0);
+        m_admissionControlNumBytesDropped = pt.get<uint64_t>("admissionControlNumBytesDropped", 0);
         const boost::property_tree::ptree& allInductsPt = pt.get_child("allInducts", EMPTY_PTREE); //non-throw version
         m_listAllInducts.clear();
         BOOST_FOREACH(const boost::property_tree::ptree::value_type & inductPt, allInductsPt) {
@@ -949,6 +1075,11 @@ boost::property_tree::ptree AllInductTelemetry_t::GetNewPropertyTree() const {
     pt.put("bundleCountStorage", m_bundleCountStorage);
     pt.put("bundleByteCountEgress", m_bundleByteCountEgress);
     pt.put("bundleByteCountStorage", m_bundleByteCountStorage);
+    pt.put("bufferPoolNumAllocations", m_bufferPoolNumAllocations);
+    pt.put("bufferPoolNumHits", m_bufferPoolNumHits);
+    pt.put("bufferPoolNumBytesCached", m_bufferPoolNumBytesCached);
+    pt.put("admissionControlNumBundlesDropped", m_admissionControlNumBundlesDropped);
+    pt.put("admissionControlNumBytesDropped", m_admissionControlNumBytesDropped);
     boost::property_tree::ptree& allInductsPt = pt.put_child("allInducts",
         m_listAllInducts.empty() ? boost::property_tree::ptree("[]") : boost::property_tree::ptree());
     for (std::list<InductTelemetry_t>::const_iterator it = m_listAllInducts.cbegin(); it != m_listAllInducts.cend(); ++it) {
@@ -971,7 +1102,11 @@ OutductTelemetry_t::OutductTelemetry_t() :
     m_totalBundleBytesSent(0),
     m_totalBundlesFailedToSend(0),
     m_linkIsUpPhysically(false),
-    m_linkIsUpPerTimeSchedule(false)
+    m_linkIsUpPerTimeSchedule(false),
+    m_numBundlesInEgressQueue(0),
+    m_averageEgressQueueTimeMicroseconds(0),
+    m_maxEgressQueueTimeMicroseconds(0),
+    m_numFlowsInEgressScheduler(0)
 {
 }
 OutductTelemetry_t::~OutductTelemetry_t() {}
@@ -983,7 +1118,11 @@ bool OutductTelemetry_t::operator==(const OutductTelemetry_t& o) const {
         && (m_totalBundleBytesSent == o.m_totalBundleBytesSent)
         && (m_totalBundlesFailedToSend == o.m_totalBundlesFailedToSend)
         && (m_linkIsUpPhysically == o.m_linkIsUpPhysically)
-        && (m_linkIsUpPerTimeSchedule == o.m_linkIsUpPerTimeSchedule);
+        && (m_linkIsUpPerTimeSchedule == o.m_linkIsUpPerTimeSchedule)
+        && (m_numBundlesInEgressQueue == o.m_numBundlesInEgressQueue)
+        && (m_averageEgressQueueTimeMicroseconds == o.m_averageEgressQueueTimeMicroseconds)
+        && (m_maxEgressQueueTimeMicroseconds == o.m_maxEgressQueueTimeMicroseconds)
+        && (m_numFlowsInEgressScheduler == o.m_numFlowsInEgressScheduler);
 }
 bool OutductTelemetry_t::operator!=(const OutductTelemetry_t& o) const {
     return !(*this == o);
@@ -998,6 +1137,11 @@ bool OutductTelemetry_t::SetValuesFromPropertyTree(const boost::property_tree::p
         m_totalBundlesFailedToSend = pt.get<uint64_t>("totalBundlesFailedToSend");
         m_linkIsUpPhysically = pt.get<bool>("linkIsUpPhysically");
         m_linkIsUpPerTimeSchedule = pt.get<bool>("linkIsUpPerTimeSchedule");
+        //optional (absent when egress forwards on its single reader thread)
+        m_numBundlesInEgressQueue = pt.get<uint64_t>("numBundlesInEgressQueue", 0);
+        m_averageEgressQueueTimeMicroseconds = pt.get<uint64_t>("averageEgressQueueTimeMicroseconds", 0);
+        m_maxEgressQueueTimeMicroseconds = pt.get<uint64_t>("maxEgressQueueTimeMicroseconds", 0);
+        m_numFlowsInEgressScheduler = pt.get<uint64_t>("numFlowsInEgressScheduler", 0);
     }
     catch (const boost::property_tree::ptree_error& e) {
         LOG_ERROR(subprocess) << "parsing JSON OutductTelemetry_t: " << e.what();
@@ -1015,6 +1159,10 @@ boost::property_tree::ptree OutductTelemetry_t::GetNewPropertyTree() const {
     pt.put("totalBundlesFailedToSend", m_totalBundlesFailedToSend);
     pt.put("linkIsUpPhysically", m_linkIsUpPhysically);
     pt.put("linkIsUpPerTimeSchedule", m_linkIsUpPerTimeSchedule);
+    pt.put("numBundlesInEgressQueue", m_numBundlesInEgressQueue);
+    pt.put("averageEgressQueueTimeMicroseconds", m_averageEgressQueueTimeMicroseconds);
+    pt.put("maxEgressQueueTimeMicroseconds", m_maxEgressQueueTimeMicroseconds);
+    pt.put("numFlowsInEgressScheduler", m_numFlowsInEgressScheduler);
     return pt;
 }
 uint64_t OutductTelemetry_t::GetTotalBundlesQueued() const {
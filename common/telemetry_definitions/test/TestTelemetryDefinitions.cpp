@@ -45,6 +45,27 @@ BOOST_AUTO_TEST_CASE(TelemetryDefinitionsStorageTestCase)
     t.m_usedSpaceBytes = 150;
     t.m_freeSpaceBytes = 160;
 
+    //from BundleStorageManagerBase's RAM cache tier
+    t.m_numBundlesInRamCache = 161;
+    t.m_numBundleBytesInRamCache = 162;
+    t.m_totalRamCacheHits = 163;
+    t.m_totalRamCacheMisses = 164;
+    t.m_totalBundlesFlushedFromRamCacheToDisk = 165;
+    t.m_totalBundlesErasedFromRamCacheBeforeFlush = 166;
+
+    //from BundleStorageManagerBase's RestoreFromDisk
+    t.m_diskRestoreTelemetryVec.resize(2);
+    for (std::size_t i = 0; i < t.m_diskRestoreTelemetryVec.size(); ++i) {
+        StorageDiskRestoreTelemetry_t& diskTelem = t.m_diskRestoreTelemetryVec[i];
+        diskTelem.m_diskIndex = i;
+        diskTelem.m_bytesScanned = 170 + i;
+        diskTelem.m_totalBytesToScan = 180 + i;
+        diskTelem.m_bundlesRestored = 190 + i;
+        diskTelem.m_bundleBytesRestored = 200 + i;
+        diskTelem.m_segmentsRestored = 210 + i;
+        diskTelem.m_restoreCompleted = (i == 0);
+    }
+
     const std::string tJson = t.ToJson();
     //std::cout << tJson << "\n";
     StorageTelemetry_t t2;
@@ -54,6 +75,10 @@ BOOST_AUTO_TEST_CASE(TelemetryDefinitionsStorageTestCase)
     BOOST_REQUIRE_EQUAL(tJson, t2.ToJson());
     t.m_totalBundleWriteOperationsToDisk += 1000;
     BOOST_REQUIRE(t != t2);
+    t.m_totalBundleWriteOperationsToDisk -= 1000;
+    BOOST_REQUIRE(t == t2);
+    t.m_diskRestoreTelemetryVec[1].m_restoreCompleted = true;
+    BOOST_REQUIRE(t != t2);
 }
 
 
@@ -67,6 +92,8 @@ BOOST_AUTO_TEST_CASE(TelemetryDefinitionsOutductTestCase)
         oct.maxBundleSizeBytesInPipeline = 5000;
         oct.outductArrayIndex = 2;
         oct.nextHopNodeId = 10;
+        oct.totalBundleBytesGivenToOutduct = 123456;
+        oct.bundleBytesInEgressQueue = 789;
         oct.finalDestinationEidList = { cbhe_eid_t(1,1), cbhe_eid_t(2,1) };
         oct.finalDestinationNodeIdList = { 3, 4, 5 };
 
@@ -182,6 +209,11 @@ BOOST_AUTO_TEST_CASE(AllInductTelemetryTestCase)
     ait.m_bundleCountStorage = 102;
     ait.m_bundleByteCountEgress = 103;
     ait.m_bundleByteCountStorage = 104;
+    ait.m_bufferPoolNumAllocations = 105;
+    ait.m_bufferPoolNumHits = 106;
+    ait.m_bufferPoolNumBytesCached = 107;
+    ait.m_admissionControlNumBundlesDropped = 108;
+    ait.m_admissionControlNumBytesDropped = 109;
 
     {
         ait.m_listAllInducts.emplace_back();
@@ -467,6 +499,10 @@ BOOST_AUTO_TEST_CASE(AllOutductTelemetryTestCase)
         ot.m_totalBundlesFailedToSend = ot.m_convergenceLayer.size() + 4;
         ot.m_linkIsUpPhysically = (ot.m_convergenceLayer == "stcp");
         ot.m_linkIsUpPerTimeSchedule = (ot.m_convergenceLayer == "udp");
+        ot.m_numBundlesInEgressQueue = ot.m_convergenceLayer.size() + 5;
+        ot.m_averageEgressQueueTimeMicroseconds = ot.m_convergenceLayer.size() + 6;
+        ot.m_maxEgressQueueTimeMicroseconds = ot.m_convergenceLayer.size() + 7;
+        ot.m_numFlowsInEgressScheduler = ot.m_convergenceLayer.size() + 8;
     }
     const std::string aotJson = aot.ToJson();
     //std::cout << aotJson << "\n";
@@ -0,0 +1,189 @@
+/**
+ * @file InprocMessageChannel.h
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * This InprocMessageChannel class is a bounded, lock-free, multiple producer single consumer queue
+ * used to pass messages (moved, never copied) between the modules of hdtn-one-process
+ * in place of a ZeroMQ inproc socket pair.
+ * Each slot of the ring carries its own sequence number so that any number of producer threads
+ * can claim slots with a single compare-and-swap while the one consumer thread pops them in order without any atomic read-modify-write.
+ * The consumer thread may sleep in zmq::poll alongside its ZeroMQ sockets by polling the file descriptor of the
+ * InprocWakeupEvent (an eventfd on Linux, a pipe on other POSIX systems).  Producers only signal the event
+ * (a system call) when the consumer has announced that it is about to sleep, so a busy channel costs no system calls.
+ */
+
+#ifndef _INPROC_MESSAGE_CHANNEL_H
+#define _INPROC_MESSAGE_CHANNEL_H 1
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <boost/core/noncopyable.hpp>
+#include "hdtn_util_export.h"
+
+class InprocWakeupEvent : private boost::noncopyable {
+public:
+#ifdef _WIN32
+    typedef uintptr_t fd_type; //matches zmq_fd_t (SOCKET)
+#else
+    typedef int fd_type; //matches zmq_fd_t
+#endif
+    HDTN_UTIL_EXPORT InprocWakeupEvent();
+    HDTN_UTIL_EXPORT ~InprocWakeupEvent();
+
+    /// @return True if the event was created and its file descriptor can be polled, or False if not supported on this platform.
+    HDTN_UTIL_EXPORT bool IsValid() const noexcept;
+    /// Make the file descriptor readable (thread safe).
+    HDTN_UTIL_EXPORT void Notify() noexcept;
+    /// Make the file descriptor no longer readable (consumer thread only).
+    HDTN_UTIL_EXPORT void Clear() noexcept;
+    /// @return The file descriptor to be placed in a zmq::pollitem_t (with a NULL socket) and polled for ZMQ_POLLIN.
+    HDTN_UTIL_EXPORT fd_type GetPollFd() const noexcept;
+private:
+    int m_readFd;
+    int m_writeFd; //equal to m_readFd for an eventfd
+};
+
+template <typename T>
+class InprocMessageChannel : private boost::noncopyable {
+private:
+    InprocMessageChannel() = delete;
+public:
+    /**
+     * Allocate the ring (every slot's T is default constructed once, then only moved into and out of).
+     * @param capacity The maximum number of messages in the channel, rounded up to a power of 2.
+     */
+    explicit InprocMessageChannel(const uint32_t capacity) :
+        m_mask(RoundUpToPowerOf2(capacity) - 1),
+        m_slots(new slot_t[static_cast<std::size_t>(m_mask) + 1]),
+        m_enqueuePos(0),
+        m_consumerWaiting(false),
+        m_dequeuePos(0)
+    {
+        for (uint64_t i = 0; i <= m_mask; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Move a message into the channel (safe to call from any number of producer threads).
+     * @param value The message to move into the channel; left untouched if the channel is full.
+     * @return True if the message was moved into the channel, or False if the channel is full.
+     */
+    bool TryPush(T&& value) {
+        uint64_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        slot_t* slot;
+        while (true) {
+            slot = &m_slots[pos & m_mask];
+            const uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+            const int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) { //full (consumer has not yet freed this slot from the previous lap)
+                return false;
+            }
+            else { //another producer claimed this slot
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        slot->data = std::move(value);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+
+        //pairs with the fence in PrepareToWait: either the consumer sees this message or this producer sees the consumer waiting
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_consumerWaiting.load(std::memory_order_relaxed) && m_consumerWaiting.exchange(false, std::memory_order_acq_rel)) {
+            m_wakeupEvent.Notify();
+        }
+        return true;
+    }
+
+    /**
+     * Move the oldest message out of the channel (consumer thread only).
+     * @param value The message moved out of the channel.
+     * @return True if a message was popped, or False if the channel is empty.
+     */
+    bool TryPop(T& value) {
+        slot_t& slot = m_slots[m_dequeuePos & m_mask];
+        const uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+        if (seq != (m_dequeuePos + 1)) {
+            return false;
+        }
+        value = std::move(slot.data);
+        slot.sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+        ++m_dequeuePos;
+        return true;
+    }
+
+    /**
+     * Announce that the consumer thread is about to sleep on the wakeup event (consumer thread only).
+     * @return True if the channel already has a message (so the consumer should not block), or False otherwise.
+     */
+    bool PrepareToWait() noexcept {
+        m_consumerWaiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const slot_t& slot = m_slots[m_dequeuePos & m_mask];
+        return (slot.sequence.load(std::memory_order_acquire) == (m_dequeuePos + 1));
+    }
+
+    /**
+     * Announce that the consumer thread has woken up (consumer thread only).
+     * @param wakeupFdReadable True if zmq::poll reported the wakeup event's file descriptor as readable.
+     */
+    void FinishWait(const bool wakeupFdReadable) noexcept {
+        m_consumerWaiting.store(false, std::memory_order_relaxed);
+        if (wakeupFdReadable) {
+            m_wakeupEvent.Clear();
+        }
+    }
+
+    bool IsValid() const noexcept {
+        return m_wakeupEvent.IsValid();
+    }
+
+    InprocWakeupEvent::fd_type GetPollFd() const noexcept {
+        return m_wakeupEvent.GetPollFd();
+    }
+
+    uint32_t GetCapacity() const noexcept {
+        return m_mask + 1;
+    }
+
+private:
+    static uint32_t RoundUpToPowerOf2(const uint32_t capacity) noexcept {
+        uint32_t rounded = 2;
+        while ((rounded < capacity) && (rounded < (1u << 31))) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+    struct slot_t {
+        std::atomic<uint64_t> sequence;
+        T data;
+    };
+
+    const uint32_t m_mask;
+    std::unique_ptr<slot_t[]> m_slots;
+    InprocWakeupEvent m_wakeupEvent;
+
+    //the padding keeps the producer and consumer positions on separate cache lines
+    //(without relying on over-aligned new, which needs C++17)
+    uint8_t m_padding0[64];
+    std::atomic<uint64_t> m_enqueuePos; //producers
+    std::atomic<bool> m_consumerWaiting;
+    uint8_t m_padding1[64];
+    uint64_t m_dequeuePos; //consumer
+    uint8_t m_padding2[64];
+};
+
+#endif //_INPROC_MESSAGE_CHANNEL_H
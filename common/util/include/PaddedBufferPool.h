@@ -0,0 +1,96 @@
+/**
+ * @file PaddedBufferPool.h
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * This PaddedBufferPool class is a size-classed, thread-safe pool of raw memory blocks used by the
+ * PaddedMallocator (the allocator of padded_vector_uint8_t) when USE_PADDED_BUFFER_POOL is defined.
+ * Inducts allocate one bundle buffer per received bundle, and that buffer is usually freed from another thread
+ * (e.g. a ZeroMQ cleanup callback once ingress has sent the bundle on).  Rather than returning multi-megabyte
+ * buffers to the heap, a freed block is kept on the free list of its size class so that the next bundle of a
+ * similar size reuses it (with its pages already faulted in).
+ * Size classes are spaced four per power of 2 (at most 25% wasted space) from 512 bytes to 128 MiB;
+ * larger requests bypass the pool.
+ * Each block carries a small hidden header recording the pool and size class it came from,
+ * so a block can be freed from any thread and is always returned to its pool of origin.
+ */
+
+#ifndef _PADDED_BUFFER_POOL_H
+#define _PADDED_BUFFER_POOL_H 1
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <boost/thread/mutex.hpp>
+#include <boost/core/noncopyable.hpp>
+#include "hdtn_util_export.h"
+
+class PaddedBufferPool : private boost::noncopyable {
+public:
+    static constexpr unsigned int MIN_SIZE_CLASS_SHIFT = 9; //512 bytes
+    static constexpr unsigned int MAX_SIZE_CLASS_SHIFT = 27; //128 MiB
+    static constexpr unsigned int SIZE_CLASSES_PER_POWER_OF_2 = 4;
+    static constexpr unsigned int NUM_SIZE_CLASSES = ((MAX_SIZE_CLASS_SHIFT - MIN_SIZE_CLASS_SHIFT) * SIZE_CLASSES_PER_POWER_OF_2) + 1;
+    static constexpr unsigned int OVERSIZE_CLASS_INDEX = NUM_SIZE_CLASSES;
+    static constexpr uint64_t DEFAULT_MAX_BYTES_CACHED = 256u * 1024u * 1024u;
+
+    /**
+     * @param maxBytesCached The maximum total size of the blocks held on the free lists; blocks freed beyond this are returned to the heap.
+     */
+    HDTN_UTIL_EXPORT explicit PaddedBufferPool(const uint64_t maxBytesCached = DEFAULT_MAX_BYTES_CACHED);
+    /// Return the cached blocks to the heap.  Blocks still in use must not be freed after the pool is destroyed.
+    HDTN_UTIL_EXPORT ~PaddedBufferPool();
+
+    /**
+     * Allocate a block of at least numBytes usable bytes (thread safe).
+     * @param numBytes The number of usable bytes.
+     * @return A pointer to the usable bytes (aligned like malloc), or NULL if the heap is exhausted.
+     */
+    HDTN_UTIL_EXPORT void* Allocate(const std::size_t numBytes);
+
+    /**
+     * Free a block returned by Allocate from any pool (thread safe).  The block goes back to the pool it came from.
+     * @param p The pointer returned by Allocate, or NULL.
+     */
+    HDTN_UTIL_EXPORT static void Deallocate(void* p) noexcept;
+
+    /// @return The process-wide pool used by the PaddedMallocator.  It is never destroyed, so buffers may be freed during static destruction.
+    HDTN_UTIL_EXPORT static PaddedBufferPool& GetGlobalInstance();
+
+    /// @return The size class index serving a block of totalBlockBytes (hidden header included), or OVERSIZE_CLASS_INDEX.
+    HDTN_UTIL_EXPORT static unsigned int SizeClassIndexFromBlockSize(const std::size_t totalBlockBytes) noexcept;
+    /// @return The total block size (hidden header included) of the given size class index.
+    HDTN_UTIL_EXPORT static std::size_t BlockSizeFromSizeClassIndex(const unsigned int sizeClassIndex) noexcept;
+
+    /// @return The number of calls to Allocate that succeeded.
+    HDTN_UTIL_EXPORT uint64_t GetNumAllocations() const noexcept;
+    /// @return The number of allocations served from a free list rather than from the heap.
+    HDTN_UTIL_EXPORT uint64_t GetNumPoolHits() const noexcept;
+    /// @return The number of allocations too large for any size class.
+    HDTN_UTIL_EXPORT uint64_t GetNumOversizeAllocations() const noexcept;
+    /// @return The total size of the blocks currently held on the free lists.
+    HDTN_UTIL_EXPORT uint64_t GetNumBytesCached() const noexcept;
+
+private:
+    struct BlockHeader;
+    struct SizeClassFreeList {
+        SizeClassFreeList() : m_headPtr(NULL) {}
+        boost::mutex m_mutex;
+        BlockHeader* m_headPtr;
+    };
+    void ReturnBlock(BlockHeader* blockHeaderPtr) noexcept;
+
+    const uint64_t M_MAX_BYTES_CACHED;
+    SizeClassFreeList m_freeLists[NUM_SIZE_CLASSES];
+    std::atomic<uint64_t> m_numBytesCached;
+    std::atomic<uint64_t> m_numAllocations;
+    std::atomic<uint64_t> m_numPoolHits;
+    std::atomic<uint64_t> m_numOversizeAllocations;
+};
+
+#endif //_PADDED_BUFFER_POOL_H
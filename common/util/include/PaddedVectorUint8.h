@@ -17,6 +17,9 @@
  * This allocator adds contiguous bytes of padding before and after a vector (used by an induct)
  * so that bundles can be manipulated in place (grow a few bytes in either direction) without
  * the need to reallocate/copy a modified bundle.
+ * When USE_PADDED_BUFFER_POOL is defined (set by the hdtn_util target), the memory comes from
+ * the process-wide PaddedBufferPool so that bundle buffers freed by another thread are recycled
+ * instead of being returned to the heap.  Otherwise this header stays stand-alone (malloc/free).
  */
 
 #ifndef PADDED_VECTOR_UINT8_H
@@ -27,6 +30,9 @@
 #include <limits>
 #include <iostream>
 #include <vector>
+#ifdef USE_PADDED_BUFFER_POOL
+#include "PaddedBufferPool.h"
+#endif
 
 struct PaddedMallocatorConstants {
     static constexpr std::size_t PADDING_ELEMENTS_BEFORE = 256;
@@ -52,7 +58,11 @@ struct PaddedMallocator {
         //if (elementsWithPadding > std::numeric_limits<std::size_t>::max() / sizeof(T))
         //    throw std::bad_array_new_length();
 
+#ifdef USE_PADDED_BUFFER_POOL
+        if (T* p = static_cast<T*>(PaddedBufferPool::GetGlobalInstance().Allocate(elementsWithPadding * sizeof(T)))) {
+#else
         if (T* p = static_cast<T*>(std::malloc(elementsWithPadding * sizeof(T)))) {
+#endif
             return p + PaddedMallocatorConstants::PADDING_ELEMENTS_BEFORE;
         }
 
@@ -61,7 +71,11 @@ struct PaddedMallocator {
 
     void deallocate(T* p, std::size_t n) noexcept {
         (void)n;
+#ifdef USE_PADDED_BUFFER_POOL
+        PaddedBufferPool::Deallocate(p - PaddedMallocatorConstants::PADDING_ELEMENTS_BEFORE);
+#else
         std::free(p - PaddedMallocatorConstants::PADDING_ELEMENTS_BEFORE);
+#endif
     }
 
     //force default initialize construction
@@ -0,0 +1,104 @@
+/**
+ * @file SharedMemoryBundleTransport.h
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * The SharedMemoryBundleWriter and SharedMemoryBundleReader classes let distributed HDTN modules
+ * running on the same host pass bundles through shared memory instead of through their ZeroMQ TCP sockets
+ * (see sharedMemoryBundleTransport in HdtnDistributedConfig).
+ * A writer owns a named shared memory segment divided into fixed size slots.  Sending a bundle copies it once
+ * into a free slot and sends, in place of the bundle part of the ZeroMQ message, a small SharedMemoryBundleDescriptor.
+ * The reader (any process on the host) turns the descriptor back into a zero-copy zmq::message_t of the bundle in the
+ * shared segment, and the slot is given back to the writer when that message is released (e.g. after the outduct sent it).
+ * Bundles that do not fit in a slot, or sent while all slots are in use, are sent inline as before,
+ * so a reader must accept both.  Like LtpIpcEngine, this relies on boost::interprocess.
+ */
+
+#ifndef _SHARED_MEMORY_BUNDLE_TRANSPORT_H
+#define _SHARED_MEMORY_BUNDLE_TRANSPORT_H 1
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <boost/core/noncopyable.hpp>
+#include "zmq.hpp"
+#include "hdtn_util_export.h"
+
+struct SharedMemoryBundleDescriptor {
+    static constexpr uint64_t MAGIC = 0x31444e4254444853ULL; //"SHDTBND1", first byte 'S' is neither a bpv6 nor a bpv7 first byte
+    static constexpr std::size_t MAX_NAME_SIZE = 32; //including the null terminator
+
+    uint64_t magic;
+    uint64_t instanceId; //of the writer's segment, changes if the writer is restarted
+    uint64_t bundleSizeBytes;
+    uint32_t slotIndex;
+    uint32_t reserved;
+    char sharedMemoryName[MAX_NAME_SIZE];
+};
+static_assert(sizeof(SharedMemoryBundleDescriptor) == 64, "SharedMemoryBundleDescriptor must be 64 bytes");
+
+class SharedMemoryBundleWriter : private boost::noncopyable {
+private:
+    SharedMemoryBundleWriter() = delete;
+public:
+    /**
+     * Create (replacing any stale one) the named shared memory segment.
+     * @param sharedMemoryName The segment name, at most SharedMemoryBundleDescriptor::MAX_NAME_SIZE - 1 characters.
+     * @param numSlots The number of bundles that may be in flight through shared memory at once.
+     * @param slotSizeBytes The largest bundle sent through shared memory.
+     */
+    HDTN_UTIL_EXPORT SharedMemoryBundleWriter(const std::string& sharedMemoryName, const uint32_t numSlots, const uint64_t slotSizeBytes);
+    /// Remove the segment name.  Readers keep their mapping until they release their bundles.
+    HDTN_UTIL_EXPORT ~SharedMemoryBundleWriter();
+
+    /// @return True if the segment was created, or False if shared memory is not available (then Send always sends inline).
+    HDTN_UTIL_EXPORT bool IsValid() const noexcept;
+
+    /**
+     * Send the bundle part of a multipart message (thread safe, but the socket must be protected by the caller as usual).
+     * The bundle goes through shared memory if it fits in a free slot, otherwise it is sent inline.
+     * @param socket The socket to send on.
+     * @param bundle The bundle; like socket.send(std::move(bundle), flags), it is emptied only on success.
+     * @param flags The send flags.
+     * @return True if the part was sent.
+     */
+    HDTN_UTIL_EXPORT bool Send(zmq::socket_t& socket, zmq::message_t& bundle, const zmq::send_flags flags);
+
+    HDTN_UTIL_EXPORT uint64_t GetNumBundlesSentThroughSharedMemory() const noexcept;
+    HDTN_UTIL_EXPORT uint64_t GetNumBundlesSentInline() const noexcept;
+    /// @return The number of slots not yet released by the readers.
+    HDTN_UTIL_EXPORT uint32_t GetNumSlotsInUse() const noexcept;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_pimpl;
+};
+
+class SharedMemoryBundleReader : private boost::noncopyable {
+public:
+    HDTN_UTIL_EXPORT SharedMemoryBundleReader();
+    HDTN_UTIL_EXPORT ~SharedMemoryBundleReader();
+
+    /// @return True if the message is a SharedMemoryBundleDescriptor (rather than an inline bundle).
+    HDTN_UTIL_EXPORT static bool IsDescriptor(const zmq::message_t& bundlePart) noexcept;
+
+    /**
+     * If bundlePart is a SharedMemoryBundleDescriptor, replace it with a zero-copy message of the bundle in shared memory
+     * (thread safe).  Any other message is left untouched.
+     * @param bundlePart The received bundle part.
+     * @return False if bundlePart is a descriptor whose segment cannot be opened (e.g. the writer exited before this reader mapped its segment, or runs on another host),
+     * in which case the bundle is lost and bundlePart is left untouched; otherwise True.
+     */
+    HDTN_UTIL_EXPORT bool Resolve(zmq::message_t& bundlePart);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_pimpl;
+};
+
+#endif //_SHARED_MEMORY_BUNDLE_TRANSPORT_H
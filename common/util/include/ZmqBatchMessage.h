@@ -0,0 +1,116 @@
+/**
+ * @file ZmqBatchMessage.h
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * Helpers for the multipart ZeroMQ batch messages exchanged between the HDTN modules
+ * (e.g. HDTN_MSGTYPE_EGRESS_BATCH and HDTN_MSGTYPE_STORE_BATCH).
+ * A batch of N bundles is one multipart message made of a header whose base.type is the batch type,
+ * then one part holding the N per-bundle headers back to back, then N parts holding the bundles.
+ * A receiver that stops reading a multipart message early must discard the unread parts,
+ * otherwise the next bundle part would be read as the next header.
+ */
+
+#ifndef _ZMQ_BATCH_MESSAGE_H
+#define _ZMQ_BATCH_MESSAGE_H 1
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "zmq.hpp"
+#include "SharedMemoryBundleTransport.h"
+
+namespace hdtn {
+
+/// Discards the unread parts of a multipart message so that the next recv starts at a header.
+inline void DiscardRemainingMessageParts(zmq::socket_t& socket) {
+    while (socket.get(zmq::sockopt::rcvmore)) {
+        zmq::message_t discardedPart;
+        if (!socket.recv(discardedPart, zmq::recv_flags::none)) {
+            break;
+        }
+    }
+}
+
+/// Sends headers.size() bundles (moved from the front of bundles) as one batch message of type batchMessageType.
+/// Returns the number of bundles sent (0 if the message was not accepted, e.g. zmq high water mark when using dontwait).
+/// If sharedMemoryBundleWriterPtr is not NULL, the bundles are sent through it (the receiver must resolve them with a SharedMemoryBundleReader).
+template <typename HdrType>
+std::size_t SendBatchMessage(zmq::socket_t& socket, const uint16_t batchMessageType,
+    const std::vector<HdrType>& headers, std::vector<zmq::message_t>& bundles, const zmq::send_flags flags = zmq::send_flags::dontwait,
+    SharedMemoryBundleWriter* sharedMemoryBundleWriterPtr = NULL)
+{
+    const std::size_t numBundles = headers.size();
+    if ((numBundles == 0) || (bundles.size() < numBundles)) {
+        return 0;
+    }
+    HdrType batchHdr = HdrType();
+    batchHdr.base.type = batchMessageType;
+    zmq::message_t zmqMessageBatchHdr(&batchHdr, sizeof(HdrType));
+    zmq::message_t zmqMessageHeaders(headers.data(), numBundles * sizeof(HdrType));
+    if (!socket.send(std::move(zmqMessageBatchHdr), zmq::send_flags::sndmore | flags)) {
+        return 0;
+    }
+    if (!socket.send(std::move(zmqMessageHeaders), zmq::send_flags::sndmore | flags)) {
+        return 0;
+    }
+    std::size_t numSent = 0;
+    for (; numSent < numBundles; ++numSent) {
+        const bool isLast = ((numSent + 1) == numBundles);
+        const zmq::send_flags bundleFlags = (isLast) ? flags : (zmq::send_flags::sndmore | flags);
+        if (sharedMemoryBundleWriterPtr) {
+            if (!sharedMemoryBundleWriterPtr->Send(socket, bundles[numSent], bundleFlags)) {
+                break;
+            }
+        }
+        else if (!socket.send(std::move(bundles[numSent]), bundleFlags)) {
+            break;
+        }
+    }
+    return numSent;
+}
+
+/// Receives the rest of a batch message whose batch header was already received.
+/// Returns true if the whole batch was received (bundles.size() == headers.size()).
+/// On failure the unread parts are discarded and bundles holds the bundles received so far (for headers[0..bundles.size()-1]).
+template <typename HdrType>
+bool ReceiveBatchMessage(zmq::socket_t& socket, std::vector<HdrType>& headers, std::vector<zmq::message_t>& bundles) {
+    headers.resize(0);
+    bundles.resize(0);
+    zmq::message_t zmqMessageHeaders;
+    if ((!socket.recv(zmqMessageHeaders, zmq::recv_flags::none))
+        || (zmqMessageHeaders.size() == 0) || ((zmqMessageHeaders.size() % sizeof(HdrType)) != 0))
+    {
+        DiscardRemainingMessageParts(socket);
+        return false;
+    }
+    const std::size_t numBundles = zmqMessageHeaders.size() / sizeof(HdrType);
+    headers.resize(numBundles);
+    memcpy(static_cast<void*>(headers.data()), zmqMessageHeaders.data(), zmqMessageHeaders.size()); //force alignment
+    bundles.reserve(numBundles);
+    for (std::size_t i = 0; i < numBundles; ++i) {
+        if (!socket.get(zmq::sockopt::rcvmore)) {
+            return false; //fewer bundles than headers
+        }
+        bundles.emplace_back();
+        if (!socket.recv(bundles.back(), zmq::recv_flags::none)) {
+            bundles.pop_back();
+            DiscardRemainingMessageParts(socket);
+            return false;
+        }
+    }
+    if (socket.get(zmq::sockopt::rcvmore)) { //more bundles than headers
+        DiscardRemainingMessageParts(socket);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace hdtn
+
+#endif //_ZMQ_BATCH_MESSAGE_H
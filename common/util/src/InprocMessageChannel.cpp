@@ -0,0 +1,90 @@
+/**
+ * @file InprocMessageChannel.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include "InprocMessageChannel.h"
+#include "Logger.h"
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#elif !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static constexpr hdtn::Logger::SubProcess subprocess = hdtn::Logger::SubProcess::none;
+
+InprocWakeupEvent::InprocWakeupEvent() :
+    m_readFd(-1),
+    m_writeFd(-1)
+{
+#if defined(__linux__)
+    m_readFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_readFd < 0) {
+        LOG_ERROR(subprocess) << "InprocWakeupEvent: cannot create eventfd";
+    }
+    m_writeFd = m_readFd;
+#elif !defined(_WIN32)
+    int fds[2];
+    if (pipe(fds) != 0) {
+        LOG_ERROR(subprocess) << "InprocWakeupEvent: cannot create pipe";
+        return;
+    }
+    for (unsigned int i = 0; i < 2; ++i) {
+        fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+        fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+    }
+    m_readFd = fds[0];
+    m_writeFd = fds[1];
+#endif //_WIN32 not supported (zmq_poll only polls sockets there), callers fall back to ZeroMQ
+}
+
+InprocWakeupEvent::~InprocWakeupEvent() {
+#ifndef _WIN32
+    if (m_readFd >= 0) {
+        close(m_readFd);
+    }
+    if ((m_writeFd >= 0) && (m_writeFd != m_readFd)) {
+        close(m_writeFd);
+    }
+#endif
+}
+
+bool InprocWakeupEvent::IsValid() const noexcept {
+    return (m_readFd >= 0);
+}
+
+void InprocWakeupEvent::Notify() noexcept {
+#if defined(__linux__)
+    const uint64_t one = 1;
+    if (write(m_writeFd, &one, sizeof(one)) < 0) {
+        //EAGAIN => counter would overflow, consumer already has a pending wakeup
+    }
+#elif !defined(_WIN32)
+    const uint8_t one = 1;
+    if (write(m_writeFd, &one, sizeof(one)) < 0) {
+        //EAGAIN => pipe full, consumer already has a pending wakeup
+    }
+#endif
+}
+
+void InprocWakeupEvent::Clear() noexcept {
+#if defined(__linux__)
+    uint64_t count;
+    if (read(m_readFd, &count, sizeof(count)) < 0) {
+        //EAGAIN => already cleared
+    }
+#elif !defined(_WIN32)
+    uint8_t buf[64];
+    while (read(m_readFd, buf, sizeof(buf)) > 0) {}
+#endif
+}
+
+InprocWakeupEvent::fd_type InprocWakeupEvent::GetPollFd() const noexcept {
+    return static_cast<fd_type>(m_readFd);
+}
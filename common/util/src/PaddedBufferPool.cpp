@@ -0,0 +1,139 @@
+/**
+ * @file PaddedBufferPool.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include "PaddedBufferPool.h"
+#include <cstdlib>
+#include <boost/multiprecision/cpp_int.hpp>
+#include <boost/multiprecision/detail/bitscan.hpp>
+
+//the hidden header in front of every block; its size keeps the usable bytes aligned like malloc
+struct alignas(16) PaddedBufferPool::BlockHeader {
+    PaddedBufferPool* m_originPoolPtr;
+    BlockHeader* m_nextFreePtr; //only valid while on a free list
+    unsigned int m_sizeClassIndex;
+};
+
+PaddedBufferPool::PaddedBufferPool(const uint64_t maxBytesCached) :
+    M_MAX_BYTES_CACHED(maxBytesCached),
+    m_numBytesCached(0),
+    m_numAllocations(0),
+    m_numPoolHits(0),
+    m_numOversizeAllocations(0) {}
+
+PaddedBufferPool::~PaddedBufferPool() {
+    for (unsigned int i = 0; i < NUM_SIZE_CLASSES; ++i) {
+        BlockHeader* blockHeaderPtr = m_freeLists[i].m_headPtr;
+        while (blockHeaderPtr) {
+            BlockHeader* const nextPtr = blockHeaderPtr->m_nextFreePtr;
+            std::free(blockHeaderPtr);
+            blockHeaderPtr = nextPtr;
+        }
+        m_freeLists[i].m_headPtr = NULL;
+    }
+}
+
+PaddedBufferPool& PaddedBufferPool::GetGlobalInstance() {
+    static PaddedBufferPool* const globalInstancePtr = new PaddedBufferPool(); //intentionally never deleted
+    return *globalInstancePtr;
+}
+
+unsigned int PaddedBufferPool::SizeClassIndexFromBlockSize(const std::size_t totalBlockBytes) noexcept {
+    if (totalBlockBytes <= (static_cast<std::size_t>(1) << MIN_SIZE_CLASS_SHIFT)) {
+        return 0;
+    }
+    //totalBlockBytes is in (2^msb, 2^(msb+1)], which holds the four classes 5*2^(msb-2) .. 8*2^(msb-2)
+    const uint64_t v = totalBlockBytes - 1;
+    const unsigned int msb = boost::multiprecision::detail::find_msb<uint64_t>(v);
+    if (msb >= MAX_SIZE_CLASS_SHIFT) {
+        return OVERSIZE_CLASS_INDEX;
+    }
+    const unsigned int quarterMultiple = static_cast<unsigned int>(v >> (msb - 2)) + 1; //5..8
+    return ((msb - MIN_SIZE_CLASS_SHIFT) * SIZE_CLASSES_PER_POWER_OF_2) + (quarterMultiple - SIZE_CLASSES_PER_POWER_OF_2);
+}
+
+std::size_t PaddedBufferPool::BlockSizeFromSizeClassIndex(const unsigned int sizeClassIndex) noexcept {
+    const unsigned int shift = MIN_SIZE_CLASS_SHIFT + (sizeClassIndex / SIZE_CLASSES_PER_POWER_OF_2) - 2;
+    return static_cast<std::size_t>(SIZE_CLASSES_PER_POWER_OF_2 + (sizeClassIndex % SIZE_CLASSES_PER_POWER_OF_2)) << shift;
+}
+
+void* PaddedBufferPool::Allocate(const std::size_t numBytes) {
+    const std::size_t totalBlockBytes = numBytes + sizeof(BlockHeader);
+    const unsigned int sizeClassIndex = SizeClassIndexFromBlockSize(totalBlockBytes);
+    BlockHeader* blockHeaderPtr = NULL;
+    if (sizeClassIndex == OVERSIZE_CLASS_INDEX) {
+        blockHeaderPtr = static_cast<BlockHeader*>(std::malloc(totalBlockBytes));
+        if (blockHeaderPtr == NULL) {
+            return NULL;
+        }
+        m_numOversizeAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        SizeClassFreeList& freeList = m_freeLists[sizeClassIndex];
+        {
+            boost::mutex::scoped_lock lock(freeList.m_mutex);
+            blockHeaderPtr = freeList.m_headPtr;
+            if (blockHeaderPtr) {
+                freeList.m_headPtr = blockHeaderPtr->m_nextFreePtr;
+            }
+        }
+        if (blockHeaderPtr) {
+            m_numBytesCached.fetch_sub(BlockSizeFromSizeClassIndex(sizeClassIndex), std::memory_order_relaxed);
+            m_numPoolHits.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            blockHeaderPtr = static_cast<BlockHeader*>(std::malloc(BlockSizeFromSizeClassIndex(sizeClassIndex)));
+            if (blockHeaderPtr == NULL) {
+                return NULL;
+            }
+        }
+    }
+    m_numAllocations.fetch_add(1, std::memory_order_relaxed);
+    blockHeaderPtr->m_originPoolPtr = this;
+    blockHeaderPtr->m_nextFreePtr = NULL;
+    blockHeaderPtr->m_sizeClassIndex = sizeClassIndex;
+    return blockHeaderPtr + 1;
+}
+
+void PaddedBufferPool::Deallocate(void* p) noexcept {
+    if (p) {
+        BlockHeader* const blockHeaderPtr = static_cast<BlockHeader*>(p) - 1;
+        blockHeaderPtr->m_originPoolPtr->ReturnBlock(blockHeaderPtr);
+    }
+}
+
+void PaddedBufferPool::ReturnBlock(BlockHeader* blockHeaderPtr) noexcept {
+    const unsigned int sizeClassIndex = blockHeaderPtr->m_sizeClassIndex;
+    if (sizeClassIndex == OVERSIZE_CLASS_INDEX) {
+        std::free(blockHeaderPtr);
+        return;
+    }
+    const uint64_t blockSize = BlockSizeFromSizeClassIndex(sizeClassIndex);
+    if ((m_numBytesCached.fetch_add(blockSize, std::memory_order_relaxed) + blockSize) > M_MAX_BYTES_CACHED) {
+        m_numBytesCached.fetch_sub(blockSize, std::memory_order_relaxed);
+        std::free(blockHeaderPtr);
+        return;
+    }
+    SizeClassFreeList& freeList = m_freeLists[sizeClassIndex];
+    boost::mutex::scoped_lock lock(freeList.m_mutex);
+    blockHeaderPtr->m_nextFreePtr = freeList.m_headPtr;
+    freeList.m_headPtr = blockHeaderPtr;
+}
+
+uint64_t PaddedBufferPool::GetNumAllocations() const noexcept {
+    return m_numAllocations.load(std::memory_order_relaxed);
+}
+uint64_t PaddedBufferPool::GetNumPoolHits() const noexcept {
+    return m_numPoolHits.load(std::memory_order_relaxed);
+}
+uint64_t PaddedBufferPool::GetNumOversizeAllocations() const noexcept {
+    return m_numOversizeAllocations.load(std::memory_order_relaxed);
+}
+uint64_t PaddedBufferPool::GetNumBytesCached() const noexcept {
+    return m_numBytesCached.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,286 @@
+/**
+ * @file SharedMemoryBundleTransport.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include "SharedMemoryBundleTransport.h"
+#include "Logger.h"
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <new>
+#include <random>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/make_unique.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+static constexpr hdtn::Logger::SubProcess subprocess = hdtn::Logger::SubProcess::none;
+
+//the slot states are shared between processes, so they must not fall back to a (process local) lock
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "std::atomic<uint32_t> must be always lock free");
+
+//segment layout: SegmentHeader, then one std::atomic<uint32_t> state per slot (0 => free), then the slots
+struct SegmentHeader {
+    uint64_t magic;
+    uint64_t instanceId;
+    uint64_t slotSizeBytes;
+    uint32_t numSlots;
+    uint32_t reserved;
+};
+static constexpr std::size_t SLOT_STATES_OFFSET = 64;
+
+static std::size_t GetSlotsOffset(const uint32_t numSlots) {
+    const std::size_t slotStatesEnd = SLOT_STATES_OFFSET + (numSlots * sizeof(std::atomic<uint32_t>));
+    return (slotStatesEnd + 63) & (~static_cast<std::size_t>(63)); //cache line aligned
+}
+
+struct SharedMemoryBundleWriter::Impl : private boost::noncopyable {
+    Impl(const std::string& sharedMemoryName, const uint32_t numSlots, const uint64_t slotSizeBytes);
+    ~Impl();
+    bool TryAcquireSlot(uint32_t& slotIndex) noexcept;
+
+    const std::string m_sharedMemoryName;
+    const uint32_t M_NUM_SLOTS;
+    const uint64_t M_SLOT_SIZE_BYTES;
+    uint64_t m_instanceId;
+    std::unique_ptr<boost::interprocess::shared_memory_object> m_sharedMemoryObjectPtr;
+    std::unique_ptr<boost::interprocess::mapped_region> m_mappedRegionPtr;
+    std::atomic<uint32_t>* m_slotStates;
+    uint8_t* m_slotsStart;
+    std::atomic<uint32_t> m_nextSlotHint;
+    std::atomic<uint64_t> m_numBundlesSentThroughSharedMemory;
+    std::atomic<uint64_t> m_numBundlesSentInline;
+};
+
+SharedMemoryBundleWriter::Impl::Impl(const std::string& sharedMemoryName, const uint32_t numSlots, const uint64_t slotSizeBytes) :
+    m_sharedMemoryName(sharedMemoryName),
+    M_NUM_SLOTS(numSlots),
+    M_SLOT_SIZE_BYTES(slotSizeBytes),
+    m_instanceId(0),
+    m_slotStates(NULL),
+    m_slotsStart(NULL),
+    m_nextSlotHint(0),
+    m_numBundlesSentThroughSharedMemory(0),
+    m_numBundlesSentInline(0)
+{
+    if ((sharedMemoryName.size() >= SharedMemoryBundleDescriptor::MAX_NAME_SIZE) || (numSlots == 0) || (slotSizeBytes == 0)) {
+        LOG_ERROR(subprocess) << "SharedMemoryBundleWriter: invalid name (" << sharedMemoryName << "), number of slots, or slot size";
+        return;
+    }
+    //owner/creator shall try to remove on constructor and destructor
+    boost::interprocess::shared_memory_object::remove(m_sharedMemoryName.c_str());
+    const std::size_t slotsOffset = GetSlotsOffset(numSlots);
+    try {
+        m_sharedMemoryObjectPtr = boost::make_unique<boost::interprocess::shared_memory_object>(
+            boost::interprocess::create_only, m_sharedMemoryName.c_str(), boost::interprocess::read_write);
+        m_sharedMemoryObjectPtr->truncate(static_cast<boost::interprocess::offset_t>(slotsOffset + (numSlots * slotSizeBytes)));
+        m_mappedRegionPtr = boost::make_unique<boost::interprocess::mapped_region>(*m_sharedMemoryObjectPtr, boost::interprocess::read_write);
+    }
+    catch (const boost::interprocess::interprocess_exception& e) {
+        LOG_ERROR(subprocess) << "SharedMemoryBundleWriter: cannot create shared memory " << m_sharedMemoryName << ": " << e.what();
+        m_mappedRegionPtr.reset();
+        m_sharedMemoryObjectPtr.reset();
+        return;
+    }
+
+    //differs between runs so that a reader never resolves a descriptor against a previous writer's segment
+    std::random_device randomDevice;
+    m_instanceId = (static_cast<uint64_t>(randomDevice()) << 32) ^ randomDevice()
+        ^ static_cast<uint64_t>((boost::posix_time::microsec_clock::universal_time() - boost::posix_time::from_time_t(0)).total_microseconds());
+
+    uint8_t* const addr = static_cast<uint8_t*>(m_mappedRegionPtr->get_address());
+    m_slotStates = reinterpret_cast<std::atomic<uint32_t>*>(addr + SLOT_STATES_OFFSET);
+    for (uint32_t i = 0; i < numSlots; ++i) {
+        new (&m_slotStates[i]) std::atomic<uint32_t>(0); //placement new
+    }
+    m_slotsStart = addr + slotsOffset;
+    SegmentHeader* const headerPtr = reinterpret_cast<SegmentHeader*>(addr);
+    headerPtr->instanceId = m_instanceId;
+    headerPtr->slotSizeBytes = slotSizeBytes;
+    headerPtr->numSlots = numSlots;
+    headerPtr->reserved = 0;
+    headerPtr->magic = SharedMemoryBundleDescriptor::MAGIC;
+    LOG_INFO(subprocess) << "created shared memory " << m_sharedMemoryName << " for " << numSlots << " bundles of up to " << slotSizeBytes << " bytes";
+}
+
+SharedMemoryBundleWriter::Impl::~Impl() {
+    m_mappedRegionPtr.reset();
+    m_sharedMemoryObjectPtr.reset();
+    if ((m_instanceId != 0) && boost::interprocess::shared_memory_object::remove(m_sharedMemoryName.c_str())) {
+        LOG_INFO(subprocess) << "removed shared memory " << m_sharedMemoryName;
+    }
+}
+
+bool SharedMemoryBundleWriter::Impl::TryAcquireSlot(uint32_t& slotIndex) noexcept {
+    const uint32_t startIndex = m_nextSlotHint.fetch_add(1, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < M_NUM_SLOTS; ++i) {
+        const uint32_t index = (startIndex + i) % M_NUM_SLOTS;
+        std::atomic<uint32_t>& slotState = m_slotStates[index];
+        uint32_t expected = 0;
+        if ((slotState.load(std::memory_order_relaxed) == 0)
+            && slotState.compare_exchange_strong(expected, 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            slotIndex = index;
+            return true;
+        }
+    }
+    return false;
+}
+
+SharedMemoryBundleWriter::SharedMemoryBundleWriter(const std::string& sharedMemoryName, const uint32_t numSlots, const uint64_t slotSizeBytes) :
+    m_pimpl(boost::make_unique<SharedMemoryBundleWriter::Impl>(sharedMemoryName, numSlots, slotSizeBytes)) {}
+
+SharedMemoryBundleWriter::~SharedMemoryBundleWriter() {}
+
+bool SharedMemoryBundleWriter::IsValid() const noexcept {
+    return (m_pimpl->m_slotsStart != NULL);
+}
+
+bool SharedMemoryBundleWriter::Send(zmq::socket_t& socket, zmq::message_t& bundle, const zmq::send_flags flags) {
+    Impl& impl = *m_pimpl;
+    const std::size_t bundleSize = bundle.size();
+    uint32_t slotIndex;
+    if ((bundleSize != 0) && (bundleSize <= impl.M_SLOT_SIZE_BYTES) && impl.m_slotsStart && impl.TryAcquireSlot(slotIndex)) {
+        memcpy(impl.m_slotsStart + (slotIndex * impl.M_SLOT_SIZE_BYTES), bundle.data(), bundleSize);
+        SharedMemoryBundleDescriptor descriptor;
+        memset(&descriptor, 0, sizeof(descriptor));
+        descriptor.magic = SharedMemoryBundleDescriptor::MAGIC;
+        descriptor.instanceId = impl.m_instanceId;
+        descriptor.bundleSizeBytes = bundleSize;
+        descriptor.slotIndex = slotIndex;
+        memcpy(descriptor.sharedMemoryName, impl.m_sharedMemoryName.data(), impl.m_sharedMemoryName.size());
+        if (socket.send(zmq::const_buffer(&descriptor, sizeof(descriptor)), flags)) {
+            bundle.rebuild(); //the reader now owns the slot
+            impl.m_numBundlesSentThroughSharedMemory.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        impl.m_slotStates[slotIndex].store(0, std::memory_order_release);
+        return false;
+    }
+    if (socket.send(std::move(bundle), flags)) {
+        impl.m_numBundlesSentInline.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+uint64_t SharedMemoryBundleWriter::GetNumBundlesSentThroughSharedMemory() const noexcept {
+    return m_pimpl->m_numBundlesSentThroughSharedMemory.load(std::memory_order_relaxed);
+}
+uint64_t SharedMemoryBundleWriter::GetNumBundlesSentInline() const noexcept {
+    return m_pimpl->m_numBundlesSentInline.load(std::memory_order_relaxed);
+}
+uint32_t SharedMemoryBundleWriter::GetNumSlotsInUse() const noexcept {
+    uint32_t numSlotsInUse = 0;
+    if (m_pimpl->m_slotStates) {
+        for (uint32_t i = 0; i < m_pimpl->M_NUM_SLOTS; ++i) {
+            numSlotsInUse += (m_pimpl->m_slotStates[i].load(std::memory_order_relaxed) != 0);
+        }
+    }
+    return numSlotsInUse;
+}
+
+
+//a writer's segment as mapped by a reader; shared by the bundles resolved from it so it outlives a reopen
+struct MappedSegment : private boost::noncopyable {
+    std::unique_ptr<boost::interprocess::mapped_region> m_mappedRegionPtr;
+    uint64_t m_instanceId;
+    uint64_t m_slotSizeBytes;
+    uint32_t m_numSlots;
+    std::atomic<uint32_t>* m_slotStates;
+    uint8_t* m_slotsStart;
+};
+struct SlotLease {
+    std::shared_ptr<MappedSegment> m_segmentPtr;
+    uint32_t m_slotIndex;
+};
+static void ReleaseSlot(void* data, void* hint) {
+    (void)data;
+    SlotLease* const leasePtr = static_cast<SlotLease*>(hint);
+    leasePtr->m_segmentPtr->m_slotStates[leasePtr->m_slotIndex].store(0, std::memory_order_release);
+    delete leasePtr;
+}
+
+struct SharedMemoryBundleReader::Impl : private boost::noncopyable {
+    static std::shared_ptr<MappedSegment> OpenSegment(const char* sharedMemoryName);
+
+    boost::mutex m_mutex;
+    std::map<std::string, std::shared_ptr<MappedSegment> > m_mapNameToSegment;
+};
+
+std::shared_ptr<MappedSegment> SharedMemoryBundleReader::Impl::OpenSegment(const char* sharedMemoryName) {
+    std::shared_ptr<MappedSegment> segmentPtr = std::make_shared<MappedSegment>();
+    try {
+        boost::interprocess::shared_memory_object sharedMemoryObject(boost::interprocess::open_only, sharedMemoryName, boost::interprocess::read_write);
+        segmentPtr->m_mappedRegionPtr = boost::make_unique<boost::interprocess::mapped_region>(sharedMemoryObject, boost::interprocess::read_write);
+    }
+    catch (const boost::interprocess::interprocess_exception& e) {
+        LOG_ERROR(subprocess) << "SharedMemoryBundleReader: cannot open shared memory " << sharedMemoryName << ": " << e.what();
+        return std::shared_ptr<MappedSegment>();
+    }
+    uint8_t* const addr = static_cast<uint8_t*>(segmentPtr->m_mappedRegionPtr->get_address());
+    const std::size_t regionSize = segmentPtr->m_mappedRegionPtr->get_size();
+    const SegmentHeader* const headerPtr = reinterpret_cast<const SegmentHeader*>(addr);
+    if ((regionSize < SLOT_STATES_OFFSET) || (headerPtr->magic != SharedMemoryBundleDescriptor::MAGIC)
+        || (regionSize < (GetSlotsOffset(headerPtr->numSlots) + (headerPtr->numSlots * headerPtr->slotSizeBytes))))
+    {
+        LOG_ERROR(subprocess) << "SharedMemoryBundleReader: shared memory " << sharedMemoryName << " is not a bundle segment";
+        return std::shared_ptr<MappedSegment>();
+    }
+    segmentPtr->m_instanceId = headerPtr->instanceId;
+    segmentPtr->m_slotSizeBytes = headerPtr->slotSizeBytes;
+    segmentPtr->m_numSlots = headerPtr->numSlots;
+    segmentPtr->m_slotStates = reinterpret_cast<std::atomic<uint32_t>*>(addr + SLOT_STATES_OFFSET);
+    segmentPtr->m_slotsStart = addr + GetSlotsOffset(headerPtr->numSlots);
+    return segmentPtr;
+}
+
+SharedMemoryBundleReader::SharedMemoryBundleReader() :
+    m_pimpl(boost::make_unique<SharedMemoryBundleReader::Impl>()) {}
+
+SharedMemoryBundleReader::~SharedMemoryBundleReader() {}
+
+bool SharedMemoryBundleReader::IsDescriptor(const zmq::message_t& bundlePart) noexcept {
+    uint64_t magic;
+    if (bundlePart.size() != sizeof(SharedMemoryBundleDescriptor)) {
+        return false;
+    }
+    memcpy(&magic, bundlePart.data(), sizeof(magic));
+    return (magic == SharedMemoryBundleDescriptor::MAGIC);
+}
+
+bool SharedMemoryBundleReader::Resolve(zmq::message_t& bundlePart) {
+    if (!IsDescriptor(bundlePart)) {
+        return true; //inline bundle
+    }
+    SharedMemoryBundleDescriptor descriptor;
+    memcpy(&descriptor, bundlePart.data(), sizeof(descriptor)); //force alignment
+    descriptor.sharedMemoryName[SharedMemoryBundleDescriptor::MAX_NAME_SIZE - 1] = '\0';
+    std::shared_ptr<MappedSegment> segmentPtr;
+    {
+        boost::mutex::scoped_lock lock(m_pimpl->m_mutex);
+        std::shared_ptr<MappedSegment>& cachedSegmentPtr = m_pimpl->m_mapNameToSegment[descriptor.sharedMemoryName];
+        if ((!cachedSegmentPtr) || (cachedSegmentPtr->m_instanceId != descriptor.instanceId)) { //first use or the writer restarted
+            cachedSegmentPtr = Impl::OpenSegment(descriptor.sharedMemoryName);
+        }
+        segmentPtr = cachedSegmentPtr;
+    }
+    if ((!segmentPtr) || (segmentPtr->m_instanceId != descriptor.instanceId)
+        || (descriptor.slotIndex >= segmentPtr->m_numSlots) || (descriptor.bundleSizeBytes > segmentPtr->m_slotSizeBytes))
+    {
+        LOG_ERROR(subprocess) << "SharedMemoryBundleReader: cannot resolve a bundle in shared memory " << descriptor.sharedMemoryName;
+        return false;
+    }
+    SlotLease* const leasePtr = new SlotLease();
+    leasePtr->m_segmentPtr = segmentPtr;
+    leasePtr->m_slotIndex = descriptor.slotIndex;
+    bundlePart = zmq::message_t(segmentPtr->m_slotsStart + (descriptor.slotIndex * segmentPtr->m_slotSizeBytes),
+        static_cast<std::size_t>(descriptor.bundleSizeBytes), ReleaseSlot, leasePtr);
+    return true;
+}
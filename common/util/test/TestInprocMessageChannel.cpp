@@ -0,0 +1,124 @@
+/**
+ * @file TestInprocMessageChannel.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "InprocMessageChannel.h"
+#include "zmq.hpp"
+#include <boost/thread.hpp>
+#include <boost/make_unique.hpp>
+#include <memory>
+#include <vector>
+
+typedef std::unique_ptr<uint64_t> test_message_t; //move only, like a bundle
+
+BOOST_AUTO_TEST_CASE(InprocMessageChannelSingleThreadTestCase)
+{
+    InprocMessageChannel<test_message_t> channel(5); //rounded up to 8
+    BOOST_REQUIRE_EQUAL(channel.GetCapacity(), 8);
+    test_message_t msg;
+    BOOST_REQUIRE(!channel.TryPop(msg));
+    for (uint64_t lap = 0; lap < 3; ++lap) { //wrap around the ring
+        for (uint64_t i = 0; i < 8; ++i) {
+            test_message_t toPush = boost::make_unique<uint64_t>((lap * 100) + i);
+            BOOST_REQUIRE(channel.TryPush(std::move(toPush)));
+            BOOST_REQUIRE(!toPush); //moved
+        }
+        test_message_t toPushWhenFull = boost::make_unique<uint64_t>(12345);
+        BOOST_REQUIRE(!channel.TryPush(std::move(toPushWhenFull)));
+        BOOST_REQUIRE(toPushWhenFull); //not moved when full
+        BOOST_REQUIRE_EQUAL(*toPushWhenFull, 12345);
+        for (uint64_t i = 0; i < 8; ++i) {
+            BOOST_REQUIRE(channel.TryPop(msg));
+            BOOST_REQUIRE(msg);
+            BOOST_REQUIRE_EQUAL(*msg, (lap * 100) + i); //fifo
+        }
+        BOOST_REQUIRE(!channel.TryPop(msg));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(InprocMessageChannelWakeupTestCase)
+{
+    InprocMessageChannel<test_message_t> channel(16);
+    if (!channel.IsValid()) {
+        return; //platform cannot poll the wakeup event
+    }
+    zmq::pollitem_t items[1] = { {NULL, channel.GetPollFd(), ZMQ_POLLIN, 0} };
+
+    //nothing pushed => poll times out
+    BOOST_REQUIRE(!channel.PrepareToWait());
+    BOOST_REQUIRE_EQUAL(zmq::poll(&items[0], 1, 0), 0);
+    channel.FinishWait(false);
+
+    //consumer waiting => push signals the event
+    BOOST_REQUIRE(!channel.PrepareToWait());
+    BOOST_REQUIRE(channel.TryPush(boost::make_unique<uint64_t>(1)));
+    BOOST_REQUIRE_EQUAL(zmq::poll(&items[0], 1, 0), 1);
+    BOOST_REQUIRE(items[0].revents & ZMQ_POLLIN);
+    channel.FinishWait(true);
+    BOOST_REQUIRE_EQUAL(zmq::poll(&items[0], 1, 0), 0); //cleared
+
+    //consumer not waiting => push does not signal the event, but PrepareToWait reports the message
+    BOOST_REQUIRE(channel.TryPush(boost::make_unique<uint64_t>(2)));
+    BOOST_REQUIRE_EQUAL(zmq::poll(&items[0], 1, 0), 0);
+    BOOST_REQUIRE(channel.PrepareToWait());
+    channel.FinishWait(false);
+
+    test_message_t msg;
+    BOOST_REQUIRE(channel.TryPop(msg));
+    BOOST_REQUIRE_EQUAL(*msg, 1);
+    BOOST_REQUIRE(channel.TryPop(msg));
+    BOOST_REQUIRE_EQUAL(*msg, 2);
+    BOOST_REQUIRE(!channel.TryPop(msg));
+}
+
+BOOST_AUTO_TEST_CASE(InprocMessageChannelMultipleProducersTestCase)
+{
+    static constexpr unsigned int NUM_PRODUCERS = 4;
+    static constexpr uint64_t NUM_MESSAGES_PER_PRODUCER = 100000;
+    InprocMessageChannel<test_message_t> channel(64); //small so that producers often find it full
+    if (!channel.IsValid()) {
+        return; //platform cannot poll the wakeup event
+    }
+
+    std::vector<std::unique_ptr<boost::thread> > producerThreads;
+    for (unsigned int p = 0; p < NUM_PRODUCERS; ++p) {
+        producerThreads.emplace_back(boost::make_unique<boost::thread>([&channel, p]() {
+            for (uint64_t i = 0; i < NUM_MESSAGES_PER_PRODUCER; ++i) {
+                test_message_t msg = boost::make_unique<uint64_t>((static_cast<uint64_t>(p) << 32) | i);
+                while (!channel.TryPush(std::move(msg))) {
+                    boost::this_thread::yield();
+                }
+            }
+        }));
+    }
+
+    //consumer sleeps in zmq::poll the same way egress does
+    zmq::pollitem_t items[1] = { {NULL, channel.GetPollFd(), ZMQ_POLLIN, 0} };
+    std::vector<uint64_t> nextExpectedPerProducer(NUM_PRODUCERS, 0);
+    uint64_t totalPopped = 0;
+    test_message_t msg;
+    while (totalPopped < (NUM_PRODUCERS * NUM_MESSAGES_PER_PRODUCER)) {
+        const bool hasMessages = channel.PrepareToWait();
+        const int rc = zmq::poll(&items[0], 1, (hasMessages) ? 0 : 2000);
+        BOOST_REQUIRE(hasMessages || (rc == 1)); //a waiting consumer must never miss a wakeup
+        channel.FinishWait((rc > 0) && (items[0].revents & ZMQ_POLLIN));
+        while (channel.TryPop(msg)) {
+            const uint64_t producerIndex = (*msg) >> 32;
+            const uint64_t sequence = (*msg) & UINT32_MAX;
+            BOOST_REQUIRE_LT(producerIndex, NUM_PRODUCERS);
+            BOOST_REQUIRE_EQUAL(sequence, nextExpectedPerProducer[producerIndex]); //fifo per producer
+            ++nextExpectedPerProducer[producerIndex];
+            ++totalPopped;
+        }
+    }
+    for (std::size_t p = 0; p < producerThreads.size(); ++p) {
+        producerThreads[p]->join();
+    }
+    BOOST_REQUIRE(!channel.TryPop(msg));
+}
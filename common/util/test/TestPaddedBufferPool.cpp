@@ -0,0 +1,140 @@
+/**
+ * @file TestPaddedBufferPool.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <cstring>
+#include <vector>
+#include "PaddedBufferPool.h"
+#include "PaddedVectorUint8.h"
+
+BOOST_AUTO_TEST_CASE(PaddedBufferPoolSizeClassTestCase)
+{
+    BOOST_REQUIRE_EQUAL(PaddedBufferPool::SizeClassIndexFromBlockSize(1), 0);
+    BOOST_REQUIRE_EQUAL(PaddedBufferPool::SizeClassIndexFromBlockSize(512), 0);
+    BOOST_REQUIRE_EQUAL(PaddedBufferPool::SizeClassIndexFromBlockSize(513), 1);
+    BOOST_REQUIRE_EQUAL(PaddedBufferPool::BlockSizeFromSizeClassIndex(1), 640);
+    BOOST_REQUIRE_EQUAL(PaddedBufferPool::SizeClassIndexFromBlockSize(1024), 4);
+    BOOST_REQUIRE_EQUAL(PaddedBufferPool::BlockSizeFromSizeClassIndex(4), 1024);
+    BOOST_REQUIRE_EQUAL(PaddedBufferPool::SizeClassIndexFromBlockSize(1025), 5);
+    const std::size_t maxClassSize = static_cast<std::size_t>(1) << PaddedBufferPool::MAX_SIZE_CLASS_SHIFT;
+    BOOST_REQUIRE_EQUAL(PaddedBufferPool::SizeClassIndexFromBlockSize(maxClassSize), PaddedBufferPool::NUM_SIZE_CLASSES - 1);
+    BOOST_REQUIRE_EQUAL(PaddedBufferPool::BlockSizeFromSizeClassIndex(PaddedBufferPool::NUM_SIZE_CLASSES - 1), maxClassSize);
+    BOOST_REQUIRE_EQUAL(PaddedBufferPool::SizeClassIndexFromBlockSize(maxClassSize + 1), PaddedBufferPool::OVERSIZE_CLASS_INDEX);
+
+    //every size maps to the smallest class that fits, with at most 25% wasted
+    for (std::size_t size = 1; size <= (1u << 20); size += 97) {
+        const unsigned int sizeClassIndex = PaddedBufferPool::SizeClassIndexFromBlockSize(size);
+        const std::size_t blockSize = PaddedBufferPool::BlockSizeFromSizeClassIndex(sizeClassIndex);
+        BOOST_REQUIRE_GE(blockSize, size);
+        if (sizeClassIndex != 0) {
+            BOOST_REQUIRE_LT(PaddedBufferPool::BlockSizeFromSizeClassIndex(sizeClassIndex - 1), size);
+            BOOST_REQUIRE_LE(blockSize, size + (size / 4) + 1);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(PaddedBufferPoolRecycleTestCase)
+{
+    PaddedBufferPool pool(1000000);
+    void* p1 = pool.Allocate(3000);
+    BOOST_REQUIRE(p1 != NULL);
+    BOOST_REQUIRE_EQUAL(reinterpret_cast<uintptr_t>(p1) % 16, 0);
+    memset(p1, 0xaa, 3000);
+    BOOST_REQUIRE_EQUAL(pool.GetNumAllocations(), 1);
+    BOOST_REQUIRE_EQUAL(pool.GetNumPoolHits(), 0);
+    PaddedBufferPool::Deallocate(p1);
+    BOOST_REQUIRE_GE(pool.GetNumBytesCached(), 3000);
+
+    //same size class is served from the free list
+    void* p2 = pool.Allocate(2990);
+    BOOST_REQUIRE(p2 == p1);
+    BOOST_REQUIRE_EQUAL(pool.GetNumPoolHits(), 1);
+    BOOST_REQUIRE_EQUAL(pool.GetNumBytesCached(), 0);
+    //different size class is not
+    void* p3 = pool.Allocate(100000);
+    BOOST_REQUIRE(p3 != NULL);
+    BOOST_REQUIRE_EQUAL(pool.GetNumPoolHits(), 1);
+    PaddedBufferPool::Deallocate(p2);
+    PaddedBufferPool::Deallocate(p3);
+    PaddedBufferPool::Deallocate(NULL);
+
+    //the cache is bounded
+    {
+        std::vector<void*> blocks;
+        for (unsigned int i = 0; i < 20; ++i) {
+            blocks.push_back(pool.Allocate(100000));
+        }
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            PaddedBufferPool::Deallocate(blocks[i]);
+        }
+        BOOST_REQUIRE_LE(pool.GetNumBytesCached(), 1000000);
+    }
+
+    //oversize blocks bypass the pool
+    const std::size_t oversize = (static_cast<std::size_t>(1) << PaddedBufferPool::MAX_SIZE_CLASS_SHIFT) + 1;
+    void* p4 = pool.Allocate(oversize);
+    BOOST_REQUIRE(p4 != NULL);
+    BOOST_REQUIRE_EQUAL(pool.GetNumOversizeAllocations(), 1);
+    const uint64_t numBytesCachedBefore = pool.GetNumBytesCached();
+    PaddedBufferPool::Deallocate(p4);
+    BOOST_REQUIRE_EQUAL(pool.GetNumBytesCached(), numBytesCachedBefore);
+}
+
+BOOST_AUTO_TEST_CASE(PaddedBufferPoolReturnToOriginTestCase)
+{
+    PaddedBufferPool poolA;
+    PaddedBufferPool poolB;
+    static constexpr unsigned int NUM_BLOCKS = 1000;
+    std::vector<void*> blocks(NUM_BLOCKS);
+    for (unsigned int i = 0; i < NUM_BLOCKS; ++i) {
+        blocks[i] = ((i & 1) ? poolB : poolA).Allocate(1000 + i);
+        BOOST_REQUIRE(blocks[i] != NULL);
+    }
+    //free from other threads; every block goes back to the pool it came from
+    boost::thread t0([&blocks]() { for (unsigned int i = 0; i < NUM_BLOCKS; i += 2) { PaddedBufferPool::Deallocate(blocks[i]); } });
+    boost::thread t1([&blocks]() { for (unsigned int i = 1; i < NUM_BLOCKS; i += 2) { PaddedBufferPool::Deallocate(blocks[i]); } });
+    t0.join();
+    t1.join();
+    BOOST_REQUIRE_GT(poolA.GetNumBytesCached(), 0);
+    BOOST_REQUIRE_GT(poolB.GetNumBytesCached(), 0);
+    //poolA's blocks are all reusable by poolA and none went to poolB
+    for (unsigned int i = 0; i < NUM_BLOCKS; i += 2) {
+        blocks[i] = poolA.Allocate(1000 + i);
+    }
+    BOOST_REQUIRE_EQUAL(poolA.GetNumPoolHits(), NUM_BLOCKS / 2);
+    BOOST_REQUIRE_EQUAL(poolB.GetNumPoolHits(), 0);
+    for (unsigned int i = 0; i < NUM_BLOCKS; i += 2) {
+        PaddedBufferPool::Deallocate(blocks[i]);
+    }
+}
+
+#ifdef USE_PADDED_BUFFER_POOL
+BOOST_AUTO_TEST_CASE(PaddedBufferPoolPaddedVectorTestCase)
+{
+    PaddedBufferPool& pool = PaddedBufferPool::GetGlobalInstance();
+    {
+        padded_vector_uint8_t v(50000);
+        v[0] = 1;
+    }
+    padded_vector_uint8_t* vPtr = NULL;
+    boost::thread t([&vPtr]() { //allocated by one thread, freed by another (like a zmq cleanup callback)
+        vPtr = new padded_vector_uint8_t(49000);
+        (*vPtr)[0] = 2;
+    });
+    t.join();
+    delete vPtr;
+    const uint64_t numPoolHitsBefore = pool.GetNumPoolHits();
+    {
+        padded_vector_uint8_t v(49500);
+        v[0] = 3;
+    }
+    BOOST_REQUIRE_GT(pool.GetNumPoolHits(), numPoolHitsBefore);
+}
+#endif
@@ -0,0 +1,95 @@
+/**
+ * @file TestSharedMemoryBundleTransport.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "SharedMemoryBundleTransport.h"
+#include "zmq.hpp"
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(SharedMemoryBundleTransportTestCase)
+{
+    zmq::context_t ctx;
+    zmq::socket_t sender(ctx, zmq::socket_type::pair);
+    zmq::socket_t receiver(ctx, zmq::socket_type::pair);
+    receiver.bind("inproc://TestSharedMemoryBundleTransport");
+    sender.connect("inproc://TestSharedMemoryBundleTransport");
+
+    SharedMemoryBundleReader reader;
+    std::vector<zmq::message_t> resolvedBundles;
+    {
+        SharedMemoryBundleWriter writer("hdtn_test_shm_bundles", 2, 100);
+        BOOST_REQUIRE(writer.IsValid());
+
+        //fits in a slot: only the descriptor is sent
+        static const std::string BUNDLE_STRING("bundle in shared memory");
+        zmq::message_t bundle(BUNDLE_STRING.data(), BUNDLE_STRING.size());
+        BOOST_REQUIRE(writer.Send(sender, bundle, zmq::send_flags::dontwait));
+        BOOST_REQUIRE_EQUAL(bundle.size(), 0); //moved
+        BOOST_REQUIRE_EQUAL(writer.GetNumBundlesSentThroughSharedMemory(), 1);
+        BOOST_REQUIRE_EQUAL(writer.GetNumSlotsInUse(), 1);
+        zmq::message_t part;
+        BOOST_REQUIRE(receiver.recv(part, zmq::recv_flags::none));
+        BOOST_REQUIRE_EQUAL(part.size(), sizeof(SharedMemoryBundleDescriptor));
+        BOOST_REQUIRE(SharedMemoryBundleReader::IsDescriptor(part));
+        BOOST_REQUIRE(reader.Resolve(part));
+        BOOST_REQUIRE_EQUAL(part.to_string(), BUNDLE_STRING);
+        part = zmq::message_t(); //release the bundle, which frees its slot
+        BOOST_REQUIRE_EQUAL(writer.GetNumSlotsInUse(), 0);
+
+        //too large for a slot: sent inline, and Resolve leaves it alone
+        const std::string largeBundleString(101, 'x');
+        zmq::message_t largeBundle(largeBundleString.data(), largeBundleString.size());
+        BOOST_REQUIRE(writer.Send(sender, largeBundle, zmq::send_flags::dontwait));
+        BOOST_REQUIRE_EQUAL(writer.GetNumBundlesSentInline(), 1);
+        BOOST_REQUIRE(receiver.recv(part, zmq::recv_flags::none));
+        BOOST_REQUIRE(!SharedMemoryBundleReader::IsDescriptor(part));
+        BOOST_REQUIRE(reader.Resolve(part));
+        BOOST_REQUIRE_EQUAL(part.to_string(), largeBundleString);
+
+        //all slots in use: sent inline
+        for (unsigned int i = 0; i < 3; ++i) {
+            const std::string s(1, static_cast<char>('a' + i));
+            zmq::message_t smallBundle(s.data(), s.size());
+            BOOST_REQUIRE(writer.Send(sender, smallBundle, zmq::send_flags::dontwait));
+            resolvedBundles.emplace_back();
+            BOOST_REQUIRE(receiver.recv(resolvedBundles.back(), zmq::recv_flags::none));
+            BOOST_REQUIRE(reader.Resolve(resolvedBundles.back()));
+            BOOST_REQUIRE_EQUAL(resolvedBundles.back().to_string(), s);
+        }
+        BOOST_REQUIRE_EQUAL(writer.GetNumBundlesSentThroughSharedMemory(), 3);
+        BOOST_REQUIRE_EQUAL(writer.GetNumBundlesSentInline(), 2);
+        BOOST_REQUIRE_EQUAL(writer.GetNumSlotsInUse(), 2);
+
+        //a descriptor that is sent but not received before the writer exits
+        zmq::message_t lastBundle("z", 1);
+        resolvedBundles.erase(resolvedBundles.begin()); //release "a" to free its slot
+        BOOST_REQUIRE(writer.Send(sender, lastBundle, zmq::send_flags::dontwait));
+        BOOST_REQUIRE_EQUAL(writer.GetNumBundlesSentThroughSharedMemory(), 4);
+    }
+    //bundles resolved before the writer exited stay valid
+    BOOST_REQUIRE_EQUAL(resolvedBundles[0].to_string(), "b"); //in shared memory
+    BOOST_REQUIRE_EQUAL(resolvedBundles[1].to_string(), "c"); //inline
+
+    //a new writer with the same name is a new instance
+    SharedMemoryBundleWriter newWriter("hdtn_test_shm_bundles", 2, 100);
+    BOOST_REQUIRE(newWriter.IsValid());
+    zmq::message_t descriptorOfExitedWriter;
+    BOOST_REQUIRE(receiver.recv(descriptorOfExitedWriter, zmq::recv_flags::none));
+    BOOST_REQUIRE(SharedMemoryBundleReader::IsDescriptor(descriptorOfExitedWriter));
+    zmq::message_t descriptorCopy(descriptorOfExitedWriter.data(), descriptorOfExitedWriter.size());
+    //a reader that has never mapped the old segment cannot resolve it against the new one
+    SharedMemoryBundleReader newReader;
+    BOOST_REQUIRE(!newReader.Resolve(descriptorCopy));
+    BOOST_REQUIRE(SharedMemoryBundleReader::IsDescriptor(descriptorCopy)); //left untouched
+    //a reader still mapping the old segment (its bundles "b" are in use) resolves it from the old segment
+    BOOST_REQUIRE(reader.Resolve(descriptorOfExitedWriter));
+    BOOST_REQUIRE_EQUAL(descriptorOfExitedWriter.to_string(), "z");
+    BOOST_REQUIRE_EQUAL(newWriter.GetNumSlotsInUse(), 0);
+}
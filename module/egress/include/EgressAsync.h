@@ -32,9 +32,15 @@
 #include <boost/core/noncopyable.hpp>
 #include "egress_async_lib_export.h"
 
+template <typename T> class InprocMessageChannel;
+
 
 namespace hdtn {
 
+struct ToEgressInprocMessage;
+typedef InprocMessageChannel<ToEgressInprocMessage> ToEgressInprocChannel; //defined in InprocChannels.hpp
+class DirectOutductForwarder; //defined in InprocChannels.hpp
+
 
 class Egress : private boost::noncopyable {
 public:
@@ -43,7 +49,9 @@ public:
     EGRESS_ASYNC_LIB_EXPORT void Stop();
     EGRESS_ASYNC_LIB_EXPORT bool Init(const HdtnConfig& hdtnConfig,
         const HdtnDistributedConfig& hdtnDistributedConfig,
-        zmq::context_t * hdtnOneProcessZmqInprocContextPtr = NULL);
+        zmq::context_t * hdtnOneProcessZmqInprocContextPtr = NULL,
+        ToEgressInprocChannel * hdtnOneProcessToEgressInprocChannelPtr = NULL,
+        DirectOutductForwarder * hdtnOneProcessDirectOutductForwarderPtr = NULL);
 
 private:
 
@@ -0,0 +1,189 @@
+/**
+ * @file EgressBundleScheduler.h
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * This EgressBundleScheduler class holds the bundles waiting for one outduct (see the outduct's
+ * "egressScheduler" config) and decides which bundle the outduct gets next:
+ * - FIFO: arrival order.
+ * - PRIORITY: strict priority (expedited, then normal, then bulk), arrival order within a priority class.
+ * - DRR: weighted deficit round robin over flows, where a flow is a (source EID, final destination EID, priority)
+ *   triple.  Each round a flow may send up to its quantum of bytes (quantumBytes for bulk,
+ *   twice that for normal and four times that for expedited), so a single large flow
+ *   cannot starve the other flows sharing the outduct.  Bundles of the same flow keep their order.
+ * This class is not thread safe; it is owned by a single egress worker thread.
+ */
+
+#ifndef _EGRESS_BUNDLE_SCHEDULER_H
+#define _EGRESS_BUNDLE_SCHEDULER_H 1
+
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+#include <boost/core/noncopyable.hpp>
+#include "codec/Cbhe.h"
+
+template <typename EntryType>
+class EgressBundleScheduler : private boost::noncopyable {
+public:
+    enum class SchedulerType { FIFO = 0, PRIORITY, DRR };
+    static constexpr unsigned int NUM_PRIORITY_CLASSES = 3; //0 bulk, 1 normal, 2 expedited
+
+    EgressBundleScheduler(const SchedulerType schedulerType, const uint64_t quantumBytes) :
+        M_SCHEDULER_TYPE(schedulerType),
+        M_QUANTUM_BYTES((quantumBytes) ? quantumBytes : 1),
+        m_numEntries(0) {}
+
+    /// @return True if schedulerName is "fifo", "priority" or "drr" (the OutductsConfig egressScheduler values), with schedulerType set.
+    static bool SchedulerTypeFromString(const std::string& schedulerName, SchedulerType& schedulerType) {
+        if (schedulerName == "fifo") {
+            schedulerType = SchedulerType::FIFO;
+        }
+        else if (schedulerName == "priority") {
+            schedulerType = SchedulerType::PRIORITY;
+        }
+        else if (schedulerName == "drr") {
+            schedulerType = SchedulerType::DRR;
+        }
+        else {
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Queue a bundle.
+     * @param entry The bundle (moved from).
+     * @param entrySizeBytes The bundle size charged against its flow's deficit.
+     * @param sourceEid The bundle's source EID.
+     * @param finalDestEid The bundle's final destination EID.
+     * @param priority The bundle's priority class (0 bulk, 1 normal, 2 expedited); larger values are treated as expedited.
+     */
+    void Push(EntryType&& entry, const uint64_t entrySizeBytes, const cbhe_eid_t& sourceEid, const cbhe_eid_t& finalDestEid, unsigned int priority) {
+        if (priority >= NUM_PRIORITY_CLASSES) {
+            priority = NUM_PRIORITY_CLASSES - 1;
+        }
+        ++m_numEntries;
+        if (M_SCHEDULER_TYPE == SchedulerType::FIFO) {
+            m_priorityQueues[0].push_back(std::move(entry));
+        }
+        else if (M_SCHEDULER_TYPE == SchedulerType::PRIORITY) {
+            m_priorityQueues[priority].push_back(std::move(entry));
+        }
+        else {
+            std::pair<typename flow_map_t::iterator, bool> res = m_flowsMap.emplace(FlowKey(sourceEid, finalDestEid, priority), Flow());
+            Flow& flow = res.first->second;
+            if (res.second) { //new (or previously emptied) flow joins the back of the round
+                flow.m_quantumBytes = M_QUANTUM_BYTES << priority;
+                m_activeFlows.push_back(res.first);
+            }
+            flow.m_queue.emplace_back(std::move(entry), entrySizeBytes);
+        }
+    }
+
+    /**
+     * Remove the next bundle to give to the outduct.
+     * @param entry The bundle (moved to).
+     * @return True if a bundle was removed, or False if the scheduler is empty.
+     */
+    bool TryPop(EntryType& entry) {
+        if (m_numEntries == 0) {
+            return false;
+        }
+        if (M_SCHEDULER_TYPE != SchedulerType::DRR) {
+            for (unsigned int i = NUM_PRIORITY_CLASSES; i > 0; --i) {
+                std::deque<EntryType>& q = m_priorityQueues[i - 1];
+                if (!q.empty()) {
+                    entry = std::move(q.front());
+                    q.pop_front();
+                    --m_numEntries;
+                    return true;
+                }
+            }
+            return false;
+        }
+        while (true) { //m_activeFlows is not empty since m_numEntries != 0
+            const typename flow_map_t::iterator flowIt = m_activeFlows.front();
+            Flow& flow = flowIt->second;
+            if (!flow.m_quantumAddedThisTurn) {
+                flow.m_deficitBytes += flow.m_quantumBytes;
+                flow.m_quantumAddedThisTurn = true;
+            }
+            DrrEntry& front = flow.m_queue.front();
+            if (front.second <= flow.m_deficitBytes) {
+                flow.m_deficitBytes -= front.second;
+                entry = std::move(front.first);
+                flow.m_queue.pop_front();
+                --m_numEntries;
+                if (flow.m_queue.empty()) { //an idle flow keeps no deficit
+                    m_activeFlows.pop_front();
+                    m_flowsMap.erase(flowIt);
+                }
+                return true;
+            }
+            //turn over, move this flow to the back of the round
+            flow.m_quantumAddedThisTurn = false;
+            m_activeFlows.splice(m_activeFlows.end(), m_activeFlows, m_activeFlows.begin());
+        }
+    }
+
+    std::size_t GetNumEntries() const noexcept {
+        return m_numEntries;
+    }
+
+    /// @return The number of flows (DRR) or priority classes (PRIORITY, FIFO) currently holding bundles.
+    std::size_t GetNumFlows() const noexcept {
+        if (M_SCHEDULER_TYPE == SchedulerType::DRR) {
+            return m_flowsMap.size();
+        }
+        std::size_t numFlows = 0;
+        for (unsigned int i = 0; i < NUM_PRIORITY_CLASSES; ++i) {
+            numFlows += (!m_priorityQueues[i].empty());
+        }
+        return numFlows;
+    }
+
+private:
+    struct FlowKey {
+        FlowKey(const cbhe_eid_t& sourceEid, const cbhe_eid_t& finalDestEid, const unsigned int priority) :
+            m_sourceEid(sourceEid), m_finalDestEid(finalDestEid), m_priority(priority) {}
+        bool operator<(const FlowKey& o) const {
+            if (m_sourceEid == o.m_sourceEid) {
+                if (m_finalDestEid == o.m_finalDestEid) {
+                    return (m_priority < o.m_priority);
+                }
+                return (m_finalDestEid < o.m_finalDestEid);
+            }
+            return (m_sourceEid < o.m_sourceEid);
+        }
+        cbhe_eid_t m_sourceEid;
+        cbhe_eid_t m_finalDestEid;
+        unsigned int m_priority;
+    };
+    typedef std::pair<EntryType, uint64_t> DrrEntry; //bundle and its size in bytes
+    struct Flow {
+        Flow() : m_deficitBytes(0), m_quantumBytes(0), m_quantumAddedThisTurn(false) {}
+        std::deque<DrrEntry> m_queue;
+        uint64_t m_deficitBytes;
+        uint64_t m_quantumBytes;
+        bool m_quantumAddedThisTurn;
+    };
+    typedef std::map<FlowKey, Flow> flow_map_t;
+
+    const SchedulerType M_SCHEDULER_TYPE;
+    const uint64_t M_QUANTUM_BYTES;
+    std::size_t m_numEntries;
+    std::deque<EntryType> m_priorityQueues[NUM_PRIORITY_CLASSES]; //FIFO and PRIORITY
+    flow_map_t m_flowsMap; //DRR, only flows holding bundles
+    std::list<typename flow_map_t::iterator> m_activeFlows; //DRR round, front is the flow whose turn it is
+};
+
+#endif //_EGRESS_BUNDLE_SCHEDULER_H
@@ -19,7 +19,12 @@
 
 #include "EgressAsync.h"
 #include <string>
+#include <algorithm>
 #include "message.hpp"
+#include "ZmqBatchMessage.h"
+#include "SharedMemoryBundleTransport.h"
+#include "EgressBundleScheduler.h"
+#include "InprocChannels.hpp"
 #include <boost/thread.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/make_unique.hpp>
@@ -31,26 +36,46 @@
 #include "TimestampUtil.h"
 #include "ThreadNamer.h"
 #include "TelemetryServer.h"
+#include "codec/bpv6.h"
+#include "codec/bpv7.h"
 
 namespace hdtn {
 
 static constexpr hdtn::Logger::SubProcess subprocess = hdtn::Logger::SubProcess::egress;
+static constexpr uint64_t EGRESS_WORKER_QUEUE_MIN_CAPACITY = 64; //per outduct worker thread, in whole bundles
+static const boost::posix_time::time_duration OUTDUCT_VOLUME_REPORT_INTERVAL = boost::posix_time::seconds(1);
 
 struct Egress::Impl : private boost::noncopyable {
 
     Impl();
     ~Impl();
     void Stop();
-    bool Init(const HdtnConfig& hdtnConfig, const HdtnDistributedConfig& hdtnDistributedConfig, zmq::context_t* hdtnOneProcessZmqInprocContextPtr);
+    bool Init(const HdtnConfig& hdtnConfig, const HdtnDistributedConfig& hdtnDistributedConfig, zmq::context_t* hdtnOneProcessZmqInprocContextPtr,
+        ToEgressInprocChannel* hdtnOneProcessToEgressInprocChannelPtr, DirectOutductForwarder* hdtnOneProcessDirectOutductForwarderPtr);
 
 private:
     void RouterEventHandler();
     void ReadZmqThreadFunc();
+    bool ResolveBundle(zmq::message_t& zmqMessageBundle, const bool isCutThroughFromIngress);
+    void ProcessToEgressMessage(const hdtn::ToEgressHdr& toEgressHeader, zmq::message_t& zmqMessageBundle, const bool isCutThroughFromIngress);
+    bool ForwardToOutduct(Outduct& outduct, const hdtn::ToEgressHdr& toEgressHeader, zmq::message_t& zmqMessageBundle, const bool isCutThroughFromIngress);
+    bool DirectForwardFromIngress(const hdtn::ToEgressHdr& toEgressHeader, zmq::message_t& zmqMessageBundle);
+    void EgressWorkerThreadFunc(const uint64_t outductUuid);
+    void NotifyEgressWorkerOfOutductAck(const uint64_t outductUuid);
+    struct EgressWorker;
+    struct EgressWorkerQueueEntry;
+    void ForwardEgressWorkerQueueEntry(EgressWorker& worker, Outduct& outduct, EgressWorkerQueueEntry& entry);
+    Outduct* GetOutductForBundle(const cbhe_eid_t& finalDestEid, zmq::message_t& zmqMessageBundle);
+    void PopulateBundlesGivenToOutductsTelemetry();
+    void ForwardBundleToRouter(zmq::message_t& zmqMessageBundleToRouter);
     void WholeBundleReadyCallback(padded_vector_uint8_t& wholeBundleVec);
     void OnFailedBundleZmqSendCallback(zmq::message_t& movableBundle, std::vector<uint8_t>& userData, uint64_t outductUuid, bool successCallbackCalled);
     void OnSuccessfulBundleSendCallback(std::vector<uint8_t>& userData, uint64_t outductUuid);
     void OnOutductLinkStatusChangedCallback(bool isLinkDownEvent, uint64_t outductUuid);
     void ResendOutductCapabilities();
+    uint64_t GetBundleBytesInEgressQueue(const uint64_t outductUuid) const;
+    void PopulateOutductVolumes(AllOutductCapabilitiesTelemetry_t& allOutductCapabilitiesTelemetry);
+    void TrySendOutductVolumesToRouter();
     void RouterEventHandler(hdtn::IreleaseChangeHdr& releaseChangeHdr);
     void SetMaxSendRate(uint64_t rateBps, uint64_t outductUuid);
 
@@ -63,6 +88,10 @@ private:
     static const uint64_t NO_OUTDUCT;
     uint64_t m_totalTcpclBundlesReceivedMutexProtected;
     uint64_t m_totalTcpclBundleBytesReceivedMutexProtected;
+    uint64_t m_totalBundlesGivenToOutductsByReaderThread; //only accessed by ReadZmqThreadFunc (until joined)
+    uint64_t m_totalBundleBytesGivenToOutductsByReaderThread;
+    std::atomic<uint64_t> m_totalBundlesGivenToOutductsDirectlyByIngress;
+    std::atomic<uint64_t> m_totalBundleBytesGivenToOutductsDirectlyByIngress;
 
     std::unique_ptr<zmq::context_t> m_zmqCtxPtr;
     std::unique_ptr<zmq::socket_t> m_zmqPullSock_boundIngressToConnectingEgressPtr;
@@ -74,6 +103,10 @@ private:
     boost::mutex m_mutex_zmqPushSock_boundEgressToConnectingStorage;
     std::unique_ptr<zmq::socket_t> m_zmqPushSock_boundEgressToConnectingRouterPtr;
     std::unique_ptr<zmq::socket_t> m_zmqPullSock_connectingRouterToBoundEgressPtr;
+    std::vector<hdtn::ToEgressHdr> m_batchToEgressHeaders; //only used by ReadZmqThreadFunc for HDTN_MSGTYPE_EGRESS_BATCH
+    std::vector<zmq::message_t> m_batchBundles; //only used by ReadZmqThreadFunc for HDTN_MSGTYPE_EGRESS_BATCH
+    //distributed mode with sharedMemoryBundleTransport only: resolves the bundles ingress and storage sent through shared memory (NULL otherwise)
+    std::unique_ptr<SharedMemoryBundleReader> m_sharedMemoryBundleReaderPtr;
     std::unique_ptr<zmq::socket_t> m_zmqSubSock_boundRouterToConnectingEgressPtr;
 
     std::unique_ptr<zmq::socket_t> m_zmqRepSock_connectingTelemToFromBoundEgressPtr;
@@ -81,7 +114,15 @@ private:
     std::unique_ptr<zmq::socket_t> m_zmqPairSock_LinkStatusWaitPtr;
     std::unique_ptr<zmq::socket_t> m_zmqPairSock_LinkStatusNotifyOnePtr;
 
+    //hdtn-one-process only: replaces m_zmqPullSock_boundIngressToConnectingEgressPtr (NULL otherwise)
+    ToEgressInprocChannel* m_toEgressInprocChannelPtr;
+    //hdtn-one-process with oneProcessDirectOutductForward only (NULL otherwise)
+    DirectOutductForwarder* m_directOutductForwarderPtr;
+    //one per outduct, only allocated with m_directOutductForwarderPtr (ingress threads then also call Forward)
+    std::unique_ptr<boost::mutex[]> m_outductForwardMutexes;
+
     HdtnConfig m_hdtnConfig;
+    std::set<uint64_t> m_availableDestOpportunisticNodeIdsSet; //only accessed by ReadZmqThreadFunc
 
     boost::mutex m_mutexPushBundleToIngress;
     boost::mutex m_mutexLinkStatusUpdate;
@@ -89,6 +130,56 @@ private:
     std::unique_ptr<boost::thread> m_threadZmqReaderPtr;
     std::atomic<bool> m_running;
 
+    //optional (egressWorkerThreadPerOutduct) threads, one per outduct, that call Forward on that outduct only,
+    //so that an outduct whose Forward blocks does not delay the bundles of the other outducts.
+    //An outduct with a (non-fifo) egressScheduler always gets a worker, which holds the bundles in its scheduler
+    //and only gives the outduct egressSchedulerMaxBundlesInOutduct unacked bundles at a time.
+    struct EgressWorkerQueueEntry {
+        hdtn::ToEgressHdr toEgressHeader;
+        zmq::message_t bundle;
+        boost::posix_time::ptime enqueueTime;
+        bool isCutThroughFromIngress;
+    };
+    struct EgressWorker : private boost::noncopyable {
+        EgressWorker(const uint32_t queueCapacity) :
+            m_bundleQueue(queueCapacity),
+            m_totalBundlesEnqueued(0),
+            m_totalBundlesDequeued(0),
+            m_totalQueueTimeMicroseconds(0),
+            m_maxQueueTimeMicroseconds(0),
+            m_totalBundlesGivenToOutduct(0),
+            m_totalBundleBytesGivenToOutduct(0),
+            m_totalBundleBytesEnqueued(0),
+            m_totalBundleBytesDequeued(0),
+            m_maxBundlesInOutduct(0),
+            m_waitingForOutductAck(false),
+            m_numFlowsInScheduler(0) {}
+        InprocMessageChannel<EgressWorkerQueueEntry> m_bundleQueue; //ReadZmqThreadFunc (only producer) to this worker
+        std::unique_ptr<boost::thread> m_threadPtr;
+        std::atomic<uint64_t> m_totalBundlesEnqueued; //written by ReadZmqThreadFunc
+        std::atomic<uint64_t> m_totalBundlesDequeued; //written by the worker (as are all below)
+        std::atomic<uint64_t> m_totalQueueTimeMicroseconds;
+        std::atomic<uint64_t> m_maxQueueTimeMicroseconds;
+        std::atomic<uint64_t> m_totalBundlesGivenToOutduct;
+        std::atomic<uint64_t> m_totalBundleBytesGivenToOutduct;
+        std::atomic<uint64_t> m_totalBundleBytesEnqueued; //written by ReadZmqThreadFunc
+        std::atomic<uint64_t> m_totalBundleBytesDequeued;
+        std::unique_ptr<EgressBundleScheduler<EgressWorkerQueueEntry> > m_schedulerPtr; //NULL => fifo (bundles given to the outduct as they are popped)
+        uint64_t m_maxBundlesInOutduct; //only used with a scheduler
+        InprocWakeupEvent m_outductAckEvent; //notified by the outduct's callbacks while the scheduler waits for room in the outduct
+        std::atomic<bool> m_waitingForOutductAck; //set by the worker, cleared by the worker or by the callback that notifies
+        std::atomic<uint64_t> m_numFlowsInScheduler; //written by the worker
+    };
+    typedef std::unique_ptr<EgressWorker> EgressWorkerPtr;
+    std::vector<EgressWorkerPtr> m_egressWorkers; //indexed by outduct uuid, empty or NULL element => bundles are forwarded by ReadZmqThreadFunc
+
+    //bundle bytes given to each outduct (indexed by uuid) by any thread, reported with the egress queue backlog to the router,
+    //which books them on the outduct's contacts (only sent by ReadZmqThreadFunc when they changed, at most every OUTDUCT_VOLUME_REPORT_INTERVAL)
+    std::unique_ptr<std::atomic<uint64_t>[]> m_totalBundleBytesGivenToOutductByUuid;
+    std::size_t m_numOutducts;
+    std::vector<uint64_t> m_lastReportedOutductVolumes; //only accessed by ReadZmqThreadFunc
+    boost::posix_time::ptime m_lastOutductVolumeReportTime;
+
     //for blocking until worker-thread startup
     std::atomic<bool> m_workerThreadStartupInProgress;
     boost::mutex m_workerThreadStartupMutex;
@@ -110,7 +201,14 @@ Egress::Impl::Impl() :
     m_totalCustodyTransfersSentToIngress(0),
     m_totalTcpclBundlesReceivedMutexProtected(0),
     m_totalTcpclBundleBytesReceivedMutexProtected(0),
+    m_totalBundlesGivenToOutductsByReaderThread(0),
+    m_totalBundleBytesGivenToOutductsByReaderThread(0),
+    m_totalBundlesGivenToOutductsDirectlyByIngress(0),
+    m_totalBundleBytesGivenToOutductsDirectlyByIngress(0),
+    m_toEgressInprocChannelPtr(NULL),
+    m_directOutductForwarderPtr(NULL),
     m_running(false),
+    m_numOutducts(0),
     m_workerThreadStartupInProgress(false) {}
 
 Egress::Egress() :
@@ -142,12 +240,37 @@ void Egress::Impl::Stop() {
             LOG_ERROR(subprocess) << "error stopping Egress thread: " << e.what();
         }
     }
+    for (std::size_t i = 0; i < m_egressWorkers.size(); ++i) {
+        if (!m_egressWorkers[i]) {
+            continue;
+        }
+        EgressWorker& worker = *m_egressWorkers[i];
+        if (worker.m_threadPtr) {
+            try {
+                worker.m_threadPtr->join();
+                worker.m_threadPtr.reset(); //delete it
+            }
+            catch (boost::thread_resource_error& e) {
+                LOG_ERROR(subprocess) << "unable to stop egress worker thread for outduct " << i << ": " << e.what();
+            }
+            const uint64_t numBundlesNotForwarded = worker.m_totalBundlesEnqueued - worker.m_totalBundlesDequeued;
+            if (numBundlesNotForwarded) {
+                LOG_INFO(subprocess) << "egress worker thread for outduct " << i << " stopped with " << numBundlesNotForwarded << " bundles not given to the outduct";
+            }
+        }
+    }
+    PopulateBundlesGivenToOutductsTelemetry(); //final totals for m_allOutductTelemRef
 }
 
-bool Egress::Init(const HdtnConfig& hdtnConfig, const HdtnDistributedConfig& hdtnDistributedConfig, zmq::context_t* hdtnOneProcessZmqInprocContextPtr) {
-    return m_pimpl->Init(hdtnConfig, hdtnDistributedConfig, hdtnOneProcessZmqInprocContextPtr);
+bool Egress::Init(const HdtnConfig& hdtnConfig, const HdtnDistributedConfig& hdtnDistributedConfig, zmq::context_t* hdtnOneProcessZmqInprocContextPtr,
+    ToEgressInprocChannel* hdtnOneProcessToEgressInprocChannelPtr, DirectOutductForwarder* hdtnOneProcessDirectOutductForwarderPtr)
+{
+    return m_pimpl->Init(hdtnConfig, hdtnDistributedConfig, hdtnOneProcessZmqInprocContextPtr, hdtnOneProcessToEgressInprocChannelPtr,
+        hdtnOneProcessDirectOutductForwarderPtr);
 }
-bool Egress::Impl::Init(const HdtnConfig & hdtnConfig, const HdtnDistributedConfig& hdtnDistributedConfig, zmq::context_t * hdtnOneProcessZmqInprocContextPtr) {
+bool Egress::Impl::Init(const HdtnConfig & hdtnConfig, const HdtnDistributedConfig& hdtnDistributedConfig, zmq::context_t * hdtnOneProcessZmqInprocContextPtr,
+    ToEgressInprocChannel* hdtnOneProcessToEgressInprocChannelPtr, DirectOutductForwarder* hdtnOneProcessDirectOutductForwarderPtr)
+{
     
     if (m_running.load(std::memory_order_acquire)) {
         LOG_ERROR(subprocess) << "Egress::Init called while Egress is already running";
@@ -155,6 +278,9 @@ bool Egress::Impl::Init(const HdtnConfig & hdtnConfig, const HdtnDistributedConf
     }
 
     m_hdtnConfig = hdtnConfig;
+    m_toEgressInprocChannelPtr = (hdtnOneProcessZmqInprocContextPtr) ? hdtnOneProcessToEgressInprocChannelPtr : NULL;
+    m_directOutductForwarderPtr = (hdtnOneProcessZmqInprocContextPtr) ? hdtnOneProcessDirectOutductForwarderPtr : NULL;
+    m_availableDestOpportunisticNodeIdsSet.clear();
 
 
     m_zmqCtxPtr = boost::make_unique<zmq::context_t>(); //needed at least by router pubsub (and if one-process is not used)
@@ -228,6 +354,9 @@ bool Egress::Impl::Init(const HdtnConfig & hdtnConfig, const HdtnDistributedConf
             const std::string bind_connectingTelemToFromBoundEgressPath(
                 std::string("tcp://*:") + boost::lexical_cast<std::string>(hdtnDistributedConfig.m_zmqConnectingTelemToFromBoundEgressPortPath));
             m_zmqRepSock_connectingTelemToFromBoundEgressPtr->bind(bind_connectingTelemToFromBoundEgressPath);
+            if (hdtnDistributedConfig.m_sharedMemoryBundleTransport) {
+                m_sharedMemoryBundleReaderPtr = boost::make_unique<SharedMemoryBundleReader>();
+            }
 
             //socket for sending LinkStatus events from Egress to Router
             m_zmqPushSock_boundEgressToConnectingRouterPtr = boost::make_unique<zmq::socket_t>(*m_zmqCtxPtr, zmq::socket_type::push);
@@ -312,9 +441,70 @@ bool Egress::Impl::Init(const HdtnConfig & hdtnConfig, const HdtnDistributedConf
         return false;
     }
 
+    m_running = true;
+
+    m_numOutducts = m_hdtnConfig.m_outductsConfig.m_outductElementConfigVector.size();
+    m_totalBundleBytesGivenToOutductByUuid.reset(new std::atomic<uint64_t>[m_numOutducts]());
+    m_lastReportedOutductVolumes.assign(2 * m_numOutducts, 0);
+    m_lastOutductVolumeReportTime = boost::posix_time::microsec_clock::universal_time();
+
+    m_egressWorkers.clear();
+    { //start before the reader thread, which is the only producer
+        const outduct_element_config_vector_t& outductConfigs = m_hdtnConfig.m_outductsConfig.m_outductElementConfigVector;
+        std::size_t numWorkers = 0;
+        for (uint64_t outductUuid = 0; outductUuid < outductConfigs.size(); ++outductUuid) {
+            const outduct_element_config_t& outductConfig = outductConfigs[outductUuid];
+            EgressBundleScheduler<EgressWorkerQueueEntry>::SchedulerType schedulerType = EgressBundleScheduler<EgressWorkerQueueEntry>::SchedulerType::FIFO;
+            EgressBundleScheduler<EgressWorkerQueueEntry>::SchedulerTypeFromString(outductConfig.egressScheduler, schedulerType); //validated by OutductsConfig
+            const bool hasScheduler = (schedulerType != EgressBundleScheduler<EgressWorkerQueueEntry>::SchedulerType::FIFO);
+            if ((!m_hdtnConfig.m_egressWorkerThreadPerOutduct) && (!hasScheduler)) {
+                m_egressWorkers.emplace_back(); //NULL
+                continue;
+            }
+            Outduct* outduct = m_outductManager.GetOutductByOutductUuid(outductUuid);
+            const uint64_t maxBundlesInPipeline = (outduct) ? outduct->GetOutductMaxNumberOfBundlesInPipeline() : 0;
+            //ingress and storage never exceed maxBundlesInPipeline (each) for an outduct, so a full queue is the exception
+            const uint64_t queueCapacity = std::max(EGRESS_WORKER_QUEUE_MIN_CAPACITY, 2 * maxBundlesInPipeline);
+            EgressWorkerPtr workerPtr = boost::make_unique<EgressWorker>(static_cast<uint32_t>(std::min<uint64_t>(queueCapacity, UINT32_MAX)));
+            if ((!workerPtr->m_bundleQueue.IsValid()) || (!workerPtr->m_outductAckEvent.IsValid())) {
+                LOG_WARNING(subprocess) << "egress worker threads (and egress schedulers) not supported on this platform, forwarding bundles on the egress reader thread";
+                m_egressWorkers.clear();
+                numWorkers = 0;
+                break;
+            }
+            if (hasScheduler) {
+                workerPtr->m_schedulerPtr = boost::make_unique<EgressBundleScheduler<EgressWorkerQueueEntry> >(schedulerType, outductConfig.egressSchedulerQuantumBytes);
+                workerPtr->m_maxBundlesInOutduct = (outductConfig.egressSchedulerMaxBundlesInOutduct) ?
+                    outductConfig.egressSchedulerMaxBundlesInOutduct : std::max<uint64_t>(1, maxBundlesInPipeline / 2);
+                LOG_INFO(subprocess) << "outduct " << outductUuid << " uses the " << outductConfig.egressScheduler
+                    << " egress scheduler with at most " << workerPtr->m_maxBundlesInOutduct << " unacked bundles in the outduct";
+            }
+            m_egressWorkers.emplace_back(std::move(workerPtr));
+            ++numWorkers;
+        }
+        if (numWorkers == 0) {
+            m_egressWorkers.clear();
+        }
+        for (std::size_t i = 0; i < m_egressWorkers.size(); ++i) {
+            if (m_egressWorkers[i]) {
+                m_egressWorkers[i]->m_threadPtr = boost::make_unique<boost::thread>(
+                    boost::bind(&Egress::Impl::EgressWorkerThreadFunc, this, static_cast<uint64_t>(i)));
+            }
+        }
+        if (numWorkers) {
+            LOG_INFO(subprocess) << numWorkers << " egress worker threads started";
+        }
+    }
+
+    if (m_directOutductForwarderPtr) { //after the outducts and egress workers are loaded, before ingress can get the outduct capabilities
+        m_outductForwardMutexes.reset(new boost::mutex[m_hdtnConfig.m_outductsConfig.m_outductElementConfigVector.size()]);
+        m_directOutductForwarderPtr->SetForwardFunction(boost::bind(&Egress::Impl::DirectForwardFromIngress, this,
+            boost::placeholders::_1, boost::placeholders::_2));
+        LOG_INFO(subprocess) << "ingress may give non-custody cut-through bundles directly to the outducts";
+    }
 
     { //start worker thread
-        m_running = true;
+        //m_running = true; //already true
 
         boost::mutex::scoped_lock workerThreadStartupLock(m_workerThreadStartupMutex);
         m_workerThreadStartupInProgress = true;
@@ -372,6 +562,18 @@ void Egress::Impl::RouterEventHandler() {
     else if (routeUpdateHdr.base.type == HDTN_MSGTYPE_ROUTEUPDATE) {
         std::string nextHop = routeUpdateHdr.nextHopNodeId == HDTN_NOROUTE ? std::string("NOROUTE") : std::to_string(routeUpdateHdr.nextHopNodeId);
         if (m_outductManager.Reroute_ThreadSafe(routeUpdateHdr.finalDestNodeId, routeUpdateHdr.nextHopNodeId)) {
+            const std::size_t numMultipathNextHops = static_cast<std::size_t>(
+                std::min<uint64_t>(routeUpdateHdr.numMultipathNextHops, HDTN_MAX_MULTIPATH_NEXT_HOPS));
+            if (!m_outductManager.SetMultipathNextHops_ThreadSafe(routeUpdateHdr.finalDestNodeId,
+                routeUpdateHdr.multipathNextHopNodeIds, routeUpdateHdr.multipathWeights, numMultipathNextHops))
+            {
+                LOG_ERROR(subprocess) << "Failed to split the bulk flows for finalDestNodeId " << routeUpdateHdr.finalDestNodeId
+                    << " across " << numMultipathNextHops << " next hops";
+            }
+            else if (numMultipathNextHops >= 2) {
+                LOG_INFO(subprocess) << "Splitting the bulk flows for finalDestNodeId " << routeUpdateHdr.finalDestNodeId
+                    << " across " << numMultipathNextHops << " next hops";
+            }
             ResendOutductCapabilities();
             LOG_INFO(subprocess) << "Updated the outduct based on the optimal Route for finalDestNodeId " << routeUpdateHdr.finalDestNodeId
                 << ": New Outduct Next Hop is " << nextHop;
@@ -406,23 +608,28 @@ void Egress::Impl::ReadZmqThreadFunc() {
     }
 #endif
 
-    std::set<uint64_t> availableDestOpportunisticNodeIdsSet;
-
-
     static constexpr unsigned int NUM_SOCKETS = 6;
 
     //THIS PROBABLY DOESNT WORK SINCE IT HAPPENED AFTER BIND/CONNECT BUT NOT USED ANYWAY BECAUSE OF POLLITEMS
     //m_zmqPullSock_boundIngressToConnectingEgressPtr->set(zmq::sockopt::rcvtimeo, timeout);
     //m_zmqPullSock_connectingStorageToBoundEgressPtr->set(zmq::sockopt::rcvtimeo, timeout);
 
-    zmq::pollitem_t items[NUM_SOCKETS] = {
+    zmq::pollitem_t items[NUM_SOCKETS + 1] = {
         {m_zmqPullSock_boundIngressToConnectingEgressPtr->handle(), 0, ZMQ_POLLIN, 0},
         {m_zmqPullSock_connectingStorageToBoundEgressPtr->handle(), 0, ZMQ_POLLIN, 0},
         {m_zmqPullSock_connectingRouterToBoundEgressPtr->handle(), 0, ZMQ_POLLIN, 0},
         {m_zmqRepSock_connectingTelemToFromBoundEgressPtr->handle(), 0, ZMQ_POLLIN, 0},
         {m_zmqPairSock_LinkStatusWaitPtr->handle(), 0, ZMQ_POLLIN, 0},
-        {m_zmqSubSock_boundRouterToConnectingEgressPtr->handle(), 0, ZMQ_POLLIN, 0}
+        {m_zmqSubSock_boundRouterToConnectingEgressPtr->handle(), 0, ZMQ_POLLIN, 0},
+        {NULL, 0, ZMQ_POLLIN, 0} //m_toEgressInprocChannelPtr wakeup event (only polled in hdtn-one-process)
     };
+    const unsigned int numPollItems = (m_toEgressInprocChannelPtr) ? (NUM_SOCKETS + 1) : NUM_SOCKETS;
+    if (m_toEgressInprocChannelPtr) {
+        items[NUM_SOCKETS].fd = m_toEgressInprocChannelPtr->GetPollFd();
+    }
+    //bundles popped per loop iteration so that bundles from storage are not starved by a busy ingress
+    static constexpr unsigned int MAX_INPROC_MESSAGES_PER_POLL = 64;
+    hdtn::ToEgressInprocMessage inprocMessage;
     zmq::socket_t * const firstTwoSockets[2] = {
         m_zmqPullSock_boundIngressToConnectingEgressPtr.get(),
         m_zmqPullSock_connectingStorageToBoundEgressPtr.get()
@@ -441,13 +648,21 @@ void Egress::Impl::ReadZmqThreadFunc() {
     static const long DEFAULT_BIG_TIMEOUT_POLL = 250; // milliseconds
     while (m_running.load(std::memory_order_acquire)) { //keep thread alive if running
         int rc = 0;
+        const bool inprocChannelHasMessages = (m_toEgressInprocChannelPtr) && m_toEgressInprocChannelPtr->PrepareToWait();
         try {
-            rc = zmq::poll(&items[0], NUM_SOCKETS, DEFAULT_BIG_TIMEOUT_POLL);
+            rc = zmq::poll(&items[0], numPollItems, (inprocChannelHasMessages) ? 0 : DEFAULT_BIG_TIMEOUT_POLL);
         }
         catch (zmq::error_t & e) {
             LOG_ERROR(subprocess) << "caught zmq::error_t in hdtn::HegrManagerAsync::ReadZmqThreadFunc: " << e.what();
             continue;
         }
+        if (m_toEgressInprocChannelPtr) { //cut-through from ingress within hdtn-one-process
+            m_toEgressInprocChannelPtr->FinishWait((rc > 0) && (items[NUM_SOCKETS].revents & ZMQ_POLLIN));
+            for (unsigned int i = 0; (i < MAX_INPROC_MESSAGES_PER_POLL) && m_toEgressInprocChannelPtr->TryPop(inprocMessage); ++i) {
+                ProcessToEgressMessage(inprocMessage.toEgressHdr, inprocMessage.bundle, true);
+                inprocMessage.bundle.rebuild(); //release the bundle now if the outduct did not take it
+            }
+        }
         if (rc > 0) {
             for (unsigned int itemIndex = 0; itemIndex < 2; ++itemIndex) { //skip m_zmqPullSignalInprocSockPtr in this loop
                 
@@ -468,137 +683,33 @@ void Egress::Impl::ReadZmqThreadFunc() {
                         << " truncated = " << res->size << " expected = " << sizeof(hdtn::ToEgressHdr);
                     continue;
                 }
-                else if ((itemIndex == 0) && (toEgressHeader.base.type == HDTN_MSGTYPE_EGRESS_ADD_OPPORTUNISTIC_LINK)) {
-                    LOG_INFO(subprocess) << "adding opportunistic link " << toEgressHeader.finalDestEid.nodeId;
-                    availableDestOpportunisticNodeIdsSet.insert(toEgressHeader.finalDestEid.nodeId);
-                    continue;
-                }
-                else if ((itemIndex == 0) && (toEgressHeader.base.type == HDTN_MSGTYPE_EGRESS_REMOVE_OPPORTUNISTIC_LINK)) {
-                    LOG_INFO(subprocess) << "removing opportunistic link " << toEgressHeader.finalDestEid.nodeId;
-                    availableDestOpportunisticNodeIdsSet.erase(toEgressHeader.finalDestEid.nodeId);
-                    continue;
-                }
-                else if ((itemIndex == 0) && (toEgressHeader.base.type == HDTN_MSGTYPE_BUNDLES_TO_ROUTER)) {
-                    LOG_INFO(subprocess) << "forwarding bundle to router";
-                    zmq::message_t zmqMessageBundleToRouter;
-                    //message guaranteed to be there due to the zmq::send_flags::sndmore
-                    if (!firstTwoSockets[itemIndex]->recv(zmqMessageBundleToRouter, zmq::recv_flags::none)) {
-                        LOG_ERROR(subprocess) << "error receiving zmqMessageBundleToRouter";
+
+                if (isCutThroughFromIngress && (toEgressHeader.base.type == HDTN_MSGTYPE_EGRESS_BATCH)) {
+                    //process the whole batch in one pass
+                    if (!hdtn::ReceiveBatchMessage(*firstTwoSockets[itemIndex], m_batchToEgressHeaders, m_batchBundles)) {
+                        LOG_ERROR(subprocess) << "malformed batch from ingress, processing only the " << m_batchBundles.size() << " bundles received";
                     }
-                    else {
-                        hdtn::LinkStatusHdr linkStatusMsg;
-                        linkStatusMsg.base.type = HDTN_MSGTYPE_BUNDLES_TO_ROUTER;
-                        while (m_running.load(std::memory_order_acquire) && !m_zmqPushSock_boundEgressToConnectingRouterPtr->send(
-                            zmq::const_buffer(&linkStatusMsg, sizeof(linkStatusMsg)), zmq::send_flags::sndmore | zmq::send_flags::dontwait))
-                        {
-                            LOG_INFO(subprocess) << "waiting for router to become available to send HDTN_MSGTYPE_BUNDLES_TO_ROUTER header";
-                            boost::this_thread::sleep(boost::posix_time::seconds(1));
-                        }
-                        while (m_running.load(std::memory_order_acquire) && !m_zmqPushSock_boundEgressToConnectingRouterPtr->send(zmqMessageBundleToRouter, zmq::send_flags::dontwait)) {
-                            LOG_INFO(subprocess) << "waiting for router to become available to send it a router-only bundle received by ingress";
-                            boost::this_thread::sleep(boost::posix_time::seconds(1));
+                    for (std::size_t i = 0; i < m_batchBundles.size(); ++i) {
+                        if (ResolveBundle(m_batchBundles[i], true)) {
+                            ProcessToEgressMessage(m_batchToEgressHeaders[i], m_batchBundles[i], true);
                         }
                     }
+                    m_batchBundles.resize(0);
                     continue;
                 }
-                else if (toEgressHeader.base.type != HDTN_MSGTYPE_EGRESS) {
-                    LOG_ERROR(subprocess) << "toEgressHeader.base.type != HDTN_MSGTYPE_EGRESS";
-                    continue;
-                }
-                
-                zmq::message_t zmqMessageBundle;
-                //message guaranteed to be there due to the zmq::send_flags::sndmore
-                if (!firstTwoSockets[itemIndex]->recv(zmqMessageBundle, zmq::recv_flags::none)) {
-                    LOG_ERROR(subprocess) << "error on sockets[itemIndex]->recv";
-                    continue;
-                }
-                const uint64_t zmqMessageBundleSize = zmqMessageBundle.size();
-                
-
-                const cbhe_eid_t & finalDestEid = toEgressHeader.finalDestEid;
-                //TODO DERMINE IF availableDestOpportunisticNodeIdsSet IS NEEDED
-                if ((itemIndex == 1) && (availableDestOpportunisticNodeIdsSet.count(finalDestEid.nodeId) || toEgressHeader.IsOpportunisticLink())) { //from storage and opportunistic link available in ingress
-                    hdtn::EgressAckHdr * egressAckPtr = new hdtn::EgressAckHdr();
-                    //memset 0 not needed because all values set below
-                    egressAckPtr->base.type = HDTN_MSGTYPE_EGRESS_ACK_TO_STORAGE;
-                    egressAckPtr->base.flags = 0;
-                    egressAckPtr->nextHopNodeId = toEgressHeader.nextHopNodeId;
-                    egressAckPtr->finalDestEid = finalDestEid;
-                    egressAckPtr->error = EGRESS_ACK_ERROR_TYPE::NO_ERRORS; //can set later before sending this ack if error
-                    egressAckPtr->deleteNow = (toEgressHeader.hasCustody == 0);
-                    egressAckPtr->isResponseToStorageCutThrough = toEgressHeader.isCutThroughFromStorage;
-                    egressAckPtr->custodyId = toEgressHeader.custodyId;
-                    egressAckPtr->outductIndex = toEgressHeader.outductIndex;
-
-                    zmq::message_t messageWithDataStolen(egressAckPtr, sizeof(hdtn::EgressAckHdr), CustomCleanupEgressAckHdrNoHint); //storage can be acked right away since bundle transferred
-                    {
-                        boost::mutex::scoped_lock lock(m_mutex_zmqPushSock_boundEgressToConnectingStorage);
-                        if (!m_zmqPushSock_boundEgressToConnectingStoragePtr->send(std::move(messageWithDataStolen), zmq::send_flags::dontwait)) {
-                            LOG_ERROR(subprocess) << "m_zmqPushSock_boundEgressToConnectingStoragePtr could not send";
-                            break;
-                        }
-                        ++m_totalCustodyTransfersSentToStorage;
-                    }
 
-                    boost::mutex::scoped_lock lock(m_mutexPushBundleToIngress);
-                    static const char messageFlags = 0; //0 => from storage and needs no processing
-                    static const zmq::const_buffer messageFlagsConstBuf(&messageFlags, sizeof(messageFlags));
-                    if (!m_zmqPushSock_connectingEgressBundlesOnlyToBoundIngressPtr->send(messageFlagsConstBuf, zmq::send_flags::sndmore)) { //blocks if above 5 high water mark
-                        LOG_ERROR(subprocess) << "WholeBundleReadyCallback: zmq could not send messageFlagsConstBuf to ingress";
-                    }
-                    else if (!m_zmqPushSock_connectingEgressBundlesOnlyToBoundIngressPtr->send(std::move(zmqMessageBundle), zmq::send_flags::none)) { //blocks if above 5 high water mark
-                        LOG_ERROR(subprocess) << "WholeBundleReadyCallback: zmq could not forward bundle to ingress";
-                    }
-                    else {
-                        ++m_allOutductTelem.m_totalStorageToIngressOpportunisticBundles;
-                        m_allOutductTelem.m_totalStorageToIngressOpportunisticBundleBytes += zmqMessageBundleSize;
-                    }
-                }
-                else if (Outduct * outduct = m_outductManager.GetOutductByFinalDestinationEid_ThreadSafe(finalDestEid)) {
-                    std::vector<uint8_t> userData(sizeof(hdtn::EgressAckHdr));
-                    hdtn::EgressAckHdr* egressAckPtr = (hdtn::EgressAckHdr*)userData.data();
-                    //memset 0 not needed because all values set below
-                    egressAckPtr->base.type = (isCutThroughFromIngress) ? HDTN_MSGTYPE_EGRESS_ACK_TO_INGRESS : HDTN_MSGTYPE_EGRESS_ACK_TO_STORAGE;
-                    egressAckPtr->base.flags = 0;
-                    egressAckPtr->nextHopNodeId = toEgressHeader.nextHopNodeId;
-                    egressAckPtr->finalDestEid = finalDestEid;
-                    egressAckPtr->error = EGRESS_ACK_ERROR_TYPE::NO_ERRORS; //can set later before sending this ack if error
-                    egressAckPtr->deleteNow = (toEgressHeader.hasCustody == 0);
-                    egressAckPtr->isResponseToStorageCutThrough = toEgressHeader.isCutThroughFromStorage;
-                    egressAckPtr->custodyId = toEgressHeader.custodyId;
-                    egressAckPtr->outductIndex = toEgressHeader.outductIndex;
-                    outduct->Forward(zmqMessageBundle, std::move(userData));
-                    if (zmqMessageBundle.size() != 0) {
-                        LOG_ERROR(subprocess) << "hdtn::HegrManagerAsync::ProcessZmqMessagesThreadFunc, zmqMessage was not moved.. bundle shall remain in storage";
-
-                        OnFailedBundleZmqSendCallback(zmqMessageBundle, userData, outduct->GetOutductUuid(), false); //todo is this correct?.. verify userdata not moved
+                zmq::message_t zmqMessageBundle;
+                if ((toEgressHeader.base.type == HDTN_MSGTYPE_EGRESS) || (isCutThroughFromIngress && (toEgressHeader.base.type == HDTN_MSGTYPE_BUNDLES_TO_ROUTER))) {
+                    //message guaranteed to be there due to the zmq::send_flags::sndmore
+                    if (!firstTwoSockets[itemIndex]->recv(zmqMessageBundle, zmq::recv_flags::none)) {
+                        LOG_ERROR(subprocess) << "error on sockets[itemIndex]->recv";
+                        continue;
                     }
-                    else {
-                        m_allOutductTelem.m_totalBundleBytesGivenToOutducts += zmqMessageBundleSize;
-                        ++m_allOutductTelem.m_totalBundlesGivenToOutducts;
+                    if (!ResolveBundle(zmqMessageBundle, isCutThroughFromIngress)) {
+                        continue;
                     }
                 }
-                else {
-                    LOG_INFO(subprocess) << "While processing bundle: no outduct for "
-                        << Uri::GetIpnUriString(finalDestEid.nodeId, finalDestEid.serviceId)
-                        << " returning to storage";
-
-                    std::vector<uint8_t> userData(sizeof(hdtn::EgressAckHdr));
-                    hdtn::EgressAckHdr* egressAckPtr = (hdtn::EgressAckHdr*)userData.data();
-                    //memset 0 not needed because all values set below
-                    egressAckPtr->base.type = (isCutThroughFromIngress) ? HDTN_MSGTYPE_EGRESS_ACK_TO_INGRESS : HDTN_MSGTYPE_EGRESS_ACK_TO_STORAGE;
-                    egressAckPtr->base.flags = 0;
-                    egressAckPtr->nextHopNodeId = toEgressHeader.nextHopNodeId;
-                    egressAckPtr->finalDestEid = finalDestEid;
-                    egressAckPtr->error = EGRESS_ACK_ERROR_TYPE::NO_ERRORS; // this is updated in OnFailed... below
-                    egressAckPtr->deleteNow = (toEgressHeader.hasCustody == 0); // Doesn't matter, the error flag set in OnFailed will prevent deletion
-                    egressAckPtr->isResponseToStorageCutThrough = toEgressHeader.isCutThroughFromStorage;
-                    egressAckPtr->custodyId = toEgressHeader.custodyId;
-                    egressAckPtr->outductIndex = toEgressHeader.outductIndex;
-
-                    OnFailedBundleZmqSendCallback(zmqMessageBundle, userData, NO_OUTDUCT, false);
-                }
-
+                ProcessToEgressMessage(toEgressHeader, zmqMessageBundle, isCutThroughFromIngress);
             }
 
             if (items[2].revents & ZMQ_POLLIN) { //events from Router
@@ -609,6 +720,7 @@ void Egress::Impl::ReadZmqThreadFunc() {
             if (items[3].revents & ZMQ_POLLIN) { //telemetry requests data
                 // Prepare telemetry
                 m_outductManager.PopulateAllOutductTelemetry(m_allOutductTelem); //also sets m_totalBundlesSuccessfullySent, m_totalBundleBytesSuccessfullySent
+                PopulateBundlesGivenToOutductsTelemetry();
                 m_mutexPushBundleToIngress.lock();
                 m_allOutductTelem.m_totalTcpclBundlesReceived = m_totalTcpclBundlesReceivedMutexProtected;
                 m_allOutductTelem.m_totalTcpclBundleBytesReceived = m_totalTcpclBundleBytesReceivedMutexProtected;
@@ -673,6 +785,7 @@ void Egress::Impl::ReadZmqThreadFunc() {
                 }
             }
         }
+        TrySendOutductVolumesToRouter();
     }
 
     LOG_INFO(subprocess) << "HegrManagerAsync::ReadZmqThreadFunc thread exiting";
@@ -680,10 +793,392 @@ void Egress::Impl::ReadZmqThreadFunc() {
     LOG_DEBUG(subprocess) << "m_totalCustodyTransfersSentToIngress: " << m_totalCustodyTransfersSentToIngress;
 }
 
+//must be called from within ReadZmqThreadFunc (zmqMessageBundle is empty unless the type is HDTN_MSGTYPE_EGRESS or HDTN_MSGTYPE_BUNDLES_TO_ROUTER)
+//replaces a bundle that ingress or storage sent through shared memory with the bundle itself
+bool Egress::Impl::ResolveBundle(zmq::message_t& zmqMessageBundle, const bool isCutThroughFromIngress) {
+    if (m_sharedMemoryBundleReaderPtr && (!m_sharedMemoryBundleReaderPtr->Resolve(zmqMessageBundle))) {
+        LOG_ERROR(subprocess) << "cannot open the shared memory of a bundle from " << ((isCutThroughFromIngress) ? "ingress" : "storage")
+            << " (egress must run on the same host), this bundle will be lost";
+        return false;
+    }
+    return true;
+}
+
+void Egress::Impl::ProcessToEgressMessage(const hdtn::ToEgressHdr& toEgressHeader, zmq::message_t& zmqMessageBundle, const bool isCutThroughFromIngress) {
+    if (isCutThroughFromIngress && (toEgressHeader.base.type == HDTN_MSGTYPE_EGRESS_ADD_OPPORTUNISTIC_LINK)) {
+        LOG_INFO(subprocess) << "adding opportunistic link " << toEgressHeader.finalDestEid.nodeId;
+        m_availableDestOpportunisticNodeIdsSet.insert(toEgressHeader.finalDestEid.nodeId);
+        return;
+    }
+    else if (isCutThroughFromIngress && (toEgressHeader.base.type == HDTN_MSGTYPE_EGRESS_REMOVE_OPPORTUNISTIC_LINK)) {
+        LOG_INFO(subprocess) << "removing opportunistic link " << toEgressHeader.finalDestEid.nodeId;
+        m_availableDestOpportunisticNodeIdsSet.erase(toEgressHeader.finalDestEid.nodeId);
+        return;
+    }
+    else if (isCutThroughFromIngress && (toEgressHeader.base.type == HDTN_MSGTYPE_BUNDLES_TO_ROUTER)) {
+        ForwardBundleToRouter(zmqMessageBundle);
+        return;
+    }
+    else if (toEgressHeader.base.type != HDTN_MSGTYPE_EGRESS) {
+        LOG_ERROR(subprocess) << "toEgressHeader.base.type != HDTN_MSGTYPE_EGRESS";
+        return;
+    }
+
+    const uint64_t zmqMessageBundleSize = zmqMessageBundle.size();
+
+    const cbhe_eid_t & finalDestEid = toEgressHeader.finalDestEid;
+    //TODO DERMINE IF m_availableDestOpportunisticNodeIdsSet IS NEEDED
+    if ((!isCutThroughFromIngress) && (m_availableDestOpportunisticNodeIdsSet.count(finalDestEid.nodeId) || toEgressHeader.IsOpportunisticLink())) { //from storage and opportunistic link available in ingress
+        hdtn::EgressAckHdr * egressAckPtr = new hdtn::EgressAckHdr();
+        //memset 0 not needed because all values set below
+        egressAckPtr->base.type = HDTN_MSGTYPE_EGRESS_ACK_TO_STORAGE;
+        egressAckPtr->base.flags = 0;
+        egressAckPtr->nextHopNodeId = toEgressHeader.nextHopNodeId;
+        egressAckPtr->finalDestEid = finalDestEid;
+        egressAckPtr->error = EGRESS_ACK_ERROR_TYPE::NO_ERRORS; //can set later before sending this ack if error
+        egressAckPtr->deleteNow = (toEgressHeader.hasCustody == 0);
+        egressAckPtr->isResponseToStorageCutThrough = toEgressHeader.isCutThroughFromStorage;
+        egressAckPtr->custodyId = toEgressHeader.custodyId;
+        egressAckPtr->outductIndex = toEgressHeader.outductIndex;
+
+        zmq::message_t messageWithDataStolen(egressAckPtr, sizeof(hdtn::EgressAckHdr), CustomCleanupEgressAckHdrNoHint); //storage can be acked right away since bundle transferred
+        {
+            boost::mutex::scoped_lock lock(m_mutex_zmqPushSock_boundEgressToConnectingStorage);
+            if (!m_zmqPushSock_boundEgressToConnectingStoragePtr->send(std::move(messageWithDataStolen), zmq::send_flags::dontwait)) {
+                LOG_ERROR(subprocess) << "m_zmqPushSock_boundEgressToConnectingStoragePtr could not send";
+                return;
+            }
+            ++m_totalCustodyTransfersSentToStorage;
+        }
+
+        boost::mutex::scoped_lock lock(m_mutexPushBundleToIngress);
+        static const char messageFlags = 0; //0 => from storage and needs no processing
+        static const zmq::const_buffer messageFlagsConstBuf(&messageFlags, sizeof(messageFlags));
+        if (!m_zmqPushSock_connectingEgressBundlesOnlyToBoundIngressPtr->send(messageFlagsConstBuf, zmq::send_flags::sndmore)) { //blocks if above 5 high water mark
+            LOG_ERROR(subprocess) << "WholeBundleReadyCallback: zmq could not send messageFlagsConstBuf to ingress";
+        }
+        else if (!m_zmqPushSock_connectingEgressBundlesOnlyToBoundIngressPtr->send(std::move(zmqMessageBundle), zmq::send_flags::none)) { //blocks if above 5 high water mark
+            LOG_ERROR(subprocess) << "WholeBundleReadyCallback: zmq could not forward bundle to ingress";
+        }
+        else {
+            ++m_allOutductTelem.m_totalStorageToIngressOpportunisticBundles;
+            m_allOutductTelem.m_totalStorageToIngressOpportunisticBundleBytes += zmqMessageBundleSize;
+        }
+    }
+    else if (Outduct * outduct = GetOutductForBundle(finalDestEid, zmqMessageBundle)) {
+        const uint64_t outductUuid = outduct->GetOutductUuid();
+        if ((outductUuid < m_egressWorkers.size()) && m_egressWorkers[outductUuid]) {
+            EgressWorker& worker = *m_egressWorkers[outductUuid];
+            const uint64_t zmqMessageBundleSize = zmqMessageBundle.size();
+            EgressWorkerQueueEntry entry;
+            entry.toEgressHeader = toEgressHeader;
+            entry.bundle = std::move(zmqMessageBundle);
+            entry.enqueueTime = boost::posix_time::microsec_clock::universal_time();
+            entry.isCutThroughFromIngress = isCutThroughFromIngress;
+            //the queue only fills if the pipeline limits were exceeded; wait rather than reorder this outduct's bundles
+            while (!worker.m_bundleQueue.TryPush(std::move(entry))) {
+                if (!m_running.load(std::memory_order_acquire)) {
+                    return;
+                }
+                boost::this_thread::sleep(boost::posix_time::microseconds(200));
+            }
+            worker.m_totalBundleBytesEnqueued.fetch_add(zmqMessageBundleSize, std::memory_order_relaxed);
+            worker.m_totalBundlesEnqueued.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (ForwardToOutduct(*outduct, toEgressHeader, zmqMessageBundle, isCutThroughFromIngress)) {
+            m_totalBundleBytesGivenToOutductsByReaderThread += zmqMessageBundleSize;
+            ++m_totalBundlesGivenToOutductsByReaderThread;
+        }
+    }
+    else {
+        LOG_INFO(subprocess) << "While processing bundle: no outduct for "
+            << Uri::GetIpnUriString(finalDestEid.nodeId, finalDestEid.serviceId)
+            << " returning to storage";
+
+        std::vector<uint8_t> userData(sizeof(hdtn::EgressAckHdr));
+        hdtn::EgressAckHdr* egressAckPtr = (hdtn::EgressAckHdr*)userData.data();
+        //memset 0 not needed because all values set below
+        egressAckPtr->base.type = (isCutThroughFromIngress) ? HDTN_MSGTYPE_EGRESS_ACK_TO_INGRESS : HDTN_MSGTYPE_EGRESS_ACK_TO_STORAGE;
+        egressAckPtr->base.flags = 0;
+        egressAckPtr->nextHopNodeId = toEgressHeader.nextHopNodeId;
+        egressAckPtr->finalDestEid = finalDestEid;
+        egressAckPtr->error = EGRESS_ACK_ERROR_TYPE::NO_ERRORS; // this is updated in OnFailed... below
+        egressAckPtr->deleteNow = (toEgressHeader.hasCustody == 0); // Doesn't matter, the error flag set in OnFailed will prevent deletion
+        egressAckPtr->isResponseToStorageCutThrough = toEgressHeader.isCutThroughFromStorage;
+        egressAckPtr->custodyId = toEgressHeader.custodyId;
+        egressAckPtr->outductIndex = toEgressHeader.outductIndex;
+
+        OnFailedBundleZmqSendCallback(zmqMessageBundle, userData, NO_OUTDUCT, false);
+    }
+}
+
+//Called by ReadZmqThreadFunc, or by the outduct's worker thread when egressWorkerThreadPerOutduct is enabled.
+//Returns true if the outduct took the bundle, otherwise the bundle is returned to ingress/storage with an error ack.
+bool Egress::Impl::ForwardToOutduct(Outduct& outduct, const hdtn::ToEgressHdr& toEgressHeader, zmq::message_t& zmqMessageBundle, const bool isCutThroughFromIngress) {
+    std::vector<uint8_t> userData(sizeof(hdtn::EgressAckHdr));
+    hdtn::EgressAckHdr* egressAckPtr = (hdtn::EgressAckHdr*)userData.data();
+    //memset 0 not needed because all values set below
+    egressAckPtr->base.type = (isCutThroughFromIngress) ? HDTN_MSGTYPE_EGRESS_ACK_TO_INGRESS : HDTN_MSGTYPE_EGRESS_ACK_TO_STORAGE;
+    egressAckPtr->base.flags = 0;
+    egressAckPtr->nextHopNodeId = toEgressHeader.nextHopNodeId;
+    egressAckPtr->finalDestEid = toEgressHeader.finalDestEid;
+    egressAckPtr->error = EGRESS_ACK_ERROR_TYPE::NO_ERRORS; //can set later before sending this ack if error
+    egressAckPtr->deleteNow = (toEgressHeader.hasCustody == 0);
+    egressAckPtr->isResponseToStorageCutThrough = toEgressHeader.isCutThroughFromStorage;
+    egressAckPtr->custodyId = toEgressHeader.custodyId;
+    egressAckPtr->outductIndex = toEgressHeader.outductIndex;
+    const uint64_t zmqMessageBundleSize = zmqMessageBundle.size();
+    boost::mutex* const forwardMutexPtr = (m_outductForwardMutexes) ? &m_outductForwardMutexes[outduct.GetOutductUuid()] : NULL;
+    if (forwardMutexPtr) {
+        forwardMutexPtr->lock();
+    }
+    outduct.Forward(zmqMessageBundle, std::move(userData));
+    if (forwardMutexPtr) {
+        forwardMutexPtr->unlock();
+    }
+    if (zmqMessageBundle.size() != 0) {
+        LOG_ERROR(subprocess) << "hdtn::HegrManagerAsync::ProcessZmqMessagesThreadFunc, zmqMessage was not moved.. bundle shall remain in storage";
+
+        OnFailedBundleZmqSendCallback(zmqMessageBundle, userData, outduct.GetOutductUuid(), false); //todo is this correct?.. verify userdata not moved
+        return false;
+    }
+    m_totalBundleBytesGivenToOutductByUuid[outduct.GetOutductUuid()].fetch_add(zmqMessageBundleSize, std::memory_order_relaxed);
+    return true;
+}
+
+//DirectOutductForwarder forward function, called by the ingress threads of hdtn-one-process for non-custody cut-through bundles
+//(ingress has already reserved the cut-through pipeline).  Returns false, without moving the bundle, if the outduct did not take it,
+//in which case ingress sends the bundle the normal way through ReadZmqThreadFunc (which handles the link down).
+bool Egress::Impl::DirectForwardFromIngress(const hdtn::ToEgressHdr& toEgressHeader, zmq::message_t& zmqMessageBundle) {
+    Outduct* outduct = m_outductManager.GetOutductByOutductUuid(toEgressHeader.outductIndex);
+    if ((outduct == NULL) || (!outduct->ReadyToForward())) {
+        return false;
+    }
+    if ((toEgressHeader.outductIndex < m_egressWorkers.size()) && m_egressWorkers[toEgressHeader.outductIndex]
+        && m_egressWorkers[toEgressHeader.outductIndex]->m_schedulerPtr)
+    {
+        return false; //the outduct's scheduler decides the order, so let ReadZmqThreadFunc queue it
+    }
+    if (m_outductManager.HasMultipathNextHops()) {
+        return false; //bulk flows may be split across outducts, so let ReadZmqThreadFunc pick the outduct
+    }
+    std::vector<uint8_t> userData(sizeof(hdtn::EgressAckHdr));
+    hdtn::EgressAckHdr* egressAckPtr = (hdtn::EgressAckHdr*)userData.data();
+    //memset 0 not needed because all values set below
+    egressAckPtr->base.type = HDTN_MSGTYPE_EGRESS_ACK_TO_INGRESS;
+    egressAckPtr->base.flags = HDTN_EGRESS_ACK_FLAG_DIRECT_FORWARD;
+    egressAckPtr->nextHopNodeId = toEgressHeader.nextHopNodeId;
+    egressAckPtr->finalDestEid = toEgressHeader.finalDestEid;
+    egressAckPtr->error = EGRESS_ACK_ERROR_TYPE::NO_ERRORS; //can set later before sending this ack if error
+    egressAckPtr->deleteNow = (toEgressHeader.hasCustody == 0);
+    egressAckPtr->isResponseToStorageCutThrough = toEgressHeader.isCutThroughFromStorage;
+    egressAckPtr->custodyId = toEgressHeader.custodyId;
+    egressAckPtr->outductIndex = toEgressHeader.outductIndex;
+    const uint64_t zmqMessageBundleSize = zmqMessageBundle.size();
+    {
+        boost::mutex::scoped_lock lock(m_outductForwardMutexes[toEgressHeader.outductIndex]);
+        outduct->Forward(zmqMessageBundle, std::move(userData));
+    }
+    if (zmqMessageBundle.size() != 0) { //not moved
+        return false;
+    }
+    m_totalBundleBytesGivenToOutductsDirectlyByIngress.fetch_add(zmqMessageBundleSize, std::memory_order_relaxed);
+    m_totalBundleBytesGivenToOutductByUuid[toEgressHeader.outductIndex].fetch_add(zmqMessageBundleSize, std::memory_order_relaxed);
+    m_totalBundlesGivenToOutductsDirectlyByIngress.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+//Reads the flow (source, final destination, priority class) of a bundle from its primary block.
+//Returns false if the bundle is not a well formed bpv6 or bpv7 bundle.
+static bool PeekBundleFlow(zmq::message_t& bundle, cbhe_eid_t& sourceEid, cbhe_eid_t& finalDestEid, unsigned int& priority) {
+    uint8_t* const bundleDataBegin = static_cast<uint8_t*>(bundle.data());
+    const std::size_t bundleSize = bundle.size();
+    if (bundleSize == 0) {
+        return false;
+    }
+    uint64_t decodedBlockSize;
+    const uint8_t firstByte = bundleDataBegin[0];
+    if (firstByte == 6) {
+        Bpv6CbhePrimaryBlock primary;
+        if (!primary.DeserializeBpv6(bundleDataBegin, decodedBlockSize, bundleSize)) {
+            return false;
+        }
+        sourceEid = primary.m_sourceNodeId;
+        finalDestEid = primary.m_destinationEid;
+        priority = primary.GetPriority();
+        return true;
+    }
+    else if (firstByte == ((4U << 5) | 31U)) { //CBOR major type 4, additional information 31 (Indefinite-Length Array)
+        Bpv7CbhePrimaryBlock primary;
+        if (!primary.DeserializeBpv7(bundleDataBegin + 1, decodedBlockSize, bundleSize - 1)) {
+            return false;
+        }
+        sourceEid = primary.m_sourceNodeId;
+        finalDestEid = primary.m_destinationEid;
+        priority = primary.GetPriority();
+        return true;
+    }
+    return false;
+}
+
+//Returns the outduct of a bundle to finalDestEid.  Bulk bundles to a final destination whose flows are split across
+//next hops (multipath) go to the outduct of their flow, so every bundle of a flow takes the same outduct, in order.
+Outduct* Egress::Impl::GetOutductForBundle(const cbhe_eid_t& finalDestEid, zmq::message_t& zmqMessageBundle) {
+    if (m_outductManager.HasMultipathNextHops()) {
+        cbhe_eid_t sourceEid(0, 0);
+        cbhe_eid_t bundleFinalDestEid(finalDestEid);
+        unsigned int priority = 0;
+        if (PeekBundleFlow(zmqMessageBundle, sourceEid, bundleFinalDestEid, priority) && (priority == 0)) { //bulk
+            if (Outduct* outduct = m_outductManager.GetMultipathOutductByFlow_ThreadSafe(sourceEid, finalDestEid)) {
+                return outduct;
+            }
+        }
+    }
+    return m_outductManager.GetOutductByFinalDestinationEid_ThreadSafe(finalDestEid);
+}
+
+void Egress::Impl::EgressWorkerThreadFunc(const uint64_t outductUuid) {
+    ThreadNamer::SetThisThreadName("egressWorker" + boost::lexical_cast<std::string>(outductUuid));
+    EgressWorker& worker = *m_egressWorkers[outductUuid];
+    Outduct* outduct = m_outductManager.GetOutductByOutductUuid(outductUuid);
+    EgressBundleScheduler<EgressWorkerQueueEntry>* const schedulerPtr = worker.m_schedulerPtr.get();
+    zmq::pollitem_t items[2] = {
+        {NULL, worker.m_bundleQueue.GetPollFd(), ZMQ_POLLIN, 0},
+        {NULL, worker.m_outductAckEvent.GetPollFd(), ZMQ_POLLIN, 0}
+    };
+    static constexpr long DEFAULT_BIG_TIMEOUT_POLL = 250;
+    EgressWorkerQueueEntry entry;
+    while (m_running.load(std::memory_order_acquire)) { //keep thread alive if running
+        const bool hasBundles = worker.m_bundleQueue.PrepareToWait();
+        //with a backlog in the scheduler, also wake up when the outduct acks a bundle (the recheck below avoids a missed notify)
+        const bool waitForOutductAck = (schedulerPtr != NULL) && (schedulerPtr->GetNumEntries() != 0);
+        bool outductHasRoom = false;
+        if (waitForOutductAck) {
+            worker.m_waitingForOutductAck.store(true, std::memory_order_seq_cst);
+            outductHasRoom = (outduct->GetTotalBundlesUnacked() < worker.m_maxBundlesInOutduct);
+        }
+        int rc = 0;
+        try {
+            rc = zmq::poll(&items[0], (waitForOutductAck) ? 2 : 1, (hasBundles || outductHasRoom) ? 0 : DEFAULT_BIG_TIMEOUT_POLL);
+        }
+        catch (zmq::error_t& e) {
+            LOG_ERROR(subprocess) << "caught zmq::error_t in Egress::EgressWorkerThreadFunc: " << e.what();
+        }
+        worker.m_bundleQueue.FinishWait((rc > 0) && (items[0].revents & ZMQ_POLLIN));
+        if (waitForOutductAck) {
+            worker.m_waitingForOutductAck.store(false, std::memory_order_relaxed);
+            if ((rc > 0) && (items[1].revents & ZMQ_POLLIN)) {
+                worker.m_outductAckEvent.Clear();
+            }
+        }
+        while (worker.m_bundleQueue.TryPop(entry)) {
+            if (schedulerPtr) {
+                cbhe_eid_t sourceEid(0, 0);
+                cbhe_eid_t finalDestEid(entry.toEgressHeader.finalDestEid);
+                unsigned int priority = 0;
+                PeekBundleFlow(entry.bundle, sourceEid, finalDestEid, priority); //if malformed, a (0,0) flow of bulk priority
+                const uint64_t bundleSize = entry.bundle.size();
+                schedulerPtr->Push(std::move(entry), bundleSize, sourceEid, finalDestEid, priority);
+                continue;
+            }
+            ForwardEgressWorkerQueueEntry(worker, *outduct, entry);
+        }
+        if (schedulerPtr) {
+            while ((outduct->GetTotalBundlesUnacked() < worker.m_maxBundlesInOutduct) && schedulerPtr->TryPop(entry)) {
+                ForwardEgressWorkerQueueEntry(worker, *outduct, entry);
+            }
+            worker.m_numFlowsInScheduler.store(schedulerPtr->GetNumFlows(), std::memory_order_relaxed);
+        }
+    }
+}
+
+//Called by an egress worker thread to give one bundle to its outduct.  Time in the worker queue (and scheduler) ends here.
+void Egress::Impl::ForwardEgressWorkerQueueEntry(EgressWorker& worker, Outduct& outduct, EgressWorkerQueueEntry& entry) {
+    const boost::posix_time::time_duration queueTime = boost::posix_time::microsec_clock::universal_time() - entry.enqueueTime;
+    const uint64_t queueTimeMicroseconds = (queueTime.is_negative()) ? 0 : static_cast<uint64_t>(queueTime.total_microseconds());
+    worker.m_totalQueueTimeMicroseconds.fetch_add(queueTimeMicroseconds, std::memory_order_relaxed);
+    if (queueTimeMicroseconds > worker.m_maxQueueTimeMicroseconds.load(std::memory_order_relaxed)) {
+        worker.m_maxQueueTimeMicroseconds.store(queueTimeMicroseconds, std::memory_order_relaxed); //only this thread writes it
+    }
+    const uint64_t bundleSize = entry.bundle.size();
+    if (ForwardToOutduct(outduct, entry.toEgressHeader, entry.bundle, entry.isCutThroughFromIngress)) {
+        worker.m_totalBundleBytesGivenToOutduct.fetch_add(bundleSize, std::memory_order_relaxed);
+        worker.m_totalBundlesGivenToOutduct.fetch_add(1, std::memory_order_relaxed);
+    }
+    worker.m_totalBundleBytesDequeued.fetch_add(bundleSize, std::memory_order_relaxed);
+    worker.m_totalBundlesDequeued.fetch_add(1, std::memory_order_release);
+    entry.bundle.rebuild(); //release the bundle now if the outduct did not take it
+}
+
+//Called by the outduct callbacks (any thread) so that an egress scheduler waiting for room in the outduct gives it its next bundle.
+void Egress::Impl::NotifyEgressWorkerOfOutductAck(const uint64_t outductUuid) {
+    if ((outductUuid < m_egressWorkers.size()) && m_egressWorkers[outductUuid]) {
+        EgressWorker& worker = *m_egressWorkers[outductUuid];
+        if (worker.m_waitingForOutductAck.load(std::memory_order_seq_cst) && worker.m_waitingForOutductAck.exchange(false)) {
+            worker.m_outductAckEvent.Notify();
+        }
+    }
+}
+
+//Sums the bundles given to the outducts by ReadZmqThreadFunc, by the egress workers and directly by ingress,
+//and adds the egress worker queue depth (scheduler backlog included), time-in-queue and scheduler flows to the outduct telemetry.
+//Must be called from within ReadZmqThreadFunc (or after it is joined).
+void Egress::Impl::PopulateBundlesGivenToOutductsTelemetry() {
+    uint64_t totalBundlesGivenToOutducts = m_totalBundlesGivenToOutductsByReaderThread
+        + m_totalBundlesGivenToOutductsDirectlyByIngress.load(std::memory_order_relaxed);
+    uint64_t totalBundleBytesGivenToOutducts = m_totalBundleBytesGivenToOutductsByReaderThread
+        + m_totalBundleBytesGivenToOutductsDirectlyByIngress.load(std::memory_order_relaxed);
+    //the list is in uuid order unless an outduct type has no telemetry (then only the totals are updated)
+    const bool listIsInUuidOrder = (m_allOutductTelem.m_listAllOutducts.size() == m_egressWorkers.size());
+    std::list<std::unique_ptr<OutductTelemetry_t> >::iterator otIt = m_allOutductTelem.m_listAllOutducts.begin();
+    for (std::size_t i = 0; i < m_egressWorkers.size(); ++i) {
+        if (!m_egressWorkers[i]) {
+            if (listIsInUuidOrder) {
+                ++otIt;
+            }
+            continue;
+        }
+        const EgressWorker& worker = *m_egressWorkers[i];
+        totalBundlesGivenToOutducts += worker.m_totalBundlesGivenToOutduct.load(std::memory_order_relaxed);
+        totalBundleBytesGivenToOutducts += worker.m_totalBundleBytesGivenToOutduct.load(std::memory_order_relaxed);
+        if (!listIsInUuidOrder) {
+            continue;
+        }
+        OutductTelemetry_t& ot = **otIt;
+        ++otIt;
+        const uint64_t totalDequeued = worker.m_totalBundlesDequeued.load(std::memory_order_acquire);
+        const uint64_t totalEnqueued = worker.m_totalBundlesEnqueued.load(std::memory_order_relaxed);
+        ot.m_numBundlesInEgressQueue = (totalEnqueued > totalDequeued) ? (totalEnqueued - totalDequeued) : 0;
+        ot.m_averageEgressQueueTimeMicroseconds = (totalDequeued) ? (worker.m_totalQueueTimeMicroseconds.load(std::memory_order_relaxed) / totalDequeued) : 0;
+        ot.m_maxEgressQueueTimeMicroseconds = worker.m_maxQueueTimeMicroseconds.load(std::memory_order_relaxed);
+        ot.m_numFlowsInEgressScheduler = worker.m_numFlowsInScheduler.load(std::memory_order_relaxed);
+    }
+    m_allOutductTelem.m_totalBundlesGivenToOutducts = totalBundlesGivenToOutducts;
+    m_allOutductTelem.m_totalBundleBytesGivenToOutducts = totalBundleBytesGivenToOutducts;
+}
+
+//must be called from within ReadZmqThreadFunc to protect m_zmqPushSock_boundEgressToConnectingRouterPtr
+void Egress::Impl::ForwardBundleToRouter(zmq::message_t& zmqMessageBundleToRouter) {
+    LOG_INFO(subprocess) << "forwarding bundle to router";
+    hdtn::LinkStatusHdr linkStatusMsg;
+    linkStatusMsg.base.type = HDTN_MSGTYPE_BUNDLES_TO_ROUTER;
+    while (m_running.load(std::memory_order_acquire) && !m_zmqPushSock_boundEgressToConnectingRouterPtr->send(
+        zmq::const_buffer(&linkStatusMsg, sizeof(linkStatusMsg)), zmq::send_flags::sndmore | zmq::send_flags::dontwait))
+    {
+        LOG_INFO(subprocess) << "waiting for router to become available to send HDTN_MSGTYPE_BUNDLES_TO_ROUTER header";
+        boost::this_thread::sleep(boost::posix_time::seconds(1));
+    }
+    while (m_running.load(std::memory_order_acquire) && !m_zmqPushSock_boundEgressToConnectingRouterPtr->send(zmqMessageBundleToRouter, zmq::send_flags::dontwait)) {
+        LOG_INFO(subprocess) << "waiting for router to become available to send it a router-only bundle received by ingress";
+        boost::this_thread::sleep(boost::posix_time::seconds(1));
+    }
+}
+
 //must be called from within ReadZmqThreadFunc to protect m_zmqPushSock_boundEgressToConnectingRouterPtr
 void Egress::Impl::ResendOutductCapabilities() {
     AllOutductCapabilitiesTelemetry_t allOutductCapabilitiesTelemetry;
     m_outductManager.GetAllOutductCapabilitiesTelemetry_ThreadSafe(allOutductCapabilitiesTelemetry);
+    PopulateOutductVolumes(allOutductCapabilitiesTelemetry);
 
     //one serialization in one memory location, 3 shared_ptr references
     std::shared_ptr<std::string>* jsonRawPtrToSharedPtr =
@@ -773,6 +1268,76 @@ void Egress::Impl::ResendOutductCapabilities() {
     }
 }
 
+//The bundle bytes waiting in the outduct's egress worker queue (and scheduler), 0 without a worker
+uint64_t Egress::Impl::GetBundleBytesInEgressQueue(const uint64_t outductUuid) const {
+    if ((outductUuid >= m_egressWorkers.size()) || (!m_egressWorkers[outductUuid])) {
+        return 0;
+    }
+    const EgressWorker& worker = *m_egressWorkers[outductUuid];
+    const uint64_t totalDequeued = worker.m_totalBundleBytesDequeued.load(std::memory_order_relaxed);
+    const uint64_t totalEnqueued = worker.m_totalBundleBytesEnqueued.load(std::memory_order_relaxed);
+    return (totalEnqueued > totalDequeued) ? (totalEnqueued - totalDequeued) : 0;
+}
+
+//Sets the bundle bytes given to each outduct and waiting in its egress queue (and scheduler), as reported to the router.
+//Must be called from within ReadZmqThreadFunc (which owns m_lastReportedOutductVolumes).
+void Egress::Impl::PopulateOutductVolumes(AllOutductCapabilitiesTelemetry_t& allOutductCapabilitiesTelemetry) {
+    for (std::list<OutductCapabilityTelemetry_t>::iterator it = allOutductCapabilitiesTelemetry.outductCapabilityTelemetryList.begin();
+        it != allOutductCapabilitiesTelemetry.outductCapabilityTelemetryList.end(); ++it)
+    {
+        OutductCapabilityTelemetry_t& oct = *it;
+        const uint64_t i = oct.outductArrayIndex;
+        if (i >= m_numOutducts) {
+            continue;
+        }
+        oct.totalBundleBytesGivenToOutduct = m_totalBundleBytesGivenToOutductByUuid[i].load(std::memory_order_relaxed);
+        oct.bundleBytesInEgressQueue = GetBundleBytesInEgressQueue(i);
+        m_lastReportedOutductVolumes[2 * i] = oct.totalBundleBytesGivenToOutduct;
+        m_lastReportedOutductVolumes[(2 * i) + 1] = oct.bundleBytesInEgressQueue;
+    }
+}
+
+//Sends the router the outduct capabilities with their latest volumes (only), if the volumes changed since last reported
+//and OUTDUCT_VOLUME_REPORT_INTERVAL has elapsed.  Must be called from within ReadZmqThreadFunc to protect m_zmqPushSock_boundEgressToConnectingRouterPtr
+void Egress::Impl::TrySendOutductVolumesToRouter() {
+    const boost::posix_time::ptime nowTime = boost::posix_time::microsec_clock::universal_time();
+    if ((nowTime - m_lastOutductVolumeReportTime) < OUTDUCT_VOLUME_REPORT_INTERVAL) {
+        return;
+    }
+    m_lastOutductVolumeReportTime = nowTime;
+    bool volumesChanged = false;
+    for (std::size_t i = 0; (i < m_numOutducts) && (!volumesChanged); ++i) {
+        volumesChanged = (m_lastReportedOutductVolumes[2 * i] != m_totalBundleBytesGivenToOutductByUuid[i].load(std::memory_order_relaxed))
+            || (m_lastReportedOutductVolumes[(2 * i) + 1] != GetBundleBytesInEgressQueue(i));
+    }
+    if (!volumesChanged) {
+        return;
+    }
+
+    AllOutductCapabilitiesTelemetry_t allOutductCapabilitiesTelemetry;
+    m_outductManager.GetAllOutductCapabilitiesTelemetry_ThreadSafe(allOutductCapabilitiesTelemetry);
+    PopulateOutductVolumes(allOutductCapabilitiesTelemetry);
+    std::shared_ptr<std::string>* jsonRawPtrToSharedPtr =
+        new std::shared_ptr<std::string>(std::make_shared<std::string>(allOutductCapabilitiesTelemetry.ToJson()));
+    std::string& strRef = **jsonRawPtrToSharedPtr;
+    zmq::message_t zmqMsgToRouter(
+        &strRef[0],
+        strRef.size(),
+        CustomCleanupSharedPtrStdString,
+        jsonRawPtrToSharedPtr);
+
+    hdtn::LinkStatusHdr linkStatusHdr;
+    //memset 0 not needed because remaining values are "don't care"
+    linkStatusHdr.base.type = HDTN_MSGTYPE_ALL_OUTDUCT_CAPABILITIES_TELEMETRY;
+    //a volume report is not worth waiting for (unlike the capabilities), the next one will include these volumes
+    if ((!m_zmqPushSock_boundEgressToConnectingRouterPtr->send(zmq::const_buffer(&linkStatusHdr, sizeof(linkStatusHdr)), zmq::send_flags::sndmore | zmq::send_flags::dontwait))
+        || (!m_zmqPushSock_boundEgressToConnectingRouterPtr->send(std::move(zmqMsgToRouter), zmq::send_flags::dontwait)))
+    {
+        LOG_DEBUG(subprocess) << "router not available for an outduct volume report";
+        std::fill(m_lastReportedOutductVolumes.begin(), m_lastReportedOutductVolumes.end(), UINT64_MAX); //report again next time
+    }
+}
+
 static void CustomCleanupPaddedVecUint8(void *data, void *hint) {
     (void)data;
     delete static_cast<padded_vector_uint8_t*>(hint);
@@ -814,6 +1379,7 @@ void Egress::Impl::OnFailedBundleZmqSendCallback(zmq::message_t& movableBundle,
 
     if(hasOutduct) {
         OnOutductLinkStatusChangedCallback(isLinkDownEvent, outductUuid);
+        NotifyEgressWorkerOfOutductAck(outductUuid);
     }
 
     if (successCallbackCalled) { //ltp sender with sessions from disk enabled
@@ -886,6 +1452,15 @@ void Egress::Impl::OnSuccessfulBundleSendCallback(std::vector<uint8_t>& userData
 
     static constexpr bool isLinkDownEvent = false;
     OnOutductLinkStatusChangedCallback(isLinkDownEvent, outductUuid);
+    NotifyEgressWorkerOfOutductAck(outductUuid);
+
+    if (m_directOutductForwarderPtr && (userData.size() == sizeof(hdtn::EgressAckHdr))) {
+        const hdtn::EgressAckHdr* directAckPtr = (const hdtn::EgressAckHdr*)userData.data();
+        if (directAckPtr->base.flags & HDTN_EGRESS_ACK_FLAG_DIRECT_FORWARD) { //complete the ingress pipeline accounting without zmq
+            m_directOutductForwarderPtr->OnSuccessfulSend(*directAckPtr);
+            return;
+        }
+    }
     
     //this is an optimization because we only have one chunk to send
     //The zmq_msg_init_data() function shall initialise the message object referenced by msg
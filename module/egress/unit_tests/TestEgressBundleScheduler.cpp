@@ -0,0 +1,117 @@
+/**
+ * @file TestEgressBundleScheduler.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "EgressBundleScheduler.h"
+#include <string>
+#include <vector>
+
+typedef EgressBundleScheduler<std::string> string_scheduler_t;
+
+static std::string PopAll(string_scheduler_t& scheduler) {
+    std::string order;
+    std::string entry;
+    while (scheduler.TryPop(entry)) {
+        order += entry;
+    }
+    return order;
+}
+
+BOOST_AUTO_TEST_CASE(EgressBundleSchedulerFifoAndPriorityTestCase)
+{
+    string_scheduler_t::SchedulerType schedulerType;
+    BOOST_REQUIRE(string_scheduler_t::SchedulerTypeFromString("drr", schedulerType));
+    BOOST_REQUIRE(schedulerType == string_scheduler_t::SchedulerType::DRR);
+    BOOST_REQUIRE(!string_scheduler_t::SchedulerTypeFromString("wfq", schedulerType));
+
+    const cbhe_eid_t src(1, 1);
+    const cbhe_eid_t dest(2, 1);
+    {
+        string_scheduler_t fifo(string_scheduler_t::SchedulerType::FIFO, 1000);
+        fifo.Push("a", 100, src, dest, 0);
+        fifo.Push("b", 100, src, dest, 2);
+        fifo.Push("c", 100, src, dest, 1);
+        BOOST_REQUIRE_EQUAL(fifo.GetNumEntries(), 3);
+        BOOST_REQUIRE_EQUAL(PopAll(fifo), "abc");
+    }
+    {
+        string_scheduler_t priority(string_scheduler_t::SchedulerType::PRIORITY, 1000);
+        priority.Push("a", 100, src, dest, 0);
+        priority.Push("b", 100, src, dest, 1);
+        priority.Push("c", 100, src, dest, 2);
+        priority.Push("d", 100, src, dest, 0);
+        priority.Push("e", 100, src, dest, 7); //treated as expedited
+        priority.Push("f", 100, src, dest, 1);
+        BOOST_REQUIRE_EQUAL(priority.GetNumFlows(), 3);
+        BOOST_REQUIRE_EQUAL(PopAll(priority), "cebfad");
+        BOOST_REQUIRE_EQUAL(priority.GetNumEntries(), 0);
+        BOOST_REQUIRE_EQUAL(priority.GetNumFlows(), 0);
+        std::string entry;
+        BOOST_REQUIRE(!priority.TryPop(entry));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(EgressBundleSchedulerDrrTestCase)
+{
+    const cbhe_eid_t srcA(1, 1);
+    const cbhe_eid_t srcB(3, 1);
+    const cbhe_eid_t dest(2, 1);
+    {
+        //a large flow queued first does not delay a later flow by more than one quantum
+        string_scheduler_t drr(string_scheduler_t::SchedulerType::DRR, 1000);
+        for (unsigned int i = 0; i < 4; ++i) {
+            drr.Push("A", 1000, srcA, dest, 0);
+        }
+        for (unsigned int i = 0; i < 4; ++i) {
+            drr.Push("B", 1000, srcB, dest, 0);
+        }
+        BOOST_REQUIRE_EQUAL(drr.GetNumFlows(), 2);
+        BOOST_REQUIRE_EQUAL(PopAll(drr), "ABABABAB");
+        BOOST_REQUIRE_EQUAL(drr.GetNumFlows(), 0);
+    }
+    {
+        //same source and destination but a different priority is a different flow with 4x the quantum of bulk
+        string_scheduler_t drr(string_scheduler_t::SchedulerType::DRR, 1000);
+        for (unsigned int i = 0; i < 8; ++i) {
+            drr.Push("b", 1000, srcA, dest, 0);
+        }
+        for (unsigned int i = 0; i < 8; ++i) {
+            drr.Push("E", 1000, srcA, dest, 2);
+        }
+        BOOST_REQUIRE_EQUAL(drr.GetNumFlows(), 2);
+        BOOST_REQUIRE_EQUAL(PopAll(drr), "bEEEEbEEEEbbbbbb");
+    }
+    {
+        //fairness is in bytes: a flow of small bundles sends several per turn of a flow of large bundles
+        string_scheduler_t drr(string_scheduler_t::SchedulerType::DRR, 1500);
+        for (unsigned int i = 0; i < 3; ++i) {
+            drr.Push("L", 3000, srcA, dest, 0);
+        }
+        for (unsigned int i = 0; i < 6; ++i) {
+            drr.Push("s", 500, srcB, dest, 0);
+        }
+        //round 1: L has 1500 < 3000 (keeps its deficit), s sends 3; round 2: L sends 1, s sends 3
+        BOOST_REQUIRE_EQUAL(PopAll(drr), "sssLsssLL");
+    }
+    {
+        //bundles of one flow keep their order, and a flow that empties leaves the round
+        string_scheduler_t drr(string_scheduler_t::SchedulerType::DRR, 1000);
+        drr.Push("1", 10, srcA, dest, 1);
+        drr.Push("2", 10, srcA, dest, 1);
+        std::string entry;
+        BOOST_REQUIRE(drr.TryPop(entry));
+        BOOST_REQUIRE_EQUAL(entry, "1");
+        drr.Push("3", 10, srcA, dest, 1);
+        BOOST_REQUIRE_EQUAL(drr.GetNumFlows(), 1);
+        BOOST_REQUIRE_EQUAL(PopAll(drr), "23");
+        BOOST_REQUIRE_EQUAL(drr.GetNumFlows(), 0);
+        BOOST_REQUIRE_EQUAL(drr.GetNumEntries(), 0);
+        BOOST_REQUIRE(!drr.TryPop(entry));
+    }
+}
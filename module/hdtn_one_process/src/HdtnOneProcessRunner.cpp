@@ -24,6 +24,7 @@
 #include <iostream>
 #include "Logger.h"
 #include "message.hpp"
+#include "InprocChannels.hpp"
 #include <boost/filesystem/path.hpp>
 #include <boost/filesystem/operations.hpp>
 #include <boost/program_options.hpp>
@@ -161,6 +162,20 @@ bool HdtnOneProcessRunner::Run(int argc, const char *const argv[], std::atomic<b
         //If your application is using only the inproc transport for messaging you may set this to zero, otherwise set it to at least one.
         std::unique_ptr<zmq::context_t> hdtnOneProcessZmqInprocContextPtr = boost::make_unique<zmq::context_t>(0);// 0 Threads
 
+        //Lock-free replacement for the inproc ingress to egress zmq socket (the hop taken by every cut-through bundle).
+        //Falls back to zmq if the platform cannot poll its wakeup event alongside zmq sockets (Windows).
+        std::unique_ptr<hdtn::ToEgressInprocChannel> toEgressInprocChannelPtr = boost::make_unique<hdtn::ToEgressInprocChannel>(hdtn::TO_EGRESS_INPROC_CHANNEL_CAPACITY);
+        if (!toEgressInprocChannelPtr->IsValid()) {
+            LOG_INFO(subprocess) << "in-process channel not supported on this platform, using zmq inproc sockets from ingress to egress";
+            toEgressInprocChannelPtr.reset();
+        }
+
+        //Optional fast path that lets ingress give non-custody cut-through bundles straight to the outducts owned by egress.
+        std::unique_ptr<hdtn::DirectOutductForwarder> directOutductForwarderPtr;
+        if (hdtnConfig->m_oneProcessDirectOutductForward) {
+            directOutductForwarderPtr = boost::make_unique<hdtn::DirectOutductForwarder>();
+        }
+
         LOG_INFO(subprocess) << "starting Router..";
         std::unique_ptr<Router> routerPtr = boost::make_unique<Router>();
         if (!routerPtr->Init(*hdtnConfig, unusedHdtnDistributedConfig, contactPlanFilePath, usingUnixTimestamp, useMgr, hdtnOneProcessZmqInprocContextPtr.get())) {
@@ -171,7 +186,9 @@ bool HdtnOneProcessRunner::Run(int argc, const char *const argv[], std::atomic<b
         //No need to create Egress, Ingress, and Storage on heap with unique_ptr to prevent stack overflows because they use the pimpl pattern
         //However, the unique_ptr reset() function is useful for isolating destructor hangs on exit
         std::unique_ptr<hdtn::Egress> egressPtr = boost::make_unique<hdtn::Egress>();
-        if (!egressPtr->Init(*hdtnConfig, unusedHdtnDistributedConfig, hdtnOneProcessZmqInprocContextPtr.get())) {
+        if (!egressPtr->Init(*hdtnConfig, unusedHdtnDistributedConfig, hdtnOneProcessZmqInprocContextPtr.get(), toEgressInprocChannelPtr.get(),
+            directOutductForwarderPtr.get()))
+        {
             return false;
         }
 
@@ -180,7 +197,9 @@ bool HdtnOneProcessRunner::Run(int argc, const char *const argv[], std::atomic<b
         if (!ingressPtr->Init(*hdtnConfig, bpSecConfigFilePath,
             unusedHdtnDistributedConfig,
             hdtnOneProcessZmqInprocContextPtr.get(),
-            maskerImpl))
+            maskerImpl,
+            toEgressInprocChannelPtr.get(),
+            directOutductForwarderPtr.get()))
         {
             return false;
         }
@@ -262,6 +281,9 @@ bool HdtnOneProcessRunner::Run(int argc, const char *const argv[], std::atomic<b
         LOG_INFO(subprocess) << "Egress: deleting..";
         egressPtr.reset();
 
+        toEgressInprocChannelPtr.reset(); //after both its producer (ingress) and consumer (egress) are deleted
+        directOutductForwarderPtr.reset(); //likewise
+
         LOG_INFO(subprocess) << "Inproc zmq context: deleting..";
         hdtnOneProcessZmqInprocContextPtr.reset();
 
@@ -0,0 +1,105 @@
+/**
+ * @file BundlePipelineAckingSet.h
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * This BundlePipelineAckingSet class tracks, for one ingress outduct (or for storage), the bundles
+ * sent to egress and to storage that have not yet been acked, and limits each of the two pipelines to half of
+ * the outduct's maxBundlesInPipeline and maxBundleSizeBytesInPipeline.
+ * Each pipeline is a pair of atomic credit counters (bundles and bytes) plus a fixed-size open addressing
+ * table (indexed by the low bits of the ingress unique id) mapping an in-flight unique id to its size in bytes for ack matching.
+ * Reserving and acking are lock-free.  The mutex and condition variable are only used by an induct thread that
+ * finds both pipelines full and must wait, and an ack only wakes the waiting threads when it frees enough credit
+ * for the smallest waiting bundle to fit.
+ */
+
+#ifndef _BUNDLE_PIPELINE_ACKING_SET_H
+#define _BUNDLE_PIPELINE_ACKING_SET_H 1
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <boost/thread.hpp>
+#include <boost/date_time.hpp>
+#include <boost/core/noncopyable.hpp>
+#include "ingress_async_lib_export.h"
+
+namespace hdtn {
+
+class BundlePipelineAckingSet : private boost::noncopyable {
+public:
+    BundlePipelineAckingSet() = delete; //vector resize() not possible, must use reserve()
+    INGRESS_ASYNC_LIB_EXPORT BundlePipelineAckingSet(const uint64_t paramMaxBundlesInPipeline,
+        const uint64_t paramMaxBundleSizeBytesInPipeline, const uint64_t paramNextHopNodeId, bool paramLinkIsUp);
+    INGRESS_ASYNC_LIB_EXPORT ~BundlePipelineAckingSet();
+
+    /// Not thread safe: the caller must guarantee that no other thread is using this set (bundles may be in flight).
+    INGRESS_ASYNC_LIB_EXPORT void Update(const uint64_t paramMaxBundlesInPipeline,
+        const uint64_t paramMaxBundleSizeBytesInPipeline, const uint64_t paramNextHopNodeId, bool paramLinkIsUp);
+
+    /// Release the reservation of uniqueId (wakes waiting threads if they now fit).  Returns false if uniqueId was not in the pipeline.
+    INGRESS_ASYNC_LIB_EXPORT bool CompareAndPop_ThreadSafe(const uint64_t uniqueId, const bool isEgress);
+
+    //make sure at least one of [checkEgressPipeline, checkStoragePipeline] are true, otherwise a timeout will occur followed by a return false
+    //return true if either the egress or storage got reserved, false if timeout
+    INGRESS_ASYNC_LIB_EXPORT bool WaitForPipelineAvailabilityAndReserve(const bool checkEgressPipeline, const bool checkStoragePipeline,
+        const boost::posix_time::time_duration& timeoutDuration, const uint64_t uniqueId, const uint64_t bundleSizeBytes,
+        bool& reservedEgressPipelineAvailability, bool& reservedStoragePipelineAvailability);
+    INGRESS_ASYNC_LIB_EXPORT bool WaitForStoragePipelineAvailabilityAndReserve(const boost::posix_time::time_duration& timeoutDuration,
+        const uint64_t uniqueId, const uint64_t bundleSizeBytes);
+    INGRESS_ASYNC_LIB_EXPORT uint64_t GetNextHopNodeId() const;
+    INGRESS_ASYNC_LIB_EXPORT uint64_t GetNumBundlesInPipeline(const bool isEgress) const;
+    INGRESS_ASYNC_LIB_EXPORT uint64_t GetNumBytesInPipeline(const bool isEgress) const;
+    INGRESS_ASYNC_LIB_EXPORT uint64_t GetNumWakeups() const;
+
+private:
+    static constexpr uint64_t EMPTY_KEY = UINT64_MAX; //never used
+    static constexpr uint64_t DELETED_KEY = UINT64_MAX - 1; //used then acked (reusable, but a lookup continues past it)
+    static constexpr uint64_t BUSY_KEY = UINT64_MAX - 2; //claimed by an inserting thread that has not yet published the unique id
+
+    struct slot_t {
+        std::atomic<uint64_t> key;
+        uint64_t bundleSizeBytes; //written before key is published
+    };
+    struct pipeline_t {
+        pipeline_t();
+        std::atomic<uint64_t> numBundles;
+        std::atomic<uint64_t> numBytes;
+        uint8_t padding[64]; //keep the egress and storage counters on separate cache lines
+        std::unique_ptr<slot_t[]> slots;
+        uint64_t slotsMask;
+    };
+
+    INGRESS_ASYNC_LIB_NO_EXPORT bool TryReserve(pipeline_t& pipeline, const uint64_t uniqueId, const uint64_t bundleSizeBytes);
+    INGRESS_ASYNC_LIB_NO_EXPORT void Release(pipeline_t& pipeline, const uint64_t bundleSizeBytes);
+    INGRESS_ASYNC_LIB_NO_EXPORT bool TryReserveEither(const bool checkEgressPipeline, const bool checkStoragePipeline,
+        const uint64_t uniqueId, const uint64_t bundleSizeBytes,
+        bool& reservedEgressPipelineAvailability, bool& reservedStoragePipelineAvailability);
+    INGRESS_ASYNC_LIB_NO_EXPORT static void InsertIntoTable(pipeline_t& pipeline, const uint64_t uniqueId, const uint64_t bundleSizeBytes);
+    INGRESS_ASYNC_LIB_NO_EXPORT static void ResizeTable(pipeline_t& pipeline, const uint64_t maxBundles);
+
+    pipeline_t m_egressPipeline;
+    pipeline_t m_storagePipeline;
+
+    uint64_t m_halfOfMaxBundlesInPipeline;
+    uint64_t m_halfOfMaxBytesInPipeline;
+    uint64_t m_nextHopNodeId;
+
+    //only used when an induct thread must wait
+    boost::mutex m_mutex;
+    boost::condition_variable m_conditionVariable;
+    std::atomic<uint32_t> m_numWaiters;
+    std::atomic<uint64_t> m_smallestWaitingBundleSizeBytes; //UINT64_MAX if none, may be stale (too small) which only causes an extra wakeup
+    std::atomic<uint64_t> m_numWakeups;
+public:
+    bool m_linkIsUp;
+};
+
+}  // namespace hdtn
+
+#endif //_BUNDLE_PIPELINE_ACKING_SET_H
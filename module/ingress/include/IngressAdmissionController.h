@@ -0,0 +1,93 @@
+/**
+ * @file IngressAdmissionController.h
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * This IngressAdmissionController class decides, when ingressAdmissionControl is enabled in the HdtnConfig,
+ * how ingress treats a bundle received on an induct while the egress and storage pipelines may be full.
+ * Without it, every bundle waits (blocking its induct thread, and so the whole convergence layer session)
+ * for a pipeline slot, so a burst of bulk traffic delays the expedited traffic behind it.
+ * The decision for each bundle is:
+ * - DROP: the bundle has expired.
+ * - ADMIT: the bundle is expedited, or is normal priority and its source has not exceeded
+ *   ingressAdmissionMaxBundlesPerSecondPerSource; it waits for a pipeline slot as before.
+ * - ADMIT_WITHOUT_WAITING: the bundle is bulk, or its source exceeded its rate; it is dropped early
+ *   rather than waiting if no pipeline slot is free.
+ * In addition, while the used storage space reported by storage (in its acks to ingress) is at least
+ * ingressAdmissionStorageFullPercent, bundles that are not expedited are refused before being sent to storage,
+ * so that the remaining space (and custody) is kept for expedited traffic.
+ * All methods are thread safe (called by the induct threads and by the ingress ack reader thread).
+ */
+
+#ifndef _INGRESS_ADMISSION_CONTROLLER_H
+#define _INGRESS_ADMISSION_CONTROLLER_H 1
+
+#include <cstdint>
+#include <atomic>
+#include <unordered_map>
+#include <boost/thread/mutex.hpp>
+#include <boost/core/noncopyable.hpp>
+#include "ingress_async_lib_export.h"
+
+namespace hdtn {
+
+class IngressAdmissionController : private boost::noncopyable {
+public:
+    enum class DECISION { ADMIT = 0, ADMIT_WITHOUT_WAITING, DROP };
+    static constexpr uint8_t EXPEDITED_PRIORITY = 2; //0 bulk, 1 normal, 2 expedited (bpv7 bundles have no priority and are expedited)
+
+    IngressAdmissionController() = delete;
+    /**
+     * @param storageFullPercent Refuse bundles that are not expedited from storage when its used space is at least this percent (more than 100 never refuses).
+     * @param maxBundlesPerSecondPerSource Normal priority bundles of a source above this rate do not wait for the pipelines (0 => no limit).
+     */
+    INGRESS_ASYNC_LIB_EXPORT IngressAdmissionController(const uint64_t storageFullPercent, const uint64_t maxBundlesPerSecondPerSource);
+    INGRESS_ASYNC_LIB_EXPORT ~IngressAdmissionController();
+
+    /**
+     * Classify a bundle received on an induct (counts it against its source's rate).
+     * @param sourceNodeId The bundle's source node.
+     * @param priority The bundle's priority (0 bulk, 1 normal, 2 expedited).
+     * @param isExpired True if the bundle's lifetime has ended.
+     * @param bundleSizeBytes The bundle size, counted if the bundle is dropped.
+     * @param nowSeconds The current time in seconds (the rate window).
+     * @return The admission decision (a DROP is counted).
+     */
+    INGRESS_ASYNC_LIB_EXPORT DECISION Admit(const uint64_t sourceNodeId, const uint8_t priority, const bool isExpired,
+        const uint64_t bundleSizeBytes, const uint64_t nowSeconds);
+
+    /// @return True if a bundle of this priority must not be sent to storage (and is counted as dropped).
+    INGRESS_ASYNC_LIB_EXPORT bool RefuseStorage(const uint8_t priority, const uint64_t bundleSizeBytes);
+
+    /// Count a bundle admitted without waiting that found no free pipeline slot.
+    INGRESS_ASYNC_LIB_EXPORT void RecordEarlyDrop(const uint64_t bundleSizeBytes) noexcept;
+
+    /// Set from the storage acks.
+    INGRESS_ASYNC_LIB_EXPORT void SetStorageUsedPercent(const uint8_t storageUsedPercent) noexcept;
+    INGRESS_ASYNC_LIB_EXPORT uint8_t GetStorageUsedPercent() const noexcept;
+
+    INGRESS_ASYNC_LIB_EXPORT uint64_t GetNumBundlesDropped() const noexcept;
+    INGRESS_ASYNC_LIB_EXPORT uint64_t GetNumBytesDropped() const noexcept;
+
+private:
+    INGRESS_ASYNC_LIB_NO_EXPORT bool ExceedsSourceRate(const uint64_t sourceNodeId, const uint64_t nowSeconds);
+
+    const uint64_t M_STORAGE_FULL_PERCENT;
+    const uint64_t M_MAX_BUNDLES_PER_SECOND_PER_SOURCE;
+    std::atomic<uint8_t> m_storageUsedPercent;
+    std::atomic<uint64_t> m_numBundlesDropped;
+    std::atomic<uint64_t> m_numBytesDropped;
+
+    boost::mutex m_sourceRateMutex;
+    uint64_t m_sourceRateWindowSeconds; //protected by m_sourceRateMutex
+    std::unordered_map<uint64_t, uint64_t> m_sourceNodeIdToNumBundlesInWindowMap; //protected by m_sourceRateMutex
+};
+
+}  // namespace hdtn
+
+#endif //_INGRESS_ADMISSION_CONTROLLER_H
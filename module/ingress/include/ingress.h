@@ -30,8 +30,14 @@
 #include <boost/core/noncopyable.hpp>
 #include "ingress_async_lib_export.h"
 
+template <typename T> class InprocMessageChannel;
+
 namespace hdtn {
 
+struct ToEgressInprocMessage;
+typedef InprocMessageChannel<ToEgressInprocMessage> ToEgressInprocChannel; //defined in InprocChannels.hpp
+class DirectOutductForwarder; //defined in InprocChannels.hpp
+
 
 class Ingress : private boost::noncopyable {
 public:
@@ -41,7 +47,9 @@ public:
     INGRESS_ASYNC_LIB_EXPORT bool Stopped() noexcept;
     INGRESS_ASYNC_LIB_EXPORT bool Init(const HdtnConfig& hdtnConfig,
         const boost::filesystem::path& bpSecConfigFilePath, const HdtnDistributedConfig& hdtnDistributedConfig,
-        zmq::context_t* hdtnOneProcessZmqInprocContextPtr = NULL, const std::string& maskerImpl = "");
+        zmq::context_t* hdtnOneProcessZmqInprocContextPtr = NULL, const std::string& maskerImpl = "",
+        ToEgressInprocChannel* hdtnOneProcessToEgressInprocChannelPtr = NULL,
+        DirectOutductForwarder* hdtnOneProcessDirectOutductForwarderPtr = NULL);
 private:
 
     // Internal implementation class
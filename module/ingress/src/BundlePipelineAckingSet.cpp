@@ -0,0 +1,228 @@
+/**
+ * @file BundlePipelineAckingSet.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include "BundlePipelineAckingSet.h"
+
+namespace hdtn {
+
+static constexpr uint64_t MIN_TABLE_SIZE = 16;
+
+BundlePipelineAckingSet::pipeline_t::pipeline_t() :
+    numBundles(0),
+    numBytes(0),
+    slotsMask(0) {}
+
+BundlePipelineAckingSet::BundlePipelineAckingSet(const uint64_t paramMaxBundlesInPipeline,
+    const uint64_t paramMaxBundleSizeBytesInPipeline, const uint64_t paramNextHopNodeId, bool paramLinkIsUp) :
+    m_halfOfMaxBundlesInPipeline(0),
+    m_halfOfMaxBytesInPipeline(0),
+    m_nextHopNodeId(paramNextHopNodeId),
+    m_numWaiters(0),
+    m_smallestWaitingBundleSizeBytes(UINT64_MAX),
+    m_numWakeups(0),
+    m_linkIsUp(paramLinkIsUp)
+{
+    Update(paramMaxBundlesInPipeline, paramMaxBundleSizeBytesInPipeline, paramNextHopNodeId, paramLinkIsUp);
+}
+
+BundlePipelineAckingSet::~BundlePipelineAckingSet() {}
+
+void BundlePipelineAckingSet::Update(const uint64_t paramMaxBundlesInPipeline,
+    const uint64_t paramMaxBundleSizeBytesInPipeline, const uint64_t paramNextHopNodeId, bool paramLinkIsUp)
+{
+    m_halfOfMaxBundlesInPipeline = paramMaxBundlesInPipeline >> 1;
+    m_halfOfMaxBytesInPipeline = paramMaxBundleSizeBytesInPipeline >> 1;
+    m_nextHopNodeId = paramNextHopNodeId;
+    m_linkIsUp = paramLinkIsUp;
+    //at most half of maxBundlesInPipeline unique ids are in each table, so keep the load factor at or below 0.5
+    ResizeTable(m_egressPipeline, m_halfOfMaxBundlesInPipeline);
+    ResizeTable(m_storagePipeline, m_halfOfMaxBundlesInPipeline);
+}
+
+void BundlePipelineAckingSet::ResizeTable(pipeline_t& pipeline, const uint64_t maxBundles) {
+    uint64_t newSize = MIN_TABLE_SIZE;
+    while (newSize < (maxBundles << 1)) {
+        newSize <<= 1;
+    }
+    if ((newSize - 1) <= pipeline.slotsMask) {
+        return; //never shrink, bundles reserved under the old limit may still be in flight
+    }
+    std::unique_ptr<slot_t[]> oldSlots(std::move(pipeline.slots));
+    const uint64_t oldSize = (oldSlots) ? (pipeline.slotsMask + 1) : 0;
+    pipeline.slots.reset(new slot_t[newSize]);
+    pipeline.slotsMask = newSize - 1;
+    for (uint64_t i = 0; i < newSize; ++i) {
+        pipeline.slots[i].key.store(EMPTY_KEY, std::memory_order_relaxed);
+        pipeline.slots[i].bundleSizeBytes = 0;
+    }
+    for (uint64_t i = 0; i < oldSize; ++i) { //rehash the in-flight unique ids
+        const uint64_t key = oldSlots[i].key.load(std::memory_order_relaxed);
+        if (key < BUSY_KEY) {
+            InsertIntoTable(pipeline, key, oldSlots[i].bundleSizeBytes);
+        }
+    }
+}
+
+void BundlePipelineAckingSet::InsertIntoTable(pipeline_t& pipeline, const uint64_t uniqueId, const uint64_t bundleSizeBytes) {
+    //the caller already holds a bundle credit, so fewer than half of the slots are in use and a free slot always exists
+    for (uint64_t i = uniqueId; ; ++i) {
+        slot_t& slot = pipeline.slots[i & pipeline.slotsMask];
+        uint64_t key = slot.key.load(std::memory_order_relaxed);
+        while ((key == EMPTY_KEY) || (key == DELETED_KEY)) {
+            if (slot.key.compare_exchange_weak(key, BUSY_KEY, std::memory_order_acquire, std::memory_order_relaxed)) {
+                slot.bundleSizeBytes = bundleSizeBytes;
+                slot.key.store(uniqueId, std::memory_order_release);
+                return;
+            }
+        }
+    }
+}
+
+bool BundlePipelineAckingSet::TryReserve(pipeline_t& pipeline, const uint64_t uniqueId, const uint64_t bundleSizeBytes) {
+    uint64_t numBundles = pipeline.numBundles.load(std::memory_order_relaxed);
+    do {
+        if (numBundles >= m_halfOfMaxBundlesInPipeline) {
+            return false;
+        }
+    } while (!pipeline.numBundles.compare_exchange_weak(numBundles, numBundles + 1, std::memory_order_seq_cst, std::memory_order_relaxed));
+
+    //optimistically add the bytes, then undo if that went over the limit
+    const uint64_t numBytesBefore = pipeline.numBytes.fetch_add(bundleSizeBytes, std::memory_order_seq_cst);
+    if ((numBytesBefore + bundleSizeBytes) > m_halfOfMaxBytesInPipeline) {
+        Release(pipeline, bundleSizeBytes); //another thread may have failed because of this transient overshoot
+        return false;
+    }
+    InsertIntoTable(pipeline, uniqueId, bundleSizeBytes);
+    return true;
+}
+
+void BundlePipelineAckingSet::Release(pipeline_t& pipeline, const uint64_t bundleSizeBytes) {
+    const uint64_t numBytes = pipeline.numBytes.fetch_sub(bundleSizeBytes, std::memory_order_seq_cst) - bundleSizeBytes;
+    const uint64_t numBundles = pipeline.numBundles.fetch_sub(1, std::memory_order_seq_cst) - 1;
+
+    //pairs with the increment of m_numWaiters before a waiter's last try under the mutex:
+    //either that try sees the released credit or this sees the waiter
+    if (m_numWaiters.load(std::memory_order_seq_cst) == 0) {
+        return;
+    }
+    //only wake the waiters once the smallest one can fit
+    const uint64_t smallestWaitingBundleSizeBytes = m_smallestWaitingBundleSizeBytes.load(std::memory_order_seq_cst);
+    if ((numBundles < m_halfOfMaxBundlesInPipeline)
+        && (numBytes <= m_halfOfMaxBytesInPipeline)
+        && (smallestWaitingBundleSizeBytes <= (m_halfOfMaxBytesInPipeline - numBytes)))
+    {
+        m_numWakeups.fetch_add(1, std::memory_order_relaxed);
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_conditionVariable.notify_all();
+    }
+}
+
+bool BundlePipelineAckingSet::CompareAndPop_ThreadSafe(const uint64_t uniqueId, const bool isEgress) {
+    pipeline_t& pipeline = (isEgress) ? m_egressPipeline : m_storagePipeline;
+    for (uint64_t i = uniqueId, numProbes = 0; numProbes <= pipeline.slotsMask; ++i, ++numProbes) {
+        slot_t& slot = pipeline.slots[i & pipeline.slotsMask];
+        uint64_t key = slot.key.load(std::memory_order_acquire);
+        if (key == EMPTY_KEY) {
+            return false;
+        }
+        else if (key == uniqueId) {
+            const uint64_t bundleSizeBytes = slot.bundleSizeBytes;
+            if (!slot.key.compare_exchange_strong(key, DELETED_KEY, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                return false; //already popped by another thread
+            }
+            Release(pipeline, bundleSizeBytes);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BundlePipelineAckingSet::TryReserveEither(const bool checkEgressPipeline, const bool checkStoragePipeline,
+    const uint64_t uniqueId, const uint64_t bundleSizeBytes,
+    bool& reservedEgressPipelineAvailability, bool& reservedStoragePipelineAvailability)
+{
+    //egress gets first priority, storage gets second priority
+    if (checkEgressPipeline && TryReserve(m_egressPipeline, uniqueId, bundleSizeBytes)) {
+        reservedEgressPipelineAvailability = true;
+        return true;
+    }
+    if (checkStoragePipeline && TryReserve(m_storagePipeline, uniqueId, bundleSizeBytes)) {
+        reservedStoragePipelineAvailability = true;
+        return true;
+    }
+    return false;
+}
+
+//make sure at least one of [checkEgressPipeline, checkStoragePipeline] are true, otherwise a timeout will occur followed by a return false
+//return true if either the egress or storage got reserved, false if timeout
+bool BundlePipelineAckingSet::WaitForPipelineAvailabilityAndReserve(const bool checkEgressPipeline, const bool checkStoragePipeline,
+    const boost::posix_time::time_duration& timeoutDuration, const uint64_t uniqueId, const uint64_t bundleSizeBytes,
+    bool& reservedEgressPipelineAvailability, bool& reservedStoragePipelineAvailability)
+{
+    reservedEgressPipelineAvailability = false;
+    reservedStoragePipelineAvailability = false;
+    if (TryReserveEither(checkEgressPipeline, checkStoragePipeline, uniqueId, bundleSizeBytes,
+        reservedEgressPipelineAvailability, reservedStoragePipelineAvailability))
+    {
+        return true; //fast path, no lock
+    }
+
+    const boost::posix_time::ptime timeoutExpiry(boost::posix_time::microsec_clock::universal_time() + timeoutDuration);
+    boost::mutex::scoped_lock lock(m_mutex);
+    //publish the size before the waiter count so that a releaser seeing the count also sees a size no larger than this one
+    uint64_t smallest = m_smallestWaitingBundleSizeBytes.load(std::memory_order_relaxed);
+    while ((bundleSizeBytes < smallest) && (!m_smallestWaitingBundleSizeBytes.compare_exchange_weak(smallest, bundleSizeBytes, std::memory_order_seq_cst))) {}
+    m_numWaiters.fetch_add(1, std::memory_order_seq_cst);
+    bool reserved;
+    //timed_wait Returns: false if the call is returning because the time specified by abs_time was reached, true otherwise. (false=>timeout)
+    //wait while (queueIsFull AND hasNotTimedOutYet)
+    while (true) {
+        reserved = TryReserveEither(checkEgressPipeline, checkStoragePipeline, uniqueId, bundleSizeBytes,
+            reservedEgressPipelineAvailability, reservedStoragePipelineAvailability);
+        if (reserved || (!m_conditionVariable.timed_wait(lock, timeoutExpiry))) {
+            break;
+        }
+    }
+    if ((!reserved) && TryReserveEither(checkEgressPipeline, checkStoragePipeline, uniqueId, bundleSizeBytes,
+        reservedEgressPipelineAvailability, reservedStoragePipelineAvailability))
+    {
+        reserved = true; //credit released right at the timeout
+    }
+    if (m_numWaiters.fetch_sub(1, std::memory_order_seq_cst) == 1) {
+        m_smallestWaitingBundleSizeBytes.store(UINT64_MAX, std::memory_order_seq_cst); //under the mutex, so no new waiter has published yet
+    }
+    return reserved;
+}
+
+bool BundlePipelineAckingSet::WaitForStoragePipelineAvailabilityAndReserve(const boost::posix_time::time_duration& timeoutDuration,
+    const uint64_t uniqueId, const uint64_t bundleSizeBytes)
+{
+    bool dontCare1, dontCare2;
+    return WaitForPipelineAvailabilityAndReserve(false, true,
+        timeoutDuration, uniqueId, bundleSizeBytes,
+        dontCare1, dontCare2);
+}
+
+uint64_t BundlePipelineAckingSet::GetNextHopNodeId() const {
+    return m_nextHopNodeId;
+}
+
+uint64_t BundlePipelineAckingSet::GetNumBundlesInPipeline(const bool isEgress) const {
+    return ((isEgress) ? m_egressPipeline : m_storagePipeline).numBundles.load(std::memory_order_relaxed);
+}
+
+uint64_t BundlePipelineAckingSet::GetNumBytesInPipeline(const bool isEgress) const {
+    return ((isEgress) ? m_egressPipeline : m_storagePipeline).numBytes.load(std::memory_order_relaxed);
+}
+
+uint64_t BundlePipelineAckingSet::GetNumWakeups() const {
+    return m_numWakeups.load(std::memory_order_relaxed);
+}
+
+}  // namespace hdtn
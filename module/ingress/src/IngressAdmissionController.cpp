@@ -0,0 +1,84 @@
+/**
+ * @file IngressAdmissionController.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include "IngressAdmissionController.h"
+
+namespace hdtn {
+
+IngressAdmissionController::IngressAdmissionController(const uint64_t storageFullPercent, const uint64_t maxBundlesPerSecondPerSource) :
+    M_STORAGE_FULL_PERCENT(storageFullPercent),
+    M_MAX_BUNDLES_PER_SECOND_PER_SOURCE(maxBundlesPerSecondPerSource),
+    m_storageUsedPercent(0),
+    m_numBundlesDropped(0),
+    m_numBytesDropped(0),
+    m_sourceRateWindowSeconds(0) {}
+
+IngressAdmissionController::~IngressAdmissionController() {}
+
+IngressAdmissionController::DECISION IngressAdmissionController::Admit(const uint64_t sourceNodeId, const uint8_t priority, const bool isExpired,
+    const uint64_t bundleSizeBytes, const uint64_t nowSeconds)
+{
+    if (isExpired) {
+        RecordEarlyDrop(bundleSizeBytes);
+        return DECISION::DROP;
+    }
+    const bool exceedsSourceRate = ExceedsSourceRate(sourceNodeId, nowSeconds); //count every bundle, including expedited ones
+    if (priority >= EXPEDITED_PRIORITY) {
+        return DECISION::ADMIT;
+    }
+    if ((priority == 0) || exceedsSourceRate) {
+        return DECISION::ADMIT_WITHOUT_WAITING;
+    }
+    return DECISION::ADMIT;
+}
+
+bool IngressAdmissionController::RefuseStorage(const uint8_t priority, const uint64_t bundleSizeBytes) {
+    if ((priority >= EXPEDITED_PRIORITY) || (m_storageUsedPercent.load(std::memory_order_relaxed) < M_STORAGE_FULL_PERCENT)) {
+        return false;
+    }
+    RecordEarlyDrop(bundleSizeBytes);
+    return true;
+}
+
+void IngressAdmissionController::RecordEarlyDrop(const uint64_t bundleSizeBytes) noexcept {
+    m_numBundlesDropped.fetch_add(1, std::memory_order_relaxed);
+    m_numBytesDropped.fetch_add(bundleSizeBytes, std::memory_order_relaxed);
+}
+
+bool IngressAdmissionController::ExceedsSourceRate(const uint64_t sourceNodeId, const uint64_t nowSeconds) {
+    if (M_MAX_BUNDLES_PER_SECOND_PER_SOURCE == 0) {
+        return false;
+    }
+    boost::mutex::scoped_lock lock(m_sourceRateMutex);
+    if (nowSeconds != m_sourceRateWindowSeconds) { //new one second window (the map only holds the sources active in this window)
+        m_sourceRateWindowSeconds = nowSeconds;
+        m_sourceNodeIdToNumBundlesInWindowMap.clear();
+    }
+    uint64_t& numBundlesInWindow = m_sourceNodeIdToNumBundlesInWindowMap[sourceNodeId];
+    ++numBundlesInWindow;
+    return (numBundlesInWindow > M_MAX_BUNDLES_PER_SECOND_PER_SOURCE);
+}
+
+void IngressAdmissionController::SetStorageUsedPercent(const uint8_t storageUsedPercent) noexcept {
+    m_storageUsedPercent.store(storageUsedPercent, std::memory_order_relaxed);
+}
+
+uint8_t IngressAdmissionController::GetStorageUsedPercent() const noexcept {
+    return m_storageUsedPercent.load(std::memory_order_relaxed);
+}
+
+uint64_t IngressAdmissionController::GetNumBundlesDropped() const noexcept {
+    return m_numBundlesDropped.load(std::memory_order_relaxed);
+}
+
+uint64_t IngressAdmissionController::GetNumBytesDropped() const noexcept {
+    return m_numBytesDropped.load(std::memory_order_relaxed);
+}
+
+}  // namespace hdtn
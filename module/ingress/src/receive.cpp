@@ -21,6 +21,9 @@
 #include "codec/bpv6.h"
 #include "Logger.h"
 #include "message.hpp"
+#include "ZmqBatchMessage.h"
+#include "InprocChannels.hpp"
+#include "BundlePipelineAckingSet.h"
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
 #include "InductManager.h"
@@ -38,11 +41,13 @@
 #include "TcpclV4Induct.h"
 #include "StcpInduct.h"
 #include "SlipOverUartInduct.h"
-#include "FreeListAllocator.h"
 #include "TelemetryDefinitions.h"
 #include "ThreadNamer.h"
+#include "PaddedBufferPool.h"
+#include "SharedMemoryBundleTransport.h"
+#include "IngressAdmissionController.h"
+#include "TimestampUtil.h"
 #include "TelemetryServer.h"
-#include <unordered_map>
 #include <atomic>
 #if (__cplusplus >= 201703L)
 #include <shared_mutex>
@@ -62,6 +67,7 @@ namespace hdtn {
 static constexpr hdtn::Logger::SubProcess subprocess = hdtn::Logger::SubProcess::ingress;
 static constexpr uint64_t STORAGE_MAX_BUNDLES_IN_PIPELINE = 5;//"zmq-path-to-storage" up to zmqMaxMessageSizeBytes or 5 bundles,
 static constexpr uint64_t MY_PING_SERVICE_ID = 1;
+static constexpr uint32_t INGRESS_WORKER_QUEUE_CAPACITY = 32; //per worker thread, in whole bundles
 
 struct Ingress::Impl : private boost::noncopyable {
 
@@ -70,10 +76,12 @@ struct Ingress::Impl : private boost::noncopyable {
     void Stop();
     bool Stopped() noexcept;
     bool Init(const HdtnConfig& hdtnConfig, const boost::filesystem::path& bpSecConfigFilePath,
-           const HdtnDistributedConfig& hdtnDistributedConfig, zmq::context_t* hdtnOneProcessZmqInprocContextPtr, const std::string& maskerImpl);
+           const HdtnDistributedConfig& hdtnDistributedConfig, zmq::context_t* hdtnOneProcessZmqInprocContextPtr, const std::string& maskerImpl,
+           ToEgressInprocChannel* hdtnOneProcessToEgressInprocChannelPtr, DirectOutductForwarder* hdtnOneProcessDirectOutductForwarderPtr);
 
 private:
     void ReadZmqAcksThreadFunc();
+    void OnDirectForwardSuccessfulSend(const hdtn::EgressAckHdr& egressAckHdr);
     void ZmqTelemThreadFunc();
     void RouterEventHandler();
     bool ProcessPaddedData(uint8_t* bundleDataBegin, std::size_t bundleCurrentSize,
@@ -81,9 +89,26 @@ private:
         const bool usingZmqData, const bool needsProcessing, const bool isSafeToYieldThisThread);
     void ReadTcpclOpportunisticBundlesFromEgressThreadFunc();
     void WholeBundleReadyCallback(padded_vector_uint8_t& wholeBundleVec);
+    void IngressWorkerThreadFunc(const unsigned int workerIndex);
     void OnNewOpportunisticLinkCallback(const uint64_t remoteNodeId, Induct* thisInductPtr, void* sinkPtr);
     void OnDeletedOpportunisticLinkCallback(const uint64_t remoteNodeId, Induct* thisInductPtr, void* sinkPtrAboutToBeDeleted);
     void SendOpportunisticLinkMessages(const uint64_t remoteNodeId, bool isAvailable);
+    bool SendToEgress(const hdtn::ToEgressHdr& toEgressHdr, zmq::message_t* zmqMessageBundlePtr,
+        BundlePipelineAckingSet* ackingSetToRestorePtr = NULL);
+    template <typename ToHdrType>
+    struct PendingBatch;
+    template <typename ToHdrType>
+    void AppendToBatch_NotThreadSafe(PendingBatch<ToHdrType>& batch, const ToHdrType& toHdr, const uint64_t ingressUniqueId,
+        zmq::message_t&& zmqMessageBundle, BundlePipelineAckingSet& ackingSetToRestore);
+    template <typename ToHdrType>
+    void FlushBatch_NotThreadSafe(PendingBatch<ToHdrType>& batch, zmq::socket_t& socket, const uint16_t batchMessageType,
+        const bool isEgress, uint64_t& bundleCount, uint64_t& bundleByteCount, PendingBatch<ToHdrType>* unsentBatchPtr);
+    bool SendBundlePart(zmq::socket_t& socket, zmq::message_t& zmqMessageBundle);
+    void FlushEgressBatch_NotThreadSafe(PendingBatch<hdtn::ToEgressHdr>& unsentEgressBatch);
+    void SendUnsentEgressBatchToStorage(PendingBatch<hdtn::ToEgressHdr>& unsentEgressBatch);
+    void FlushStorageBatch_NotThreadSafe();
+    void FlushAllBatches();
+    void BatchFlusherThreadFunc();
     void SendPing(const uint64_t remoteNodeId, const uint64_t remotePingServiceNumber, const uint64_t bpVersion);
     void ProcessReceivedPingPayload(const uint8_t* data, const uint64_t size, const uint64_t bpVersion);
 
@@ -97,43 +122,45 @@ public:
 #endif
 
 private:
-    struct BundlePipelineAckingSet : private boost::noncopyable {
-        BundlePipelineAckingSet() = delete; //vector resize() not possible, must use reserve()
-        BundlePipelineAckingSet(const uint64_t paramMaxBundlesInPipeline,
-            const uint64_t paramMaxBundleSizeBytesInPipeline, const uint64_t paramNextHopNodeId, bool paramLinkIsUp);
-        void Update(const uint64_t paramMaxBundlesInPipeline,
-            const uint64_t paramMaxBundleSizeBytesInPipeline, const uint64_t paramNextHopNodeId, bool paramLinkIsUp);
-
-        bool CompareAndPop_ThreadSafe(const uint64_t uniqueId, const bool isEgress);
-
-        bool WaitForPipelineAvailabilityAndReserve(const bool checkEgressPipeline, const bool checkStoragePipeline,
-            const boost::posix_time::time_duration& timeoutDuration, const uint64_t uniqueId, const uint64_t bundleSizeBytes,
-            bool& reservedEgressPipelineAvailability, bool& reservedStoragePipelineAvailability);
-        bool WaitForStoragePipelineAvailabilityAndReserve(const boost::posix_time::time_duration& timeoutDuration,
-            const uint64_t uniqueId, const uint64_t bundleSizeBytes);
-        void NotifyAll();
-        uint64_t GetNextHopNodeId() const;
-    private:
-        
-        boost::mutex m_mutex;
-        boost::condition_variable m_conditionVariable;
-        typedef std::unordered_map<uint64_t, uint64_t,
-            std::hash<uint64_t>,
-            std::equal_to<uint64_t>,
-            FreeListAllocatorDynamic<std::pair<const uint64_t, uint64_t> > > umap_64_to_64_t;
-        umap_64_to_64_t m_mapEgressBundleUniqueIdToBundleSizeBytes;
-        umap_64_to_64_t m_mapStorageBundleUniqueIdToBundleSizeBytes;
-        uint64_t m_egressBytesInPipeline;
-        uint64_t m_storageBytesInPipeline;
-
-        uint64_t m_maxBundlesInPipeline;
-        uint64_t m_maxBundleSizeBytesInPipeline;
-        uint64_t m_nextHopNodeId;
-    public:
-        bool m_linkIsUp;
-    };
     typedef std::unique_ptr<BundlePipelineAckingSet> BundlePipelineAckingSetPtr;
 
+    //optional (numIngressWorkerThreads > 0) pool of threads that run ProcessPaddedData for bundles received by the inducts.
+    //Bundles are sharded by final destination eid so that bundles to the same destination are processed in order by one worker.
+    struct IngressWorker : private boost::noncopyable {
+        IngressWorker() : m_bundleQueue(INGRESS_WORKER_QUEUE_CAPACITY), m_totalBundlesProcessed(0) {}
+        InprocMessageChannel<padded_vector_uint8_t> m_bundleQueue; //induct threads (multiple producers) to this worker
+        std::unique_ptr<boost::thread> m_threadPtr;
+        uint64_t m_totalBundlesProcessed; //only read after the thread is joined
+    };
+    typedef std::unique_ptr<IngressWorker> IngressWorkerPtr;
+    std::vector<IngressWorkerPtr> m_ingressWorkers; //empty => bundles are processed on the induct threads
+
+    //optional (maxIngressBatchBundles > 1) batching of bundles into one multipart zmq message
+    //(header of the batch type, then all the per-bundle headers in one part, then one part per bundle).
+    //A batch is sent when it is full, when its oldest bundle has waited ingressBatchLatencyMicroseconds,
+    //or just before an induct thread would block on a full pipeline (since the acks it waits on may need the batch sent first).
+    //An egress batch that zmq cannot accept goes to storage instead, the same as a failed per-bundle send to egress.
+    template <typename ToHdrType>
+    struct PendingBatch {
+        struct RestoreInfo {
+            BundlePipelineAckingSet* ackingSetPtr; //only used to restore state if zmq fails
+            uint64_t ingressUniqueId;
+            uint64_t bundleSizeBytes;
+        };
+        PendingBatch() : m_totalBatchesSent(0) {}
+        std::vector<ToHdrType> m_headers;
+        std::vector<zmq::message_t> m_bundles;
+        std::vector<RestoreInfo> m_restoreInfos;
+        uint64_t m_totalBatchesSent;
+    };
+    PendingBatch<hdtn::ToEgressHdr> m_pendingEgressBatch; //protected by m_ingressToEgressZmqSocketMutex (distributed mode only)
+    PendingBatch<hdtn::ToStorageHdr> m_pendingStorageBatch; //protected by m_ingressToStorageZmqSocketMutex
+    bool m_batchingEnabled;
+    std::unique_ptr<boost::thread> m_threadBatchFlusherPtr;
+    boost::mutex m_batchFlusherMutex;
+    boost::condition_variable m_batchFlusherConditionVariable;
+    bool m_batchFlusherHasPendingBatch; //protected by m_batchFlusherMutex
+
     std::unique_ptr<zmq::context_t> m_zmqCtxPtr;
     std::unique_ptr<zmq::socket_t> m_zmqPushSock_boundIngressToConnectingEgressPtr;
     std::unique_ptr<zmq::socket_t> m_zmqPullSock_connectingEgressToBoundIngressPtr;
@@ -144,6 +171,14 @@ private:
 
     std::unique_ptr<zmq::socket_t> m_zmqRepSock_connectingTelemToFromBoundIngressPtr;
 
+    //distributed mode with sharedMemoryBundleTransport only: bundles to egress and storage go through shared memory (NULL otherwise)
+    std::unique_ptr<SharedMemoryBundleWriter> m_sharedMemoryBundleWriterPtr;
+
+    //hdtn-one-process only: replaces m_zmqPushSock_boundIngressToConnectingEgressPtr (NULL otherwise)
+    ToEgressInprocChannel* m_toEgressInprocChannelPtr;
+    //hdtn-one-process with oneProcessDirectOutductForward only: gives cut-through bundles straight to the outducts (NULL otherwise)
+    DirectOutductForwarder* m_directOutductForwarderPtr;
+
     //std::shared_ptr<zmq::context_t> m_zmqTelemCtx;
     //std::shared_ptr<zmq::socket_t> m_zmqTelemSock;
 
@@ -155,6 +190,7 @@ private:
     cbhe_eid_t M_HDTN_EID_PING;
     cbhe_eid_t M_HDTN_EID_TO_ROUTER_BUNDLES;
     boost::posix_time::time_duration M_MAX_INGRESS_BUNDLE_WAIT_ON_EGRESS_TIME_DURATION;
+    std::unique_ptr<IngressAdmissionController> m_admissionControllerPtr; //NULL unless ingressAdmissionControl
 
     std::unique_ptr<boost::thread> m_threadZmqAckReaderPtr;
     std::unique_ptr<boost::thread> m_threadZmqTelemPtr;
@@ -218,110 +254,15 @@ private:
 #endif
 };
 
-Ingress::Impl::BundlePipelineAckingSet::BundlePipelineAckingSet(const uint64_t paramMaxBundlesInPipeline,
-    const uint64_t paramMaxBundleSizeBytesInPipeline, const uint64_t paramNextHopNodeId, bool paramLinkIsUp) :
-    m_egressBytesInPipeline(0),
-    m_storageBytesInPipeline(0)
-{
-    Update(paramMaxBundlesInPipeline, paramMaxBundleSizeBytesInPipeline, paramNextHopNodeId, paramLinkIsUp);
-}
-void Ingress::Impl::BundlePipelineAckingSet::Update(const uint64_t paramMaxBundlesInPipeline,
-    const uint64_t paramMaxBundleSizeBytesInPipeline, const uint64_t paramNextHopNodeId, bool paramLinkIsUp)
-{
-    m_maxBundlesInPipeline = paramMaxBundlesInPipeline;
-    m_maxBundleSizeBytesInPipeline = paramMaxBundleSizeBytesInPipeline;
-    m_nextHopNodeId = paramNextHopNodeId;
-    m_linkIsUp = paramLinkIsUp;
-    //By default, unordered_set containers have a max_load_factor of 1.0.
-    m_mapEgressBundleUniqueIdToBundleSizeBytes.reserve(m_maxBundlesInPipeline); //maxBundlesInPipeline is double of half
-    m_mapEgressBundleUniqueIdToBundleSizeBytes.get_allocator().SetMaxListSizeFromGetAllocatorCopy(m_maxBundlesInPipeline + 2);
-
-    m_mapStorageBundleUniqueIdToBundleSizeBytes.reserve(m_maxBundlesInPipeline);
-    m_mapStorageBundleUniqueIdToBundleSizeBytes.get_allocator().SetMaxListSizeFromGetAllocatorCopy(m_maxBundlesInPipeline + 2);
-}
-
-bool Ingress::Impl::BundlePipelineAckingSet::CompareAndPop_ThreadSafe(const uint64_t uniqueId, const bool isEgress) {
-    
-    uint64_t& bytesInPipelineRef = (isEgress) ? m_egressBytesInPipeline : m_storageBytesInPipeline;
-    umap_64_to_64_t& mapBundleUniqueIdToBundleSizeBytes = (isEgress) ?
-        m_mapEgressBundleUniqueIdToBundleSizeBytes : m_mapStorageBundleUniqueIdToBundleSizeBytes;
-
-    boost::mutex::scoped_lock lock(m_mutex);
-    umap_64_to_64_t::iterator it = mapBundleUniqueIdToBundleSizeBytes.find(uniqueId);
-    if (it == mapBundleUniqueIdToBundleSizeBytes.end()) {
-        return false;
-    }
-    const uint64_t bundleSizeBytes = it->second;
-    bytesInPipelineRef -= bundleSizeBytes;
-    mapBundleUniqueIdToBundleSizeBytes.erase(it);
-    return true;
-}
-
-//make sure at least one of [checkEgressPipeline, checkStoragePipeline] are true, otherwise a timeout will occur followed by a return false
-//return true if either the egress or storage got reserved, false if timeout
-bool Ingress::Impl::BundlePipelineAckingSet::WaitForPipelineAvailabilityAndReserve(const bool checkEgressPipeline, const bool checkStoragePipeline,
-    const boost::posix_time::time_duration & timeoutDuration, const uint64_t uniqueId, const uint64_t bundleSizeBytes,
-    bool & reservedEgressPipelineAvailability, bool& reservedStoragePipelineAvailability)
-{
-    reservedEgressPipelineAvailability = false;
-    reservedStoragePipelineAvailability = false;
-    const uint64_t halfOfMaxBundlesInPipeline = m_maxBundlesInPipeline >> 1;
-    const uint64_t halfOfMaxBytesInPipeline = m_maxBundleSizeBytesInPipeline >> 1;
-    const boost::posix_time::ptime timeoutExpiry(boost::posix_time::microsec_clock::universal_time() + timeoutDuration);
-    boost::mutex::scoped_lock lock(m_mutex);
-    //timed_wait Returns: false if the call is returning because the time specified by abs_time was reached, true otherwise. (false=>timeout)
-    //wait while (queueIsFull AND hasNotTimedOutYet)
-    while (
-        ((m_mapEgressBundleUniqueIdToBundleSizeBytes.size() >= (halfOfMaxBundlesInPipeline * checkEgressPipeline))
-        || ((m_egressBytesInPipeline + bundleSizeBytes) > (halfOfMaxBytesInPipeline * checkEgressPipeline)))
-        && 
-        ((m_mapStorageBundleUniqueIdToBundleSizeBytes.size() >= (halfOfMaxBundlesInPipeline * checkStoragePipeline))
-        || ((m_storageBytesInPipeline + bundleSizeBytes) > (halfOfMaxBytesInPipeline * checkStoragePipeline)))
-        &&
-        m_conditionVariable.timed_wait(lock, timeoutExpiry)) {
-    }//lock mutex (above) before checking condition
-
-    //egress gets first priority, storage gets second priority
-    if (checkEgressPipeline) {
-        reservedEgressPipelineAvailability = (m_mapEgressBundleUniqueIdToBundleSizeBytes.size() < halfOfMaxBundlesInPipeline)
-            && ((m_egressBytesInPipeline + bundleSizeBytes) <= halfOfMaxBytesInPipeline);
-        if (reservedEgressPipelineAvailability) {
-            m_mapEgressBundleUniqueIdToBundleSizeBytes.emplace(uniqueId, bundleSizeBytes);
-            m_egressBytesInPipeline += bundleSizeBytes;
-            return true;
-        }
-    }
-    if (checkStoragePipeline) {
-        reservedStoragePipelineAvailability = (m_mapStorageBundleUniqueIdToBundleSizeBytes.size() < halfOfMaxBundlesInPipeline)
-            && ((m_storageBytesInPipeline + bundleSizeBytes) <= halfOfMaxBytesInPipeline);
-        if (reservedStoragePipelineAvailability) {
-            m_mapStorageBundleUniqueIdToBundleSizeBytes.emplace(uniqueId, bundleSizeBytes);
-            m_storageBytesInPipeline += bundleSizeBytes;
-            return true;
-        }
-    }
-    return false;
-}
-bool Ingress::Impl::BundlePipelineAckingSet::WaitForStoragePipelineAvailabilityAndReserve(const boost::posix_time::time_duration& timeoutDuration,
-    const uint64_t uniqueId, const uint64_t bundleSizeBytes)
-{
-    bool dontCare1, dontCare2;
-    return WaitForPipelineAvailabilityAndReserve(false, true,
-        timeoutDuration, uniqueId, bundleSizeBytes,
-        dontCare1, dontCare2);
-}
-void Ingress::Impl::BundlePipelineAckingSet::NotifyAll() {
-    m_conditionVariable.notify_all();
-}
-uint64_t Ingress::Impl::BundlePipelineAckingSet::GetNextHopNodeId() const {
-    return m_nextHopNodeId;
-}
-
 Ingress::Impl::Impl() : 
     m_bundleCountStorage(0),
     m_bundleByteCountStorage(0),
     m_bundleCountEgress(0),
     m_bundleByteCountEgress(0),
+    m_batchingEnabled(false),
+    m_batchFlusherHasPendingBatch(false),
+    m_toEgressInprocChannelPtr(NULL),
+    m_directOutductForwarderPtr(NULL),
     m_singleStorageBundlePipelineAckingSet(10, 10, UINT64_MAX, false), //initial don't cares for a deleted default constructor, set later
     m_eventsTooManyInStorageCutThroughQueue(0),
     m_eventsTooManyInEgressCutThroughQueue(0),
@@ -361,6 +302,40 @@ void Ingress::Impl::Stop() {
 
     m_running = false; //thread stopping criteria
 
+    if (m_directOutductForwarderPtr) { //egress outlives ingress in hdtn-one-process; drop any late acks
+        m_directOutductForwarderPtr->SetOnSuccessfulSendFunction(DirectOutductForwarder::on_successful_send_function_t());
+    }
+
+    for (std::size_t i = 0; i < m_ingressWorkers.size(); ++i) {
+        IngressWorker& worker = *m_ingressWorkers[i];
+        if (worker.m_threadPtr) {
+            try {
+                worker.m_threadPtr->join();
+                worker.m_threadPtr.reset(); //delete it
+                LOG_INFO(subprocess) << "ingress worker thread " << i << " processed " << worker.m_totalBundlesProcessed << " bundles";
+            }
+            catch (boost::thread_resource_error& e) {
+                LOG_ERROR(subprocess) << "unable to stop ingress worker thread " << i << ": " << e.what();
+            }
+        }
+    }
+
+    if (m_threadBatchFlusherPtr) {
+        try {
+            m_batchFlusherConditionVariable.notify_one();
+            m_threadBatchFlusherPtr->join();
+            m_threadBatchFlusherPtr.reset(); //delete it
+        }
+        catch (boost::thread_resource_error& e) {
+            LOG_ERROR(subprocess) << "unable to stop ingress threadBatchFlusherPtr: " << e.what();
+        }
+    }
+    if (m_batchingEnabled) {
+        FlushAllBatches(); //no more bundles can be added since the inducts and workers are stopped
+        LOG_INFO(subprocess) << "ingress sent " << m_pendingEgressBatch.m_totalBatchesSent << " batches to egress and "
+            << m_pendingStorageBatch.m_totalBatchesSent << " batches to storage";
+    }
+
     if (m_threadZmqTelemPtr) {
         try {
             m_threadZmqTelemPtr->join();
@@ -403,11 +378,14 @@ bool Ingress::Impl::Stopped() noexcept {
 }
 
 bool Ingress::Init(const HdtnConfig& hdtnConfig, const boost::filesystem::path& bpSecConfigFilePath,
-		   const HdtnDistributedConfig& hdtnDistributedConfig, zmq::context_t* hdtnOneProcessZmqInprocContextPtr, const std::string& maskerImpl) {
-    return m_pimpl->Init(hdtnConfig, bpSecConfigFilePath, hdtnDistributedConfig, hdtnOneProcessZmqInprocContextPtr, maskerImpl);
+		   const HdtnDistributedConfig& hdtnDistributedConfig, zmq::context_t* hdtnOneProcessZmqInprocContextPtr, const std::string& maskerImpl,
+		   ToEgressInprocChannel* hdtnOneProcessToEgressInprocChannelPtr, DirectOutductForwarder* hdtnOneProcessDirectOutductForwarderPtr) {
+    return m_pimpl->Init(hdtnConfig, bpSecConfigFilePath, hdtnDistributedConfig, hdtnOneProcessZmqInprocContextPtr, maskerImpl, hdtnOneProcessToEgressInprocChannelPtr,
+        hdtnOneProcessDirectOutductForwarderPtr);
 }
 bool Ingress::Impl::Init(const HdtnConfig& hdtnConfig, const boost::filesystem::path& bpSecConfigFilePath,
-    const HdtnDistributedConfig& hdtnDistributedConfig, zmq::context_t * hdtnOneProcessZmqInprocContextPtr, const std::string& maskerImpl)
+    const HdtnDistributedConfig& hdtnDistributedConfig, zmq::context_t * hdtnOneProcessZmqInprocContextPtr, const std::string& maskerImpl,
+    ToEgressInprocChannel* hdtnOneProcessToEgressInprocChannelPtr, DirectOutductForwarder* hdtnOneProcessDirectOutductForwarderPtr)
 {
 #ifndef MASKING_ENABLED
     (void)maskerImpl; //parameter not used
@@ -418,6 +396,11 @@ bool Ingress::Impl::Init(const HdtnConfig& hdtnConfig, const boost::filesystem::
     }
 
     m_hdtnConfig = hdtnConfig;
+    m_toEgressInprocChannelPtr = (hdtnOneProcessZmqInprocContextPtr) ? hdtnOneProcessToEgressInprocChannelPtr : NULL;
+    m_directOutductForwarderPtr = (hdtnOneProcessZmqInprocContextPtr) ? hdtnOneProcessDirectOutductForwarderPtr : NULL;
+    if (m_directOutductForwarderPtr) {
+        m_directOutductForwarderPtr->SetOnSuccessfulSendFunction(boost::bind(&Ingress::Impl::OnDirectForwardSuccessfulSend, this, boost::placeholders::_1));
+    }
 
     if (!bpSecConfigFilePath.empty()) {
 #ifdef BPSEC_SUPPORT_ENABLED
@@ -451,6 +434,12 @@ bool Ingress::Impl::Init(const HdtnConfig& hdtnConfig, const boost::filesystem::
     M_HDTN_EID_TO_ROUTER_BUNDLES.Set(m_hdtnConfig.m_myNodeId, m_hdtnConfig.m_myRouterServiceId);
 
     M_MAX_INGRESS_BUNDLE_WAIT_ON_EGRESS_TIME_DURATION = boost::posix_time::milliseconds(m_hdtnConfig.m_maxIngressBundleWaitOnEgressMilliseconds);
+    if (m_hdtnConfig.m_ingressAdmissionControl) {
+        m_admissionControllerPtr = boost::make_unique<IngressAdmissionController>(m_hdtnConfig.m_ingressAdmissionStorageFullPercent,
+            m_hdtnConfig.m_ingressAdmissionMaxBundlesPerSecondPerSource);
+        LOG_INFO(subprocess) << "ingress admission control enabled (storage full at " << m_hdtnConfig.m_ingressAdmissionStorageFullPercent
+            << "%, max bundles per second per source " << m_hdtnConfig.m_ingressAdmissionMaxBundlesPerSecondPerSource << ")";
+    }
 
     m_zmqCtxPtr = boost::make_unique<zmq::context_t>(); //needed at least by router (and if one-process is not used)
     try {
@@ -489,6 +478,15 @@ bool Ingress::Impl::Init(const HdtnConfig& hdtnConfig, const boost::filesystem::
             const std::string bind_boundIngressToConnectingStoragePath(
                 std::string("tcp://*:") + boost::lexical_cast<std::string>(hdtnDistributedConfig.m_zmqBoundIngressToConnectingStoragePortPath));
             m_zmqPushSock_boundIngressToConnectingStoragePtr->bind(bind_boundIngressToConnectingStoragePath);
+            if (hdtnDistributedConfig.m_sharedMemoryBundleTransport) {
+                m_sharedMemoryBundleWriterPtr = boost::make_unique<SharedMemoryBundleWriter>(
+                    std::string("hdtn_ingress_") + boost::lexical_cast<std::string>(hdtnDistributedConfig.m_zmqBoundIngressToConnectingEgressPortPath),
+                    hdtnDistributedConfig.m_sharedMemoryNumSlots, hdtnDistributedConfig.m_sharedMemorySlotSizeBytes);
+                if (!m_sharedMemoryBundleWriterPtr->IsValid()) {
+                    LOG_WARNING(subprocess) << "cannot create the shared memory for bundles to egress and storage, sending them through zmq instead";
+                    m_sharedMemoryBundleWriterPtr.reset();
+                }
+            }
             // socket for receiving acks from storage
             m_zmqPullSock_connectingStorageToBoundIngressPtr = boost::make_unique<zmq::socket_t>(*m_zmqCtxPtr, zmq::socket_type::pull);
             const std::string bind_connectingStorageToBoundIngressPath(
@@ -561,8 +559,43 @@ bool Ingress::Impl::Init(const HdtnConfig& hdtnConfig, const boost::filesystem::
         return false;
     }
 
+    m_running = true;
+
+    if (m_hdtnConfig.m_numIngressWorkerThreads) { //start bundle processing worker threads before the inducts get loaded
+        m_ingressWorkers.clear();
+        for (uint64_t i = 0; i < m_hdtnConfig.m_numIngressWorkerThreads; ++i) {
+            m_ingressWorkers.emplace_back(boost::make_unique<IngressWorker>());
+            if (!m_ingressWorkers.back()->m_bundleQueue.IsValid()) {
+                LOG_WARNING(subprocess) << "ingress worker threads not supported on this platform, processing bundles on the induct threads";
+                m_ingressWorkers.clear();
+                break;
+            }
+        }
+        for (std::size_t i = 0; i < m_ingressWorkers.size(); ++i) {
+            m_ingressWorkers[i]->m_threadPtr = boost::make_unique<boost::thread>(
+                boost::bind(&Ingress::Impl::IngressWorkerThreadFunc, this, static_cast<unsigned int>(i)));
+        }
+        if (m_ingressWorkers.size()) {
+            LOG_INFO(subprocess) << m_ingressWorkers.size() << " ingress worker threads started";
+        }
+    }
+
+    m_batchingEnabled = (m_hdtnConfig.m_maxIngressBatchBundles > 1);
+    if (m_batchingEnabled) {
+        m_pendingEgressBatch.m_headers.reserve(m_hdtnConfig.m_maxIngressBatchBundles);
+        m_pendingEgressBatch.m_bundles.reserve(m_hdtnConfig.m_maxIngressBatchBundles);
+        m_pendingEgressBatch.m_restoreInfos.reserve(m_hdtnConfig.m_maxIngressBatchBundles);
+        m_pendingStorageBatch.m_headers.reserve(m_hdtnConfig.m_maxIngressBatchBundles);
+        m_pendingStorageBatch.m_bundles.reserve(m_hdtnConfig.m_maxIngressBatchBundles);
+        m_pendingStorageBatch.m_restoreInfos.reserve(m_hdtnConfig.m_maxIngressBatchBundles);
+        m_threadBatchFlusherPtr = boost::make_unique<boost::thread>(
+            boost::bind(&Ingress::Impl::BatchFlusherThreadFunc, this));
+        LOG_INFO(subprocess) << "ingress batching up to " << m_hdtnConfig.m_maxIngressBatchBundles << " bundles for at most "
+            << m_hdtnConfig.m_ingressBatchLatencyMicroseconds << " microseconds";
+    }
+
     { //start worker thread
-        m_running = true;
+        //m_running = true; //already true
         boost::mutex::scoped_lock workerThreadStartupLock(m_workerThreadStartupMutex);
         m_workerThreadStartupInProgress = true;
 
@@ -783,7 +816,6 @@ void Ingress::Impl::ReadZmqAcksThreadFunc() {
                         }
                     }
                     if (bundlePipelineAckingSetObj.CompareAndPop_ThreadSafe(receivedEgressAckHdr.custodyId, true)) { //true => isEgress
-                        bundlePipelineAckingSetObj.NotifyAll();
                         ++totalAcksFromEgress;
                     }
                     else {
@@ -827,10 +859,45 @@ void Ingress::Impl::ReadZmqAcksThreadFunc() {
                     LOG_ERROR(subprocess) << "StorageAckHdr message mismatch: untruncated = " << res->untruncated_size
                         << " truncated = " << res->size << " expected = " << sizeof(hdtn::StorageAckHdr);
                 }
+                else if (receivedStorageAck.base.type == HDTN_MSGTYPE_STORAGE_ACK_BATCH_TO_INGRESS) {
+                    if (m_admissionControllerPtr) {
+                        m_admissionControllerPtr->SetStorageUsedPercent(receivedStorageAck.storageUsedPercent);
+                    }
+                    zmq::message_t zmqMessageAckRanges;
+                    //message guaranteed to be there due to the zmq::send_flags::sndmore
+                    if (!m_zmqPullSock_connectingStorageToBoundIngressPtr->recv(zmqMessageAckRanges, zmq::recv_flags::none)) {
+                        LOG_ERROR(subprocess) << "error receiving batched storage ack";
+                    }
+                    else if ((zmqMessageAckRanges.size() % sizeof(hdtn::IngressUniqueIdAckRange)) != 0) {
+                        LOG_ERROR(subprocess) << "batched storage ack invalid size " << zmqMessageAckRanges.size();
+                    }
+                    else {
+                        ingress_shared_lock_t lockShared(m_sharedMutexFinalDestsToOutductArrayIndexMaps);
+                        const std::size_t numRanges = zmqMessageAckRanges.size() / sizeof(hdtn::IngressUniqueIdAckRange);
+                        const uint8_t* rangesPtr = static_cast<const uint8_t*>(zmqMessageAckRanges.data());
+                        for (std::size_t i = 0; i < numRanges; ++i) {
+                            hdtn::IngressUniqueIdAckRange range;
+                            memcpy(&range, rangesPtr + (i * sizeof(hdtn::IngressUniqueIdAckRange)), sizeof(hdtn::IngressUniqueIdAckRange)); //force alignment
+                            BundlePipelineAckingSet& bundlePipelineAckingSetObj = (range.outductIndex == UINT64_MAX) ?
+                                m_singleStorageBundlePipelineAckingSet : (*(m_vectorBundlePipelineAckingSet[range.outductIndex]));
+                            for (uint64_t j = 0; j < range.numIngressUniqueIds; ++j) {
+                                if (bundlePipelineAckingSetObj.CompareAndPop_ThreadSafe(range.firstIngressUniqueId + j, false)) { //false => is Storage
+                                    ++totalAcksFromStorage;
+                                }
+                                else {
+                                    LOG_ERROR(subprocess) << "batched storage ack with ingressUniqueId " << (range.firstIngressUniqueId + j) << " not found!";
+                                }
+                            }
+                        }
+                    }
+                }
                 else if (receivedStorageAck.base.type != HDTN_MSGTYPE_STORAGE_ACK_TO_INGRESS) {
                     LOG_ERROR(subprocess) << "message ack not HDTN_MSGTYPE_STORAGE_ACK_TO_INGRESS";
                 }
                 else {
+                    if (m_admissionControllerPtr) {
+                        m_admissionControllerPtr->SetStorageUsedPercent(receivedStorageAck.storageUsedPercent);
+                    }
                     ingress_shared_lock_t lockShared(m_sharedMutexFinalDestsToOutductArrayIndexMaps);
                     BundlePipelineAckingSet& bundlePipelineAckingSetObj = (receivedStorageAck.outductIndex == UINT64_MAX) ?
                         m_singleStorageBundlePipelineAckingSet : (*(m_vectorBundlePipelineAckingSet[receivedStorageAck.outductIndex]));
@@ -844,7 +911,6 @@ void Ingress::Impl::ReadZmqAcksThreadFunc() {
                         }
                     }
                     if (bundlePipelineAckingSetObj.CompareAndPop_ThreadSafe(receivedStorageAck.ingressUniqueId, false)) { //false => is Storage
-                        bundlePipelineAckingSetObj.NotifyAll();
                         ++totalAcksFromStorage;
                     }
                     else {
@@ -865,6 +931,13 @@ void Ingress::Impl::ReadZmqAcksThreadFunc() {
     LOG_INFO(subprocess) << "m_bundleCountEgress: " << m_bundleCountEgress;
     LOG_INFO(subprocess) << "m_bundleByteCountEgress: " << m_bundleByteCountEgress;
     LOG_INFO(subprocess) << "bundleCount: " << (m_bundleCountStorage + m_bundleCountEgress);
+    if (m_admissionControllerPtr) {
+        LOG_INFO(subprocess) << "bundles dropped by admission control: " << m_admissionControllerPtr->GetNumBundlesDropped();
+    }
+    if (m_sharedMemoryBundleWriterPtr) {
+        LOG_INFO(subprocess) << "bundles sent through shared memory: " << m_sharedMemoryBundleWriterPtr->GetNumBundlesSentThroughSharedMemory()
+            << ", inline: " << m_sharedMemoryBundleWriterPtr->GetNumBundlesSentInline();
+    }
     LOG_DEBUG(subprocess) << "ReadZmqAcksThreadFunc thread exiting";
 }
 
@@ -933,6 +1006,14 @@ void Ingress::Impl::ZmqTelemThreadFunc() {
                 allInductTelem.m_bundleCountStorage = m_bundleCountStorage;
                 allInductTelem.m_bundleByteCountStorage = m_bundleByteCountStorage;
                 m_ingressToStorageZmqSocketMutex.unlock();
+                const PaddedBufferPool& bufferPool = PaddedBufferPool::GetGlobalInstance();
+                allInductTelem.m_bufferPoolNumAllocations = bufferPool.GetNumAllocations();
+                allInductTelem.m_bufferPoolNumHits = bufferPool.GetNumPoolHits();
+                allInductTelem.m_bufferPoolNumBytesCached = bufferPool.GetNumBytesCached();
+                if (m_admissionControllerPtr) {
+                    allInductTelem.m_admissionControlNumBundlesDropped = m_admissionControllerPtr->GetNumBundlesDropped();
+                    allInductTelem.m_admissionControlNumBytesDropped = m_admissionControllerPtr->GetNumBytesDropped();
+                }
 
                 bool more = false;
                 do {
@@ -1123,6 +1204,11 @@ bool Ingress::Impl::ProcessPaddedData(uint8_t * bundleDataBegin, std::size_t bun
     bool isAdminRecordForHdtnStorage = false;
     bool isBundleForHdtnRouter = false;
     bool canBeFragmented = false;
+    //for admission control of the bundles received on the inducts
+    uint64_t sourceNodeId = 0;
+    uint8_t priority = IngressAdmissionController::EXPEDITED_PRIORITY;
+    bool isExpired = false;
+    uint64_t nowMilliseconds = 0;
     const uint8_t firstByte = bundleDataBegin[0];
     const bool isBpVersion6 = (firstByte == 6);
     const bool isBpVersion7 = (firstByte == ((4U << 5) | 31U));  //CBOR major type 4, additional information 31 (Indefinite-Length Array)
@@ -1146,6 +1232,12 @@ bool Ingress::Impl::ProcessPaddedData(uint8_t * bundleDataBegin, std::size_t bun
             isAdminRecordForHdtnStorage = (((primary.m_bundleProcessingControlFlags & requiredPrimaryFlagsForAdminRecord) == requiredPrimaryFlagsForAdminRecord) && (finalDestEid == M_HDTN_EID_CUSTODY));
             isBundleForHdtnRouter = (finalDestEid == M_HDTN_EID_TO_ROUTER_BUNDLES);
             canBeFragmented = !primary.HasFlagSet(BPV6_BUNDLEFLAG::NOFRAGMENT);
+            if (m_admissionControllerPtr) {
+                nowMilliseconds = TimestampUtil::GetMillisecondsSinceEpochRfc5050();
+                sourceNodeId = primary.m_sourceNodeId.nodeId;
+                priority = primary.GetPriority();
+                isExpired = (primary.m_creationTimestamp.secondsSinceStartOfYear2000 != 0) && (primary.GetExpirationMilliseconds() <= nowMilliseconds);
+            }
             static const BPV6_BUNDLEFLAG requiredPrimaryFlagsForEcho = BPV6_BUNDLEFLAG::NO_FLAGS_SET;
             //BPV6_BUNDLEFLAG::SINGLETON | BPV6_BUNDLEFLAG::NOFRAGMENT;
             const bool isEcho = (((primary.m_bundleProcessingControlFlags & requiredPrimaryFlagsForEcho) == requiredPrimaryFlagsForEcho) && (finalDestEid == M_HDTN_EID_ECHO));
@@ -1216,6 +1308,13 @@ bool Ingress::Impl::ProcessPaddedData(uint8_t * bundleDataBegin, std::size_t bun
                 ProcessReceivedPingPayload(payloadBlock.m_dataPtr, payloadBlock.m_dataLength, 7);
                 return true;
             }
+            if (m_admissionControllerPtr) {
+                nowMilliseconds = TimestampUtil::GetMillisecondsSinceEpochRfc5050();
+                sourceNodeId = primary.m_sourceNodeId.nodeId;
+                priority = primary.GetPriority();
+                //a creation time of 0 means the source has no accurate clock, so its expiration is unknown
+                isExpired = (primary.m_creationTimestamp.millisecondsSinceStartOfYear2000 != 0) && (primary.GetExpirationMilliseconds() <= nowMilliseconds);
+            }
             //admin records pertaining to this hdtn node must go to storage.. they signal a deletion from disk
             static constexpr BPV7_BUNDLEFLAG requiredPrimaryFlagsForAdminRecord = BPV7_BUNDLEFLAG::ADMINRECORD;
             isAdminRecordForHdtnStorage = (((primary.m_bundleProcessingControlFlags & requiredPrimaryFlagsForAdminRecord) == requiredPrimaryFlagsForAdminRecord) && (finalDestEid == M_HDTN_EID_CUSTODY));
@@ -1340,27 +1439,28 @@ bool Ingress::Impl::ProcessPaddedData(uint8_t * bundleDataBegin, std::size_t bun
 
 
     if (isBundleForHdtnRouter) { //forward to egress which will forward to router
-        //force natural/64-bit alignment
-        hdtn::ToEgressHdr* toEgressHdr = new hdtn::ToEgressHdr();
-        zmq::message_t zmqMessageToEgressHdrWithDataStolen(toEgressHdr, sizeof(hdtn::ToEgressHdr), CustomCleanupToEgressHdr, toEgressHdr);
-        toEgressHdr->base.type = HDTN_MSGTYPE_BUNDLES_TO_ROUTER;
-        {
-            boost::mutex::scoped_lock lock(m_ingressToEgressZmqSocketMutex);
-            if (!m_zmqPushSock_boundIngressToConnectingEgressPtr->send(std::move(zmqMessageToEgressHdrWithDataStolen), zmq::send_flags::sndmore | zmq::send_flags::dontwait)) {
-                LOG_ERROR(subprocess) << "can't send toEgressHdr to egress";
-            }
-            else {
-                if (!m_zmqPushSock_boundIngressToConnectingEgressPtr->send(std::move(*zmqMessageToSendUniquePtr), zmq::send_flags::dontwait)) {
-                    LOG_ERROR(subprocess) << "can't send bundle intended for router to egress";
-                }
-                else { //success
-                    ++m_bundleCountEgress; //protected by m_ingressToEgressZmqSocketMutex
-                    m_bundleByteCountEgress += bundleCurrentSize; //protected by m_ingressToEgressZmqSocketMutex
-                }
-            }
+        hdtn::ToEgressHdr toEgressHdr = hdtn::ToEgressHdr();
+        toEgressHdr.base.type = HDTN_MSGTYPE_BUNDLES_TO_ROUTER;
+        if (!SendToEgress(toEgressHdr, zmqMessageToSendUniquePtr.get())) {
+            LOG_ERROR(subprocess) << "can't send bundle intended for router to egress";
         }
         return true;
     }
+
+    //admission control of the bundles received on the inducts (see IngressAdmissionController)
+    bool mayWaitForPipelines = true; //false => this bundle is dropped rather than blocking its induct if the pipelines are full
+    if (m_admissionControllerPtr && needsProcessing) {
+        if (isAdminRecordForHdtnStorage) { //custody signals free storage, never drop them
+            priority = IngressAdmissionController::EXPEDITED_PRIORITY;
+        }
+        const IngressAdmissionController::DECISION decision = m_admissionControllerPtr->Admit(sourceNodeId, priority, isExpired,
+            bundleCurrentSize, nowMilliseconds / 1000);
+        if (decision == IngressAdmissionController::DECISION::DROP) {
+            LOG_DEBUG(subprocess) << "admission control dropping an expired bundle from ipn:" << sourceNodeId << ".*";
+            return false;
+        }
+        mayWaitForPipelines = (decision == IngressAdmissionController::DECISION::ADMIT);
+    }
     /*
     Config file changes:
     remove: zmqMaxMessagesPerPath, zmqMaxMessageSizeBytes, zmqRegistrationServerAddress, and zmqRegistrationServerPortPath from hdtn global configs
@@ -1517,9 +1617,15 @@ bool Ingress::Impl::ProcessPaddedData(uint8_t * bundleDataBegin, std::size_t bun
                     static const boost::posix_time::time_duration noDuration = boost::posix_time::seconds(0);
                     const boost::posix_time::time_duration& cutThroughTimeoutRef = (m_hdtnConfig.m_bufferRxToStorageOnLinkUpSaturation)
                         ? noDuration : M_MAX_INGRESS_BUNDLE_WAIT_ON_EGRESS_TIME_DURATION;
-                    const bool foundACutThroughPath = bundleCutThroughPipelineAckingSetObj.WaitForPipelineAvailabilityAndReserve(shouldCheckEgress, true,
-                        cutThroughTimeoutRef, fromIngressUniqueId, zmqMessageToSendUniquePtr->size(),
+                    bool foundACutThroughPath = bundleCutThroughPipelineAckingSetObj.WaitForPipelineAvailabilityAndReserve(shouldCheckEgress, true,
+                        (m_batchingEnabled || (!mayWaitForPipelines)) ? noDuration : cutThroughTimeoutRef, fromIngressUniqueId, zmqMessageToSendUniquePtr->size(),
                         reservedEgressPipelineAvailability, reservedStorageCutThroughPipelineAvailability);
+                    if ((!foundACutThroughPath) && m_batchingEnabled && mayWaitForPipelines && (cutThroughTimeoutRef != noDuration)) {
+                        FlushAllBatches(); //the acks needed to free the pipeline may be for bundles still in a pending batch
+                        foundACutThroughPath = bundleCutThroughPipelineAckingSetObj.WaitForPipelineAvailabilityAndReserve(shouldCheckEgress, true,
+                            cutThroughTimeoutRef, fromIngressUniqueId, zmqMessageToSendUniquePtr->size(),
+                            reservedEgressPipelineAvailability, reservedStorageCutThroughPipelineAvailability);
+                    }
                     if (foundACutThroughPath) {
                         if (reservedStorageCutThroughPipelineAvailability) { //pipeline limit exceeded for egress cut-through path
                             useStorage = true;
@@ -1529,40 +1635,26 @@ bool Ingress::Impl::ProcessPaddedData(uint8_t * bundleDataBegin, std::size_t bun
                         }
                         else { //if(reservedEgressPipelineAvailability) //pipeline limits not exceeded for egress cut-through path, continue to send the bundle to egress
 
-                            //force natural/64-bit alignment
-                            hdtn::ToEgressHdr* toEgressHdr = new hdtn::ToEgressHdr();
-                            zmq::message_t zmqMessageToEgressHdrWithDataStolen(toEgressHdr, sizeof(hdtn::ToEgressHdr), CustomCleanupToEgressHdr, toEgressHdr);
-
+                            hdtn::ToEgressHdr toEgressHdr = hdtn::ToEgressHdr();
                             //memset 0 not needed because all values set below
-                            toEgressHdr->base.type = HDTN_MSGTYPE_EGRESS;
-                            toEgressHdr->base.flags = 0; //flags not used by egress // static_cast<uint16_t>(primary.flags);
-                            toEgressHdr->nextHopNodeId = bundleCutThroughPipelineAckingSetObj.GetNextHopNodeId();
-                            toEgressHdr->finalDestEid = finalDestEid;
-                            toEgressHdr->hasCustody = requestsCustody;
-                            toEgressHdr->isCutThroughFromStorage = 0;
-                            toEgressHdr->custodyId = fromIngressUniqueId;
-                            toEgressHdr->outductIndex = outductIndex;
-                            {
-                                //zmq::message_t messageWithDataStolen(hdrPtr.get(), sizeof(hdtn::BlockHdr), CustomIgnoreCleanupBlockHdr); //cleanup will occur in the queue below
-                                boost::mutex::scoped_lock lock(m_ingressToEgressZmqSocketMutex);
-                                if (!m_zmqPushSock_boundIngressToConnectingEgressPtr->send(std::move(zmqMessageToEgressHdrWithDataStolen), zmq::send_flags::sndmore | zmq::send_flags::dontwait)) {
-                                    LOG_ERROR(subprocess) << "can't send toEgressHdr to egress";
-                                    bundleCutThroughPipelineAckingSetObj.CompareAndPop_ThreadSafe(fromIngressUniqueId, true);
-                                    useStorage = true;
-                                }
-                                else {
-
-                                    if (!m_zmqPushSock_boundIngressToConnectingEgressPtr->send(std::move(*zmqMessageToSendUniquePtr), zmq::send_flags::dontwait)) {
-                                        LOG_ERROR(subprocess) << "can't send bundle to egress";
-                                        bundleCutThroughPipelineAckingSetObj.CompareAndPop_ThreadSafe(fromIngressUniqueId, true);
-                                        useStorage = true;
-                                    }
-                                    else {
-                                        //success                            
-                                        ++m_bundleCountEgress; //protected by m_ingressToEgressZmqSocketMutex
-                                        m_bundleByteCountEgress += bundleCurrentSize; //protected by m_ingressToEgressZmqSocketMutex
-                                    }
-                                }
+                            toEgressHdr.base.type = HDTN_MSGTYPE_EGRESS;
+                            toEgressHdr.base.flags = 0; //flags not used by egress // static_cast<uint16_t>(primary.flags);
+                            toEgressHdr.nextHopNodeId = bundleCutThroughPipelineAckingSetObj.GetNextHopNodeId();
+                            toEgressHdr.finalDestEid = finalDestEid;
+                            toEgressHdr.hasCustody = requestsCustody;
+                            toEgressHdr.isCutThroughFromStorage = 0;
+                            toEgressHdr.custodyId = fromIngressUniqueId;
+                            toEgressHdr.outductIndex = outductIndex;
+                            if (m_directOutductForwarderPtr && m_directOutductForwarderPtr->Forward(toEgressHdr, *zmqMessageToSendUniquePtr)) {
+                                //given straight to the outduct by this thread, acked by OnDirectForwardSuccessfulSend
+                                boost::mutex::scoped_lock lock(m_ingressToEgressZmqSocketMutex); //only protects the counters in this mode
+                                ++m_bundleCountEgress;
+                                m_bundleByteCountEgress += bundleCurrentSize;
+                            }
+                            else if (!SendToEgress(toEgressHdr, zmqMessageToSendUniquePtr.get(), &bundleCutThroughPipelineAckingSetObj)) {
+                                LOG_ERROR(subprocess) << "can't send bundle to egress";
+                                bundleCutThroughPipelineAckingSetObj.CompareAndPop_ThreadSafe(fromIngressUniqueId, true);
+                                useStorage = true;
                             }
                         }
                     }
@@ -1576,16 +1668,45 @@ bool Ingress::Impl::ProcessPaddedData(uint8_t * bundleDataBegin, std::size_t bun
             if (useStorage) { //storage
                 bool storageModuleAvailable = true;
                 if (!reservedStorageCutThroughPipelineAvailability) { //cut through path was not available for egress or storage, time to store the bundle
+                    if (m_admissionControllerPtr && needsProcessing && m_admissionControllerPtr->RefuseStorage(priority, bundleCurrentSize)) {
+                        //never accepted, so custody (if requested) stays with the sender
+                        LOG_DEBUG(subprocess) << "admission control refusing to store a bundle (storage is "
+                            << static_cast<unsigned int>(m_admissionControllerPtr->GetStorageUsedPercent()) << "% full)";
+                        return false;
+                    }
                     ++m_eventsTooManyInStorageCutThroughQueue;
                     static const boost::posix_time::time_duration twoSeconds = boost::posix_time::seconds(2);
-                    storageModuleAvailable = m_singleStorageBundlePipelineAckingSet.WaitForStoragePipelineAvailabilityAndReserve(twoSeconds,
-                        fromIngressUniqueId, zmqMessageToSendUniquePtr->size());
+                    static const boost::posix_time::time_duration noDuration = boost::posix_time::seconds(0);
+                    storageModuleAvailable = m_singleStorageBundlePipelineAckingSet.WaitForStoragePipelineAvailabilityAndReserve(
+                        (m_batchingEnabled || (!mayWaitForPipelines)) ? noDuration : twoSeconds, fromIngressUniqueId, zmqMessageToSendUniquePtr->size());
+                    if ((!storageModuleAvailable) && m_batchingEnabled && mayWaitForPipelines) {
+                        FlushAllBatches(); //the acks needed to free the pipeline may be for bundles still in a pending batch
+                        storageModuleAvailable = m_singleStorageBundlePipelineAckingSet.WaitForStoragePipelineAvailabilityAndReserve(twoSeconds,
+                            fromIngressUniqueId, zmqMessageToSendUniquePtr->size());
+                    }
                     outductIndex = UINT64_MAX;
                 }
                 if (storageModuleAvailable) {
 
                     BundlePipelineAckingSet& ackingSetObj = (outductIndex == UINT64_MAX) ?
                         m_singleStorageBundlePipelineAckingSet : (*(m_vectorBundlePipelineAckingSet[outductIndex])); //only used to restore state if zmq fails
+
+                    if (m_batchingEnabled) {
+                        hdtn::ToStorageHdr toStorageHdr = hdtn::ToStorageHdr();
+                        toStorageHdr.base.type = HDTN_MSGTYPE_STORE;
+                        toStorageHdr.base.flags = 0;
+                        toStorageHdr.ingressUniqueId = fromIngressUniqueId;
+                        toStorageHdr.outductIndex = outductIndex;
+                        toStorageHdr.dontStoreBundle = reservedStorageCutThroughPipelineAvailability;
+                        toStorageHdr.isCustodyOrAdminRecord = (requestsCustody || isAdminRecordForHdtnStorage || needsFragmenting);
+                        toStorageHdr.finalDestEid = finalDestEid;
+                        boost::mutex::scoped_lock lock(m_ingressToStorageZmqSocketMutex);
+                        AppendToBatch_NotThreadSafe(m_pendingStorageBatch, toStorageHdr, fromIngressUniqueId, std::move(*zmqMessageToSendUniquePtr), ackingSetObj);
+                        if (m_pendingStorageBatch.m_headers.size() >= m_hdtnConfig.m_maxIngressBatchBundles) {
+                            FlushStorageBatch_NotThreadSafe();
+                        }
+                        return true;
+                    }
                     
                     //force natural/64-bit alignment
                     hdtn::ToStorageHdr* toStorageHdr = new hdtn::ToStorageHdr();
@@ -1607,7 +1728,7 @@ bool Ingress::Impl::ProcessPaddedData(uint8_t * bundleDataBegin, std::size_t bun
                         ackingSetObj.CompareAndPop_ThreadSafe(fromIngressUniqueId, false);
                     }
                     else {
-                        if (!m_zmqPushSock_boundIngressToConnectingStoragePtr->send(std::move(*zmqMessageToSendUniquePtr), zmq::send_flags::dontwait)) {
+                        if (!SendBundlePart(*m_zmqPushSock_boundIngressToConnectingStoragePtr, *zmqMessageToSendUniquePtr)) {
                             LOG_ERROR(subprocess) << "can't send bundle to storage, this bundle will be lost";
                             ackingSetObj.CompareAndPop_ThreadSafe(fromIngressUniqueId, false);
                         }
@@ -1618,6 +1739,10 @@ bool Ingress::Impl::ProcessPaddedData(uint8_t * bundleDataBegin, std::size_t bun
                         }
                     }
                 }
+                else if (!mayWaitForPipelines) { //overloaded, dropped early rather than blocking this induct
+                    m_admissionControllerPtr->RecordEarlyDrop(bundleCurrentSize);
+                    return false;
+                }
                 else {
                     LOG_ERROR(subprocess) << "storage module unresponsive, this bundle will be lost";
                 }
@@ -1629,7 +1754,48 @@ bool Ingress::Impl::ProcessPaddedData(uint8_t * bundleDataBegin, std::size_t bun
 }
 
 
+//Returns the final destination of a bundle from its primary block only (for choosing an ingress worker), false if malformed
+static bool PeekFinalDestEid(uint8_t* bundleDataBegin, const std::size_t bundleCurrentSize, cbhe_eid_t& finalDestEid) {
+    if (bundleCurrentSize == 0) {
+        return false;
+    }
+    uint64_t decodedBlockSize;
+    const uint8_t firstByte = bundleDataBegin[0];
+    if (firstByte == 6) {
+        Bpv6CbhePrimaryBlock primary;
+        if (!primary.DeserializeBpv6(bundleDataBegin, decodedBlockSize, bundleCurrentSize)) {
+            return false;
+        }
+        finalDestEid = primary.m_destinationEid;
+        return true;
+    }
+    else if (firstByte == ((4U << 5) | 31U)) { //CBOR major type 4, additional information 31 (Indefinite-Length Array)
+        Bpv7CbhePrimaryBlock primary;
+        if (!primary.DeserializeBpv7(bundleDataBegin + 1, decodedBlockSize, bundleCurrentSize - 1)) {
+            return false;
+        }
+        finalDestEid = primary.m_destinationEid;
+        return true;
+    }
+    return false;
+}
+
 void Ingress::Impl::WholeBundleReadyCallback(padded_vector_uint8_t & wholeBundleVec) {
+    if (!m_ingressWorkers.empty()) {
+        //all bundles to the same final destination go to the same worker to keep them in order
+        cbhe_eid_t finalDestEid(0, 0);
+        PeekFinalDestEid(wholeBundleVec.data(), wholeBundleVec.size(), finalDestEid); //if malformed, the worker will log and drop it
+        const uint64_t hash = (finalDestEid.nodeId * 0x9E3779B97F4A7C15ULL) ^ finalDestEid.serviceId;
+        IngressWorker& worker = *m_ingressWorkers[hash % m_ingressWorkers.size()];
+        //block this induct while the worker is backed up to keep the convergence layer's natural flow control
+        while (!worker.m_bundleQueue.TryPush(std::move(wholeBundleVec))) {
+            if (!m_running.load(std::memory_order_acquire)) {
+                return;
+            }
+            boost::this_thread::sleep(boost::posix_time::microseconds(200));
+        }
+        return;
+    }
     //if more than 1 BpSinkAsync context, must protect shared resources with mutex.  Each BpSinkAsync context has
     //its own processing thread that calls this callback
     static std::unique_ptr<zmq::message_t> unusedZmqPtr;
@@ -1637,21 +1803,267 @@ void Ingress::Impl::WholeBundleReadyCallback(padded_vector_uint8_t & wholeBundle
     ProcessPaddedData(wholeBundleVec.data(), wholeBundleVec.size(), unusedZmqPtr, wholeBundleVec, false, true, isSafeToYieldThisThread);
 }
 
-void Ingress::Impl::SendOpportunisticLinkMessages(const uint64_t remoteNodeId, bool isAvailable) {
-    //force natural/64-bit alignment
-    hdtn::ToEgressHdr * toEgressHdr = new hdtn::ToEgressHdr();
-    zmq::message_t zmqMessageToEgressHdrWithDataStolen(toEgressHdr, sizeof(hdtn::ToEgressHdr), CustomCleanupToEgressHdr, toEgressHdr);
+void Ingress::Impl::IngressWorkerThreadFunc(const unsigned int workerIndex) {
+    ThreadNamer::SetThisThreadName("ingressWorker" + boost::lexical_cast<std::string>(workerIndex));
+    IngressWorker& worker = *m_ingressWorkers[workerIndex];
+    zmq::pollitem_t items[1] = { {NULL, worker.m_bundleQueue.GetPollFd(), ZMQ_POLLIN, 0} };
+    static constexpr long DEFAULT_BIG_TIMEOUT_POLL = 250;
+    static std::unique_ptr<zmq::message_t> unusedZmqPtr;
+    static constexpr bool isSafeToYieldThisThread = true; //not the ReadZmqAcksThreadFunc
+    padded_vector_uint8_t bundle;
+    while (m_running.load(std::memory_order_acquire)) { //keep thread alive if running
+        const bool hasBundles = worker.m_bundleQueue.PrepareToWait();
+        int rc = 0;
+        try {
+            rc = zmq::poll(&items[0], 1, (hasBundles) ? 0 : DEFAULT_BIG_TIMEOUT_POLL);
+        }
+        catch (zmq::error_t& e) {
+            LOG_ERROR(subprocess) << "caught zmq::error_t in Ingress::IngressWorkerThreadFunc: " << e.what();
+        }
+        worker.m_bundleQueue.FinishWait((rc > 0) && (items[0].revents & ZMQ_POLLIN));
+        while (worker.m_bundleQueue.TryPop(bundle)) {
+            ProcessPaddedData(bundle.data(), bundle.size(), unusedZmqPtr, bundle, false, true, isSafeToYieldThisThread);
+            ++worker.m_totalBundlesProcessed;
+        }
+    }
+}
 
-    //not necessary to send to egress first before storage because storage marks bundles as opportunistic before sending them to egress
-    //memset 0 not needed because all values set below
-    toEgressHdr->base.type = isAvailable ? HDTN_MSGTYPE_EGRESS_ADD_OPPORTUNISTIC_LINK : HDTN_MSGTYPE_EGRESS_REMOVE_OPPORTUNISTIC_LINK;
-    toEgressHdr->finalDestEid.nodeId = remoteNodeId; //only used field, rest are don't care
+//Called by egress (from an outduct thread) when a bundle given to the outduct by m_directOutductForwarderPtr was sent,
+//instead of an HDTN_MSGTYPE_EGRESS_ACK_TO_INGRESS over zmq.  No shared lock is needed because m_vectorBundlePipelineAckingSet
+//is only filled in when the first outduct capabilities are received, before any bundle could have been forwarded.
+void Ingress::Impl::OnDirectForwardSuccessfulSend(const hdtn::EgressAckHdr& egressAckHdr) {
+    if (egressAckHdr.outductIndex >= m_vectorBundlePipelineAckingSet.size()) {
+        LOG_ERROR(subprocess) << "direct forward ack for unknown outductIndex " << egressAckHdr.outductIndex;
+    }
+    else if (!m_vectorBundlePipelineAckingSet[egressAckHdr.outductIndex]->CompareAndPop_ThreadSafe(egressAckHdr.custodyId, true)) { //true => isEgress
+        LOG_ERROR(subprocess) << "didn't receive expected direct forward ack";
+    }
+}
+
+//Sends the ToEgressHdr followed by the bundle (if zmqMessageBundlePtr is not NULL) to egress,
+//either over the lock-free m_toEgressInprocChannelPtr (hdtn-one-process) or over zmq.
+//Thread safe.  Returns false if egress could not take the message, in which case *zmqMessageBundlePtr is not moved.
+bool Ingress::Impl::SendToEgress(const hdtn::ToEgressHdr& toEgressHdr, zmq::message_t* zmqMessageBundlePtr,
+    BundlePipelineAckingSet* ackingSetToRestorePtr)
+{
+    const std::size_t bundleSize = (zmqMessageBundlePtr) ? zmqMessageBundlePtr->size() : 0;
+    if (m_toEgressInprocChannelPtr) {
+        hdtn::ToEgressInprocMessage inprocMessage;
+        inprocMessage.toEgressHdr = toEgressHdr;
+        if (zmqMessageBundlePtr) {
+            inprocMessage.bundle.move(*zmqMessageBundlePtr);
+        }
+        if (!m_toEgressInprocChannelPtr->TryPush(std::move(inprocMessage))) { //full
+            if (zmqMessageBundlePtr) {
+                zmqMessageBundlePtr->move(inprocMessage.bundle); //give it back to the caller
+            }
+            return false;
+        }
+        if (zmqMessageBundlePtr) {
+            boost::mutex::scoped_lock lock(m_ingressToEgressZmqSocketMutex); //only protects the counters in this mode
+            ++m_bundleCountEgress;
+            m_bundleByteCountEgress += bundleSize;
+        }
+        return true;
+    }
+
+    if (m_batchingEnabled) {
+        const bool isBatchable = (ackingSetToRestorePtr && zmqMessageBundlePtr && (toEgressHdr.base.type == HDTN_MSGTYPE_EGRESS));
+        PendingBatch<hdtn::ToEgressHdr> unsentEgressBatch;
+        {
+            boost::mutex::scoped_lock lock(m_ingressToEgressZmqSocketMutex);
+            if (isBatchable) {
+                AppendToBatch_NotThreadSafe(m_pendingEgressBatch, toEgressHdr, toEgressHdr.custodyId, std::move(*zmqMessageBundlePtr), *ackingSetToRestorePtr);
+                if (m_pendingEgressBatch.m_headers.size() >= m_hdtnConfig.m_maxIngressBatchBundles) {
+                    FlushEgressBatch_NotThreadSafe(unsentEgressBatch);
+                }
+            }
+            else {
+                FlushEgressBatch_NotThreadSafe(unsentEgressBatch); //keep this message in order behind the pending bundles
+            }
+        }
+        SendUnsentEgressBatchToStorage(unsentEgressBatch);
+        if (isBatchable) {
+            return true;
+        }
+    }
+    boost::mutex::scoped_lock lock(m_ingressToEgressZmqSocketMutex);
+    //force natural/64-bit alignment
+    hdtn::ToEgressHdr* toEgressHdrPtr = new hdtn::ToEgressHdr(toEgressHdr);
+    zmq::message_t zmqMessageToEgressHdrWithDataStolen(toEgressHdrPtr, sizeof(hdtn::ToEgressHdr), CustomCleanupToEgressHdr, toEgressHdrPtr);
+    if (!m_zmqPushSock_boundIngressToConnectingEgressPtr->send(std::move(zmqMessageToEgressHdrWithDataStolen),
+        (zmqMessageBundlePtr) ? (zmq::send_flags::sndmore | zmq::send_flags::dontwait) : zmq::send_flags::dontwait))
     {
-        //zmq::message_t messageWithDataStolen(hdrPtr.get(), sizeof(hdtn::BlockHdr), CustomIgnoreCleanupBlockHdr); //cleanup will occur in the queue below
-        boost::mutex::scoped_lock lock(m_ingressToEgressZmqSocketMutex);
-        if (!m_zmqPushSock_boundIngressToConnectingEgressPtr->send(std::move(zmqMessageToEgressHdrWithDataStolen), zmq::send_flags::dontwait)) {
-            LOG_ERROR(subprocess) << "can't send ToEgressHdr Opportunistic link message to egress";
+        LOG_ERROR(subprocess) << "can't send toEgressHdr to egress";
+        return false;
+    }
+    if (zmqMessageBundlePtr) {
+        if (!SendBundlePart(*m_zmqPushSock_boundIngressToConnectingEgressPtr, *zmqMessageBundlePtr)) {
+            return false;
+        }
+        ++m_bundleCountEgress; //protected by m_ingressToEgressZmqSocketMutex
+        m_bundleByteCountEgress += bundleSize; //protected by m_ingressToEgressZmqSocketMutex
+    }
+    return true;
+}
+
+//sends the last part (the bundle) of a message to egress or storage; caller must hold the mutex protecting socket
+bool Ingress::Impl::SendBundlePart(zmq::socket_t& socket, zmq::message_t& zmqMessageBundle) {
+    if (m_sharedMemoryBundleWriterPtr) {
+        return m_sharedMemoryBundleWriterPtr->Send(socket, zmqMessageBundle, zmq::send_flags::dontwait);
+    }
+    return static_cast<bool>(socket.send(std::move(zmqMessageBundle), zmq::send_flags::dontwait));
+}
+
+//caller must hold the mutex protecting the batch's socket
+template <typename ToHdrType>
+void Ingress::Impl::AppendToBatch_NotThreadSafe(PendingBatch<ToHdrType>& batch, const ToHdrType& toHdr, const uint64_t ingressUniqueId,
+    zmq::message_t&& zmqMessageBundle, BundlePipelineAckingSet& ackingSetToRestore)
+{
+    if (batch.m_headers.empty()) { //start the latency deadline of this batch
+        {
+            boost::mutex::scoped_lock lock(m_batchFlusherMutex);
+            m_batchFlusherHasPendingBatch = true;
+        }
+        m_batchFlusherConditionVariable.notify_one();
+    }
+    batch.m_headers.push_back(toHdr);
+    batch.m_restoreInfos.push_back({ &ackingSetToRestore, ingressUniqueId, zmqMessageBundle.size() });
+    batch.m_bundles.emplace_back(std::move(zmqMessageBundle));
+}
+
+//caller must hold the mutex protecting socket
+template <typename ToHdrType>
+void Ingress::Impl::FlushBatch_NotThreadSafe(PendingBatch<ToHdrType>& batch, zmq::socket_t& socket, const uint16_t batchMessageType,
+    const bool isEgress, uint64_t& bundleCount, uint64_t& bundleByteCount, PendingBatch<ToHdrType>* unsentBatchPtr)
+{
+    const std::size_t numBundles = batch.m_headers.size();
+    if (numBundles == 0) {
+        return;
+    }
+    const std::size_t numSent = SendBatchMessage(socket, batchMessageType, batch.m_headers, batch.m_bundles,
+        zmq::send_flags::dontwait, m_sharedMemoryBundleWriterPtr.get());
+    if (numSent) {
+        for (std::size_t i = 0; i < numSent; ++i) {
+            bundleByteCount += batch.m_restoreInfos[i].bundleSizeBytes;
+        }
+        bundleCount += numSent;
+        ++batch.m_totalBatchesSent;
+    }
+    if (numSent != numBundles) {
+        if (unsentBatchPtr) { //caller keeps the reservations and takes ownership of the unsent bundles
+            for (std::size_t i = numSent; i < numBundles; ++i) {
+                unsentBatchPtr->m_headers.push_back(batch.m_headers[i]);
+                unsentBatchPtr->m_bundles.emplace_back(std::move(batch.m_bundles[i]));
+                unsentBatchPtr->m_restoreInfos.push_back(batch.m_restoreInfos[i]);
+            }
+        }
+        else {
+            LOG_ERROR(subprocess) << "can't send batch to " << ((isEgress) ? "egress" : "storage") << ", "
+                << (numBundles - numSent) << " bundles will be lost";
+            for (std::size_t i = numSent; i < numBundles; ++i) {
+                const typename PendingBatch<ToHdrType>::RestoreInfo& restoreInfo = batch.m_restoreInfos[i];
+                restoreInfo.ackingSetPtr->CompareAndPop_ThreadSafe(restoreInfo.ingressUniqueId, isEgress);
+            }
+        }
+    }
+    batch.m_headers.clear();
+    batch.m_bundles.clear();
+    batch.m_restoreInfos.clear();
+}
+
+//the caller must pass unsentEgressBatch to SendUnsentEgressBatchToStorage after releasing m_ingressToEgressZmqSocketMutex
+void Ingress::Impl::FlushEgressBatch_NotThreadSafe(PendingBatch<hdtn::ToEgressHdr>& unsentEgressBatch) {
+    FlushBatch_NotThreadSafe(m_pendingEgressBatch, *m_zmqPushSock_boundIngressToConnectingEgressPtr, HDTN_MSGTYPE_EGRESS_BATCH,
+        true, m_bundleCountEgress, m_bundleByteCountEgress, &unsentEgressBatch);
+}
+
+void Ingress::Impl::FlushStorageBatch_NotThreadSafe() {
+    FlushBatch_NotThreadSafe(m_pendingStorageBatch, *m_zmqPushSock_boundIngressToConnectingStoragePtr, HDTN_MSGTYPE_STORE_BATCH,
+        false, m_bundleCountStorage, m_bundleByteCountStorage, static_cast<PendingBatch<hdtn::ToStorageHdr>*>(NULL)); //a failed storage send loses the bundles
+}
+
+//bundles that egress could not accept (zmq high water mark) are stored instead, like a failed per-bundle send to egress
+void Ingress::Impl::SendUnsentEgressBatchToStorage(PendingBatch<hdtn::ToEgressHdr>& unsentEgressBatch) {
+    static const boost::posix_time::time_duration noDuration = boost::posix_time::seconds(0);
+    static const boost::posix_time::time_duration twoSeconds = boost::posix_time::seconds(2);
+    for (std::size_t i = 0; i < unsentEgressBatch.m_headers.size(); ++i) {
+        const hdtn::ToEgressHdr& toEgressHdr = unsentEgressBatch.m_headers[i];
+        const PendingBatch<hdtn::ToEgressHdr>::RestoreInfo& restoreInfo = unsentEgressBatch.m_restoreInfos[i];
+        zmq::message_t& zmqMessageBundle = unsentEgressBatch.m_bundles[i];
+        LOG_ERROR(subprocess) << "can't send bundle to egress";
+        restoreInfo.ackingSetPtr->CompareAndPop_ThreadSafe(restoreInfo.ingressUniqueId, true); //true => isEgress
+        ++m_eventsTooManyInStorageCutThroughQueue;
+        bool storageModuleAvailable = m_singleStorageBundlePipelineAckingSet.WaitForStoragePipelineAvailabilityAndReserve(noDuration,
+            restoreInfo.ingressUniqueId, zmqMessageBundle.size());
+        if (!storageModuleAvailable) {
+            {
+                boost::mutex::scoped_lock lock(m_ingressToStorageZmqSocketMutex);
+                FlushStorageBatch_NotThreadSafe(); //the acks needed to free the pipeline may be for bundles still in the pending batch
+            }
+            storageModuleAvailable = m_singleStorageBundlePipelineAckingSet.WaitForStoragePipelineAvailabilityAndReserve(twoSeconds,
+                restoreInfo.ingressUniqueId, zmqMessageBundle.size());
+        }
+        if (!storageModuleAvailable) {
+            LOG_ERROR(subprocess) << "storage module unresponsive, this bundle will be lost";
+            continue;
+        }
+        hdtn::ToStorageHdr toStorageHdr = hdtn::ToStorageHdr();
+        toStorageHdr.base.type = HDTN_MSGTYPE_STORE;
+        toStorageHdr.base.flags = 0;
+        toStorageHdr.ingressUniqueId = restoreInfo.ingressUniqueId;
+        toStorageHdr.outductIndex = UINT64_MAX;
+        toStorageHdr.dontStoreBundle = 0;
+        toStorageHdr.isCustodyOrAdminRecord = toEgressHdr.hasCustody;
+        toStorageHdr.finalDestEid = toEgressHdr.finalDestEid;
+        boost::mutex::scoped_lock lock(m_ingressToStorageZmqSocketMutex);
+        AppendToBatch_NotThreadSafe(m_pendingStorageBatch, toStorageHdr, restoreInfo.ingressUniqueId, std::move(zmqMessageBundle),
+            m_singleStorageBundlePipelineAckingSet);
+        if (m_pendingStorageBatch.m_headers.size() >= m_hdtnConfig.m_maxIngressBatchBundles) {
+            FlushStorageBatch_NotThreadSafe();
+        }
+    }
+}
+
+void Ingress::Impl::FlushAllBatches() {
+    if (m_toEgressInprocChannelPtr == NULL) {
+        PendingBatch<hdtn::ToEgressHdr> unsentEgressBatch;
+        {
+            boost::mutex::scoped_lock lock(m_ingressToEgressZmqSocketMutex);
+            FlushEgressBatch_NotThreadSafe(unsentEgressBatch);
+        }
+        SendUnsentEgressBatchToStorage(unsentEgressBatch);
+    }
+    boost::mutex::scoped_lock lock(m_ingressToStorageZmqSocketMutex);
+    FlushStorageBatch_NotThreadSafe();
+}
+
+//sends every pending batch no later than ingressBatchLatencyMicroseconds after its first bundle was added
+void Ingress::Impl::BatchFlusherThreadFunc() {
+    ThreadNamer::SetThisThreadName("ingressBatchFlusher");
+    const boost::posix_time::time_duration batchLatency = boost::posix_time::microseconds(m_hdtnConfig.m_ingressBatchLatencyMicroseconds);
+    boost::mutex::scoped_lock lock(m_batchFlusherMutex);
+    while (m_running.load(std::memory_order_acquire)) { //keep thread alive if running
+        if (!m_batchFlusherHasPendingBatch) {
+            m_batchFlusherConditionVariable.timed_wait(lock, boost::posix_time::milliseconds(250)); //periodically check m_running
+            continue;
         }
+        m_batchFlusherHasPendingBatch = false;
+        lock.unlock();
+        boost::this_thread::sleep(batchLatency); //a batch that fills up in the meantime is sent by the thread that filled it
+        FlushAllBatches();
+        lock.lock();
+    }
+}
+
+void Ingress::Impl::SendOpportunisticLinkMessages(const uint64_t remoteNodeId, bool isAvailable) {
+    hdtn::ToEgressHdr toEgressHdr = hdtn::ToEgressHdr();
+
+    //not necessary to send to egress first before storage because storage marks bundles as opportunistic before sending them to egress
+    toEgressHdr.base.type = isAvailable ? HDTN_MSGTYPE_EGRESS_ADD_OPPORTUNISTIC_LINK : HDTN_MSGTYPE_EGRESS_REMOVE_OPPORTUNISTIC_LINK;
+    toEgressHdr.finalDestEid.nodeId = remoteNodeId; //only used field, rest are don't care
+    if (!SendToEgress(toEgressHdr, NULL)) {
+        LOG_ERROR(subprocess) << "can't send ToEgressHdr Opportunistic link message to egress";
     }
 
     //force natural/64-bit alignment
@@ -1663,6 +2075,9 @@ void Ingress::Impl::SendOpportunisticLinkMessages(const uint64_t remoteNodeId, b
     toStorageHdr->ingressUniqueId = remoteNodeId; //use this field as the remote node id
     {
         boost::mutex::scoped_lock lock(m_ingressToStorageZmqSocketMutex);
+        if (m_batchingEnabled) {
+            FlushStorageBatch_NotThreadSafe(); //keep this message in order behind the pending bundles
+        }
         if (!m_zmqPushSock_boundIngressToConnectingStoragePtr->send(std::move(zmqMessageToStorageHdrWithDataStolen), zmq::send_flags::dontwait)) {
             LOG_ERROR(subprocess) << "can't send ToStorageHdr Opportunistic link message to storage";
         }
@@ -0,0 +1,265 @@
+/**
+ * @file BundlePipelineAckingSetSpeedTestMain.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * Contention benchmark of the ingress BundlePipelineAckingSet the way ingress uses it:
+ * N producer threads (the inducts) reserve egress or storage pipeline credit for every bundle and pass the
+ * unique id to a single acker thread (the ReadZmqAcksThreadFunc) which acks it back.
+ * The lock-free BundlePipelineAckingSet is compared against the previous mutex and unordered_map implementation,
+ * which notified every waiting producer on every ack.
+ */
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <boost/program_options.hpp>
+#include <boost/timer/timer.hpp>
+#include <boost/thread.hpp>
+#include <boost/make_unique.hpp>
+#include "BundlePipelineAckingSet.h"
+#include "InprocMessageChannel.h"
+#include "FreeListAllocator.h"
+#include "Logger.h"
+
+static constexpr hdtn::Logger::SubProcess subprocess = hdtn::Logger::SubProcess::ingress;
+
+//the previous implementation, kept here as the baseline
+class MutexBundlePipelineAckingSet : private boost::noncopyable {
+public:
+    MutexBundlePipelineAckingSet(const uint64_t paramMaxBundlesInPipeline,
+        const uint64_t paramMaxBundleSizeBytesInPipeline, const uint64_t, bool) :
+        m_egressBytesInPipeline(0),
+        m_storageBytesInPipeline(0),
+        m_maxBundlesInPipeline(paramMaxBundlesInPipeline),
+        m_maxBundleSizeBytesInPipeline(paramMaxBundleSizeBytesInPipeline)
+    {
+        m_mapEgressBundleUniqueIdToBundleSizeBytes.reserve(m_maxBundlesInPipeline);
+        m_mapEgressBundleUniqueIdToBundleSizeBytes.get_allocator().SetMaxListSizeFromGetAllocatorCopy(m_maxBundlesInPipeline + 2);
+        m_mapStorageBundleUniqueIdToBundleSizeBytes.reserve(m_maxBundlesInPipeline);
+        m_mapStorageBundleUniqueIdToBundleSizeBytes.get_allocator().SetMaxListSizeFromGetAllocatorCopy(m_maxBundlesInPipeline + 2);
+    }
+
+    bool CompareAndPop_ThreadSafe(const uint64_t uniqueId, const bool isEgress) {
+        uint64_t& bytesInPipelineRef = (isEgress) ? m_egressBytesInPipeline : m_storageBytesInPipeline;
+        umap_64_to_64_t& mapBundleUniqueIdToBundleSizeBytes = (isEgress) ?
+            m_mapEgressBundleUniqueIdToBundleSizeBytes : m_mapStorageBundleUniqueIdToBundleSizeBytes;
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            umap_64_to_64_t::iterator it = mapBundleUniqueIdToBundleSizeBytes.find(uniqueId);
+            if (it == mapBundleUniqueIdToBundleSizeBytes.end()) {
+                return false;
+            }
+            bytesInPipelineRef -= it->second;
+            mapBundleUniqueIdToBundleSizeBytes.erase(it);
+        }
+        m_conditionVariable.notify_all(); //the ack thread called NotifyAll() after every successful pop
+        return true;
+    }
+
+    bool WaitForPipelineAvailabilityAndReserve(const bool checkEgressPipeline, const bool checkStoragePipeline,
+        const boost::posix_time::time_duration& timeoutDuration, const uint64_t uniqueId, const uint64_t bundleSizeBytes,
+        bool& reservedEgressPipelineAvailability, bool& reservedStoragePipelineAvailability)
+    {
+        reservedEgressPipelineAvailability = false;
+        reservedStoragePipelineAvailability = false;
+        const uint64_t halfOfMaxBundlesInPipeline = m_maxBundlesInPipeline >> 1;
+        const uint64_t halfOfMaxBytesInPipeline = m_maxBundleSizeBytesInPipeline >> 1;
+        const boost::posix_time::ptime timeoutExpiry(boost::posix_time::microsec_clock::universal_time() + timeoutDuration);
+        boost::mutex::scoped_lock lock(m_mutex);
+        while (
+            ((m_mapEgressBundleUniqueIdToBundleSizeBytes.size() >= (halfOfMaxBundlesInPipeline * checkEgressPipeline))
+            || ((m_egressBytesInPipeline + bundleSizeBytes) > (halfOfMaxBytesInPipeline * checkEgressPipeline)))
+            &&
+            ((m_mapStorageBundleUniqueIdToBundleSizeBytes.size() >= (halfOfMaxBundlesInPipeline * checkStoragePipeline))
+            || ((m_storageBytesInPipeline + bundleSizeBytes) > (halfOfMaxBytesInPipeline * checkStoragePipeline)))
+            &&
+            m_conditionVariable.timed_wait(lock, timeoutExpiry)) {
+        }
+        if (checkEgressPipeline) {
+            reservedEgressPipelineAvailability = (m_mapEgressBundleUniqueIdToBundleSizeBytes.size() < halfOfMaxBundlesInPipeline)
+                && ((m_egressBytesInPipeline + bundleSizeBytes) <= halfOfMaxBytesInPipeline);
+            if (reservedEgressPipelineAvailability) {
+                m_mapEgressBundleUniqueIdToBundleSizeBytes.emplace(uniqueId, bundleSizeBytes);
+                m_egressBytesInPipeline += bundleSizeBytes;
+                return true;
+            }
+        }
+        if (checkStoragePipeline) {
+            reservedStoragePipelineAvailability = (m_mapStorageBundleUniqueIdToBundleSizeBytes.size() < halfOfMaxBundlesInPipeline)
+                && ((m_storageBytesInPipeline + bundleSizeBytes) <= halfOfMaxBytesInPipeline);
+            if (reservedStoragePipelineAvailability) {
+                m_mapStorageBundleUniqueIdToBundleSizeBytes.emplace(uniqueId, bundleSizeBytes);
+                m_storageBytesInPipeline += bundleSizeBytes;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint64_t GetNumBundlesInPipeline(const bool isEgress) {
+        boost::mutex::scoped_lock lock(m_mutex);
+        return ((isEgress) ? m_mapEgressBundleUniqueIdToBundleSizeBytes : m_mapStorageBundleUniqueIdToBundleSizeBytes).size();
+    }
+    uint64_t GetNumBytesInPipeline(const bool isEgress) {
+        boost::mutex::scoped_lock lock(m_mutex);
+        return (isEgress) ? m_egressBytesInPipeline : m_storageBytesInPipeline;
+    }
+private:
+    boost::mutex m_mutex;
+    boost::condition_variable m_conditionVariable;
+    typedef std::unordered_map<uint64_t, uint64_t,
+        std::hash<uint64_t>,
+        std::equal_to<uint64_t>,
+        FreeListAllocatorDynamic<std::pair<const uint64_t, uint64_t> > > umap_64_to_64_t;
+    umap_64_to_64_t m_mapEgressBundleUniqueIdToBundleSizeBytes;
+    umap_64_to_64_t m_mapStorageBundleUniqueIdToBundleSizeBytes;
+    uint64_t m_egressBytesInPipeline;
+    uint64_t m_storageBytesInPipeline;
+    uint64_t m_maxBundlesInPipeline;
+    uint64_t m_maxBundleSizeBytesInPipeline;
+};
+
+struct AckMessage {
+    uint64_t uniqueId;
+    bool isEgress;
+};
+
+template <typename ackingSetType>
+static bool TestSpeed(const unsigned int numProducers, const uint64_t numBundlesPerProducer,
+    const uint64_t maxBundlesInPipeline, const uint64_t maxBundleSizeBytesInPipeline, const uint64_t maxBundleSizeBytes,
+    double& bundlesPerSec)
+{
+    ackingSetType ackingSet(maxBundlesInPipeline, maxBundleSizeBytesInPipeline, 1, true);
+    //every reserved unique id fits, so a push never fails
+    InprocMessageChannel<AckMessage> ackChannel(static_cast<uint32_t>(maxBundlesInPipeline + 1));
+    const uint64_t totalBundles = numBundlesPerProducer * numProducers;
+    std::atomic<uint64_t> numTimeouts(0);
+
+    boost::timer::cpu_timer timer;
+    std::vector<std::unique_ptr<boost::thread> > producerThreads;
+    for (unsigned int p = 0; p < numProducers; ++p) {
+        producerThreads.emplace_back(boost::make_unique<boost::thread>([&, p]() {
+            for (uint64_t i = 0; i < numBundlesPerProducer; ++i) {
+                const uint64_t uniqueId = (i * numProducers) + p;
+                const uint64_t bundleSizeBytes = 1 + ((uniqueId * 2654435761u) % maxBundleSizeBytes);
+                AckMessage msg;
+                msg.uniqueId = uniqueId;
+                bool reservedEgress, reservedStorage;
+                while (!ackingSet.WaitForPipelineAvailabilityAndReserve(true, true, boost::posix_time::seconds(2),
+                    uniqueId, bundleSizeBytes, reservedEgress, reservedStorage))
+                {
+                    numTimeouts.fetch_add(1, std::memory_order_relaxed);
+                }
+                msg.isEgress = reservedEgress;
+                if (!ackChannel.TryPush(std::move(msg))) {
+                    LOG_ERROR(subprocess) << "ack channel full";
+                }
+            }
+        }));
+    }
+
+    uint64_t numAcked = 0;
+    uint64_t numAckErrors = 0;
+    AckMessage msg;
+    while (numAcked < totalBundles) {
+        if (ackChannel.TryPop(msg)) {
+            if (!ackingSet.CompareAndPop_ThreadSafe(msg.uniqueId, msg.isEgress)) {
+                ++numAckErrors;
+            }
+            ++numAcked;
+        }
+        else {
+            boost::this_thread::yield();
+        }
+    }
+    for (std::size_t p = 0; p < producerThreads.size(); ++p) {
+        producerThreads[p]->join();
+    }
+    timer.stop();
+
+    const double seconds = static_cast<double>(timer.elapsed().wall) * 1e-9;
+    bundlesPerSec = (seconds > 0.0) ? (static_cast<double>(totalBundles) / seconds) : 0.0;
+    if (numAckErrors || numTimeouts.load()) {
+        LOG_ERROR(subprocess) << numAckErrors << " acks not found, " << numTimeouts.load() << " reservation timeouts";
+        return false;
+    }
+    for (unsigned int i = 0; i < 2; ++i) {
+        const bool isEgress = (i == 0);
+        if (ackingSet.GetNumBundlesInPipeline(isEgress) || ackingSet.GetNumBytesInPipeline(isEgress)) {
+            LOG_ERROR(subprocess) << ((isEgress) ? "egress" : "storage") << " pipeline not empty after all acks: "
+                << ackingSet.GetNumBundlesInPipeline(isEgress) << " bundles, " << ackingSet.GetNumBytesInPipeline(isEgress) << " bytes";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, const char* argv[]) {
+    hdtn::Logger::initializeWithProcess(hdtn::Logger::Process::ingress);
+
+    std::vector<unsigned int> numProducersList;
+    uint64_t numBundles;
+    uint64_t maxBundlesInPipeline;
+    uint64_t maxBundleSizeBytesInPipeline;
+    uint64_t maxBundleSizeBytes;
+    boost::program_options::options_description desc("Allowed options");
+    try {
+        desc.add_options()
+            ("help", "Produce help message.")
+            ("num-producers", boost::program_options::value<std::vector<unsigned int> >()->multitoken()->default_value(std::vector<unsigned int>({ 1, 2, 4, 8 }), "1 2 4 8"), "Numbers of producer (induct) threads to test.")
+            ("num-bundles", boost::program_options::value<uint64_t>()->default_value(1000000), "Total number of bundles reserved and acked per test.")
+            ("max-bundles-in-pipeline", boost::program_options::value<uint64_t>()->default_value(50), "Outduct maxBundlesInPipeline (half for egress, half for storage).")
+            ("max-bundle-size-bytes-in-pipeline", boost::program_options::value<uint64_t>()->default_value(50000000), "Outduct maxBundleSizeBytesInPipeline (half for egress, half for storage).")
+            ("max-bundle-size-bytes", boost::program_options::value<uint64_t>()->default_value(100000), "Bundle sizes are spread between 1 and this value.");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc, boost::program_options::command_line_style::unix_style | boost::program_options::command_line_style::case_insensitive), vm);
+        boost::program_options::notify(vm);
+
+        if (vm.count("help")) {
+            LOG_INFO(subprocess) << desc;
+            return 1;
+        }
+        numProducersList = vm["num-producers"].as<std::vector<unsigned int> >();
+        numBundles = vm["num-bundles"].as<uint64_t>();
+        maxBundlesInPipeline = std::max<uint64_t>(vm["max-bundles-in-pipeline"].as<uint64_t>(), 2);
+        maxBundleSizeBytesInPipeline = vm["max-bundle-size-bytes-in-pipeline"].as<uint64_t>();
+        maxBundleSizeBytes = std::max<uint64_t>(vm["max-bundle-size-bytes"].as<uint64_t>(), 1);
+        if (maxBundleSizeBytes > (maxBundleSizeBytesInPipeline >> 1)) {
+            LOG_ERROR(subprocess) << "max-bundle-size-bytes must fit in half of max-bundle-size-bytes-in-pipeline";
+            return 1;
+        }
+    }
+    catch (std::exception& e) {
+        LOG_ERROR(subprocess) << "error: " << e.what();
+        return 1;
+    }
+
+    for (std::size_t i = 0; i < numProducersList.size(); ++i) {
+        const unsigned int numProducers = std::max(numProducersList[i], 1u);
+        const uint64_t numBundlesPerProducer = numBundles / numProducers;
+        double mutexBundlesPerSec;
+        double atomicBundlesPerSec;
+        if (!TestSpeed<MutexBundlePipelineAckingSet>(numProducers, numBundlesPerProducer,
+            maxBundlesInPipeline, maxBundleSizeBytesInPipeline, maxBundleSizeBytes, mutexBundlesPerSec))
+        {
+            return 1;
+        }
+        if (!TestSpeed<hdtn::BundlePipelineAckingSet>(numProducers, numBundlesPerProducer,
+            maxBundlesInPipeline, maxBundleSizeBytesInPipeline, maxBundleSizeBytes, atomicBundlesPerSec))
+        {
+            return 1;
+        }
+        LOG_INFO(subprocess) << numProducers << " producer thread(s), " << (numBundlesPerProducer * numProducers)
+            << " bundles (million reserve+ack/sec, mutex -> atomic): " << (mutexBundlesPerSec * 1e-6) << " -> " << (atomicBundlesPerSec * 1e-6)
+            << " (" << (atomicBundlesPerSec / mutexBundlesPerSec) << "x)";
+    }
+    return 0;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file TestIngressAdmissionController.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "IngressAdmissionController.h"
+
+using namespace hdtn;
+
+BOOST_AUTO_TEST_CASE(IngressAdmissionControllerTestCase)
+{
+    typedef IngressAdmissionController::DECISION DECISION;
+    {
+        IngressAdmissionController controller(90, 0);
+        //expired bundles are dropped whatever their priority
+        BOOST_REQUIRE(controller.Admit(1, 2, true, 100, 1000) == DECISION::DROP);
+        //expedited and normal bundles wait for the pipelines, bulk bundles do not
+        BOOST_REQUIRE(controller.Admit(1, 2, false, 100, 1000) == DECISION::ADMIT);
+        BOOST_REQUIRE(controller.Admit(1, 1, false, 100, 1000) == DECISION::ADMIT);
+        BOOST_REQUIRE(controller.Admit(1, 0, false, 100, 1000) == DECISION::ADMIT_WITHOUT_WAITING);
+        controller.RecordEarlyDrop(50);
+        BOOST_REQUIRE_EQUAL(controller.GetNumBundlesDropped(), 2);
+        BOOST_REQUIRE_EQUAL(controller.GetNumBytesDropped(), 150);
+
+        //storage refuses the bundles that are not expedited once full
+        BOOST_REQUIRE(!controller.RefuseStorage(0, 100));
+        controller.SetStorageUsedPercent(89);
+        BOOST_REQUIRE(!controller.RefuseStorage(1, 100));
+        controller.SetStorageUsedPercent(90);
+        BOOST_REQUIRE_EQUAL(controller.GetStorageUsedPercent(), 90);
+        BOOST_REQUIRE(controller.RefuseStorage(1, 100));
+        BOOST_REQUIRE(controller.RefuseStorage(0, 100));
+        BOOST_REQUIRE(!controller.RefuseStorage(2, 100));
+        BOOST_REQUIRE_EQUAL(controller.GetNumBundlesDropped(), 4);
+        BOOST_REQUIRE_EQUAL(controller.GetNumBytesDropped(), 350);
+    }
+    {
+        //normal priority bundles of a source above its rate stop waiting until the next one second window
+        IngressAdmissionController controller(101, 2);
+        BOOST_REQUIRE(controller.Admit(1, 1, false, 100, 1000) == DECISION::ADMIT);
+        BOOST_REQUIRE(controller.Admit(1, 1, false, 100, 1000) == DECISION::ADMIT);
+        BOOST_REQUIRE(controller.Admit(1, 1, false, 100, 1000) == DECISION::ADMIT_WITHOUT_WAITING);
+        BOOST_REQUIRE(controller.Admit(1, 2, false, 100, 1000) == DECISION::ADMIT); //expedited still waits
+        BOOST_REQUIRE(controller.Admit(2, 1, false, 100, 1000) == DECISION::ADMIT); //other sources are not affected
+        BOOST_REQUIRE(controller.Admit(1, 1, false, 100, 1001) == DECISION::ADMIT);
+        //storage is never refused above 100 percent
+        controller.SetStorageUsedPercent(100);
+        BOOST_REQUIRE(!controller.RefuseStorage(0, 100));
+        BOOST_REQUIRE_EQUAL(controller.GetNumBundlesDropped(), 0);
+    }
+}
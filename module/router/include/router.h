@@ -52,7 +52,7 @@ public:
      * @param hdtnConfig The HDTN Config
      * @param hdtnDistributedConfig HDTN config for running in distributed mode
      * @param usingUnixTimestamp If true, interpret times in contact file as unix time stamps
-     * @param useMgr if true, use the MGR routing algorithm; otherwise use CGR
+     * @param useMgr kept for compatibility; both MGR and CGR compute routes with one one-to-all earliest arrival search
      * @param hdtnOneProcessZmqInprocContextPtr ZMQ context for one-process mode
      * 
      * @returns true on successful start, false on error
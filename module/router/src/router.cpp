@@ -36,8 +36,10 @@
 #include "codec/BundleViewV6.h"
 #include "codec/BundleViewV7.h"
 #include "libcgr.h"
+#include "ContactGraph.h"
 #include <unordered_map>
 #include <unordered_set>
+#include <set>
 #include <atomic>
 #include "TelemetryServer.h"
 
@@ -141,11 +143,12 @@ struct contactPlan_t {
 class OutductInfo_t {
     public:
     OutductInfo_t()
-        : outductIndex(UINT64_MAX), nextHopNodeId(UINT64_MAX), linkIsUpTimeBased(false), linkIsUpPhysical(false), linkIsUpStorage(false) {}
+        : outductIndex(UINT64_MAX), nextHopNodeId(UINT64_MAX), totalBundleBytesGivenToOutduct(0), bundleBytesInEgressQueue(0),
+          linkIsUpTimeBased(false), linkIsUpPhysical(false), linkIsUpStorage(false) {}
     OutductInfo_t(uint64_t paramOutductIndex, uint64_t paramNextHopNodeId, bool paramLinkIsUpTimeBased,
                   bool paramLinkIsUpPhysical, bool paramLinkIsUpStorage)
-        : outductIndex(paramOutductIndex), nextHopNodeId(paramNextHopNodeId), linkIsUpTimeBased(paramLinkIsUpTimeBased),
-          linkIsUpPhysical(paramLinkIsUpPhysical), linkIsUpStorage(paramLinkIsUpStorage) {}
+        : outductIndex(paramOutductIndex), nextHopNodeId(paramNextHopNodeId), totalBundleBytesGivenToOutduct(0), bundleBytesInEgressQueue(0),
+          linkIsUpTimeBased(paramLinkIsUpTimeBased), linkIsUpPhysical(paramLinkIsUpPhysical), linkIsUpStorage(paramLinkIsUpStorage) {}
 
     bool updateLinkStateTimeBased(bool val) {
         bool previouslyUp = IsUp();
@@ -183,6 +186,10 @@ class OutductInfo_t {
     /** Routes; the final destinations associated with this outduct */
     std::unordered_set<uint64_t> finalDestNodeIds;
 
+    /** Volume as last reported by egress */
+    uint64_t totalBundleBytesGivenToOutduct;
+    uint64_t bundleBytesInEgressQueue;
+
     private:
 
     bool linkIsUpTimeBased;
@@ -212,6 +219,7 @@ private:
     bool ProcessContactsFile(const boost::filesystem::path& jsonEventFilePath);
 
     void PopulateMapsFromAllOutductCapabilitiesTelemetry(const AllOutductCapabilitiesTelemetry_t& aoct);
+    void UpdateOutductVolumesFromAllOutductCapabilitiesTelemetry(const AllOutductCapabilitiesTelemetry_t& aoct);
     void HandlePhysicalLinkStatusChange(const hdtn::LinkStatusHdr& linkStatusHdr);
 
     void NotifyEgressOfTimeBasedLinkChange(uint64_t outductArrayIndex, uint64_t rateBps, bool linkIsUpTimeBased);
@@ -236,9 +244,12 @@ private:
     void SendRouteUpdate(uint64_t nextHopNodeId, uint64_t finalDestNodeId);
 
     void UpdateRouteState(uint64_t oldNextHop, uint64_t newNextHop, uint64_t finalDest);
-    void FilterContactPlan(uint64_t sourceNode, std::vector<cgr::Contact> & contact_plan);
+    void SuppressFailedContacts(uint64_t sourceNode);
+    void BookContactVolumes(uint64_t sourceNode);
     void ComputeAllRoutes(uint64_t sourceNode);
-    uint64_t ComputeOptimalRoute(uint64_t sourceNode, uint64_t finalDestNodeId);
+    void ComputeRoutesFromSource(uint64_t sourceNode);
+    uint64_t GetComputedNextHop(uint64_t finalDestNodeId) const;
+    bool UpdateMultipathNextHops(uint64_t sourceNode, uint64_t finalDest, uint64_t nextHop);
     void ComputeOptimalRoutesForOutductIndex(uint64_t sourceNode, uint64_t outductIndex);
     OutductInfo_t* GetOutductInfo(uint64_t outductArrayIndex);
 
@@ -300,11 +311,19 @@ private:
     uint64_t m_bundleSequence;
 
     // Routing
-    bool m_usingMGR;
     uint64_t m_latestTime;
     std::vector<cgr::Contact> m_cgrContacts;
+    // Built once per contact plan from m_cgrContacts, and the reused working area of its searches
+    cgr::ContactGraph m_contactGraph;
+    cgr::ContactGraphSearch m_contactGraphSearch;
+    // Bundle bytes egress gave the outducts during each contact leaving this node (indexed like m_contactGraph's contacts)
+    std::vector<uint64_t> m_contactBytesForwarded;
     // Map of final destination node ids to next hops
     std::unordered_map<uint64_t, uint64_t> m_routes;
+    // Multipath (routerMaxMultipathRoutes >= 2): the weighted next hops, optimal next hop first, of the final destinations
+    // whose bulk flows egress splits across simultaneous contacts (from 2 to HDTN_MAX_MULTIPATH_NEXT_HOPS next hops)
+    typedef std::vector<std::pair<uint64_t, uint64_t> > weighted_next_hops_t; //(next hop node id, weight)
+    std::unordered_map<uint64_t, weighted_next_hops_t> m_multipathNextHops;
 
     // Storage full tracking
     boost::bimap <ptime_index_pair_t, uint64_t> m_storageExpirationTimes;
@@ -346,7 +365,6 @@ Router::Impl::Impl() :
     m_workerThreadStartupInProgress(false),
     m_lastMillisecondsSinceStartOfYear2000(0),
     m_bundleSequence(0),
-    m_usingMGR(false),
     m_latestTime(0),
     m_storageFullTimer(m_ioService),
     m_storageFullTimerIsRunning(false) {}
@@ -429,7 +447,10 @@ bool Router::Impl::Init(const HdtnConfig& hdtnConfig,
     m_hdtnConfig = hdtnConfig;
     m_contactPlanFilePath = contactPlanFilePath;
     m_usingUnixTimestamp = usingUnixTimestamp;
-    m_usingMGR = useMgr;
+    if (useMgr) {
+        //the one-to-all search is already a node (multigraph) based search, so both find the same earliest arrival routes
+        LOG_INFO(subprocess) << "useMgr: routes to all destinations are computed by a single one-to-all search (the same search as without useMgr)";
+    }
 
     m_receivedInitialOutductTelem = false;
     m_outductInfoInitialized = false;
@@ -688,6 +709,10 @@ void Router::Impl::EgressEventsHandler() {
                     boost::asio::post(m_ioService, boost::bind(&Router::Impl::PopulateMapsFromAllOutductCapabilitiesTelemetry,
                                                                this, std::move(aoct)));
                 }
+                else {
+                    boost::asio::post(m_ioService, boost::bind(&Router::Impl::UpdateOutductVolumesFromAllOutductCapabilitiesTelemetry,
+                                                               this, std::move(aoct)));
+                }
         }
     }
     else if (linkStatusHdr.base.type == HDTN_MSGTYPE_BUNDLES_TO_ROUTER) {
@@ -1233,6 +1258,7 @@ bool Router::Impl::ProcessContacts(const boost::property_tree::ptree& pt) {
         }
     }
     m_routes.clear();
+    m_multipathNextHops.clear();
 
     m_ptimeToContactPlanBimap.clear(); //clear the map
 
@@ -1292,6 +1318,11 @@ bool Router::Impl::ProcessContacts(const boost::property_tree::ptree& pt) {
     // Ensure we don't include contacts with our node ID and a next hop that's not in our outducts
     const boost::property_tree::ptree filteredPtree = FilterContactsPropertyTree(contactsPt);
     m_cgrContacts = cgr::cp_load(filteredPtree);
+    m_contactGraph = cgr::ContactGraph(m_cgrContacts);
+    m_contactGraphSearch = cgr::ContactGraphSearch(); //its results and suppressed contacts refer to the previous graph
+    m_contactBytesForwarded.assign(m_contactGraph.get_num_contacts(), 0);
+    LOG_INFO(subprocess) << "Contact graph built with " << m_contactGraph.get_num_contacts() << " contacts between "
+        << m_contactGraph.get_num_nodes() << " nodes";
 
     LOG_INFO(subprocess) << "Epoch Time:  " << m_epoch;
 
@@ -1415,10 +1446,61 @@ void Router::Impl::PopulateMapsFromAllOutductCapabilitiesTelemetry(const AllOutd
             std::piecewise_construct,
             std::forward_as_tuple(oct.outductArrayIndex),
             std::forward_as_tuple(oct.outductArrayIndex, oct.nextHopNodeId, false, initLinkIsUpPhysical, true));
+        OutductInfo_t& info = m_mapOutductArrayIndexToOutductInfo[oct.outductArrayIndex];
+        info.totalBundleBytesGivenToOutduct = oct.totalBundleBytesGivenToOutduct;
+        info.bundleBytesInEgressQueue = oct.bundleBytesInEgressQueue;
     }
     m_outductInfoInitialized = true;
 }
 
+/** Consume contact volume as egress reports it
+ *
+ * The bundle bytes given to an outduct since its last report are consumed from
+ * the contact to its next hop active now, and its egress queue backlog
+ * is booked on its next contacts by the route searches (see BookContactVolumes).
+ * If the volumes changed, recompute the routes, which then route around oversubscribed contacts.
+ */
+void Router::Impl::UpdateOutductVolumesFromAllOutductCapabilitiesTelemetry(const AllOutductCapabilitiesTelemetry_t& aoct) {
+    if (!m_outductInfoInitialized) {
+        return;
+    }
+    m_latestTime = TimestampUtil::GetSecondsSinceEpochUnix() - m_subtractMeFromUnixTimeSecondsToConvertToRouterTimeSeconds;
+    const cgr::ContactGraph::node_index_t sourceIndex = m_contactGraph.get_node_index(m_hdtnConfig.m_myNodeId);
+    bool volumesChanged = false;
+    for (std::list<OutductCapabilityTelemetry_t>::const_iterator itAoct = aoct.outductCapabilityTelemetryList.cbegin();
+        itAoct != aoct.outductCapabilityTelemetryList.cend(); ++itAoct)
+    {
+        const OutductCapabilityTelemetry_t& oct = *itAoct;
+        std::map<uint64_t, OutductInfo_t>::iterator it = m_mapOutductArrayIndexToOutductInfo.find(oct.outductArrayIndex);
+        if (it == m_mapOutductArrayIndexToOutductInfo.end()) {
+            continue;
+        }
+        OutductInfo_t& info = it->second;
+        // A total lower than the last one means egress restarted
+        const uint64_t bytesForwarded = (oct.totalBundleBytesGivenToOutduct >= info.totalBundleBytesGivenToOutduct) ?
+            (oct.totalBundleBytesGivenToOutduct - info.totalBundleBytesGivenToOutduct) : oct.totalBundleBytesGivenToOutduct;
+        volumesChanged |= (bytesForwarded != 0) || (oct.bundleBytesInEgressQueue != info.bundleBytesInEgressQueue);
+        info.totalBundleBytesGivenToOutduct = oct.totalBundleBytesGivenToOutduct;
+        info.bundleBytesInEgressQueue = oct.bundleBytesInEgressQueue;
+        if ((bytesForwarded == 0) || (sourceIndex == cgr::ContactGraph::INVALID_NODE_INDEX)) {
+            continue;
+        }
+        const cgr::ContactGraph::contact_index_t end = m_contactGraph.contacts_end(sourceIndex);
+        for (cgr::ContactGraph::contact_index_t i = m_contactGraph.contacts_begin(sourceIndex); i < end; ++i) {
+            const cgr::ContactGraph::CompiledContact& contact = m_contactGraph.get_contact(i);
+            if ((m_contactGraph.get_node_id(contact.to_index) == info.nextHopNodeId)
+                && (static_cast<uint64_t>(contact.start) <= m_latestTime) && (m_latestTime < static_cast<uint64_t>(contact.end)))
+            {
+                m_contactBytesForwarded[i] += bytesForwarded;
+                break;
+            }
+        }
+    }
+    if (volumesChanged && (sourceIndex != cgr::ContactGraph::INVALID_NODE_INDEX)) {
+        ComputeAllRoutes(m_hdtnConfig.m_myNodeId);
+    }
+}
+
 /** Respond to physical link status change from egress
  *
  * Update state tracking in outduct info
@@ -1477,6 +1559,16 @@ void Router::Impl::SendRouteUpdate(uint64_t nextHopNodeId, uint64_t finalDestNod
     routingMsg.base.type = HDTN_MSGTYPE_ROUTEUPDATE;
     routingMsg.nextHopNodeId = nextHopNodeId;
     routingMsg.finalDestNodeId = finalDestNodeId;
+    std::unordered_map<uint64_t, weighted_next_hops_t>::const_iterator multipathIt = m_multipathNextHops.find(finalDestNodeId);
+    if ((nextHopNodeId != HDTN_NOROUTE) && (multipathIt != m_multipathNextHops.cend())) {
+        const weighted_next_hops_t& nextHops = multipathIt->second;
+        routingMsg.numMultipathNextHops = nextHops.size();
+        for (std::size_t i = 0; i < nextHops.size(); ++i) {
+            routingMsg.multipathNextHopNodeIds[i] = nextHops[i].first;
+            routingMsg.multipathWeights[i] = nextHops[i].second;
+            LOG_INFO(subprocess) << "  multipath next hop: " << nextHops[i].first << " weight: " << nextHops[i].second;
+        }
+    }
 
     while (m_running.load(std::memory_order_acquire) && !m_zmqPushSock_connectingRouterToBoundEgressPtr->send(
         zmq::const_buffer(&routingMsg, sizeof(hdtn::RouteUpdateHdr)),
@@ -1496,6 +1588,11 @@ void Router::Impl::RerouteOnLinkDown(uint64_t prevHopNodeId, uint64_t outductArr
         LOG_ERROR(subprocess) << "out of order command, received link down before receiving outduct capabilities";
         return;
     }
+    if (m_hdtnConfig.m_routerMaxMultipathRoutes >= 2) {
+        // The outduct may also be a multipath next hop of final destinations routed through other outducts
+        ComputeAllRoutes(prevHopNodeId);
+        return;
+    }
     ComputeOptimalRoutesForOutductIndex(prevHopNodeId, outductArrayIndex);
 }
 
@@ -1512,51 +1609,81 @@ void Router::Impl::RerouteOnLinkUp(uint64_t prevHopNodeId) {
 void Router::Impl::HandleBundle() {
 }
 
-/** Filter "failed" contacts
+/** Suppress "failed" contacts
  *
- * Remove from the contact plan contacts which are active (i.e.
+ * Exclude from the route searches the contacts which are active (i.e.
  * happening now), have this node as the source, and for which
  * the link to the neighbor node is down
  *
- * @param contactPlan - the contact plan to modify in-place
+ * @param sourceNode - the source node of the contacts
  */
-void Router::Impl::FilterContactPlan(uint64_t sourceNode, std::vector<cgr::Contact> & contactPlan) {
+void Router::Impl::SuppressFailedContacts(uint64_t sourceNode) {
 
-    std::size_t i = 0;
-    while(i < contactPlan.size()) {
-        const cgr::Contact & contact = contactPlan[i];
+    m_contactGraphSearch.clear_suppressed_contacts();
+    const cgr::ContactGraph::node_index_t sourceIndex = m_contactGraph.get_node_index(sourceNode);
+    if (sourceIndex == cgr::ContactGraph::INVALID_NODE_INDEX) {
+        return;
+    }
+    const cgr::ContactGraph::contact_index_t end = m_contactGraph.contacts_end(sourceIndex);
+    for (cgr::ContactGraph::contact_index_t i = m_contactGraph.contacts_begin(sourceIndex); i < end; ++i) {
+        const cgr::ContactGraph::CompiledContact & contact = m_contactGraph.get_contact(i);
 
-        // Don't remove if not "active"
+        // Don't suppress if not "active"
         // TODO should these time bounds be inclusive or not?
         if(!(static_cast<uint64_t>(contact.start) <= m_latestTime && m_latestTime <= static_cast<uint64_t>(contact.end))) {
-            ++i;
-            continue;
-        }
-
-        // Don't remove if we're not the source
-        if(contact.frm != sourceNode) {
-            ++i;
             continue;
         }
 
-        // Don't remove if not associated with one of our outducts
-        if(m_mapNextHopNodeIdToOutductArrayIndex.count(contact.to) == 0) {
-            ++i;
+        // Don't suppress if not associated with one of our outducts
+        std::map<uint64_t, uint64_t>::const_iterator it = m_mapNextHopNodeIdToOutductArrayIndex.find(m_contactGraph.get_node_id(contact.to_index));
+        if(it == m_mapNextHopNodeIdToOutductArrayIndex.cend()) {
             continue;
         }
-        uint64_t outduct_index = m_mapNextHopNodeIdToOutductArrayIndex[contact.to];
-        const OutductInfo_t & info = m_mapOutductArrayIndexToOutductInfo[outduct_index];
+        const OutductInfo_t & info = m_mapOutductArrayIndexToOutductInfo[it->second];
 
         // Skip if up
         if(info.IsUp()) {
-            ++i;
             continue;
         }
 
         // Otherwise: active contact that's not up due to either
         // physical link down, storage full, or API command
-        // remove contact from contact plan to re-route around down node
-        contactPlan.erase(contactPlan.begin() + i);
+        // suppress contact to re-route around down node
+        m_contactGraphSearch.suppress_contact(m_contactGraph, i);
+    }
+}
+
+/** Book the volume already used on contacts
+ *
+ * Book on each contact, which has this node as the source and is not over,
+ * the bundle bytes forwarded during it, and book the egress queue backlog
+ * of its outduct on the first of them to each neighbor.  The route searches
+ * then account for the time these take to transmit at the contact rate.
+ *
+ * @param sourceNode - the source node of the contacts
+ */
+void Router::Impl::BookContactVolumes(uint64_t sourceNode) {
+
+    m_contactGraphSearch.clear_booked_volumes();
+    const cgr::ContactGraph::node_index_t sourceIndex = m_contactGraph.get_node_index(sourceNode);
+    if (sourceIndex == cgr::ContactGraph::INVALID_NODE_INDEX) {
+        return;
+    }
+    std::set<uint64_t> outductsWithBookedBacklog;
+    const cgr::ContactGraph::contact_index_t end = m_contactGraph.contacts_end(sourceIndex);
+    for (cgr::ContactGraph::contact_index_t i = m_contactGraph.contacts_begin(sourceIndex); i < end; ++i) {
+        const cgr::ContactGraph::CompiledContact & contact = m_contactGraph.get_contact(i);
+        if (static_cast<uint64_t>(contact.end) <= m_latestTime) {
+            continue;
+        }
+        uint64_t bookedBytes = m_contactBytesForwarded[i];
+        std::map<uint64_t, uint64_t>::const_iterator it = m_mapNextHopNodeIdToOutductArrayIndex.find(m_contactGraph.get_node_id(contact.to_index));
+        if ((it != m_mapNextHopNodeIdToOutductArrayIndex.cend()) && outductsWithBookedBacklog.insert(it->second).second) {
+            bookedBytes += m_mapOutductArrayIndexToOutductInfo[it->second].bundleBytesInEgressQueue;
+        }
+        if (bookedBytes) {
+            m_contactGraphSearch.book_volume(m_contactGraph, i, bookedBytes * 8); // contact plan rates are in bits per second
+        }
     }
 }
 
@@ -1604,20 +1731,25 @@ void Router::Impl::UpdateRouteState(uint64_t oldNextHop, uint64_t newNextHop, ui
  */
 void Router::Impl::ComputeAllRoutes(uint64_t sourceNode) {
 
+    ComputeRoutesFromSource(sourceNode);
+
     for (std::unordered_map<uint64_t, uint64_t>::iterator it = m_routes.begin();
         it != m_routes.end(); ++it)
     {
         uint64_t finalDest = it->first;
         uint64_t origNextHop = it->second;
-        uint64_t newNextHop = ComputeOptimalRoute(sourceNode, finalDest);
+        uint64_t newNextHop = GetComputedNextHop(finalDest);
+        const bool multipathChanged = UpdateMultipathNextHops(sourceNode, finalDest, newNextHop);
 
-        if (newNextHop == origNextHop) {
+        if ((newNextHop == origNextHop) && !multipathChanged) {
             LOG_DEBUG(subprocess) << "Skipping Computed next hop: " << routeToStr(newNextHop)
                                   << " for final Destination " << finalDest << " because the next hops didn't change.";
             continue;
         }
 
-        UpdateRouteState(origNextHop, newNextHop, finalDest);
+        if (newNextHop != origNextHop) {
+            UpdateRouteState(origNextHop, newNextHop, finalDest);
+        }
 
         LOG_INFO(subprocess) << "Route updated: finalDest " << finalDest << " -> nextHop "
                              << routeToStr(newNextHop) << ", (was " << routeToStr(origNextHop) << ")";
@@ -1643,15 +1775,21 @@ void Router::Impl::ComputeOptimalRoutesForOutductIndex(uint64_t sourceNode, uint
 
     OutductInfo_t &info = it->second;
     const uint64_t origNextHop = info.nextHopNodeId;
+    if (info.finalDestNodeIds.empty()) {
+        return;
+    }
+
+    ComputeRoutesFromSource(sourceNode);
 
     std::unordered_set<uint64_t>::iterator destIt = info.finalDestNodeIds.begin();
     while(destIt!= info.finalDestNodeIds.end()) {
         const uint64_t finalDest = *destIt;
         ++destIt;
 
-        uint64_t newNextHop = ComputeOptimalRoute(sourceNode, finalDest);
+        uint64_t newNextHop = GetComputedNextHop(finalDest);
+        const bool multipathChanged = UpdateMultipathNextHops(sourceNode, finalDest, newNextHop);
 
-        if (newNextHop == origNextHop) {
+        if ((newNextHop == origNextHop) && !multipathChanged) {
             LOG_DEBUG(subprocess) << "Skipping Computed next hop: " << routeToStr(newNextHop)
                                   << " for final Destination " << finalDest << " because the next hops didn't change.";
             continue;
@@ -1660,49 +1798,120 @@ void Router::Impl::ComputeOptimalRoutesForOutductIndex(uint64_t sourceNode, uint
                              << routeToStr(newNextHop) << ", (was " << routeToStr(origNextHop) << ")";
 
         // Update will invalidate current iterator, so move on to next first
-        UpdateRouteState(origNextHop, newNextHop, finalDest);
+        if (newNextHop != origNextHop) {
+            UpdateRouteState(origNextHop, newNextHop, finalDest);
+        }
         SendRouteUpdate(newNextHop, finalDest);
     }
 }
 
-/** Compute optimal route to destination
+/** Compute the optimal routes to all destinations
  *
- * @param sourceNode the starting node for the route
- * @param the final destination node ID
+ * @param sourceNode the starting node for the routes
  *
- * @returns The next hop node ID or HDTN_NOROUTE if no route found
+ * A single one-to-all earliest arrival search over the contact graph (built when the contact plan was loaded)
+ * replaces one CGR (or CMR) search per destination. Read the results with GetComputedNextHop.
+ * After the first search, the search tree is repaired: only the routes affected by the time
+ * elapsed or by the contacts suppressed (or unsuppressed) since are recomputed.
  */
-uint64_t Router::Impl::ComputeOptimalRoute(uint64_t sourceNode, uint64_t finalDestNodeId) {
-
-    cgr::Route bestRoute;
+void Router::Impl::ComputeRoutesFromSource(uint64_t sourceNode) {
 
-    // Make copy here to filter
-    std::vector<cgr::Contact> contactPlan = m_cgrContacts;
+    // Suppressing contacts and booking volume only affect the searches, not the contact graph
+    SuppressFailedContacts(sourceNode);
+    BookContactVolumes(sourceNode);
 
-    // The contact plan here is a copy of the actual contact plan,
-    // filtering only affects this instance of this function call
-    FilterContactPlan(sourceNode, contactPlan);
+    m_contactGraphSearch.repair(m_contactGraph, sourceNode, static_cast<time_t>(m_latestTime));
+    LOG_INFO(subprocess) << "Computed Optimal Routes to all destinations at latest time " << m_latestTime
+        << " (" << m_contactGraphSearch.get_num_nodes_searched() << " of " << m_contactGraph.get_num_nodes() << " nodes searched)";
+}
 
-    cgr::Contact rootContact = cgr::Contact(sourceNode,
-        sourceNode, 0, cgr::MAX_TIME_T, 100, 1.0, 0);
-    rootContact.arrival_time = m_latestTime;
-    if (!m_usingMGR) {
-        LOG_INFO(subprocess) << "Computing Optimal Route using CGR dijkstra for final Destination "
-            << finalDestNodeId << " at latest time " << rootContact.arrival_time;
-        bestRoute = cgr::dijkstra(&rootContact, finalDestNodeId, contactPlan);
+/** Get the next hop computed by the last ComputeRoutesFromSource
+ *
+ * @param finalDestNodeId the final destination node ID
+ *
+ * @returns The next hop node ID or HDTN_NOROUTE if no route found
+ */
+uint64_t Router::Impl::GetComputedNextHop(uint64_t finalDestNodeId) const {
+    const cgr::ContactGraph::node_index_t destIndex = m_contactGraph.get_node_index(finalDestNodeId);
+    if ((destIndex == cgr::ContactGraph::INVALID_NODE_INDEX) || (!m_contactGraphSearch.has_route(destIndex))) {
+        return HDTN_NOROUTE;
     }
-    else {
-        LOG_INFO(subprocess) << "Computing Optimal Route using CMR algorithm for final Destination "
-            << finalDestNodeId << " at latest time " << rootContact.arrival_time;
-        bestRoute = cgr::cmr_dijkstra(&rootContact,
-            finalDestNodeId, contactPlan);
+    return m_contactGraphSearch.get_next_node(destIndex);
+}
+
+/** Update the next hops across which the bulk flows to a final destination are split
+ *
+ * @param sourceNode the source node ID for the routes
+ * @param finalDest the final destination node ID
+ * @param nextHop the next hop computed by the last ComputeRoutesFromSource (or HDTN_NOROUTE)
+ *
+ * With routerMaxMultipathRoutes of 2 or more, the K best routes (Yen's algorithm) are computed,
+ * and the next hops of those that start with a contact active now, through an outduct that is up,
+ * are weighted by the rate of that contact (the optimal next hop first).
+ * Without such simultaneous contacts to at least two next hops, including the optimal one,
+ * every bundle goes to the optimal next hop.
+ *
+ * @returns True if the multipath next hops of the final destination changed
+ */
+bool Router::Impl::UpdateMultipathNextHops(uint64_t sourceNode, uint64_t finalDest, uint64_t nextHop) {
+    weighted_next_hops_t nextHops;
+    if ((m_hdtnConfig.m_routerMaxMultipathRoutes >= 2) && (nextHop != HDTN_NOROUTE)) {
+        std::vector<cgr::Route> routes = cgr::yen(sourceNode, finalDest, static_cast<int>(m_latestTime), m_cgrContacts,
+            static_cast<int>(m_hdtnConfig.m_routerMaxMultipathRoutes));
+        bool hasNextHop = false;
+        for (cgr::Route& route : routes) {
+            const cgr::Contact firstHop = route.get_hops().front();
+            if (!((static_cast<uint64_t>(firstHop.start) <= m_latestTime) && (m_latestTime < static_cast<uint64_t>(firstHop.end)))) {
+                continue;
+            }
+            std::map<uint64_t, uint64_t>::const_iterator it = m_mapNextHopNodeIdToOutductArrayIndex.find(firstHop.to);
+            if ((it == m_mapNextHopNodeIdToOutductArrayIndex.cend()) || (!m_mapOutductArrayIndexToOutductInfo[it->second].IsUp())) {
+                continue;
+            }
+            bool isDuplicate = false;
+            for (const std::pair<uint64_t, uint64_t>& weightedNextHop : nextHops) {
+                isDuplicate = isDuplicate || (weightedNextHop.first == firstHop.to);
+            }
+            if (isDuplicate) {
+                continue;
+            }
+            if (firstHop.to == nextHop) {
+                nextHops.emplace(nextHops.begin(), firstHop.to, firstHop.rate);
+                hasNextHop = true;
+            }
+            else {
+                nextHops.emplace_back(firstHop.to, firstHop.rate);
+            }
+        }
+        if (!hasNextHop) {
+            nextHops.clear();
+        }
+        if (nextHops.size() > HDTN_MAX_MULTIPATH_NEXT_HOPS) {
+            nextHops.resize(HDTN_MAX_MULTIPATH_NEXT_HOPS);
+        }
+        if (nextHops.size() < 2) {
+            nextHops.clear();
+        }
     }
 
-    if (bestRoute.valid()) { // successfully computed a route
-        return bestRoute.next_node;
-   } else {
-        return HDTN_NOROUTE;
+    std::unordered_map<uint64_t, weighted_next_hops_t>::iterator it = m_multipathNextHops.find(finalDest);
+    if (it == m_multipathNextHops.end()) {
+        if (nextHops.empty()) {
+            return false;
+        }
+        m_multipathNextHops.emplace(finalDest, std::move(nextHops));
+        return true;
     }
+    if (it->second == nextHops) {
+        return false;
+    }
+    if (nextHops.empty()) {
+        m_multipathNextHops.erase(it);
+    }
+    else {
+        it->second = std::move(nextHops);
+    }
+    return true;
 }
 
 /**
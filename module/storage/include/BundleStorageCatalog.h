@@ -22,6 +22,7 @@
 
 #include <cstdint>
 #include <map>
+#include <set>
 #include "ForwardListQueue.h"
 #include <array>
 #include <vector>
@@ -29,7 +30,7 @@
 #include <string>
 #include "MemoryManagerTreeArray.h"
 #include "codec/PrimaryBlock.h"
-#include "HashMap16BitFixedSize.h"
+#include "HashMapOpenAddressing.h"
 #include <boost/bimap.hpp>
 #include <boost/date_time.hpp>
 #include "CatalogEntry.h"
@@ -40,11 +41,39 @@
 typedef ForwardListQueue<uint64_t> custids_flist_queue_t;
 typedef std::map<uint64_t, custids_flist_queue_t> expirations_to_custids_map_t;
 typedef std::array<expirations_to_custids_map_t, NUMBER_OF_PRIORITIES> priorities_to_expirations_array_t;
-typedef std::map<cbhe_eid_t, priorities_to_expirations_array_t> dest_eid_to_priorities_map_t;
+struct awaiting_send_group_t;
+struct awaiting_send_dest_t {
+    STORAGE_LIB_EXPORT awaiting_send_dest_t();
 
-typedef HashMap16BitFixedSize<cbhe_bundle_uuid_t, uint64_t> uuid_to_custid_hashmap_t; //get the cteb custody id from fragmented bundle uuid
-typedef HashMap16BitFixedSize<cbhe_bundle_uuid_nofragment_t, uint64_t> uuidnofrag_to_custid_hashmap_t; //get the cteb custody id from non-fragmented bundle uuid
-typedef HashMap16BitFixedSize<uint64_t, catalog_entry_t> custid_to_catalog_entry_hashmap_t; //get the catalog entry from cteb custody id
+    priorities_to_expirations_array_t priorityArray;
+    //the next bundle to send to this destination (as currently indexed by groupPtrs)
+    bool hasHead;
+    uint64_t headPriorityRank; //NUMBER_OF_PRIORITIES - 1 - priority index, so that the lowest rank is sent first
+    uint64_t headExpiration;
+    const cbhe_eid_t * eidPtr; //key of this destination in m_destEidToPrioritiesMap
+    std::vector<awaiting_send_group_t*> groupPtrs; //the awaiting send groups which contain this destination
+};
+typedef std::map<cbhe_eid_t, awaiting_send_dest_t> dest_eid_to_priorities_map_t;
+
+//An awaiting send group (e.g. one per outduct) keeps the next bundle of each of its non-empty destinations
+//in an ordered set so that popping the highest priority, soonest expiring bundle across all of its destinations
+//is O(log n) in the number of destinations instead of a scan of every destination at every priority.
+struct awaiting_send_group_head_t {
+    uint64_t priorityRank;
+    uint64_t expiration;
+    awaiting_send_dest_t * destPtr;
+    STORAGE_LIB_EXPORT bool operator<(const awaiting_send_group_head_t & o) const; //ties on priority and expiration are broken by destination eid
+};
+struct awaiting_send_group_t {
+    std::vector<std::pair<cbhe_eid_t, bool> > availableDests; //pair bool = true for any service ids
+    std::vector<awaiting_send_dest_t*> memberDestPtrs;
+    std::set<awaiting_send_group_head_t> heads; //begin() is the next bundle to send
+};
+typedef std::map<uint64_t, awaiting_send_group_t> group_id_to_awaiting_send_group_map_t;
+
+typedef HashMapOpenAddressing<cbhe_bundle_uuid_t, uint64_t> uuid_to_custid_hashmap_t; //get the cteb custody id from fragmented bundle uuid
+typedef HashMapOpenAddressing<cbhe_bundle_uuid_nofragment_t, uint64_t> uuidnofrag_to_custid_hashmap_t; //get the cteb custody id from non-fragmented bundle uuid
+typedef HashMapOpenAddressing<uint64_t, catalog_entry_t> custid_to_catalog_entry_hashmap_t; //get the catalog entry from cteb custody id
 typedef boost::bimap<uint64_t, boost::posix_time::ptime> custid_to_custody_xfer_expiry_bimap_t;
 
 class BundleStorageCatalog {
@@ -58,10 +87,19 @@ public:
     STORAGE_LIB_EXPORT ~BundleStorageCatalog();
 
     STORAGE_LIB_EXPORT bool CatalogIncomingBundleForStore(catalog_entry_t & catalogEntryToTake, const PrimaryBlock & primary, const uint64_t custodyId, const DUPLICATE_EXPIRY_ORDER order);
+    //for bundles whose primary block is no longer available (e.g. replayed from the catalog journal); bundleUuid is ignored if the entry has no custody
+    STORAGE_LIB_EXPORT bool CatalogIncomingBundleForStore(catalog_entry_t & catalogEntryToTake, const cbhe_bundle_uuid_t & bundleUuid, const uint64_t custodyId, const DUPLICATE_EXPIRY_ORDER order);
 
     STORAGE_LIB_EXPORT catalog_entry_t * PopEntryFromAwaitingSend(uint64_t & custodyId, const std::vector<cbhe_eid_t> & availableDestEids);
     STORAGE_LIB_EXPORT catalog_entry_t * PopEntryFromAwaitingSend(uint64_t & custodyId, const std::vector<uint64_t> & availableDestNodeIds);
     STORAGE_LIB_EXPORT catalog_entry_t * PopEntryFromAwaitingSend(uint64_t & custodyId, const std::vector<std::pair<cbhe_eid_t, bool> > & availableDests);
+
+    //indexed alternative to PopEntryFromAwaitingSend for callers that pop repeatedly from the same destinations (e.g. an outduct),
+    //where availableDests uses the pair bool = true for any service ids (destinations first seen after the group was added are included)
+    STORAGE_LIB_EXPORT uint64_t AddAwaitingSendGroup(const std::vector<std::pair<cbhe_eid_t, bool> > & availableDests); //returns the group id
+    STORAGE_LIB_EXPORT bool UpdateAwaitingSendGroup(const uint64_t groupId, const std::vector<std::pair<cbhe_eid_t, bool> > & availableDests);
+    STORAGE_LIB_EXPORT bool RemoveAwaitingSendGroup(const uint64_t groupId);
+    STORAGE_LIB_EXPORT catalog_entry_t * PopEntryFromAwaitingSendGroup(uint64_t & custodyId, const uint64_t groupId);
     
     STORAGE_LIB_EXPORT bool AddEntryToAwaitingSend(const catalog_entry_t & catalogEntry, const uint64_t custodyId, const DUPLICATE_EXPIRY_ORDER order);
     STORAGE_LIB_EXPORT bool ReturnEntryToAwaitingSend(const catalog_entry_t & catalogEntry, const uint64_t custodyId);
@@ -70,6 +108,8 @@ public:
     STORAGE_LIB_EXPORT catalog_entry_t * GetEntryFromCustodyId(const uint64_t custodyId);
     STORAGE_LIB_EXPORT uint64_t * GetCustodyIdFromUuid(const cbhe_bundle_uuid_t & bundleUuid);
     STORAGE_LIB_EXPORT uint64_t * GetCustodyIdFromUuid(const cbhe_bundle_uuid_nofragment_t & bundleUuid);
+    //every custody id in the catalog, those awaiting send first (in the order they would be sent for each destination, priority, and expiration)
+    STORAGE_LIB_EXPORT void GetCustodyIdsInSendOrder(std::vector<uint64_t> & custodyIds) const;
     STORAGE_LIB_EXPORT void GetExpiredBundleIds(const uint64_t expiry, const uint64_t maxNumberToFind, std::vector<uint64_t> & returnedIds);
     STORAGE_LIB_EXPORT bool GetStorageExpiringBeforeThresholdTelemetry(StorageExpiringBeforeThresholdTelemetry_t & telem);
 
@@ -83,8 +123,14 @@ public:
     STORAGE_LIB_EXPORT uint64_t GetTotalBundleByteEraseOperationsFromCatalog() const noexcept;
 
 private:
+    STORAGE_LIB_NO_EXPORT bool AddEntryToCatalog(catalog_entry_t & catalogEntryToTake, const uint64_t custodyId, const DUPLICATE_EXPIRY_ORDER order);
     STORAGE_LIB_NO_EXPORT catalog_entry_t * PopEntryFromAwaitingSend(uint64_t & custodyId,
-        const std::vector<std::pair<const cbhe_eid_t*, priorities_to_expirations_array_t *> > & destEidPlusPriorityArrayPtrs);
+        const std::vector<std::pair<const cbhe_eid_t*, awaiting_send_dest_t *> > & destEidPlusDestPtrs);
+    STORAGE_LIB_NO_EXPORT void OnAwaitingSendDestCreated(dest_eid_to_priorities_map_t::iterator destIt);
+    STORAGE_LIB_NO_EXPORT void UpdateAwaitingSendHead(awaiting_send_dest_t & dest);
+    STORAGE_LIB_NO_EXPORT void AddDestToAwaitingSendGroup(awaiting_send_dest_t & dest, awaiting_send_group_t & group);
+    STORAGE_LIB_NO_EXPORT void LinkAwaitingSendGroup(awaiting_send_group_t & group);
+    STORAGE_LIB_NO_EXPORT void UnlinkAwaitingSendGroup(awaiting_send_group_t & group);
     STORAGE_LIB_NO_EXPORT bool Insert_OrderBySequence(custids_flist_queue_t& custodyIdFlistQueue, const uint64_t custodyIdToInsert, const uint64_t mySequence);
     STORAGE_LIB_NO_EXPORT void Insert_OrderByFifo(custids_flist_queue_t& custodyIdFlistQueue, const uint64_t custodyIdToInsert);
     STORAGE_LIB_NO_EXPORT void Insert_OrderByFilo(custids_flist_queue_t& custodyIdFlistQueue, const uint64_t custodyIdToInsert);
@@ -92,6 +138,10 @@ private:
 
 protected:
     dest_eid_to_priorities_map_t m_destEidToPrioritiesMap;
+    group_id_to_awaiting_send_group_map_t m_awaitingSendGroups;
+    std::map<cbhe_eid_t, std::vector<awaiting_send_group_t*> > m_awaitingSendGroupPtrsByDestEid; //fully qualified group destinations
+    std::map<uint64_t, std::vector<awaiting_send_group_t*> > m_awaitingSendGroupPtrsByWildcardNodeId; //any service id group destinations
+    uint64_t m_nextAwaitingSendGroupId;
     uuid_to_custid_hashmap_t m_uuidToCustodyIdHashMap;
     uuidnofrag_to_custid_hashmap_t m_uuidNoFragToCustodyIdHashMap;
     custid_to_catalog_entry_hashmap_t m_custodyIdToCatalogEntryHashmap;
@@ -48,6 +48,9 @@ typedef uint64_t segment_id_t;
 #error "STORAGE_SEGMENT_ID_SIZE_BITS is defined but not set to 32 or 64"
 #endif
 #define SEGMENT_ID_LAST SEGMENT_ID_FULL
+//multi-segment bundles search this many segment ids past the first free one for a run of consecutive free segments
+//(so they can be written contiguously on each disk) before falling back to the first free segments
+#define MEMORY_MANAGER_CONTIGUOUS_SEARCH_MAX_SEGMENTS (64 * 4096)
 
 
 
@@ -66,6 +69,9 @@ typedef uint64_t segment_id_t;
 #define SEGMENT_RESERVED_SPACE (sizeof(uint64_t) + sizeof(uint64_t) + sizeof(segment_id_t) + sizeof(uint64_t))
 #define BUNDLE_STORAGE_PER_SEGMENT_SIZE (SEGMENT_SIZE - SEGMENT_RESERVED_SPACE)
 #define READ_CACHE_NUM_SEGMENTS_PER_SESSION 50
+//direct I/O (O_DIRECT) requires memory buffers, file offsets, and lengths to be aligned to the disk's logical block size.
+//SEGMENT_SIZE is always a multiple of this, so only the segment buffers themselves need aligned allocation.
+#define STORAGE_DIRECT_IO_ALIGNMENT_BYTES 4096
 
 #ifdef _MSC_VER //Windows tests
 //#define FILE_SIZE (1024000000ULL * 1) //1 GByte total of files, or file_size / num_threads size per file
@@ -23,6 +23,7 @@
 
 #include "BundleStorageManagerBase.h"
 #include <boost/asio.hpp>
+#include <array>
 
 
 
@@ -37,8 +38,9 @@ public:
 
 private:
     STORAGE_LIB_NO_EXPORT void TryDiskOperation_Consume_NotThreadSafe(const unsigned int diskId);
+    STORAGE_LIB_NO_EXPORT std::array<boost::asio::mutable_buffer, 2> ReadBuffers(const unsigned int diskId, const unsigned int cbPtrIndex, uint8_t * const readFromStorageDestPointer) const;
     STORAGE_LIB_NO_EXPORT void HandleDiskOperationCompleted(const boost::system::error_code& error, std::size_t bytes_transferred,
-        const unsigned int diskId, const unsigned int consumeIndex, const bool wasReadOperation);
+        const unsigned int diskId, const unsigned int consumeIndex, const unsigned int numSlotsConsumed, const bool wasReadOperation);
 
     STORAGE_LIB_NO_EXPORT virtual void CommitWriteAndNotifyDiskOfWorkToDo_ThreadSafe(const unsigned int diskId) override;
 
@@ -55,6 +57,7 @@ private:
 #endif
 
     std::vector<bool> m_diskOperationInProgressVec;
+    std::vector<bool> m_diskUsingDirectIoVec; //direct I/O disks read whole segments (no scatter reads into unaligned bundle buffers)
 };
 
 
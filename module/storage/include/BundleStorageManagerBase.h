@@ -39,6 +39,7 @@
 #include <atomic>
 #include <boost/thread.hpp>
 #include <boost/bimap.hpp>
+#include <boost/align/aligned_delete.hpp>
 #include "CircularIndexBufferSingleProducerSingleConsumerConfigurable.h"
 #include "BundleStorageConfig.h"
 #include "Logger.h"
@@ -46,6 +47,8 @@
 #include "StorageConfig.h"
 #include "codec/bpv6.h"
 #include "BundleStorageCatalog.h"
+#include "StorageCatalogJournal.h"
+#include "BundleStorageRamCache.h"
 #include "PaddedVectorUint8.h"
 
 
@@ -66,8 +69,11 @@ struct BundleStorageManagerSession_ReadFromDisk {
     uint32_t cacheWriteIndex;
 
     //std::unique_ptr<volatile uint8_t[]> readCache;
-    std::unique_ptr<uint8_t[]> readCache;// [READ_CACHE_NUM_SEGMENTS_PER_SESSION * SEGMENT_SIZE]; //may overflow stack, create on heap
+    std::unique_ptr<uint8_t, boost::alignment::aligned_delete> readCache;// [READ_CACHE_NUM_SEGMENTS_PER_SESSION * SEGMENT_SIZE]; //may overflow stack, create on heap (aligned for direct I/O)
     std::atomic<bool> readCacheIsSegmentReady[READ_CACHE_NUM_SEGMENTS_PER_SESSION];
+    //set by ReadAllSegments: segment payloads are read from disk directly into this contiguous bundle buffer
+    //(only each segment header goes to the read cache), so the bundle is never copied out of the read cache
+    uint8_t * payloadDestPtr;
 
     STORAGE_LIB_EXPORT BundleStorageManagerSession_ReadFromDisk();
     STORAGE_LIB_EXPORT ~BundleStorageManagerSession_ReadFromDisk();
@@ -83,7 +89,7 @@ public:
     STORAGE_LIB_EXPORT virtual ~BundleStorageManagerBase();
     virtual void Start() = 0;
 
-    //write
+    //write (PushAllSegments holds the bundle in the RAM cache, if enabled and the bundle fits, instead of writing it to disk)
     STORAGE_LIB_EXPORT uint64_t Push(BundleStorageManagerSession_WriteToDisk & session,
         const PrimaryBlock & bundlePrimaryBlock, const uint64_t bundleSizeBytes, const uint64_t payloadSizeBytes, cbhe_eid_t *bundleEidMaskPtr = NULL); //return totalSegmentsRequired
     STORAGE_LIB_EXPORT int PushSegment(BundleStorageManagerSession_WriteToDisk & session,
@@ -97,6 +103,10 @@ public:
     STORAGE_LIB_EXPORT uint64_t PopTop(BundleStorageManagerSession_ReadFromDisk & session, const std::vector<cbhe_eid_t> & availableDestinationEids); //0 if empty, size if entry
     STORAGE_LIB_EXPORT uint64_t PopTop(BundleStorageManagerSession_ReadFromDisk & session, const std::vector<uint64_t> & availableDestNodeIds); //0 if empty, size if entry
     STORAGE_LIB_EXPORT uint64_t PopTop(BundleStorageManagerSession_ReadFromDisk & session, const std::vector<std::pair<cbhe_eid_t, bool> > & availableDests); //0 if empty, size if entry
+    STORAGE_LIB_EXPORT uint64_t PopTopFromAwaitingSendGroup(BundleStorageManagerSession_ReadFromDisk & session, const uint64_t awaitingSendGroupId); //0 if empty, size if entry
+    STORAGE_LIB_EXPORT uint64_t AddAwaitingSendGroup(const std::vector<std::pair<cbhe_eid_t, bool> > & availableDests); //see BundleStorageCatalog::AddAwaitingSendGroup
+    STORAGE_LIB_EXPORT bool UpdateAwaitingSendGroup(const uint64_t awaitingSendGroupId, const std::vector<std::pair<cbhe_eid_t, bool> > & availableDests);
+    STORAGE_LIB_EXPORT bool RemoveAwaitingSendGroup(const uint64_t awaitingSendGroupId);
     STORAGE_LIB_EXPORT bool ReturnTop(BundleStorageManagerSession_ReadFromDisk & session);
     STORAGE_LIB_EXPORT bool ReturnCustodyIdToAwaitingSend(const uint64_t custodyId); //for expired custody timers
     STORAGE_LIB_EXPORT catalog_entry_t * GetCatalogEntryPtrFromCustodyId(const uint64_t custodyId); //for deletion of custody timer
@@ -114,7 +124,21 @@ public:
     STORAGE_LIB_EXPORT bool GetStorageExpiringBeforeThresholdTelemetry(StorageExpiringBeforeThresholdTelemetry_t& telem);
     STORAGE_LIB_EXPORT void GetExpiredBundleIds(const uint64_t expiry, const uint64_t maxNumberToFind, std::vector<uint64_t> & returnedIds);
 
+    //Restores the catalog and segment allocations from the disk files, scanning every disk on its own thread.
+    //Progress of a restore in progress (or the results of the last one) is available from GetDiskRestoreTelemetry.
     STORAGE_LIB_EXPORT bool RestoreFromDisk(uint64_t * totalBundlesRestored, uint64_t * totalBytesRestored, uint64_t * totalSegmentsRestored);
+    STORAGE_LIB_EXPORT void GetDiskRestoreTelemetry(std::vector<StorageDiskRestoreTelemetry_t>& diskRestoreTelemetryVec) const; //thread safe
+
+    //Restores the catalog and segment allocations from the catalog snapshot plus journal (if configured) without reading any bundle data.
+    //Called before RestoreFromDisk, which is the fallback if the journal is missing or inconsistent.
+    STORAGE_LIB_EXPORT bool RestoreFromCatalogJournal(uint64_t * totalBundlesRestored, uint64_t * totalBytesRestored, uint64_t * totalSegmentsRestored);
+    //Compacts the catalog journal into a new snapshot of the current catalog (done automatically every catalogSnapshotIntervalRecords).
+    STORAGE_LIB_EXPORT bool WriteCatalogSnapshot();
+
+    //Writes every bundle held in the RAM cache to disk (done automatically, oldest first, when the RAM cache needs the room,
+    //and at shutdown unless the storage files are deleted on exit).  The disks must be started.
+    STORAGE_LIB_EXPORT void FlushRamCache();
+    STORAGE_LIB_EXPORT const BundleStorageRamCache& GetRamCacheConstRef() const;
 
     STORAGE_LIB_EXPORT const MemoryManagerTreeArray& GetMemoryManagerConstRef() const;
     STORAGE_LIB_EXPORT const BundleStorageCatalog& GetBundleStorageCatalogConstRef() const;
@@ -128,6 +152,23 @@ protected:
 
     
     virtual void CommitWriteAndNotifyDiskOfWorkToDo_ThreadSafe(const unsigned int diskId) = 0;
+#ifndef _WIN32
+    //Opens (or creates if not restoring) the disk's storage file for positional reads and writes.
+    //If the disk's useDirectIo is set, the page cache is bypassed (O_DIRECT on Linux, F_NOCACHE on macOS),
+    //falling back to buffered I/O if the file system does not support it.  Returns -1 on error.
+    STORAGE_LIB_EXPORT int OpenDiskFileDescriptor(const unsigned int diskId, bool & usingDirectIo) const;
+#endif
+    //Number of bytes a disk thread reads for a circular buffer read entry: SEGMENT_SIZE into the read cache,
+    //or, if the entry has a payload destination, the segment header into the read cache followed by the payload
+    //into the payload destination (a scatter read).
+    STORAGE_LIB_EXPORT std::size_t GetReadSizeBytes(const unsigned int cbPtrIndex) const noexcept;
+    //Direct I/O cannot scatter into unaligned buffers, so those disks read the whole segment into the read cache
+    //and call this to copy the payload (if the entry has a payload destination) on the disk thread.
+    STORAGE_LIB_EXPORT void CopyReadPayloadToDestination(const unsigned int cbPtrIndex) const;
+    //Number of consecutive circular buffer write entries starting at consumeIndex (at most numInBuffer) whose segments are
+    //adjacent on the disk and whose data slots are adjacent in memory (stopping at the end of the circular buffer), so that
+    //a disk thread can coalesce them into a single write of that many SEGMENT_SIZE bytes.  Returns 1 for a lone write.
+    STORAGE_LIB_EXPORT unsigned int GetNumCoalescableWrites(const unsigned int diskIndex, const unsigned int consumeIndex, const unsigned int numInBuffer) const;
 
 protected:
     StorageConfig_ptr m_storageConfigPtr;
@@ -150,10 +191,36 @@ protected:
     //volatile uint8_t * volatile m_circularBufferReadFromStoragePointers[CIRCULAR_INDEX_BUFFER_SIZE * NUM_STORAGE_THREADS];
     std::atomic<std::atomic<bool>* > m_circularBufferIsReadCompletedPointers[CIRCULAR_INDEX_BUFFER_SIZE * MAX_NUM_STORAGE_THREADS];
     std::atomic<uint8_t*> m_circularBufferReadFromStoragePointers[CIRCULAR_INDEX_BUFFER_SIZE * MAX_NUM_STORAGE_THREADS];
+    //payload destination of a read entry (NULL if the payload stays in the read cache), published by the read pointer's release store
+    uint8_t * m_circularBufferReadPayloadDestPointers[CIRCULAR_INDEX_BUFFER_SIZE * MAX_NUM_STORAGE_THREADS];
+    uint32_t m_circularBufferReadPayloadSizes[CIRCULAR_INDEX_BUFFER_SIZE * MAX_NUM_STORAGE_THREADS];
     std::atomic<bool> m_autoDeleteFilesOnExit;
+
+private:
+    struct DiskRestoreProgress {
+        DiskRestoreProgress();
+        std::atomic<uint64_t> bytesScanned;
+        std::atomic<uint64_t> totalBytesToScan;
+        std::atomic<uint64_t> bundlesRestored;
+        std::atomic<uint64_t> bundleBytesRestored;
+        std::atomic<uint64_t> segmentsRestored;
+        std::atomic<bool> restoreAttempted;
+        std::atomic<bool> restoreCompleted;
+    };
+    struct RestoredBundle;
+    STORAGE_LIB_NO_EXPORT void WriteSegmentToDisk(const catalog_entry_t & catalogEntry, const uint32_t logicalSegment,
+        const uint64_t custodyId, const uint8_t * buf, std::size_t size);
+    STORAGE_LIB_NO_EXPORT void DestroyHeadSegmentOnDisk(const segment_id_t segmentId);
+    STORAGE_LIB_NO_EXPORT bool FlushOldestRamCacheBundleToDisk();
+    STORAGE_LIB_NO_EXPORT void RestoreDiskThreadFunc(const unsigned int diskId, std::vector<std::unique_ptr<RestoredBundle> >& restoredBundlesVec, std::atomic<bool>& restoreErrorOccurred);
+    STORAGE_LIB_NO_EXPORT void OnCatalogJournalRecordWritten(const bool success);
+    std::unique_ptr<DiskRestoreProgress[]> m_diskRestoreProgressArray;
+    std::unique_ptr<StorageCatalogJournal> m_catalogJournalPtr; //NULL if the catalog journal is disabled
+    BundleStorageRamCache m_ramCache; //bundles in the RAM cache are cataloged but not yet on disk (nor in the catalog journal)
     
 public:
     bool m_successfullyRestoredFromDisk;
+    bool m_successfullyRestoredFromCatalogJournal; //if true, m_successfullyRestoredFromDisk is also true
     uint64_t m_totalBundlesRestored;
     uint64_t m_totalBytesRestored;
     uint64_t m_totalSegmentsRestored;
@@ -0,0 +1,53 @@
+/**
+ * @file BundleStorageManagerIoUring.h
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * This BundleStorageManagerIoUring class inherits from the BundleStorageManagerBase class and implements
+ * writing and reading bundles to and from solid state disk drive(s) using 1 thread per disk drive (i.e. 1 thread per storeFilePath)
+ * where each thread owns a Linux io_uring instance.  Rather than performing one seek plus one blocking read/write
+ * per circular buffer slot (as BundleStorageManagerMT does), each disk thread submits every pending circular buffer slot
+ * as a batch of positional reads/writes with a single io_uring_enter system call.
+ * Writes use the disk's region of m_circularBufferBlockDataPtr which is registered with the kernel as a fixed buffer.
+ * This class is only available on Linux when compiled with STORAGE_IO_URING_ENABLED.
+ */
+
+#ifndef _BUNDLE_STORAGE_MANAGER_IO_URING_H
+#define _BUNDLE_STORAGE_MANAGER_IO_URING_H 1
+
+#ifdef STORAGE_IO_URING_ENABLED
+
+#include "BundleStorageManagerBase.h"
+#include <atomic>
+
+
+class CLASS_VISIBILITY_STORAGE_LIB BundleStorageManagerIoUring : public BundleStorageManagerBase {
+public:
+    STORAGE_LIB_EXPORT BundleStorageManagerIoUring();
+    STORAGE_LIB_EXPORT BundleStorageManagerIoUring(const boost::filesystem::path& jsonConfigFilePath);
+    STORAGE_LIB_EXPORT BundleStorageManagerIoUring(const StorageConfig_ptr & storageConfigPtr);
+    STORAGE_LIB_EXPORT virtual ~BundleStorageManagerIoUring() override;
+    STORAGE_LIB_EXPORT virtual void Start() override;
+
+
+private:
+    STORAGE_LIB_NO_EXPORT void StopAllDiskThreads();
+    STORAGE_LIB_NO_EXPORT void ThreadFunc(unsigned int threadIndex);
+    STORAGE_LIB_NO_EXPORT virtual void CommitWriteAndNotifyDiskOfWorkToDo_ThreadSafe(const unsigned int diskId) override;
+private:
+
+    std::vector<std::pair<boost::condition_variable, boost::mutex> > m_conditionVariablesPlusMutexesVec;
+    std::vector<std::unique_ptr<boost::thread> > m_threadPtrsVec;
+
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_noFatalErrorsOccurred;
+};
+
+#endif //STORAGE_IO_URING_ENABLED
+
+#endif //_BUNDLE_STORAGE_MANAGER_IO_URING_H
@@ -0,0 +1,88 @@
+/**
+ * @file BundleStorageRamCache.h
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * The BundleStorageRamCache class is the bounded in-memory tier in front of the disks of a BundleStorageManagerBase.
+ * A bundle pushed to storage is held here (in full) instead of being written to disk, and is only written to disk
+ * (flushed, oldest first) when the cache needs the room for a newer bundle or when storage shuts down.
+ * A bundle that is released and deleted while still cached therefore never costs any disk I/O.
+ * Bundles requesting custody transfer bypass the cache and are always written to disk, since custody is
+ * accepted (and the previous custodian may delete its copy) as soon as the bundle is stored.
+ * Bundles keep the segments allocated to them by the MemoryManagerTreeArray while cached (so a flush never runs out of space),
+ * and are keyed by the segment id of their first logical segment, which is unique among stored bundles and
+ * is available from every catalog_entry_t.
+ * This class is not thread safe (the same as the BundleStorageCatalog whose bundles it holds).
+ */
+
+#ifndef _BUNDLE_STORAGE_RAM_CACHE_H
+#define _BUNDLE_STORAGE_RAM_CACHE_H 1
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <boost/core/noncopyable.hpp>
+#include "MemoryManagerTreeArray.h"
+#include "PaddedVectorUint8.h"
+#include "storage_lib_export.h"
+
+class BundleStorageRamCache : private boost::noncopyable {
+private:
+    BundleStorageRamCache() = delete;
+public:
+    /**
+    * @param capacityBytes The maximum number of bundle bytes held in RAM, or 0 to disable the cache.
+    */
+    STORAGE_LIB_EXPORT BundleStorageRamCache(const uint64_t capacityBytes);
+    STORAGE_LIB_EXPORT ~BundleStorageRamCache();
+
+    STORAGE_LIB_EXPORT bool IsEnabled() const noexcept;
+    /// True if the cache is enabled and a bundle of this size is not larger than the whole cache
+    STORAGE_LIB_EXPORT bool CanHold(const uint64_t bundleSizeBytes) const noexcept;
+    /// True if the cached bundles must be flushed (oldest first) to make room for a bundle of this size
+    STORAGE_LIB_EXPORT bool NeedsFlushToHold(const uint64_t bundleSizeBytes) const noexcept;
+
+    /// Copy a bundle into the cache.  Returns false if the headSegmentId is already cached or the bundle will not fit.
+    STORAGE_LIB_EXPORT bool Insert(const segment_id_t headSegmentId, const uint64_t custodyId, const uint8_t * data, const std::size_t size);
+    /// Returns NULL if the bundle is not cached.  The pointer is valid until the bundle is erased or flushed.
+    STORAGE_LIB_EXPORT const padded_vector_uint8_t * Find(const segment_id_t headSegmentId) const;
+    STORAGE_LIB_EXPORT bool Contains(const segment_id_t headSegmentId) const;
+    /// Drop a bundle (being deleted from storage) from the cache.  Returns false if it is not cached (i.e. it is on disk).
+    STORAGE_LIB_EXPORT bool Erase(const segment_id_t headSegmentId);
+    /// Remove the oldest bundle, which the caller must then write to disk.  Returns false if the cache is empty.
+    STORAGE_LIB_EXPORT bool PopOldestForFlush(uint64_t & custodyId, padded_vector_uint8_t & bundleData);
+    /// Count a bundle read from storage as served from RAM (hit) or from disk (miss)
+    STORAGE_LIB_EXPORT void CountRead(const bool hit) noexcept;
+
+    STORAGE_LIB_EXPORT uint64_t GetCapacityBytes() const noexcept;
+    STORAGE_LIB_EXPORT uint64_t GetNumBundles() const noexcept;
+    STORAGE_LIB_EXPORT uint64_t GetNumBytes() const noexcept;
+    STORAGE_LIB_EXPORT uint64_t GetTotalHits() const noexcept;
+    STORAGE_LIB_EXPORT uint64_t GetTotalMisses() const noexcept;
+    STORAGE_LIB_EXPORT uint64_t GetTotalBundlesFlushedToDisk() const noexcept;
+    STORAGE_LIB_EXPORT uint64_t GetTotalBundlesErasedBeforeFlush() const noexcept;
+
+private:
+    struct cached_bundle_t {
+        segment_id_t headSegmentId;
+        uint64_t custodyId;
+        padded_vector_uint8_t bundleData;
+    };
+    typedef std::list<cached_bundle_t> cached_bundle_list_t;
+
+    const uint64_t M_CAPACITY_BYTES;
+    cached_bundle_list_t m_cachedBundlesOldestFirst;
+    std::unordered_map<segment_id_t, cached_bundle_list_t::iterator> m_headSegmentIdToCachedBundleMap;
+    uint64_t m_numBytes;
+    uint64_t m_totalHits;
+    uint64_t m_totalMisses;
+    uint64_t m_totalBundlesFlushedToDisk;
+    uint64_t m_totalBundlesErasedBeforeFlush;
+};
+
+#endif //_BUNDLE_STORAGE_RAM_CACHE_H
@@ -0,0 +1,106 @@
+/**
+ * @file CustodyTimersTimingWheel.h
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * This CustodyTimersTimingWheel class has the same interface as CustodyTimers but is built on a
+ * hierarchical timing wheel (NUM_LEVELS levels of 64 slots, each slot of a level spanning all 64 slots of the level below it)
+ * so that starting and cancelling a custody transfer timer is O(1) and allocation free once warmed up.
+ * Timers live in a pool of nodes linked by index (the custody id is mapped to its node by a HashMapOpenAddressing).
+ * The wheel is advanced lazily to the nowPtime given to the Poll functions, and every timer whose tick has passed
+ * is moved in one batch to the expired list (in expiry order) and to the expired list of its destination,
+ * so popping an expired timer is O(1) (or O(number of available destinations) for PollOneAndPopExpiredCustodyTimer).
+ * Expiries are rounded up to the next tick (default 1 ms), so a timer never expires early.
+ */
+
+#ifndef _CUSTODY_TIMERS_TIMING_WHEEL_H
+#define _CUSTODY_TIMERS_TIMING_WHEEL_H 1
+
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "codec/bpv6.h"
+#include <boost/date_time.hpp>
+#include <boost/core/noncopyable.hpp>
+#include "HashMapOpenAddressing.h"
+#include "storage_lib_export.h"
+
+class CustodyTimersTimingWheel : private boost::noncopyable {
+private:
+    CustodyTimersTimingWheel() = delete;
+public:
+
+    STORAGE_LIB_EXPORT CustodyTimersTimingWheel(const boost::posix_time::time_duration & timeout,
+        const boost::posix_time::time_duration & tickDuration = boost::posix_time::milliseconds(1));
+    STORAGE_LIB_EXPORT ~CustodyTimersTimingWheel();
+
+    STORAGE_LIB_EXPORT bool PollOneAndPopExpiredCustodyTimer(uint64_t & custodyId, const std::vector<cbhe_eid_t> & availableDestEids, const boost::posix_time::ptime & nowPtime);
+    STORAGE_LIB_EXPORT bool PollOneAndPopAnyExpiredCustodyTimer(uint64_t & custodyId, const boost::posix_time::ptime & nowPtime);
+    STORAGE_LIB_EXPORT bool StartCustodyTransferTimer(const cbhe_eid_t & finalDestEid, const uint64_t custodyId);
+    STORAGE_LIB_EXPORT bool CancelCustodyTransferTimer(const cbhe_eid_t & finalDestEid, const uint64_t custodyId);
+    STORAGE_LIB_EXPORT std::size_t GetNumCustodyTransferTimers();
+    STORAGE_LIB_EXPORT std::size_t GetNumCustodyTransferTimers(const cbhe_eid_t & finalDestEid);
+
+private:
+    static constexpr unsigned int SLOT_BITS = 6;
+    static constexpr unsigned int NUM_SLOTS_PER_LEVEL = 1u << SLOT_BITS;
+    static constexpr uint64_t SLOT_MASK = NUM_SLOTS_PER_LEVEL - 1;
+    static constexpr unsigned int NUM_LEVELS = 6; //2^36 ticks (about 2 years at 1 ms per tick) before a timer is held at the top level
+    static constexpr uint32_t NUM_WHEEL_LISTS = NUM_LEVELS * NUM_SLOTS_PER_LEVEL;
+    static constexpr uint32_t EXPIRED_LIST_ID = NUM_WHEEL_LISTS; //the list id of a node no longer in the wheel
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct timer_node_t {
+        uint64_t custodyId;
+        uint64_t expiryTick;
+        uint32_t listId; //wheel slot (level * NUM_SLOTS_PER_LEVEL + slot) or EXPIRED_LIST_ID
+        uint32_t prev; //within listId
+        uint32_t next;
+        uint32_t destIndex;
+        uint32_t destPrev; //within the destination's expired list (only when expired)
+        uint32_t destNext;
+    };
+    struct list_t {
+        uint32_t head;
+        uint32_t tail;
+        uint64_t cascadeGeneration; //timers cascaded into this slot by cascade m_cascadeGeneration go (in order) before the slot's existing timers
+        uint32_t cascadeLast;
+    };
+    struct destination_t {
+        cbhe_eid_t eid;
+        list_t expiredList;
+        std::size_t numTimers; //both in the wheel and expired
+    };
+
+    STORAGE_LIB_NO_EXPORT uint64_t TimeToTick(const boost::posix_time::ptime & t, const bool roundUp) const;
+    STORAGE_LIB_NO_EXPORT void AdvanceTo(const uint64_t tick);
+    STORAGE_LIB_NO_EXPORT void Cascade(const unsigned int level);
+    STORAGE_LIB_NO_EXPORT void AddToWheelOrExpire(const uint32_t nodeIndex, const bool isCascade);
+    STORAGE_LIB_NO_EXPORT void InsertIntoList(const uint32_t nodeIndex, const uint32_t listId, const uint32_t prevNodeIndex);
+    STORAGE_LIB_NO_EXPORT void UnlinkFromList(const uint32_t nodeIndex);
+    STORAGE_LIB_NO_EXPORT void UnlinkFromDestExpiredList(const uint32_t nodeIndex);
+    STORAGE_LIB_NO_EXPORT void FreeNode(const uint32_t nodeIndex);
+    STORAGE_LIB_NO_EXPORT uint64_t PopExpired(const uint32_t nodeIndex);
+
+    const boost::posix_time::time_duration M_CUSTODY_TIMEOUT_DURATION;
+    const boost::posix_time::time_duration M_TICK_DURATION;
+    const boost::posix_time::ptime M_EPOCH;
+    uint64_t m_currentTick; //every slot up to and including this tick has been expired
+    uint64_t m_numTimersInWheel;
+    uint64_t m_cascadeGeneration;
+    uint64_t m_slotOccupiedBitmasks[NUM_LEVELS];
+    list_t m_lists[NUM_WHEEL_LISTS + 1]; //wheel slots followed by the expired list
+    std::vector<timer_node_t> m_nodes;
+    std::vector<uint32_t> m_freeNodeIndices;
+    HashMapOpenAddressing<uint64_t, uint32_t> m_mapCustodyIdToNodeIndex;
+    std::vector<destination_t> m_destinations; //never shrinks (one per destination ever seen)
+    std::map<cbhe_eid_t, uint32_t> m_mapDestEidToDestIndex;
+};
+
+
+#endif //_CUSTODY_TIMERS_TIMING_WHEEL_H
@@ -60,6 +60,7 @@ public:
 
     STORAGE_LIB_EXPORT void BucketToVector(const uint16_t hash, std::vector<key_value_pair_t> & bucketAsVector);
     STORAGE_LIB_EXPORT std::size_t GetBucketSize(const uint16_t hash);
+    STORAGE_LIB_EXPORT void GetKeys(std::vector<keyType> & keys) const; //every key in the map (in bucket order)
 
     STORAGE_LIB_EXPORT void Clear();
 
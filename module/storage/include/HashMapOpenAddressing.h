@@ -0,0 +1,88 @@
+/**
+ * @file HashMapOpenAddressing.h
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * This templated HashMapOpenAddressing class is a drop-in replacement for HashMap16BitFixedSize
+ * (same Insert/GetValuePtr/GetValueAndRemove API) that keeps lookups fast with millions of bundles.
+ * It is a linear probing (open addressing) hash table whose slot array doubles in size whenever
+ * it becomes 3/4 full, so probe sequences stay short regardless of the number of bundles.
+ * Each 8-byte slot holds 32 bits of the key's hash plus the index of its key/value pair, so a probe
+ * scans contiguous memory and only dereferences a key/value pair whose hash bits match.
+ * Key/value pairs live in fixed size blocks that are never moved (growing only rehashes the slots),
+ * so, like HashMap16BitFixedSize, a pointer returned by Insert or GetValuePtr remains valid until
+ * that key is removed (the catalog relies on this for catalog_entry_t::ptrUuidKeyInMap).
+ * Removal uses backward shift deletion so no tombstones are left behind.
+ */
+
+#ifndef _HASH_MAP_OPEN_ADDRESSING_H
+#define _HASH_MAP_OPEN_ADDRESSING_H 1
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <utility>
+#include "codec/Cbhe.h"
+#include "storage_lib_export.h"
+
+template <typename keyType, typename valueType>
+class HashMapOpenAddressing {
+public:
+    typedef std::pair<keyType, valueType> key_value_pair_t;
+
+
+    STORAGE_LIB_EXPORT HashMapOpenAddressing();
+    STORAGE_LIB_EXPORT ~HashMapOpenAddressing();
+
+    STORAGE_LIB_EXPORT static uint32_t GetHash(const cbhe_bundle_uuid_t & bundleUuid);
+    STORAGE_LIB_EXPORT static uint32_t GetHash(const cbhe_bundle_uuid_nofragment_t & bundleUuid);
+    STORAGE_LIB_EXPORT static uint32_t GetHash(const uint64_t key);
+
+    //return ptr of inserted pair if inserted, NULL if already exists
+    STORAGE_LIB_EXPORT const key_value_pair_t * Insert(const keyType & key, const valueType & value);
+    STORAGE_LIB_EXPORT const key_value_pair_t * Insert(const keyType & key, valueType && value);
+    STORAGE_LIB_EXPORT const key_value_pair_t * Insert(const uint32_t hash, const keyType & key, const valueType & value);
+    STORAGE_LIB_EXPORT const key_value_pair_t * Insert(const uint32_t hash, const keyType & key, valueType && value);
+
+    //return true if exists, false if key doesn't exist in the map
+    STORAGE_LIB_EXPORT bool GetValueAndRemove(const keyType & key, valueType & value);
+    STORAGE_LIB_EXPORT bool GetValueAndRemove(const uint32_t hash, const keyType & key, valueType & value);
+
+    //return ptr if exists, NULL if key doesn't exist in the map
+    STORAGE_LIB_EXPORT valueType * GetValuePtr(const keyType & key);
+    STORAGE_LIB_EXPORT valueType * GetValuePtr(const uint32_t hash, const keyType & key);
+
+
+    STORAGE_LIB_EXPORT void GetKeys(std::vector<keyType> & keys) const; //every key in the map (in no particular order)
+    STORAGE_LIB_EXPORT std::size_t GetSize() const noexcept;
+    STORAGE_LIB_EXPORT std::size_t GetNumSlots() const noexcept;
+    /// Grow the slot array (if needed) so that numElements can be held without rehashing
+    STORAGE_LIB_EXPORT void Reserve(const std::size_t numElements);
+
+    STORAGE_LIB_EXPORT void Clear();
+
+
+private:
+    struct slot_t {
+        uint32_t hash;
+        uint32_t pairIndexPlusOne; //0 if the slot is empty
+    };
+    STORAGE_LIB_NO_EXPORT std::size_t FindSlotIndex(const uint32_t hash, const keyType & key) const;
+    STORAGE_LIB_NO_EXPORT void Rehash(const std::size_t newNumSlots);
+    STORAGE_LIB_NO_EXPORT key_value_pair_t & PairAt(const uint32_t pairIndex) const;
+
+    std::vector<slot_t> m_slots;
+    std::size_t m_slotIndexMask;
+    std::size_t m_size;
+    std::vector<std::unique_ptr<key_value_pair_t[]> > m_pairBlocks;
+    std::vector<uint32_t> m_freePairIndices; //pairs removed from the map, reused before taking a new one from m_pairBlocks
+    uint32_t m_numPairsTakenFromBlocks;
+};
+
+
+#endif //_HASH_MAP_OPEN_ADDRESSING_H
@@ -49,6 +49,8 @@ public:
 
     /** Thread safe method to allocate a vector of the first available free segment numbers in numerical order.
      * The desired number of segments must be set prior to the call by calling segmentVec.resize() (i.e. number of desired segments should be the vector size).
+     * Multi-segment requests prefer a run of consecutive free segment numbers (see AllocateContiguousSegments_NotThreadSafe)
+     * and fall back to the first available free segment numbers if no such run is found.
      *
      * @param segmentVec The preallocated vector of segments to be filled.  Will be resized to zero on failure.
      * @return True if the segmentVec was fully populated (the MemoryManagerTreeArray was not full prior to the last segment being allocated), or False otherwise.
@@ -78,6 +80,14 @@ public:
      */
     STORAGE_LIB_EXPORT void BackupDataToVector(memmanager_t & backup) const;
 
+    /** Replace the internal data structure with one previously saved by BackupDataToVector, useful for restoring from a catalog snapshot.
+     *
+     * @param backup The data to copy into the internal data structure.
+     * @return True if the backup was taken from a MemoryManagerTreeArray of the same max segments and was restored, or False otherwise.
+     * @post The internal data structures (and the number of allocated segments) are updated if and only if True is returned.
+     */
+    STORAGE_LIB_EXPORT bool RestoreDataFromVector(const memmanager_t & backup);
+
     /** Get a const reference to the internal data structure, useful for equality comparision in unit testing.
      *
      * @return A const reference to the internal data structure.
@@ -106,6 +116,16 @@ public:
      */
     STORAGE_LIB_EXPORT segment_id_t GetAndSetFirstFreeSegmentId_NotThreadSafe();
 
+    /** Allocate a run of consecutive free segment numbers, the first run (at or after the first free segment) found within
+     * MEMORY_MANAGER_CONTIGUOUS_SEARCH_MAX_SEGMENTS segment numbers.  Segment numbers are striped across the disks, so each disk's
+     * share of a consecutive run is physically contiguous on that disk and can be written with fewer, larger writes.
+     *
+     * @param segmentVec The preallocated vector of segments to be filled (the vector size is the number of desired segments).
+     * @return True if a run was found and allocated into segmentVec, or False otherwise (segmentVec is left unchanged).
+     * @post The internal data structures are updated if and only if True is returned.
+     */
+    STORAGE_LIB_EXPORT bool AllocateContiguousSegments_NotThreadSafe(segment_id_chain_vec_t & segmentVec);
+
     /** Manually allocate the specified segment (if free), useful for restore from disk (rebuilding the MemoryManagerTreeArray after power loss) operations.
      *
      * @param segmentId The segment to be set as allocated.
@@ -0,0 +1,113 @@
+/**
+ * @file StorageCatalogJournal.h
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * The StorageCatalogJournal class persists the bundle storage catalog so that storage can be
+ * restarted in time proportional to the size of the catalog rather than the size of the disks
+ * (see BundleStorageManagerBase::RestoreFromDisk, which reads every segment header of every disk).
+ * It maintains two files:
+ *   - a compact snapshot (the journal file path plus a ".snapshot" extension) holding the
+ *     MemoryManagerTreeArray bitmap (from BackupDataToVector) and every catalog entry, and
+ *   - an append-only journal of every bundle cataloged (store) or removed since that snapshot.
+ * Both files carry a generation number so that a journal is only replayed on top of the snapshot it follows,
+ * and every journal record carries a CRC-32 so that a record torn by a crash ends the replay.
+ * Bundles keep the custody ids they were stored with, so the replayed catalog also tells the
+ * custody id allocator which custody ids are still in use.
+ * This class is not thread safe (the same as the BundleStorageCatalog it journals).
+ */
+
+#ifndef _STORAGE_CATALOG_JOURNAL_H
+#define _STORAGE_CATALOG_JOURNAL_H 1
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <utility>
+#include <boost/filesystem/path.hpp>
+#include <boost/core/noncopyable.hpp>
+#include "MemoryManagerTreeArray.h"
+#include "CatalogEntry.h"
+#include "codec/Cbhe.h"
+#include "storage_lib_export.h"
+
+struct catalog_journal_restored_bundle_t {
+    uint64_t custodyId;
+    catalog_entry_t catalogEntry; //ptrUuidKeyInMap is NULL until cataloged
+    cbhe_bundle_uuid_t bundleUuid; //only meaningful if the catalogEntry has custody
+};
+
+class StorageCatalogJournal : private boost::noncopyable {
+private:
+    StorageCatalogJournal() = delete;
+public:
+    /**
+    * Constructor that does not open or create any files (see Load and WriteSnapshot).
+    *
+    * @param journalFilePath The path of the journal file.  The snapshot is stored alongside it.
+    * @param maxSegments The max segments of the storage, which must match that of a snapshot being loaded.
+    * @param numStorageDisks The number of storage disks, which must match that of a snapshot being loaded.
+    */
+    STORAGE_LIB_EXPORT StorageCatalogJournal(const boost::filesystem::path & journalFilePath, const uint64_t maxSegments, const unsigned int numStorageDisks);
+    STORAGE_LIB_EXPORT ~StorageCatalogJournal();
+
+    /** Read the snapshot and replay the journal records that follow it.
+     *
+     * @param memoryManager A freshly constructed MemoryManagerTreeArray of maxSegments, which receives the segment allocations of the restored bundles.
+     * @param restoredBundlesVec The restored bundles, in the order they should be cataloged.
+     * @return True if the snapshot (and journal, if any) were valid and consistent, or False otherwise (in which case the catalog must be restored some other way).
+     */
+    STORAGE_LIB_EXPORT bool Load(MemoryManagerTreeArray & memoryManager, std::vector<catalog_journal_restored_bundle_t> & restoredBundlesVec);
+
+    /** Atomically replace the snapshot with the given catalog, then start a new empty journal following it.
+     *
+     * @param memoryManagerBackup The segment allocations of exactly the given catalog entries (from BackupDataToVector).
+     * @param custodyIdsPlusEntries Every catalog entry, in the order they should be cataloged on restore.
+     * @return True if the snapshot was written and the new journal was opened, or False otherwise (in which case any existing snapshot is deleted).
+     */
+    STORAGE_LIB_EXPORT bool WriteSnapshot(const memmanager_t & memoryManagerBackup, const std::vector<std::pair<uint64_t, const catalog_entry_t*> > & custodyIdsPlusEntries);
+
+    /** Append a record of a bundle that was cataloged.  The catalogEntry must already be in the catalog (so that its ptrUuidKeyInMap is set).
+     *
+     * @return True if the record was written, or False otherwise (in which case the snapshot is deleted and the journal is closed).
+     */
+    STORAGE_LIB_EXPORT bool LogStore(const uint64_t custodyId, const catalog_entry_t & catalogEntry);
+
+    /** Append a record of a bundle that was removed from the catalog.
+     *
+     * @return True if the record was written, or False otherwise (in which case the snapshot is deleted and the journal is closed).
+     */
+    STORAGE_LIB_EXPORT bool LogRemove(const uint64_t custodyId);
+
+    STORAGE_LIB_EXPORT uint64_t GetNumRecordsSinceSnapshot() const noexcept;
+    STORAGE_LIB_EXPORT uint64_t GetGeneration() const noexcept;
+    STORAGE_LIB_EXPORT bool IsOpen() const noexcept;
+    STORAGE_LIB_EXPORT const boost::filesystem::path & GetJournalFilePath() const noexcept;
+    STORAGE_LIB_EXPORT const boost::filesystem::path & GetSnapshotFilePath() const noexcept;
+
+    /// Close the journal and delete both the journal and the snapshot files
+    STORAGE_LIB_EXPORT void DeleteFiles();
+
+private:
+    STORAGE_LIB_NO_EXPORT bool AppendRecord();
+    STORAGE_LIB_NO_EXPORT void Invalidate();
+    STORAGE_LIB_NO_EXPORT void CloseJournal();
+    STORAGE_LIB_NO_EXPORT static bool ReadFile(const boost::filesystem::path & filePath, std::vector<uint8_t> & fileContents);
+    STORAGE_LIB_NO_EXPORT static bool ReadGeneration(const boost::filesystem::path & filePath, const char * expectedMagic, uint64_t & generation);
+
+    const boost::filesystem::path M_JOURNAL_FILE_PATH;
+    const boost::filesystem::path M_SNAPSHOT_FILE_PATH;
+    const uint64_t M_MAX_SEGMENTS;
+    const uint64_t M_NUM_STORAGE_DISKS;
+    FILE * m_journalFileHandle;
+    uint64_t m_generation;
+    uint64_t m_numRecordsSinceSnapshot;
+    std::vector<uint8_t> m_recordBuffer; //reused for every record appended
+};
+
+#endif //_STORAGE_CATALOG_JOURNAL_H
@@ -15,9 +15,28 @@
 #include "BundleStorageCatalog.h"
 #include <string>
 #include <boost/make_unique.hpp>
+#include <unordered_set>
+#include <algorithm>
+#include <tuple>
 
+awaiting_send_dest_t::awaiting_send_dest_t() :
+    hasHead(false),
+    headPriorityRank(0),
+    headExpiration(0),
+    eidPtr(NULL) {}
+
+bool awaiting_send_group_head_t::operator<(const awaiting_send_group_head_t & o) const {
+    if (priorityRank != o.priorityRank) {
+        return (priorityRank < o.priorityRank);
+    }
+    if (expiration != o.expiration) {
+        return (expiration < o.expiration);
+    }
+    return ((*destPtr->eidPtr) < (*o.destPtr->eidPtr));
+}
 
 BundleStorageCatalog::BundleStorageCatalog() : 
+    m_nextAwaitingSendGroupId(0),
     m_numBundlesInCatalog(0),
     m_numBundleBytesInCatalog(0),
     m_totalBundleWriteOperationsToCatalog(0),
@@ -106,6 +125,26 @@ bool BundleStorageCatalog::CatalogIncomingBundleForStore(catalog_entry_t & catal
             catalogEntryToTake.ptrUuidKeyInMap = &p->first;
         }
     }
+    return AddEntryToCatalog(catalogEntryToTake, custodyId, order);
+}
+bool BundleStorageCatalog::CatalogIncomingBundleForStore(catalog_entry_t & catalogEntryToTake, const cbhe_bundle_uuid_t & bundleUuid, const uint64_t custodyId, const DUPLICATE_EXPIRY_ORDER order) {
+    if (catalogEntryToTake.HasCustodyAndFragmentation()) {
+        const uuid_to_custid_hashmap_t::key_value_pair_t * p = m_uuidToCustodyIdHashMap.Insert(bundleUuid, custodyId);
+        if (p == NULL) {
+            return false;
+        }
+        catalogEntryToTake.ptrUuidKeyInMap = &p->first;
+    }
+    else if (catalogEntryToTake.HasCustodyAndNonFragmentation()) {
+        const uuidnofrag_to_custid_hashmap_t::key_value_pair_t * p = m_uuidNoFragToCustodyIdHashMap.Insert(cbhe_bundle_uuid_nofragment_t(bundleUuid), custodyId);
+        if (p == NULL) {
+            return false;
+        }
+        catalogEntryToTake.ptrUuidKeyInMap = &p->first;
+    }
+    return AddEntryToCatalog(catalogEntryToTake, custodyId, order);
+}
+bool BundleStorageCatalog::AddEntryToCatalog(catalog_entry_t & catalogEntryToTake, const uint64_t custodyId, const DUPLICATE_EXPIRY_ORDER order) {
     if (!AddEntryToAwaitingSend(catalogEntryToTake, custodyId, order)) {
         return false;
     }
@@ -123,23 +162,31 @@ bool BundleStorageCatalog::CatalogIncomingBundleForStore(catalog_entry_t & catal
     return true;
 }
 bool BundleStorageCatalog::AddEntryToAwaitingSend(const catalog_entry_t & catalogEntry, const uint64_t custodyId, const DUPLICATE_EXPIRY_ORDER order) {
-    priorities_to_expirations_array_t & priorityArray = m_destEidToPrioritiesMap[catalogEntry.destEid]; //created if not exist
-    expirations_to_custids_map_t & expirationMap = priorityArray[catalogEntry.GetPriorityIndex()];
+    std::pair<dest_eid_to_priorities_map_t::iterator, bool> destRet = m_destEidToPrioritiesMap.emplace(std::piecewise_construct,
+        std::forward_as_tuple(catalogEntry.destEid), std::forward_as_tuple()); //created if not exist
+    if (destRet.second) {
+        OnAwaitingSendDestCreated(destRet.first);
+    }
+    awaiting_send_dest_t & dest = destRet.first->second;
+    expirations_to_custids_map_t & expirationMap = dest.priorityArray[catalogEntry.GetPriorityIndex()];
     custids_flist_queue_t& custodyIdFlistQueue = expirationMap[catalogEntry.GetAbsExpiration()];
+    bool success;
     if (order == DUPLICATE_EXPIRY_ORDER::SEQUENCE_NUMBER) {
-        return Insert_OrderBySequence(custodyIdFlistQueue, custodyId, catalogEntry.sequence);
+        success = Insert_OrderBySequence(custodyIdFlistQueue, custodyId, catalogEntry.sequence);
     }
     else if (order == DUPLICATE_EXPIRY_ORDER::FIFO) {
         Insert_OrderByFifo(custodyIdFlistQueue, custodyId);
-        return true;
+        success = true;
     }
     else if (order == DUPLICATE_EXPIRY_ORDER::FILO) {
         Insert_OrderByFilo(custodyIdFlistQueue, custodyId);
-        return true;
+        success = true;
     }
     else {
-        return false;
+        success = false;
     }
+    UpdateAwaitingSendHead(dest);
+    return success;
 }
 bool BundleStorageCatalog::ReturnEntryToAwaitingSend(const catalog_entry_t & catalogEntry, const uint64_t custodyId) {
     //return what was popped off the front back to the front
@@ -148,8 +195,8 @@ bool BundleStorageCatalog::ReturnEntryToAwaitingSend(const catalog_entry_t & cat
 bool BundleStorageCatalog::RemoveEntryFromAwaitingSend(const catalog_entry_t & catalogEntry, const uint64_t custodyId) {
     dest_eid_to_priorities_map_t::iterator destEidIt = m_destEidToPrioritiesMap.find(catalogEntry.destEid);
     if (destEidIt != m_destEidToPrioritiesMap.end()) {
-        priorities_to_expirations_array_t & priorityArray = destEidIt->second; //created if not exist
-        expirations_to_custids_map_t & expirationMap = priorityArray[catalogEntry.GetPriorityIndex()];
+        awaiting_send_dest_t & dest = destEidIt->second;
+        expirations_to_custids_map_t & expirationMap = dest.priorityArray[catalogEntry.GetPriorityIndex()];
         expirations_to_custids_map_t::iterator expirationsIt = expirationMap.find(catalogEntry.GetAbsExpiration());
         if (expirationsIt != expirationMap.end()) {
             custids_flist_queue_t& custodyIdFlistQueue = expirationsIt->second;
@@ -157,31 +204,60 @@ bool BundleStorageCatalog::RemoveEntryFromAwaitingSend(const catalog_entry_t & c
             if(custodyIdFlistQueue.empty()) {
                 expirationMap.erase(expirationsIt);
             }
+            UpdateAwaitingSendHead(dest);
             return removed;
         }
     }
     return false;
 }
 
+void BundleStorageCatalog::GetCustodyIdsInSendOrder(std::vector<uint64_t> & custodyIds) const {
+    std::vector<uint64_t> allCustodyIds;
+    m_custodyIdToCatalogEntryHashmap.GetKeys(allCustodyIds);
+    custodyIds.resize(0);
+    custodyIds.reserve(allCustodyIds.size());
+    std::unordered_set<uint64_t> awaitingSendCustodyIds;
+    awaitingSendCustodyIds.reserve(allCustodyIds.size());
+    for (dest_eid_to_priorities_map_t::const_iterator dmIt = m_destEidToPrioritiesMap.cbegin(); dmIt != m_destEidToPrioritiesMap.cend(); ++dmIt) {
+        const priorities_to_expirations_array_t & priorityArray = dmIt->second.priorityArray;
+        for (std::size_t i = 0; i < priorityArray.size(); ++i) {
+            const expirations_to_custids_map_t & expirationMap = priorityArray[i];
+            for (expirations_to_custids_map_t::const_iterator emIt = expirationMap.cbegin(); emIt != expirationMap.cend(); ++emIt) {
+                const custids_flist_queue_t & custodyIdFlistQueue = emIt->second;
+                for (custids_flist_queue_t::const_iterator it = custodyIdFlistQueue.cbegin(); it != custodyIdFlistQueue.cend(); ++it) {
+                    custodyIds.push_back(*it);
+                    awaitingSendCustodyIds.insert(*it);
+                }
+            }
+        }
+    }
+    //bundles that have been popped (i.e. sent and awaiting custody or deletion) go last
+    for (std::size_t i = 0; i < allCustodyIds.size(); ++i) {
+        if (awaitingSendCustodyIds.count(allCustodyIds[i]) == 0) {
+            custodyIds.push_back(allCustodyIds[i]);
+        }
+    }
+}
+
 //this function requires fully qualified endpoint ids
 catalog_entry_t * BundleStorageCatalog::PopEntryFromAwaitingSend(uint64_t & custodyId, const std::vector<cbhe_eid_t> & availableDestEids) {
-    std::vector<std::pair<const cbhe_eid_t*, priorities_to_expirations_array_t *> > destEidPlusPriorityArrayPtrs;
-    destEidPlusPriorityArrayPtrs.reserve(availableDestEids.size());
+    std::vector<std::pair<const cbhe_eid_t*, awaiting_send_dest_t *> > destEidPlusDestPtrs;
+    destEidPlusDestPtrs.reserve(availableDestEids.size());
 
     for (std::size_t i = 0; i < availableDestEids.size(); ++i) {
         const cbhe_eid_t & currentAvailableLink = availableDestEids[i];
         dest_eid_to_priorities_map_t::iterator dmIt = m_destEidToPrioritiesMap.find(currentAvailableLink);
         if (dmIt != m_destEidToPrioritiesMap.end()) {
-            destEidPlusPriorityArrayPtrs.emplace_back(&currentAvailableLink, &(dmIt->second));
+            destEidPlusDestPtrs.emplace_back(&currentAvailableLink, &(dmIt->second));
         }
     }
-    return PopEntryFromAwaitingSend(custodyId, destEidPlusPriorityArrayPtrs);
+    return PopEntryFromAwaitingSend(custodyId, destEidPlusDestPtrs);
 }
 
 //this function ignores service ids
 catalog_entry_t * BundleStorageCatalog::PopEntryFromAwaitingSend(uint64_t & custodyId, const std::vector<uint64_t> & availableDestNodeIds) {
-    std::vector<std::pair<const cbhe_eid_t*, priorities_to_expirations_array_t *> > destEidPlusPriorityArrayPtrs;
-    destEidPlusPriorityArrayPtrs.reserve(availableDestNodeIds.size()); //todo
+    std::vector<std::pair<const cbhe_eid_t*, awaiting_send_dest_t *> > destEidPlusDestPtrs;
+    destEidPlusDestPtrs.reserve(availableDestNodeIds.size()); //todo
 
     for (std::size_t i = 0; i < availableDestNodeIds.size(); ++i) {
         const uint64_t nodeId = availableDestNodeIds[i];
@@ -192,16 +268,16 @@ catalog_entry_t * BundleStorageCatalog::PopEntryFromAwaitingSend(uint64_t & cust
             ++dmIt)
         {
             const cbhe_eid_t & currentAvailableLink = dmIt->first;
-            destEidPlusPriorityArrayPtrs.emplace_back(&currentAvailableLink, &(dmIt->second));
+            destEidPlusDestPtrs.emplace_back(&currentAvailableLink, &(dmIt->second));
         }
     }
-    return PopEntryFromAwaitingSend(custodyId, destEidPlusPriorityArrayPtrs);
+    return PopEntryFromAwaitingSend(custodyId, destEidPlusDestPtrs);
 }
 
 //this function uses the pair bool = true for any service ids
 catalog_entry_t * BundleStorageCatalog::PopEntryFromAwaitingSend(uint64_t & custodyId, const std::vector<std::pair<cbhe_eid_t, bool> > & availableDests) {
-    std::vector<std::pair<const cbhe_eid_t*, priorities_to_expirations_array_t *> > destEidPlusPriorityArrayPtrs;
-    destEidPlusPriorityArrayPtrs.reserve(availableDests.size()); //todo
+    std::vector<std::pair<const cbhe_eid_t*, awaiting_send_dest_t *> > destEidPlusDestPtrs;
+    destEidPlusDestPtrs.reserve(availableDests.size()); //todo
 
     for (std::size_t i = 0; i < availableDests.size(); ++i) {
         if (availableDests[i].second) { //wildcard * for any service id
@@ -213,21 +289,21 @@ catalog_entry_t * BundleStorageCatalog::PopEntryFromAwaitingSend(uint64_t & cust
                 ++dmIt)
             {
                 const cbhe_eid_t & currentAvailableLink = dmIt->first;
-                destEidPlusPriorityArrayPtrs.emplace_back(&currentAvailableLink, &(dmIt->second));
+                destEidPlusDestPtrs.emplace_back(&currentAvailableLink, &(dmIt->second));
             }
         }
         else { //fully qualified eids
             const cbhe_eid_t & currentAvailableLink = availableDests[i].first;
             dest_eid_to_priorities_map_t::iterator dmIt = m_destEidToPrioritiesMap.find(currentAvailableLink);
             if (dmIt != m_destEidToPrioritiesMap.end()) {
-                destEidPlusPriorityArrayPtrs.emplace_back(&currentAvailableLink, &(dmIt->second));
+                destEidPlusDestPtrs.emplace_back(&currentAvailableLink, &(dmIt->second));
             }
         }
     }
-    return PopEntryFromAwaitingSend(custodyId, destEidPlusPriorityArrayPtrs);
+    return PopEntryFromAwaitingSend(custodyId, destEidPlusDestPtrs);
 }
 catalog_entry_t * BundleStorageCatalog::PopEntryFromAwaitingSend(uint64_t & custodyId,
-    const std::vector<std::pair<const cbhe_eid_t*, priorities_to_expirations_array_t *> > & destEidPlusPriorityArrayPtrs)
+    const std::vector<std::pair<const cbhe_eid_t*, awaiting_send_dest_t *> > & destEidPlusDestPtrs)
 {
 
     //memset((uint8_t*)session.readCacheIsSegmentReady, 0, READ_CACHE_NUM_SEGMENTS_PER_SESSION);
@@ -236,10 +312,11 @@ catalog_entry_t * BundleStorageCatalog::PopEntryFromAwaitingSend(uint64_t & cust
         expirations_to_custids_map_t * expirationMapPtr = NULL;
         custids_flist_queue_t * custodyIdFlistQueuePtr = NULL;
         expirations_to_custids_map_t::iterator expirationMapIterator;
+        awaiting_send_dest_t * destPtr = NULL;
 
-        for (std::size_t j = 0; j < destEidPlusPriorityArrayPtrs.size(); ++j) {
-            priorities_to_expirations_array_t * priorityArray = destEidPlusPriorityArrayPtrs[j].second;
-            expirations_to_custids_map_t & expirationMap = (*priorityArray)[i];
+        for (std::size_t j = 0; j < destEidPlusDestPtrs.size(); ++j) {
+            awaiting_send_dest_t * thisDestPtr = destEidPlusDestPtrs[j].second;
+            expirations_to_custids_map_t & expirationMap = thisDestPtr->priorityArray[i];
             expirations_to_custids_map_t::iterator it = expirationMap.begin();
             if (it != expirationMap.end()) {
                 const uint64_t thisExpiration = it->first;
@@ -248,6 +325,7 @@ catalog_entry_t * BundleStorageCatalog::PopEntryFromAwaitingSend(uint64_t & cust
                     expirationMapPtr = &expirationMap;
                     custodyIdFlistQueuePtr = &it->second;
                     expirationMapIterator = it;
+                    destPtr = thisDestPtr;
                 }
             }
         }
@@ -258,6 +336,7 @@ catalog_entry_t * BundleStorageCatalog::PopEntryFromAwaitingSend(uint64_t & cust
             if (custodyIdFlistQueuePtr->empty()) {
                 expirationMapPtr->erase(expirationMapIterator);
             }
+            UpdateAwaitingSendHead(*destPtr);
 
             return m_custodyIdToCatalogEntryHashmap.GetValuePtr(custodyId);
         }
@@ -265,6 +344,168 @@ catalog_entry_t * BundleStorageCatalog::PopEntryFromAwaitingSend(uint64_t & cust
     return NULL;
 }
 
+uint64_t BundleStorageCatalog::AddAwaitingSendGroup(const std::vector<std::pair<cbhe_eid_t, bool> > & availableDests) {
+    const uint64_t groupId = m_nextAwaitingSendGroupId++;
+    awaiting_send_group_t & group = m_awaitingSendGroups[groupId];
+    group.availableDests = availableDests;
+    LinkAwaitingSendGroup(group);
+    return groupId;
+}
+
+bool BundleStorageCatalog::UpdateAwaitingSendGroup(const uint64_t groupId, const std::vector<std::pair<cbhe_eid_t, bool> > & availableDests) {
+    group_id_to_awaiting_send_group_map_t::iterator it = m_awaitingSendGroups.find(groupId);
+    if (it == m_awaitingSendGroups.end()) {
+        return false;
+    }
+    awaiting_send_group_t & group = it->second;
+    if (group.availableDests != availableDests) {
+        UnlinkAwaitingSendGroup(group);
+        group.availableDests = availableDests;
+        LinkAwaitingSendGroup(group);
+    }
+    return true;
+}
+
+bool BundleStorageCatalog::RemoveAwaitingSendGroup(const uint64_t groupId) {
+    group_id_to_awaiting_send_group_map_t::iterator it = m_awaitingSendGroups.find(groupId);
+    if (it == m_awaitingSendGroups.end()) {
+        return false;
+    }
+    UnlinkAwaitingSendGroup(it->second);
+    m_awaitingSendGroups.erase(it);
+    return true;
+}
+
+catalog_entry_t * BundleStorageCatalog::PopEntryFromAwaitingSendGroup(uint64_t & custodyId, const uint64_t groupId) {
+    group_id_to_awaiting_send_group_map_t::iterator it = m_awaitingSendGroups.find(groupId);
+    if ((it == m_awaitingSendGroups.end()) || it->second.heads.empty()) {
+        return NULL;
+    }
+    const awaiting_send_group_head_t & head = *(it->second.heads.cbegin());
+    awaiting_send_dest_t & dest = *head.destPtr;
+    expirations_to_custids_map_t & expirationMap = dest.priorityArray[(NUMBER_OF_PRIORITIES - 1) - head.priorityRank];
+    expirations_to_custids_map_t::iterator expirationMapIterator = expirationMap.begin();
+    custids_flist_queue_t & custodyIdFlistQueue = expirationMapIterator->second;
+    custodyId = custodyIdFlistQueue.front();
+    custodyIdFlistQueue.pop();
+    if (custodyIdFlistQueue.empty()) {
+        expirationMap.erase(expirationMapIterator);
+    }
+    UpdateAwaitingSendHead(dest); //invalidates head
+    return m_custodyIdToCatalogEntryHashmap.GetValuePtr(custodyId);
+}
+
+void BundleStorageCatalog::OnAwaitingSendDestCreated(dest_eid_to_priorities_map_t::iterator destIt) {
+    awaiting_send_dest_t & dest = destIt->second;
+    dest.eidPtr = &destIt->first;
+    std::map<cbhe_eid_t, std::vector<awaiting_send_group_t*> >::iterator eidIt = m_awaitingSendGroupPtrsByDestEid.find(destIt->first);
+    if (eidIt != m_awaitingSendGroupPtrsByDestEid.end()) {
+        for (std::size_t i = 0; i < eidIt->second.size(); ++i) {
+            AddDestToAwaitingSendGroup(dest, *(eidIt->second[i]));
+        }
+    }
+    std::map<uint64_t, std::vector<awaiting_send_group_t*> >::iterator nodeIt = m_awaitingSendGroupPtrsByWildcardNodeId.find(destIt->first.nodeId);
+    if (nodeIt != m_awaitingSendGroupPtrsByWildcardNodeId.end()) {
+        for (std::size_t i = 0; i < nodeIt->second.size(); ++i) {
+            AddDestToAwaitingSendGroup(dest, *(nodeIt->second[i]));
+        }
+    }
+}
+
+//O(NUMBER_OF_PRIORITIES) if the next bundle of this destination is unchanged, otherwise O(log n) per group containing the destination
+void BundleStorageCatalog::UpdateAwaitingSendHead(awaiting_send_dest_t & dest) {
+    bool hasHead = false;
+    uint64_t headPriorityRank = 0;
+    uint64_t headExpiration = 0;
+    for (int i = NUMBER_OF_PRIORITIES - 1; i >= 0; --i) {
+        const expirations_to_custids_map_t & expirationMap = dest.priorityArray[i];
+        if (!expirationMap.empty()) {
+            hasHead = true;
+            headPriorityRank = (NUMBER_OF_PRIORITIES - 1) - i;
+            headExpiration = expirationMap.cbegin()->first;
+            break;
+        }
+    }
+    if ((hasHead == dest.hasHead) && ((!hasHead) || ((headPriorityRank == dest.headPriorityRank) && (headExpiration == dest.headExpiration)))) {
+        return;
+    }
+    for (std::size_t i = 0; i < dest.groupPtrs.size(); ++i) {
+        std::set<awaiting_send_group_head_t> & heads = dest.groupPtrs[i]->heads;
+        if (dest.hasHead) {
+            heads.erase(awaiting_send_group_head_t({ dest.headPriorityRank, dest.headExpiration, &dest }));
+        }
+        if (hasHead) {
+            heads.insert(awaiting_send_group_head_t({ headPriorityRank, headExpiration, &dest }));
+        }
+    }
+    dest.hasHead = hasHead;
+    dest.headPriorityRank = headPriorityRank;
+    dest.headExpiration = headExpiration;
+}
+
+void BundleStorageCatalog::AddDestToAwaitingSendGroup(awaiting_send_dest_t & dest, awaiting_send_group_t & group) {
+    if (std::find(dest.groupPtrs.cbegin(), dest.groupPtrs.cend(), &group) != dest.groupPtrs.cend()) {
+        return; //e.g. group has both the fully qualified eid and the wildcard for its node
+    }
+    dest.groupPtrs.push_back(&group);
+    group.memberDestPtrs.push_back(&dest);
+    if (dest.hasHead) {
+        group.heads.insert(awaiting_send_group_head_t({ dest.headPriorityRank, dest.headExpiration, &dest }));
+    }
+}
+
+void BundleStorageCatalog::LinkAwaitingSendGroup(awaiting_send_group_t & group) {
+    for (std::size_t i = 0; i < group.availableDests.size(); ++i) {
+        const cbhe_eid_t & eid = group.availableDests[i].first;
+        if (group.availableDests[i].second) { //wildcard * for any service id
+            m_awaitingSendGroupPtrsByWildcardNodeId[eid.nodeId].push_back(&group);
+            for (dest_eid_to_priorities_map_t::iterator dmIt = m_destEidToPrioritiesMap.lower_bound(cbhe_eid_t(eid.nodeId, 0));
+                (dmIt != m_destEidToPrioritiesMap.end()) && (dmIt->first.nodeId == eid.nodeId);
+                ++dmIt)
+            {
+                AddDestToAwaitingSendGroup(dmIt->second, group);
+            }
+        }
+        else { //fully qualified eids
+            m_awaitingSendGroupPtrsByDestEid[eid].push_back(&group);
+            dest_eid_to_priorities_map_t::iterator dmIt = m_destEidToPrioritiesMap.find(eid);
+            if (dmIt != m_destEidToPrioritiesMap.end()) {
+                AddDestToAwaitingSendGroup(dmIt->second, group);
+            }
+        }
+    }
+}
+
+template <typename mapType>
+static void RemoveGroupPtrFromIndex(mapType & index, const typename mapType::key_type & key, awaiting_send_group_t * groupPtr) {
+    typename mapType::iterator it = index.find(key);
+    if (it != index.end()) {
+        std::vector<awaiting_send_group_t*> & groupPtrs = it->second;
+        groupPtrs.erase(std::remove(groupPtrs.begin(), groupPtrs.end(), groupPtr), groupPtrs.end());
+        if (groupPtrs.empty()) {
+            index.erase(it);
+        }
+    }
+}
+
+void BundleStorageCatalog::UnlinkAwaitingSendGroup(awaiting_send_group_t & group) {
+    for (std::size_t i = 0; i < group.availableDests.size(); ++i) {
+        const cbhe_eid_t & eid = group.availableDests[i].first;
+        if (group.availableDests[i].second) {
+            RemoveGroupPtrFromIndex(m_awaitingSendGroupPtrsByWildcardNodeId, eid.nodeId, &group);
+        }
+        else {
+            RemoveGroupPtrFromIndex(m_awaitingSendGroupPtrsByDestEid, eid, &group);
+        }
+    }
+    for (std::size_t i = 0; i < group.memberDestPtrs.size(); ++i) {
+        std::vector<awaiting_send_group_t*> & groupPtrs = group.memberDestPtrs[i]->groupPtrs;
+        groupPtrs.erase(std::remove(groupPtrs.begin(), groupPtrs.end(), &group), groupPtrs.end());
+    }
+    group.memberDestPtrs.clear();
+    group.heads.clear();
+}
+
 
 
 //return pair<success, numSuccessfulRemovals>
@@ -335,7 +576,7 @@ void BundleStorageCatalog::GetExpiredBundleIds(const uint64_t expiry, const uint
 
     for(uint64_t priorityIndex = 0; priorityIndex < NUMBER_OF_PRIORITIES; priorityIndex++) {
         for (dest_eid_to_priorities_map_t::iterator dmIt = m_destEidToPrioritiesMap.begin(); dmIt != m_destEidToPrioritiesMap.end(); ++dmIt) {
-            priorities_to_expirations_array_t & priorityArray = dmIt->second;
+            priorities_to_expirations_array_t & priorityArray = dmIt->second.priorityArray;
             expirations_to_custids_map_t& expirationsMap = priorityArray[priorityIndex];
             for (expirations_to_custids_map_t::iterator expirationsIt = expirationsMap.begin(); expirationsIt != expirationsMap.end(); ++expirationsIt) {
                 const uint64_t thisExpiration = expirationsIt->first;
@@ -367,7 +608,7 @@ bool BundleStorageCatalog::GetStorageExpiringBeforeThresholdTelemetry(StorageExp
 
     for (dest_eid_to_priorities_map_t::iterator dmIt = m_destEidToPrioritiesMap.begin(); dmIt != m_destEidToPrioritiesMap.end(); ++dmIt) {
         const cbhe_eid_t& eid = dmIt->first;
-        priorities_to_expirations_array_t & priorityArray = dmIt->second;
+        priorities_to_expirations_array_t & priorityArray = dmIt->second.priorityArray;
         expirations_to_custids_map_t& expirationsMap = priorityArray[priorityIndex];
         for (expirations_to_custids_map_t::iterator expirationsIt = expirationsMap.begin(); expirationsIt != expirationsMap.end(); ++expirationsIt) {
             const uint64_t thisExpiration = expirationsIt->first;
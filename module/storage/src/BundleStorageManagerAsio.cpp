@@ -47,7 +47,8 @@ BundleStorageManagerAsio::BundleStorageManagerAsio(const StorageConfig_ptr & sto
 
     m_workPtr(boost::make_unique< boost::asio::io_service::work>(m_ioService)),
     m_asioHandlePtrsVec(M_NUM_STORAGE_DISKS),
-    m_diskOperationInProgressVec(M_NUM_STORAGE_DISKS)
+    m_diskOperationInProgressVec(M_NUM_STORAGE_DISKS),
+    m_diskUsingDirectIoVec(M_NUM_STORAGE_DISKS, false)
 {
 
 
@@ -56,6 +57,9 @@ BundleStorageManagerAsio::BundleStorageManagerAsio(const StorageConfig_ptr & sto
 
 BundleStorageManagerAsio::~BundleStorageManagerAsio() {
     if (m_ioServiceThreadPtr) {
+        if (!m_autoDeleteFilesOnExit) {
+            FlushRamCache(); //bundles held only in RAM must be on disk for the next restore
+        }
         try {
             m_workPtr.reset(); //erase the work object (destructor is thread safe) so that io_service thread will exit when it runs out of work 
             m_ioServiceThreadPtr->join();
@@ -79,9 +83,9 @@ void BundleStorageManagerAsio::Start() {
     if (m_storageConfigPtr) {
         for (unsigned int diskId = 0; diskId < M_NUM_STORAGE_DISKS; ++diskId) {
             const boost::filesystem::path& filePath = m_filePathsVec[diskId];
-            const boost::filesystem::path::value_type* filePathCstr = filePath.c_str();
             LOG_INFO(subprocess) << ((m_successfullyRestoredFromDisk) ? "reopening " : "creating ") << filePath;
 #if BOOST_OS_WINDOWS
+            const boost::filesystem::path::value_type* filePathCstr = filePath.c_str();
             //
             //https://docs.microsoft.com/en-us/windows/win32/fileio/synchronous-and-asynchronous-i-o
             //In synchronous file I/O, a thread starts an I/O operation and immediately enters a wait state until the I/O request has completed.
@@ -96,7 +100,8 @@ void BundleStorageManagerAsio::Start() {
                 //CREATE_ALWAYS : Creates a new file, always. If the specified file exists and is writable, the function overwrites the file
                 //OPEN_EXISTING : Opens a file or device, only if it exists.  If the specified file or device does not exist, the function fails and the last - error code is set to ERROR_FILE_NOT_FOUND(2).
                 (m_successfullyRestoredFromDisk) ? OPEN_EXISTING : CREATE_ALWAYS,
-                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED,  // normal file
+                //FILE_FLAG_NO_BUFFERING bypasses the system cache (buffers and offsets are already sector aligned)
+                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | ((m_storageConfigPtr->m_storageDiskConfigVector[diskId].useDirectIo) ? (FILE_FLAG_NO_BUFFERING | FILE_FLAG_WRITE_THROUGH) : 0),  // normal file
                 NULL);                  // no attr. template
 
             if (hFile == INVALID_HANDLE_VALUE) {
@@ -106,20 +111,16 @@ void BundleStorageManagerAsio::Start() {
             //
             //FILE * fileHandle = (m_successfullyRestoredFromDisk) ? fopen(filePath, "r+bR") : fopen(filePath, "w+bR");
             m_asioHandlePtrsVec[diskId] = boost::make_unique<boost::asio::windows::random_access_handle>(m_ioService, hFile);
-#elif (BOOST_OS_MACOS || BOOST_OS_BSD)
-            int file_desc = open(filePathCstr, (m_successfullyRestoredFromDisk) ? (O_RDWR) : (O_CREAT|O_RDWR|O_TRUNC), DEFFILEMODE);
-            if(file_desc < 0) {
-                LOG_ERROR(subprocess) << "error opening " << filePath;
-                return;
-            }
-            m_asioHandlePtrsVec[diskId] = boost::make_unique<boost::asio::posix::stream_descriptor>(m_ioService, file_desc);
-#else // Linux (not WIN32 or APPLE)
-            int file_desc = open(filePathCstr, (m_successfullyRestoredFromDisk) ? (O_RDWR|O_LARGEFILE) : (O_CREAT|O_RDWR|O_TRUNC|O_LARGEFILE), DEFFILEMODE);
+            m_diskUsingDirectIoVec[diskId] = m_storageConfigPtr->m_storageDiskConfigVector[diskId].useDirectIo;
+#else // Linux, APPLE, or BSD
+            bool usingDirectIo;
+            int file_desc = OpenDiskFileDescriptor(diskId, usingDirectIo);
             if(file_desc < 0) {
                 LOG_ERROR(subprocess) << "error opening " << filePath;
                 return;
             }
             m_asioHandlePtrsVec[diskId] = boost::make_unique<boost::asio::posix::stream_descriptor>(m_ioService, file_desc);
+            m_diskUsingDirectIoVec[diskId] = usingDirectIo;
 #endif
             m_diskOperationInProgressVec[diskId] = false;
         }
@@ -128,6 +129,17 @@ void BundleStorageManagerAsio::Start() {
     }
 }
 
+//a scatter read (header to the read cache, payload directly to the bundle) if the read entry has a payload destination
+std::array<boost::asio::mutable_buffer, 2> BundleStorageManagerAsio::ReadBuffers(const unsigned int diskId, const unsigned int cbPtrIndex, uint8_t * const readFromStorageDestPointer) const {
+    uint8_t * const payloadDestPointer = m_circularBufferReadPayloadDestPointers[cbPtrIndex];
+    if (payloadDestPointer && (!m_diskUsingDirectIoVec[diskId])) {
+        return { {
+            boost::asio::buffer((void*)readFromStorageDestPointer, SEGMENT_RESERVED_SPACE),
+            boost::asio::buffer((void*)payloadDestPointer, m_circularBufferReadPayloadSizes[cbPtrIndex]) } };
+    }
+    return { { boost::asio::buffer((void*)readFromStorageDestPointer, SEGMENT_SIZE), boost::asio::mutable_buffer() } };
+}
+
 void BundleStorageManagerAsio::TryDiskOperation_Consume_NotThreadSafe(const unsigned int diskId) {
     if (!m_diskOperationInProgressVec[diskId]) {
         CircularIndexBufferSingleProducerSingleConsumerConfigurable & cb = m_circularIndexBuffersVec[diskId];
@@ -159,16 +171,18 @@ void BundleStorageManagerAsio::TryDiskOperation_Consume_NotThreadSafe(const unsi
             if (isWriteToDisk) {
                 boost::uint8_t * const circularBufferBlockDataPtr = &m_circularBufferBlockDataPtr[diskId * CIRCULAR_INDEX_BUFFER_SIZE * SEGMENT_SIZE];
                 boost::uint8_t * const data = &circularBufferBlockDataPtr[consumeIndex * SEGMENT_SIZE]; //expected data for testing when reading
+                //writes of segments adjacent on this disk (e.g. a multi-segment bundle) are coalesced into one write from adjacent slots
+                const unsigned int numSlotsConsumed = GetNumCoalescableWrites(diskId, consumeIndex, cb.NumInBuffer());
 #if BOOST_OS_WINDOWS
                 boost::asio::async_write_at(*m_asioHandlePtrsVec[diskId], offsetBytes,
 #else
                 boost::asio::async_write(*m_asioHandlePtrsVec[diskId],
 #endif
-                    boost::asio::buffer(data, SEGMENT_SIZE),
+                    boost::asio::buffer(data, numSlotsConsumed * SEGMENT_SIZE),
                     boost::bind(&BundleStorageManagerAsio::HandleDiskOperationCompleted, this,
                         boost::asio::placeholders::error,
                         boost::asio::placeholders::bytes_transferred,
-                        diskId, consumeIndex, false));
+                        diskId, consumeIndex, numSlotsConsumed, false));
 
             }
             else { //read from disk
@@ -177,11 +191,11 @@ void BundleStorageManagerAsio::TryDiskOperation_Consume_NotThreadSafe(const unsi
 #else
                 boost::asio::async_read(*m_asioHandlePtrsVec[diskId],
 #endif
-                    boost::asio::buffer((void*)readFromStorageDestPointer, SEGMENT_SIZE),
+                    ReadBuffers(diskId, diskId * CIRCULAR_INDEX_BUFFER_SIZE + consumeIndex, readFromStorageDestPointer),
                     boost::bind(&BundleStorageManagerAsio::HandleDiskOperationCompleted, this,
                         boost::asio::placeholders::error,
                         boost::asio::placeholders::bytes_transferred,
-                        diskId, consumeIndex, true));
+                        diskId, consumeIndex, 1, true));
             }
         }
     }
@@ -195,22 +209,27 @@ void BundleStorageManagerAsio::CommitWriteAndNotifyDiskOfWorkToDo_ThreadSafe(con
 }
 
 
-void BundleStorageManagerAsio::HandleDiskOperationCompleted(const boost::system::error_code& error, std::size_t bytes_transferred, const unsigned int diskId, const unsigned int consumeIndex, const bool wasReadOperation) {
+void BundleStorageManagerAsio::HandleDiskOperationCompleted(const boost::system::error_code& error, std::size_t bytes_transferred, const unsigned int diskId, const unsigned int consumeIndex, const unsigned int numSlotsConsumed, const bool wasReadOperation) {
     m_diskOperationInProgressVec[diskId] = false;
     if (error) {
         LOG_ERROR(subprocess) << "error in BundleStorageManagerMT::HandleDiskOperationCompleted: " << error.message();
     }
-    else if (bytes_transferred != SEGMENT_SIZE) {
-        LOG_ERROR(subprocess) << "error in BundleStorageManagerMT::HandleDiskOperationCompleted: bytes_transferred(" << bytes_transferred << ") != SEGMENT_SIZE(" << SEGMENT_SIZE << ")";
+    else if (bytes_transferred != (((wasReadOperation) && (!m_diskUsingDirectIoVec[diskId])) ? GetReadSizeBytes(diskId * CIRCULAR_INDEX_BUFFER_SIZE + consumeIndex) : (numSlotsConsumed * SEGMENT_SIZE))) {
+        LOG_ERROR(subprocess) << "error in BundleStorageManagerMT::HandleDiskOperationCompleted: bytes_transferred(" << bytes_transferred << ") != expected";
     }
     else {
+        if (wasReadOperation && m_diskUsingDirectIoVec[diskId]) {
+            CopyReadPayloadToDestination(diskId * CIRCULAR_INDEX_BUFFER_SIZE + consumeIndex);
+        }
         std::atomic<bool> junk;
         std::atomic<bool>& isReadCompletedRef = (wasReadOperation) ?
             *m_circularBufferIsReadCompletedPointers[diskId * CIRCULAR_INDEX_BUFFER_SIZE + consumeIndex].load(std::memory_order_acquire) : junk;
         CircularIndexBufferSingleProducerSingleConsumerConfigurable & cb = m_circularIndexBuffersVec[diskId];
         m_mutexMainThread.lock();
         isReadCompletedRef.store(true, std::memory_order_release);
-        cb.CommitRead();
+        for (unsigned int i = 0; i < numSlotsConsumed; ++i) {
+            cb.CommitRead();
+        }
         m_mutexMainThread.unlock();
         m_conditionVariableMainThread.notify_one();
         TryDiskOperation_Consume_NotThreadSafe(diskId);
@@ -12,6 +12,15 @@
  * See LICENSE.md in the source root directory for more information.
  */
 
+#ifndef _WIN32
+#define _LARGEFILE64_SOURCE
+#define _FILE_OFFSET_BITS 64
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
 #include "BundleStorageManagerBase.h"
 #include <string>
 #include <boost/filesystem/path.hpp>
@@ -19,9 +28,13 @@
 #include <memory>
 #include <boost/make_unique.hpp>
 #include <boost/endian/conversion.hpp>
+#include <boost/align/aligned_alloc.hpp>
 #include "codec/BundleViewV6.h"
 #include "codec/BundleViewV7.h"
 #include <boost/predef/os.h>
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include "ThreadNamer.h"
 
  //#ifdef _MSC_VER //Windows tests
  //static const char * FILE_PATHS[NUM_STORAGE_THREADS] = { "map0.bin", "map1.bin", "map2.bin", "map3.bin" };
@@ -57,7 +70,8 @@ BOOST_FORCEINLINE void StorageSegmentHeader::ToNativeEndianInplace() {
 }
 
 BundleStorageManagerSession_ReadFromDisk::BundleStorageManagerSession_ReadFromDisk() :
-    readCache(new uint8_t[READ_CACHE_NUM_SEGMENTS_PER_SESSION * SEGMENT_SIZE]) {}
+    readCache(static_cast<uint8_t*>(boost::alignment::aligned_alloc(STORAGE_DIRECT_IO_ALIGNMENT_BYTES, READ_CACHE_NUM_SEGMENTS_PER_SESSION * SEGMENT_SIZE))),
+    payloadDestPtr(NULL) {}
 
 BundleStorageManagerSession_ReadFromDisk::~BundleStorageManagerSession_ReadFromDisk() {}
 
@@ -88,8 +102,13 @@ BundleStorageManagerBase::BundleStorageManagerBase(const StorageConfig_ptr & sto
     m_circularBufferSegmentIdsPtr(NULL),
     m_circularBufferIsReadCompletedPointers(), //zero initialize
     m_circularBufferReadFromStoragePointers(), //zero initialize
+    m_circularBufferReadPayloadDestPointers(), //zero initialize
+    m_circularBufferReadPayloadSizes(), //zero initialize
     m_autoDeleteFilesOnExit((m_storageConfigPtr) ? m_storageConfigPtr->m_autoDeleteFilesOnExit : false),
+    m_diskRestoreProgressArray(new DiskRestoreProgress[M_NUM_STORAGE_DISKS]),
+    m_ramCache((m_storageConfigPtr) ? m_storageConfigPtr->m_ramCacheCapacityBytes : 0),
     m_successfullyRestoredFromDisk(false),
+    m_successfullyRestoredFromCatalogJournal(false),
     m_totalBundlesRestored(0),
     m_totalBytesRestored(0),
     m_totalSegmentsRestored(0)
@@ -101,8 +120,21 @@ BundleStorageManagerBase::BundleStorageManagerBase(const StorageConfig_ptr & sto
         return;
     }
 
+    if (!m_storageConfigPtr->m_catalogJournalFilePath.empty()) {
+        m_catalogJournalPtr = boost::make_unique<StorageCatalogJournal>(m_storageConfigPtr->m_catalogJournalFilePath, M_MAX_SEGMENTS, M_NUM_STORAGE_DISKS);
+    }
+
     if (m_storageConfigPtr->m_tryToRestoreFromDisk) {
-        m_successfullyRestoredFromDisk = RestoreFromDisk(&m_totalBundlesRestored, &m_totalBytesRestored, &m_totalSegmentsRestored);
+        if (m_catalogJournalPtr) {
+            m_successfullyRestoredFromCatalogJournal = RestoreFromCatalogJournal(&m_totalBundlesRestored, &m_totalBytesRestored, &m_totalSegmentsRestored);
+            m_successfullyRestoredFromDisk = m_successfullyRestoredFromCatalogJournal;
+            if (!m_successfullyRestoredFromCatalogJournal) {
+                LOG_INFO(subprocess) << "unable to restore from the catalog journal, restoring by scanning the disks";
+            }
+        }
+        if (!m_successfullyRestoredFromDisk) {
+            m_successfullyRestoredFromDisk = RestoreFromDisk(&m_totalBundlesRestored, &m_totalBytesRestored, &m_totalSegmentsRestored);
+        }
     }
 
 
@@ -116,15 +148,28 @@ BundleStorageManagerBase::BundleStorageManagerBase(const StorageConfig_ptr & sto
         return;
     }
 
-    m_circularBufferBlockDataPtr = (uint8_t*)malloc(CIRCULAR_INDEX_BUFFER_SIZE * M_NUM_STORAGE_DISKS * SEGMENT_SIZE * sizeof(uint8_t));
+    m_circularBufferBlockDataPtr = (uint8_t*)boost::alignment::aligned_alloc(STORAGE_DIRECT_IO_ALIGNMENT_BYTES, CIRCULAR_INDEX_BUFFER_SIZE * M_NUM_STORAGE_DISKS * SEGMENT_SIZE * sizeof(uint8_t));
     m_circularBufferSegmentIdsPtr = (segment_id_t*)malloc(CIRCULAR_INDEX_BUFFER_SIZE * M_NUM_STORAGE_DISKS * sizeof(segment_id_t));
 
+    //whatever was restored (or the empty catalog) becomes the snapshot that the new journal follows
+    if (m_catalogJournalPtr && (!WriteCatalogSnapshot())) {
+        m_catalogJournalPtr.reset();
+    }
 
 }
 
 BundleStorageManagerBase::~BundleStorageManagerBase() {
 
-    free(m_circularBufferBlockDataPtr);
+    if (m_catalogJournalPtr) {
+        if (m_autoDeleteFilesOnExit) {
+            m_catalogJournalPtr->DeleteFiles();
+        }
+        else {
+            WriteCatalogSnapshot(); //so that the next restore need not replay any journal
+        }
+    }
+
+    boost::alignment::aligned_free(m_circularBufferBlockDataPtr);
     free(m_circularBufferSegmentIdsPtr);
 
     for (unsigned int diskId = 0; diskId < M_NUM_STORAGE_DISKS; ++diskId) {
@@ -142,9 +187,51 @@ BundleStorageManagerBase::~BundleStorageManagerBase() {
 }
 
 
+#ifndef _WIN32
+int BundleStorageManagerBase::OpenDiskFileDescriptor(const unsigned int diskId, bool & usingDirectIo) const {
+    const boost::filesystem::path& filePath = m_filePathsVec[diskId];
+    const boost::filesystem::path::value_type* filePathCstr = filePath.c_str();
+#if (BOOST_OS_MACOS || BOOST_OS_BSD)
+    const int openFlags = (m_successfullyRestoredFromDisk) ? (O_RDWR) : (O_CREAT | O_RDWR | O_TRUNC);
+#else // Linux (not WIN32 or APPLE)
+    const int openFlags = (m_successfullyRestoredFromDisk) ? (O_RDWR | O_LARGEFILE) : (O_CREAT | O_RDWR | O_TRUNC | O_LARGEFILE);
+#endif
+    usingDirectIo = false;
+    if (m_storageConfigPtr->m_storageDiskConfigVector[diskId].useDirectIo) {
+#if defined(O_DIRECT)
+        const int fileDescriptor = open(filePathCstr, openFlags | O_DIRECT, DEFFILEMODE);
+        if (fileDescriptor >= 0) {
+            usingDirectIo = true;
+            LOG_INFO(subprocess) << "opened " << filePath << " with direct I/O";
+            return fileDescriptor;
+        }
+        LOG_WARNING(subprocess) << "unable to open " << filePath << " with O_DIRECT (" << strerror(errno) << "), falling back to page cached I/O";
+#elif defined(F_NOCACHE)
+        const int fileDescriptor = open(filePathCstr, openFlags, DEFFILEMODE);
+        if (fileDescriptor >= 0) {
+            if (fcntl(fileDescriptor, F_NOCACHE, 1) != -1) {
+                usingDirectIo = true;
+                LOG_INFO(subprocess) << "opened " << filePath << " with direct I/O";
+            }
+            else {
+                LOG_WARNING(subprocess) << "unable to set F_NOCACHE on " << filePath << ", falling back to page cached I/O";
+            }
+        }
+        return fileDescriptor;
+#else
+        LOG_WARNING(subprocess) << "direct I/O is not supported on this platform, opening " << filePath << " with page cached I/O";
+#endif
+    }
+    return open(filePathCstr, openFlags, DEFFILEMODE);
+}
+#endif
+
 const MemoryManagerTreeArray& BundleStorageManagerBase::GetMemoryManagerConstRef() const {
     return m_memoryManager;
 }
+const BundleStorageRamCache& BundleStorageManagerBase::GetRamCacheConstRef() const {
+    return m_ramCache;
+}
 const BundleStorageCatalog& BundleStorageManagerBase::GetBundleStorageCatalogConstRef() const {
     return m_bundleStorageCatalog;
 }
@@ -184,12 +271,26 @@ int BundleStorageManagerBase::PushSegment(BundleStorageManagerSession_WriteToDis
     if (session.nextLogicalSegment >= segmentIdChainVec.size()) {
         return 0;
     }
+    WriteSegmentToDisk(catalogEntry, session.nextLogicalSegment++, custodyId, buf, size);
+    if (session.nextLogicalSegment == segmentIdChainVec.size()) {
+        if (m_bundleStorageCatalog.CatalogIncomingBundleForStore(catalogEntry, bundlePrimaryBlock, custodyId, BundleStorageCatalog::DUPLICATE_EXPIRY_ORDER::FIFO) && m_catalogJournalPtr) {
+            OnCatalogJournalRecordWritten(m_catalogJournalPtr->LogStore(custodyId, *m_bundleStorageCatalog.GetEntryFromCustodyId(custodyId)));
+        }
+    }
+
+    return 1;
+}
+
+void BundleStorageManagerBase::WriteSegmentToDisk(const catalog_entry_t & catalogEntry, const uint32_t logicalSegment,
+    const uint64_t custodyId, const uint8_t * buf, std::size_t size)
+{
+    const segment_id_chain_vec_t & segmentIdChainVec = catalogEntry.segmentIdChainVec;
     StorageSegmentHeaderUnion storageSegmentHeaderUnion;
     StorageSegmentHeader& storageSegmentHeader = storageSegmentHeaderUnion.hdr;
     //note: SEGMENT_RESERVED_SPACE is 4 bytes smaller than sizeof(StorageSegmentHeader) if segment_id_t is 32-bit
-    storageSegmentHeader.bundleSizeBytes = (session.nextLogicalSegment == 0) ? catalogEntry.bundleSizeBytes : UINT64_MAX;
-    storageSegmentHeader.payloadSizeBytes = (session.nextLogicalSegment == 0) ? catalogEntry.payloadSizeBytes : UINT64_MAX;
-    const segment_id_t segmentId = segmentIdChainVec[session.nextLogicalSegment++];
+    storageSegmentHeader.bundleSizeBytes = (logicalSegment == 0) ? catalogEntry.bundleSizeBytes : UINT64_MAX;
+    storageSegmentHeader.payloadSizeBytes = (logicalSegment == 0) ? catalogEntry.payloadSizeBytes : UINT64_MAX;
+    const segment_id_t segmentId = segmentIdChainVec[logicalSegment];
     const unsigned int diskIndex = segmentId % M_NUM_STORAGE_DISKS;
     CircularIndexBufferSingleProducerSingleConsumerConfigurable & cb = m_circularIndexBuffersVec[diskIndex];
     unsigned int produceIndex = cb.GetIndexForWrite();
@@ -212,18 +313,40 @@ int BundleStorageManagerBase::PushSegment(BundleStorageManagerSession_WriteToDis
     circularBufferSegmentIdsPtr[produceIndex] = segmentId;
     m_circularBufferReadFromStoragePointers[diskIndex * CIRCULAR_INDEX_BUFFER_SIZE + produceIndex].store(NULL, std::memory_order_release); //isWriteToDisk = true
 
-    storageSegmentHeader.nextSegmentId = (session.nextLogicalSegment == segmentIdChainVec.size()) ? SEGMENT_ID_LAST : segmentIdChainVec[session.nextLogicalSegment];
+    storageSegmentHeader.nextSegmentId = ((logicalSegment + 1) == segmentIdChainVec.size()) ? SEGMENT_ID_LAST : segmentIdChainVec[logicalSegment + 1];
     storageSegmentHeader.custodyId = custodyId;
     storageSegmentHeader.ToLittleEndianInplace(); //should optimize out and do nothing
     memcpy(dataCb, storageSegmentHeaderUnion.rawBytes, SEGMENT_RESERVED_SPACE);
     memcpy(dataCb + SEGMENT_RESERVED_SPACE, buf, size);
 
     CommitWriteAndNotifyDiskOfWorkToDo_ThreadSafe(diskIndex);
-    if (session.nextLogicalSegment == segmentIdChainVec.size()) {
-        m_bundleStorageCatalog.CatalogIncomingBundleForStore(catalogEntry, bundlePrimaryBlock, custodyId, BundleStorageCatalog::DUPLICATE_EXPIRY_ORDER::FIFO);
+}
+
+bool BundleStorageManagerBase::FlushOldestRamCacheBundleToDisk() {
+    uint64_t custodyId;
+    padded_vector_uint8_t bundleData;
+    if (!m_ramCache.PopOldestForFlush(custodyId, bundleData)) {
+        return false;
+    }
+    const catalog_entry_t * const catalogEntryPtr = m_bundleStorageCatalog.GetEntryFromCustodyId(custodyId);
+    if (catalogEntryPtr == NULL) {
+        LOG_ERROR(subprocess) << "RAM cached bundle with custody id " << custodyId << " is not in the catalog, dropping it";
+        return true;
     }
+    const uint32_t numSegments = static_cast<uint32_t>(catalogEntryPtr->segmentIdChainVec.size());
+    for (uint32_t i = 0; i < numSegments; ++i) {
+        const uint64_t offset = static_cast<uint64_t>(i) * BUNDLE_STORAGE_PER_SEGMENT_SIZE;
+        const std::size_t bytesToCopy = static_cast<std::size_t>(std::min(static_cast<uint64_t>(BUNDLE_STORAGE_PER_SEGMENT_SIZE), bundleData.size() - offset));
+        WriteSegmentToDisk(*catalogEntryPtr, i, custodyId, &bundleData[offset], bytesToCopy);
+    }
+    if (m_catalogJournalPtr) {
+        OnCatalogJournalRecordWritten(m_catalogJournalPtr->LogStore(custodyId, *catalogEntryPtr));
+    }
+    return true;
+}
 
-    return 1;
+void BundleStorageManagerBase::FlushRamCache() {
+    while (FlushOldestRamCacheBundleToDisk()) {}
 }
 
 //return total bytes pushed
@@ -231,8 +354,26 @@ uint64_t BundleStorageManagerBase::PushAllSegments(BundleStorageManagerSession_W
     const PrimaryBlock & bundlePrimaryBlock,
     const uint64_t custodyId, const uint8_t * allData, const std::size_t allDataSize)
 {
+    catalog_entry_t & catalogEntry = session.catalogEntry;
+    //custody is accepted once a bundle is stored, so a custody bundle must never have its only copy in volatile RAM
+    if ((session.nextLogicalSegment == 0) && (!catalogEntry.segmentIdChainVec.empty()) && m_ramCache.CanHold(allDataSize)
+        && (!bundlePrimaryBlock.HasCustodyFlagSet()))
+    {
+        //hold the whole bundle in RAM, it is only written to disk if the RAM cache needs the room before the bundle is deleted
+        while (m_ramCache.NeedsFlushToHold(allDataSize)) {
+            FlushOldestRamCacheBundleToDisk();
+        }
+        if (m_ramCache.Insert(catalogEntry.segmentIdChainVec[0], custodyId, allData, allDataSize)) {
+            session.nextLogicalSegment = static_cast<uint32_t>(catalogEntry.segmentIdChainVec.size());
+            //not journaled until flushed to disk
+            if (!m_bundleStorageCatalog.CatalogIncomingBundleForStore(catalogEntry, bundlePrimaryBlock, custodyId, BundleStorageCatalog::DUPLICATE_EXPIRY_ORDER::FIFO)) {
+                m_ramCache.Erase(catalogEntry.segmentIdChainVec[0]);
+            }
+            return allDataSize;
+        }
+    }
     uint64_t totalBytesCopied = 0;
-    const uint64_t totalSegmentsRequired = session.catalogEntry.segmentIdChainVec.size();
+    const uint64_t totalSegmentsRequired = catalogEntry.segmentIdChainVec.size();
     for (uint64_t i = 0; i < totalSegmentsRequired; ++i) {
         std::size_t bytesToCopy = BUNDLE_STORAGE_PER_SEGMENT_SIZE;
         if (i == totalSegmentsRequired - 1) {
@@ -288,6 +429,28 @@ uint64_t BundleStorageManagerBase::PopTop(BundleStorageManagerSession_ReadFromDi
 
     return session.catalogEntryPtr->bundleSizeBytes;
 }
+uint64_t BundleStorageManagerBase::PopTopFromAwaitingSendGroup(BundleStorageManagerSession_ReadFromDisk & session, const uint64_t awaitingSendGroupId) { //0 if empty, size if entry
+
+    session.catalogEntryPtr = m_bundleStorageCatalog.PopEntryFromAwaitingSendGroup(session.custodyId, awaitingSendGroupId);
+    if (session.catalogEntryPtr == NULL) {
+        return 0;
+    }
+    session.nextLogicalSegment = 0;
+    session.nextLogicalSegmentToCache = 0;
+    session.cacheReadIndex = 0;
+    session.cacheWriteIndex = 0;
+
+    return session.catalogEntryPtr->bundleSizeBytes;
+}
+uint64_t BundleStorageManagerBase::AddAwaitingSendGroup(const std::vector<std::pair<cbhe_eid_t, bool> > & availableDests) {
+    return m_bundleStorageCatalog.AddAwaitingSendGroup(availableDests);
+}
+bool BundleStorageManagerBase::UpdateAwaitingSendGroup(const uint64_t awaitingSendGroupId, const std::vector<std::pair<cbhe_eid_t, bool> > & availableDests) {
+    return m_bundleStorageCatalog.UpdateAwaitingSendGroup(awaitingSendGroupId, availableDests);
+}
+bool BundleStorageManagerBase::RemoveAwaitingSendGroup(const uint64_t awaitingSendGroupId) {
+    return m_bundleStorageCatalog.RemoveAwaitingSendGroup(awaitingSendGroupId);
+}
 
 
 bool BundleStorageManagerBase::ReturnTop(BundleStorageManagerSession_ReadFromDisk & session) { //0 if empty, size if entry
@@ -307,10 +470,28 @@ catalog_entry_t * BundleStorageManagerBase::GetCatalogEntryPtrFromCustodyId(cons
 std::size_t BundleStorageManagerBase::TopSegment(BundleStorageManagerSession_ReadFromDisk & session, void * buf) {
     const segment_id_chain_vec_t & segments = session.catalogEntryPtr->segmentIdChainVec;
 
+    //serve the segment from the RAM cache if the bundle is there and this session has no reads from disk outstanding
+    //(if the bundle is flushed to disk midway, the rest is read from disk after the flush's writes to the same segments)
+    if (m_ramCache.IsEnabled() && (session.nextLogicalSegmentToCache == session.nextLogicalSegment)) {
+        const padded_vector_uint8_t * const cachedBundlePtr = m_ramCache.Find(segments[0]);
+        if (session.nextLogicalSegment == 0) {
+            m_ramCache.CountRead(cachedBundlePtr != NULL);
+        }
+        if (cachedBundlePtr) {
+            const uint64_t offset = static_cast<uint64_t>(session.nextLogicalSegment) * BUNDLE_STORAGE_PER_SEGMENT_SIZE;
+            const std::size_t size = static_cast<std::size_t>(std::min(static_cast<uint64_t>(BUNDLE_STORAGE_PER_SEGMENT_SIZE), cachedBundlePtr->size() - offset));
+            memcpy(buf, cachedBundlePtr->data() + offset, size);
+            ++session.nextLogicalSegment;
+            ++session.nextLogicalSegmentToCache;
+            return size;
+        }
+    }
+
     while (((session.nextLogicalSegmentToCache - session.nextLogicalSegment) < READ_CACHE_NUM_SEGMENTS_PER_SESSION)
         && (session.nextLogicalSegmentToCache < segments.size()))
     {
-        const segment_id_t segmentId = segments[session.nextLogicalSegmentToCache++];
+        const uint32_t logicalSegment = session.nextLogicalSegmentToCache++;
+        const segment_id_t segmentId = segments[logicalSegment];
         const unsigned int diskIndex = segmentId % M_NUM_STORAGE_DISKS;
         CircularIndexBufferSingleProducerSingleConsumerConfigurable & cb = m_circularIndexBuffersVec[diskIndex];
         unsigned int produceIndex = cb.GetIndexForWrite();
@@ -330,8 +511,18 @@ std::size_t BundleStorageManagerBase::TopSegment(BundleStorageManagerSession_Rea
         m_circularBufferIsReadCompletedPointers[cbPtrIndex].store(
             &session.readCacheIsSegmentReady[session.cacheWriteIndex], std::memory_order_release);
         m_circularBufferSegmentIdsPtr[cbPtrIndex] = segmentId;
+        if (session.payloadDestPtr) {
+            const uint64_t payloadOffset = static_cast<uint64_t>(logicalSegment) * BUNDLE_STORAGE_PER_SEGMENT_SIZE;
+            m_circularBufferReadPayloadDestPointers[cbPtrIndex] = session.payloadDestPtr + payloadOffset;
+            m_circularBufferReadPayloadSizes[cbPtrIndex] = static_cast<uint32_t>(
+                std::min(static_cast<uint64_t>(BUNDLE_STORAGE_PER_SEGMENT_SIZE), session.catalogEntryPtr->bundleSizeBytes - payloadOffset));
+        }
+        else {
+            m_circularBufferReadPayloadDestPointers[cbPtrIndex] = NULL;
+            m_circularBufferReadPayloadSizes[cbPtrIndex] = 0;
+        }
         m_circularBufferReadFromStoragePointers[cbPtrIndex].store(
-            &session.readCache[session.cacheWriteIndex * SEGMENT_SIZE], std::memory_order_release);
+            &session.readCache.get()[session.cacheWriteIndex * SEGMENT_SIZE], std::memory_order_release);
         session.cacheWriteIndex = (session.cacheWriteIndex + 1) % READ_CACHE_NUM_SEGMENTS_PER_SESSION;
 
         CommitWriteAndNotifyDiskOfWorkToDo_ThreadSafe(diskIndex);
@@ -350,7 +541,7 @@ std::size_t BundleStorageManagerBase::TopSegment(BundleStorageManagerSession_Rea
     StorageSegmentHeaderUnion storageSegmentHeaderUnion;
     StorageSegmentHeader& storageSegmentHeader = storageSegmentHeaderUnion.hdr;
     //note: SEGMENT_RESERVED_SPACE is 4 bytes smaller than sizeof(StorageSegmentHeader) if segment_id_t is 32-bit
-    memcpy(storageSegmentHeaderUnion.rawBytes, &session.readCache[session.cacheReadIndex * SEGMENT_SIZE + 0], SEGMENT_RESERVED_SPACE);
+    memcpy(storageSegmentHeaderUnion.rawBytes, &session.readCache.get()[session.cacheReadIndex * SEGMENT_SIZE + 0], SEGMENT_RESERVED_SPACE);
     storageSegmentHeader.ToNativeEndianInplace(); //should optimize out and do nothing
     if ((session.nextLogicalSegment == 0) && (storageSegmentHeader.bundleSizeBytes != session.catalogEntryPtr->bundleSizeBytes)) {// ? chainInfo.first : UINT64_MAX;
         LOG_ERROR(subprocess) << "Error: read bundle size bytes = " << storageSegmentHeader.bundleSizeBytes <<
@@ -385,12 +576,42 @@ std::size_t BundleStorageManagerBase::TopSegment(BundleStorageManagerSession_Rea
         }
     }
 
-    memcpy(buf, &session.readCache[session.cacheReadIndex * SEGMENT_SIZE + SEGMENT_RESERVED_SPACE], size);
+    if (session.payloadDestPtr == NULL) { //otherwise the disk thread already read the payload into its place in the bundle
+        memcpy(buf, &session.readCache.get()[session.cacheReadIndex * SEGMENT_SIZE + SEGMENT_RESERVED_SPACE], size);
+    }
     session.cacheReadIndex = (session.cacheReadIndex + 1) % READ_CACHE_NUM_SEGMENTS_PER_SESSION;
 
 
     return size;
 }
+std::size_t BundleStorageManagerBase::GetReadSizeBytes(const unsigned int cbPtrIndex) const noexcept {
+    return (m_circularBufferReadPayloadDestPointers[cbPtrIndex]) ?
+        (SEGMENT_RESERVED_SPACE + m_circularBufferReadPayloadSizes[cbPtrIndex]) : SEGMENT_SIZE;
+}
+void BundleStorageManagerBase::CopyReadPayloadToDestination(const unsigned int cbPtrIndex) const {
+    if (uint8_t * const payloadDestPtr = m_circularBufferReadPayloadDestPointers[cbPtrIndex]) {
+        memcpy(payloadDestPtr, m_circularBufferReadFromStoragePointers[cbPtrIndex].load(std::memory_order_acquire) + SEGMENT_RESERVED_SPACE,
+            m_circularBufferReadPayloadSizes[cbPtrIndex]);
+    }
+}
+unsigned int BundleStorageManagerBase::GetNumCoalescableWrites(const unsigned int diskIndex, const unsigned int consumeIndex, const unsigned int numInBuffer) const {
+    const unsigned int cbPtrIndexStart = diskIndex * CIRCULAR_INDEX_BUFFER_SIZE;
+    segment_id_t previousSegmentId = m_circularBufferSegmentIdsPtr[cbPtrIndexStart + consumeIndex];
+    unsigned int numWrites = 1;
+    while ((numWrites < numInBuffer) && ((consumeIndex + numWrites) < CIRCULAR_INDEX_BUFFER_SIZE)) {
+        const unsigned int cbPtrIndex = cbPtrIndexStart + consumeIndex + numWrites;
+        if (m_circularBufferReadFromStoragePointers[cbPtrIndex].load(std::memory_order_acquire) != NULL) { //a read
+            break;
+        }
+        const segment_id_t segmentId = m_circularBufferSegmentIdsPtr[cbPtrIndex];
+        if ((segmentId == SEGMENT_ID_LAST) || (segmentId != (previousSegmentId + M_NUM_STORAGE_DISKS))) {
+            break;
+        }
+        previousSegmentId = segmentId;
+        ++numWrites;
+    }
+    return numWrites;
+}
 bool BundleStorageManagerBase::ReadFirstSegment(BundleStorageManagerSession_ReadFromDisk & session, catalog_entry_t * entry, std::vector<uint8_t> & buf) {
     if(entry == NULL) {
         return 0;
@@ -416,10 +637,12 @@ bool BundleStorageManagerBase::ReadAllSegments(BundleStorageManagerSession_ReadF
     const std::size_t numSegmentsToRead = session.catalogEntryPtr->segmentIdChainVec.size();
     const uint64_t totalBytesToRead = session.catalogEntryPtr->bundleSizeBytes;
     buf.resize(totalBytesToRead);
+    session.payloadDestPtr = buf.data(); //zero copy: the disk threads read each segment's payload directly into buf
     std::size_t totalBytesRead = 0;
     for (std::size_t i = 0; i < numSegmentsToRead; ++i) {
         totalBytesRead += TopSegment(session, &buf[i*BUNDLE_STORAGE_PER_SEGMENT_SIZE]);
     }
+    session.payloadDestPtr = NULL;
     return (totalBytesRead == totalBytesToRead);
 }
 bool BundleStorageManagerBase::RemoveBundleFromDisk(const catalog_entry_t *catalogEntryPtr, const uint64_t custodyId) {
@@ -452,11 +675,22 @@ bool BundleStorageManagerBase::RemoveReadBundleFromDisk(BundleStorageManagerSess
 bool BundleStorageManagerBase::RemoveReadBundleFromDisk(const catalog_entry_t * catalogEntryPtr, const uint64_t custodyId) {
     const segment_id_chain_vec_t & segmentIdChainVec = catalogEntryPtr->segmentIdChainVec;
 
-    //destroy the head on the disk by writing UINT64_MAX to bundleSizeBytes of first logical segment
-
+    //a bundle still in the RAM cache was never written to disk (nor journaled), so there is no head on the disk to destroy
+    const bool wasOnDisk = !m_ramCache.Erase(segmentIdChainVec[0]);
+    if (wasOnDisk) {
+        DestroyHeadSegmentOnDisk(segmentIdChainVec[0]);
+    }
 
+    const bool successFreedSegments = m_memoryManager.FreeSegments_ThreadSafe(segmentIdChainVec);
+    const bool successRemovedFromCatalog = m_bundleStorageCatalog.Remove(custodyId, false).first;
+    if (successRemovedFromCatalog && wasOnDisk && m_catalogJournalPtr) {
+        OnCatalogJournalRecordWritten(m_catalogJournalPtr->LogRemove(custodyId));
+    }
+    return (successRemovedFromCatalog && successFreedSegments);
+}
+void BundleStorageManagerBase::DestroyHeadSegmentOnDisk(const segment_id_t segmentId) {
+    //destroy the head on the disk by writing UINT64_MAX to bundleSizeBytes of first logical segment
     static const uint64_t bundleSizeBytesLittleEndian = UINT64_MAX;
-    const segment_id_t segmentId = segmentIdChainVec[0];
     const unsigned int diskIndex = segmentId % M_NUM_STORAGE_DISKS;
     CircularIndexBufferSingleProducerSingleConsumerConfigurable & cb = m_circularIndexBuffersVec[diskIndex];
     unsigned int produceIndex = cb.GetIndexForWrite();
@@ -483,9 +717,6 @@ bool BundleStorageManagerBase::RemoveReadBundleFromDisk(const catalog_entry_t *
 
 
     CommitWriteAndNotifyDiskOfWorkToDo_ThreadSafe(diskIndex);
-
-    const bool successFreedSegments = m_memoryManager.FreeSegments_ThreadSafe(segmentIdChainVec);
-    return (m_bundleStorageCatalog.Remove(custodyId, false).first && successFreedSegments);
 }
 uint64_t * BundleStorageManagerBase::GetCustodyIdFromUuid(const cbhe_bundle_uuid_t & bundleUuid) {
     return m_bundleStorageCatalog.GetCustodyIdFromUuid(bundleUuid);
@@ -503,158 +734,360 @@ void BundleStorageManagerBase::GetExpiredBundleIds(const uint64_t expiry, const
 //	return session.chainInfoVecPtr->front().second.size(); //use the front as new writes will be pushed back
 //}
 
-bool BundleStorageManagerBase::RestoreFromDisk(uint64_t * totalBundlesRestored, uint64_t * totalBytesRestored, uint64_t * totalSegmentsRestored) {
-    *totalBundlesRestored = 0; *totalBytesRestored = 0; *totalSegmentsRestored = 0;
-    uint8_t dataReadBuf[SEGMENT_SIZE];
-    std::vector<FILE *> fileHandlesVec(M_NUM_STORAGE_DISKS);
-    std::vector <uint64_t> fileSizesVec(M_NUM_STORAGE_DISKS);
-    for (unsigned int diskId = 0; diskId < M_NUM_STORAGE_DISKS; ++diskId) {
-        const char * const filePath = m_storageConfigPtr->m_storageDiskConfigVector[diskId].storeFilePath.c_str();
-        const boost::filesystem::path p(filePath);
-        if (boost::filesystem::exists(p)) {
-            fileSizesVec[diskId] = boost::filesystem::file_size(p);
-            LOG_DEBUG(subprocess) << "diskId " << diskId
-                << " has file size of " << fileSizesVec[diskId];
-        }
-        else {
-            LOG_ERROR(subprocess) << "Error: " << filePath << " does not exist";
-            return false;
-        }
-        fileHandlesVec[diskId] = fopen(filePath, "rbR");
-        if (fileHandlesVec[diskId] == NULL) {
-            LOG_ERROR(subprocess) << "Error opening file " << filePath <<
-                " for reading and restoring";
-            return false;
-        }
-    }
+//a bundle found by a disk's restore thread, cataloged later (in head segment id order) by RestoreFromDisk
+struct BundleStorageManagerBase::RestoredBundle {
+    RestoredBundle() : custodyId(0), nextSegmentId(SEGMENT_ID_LAST) {}
+    uint64_t custodyId;
+    segment_id_t nextSegmentId; //from the head segment, used to follow the chain
+    catalog_entry_t catalogEntry; //segmentIdChainVec[0] is the head segment id
+    std::unique_ptr<PrimaryBlock> primaryPtr;
+};
 
-    bool restoreInProgress = true;
-    BundleViewV6 bv6;
-    BundleViewV7 bv7;
-    for (segment_id_t potentialHeadSegmentId = 0; restoreInProgress; ++potentialHeadSegmentId) {
-        if (!m_memoryManager.IsSegmentFree(potentialHeadSegmentId)) continue;
-        segment_id_t segmentId = potentialHeadSegmentId;
-        BundleStorageManagerSession_WriteToDisk session;
-        catalog_entry_t & catalogEntry = session.catalogEntry;
-        segment_id_chain_vec_t & segmentIdChainVec = catalogEntry.segmentIdChainVec;
-        bool headSegmentFound = false;
-        uint64_t custodyIdHeadSegment = 0; //initialization doesn't matter, only used if headSegmentFound
-        PrimaryBlock * primaryBasePtr = NULL;
-        for (session.nextLogicalSegment = 0; ; ++session.nextLogicalSegment) {
-            const unsigned int diskIndex = segmentId % M_NUM_STORAGE_DISKS;
-            FILE * const fileHandle = fileHandlesVec[diskIndex];
-            const uint64_t offsetBytes = static_cast<uint64_t>(segmentId / M_NUM_STORAGE_DISKS) * SEGMENT_SIZE;
-            const uint64_t fileSize = fileSizesVec[diskIndex];
-            if ((session.nextLogicalSegment == 0) && ((offsetBytes + SEGMENT_SIZE) > fileSize)) {
-                LOG_INFO(subprocess) << "end of restore";
-                restoreInProgress = false;
-                break;
-            }
+BundleStorageManagerBase::DiskRestoreProgress::DiskRestoreProgress() :
+    bytesScanned(0),
+    totalBytesToScan(0),
+    bundlesRestored(0),
+    bundleBytesRestored(0),
+    segmentsRestored(0),
+    restoreAttempted(false),
+    restoreCompleted(false) {}
+
+//number of segments read per fread while sequentially scanning a disk for head segments
+static constexpr uint64_t RESTORE_READ_NUM_SEGMENTS_PER_CHUNK = 256;
+
+static bool SeekStorageFile(FILE * fileHandle, const uint64_t offsetBytes) {
 #ifdef _MSC_VER 
-            _fseeki64_nolock(fileHandle, offsetBytes, SEEK_SET);
+    return _fseeki64_nolock(fileHandle, offsetBytes, SEEK_SET) == 0;
 #elif (BOOST_OS_MACOS || BOOST_OS_BSD)
-            fseeko(fileHandle, offsetBytes, SEEK_SET);
+    return fseeko(fileHandle, offsetBytes, SEEK_SET) == 0;
 #else //Linux or other OS
-            fseeko64(fileHandle, offsetBytes, SEEK_SET);
+    return fseeko64(fileHandle, offsetBytes, SEEK_SET) == 0;
 #endif
+}
 
-            const std::size_t bytesReadFromFread = fread((void*)dataReadBuf, 1, SEGMENT_SIZE, fileHandle);
-            if (bytesReadFromFread != SEGMENT_SIZE) {
-                LOG_ERROR(subprocess) << "Error reading at offset " << offsetBytes <<
-                    " for disk " << diskIndex << " filesize " << fileSize << " logical segment "
-                    << session.nextLogicalSegment << " bytesread " << bytesReadFromFread;
-                return false;
-            }
-
-            StorageSegmentHeaderUnion storageSegmentHeaderUnion;
-            StorageSegmentHeader& storageSegmentHeader = storageSegmentHeaderUnion.hdr;
-            //note: SEGMENT_RESERVED_SPACE is 4 bytes smaller than sizeof(StorageSegmentHeader) if segment_id_t is 32-bit
-            memcpy(storageSegmentHeaderUnion.rawBytes, dataReadBuf, SEGMENT_RESERVED_SPACE);
-            storageSegmentHeader.ToNativeEndianInplace(); //should optimize out and do nothing
+void BundleStorageManagerBase::RestoreDiskThreadFunc(const unsigned int diskId,
+    std::vector<std::unique_ptr<RestoredBundle> >& restoredBundlesVec, std::atomic<bool>& restoreErrorOccurred)
+{
+    ThreadNamer::SetThisThreadName("StorageRestoreDisk" + boost::lexical_cast<std::string>(diskId));
+    DiskRestoreProgress& progress = m_diskRestoreProgressArray[diskId];
+
+    //bundle chains are striped across all disks, so every restore thread gets its own handle to every file
+    typedef std::unique_ptr<FILE, decltype(&fclose)> file_ptr_t;
+    std::vector<file_ptr_t> fileHandlesVec;
+    fileHandlesVec.reserve(M_NUM_STORAGE_DISKS);
+    for (unsigned int i = 0; i < M_NUM_STORAGE_DISKS; ++i) {
+        const char * const filePath = m_storageConfigPtr->m_storageDiskConfigVector[i].storeFilePath.c_str();
+        fileHandlesVec.emplace_back(fopen(filePath, "rbR"), &fclose);
+        if (!fileHandlesVec.back()) {
+            LOG_ERROR(subprocess) << "Error opening file " << filePath << " for reading and restoring";
+            restoreErrorOccurred = true;
+            return;
+        }
+    }
 
-            
-            if ((session.nextLogicalSegment == 0) && (storageSegmentHeader.bundleSizeBytes != UINT64_MAX)) { //head segment
-                headSegmentFound = true;
-                custodyIdHeadSegment = storageSegmentHeader.custodyId;
+    //first pass: read this disk sequentially and parse the primary block of every head segment
+    {
+        FILE * const fileHandle = fileHandlesVec[diskId].get();
+        const uint64_t numSegmentsOnDisk = progress.totalBytesToScan.load(std::memory_order_relaxed) / SEGMENT_SIZE;
+        std::vector<uint8_t> chunk(RESTORE_READ_NUM_SEGMENTS_PER_CHUNK * SEGMENT_SIZE);
+        BundleViewV6 bv6;
+        BundleViewV7 bv7;
+        for (uint64_t localSegmentIndex = 0; localSegmentIndex < numSegmentsOnDisk; ) {
+            if (restoreErrorOccurred.load(std::memory_order_acquire)) {
+                return; //another disk failed, no need to continue
+            }
+            const uint64_t numSegmentsThisChunk = std::min(RESTORE_READ_NUM_SEGMENTS_PER_CHUNK, numSegmentsOnDisk - localSegmentIndex);
+            const std::size_t bytesToRead = static_cast<std::size_t>(numSegmentsThisChunk * SEGMENT_SIZE);
+            const std::size_t bytesReadFromFread = fread(chunk.data(), 1, bytesToRead, fileHandle);
+            if (bytesReadFromFread != bytesToRead) {
+                LOG_ERROR(subprocess) << "Error reading at offset " << (localSegmentIndex * SEGMENT_SIZE) <<
+                    " for disk " << diskId << " bytesread " << bytesReadFromFread;
+                restoreErrorOccurred = true;
+                return;
+            }
+            for (uint64_t i = 0; i < numSegmentsThisChunk; ++i, ++localSegmentIndex) {
+                uint8_t * const segmentPtr = &chunk[i * SEGMENT_SIZE];
+                StorageSegmentHeaderUnion storageSegmentHeaderUnion;
+                StorageSegmentHeader& storageSegmentHeader = storageSegmentHeaderUnion.hdr;
+                //note: SEGMENT_RESERVED_SPACE is 4 bytes smaller than sizeof(StorageSegmentHeader) if segment_id_t is 32-bit
+                memcpy(storageSegmentHeaderUnion.rawBytes, segmentPtr, SEGMENT_RESERVED_SPACE);
+                storageSegmentHeader.ToNativeEndianInplace(); //should optimize out and do nothing
+                if (storageSegmentHeader.bundleSizeBytes == UINT64_MAX) {
+                    continue; //not a head segment (either a continuation segment or the head of a removed bundle)
+                }
 
-                uint8_t * bundleDataBegin = dataReadBuf + SEGMENT_RESERVED_SPACE;
-                
+                std::unique_ptr<RestoredBundle> restoredBundlePtr = boost::make_unique<RestoredBundle>();
+                uint8_t * const bundleDataBegin = segmentPtr + SEGMENT_RESERVED_SPACE;
                 const uint8_t firstByte = bundleDataBegin[0];
                 const bool isBpVersion6 = (firstByte == 6);
                 const bool isBpVersion7 = (firstByte == ((4U << 5) | 31U));  //CBOR major type 4, additional information 31 (Indefinite-Length Array)
                 if (isBpVersion6) {
                     if (!bv6.LoadBundle(bundleDataBegin, BUNDLE_STORAGE_PER_SEGMENT_SIZE, true)) { //load primary only
                         LOG_ERROR(subprocess) << "malformed bundle";
-                        return false;
+                        restoreErrorOccurred = true;
+                        return;
                     }
-                    Bpv6CbhePrimaryBlock & primary = bv6.m_primaryBlockView.header;
-                    primaryBasePtr = &primary;
+                    restoredBundlePtr->primaryPtr = boost::make_unique<Bpv6CbhePrimaryBlock>(bv6.m_primaryBlockView.header);
                 }
                 else if (isBpVersion7) {
                     if (!bv7.LoadBundle(bundleDataBegin, BUNDLE_STORAGE_PER_SEGMENT_SIZE, true, true)) { //load primary only
                         LOG_ERROR(subprocess) << "malformed bundle";
-                        return false;
+                        restoreErrorOccurred = true;
+                        return;
                     }
-                    Bpv7CbhePrimaryBlock & primary = bv7.m_primaryBlockView.header;
-                    primaryBasePtr = &primary;
+                    restoredBundlePtr->primaryPtr = boost::make_unique<Bpv7CbhePrimaryBlock>(bv7.m_primaryBlockView.header);
                 }
                 else {
                     LOG_ERROR(subprocess) << "error in BundleStorageManagerBase::RestoreFromDisk: unknown bundle version detected";
-                    return false;
+                    restoreErrorOccurred = true;
+                    return;
                 }
                 const uint64_t totalSegmentsRequired = (storageSegmentHeader.bundleSizeBytes / BUNDLE_STORAGE_PER_SEGMENT_SIZE) + ((storageSegmentHeader.bundleSizeBytes % BUNDLE_STORAGE_PER_SEGMENT_SIZE) == 0 ? 0 : 1);
+                restoredBundlePtr->custodyId = storageSegmentHeader.custodyId;
+                restoredBundlePtr->nextSegmentId = storageSegmentHeader.nextSegmentId;
+                restoredBundlePtr->catalogEntry.Init(*restoredBundlePtr->primaryPtr, storageSegmentHeader.bundleSizeBytes, storageSegmentHeader.payloadSizeBytes, totalSegmentsRequired, NULL); //NULL replaced later at CatalogIncomingBundleForStore
+                if (restoredBundlePtr->catalogEntry.segmentIdChainVec.empty()) {
+                    LOG_ERROR(subprocess) << "error: head segment has a bundle size of zero";
+                    restoreErrorOccurred = true;
+                    return;
+                }
+                restoredBundlePtr->catalogEntry.segmentIdChainVec[0] = static_cast<segment_id_t>((localSegmentIndex * M_NUM_STORAGE_DISKS) + diskId);
+                restoredBundlesVec.push_back(std::move(restoredBundlePtr));
+            }
+            progress.bytesScanned.store(localSegmentIndex * SEGMENT_SIZE, std::memory_order_relaxed);
+        }
+    }
 
-                *totalBytesRestored += storageSegmentHeader.bundleSizeBytes;
-                *totalSegmentsRestored += totalSegmentsRequired;
-                catalogEntry.Init(*primaryBasePtr, storageSegmentHeader.bundleSizeBytes, storageSegmentHeader.payloadSizeBytes, totalSegmentsRequired, NULL); //NULL replaced later at CatalogIncomingBundleForStore
+    //second pass: follow the chain of every bundle whose head segment is on this disk (reading only the segment headers)
+    for (std::size_t bundleIndex = 0; bundleIndex < restoredBundlesVec.size(); ++bundleIndex) {
+        if (restoreErrorOccurred.load(std::memory_order_acquire)) {
+            return;
+        }
+        RestoredBundle& restoredBundle = *restoredBundlesVec[bundleIndex];
+        segment_id_chain_vec_t & segmentIdChainVec = restoredBundle.catalogEntry.segmentIdChainVec;
+        segment_id_t segmentId = restoredBundle.nextSegmentId;
+        for (std::size_t logicalSegment = 1; logicalSegment < segmentIdChainVec.size(); ++logicalSegment) {
+            if (segmentId == SEGMENT_ID_LAST) {
+                LOG_ERROR(subprocess) << "error: there are more logical segments but nextSegmentId == SEGMENT_ID_LAST";
+                restoreErrorOccurred = true;
+                return;
+            }
+            const unsigned int diskIndex = segmentId % M_NUM_STORAGE_DISKS;
+            const uint64_t offsetBytes = static_cast<uint64_t>(segmentId / M_NUM_STORAGE_DISKS) * SEGMENT_SIZE;
+            FILE * const fileHandle = fileHandlesVec[diskIndex].get();
+            StorageSegmentHeaderUnion storageSegmentHeaderUnion;
+            StorageSegmentHeader& storageSegmentHeader = storageSegmentHeaderUnion.hdr;
+            if ((!SeekStorageFile(fileHandle, offsetBytes)) || (fread(storageSegmentHeaderUnion.rawBytes, 1, SEGMENT_RESERVED_SPACE, fileHandle) != SEGMENT_RESERVED_SPACE)) {
+                LOG_ERROR(subprocess) << "Error reading segment header at offset " << offsetBytes <<
+                    " for disk " << diskIndex << " logical segment " << logicalSegment;
+                restoreErrorOccurred = true;
+                return;
             }
-            if (!headSegmentFound) break;
-            if (custodyIdHeadSegment != storageSegmentHeader.custodyId) { //shall be the same across all segments
+            storageSegmentHeader.ToNativeEndianInplace(); //should optimize out and do nothing
+            if (storageSegmentHeader.custodyId != restoredBundle.custodyId) { //shall be the same across all segments
                 LOG_ERROR(subprocess) << "error: custodyIdHeadSegment != custodyId";
-                return false;
+                restoreErrorOccurred = true;
+                return;
             }
-            if ((session.nextLogicalSegment) >= segmentIdChainVec.size()) {
-                LOG_ERROR(subprocess) << "error: logical segment exceeds total segments required";
-                return false;
+            segmentIdChainVec[logicalSegment] = segmentId;
+            segmentId = storageSegmentHeader.nextSegmentId;
+        }
+        if (segmentId != SEGMENT_ID_LAST) {
+            LOG_ERROR(subprocess) << "error: at the last logical segment but nextSegmentId != SEGMENT_ID_LAST";
+            restoreErrorOccurred = true;
+            return;
+        }
+        progress.bundlesRestored.fetch_add(1, std::memory_order_relaxed);
+        progress.bundleBytesRestored.fetch_add(restoredBundle.catalogEntry.bundleSizeBytes, std::memory_order_relaxed);
+        progress.segmentsRestored.fetch_add(segmentIdChainVec.size(), std::memory_order_relaxed);
+    }
+}
+
+bool BundleStorageManagerBase::RestoreFromDisk(uint64_t * totalBundlesRestored, uint64_t * totalBytesRestored, uint64_t * totalSegmentsRestored) {
+    *totalBundlesRestored = 0; *totalBytesRestored = 0; *totalSegmentsRestored = 0;
+    for (unsigned int diskId = 0; diskId < M_NUM_STORAGE_DISKS; ++diskId) {
+        DiskRestoreProgress& progress = m_diskRestoreProgressArray[diskId];
+        progress.bytesScanned = 0;
+        progress.bundlesRestored = 0;
+        progress.bundleBytesRestored = 0;
+        progress.segmentsRestored = 0;
+        progress.restoreCompleted = false;
+        progress.restoreAttempted = true;
+        const char * const filePath = m_storageConfigPtr->m_storageDiskConfigVector[diskId].storeFilePath.c_str();
+        const boost::filesystem::path p(filePath);
+        if (boost::filesystem::exists(p)) {
+            progress.totalBytesToScan = boost::filesystem::file_size(p);
+            LOG_DEBUG(subprocess) << "diskId " << diskId
+                << " has file size of " << progress.totalBytesToScan.load();
+        }
+        else {
+            LOG_ERROR(subprocess) << "Error: " << filePath << " does not exist";
+            return false;
+        }
+    }
+
+    //each disk is scanned by its own thread so that restore time scales with the number of disks rather than the total capacity
+    std::vector<std::vector<std::unique_ptr<RestoredBundle> > > restoredBundlesPerDiskVec(M_NUM_STORAGE_DISKS);
+    std::atomic<bool> restoreErrorOccurred(false);
+    std::vector<std::unique_ptr<boost::thread> > threadPtrsVec(M_NUM_STORAGE_DISKS);
+    for (unsigned int diskId = 0; diskId < M_NUM_STORAGE_DISKS; ++diskId) {
+        threadPtrsVec[diskId] = boost::make_unique<boost::thread>(
+            boost::bind(&BundleStorageManagerBase::RestoreDiskThreadFunc, this, diskId,
+                boost::ref(restoredBundlesPerDiskVec[diskId]), boost::ref(restoreErrorOccurred)));
+    }
+    for (unsigned int diskId = 0; diskId < M_NUM_STORAGE_DISKS; ++diskId) {
+        while (!threadPtrsVec[diskId]->try_join_for(boost::chrono::seconds(5))) {
+            uint64_t bytesScanned = 0, totalBytesToScan = 0;
+            for (unsigned int i = 0; i < M_NUM_STORAGE_DISKS; ++i) {
+                bytesScanned += m_diskRestoreProgressArray[i].bytesScanned.load(std::memory_order_relaxed);
+                totalBytesToScan += m_diskRestoreProgressArray[i].totalBytesToScan.load(std::memory_order_relaxed);
             }
-            if (!m_memoryManager.IsSegmentFree(segmentId)) { //todo this is redundant per function below
-                LOG_ERROR(subprocess) << "error: segmentId is already allocated";
+            LOG_INFO(subprocess) << "restore in progress: scanned " << bytesScanned << " of " << totalBytesToScan << " bytes";
+        }
+    }
+    if (restoreErrorOccurred) {
+        return false;
+    }
+
+    //catalog in head segment id order (the order in which the bundles were found by the original single threaded restore)
+    std::vector<RestoredBundle*> restoredBundlesSortedVec;
+    for (unsigned int diskId = 0; diskId < M_NUM_STORAGE_DISKS; ++diskId) {
+        for (std::size_t i = 0; i < restoredBundlesPerDiskVec[diskId].size(); ++i) {
+            restoredBundlesSortedVec.push_back(restoredBundlesPerDiskVec[diskId][i].get());
+        }
+    }
+    std::sort(restoredBundlesSortedVec.begin(), restoredBundlesSortedVec.end(), [](const RestoredBundle* a, const RestoredBundle* b) {
+        return a->catalogEntry.segmentIdChainVec[0] < b->catalogEntry.segmentIdChainVec[0];
+    });
+    for (std::size_t i = 0; i < restoredBundlesSortedVec.size(); ++i) {
+        RestoredBundle& restoredBundle = *restoredBundlesSortedVec[i];
+        const segment_id_chain_vec_t & segmentIdChainVec = restoredBundle.catalogEntry.segmentIdChainVec;
+        for (std::size_t j = 0; j < segmentIdChainVec.size(); ++j) {
+            if (segmentIdChainVec[j] >= M_MAX_SEGMENTS) {
+                LOG_ERROR(subprocess) << "error: segmentId " << segmentIdChainVec[j] << " exceeds the storage capacity";
                 return false;
             }
-            if (!m_memoryManager.AllocateSegmentId_NotThreadSafe(segmentId)) {
+            if (!m_memoryManager.AllocateSegmentId_NotThreadSafe(segmentIdChainVec[j])) {
                 LOG_ERROR(subprocess) << "error: AllocateSegmentId_NotThreadSafe: segmentId is already allocated";
                 return false;
             }
-            segmentIdChainVec[session.nextLogicalSegment] = segmentId;
-
-
+        }
+        *totalBytesRestored += restoredBundle.catalogEntry.bundleSizeBytes;
+        *totalSegmentsRestored += segmentIdChainVec.size();
+        m_bundleStorageCatalog.CatalogIncomingBundleForStore(restoredBundle.catalogEntry, *restoredBundle.primaryPtr, restoredBundle.custodyId, BundleStorageCatalog::DUPLICATE_EXPIRY_ORDER::FIFO);
+        *totalBundlesRestored += 1;
+    }
 
-            if ((session.nextLogicalSegment + 1) >= segmentIdChainVec.size()) { //==
-                if (storageSegmentHeader.nextSegmentId != SEGMENT_ID_LAST) { //there are more segments
-                    LOG_ERROR(subprocess) << "error: at the last logical segment but nextSegmentId != SEGMENT_ID_LAST";
-                    return false;
-                }
-                m_bundleStorageCatalog.CatalogIncomingBundleForStore(catalogEntry, *primaryBasePtr, storageSegmentHeader.custodyId, BundleStorageCatalog::DUPLICATE_EXPIRY_ORDER::FIFO);
-                *totalBundlesRestored += 1;
-                break;
-            }
+    for (unsigned int diskId = 0; diskId < M_NUM_STORAGE_DISKS; ++diskId) {
+        m_diskRestoreProgressArray[diskId].restoreCompleted = true;
+    }
+    LOG_INFO(subprocess) << "end of restore: restored " << *totalBundlesRestored << " bundles (" << *totalBytesRestored
+        << " bytes, " << *totalSegmentsRestored << " segments)";
+    m_successfullyRestoredFromDisk = true;
+    return true;
+}
 
-            if (storageSegmentHeader.nextSegmentId == SEGMENT_ID_LAST) { //there are more segments
-                LOG_ERROR(subprocess) << "error: there are more logical segments but nextSegmentId == SEGMENT_ID_LAST";
-                return false;
-            }
-            segmentId = storageSegmentHeader.nextSegmentId;
+bool BundleStorageManagerBase::RestoreFromCatalogJournal(uint64_t * totalBundlesRestored, uint64_t * totalBytesRestored, uint64_t * totalSegmentsRestored) {
+    *totalBundlesRestored = 0; *totalBytesRestored = 0; *totalSegmentsRestored = 0;
+    if (!m_catalogJournalPtr) {
+        return false;
+    }
+    for (unsigned int diskId = 0; diskId < M_NUM_STORAGE_DISKS; ++diskId) {
+        const boost::filesystem::path p(m_storageConfigPtr->m_storageDiskConfigVector[diskId].storeFilePath);
+        if (!boost::filesystem::exists(p)) {
+            LOG_ERROR(subprocess) << "Error: " << p << " does not exist";
+            return false;
+        }
+    }
+    const boost::posix_time::ptime startTime = boost::posix_time::microsec_clock::universal_time();
 
+    //load into a separate memory manager so that nothing is modified if the snapshot or journal is inconsistent
+    std::vector<catalog_journal_restored_bundle_t> restoredBundlesVec;
+    memmanager_t memoryManagerBackup;
+    {
+        MemoryManagerTreeArray restoredMemoryManager(M_MAX_SEGMENTS);
+        if (!m_catalogJournalPtr->Load(restoredMemoryManager, restoredBundlesVec)) {
+            return false;
         }
+        restoredMemoryManager.BackupDataToVector(memoryManagerBackup);
     }
+    if (!m_memoryManager.RestoreDataFromVector(memoryManagerBackup)) {
+        LOG_ERROR(subprocess) << "error: the catalog snapshot segment bitmap does not match the memory manager";
+        return false;
+    }
+    for (std::size_t i = 0; i < restoredBundlesVec.size(); ++i) {
+        catalog_journal_restored_bundle_t & restoredBundle = restoredBundlesVec[i];
+        const uint64_t bundleSizeBytes = restoredBundle.catalogEntry.bundleSizeBytes;
+        const uint64_t numSegments = restoredBundle.catalogEntry.segmentIdChainVec.size();
+        if (!m_bundleStorageCatalog.CatalogIncomingBundleForStore(restoredBundle.catalogEntry, restoredBundle.bundleUuid, restoredBundle.custodyId, BundleStorageCatalog::DUPLICATE_EXPIRY_ORDER::FIFO)) {
+            //Load already rejected duplicate custody ids, so this is a duplicate bundle uuid
+            LOG_ERROR(subprocess) << "error: unable to catalog restored bundle with custody id " << restoredBundle.custodyId;
+            continue;
+        }
+        *totalBytesRestored += bundleSizeBytes;
+        *totalSegmentsRestored += numSegments;
+        *totalBundlesRestored += 1;
+    }
+    LOG_INFO(subprocess) << "end of restore from catalog journal: restored " << *totalBundlesRestored << " bundles (" << *totalBytesRestored
+        << " bytes, " << *totalSegmentsRestored << " segments) in " << (boost::posix_time::microsec_clock::universal_time() - startTime);
+    return true;
+}
 
+bool BundleStorageManagerBase::WriteCatalogSnapshot() {
+    if (!m_catalogJournalPtr) {
+        return false;
+    }
+    std::vector<uint64_t> custodyIds;
+    m_bundleStorageCatalog.GetCustodyIdsInSendOrder(custodyIds);
+    std::vector<std::pair<uint64_t, const catalog_entry_t*> > custodyIdsPlusEntries;
+    custodyIdsPlusEntries.reserve(custodyIds.size());
+    //the bitmap is built from the catalog rather than copied from m_memoryManager, which also has
+    //the segments of bundles still being written (those are journaled once cataloged)
+    MemoryManagerTreeArray snapshotMemoryManager(M_MAX_SEGMENTS);
+    for (std::size_t i = 0; i < custodyIds.size(); ++i) {
+        const catalog_entry_t * const catalogEntryPtr = m_bundleStorageCatalog.GetEntryFromCustodyId(custodyIds[i]);
+        const segment_id_chain_vec_t & segmentIdChainVec = catalogEntryPtr->segmentIdChainVec;
+        if (m_ramCache.Contains(segmentIdChainVec[0])) {
+            continue; //not on disk yet (journaled once flushed)
+        }
+        for (std::size_t j = 0; j < segmentIdChainVec.size(); ++j) {
+            snapshotMemoryManager.AllocateSegmentId_NotThreadSafe(segmentIdChainVec[j]);
+        }
+        custodyIdsPlusEntries.emplace_back(custodyIds[i], catalogEntryPtr);
+    }
+    memmanager_t memoryManagerBackup;
+    snapshotMemoryManager.BackupDataToVector(memoryManagerBackup);
+    return m_catalogJournalPtr->WriteSnapshot(memoryManagerBackup, custodyIdsPlusEntries);
+}
 
-    for (unsigned int tId = 0; tId < M_NUM_STORAGE_DISKS; ++tId) {
-        fclose(fileHandlesVec[tId]);
+void BundleStorageManagerBase::OnCatalogJournalRecordWritten(const bool success) {
+    if (!success) {
+        m_catalogJournalPtr.reset(); //the journal deleted its snapshot so the next restore will scan the disks
+    }
+    else if (m_catalogJournalPtr->GetNumRecordsSinceSnapshot() >= m_storageConfigPtr->m_catalogSnapshotIntervalRecords) {
+        if (!WriteCatalogSnapshot()) {
+            m_catalogJournalPtr.reset();
+        }
     }
+}
 
-    m_successfullyRestoredFromDisk = true;
-    return true;
+void BundleStorageManagerBase::GetDiskRestoreTelemetry(std::vector<StorageDiskRestoreTelemetry_t>& diskRestoreTelemetryVec) const {
+    diskRestoreTelemetryVec.clear();
+    for (unsigned int diskId = 0; diskId < M_NUM_STORAGE_DISKS; ++diskId) {
+        const DiskRestoreProgress& progress = m_diskRestoreProgressArray[diskId];
+        if (!progress.restoreAttempted.load(std::memory_order_acquire)) {
+            continue;
+        }
+        diskRestoreTelemetryVec.emplace_back();
+        StorageDiskRestoreTelemetry_t& telem = diskRestoreTelemetryVec.back();
+        telem.m_diskIndex = diskId;
+        telem.m_bytesScanned = progress.bytesScanned.load(std::memory_order_relaxed);
+        telem.m_totalBytesToScan = progress.totalBytesToScan.load(std::memory_order_relaxed);
+        telem.m_bundlesRestored = progress.bundlesRestored.load(std::memory_order_relaxed);
+        telem.m_bundleBytesRestored = progress.bundleBytesRestored.load(std::memory_order_relaxed);
+        telem.m_segmentsRestored = progress.segmentsRestored.load(std::memory_order_relaxed);
+        telem.m_restoreCompleted = progress.restoreCompleted.load(std::memory_order_acquire);
+    }
 }
 
 
@@ -0,0 +1,485 @@
+/**
+ * @file BundleStorageManagerIoUring.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#define _LARGEFILE64_SOURCE
+#define _FILE_OFFSET_BITS 64
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+#include "BundleStorageManagerIoUring.h"
+#include <string>
+#include <boost/filesystem/path.hpp>
+#include <memory>
+#include <boost/make_unique.hpp>
+#include "ThreadNamer.h"
+
+static constexpr hdtn::Logger::SubProcess subprocess = hdtn::Logger::SubProcess::storage;
+
+//Minimal io_uring instance (no liburing dependency) owned by a single disk thread.
+//Only one thread ever touches a given instance, so the only required memory ordering
+//is between this thread and the kernel (acquire on kernel-owned indices, release on user-owned indices).
+class IoUringInstance {
+public:
+    IoUringInstance();
+    ~IoUringInstance();
+    bool Init(const unsigned int entries);
+    bool RegisterBuffer(void* base, const std::size_t length);
+    struct io_uring_sqe* GetSqe();
+    bool SubmitAndWait(const unsigned int numToSubmit, const unsigned int minComplete);
+    bool PopCqe(uint64_t& userData, int32_t& result);
+private:
+    int m_ringFd;
+    void* m_sqRingPtr;
+    std::size_t m_sqRingSize;
+    void* m_cqRingPtr;
+    std::size_t m_cqRingSize;
+    struct io_uring_sqe* m_sqesPtr;
+    std::size_t m_sqesSize;
+
+    unsigned int* m_sqHeadPtr;
+    unsigned int* m_sqTailPtr;
+    unsigned int m_sqTailPending;
+    unsigned int m_sqRingMask;
+    unsigned int m_sqRingEntries;
+    unsigned int* m_sqArrayPtr;
+    unsigned int* m_cqHeadPtr;
+    unsigned int* m_cqTailPtr;
+    unsigned int m_cqRingMask;
+    struct io_uring_cqe* m_cqesPtr;
+};
+
+IoUringInstance::IoUringInstance() :
+    m_ringFd(-1),
+    m_sqRingPtr(MAP_FAILED),
+    m_sqRingSize(0),
+    m_cqRingPtr(MAP_FAILED),
+    m_cqRingSize(0),
+    m_sqesPtr(static_cast<struct io_uring_sqe*>(MAP_FAILED)),
+    m_sqesSize(0),
+    m_sqHeadPtr(NULL),
+    m_sqTailPtr(NULL),
+    m_sqTailPending(0),
+    m_sqRingMask(0),
+    m_sqRingEntries(0),
+    m_sqArrayPtr(NULL),
+    m_cqHeadPtr(NULL),
+    m_cqTailPtr(NULL),
+    m_cqRingMask(0),
+    m_cqesPtr(NULL) {}
+
+IoUringInstance::~IoUringInstance() {
+    if (m_sqesPtr != MAP_FAILED) {
+        munmap(m_sqesPtr, m_sqesSize);
+    }
+    if ((m_cqRingPtr != MAP_FAILED) && (m_cqRingPtr != m_sqRingPtr)) {
+        munmap(m_cqRingPtr, m_cqRingSize);
+    }
+    if (m_sqRingPtr != MAP_FAILED) {
+        munmap(m_sqRingPtr, m_sqRingSize);
+    }
+    if (m_ringFd >= 0) {
+        close(m_ringFd);
+    }
+}
+
+bool IoUringInstance::Init(const unsigned int entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    m_ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (m_ringFd < 0) {
+        LOG_ERROR(subprocess) << "io_uring_setup failed: " << strerror(errno);
+        return false;
+    }
+    m_sqRingSize = params.sq_off.array + (params.sq_entries * sizeof(unsigned int));
+    m_cqRingSize = params.cq_off.cqes + (params.cq_entries * sizeof(struct io_uring_cqe));
+    const bool singleMmap = ((params.features & IORING_FEAT_SINGLE_MMAP) != 0);
+    if (singleMmap) {
+        m_sqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+        m_cqRingSize = m_sqRingSize;
+    }
+    m_sqRingPtr = mmap(NULL, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+    if (m_sqRingPtr == MAP_FAILED) {
+        LOG_ERROR(subprocess) << "io_uring mmap of submission queue ring failed: " << strerror(errno);
+        return false;
+    }
+    if (singleMmap) {
+        m_cqRingPtr = m_sqRingPtr;
+    }
+    else {
+        m_cqRingPtr = mmap(NULL, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_CQ_RING);
+        if (m_cqRingPtr == MAP_FAILED) {
+            LOG_ERROR(subprocess) << "io_uring mmap of completion queue ring failed: " << strerror(errno);
+            return false;
+        }
+    }
+    m_sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    m_sqesPtr = static_cast<struct io_uring_sqe*>(mmap(NULL, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES));
+    if (m_sqesPtr == MAP_FAILED) {
+        LOG_ERROR(subprocess) << "io_uring mmap of submission queue entries failed: " << strerror(errno);
+        return false;
+    }
+    uint8_t* const sqBase = static_cast<uint8_t*>(m_sqRingPtr);
+    m_sqHeadPtr = reinterpret_cast<unsigned int*>(sqBase + params.sq_off.head);
+    m_sqTailPtr = reinterpret_cast<unsigned int*>(sqBase + params.sq_off.tail);
+    m_sqTailPending = *m_sqTailPtr;
+    m_sqRingMask = *reinterpret_cast<unsigned int*>(sqBase + params.sq_off.ring_mask);
+    m_sqRingEntries = *reinterpret_cast<unsigned int*>(sqBase + params.sq_off.ring_entries);
+    m_sqArrayPtr = reinterpret_cast<unsigned int*>(sqBase + params.sq_off.array);
+    uint8_t* const cqBase = static_cast<uint8_t*>(m_cqRingPtr);
+    m_cqHeadPtr = reinterpret_cast<unsigned int*>(cqBase + params.cq_off.head);
+    m_cqTailPtr = reinterpret_cast<unsigned int*>(cqBase + params.cq_off.tail);
+    m_cqRingMask = *reinterpret_cast<unsigned int*>(cqBase + params.cq_off.ring_mask);
+    m_cqesPtr = reinterpret_cast<struct io_uring_cqe*>(cqBase + params.cq_off.cqes);
+    return true;
+}
+
+bool IoUringInstance::RegisterBuffer(void* base, const std::size_t length) {
+    struct iovec iov;
+    iov.iov_base = base;
+    iov.iov_len = length;
+    return (syscall(__NR_io_uring_register, m_ringFd, IORING_REGISTER_BUFFERS, &iov, 1) == 0);
+}
+
+struct io_uring_sqe* IoUringInstance::GetSqe() {
+    const unsigned int head = __atomic_load_n(m_sqHeadPtr, __ATOMIC_ACQUIRE); //kernel owns head
+    if ((m_sqTailPending - head) >= m_sqRingEntries) {
+        return NULL; //full
+    }
+    const unsigned int index = m_sqTailPending & m_sqRingMask;
+    ++m_sqTailPending;
+    struct io_uring_sqe* sqe = &m_sqesPtr[index];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    m_sqArrayPtr[index] = index;
+    return sqe;
+}
+
+bool IoUringInstance::SubmitAndWait(const unsigned int numToSubmit, const unsigned int minComplete) {
+    __atomic_store_n(m_sqTailPtr, m_sqTailPending, __ATOMIC_RELEASE); //make the filled sqes visible to the kernel
+    while (true) {
+        const long ret = syscall(__NR_io_uring_enter, m_ringFd, numToSubmit, minComplete,
+            (minComplete) ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (ret >= 0) {
+            return true;
+        }
+        if (errno != EINTR) {
+            LOG_ERROR(subprocess) << "io_uring_enter failed: " << strerror(errno);
+            return false;
+        }
+    }
+}
+
+bool IoUringInstance::PopCqe(uint64_t& userData, int32_t& result) {
+    const unsigned int head = *m_cqHeadPtr; //this thread owns head
+    const unsigned int tail = __atomic_load_n(m_cqTailPtr, __ATOMIC_ACQUIRE); //kernel owns tail
+    if (head == tail) {
+        return false; //empty
+    }
+    const struct io_uring_cqe& cqe = m_cqesPtr[head & m_cqRingMask];
+    userData = cqe.user_data;
+    result = cqe.res;
+    __atomic_store_n(m_cqHeadPtr, head + 1, __ATOMIC_RELEASE); //give the cqe back to the kernel
+    return true;
+}
+
+
+
+BundleStorageManagerIoUring::BundleStorageManagerIoUring() : BundleStorageManagerIoUring("storageConfig.json") {}
+
+BundleStorageManagerIoUring::BundleStorageManagerIoUring(const boost::filesystem::path& jsonConfigFilePath) :
+    BundleStorageManagerIoUring(StorageConfig::CreateFromJsonFilePath(jsonConfigFilePath)) {
+    if (!m_storageConfigPtr) {
+        LOG_ERROR(subprocess) << "cannot open storage json config file: " << jsonConfigFilePath;
+        return;
+    }
+}
+
+BundleStorageManagerIoUring::BundleStorageManagerIoUring(const StorageConfig_ptr & storageConfigPtr) :
+    BundleStorageManagerBase(storageConfigPtr),
+
+    m_conditionVariablesPlusMutexesVec(M_NUM_STORAGE_DISKS),
+    m_threadPtrsVec(M_NUM_STORAGE_DISKS),
+    m_running(false),
+    m_noFatalErrorsOccurred(true)
+{
+
+}
+
+void BundleStorageManagerIoUring::StopAllDiskThreads() {
+    m_running = false; //thread stopping criteria
+    for (unsigned int diskId = 0; diskId < M_NUM_STORAGE_DISKS; ++diskId) { //only lock one mutex at a time to prevent deadlock (a worker may call this function on an error condition)
+        //lock then unlock each thread's mutex to prevent a missed notify after setting thread stopping criteria above
+        m_conditionVariablesPlusMutexesVec[diskId].second.lock();
+        m_conditionVariablesPlusMutexesVec[diskId].second.unlock();
+        m_conditionVariablesPlusMutexesVec[diskId].first.notify_one();
+    }
+}
+
+BundleStorageManagerIoUring::~BundleStorageManagerIoUring() {
+    if (m_running && (!m_autoDeleteFilesOnExit)) {
+        FlushRamCache(); //bundles held only in RAM must be on disk for the next restore
+    }
+    StopAllDiskThreads();
+    for (unsigned int diskId = 0; diskId < M_NUM_STORAGE_DISKS; ++diskId) {
+        if (m_threadPtrsVec[diskId]) {
+            try {
+                m_threadPtrsVec[diskId]->join();
+                m_threadPtrsVec[diskId].reset(); //delete it
+            }
+            catch (const boost::thread_resource_error&) {
+                LOG_ERROR(subprocess) << "error stopping BundleStorageManagerIoUring disk thread ID " << diskId;
+            }
+        }
+    }
+}
+
+void BundleStorageManagerIoUring::Start() {
+    if ((!m_running) && (m_storageConfigPtr)) {
+        m_running = true;
+        m_noFatalErrorsOccurred = true;
+        for (unsigned int diskId = 0; diskId < M_NUM_STORAGE_DISKS; ++diskId) {
+            m_threadPtrsVec[diskId] = boost::make_unique<boost::thread>(
+                boost::bind(&BundleStorageManagerIoUring::ThreadFunc, this, diskId)); //create and start the worker thread
+        }
+    }
+}
+
+void BundleStorageManagerIoUring::ThreadFunc(const unsigned int threadIndex) {
+    const std::string threadName = "StorageIoUringDisk" + boost::lexical_cast<std::string>(threadIndex);
+    ThreadNamer::SetThisThreadName(threadName);
+
+    std::pair<boost::condition_variable, boost::mutex>& cvMutexPairRef = m_conditionVariablesPlusMutexesVec[threadIndex];
+    boost::condition_variable & cv = cvMutexPairRef.first;
+    boost::mutex & localMutex = cvMutexPairRef.second;
+    CircularIndexBufferSingleProducerSingleConsumerConfigurable & cb = m_circularIndexBuffersVec[threadIndex];
+    const boost::filesystem::path& filePath = m_filePathsVec[threadIndex];
+    LOG_INFO(subprocess) << ((m_successfullyRestoredFromDisk) ? "reopening " : "creating ") << filePath;
+    bool usingDirectIo;
+    const int fileDescriptor = OpenDiskFileDescriptor(threadIndex, usingDirectIo);
+    if (fileDescriptor < 0) {
+        LOG_ERROR(subprocess) << "error opening " << filePath;
+        m_noFatalErrorsOccurred = false;
+        StopAllDiskThreads();
+        return;
+    }
+
+    boost::uint8_t * const circularBufferBlockDataPtr = &m_circularBufferBlockDataPtr[threadIndex * CIRCULAR_INDEX_BUFFER_SIZE * SEGMENT_SIZE];
+    segment_id_t * const circularBufferSegmentIdsPtr = &m_circularBufferSegmentIdsPtr[threadIndex * CIRCULAR_INDEX_BUFFER_SIZE];
+
+    IoUringInstance ring;
+    if (!ring.Init(CIRCULAR_INDEX_BUFFER_SIZE)) {
+        LOG_ERROR(subprocess) << "unable to create io_uring for disk " << threadIndex;
+        close(fileDescriptor);
+        m_noFatalErrorsOccurred = false;
+        StopAllDiskThreads();
+        return;
+    }
+    //writes always come from this disk's slots of m_circularBufferBlockDataPtr, so register that region as fixed buffer index 0
+    const bool useFixedBuffers = ring.RegisterBuffer(circularBufferBlockDataPtr, CIRCULAR_INDEX_BUFFER_SIZE * SEGMENT_SIZE);
+    if (!useFixedBuffers) {
+        LOG_WARNING(subprocess) << "unable to register io_uring fixed buffers for disk " << threadIndex
+            << " (check RLIMIT_MEMLOCK), falling back to unregistered buffers";
+    }
+
+    //slots are consumed from the circular buffer in order, but io_uring may complete them out of order,
+    //so a slot is only committed back to the producer once it and every slot before it has completed
+    std::vector<uint8_t> slotInFlightVec(CIRCULAR_INDEX_BUFFER_SIZE, 0);
+    //scatter reads (header to the read cache, payload directly to the bundle) need their iovecs to live until completion
+    std::vector<struct iovec> slotReadIovecsVec(CIRCULAR_INDEX_BUFFER_SIZE * 2);
+    std::vector<uint8_t> slotCompletedVec(CIRCULAR_INDEX_BUFFER_SIZE, 0);
+    //writes of segments adjacent on this disk (e.g. a multi-segment bundle) are coalesced into one operation
+    //whose user_data is its first slot, so remember how many slots that operation covers
+    std::vector<unsigned int> slotRunLengthVec(CIRCULAR_INDEX_BUFFER_SIZE, 1);
+    unsigned int numSlotsSubmittedNotCommitted = 0; //counted from the circular buffer read index
+    unsigned int numSlotsInFlight = 0;
+
+    while (m_noFatalErrorsOccurred.load(std::memory_order_acquire)) {
+        const unsigned int readIndex = cb.GetIndexForRead(); //store the volatile
+        unsigned int numSubmittedThisBatch = 0;
+        if (readIndex != CIRCULAR_INDEX_BUFFER_EMPTY) {
+            const unsigned int numInBuffer = cb.NumInBuffer();
+            while (numSlotsSubmittedNotCommitted < numInBuffer) {
+                unsigned int consumeIndex = readIndex + numSlotsSubmittedNotCommitted;
+                if (consumeIndex >= CIRCULAR_INDEX_BUFFER_SIZE) {
+                    consumeIndex -= CIRCULAR_INDEX_BUFFER_SIZE;
+                }
+                const segment_id_t segmentId = circularBufferSegmentIdsPtr[consumeIndex];
+                if (segmentId == SEGMENT_ID_LAST) {
+                    LOG_ERROR(subprocess) << "error segmentId is last";
+                    m_noFatalErrorsOccurred = false; //a fatal error occurred
+                    break;
+                }
+
+                const unsigned int cbPtrIndex = threadIndex * CIRCULAR_INDEX_BUFFER_SIZE + consumeIndex;
+                uint8_t * const readFromStorageDestPointer = m_circularBufferReadFromStoragePointers[cbPtrIndex].load(std::memory_order_acquire);
+                const bool isWriteToDisk = (readFromStorageDestPointer == NULL);
+                const unsigned int runLength = (isWriteToDisk) ? GetNumCoalescableWrites(threadIndex, consumeIndex, numInBuffer - numSlotsSubmittedNotCommitted) : 1;
+
+                //a later operation on the same segment (e.g. a read after a write, or the head invalidation after a write)
+                //must not be reordered with an earlier one, so hold the rest of the batch until the earlier one completes
+                bool conflictsWithInFlight = false;
+                for (unsigned int i = 0; (i < numSlotsSubmittedNotCommitted) && (!conflictsWithInFlight); ++i) {
+                    unsigned int inFlightIndex = readIndex + i;
+                    if (inFlightIndex >= CIRCULAR_INDEX_BUFFER_SIZE) {
+                        inFlightIndex -= CIRCULAR_INDEX_BUFFER_SIZE;
+                    }
+                    if (slotInFlightVec[inFlightIndex]) {
+                        for (unsigned int j = 0; j < runLength; ++j) {
+                            if (circularBufferSegmentIdsPtr[inFlightIndex] == circularBufferSegmentIdsPtr[consumeIndex + j]) {
+                                conflictsWithInFlight = true;
+                                break;
+                            }
+                        }
+                    }
+                }
+                if (conflictsWithInFlight) {
+                    break;
+                }
+
+                struct io_uring_sqe* sqe = ring.GetSqe();
+                if (sqe == NULL) {
+                    break; //submission queue full, wait for completions
+                }
+                sqe->fd = fileDescriptor;
+                sqe->off = static_cast<boost::uint64_t>(segmentId / M_NUM_STORAGE_DISKS) * SEGMENT_SIZE;
+                sqe->len = runLength * SEGMENT_SIZE;
+                sqe->user_data = consumeIndex;
+                if (isWriteToDisk) {
+                    sqe->opcode = (useFixedBuffers) ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+                    sqe->addr = reinterpret_cast<uint64_t>(&circularBufferBlockDataPtr[consumeIndex * SEGMENT_SIZE]);
+                    sqe->buf_index = 0;
+                }
+                else if ((!usingDirectIo) && m_circularBufferReadPayloadDestPointers[cbPtrIndex]) { //header to the read cache, payload to the bundle
+                    struct iovec * const iov = &slotReadIovecsVec[consumeIndex * 2];
+                    iov[0].iov_base = readFromStorageDestPointer;
+                    iov[0].iov_len = SEGMENT_RESERVED_SPACE;
+                    iov[1].iov_base = m_circularBufferReadPayloadDestPointers[cbPtrIndex];
+                    iov[1].iov_len = m_circularBufferReadPayloadSizes[cbPtrIndex];
+                    sqe->opcode = IORING_OP_READV;
+                    sqe->addr = reinterpret_cast<uint64_t>(iov);
+                    sqe->len = 2;
+                }
+                else { //read from disk into the session's read cache (not a registered buffer)
+                    sqe->opcode = IORING_OP_READ;
+                    sqe->addr = reinterpret_cast<uint64_t>(readFromStorageDestPointer);
+                }
+                slotRunLengthVec[consumeIndex] = runLength;
+                for (unsigned int j = 0; j < runLength; ++j) {
+                    slotInFlightVec[consumeIndex + j] = 1;
+                }
+                numSlotsSubmittedNotCommitted += runLength;
+                numSlotsInFlight += runLength;
+                ++numSubmittedThisBatch;
+            }
+        }
+
+        if (numSlotsInFlight == 0) { //nothing submitted and nothing outstanding, so the circular buffer was empty
+            if (!m_noFatalErrorsOccurred.load(std::memory_order_acquire)) {
+                break;
+            }
+            //try again, but with the mutex
+            boost::mutex::scoped_lock lock(localMutex);
+            if (cb.GetIndexForRead() == CIRCULAR_INDEX_BUFFER_EMPTY) { //if empty again (lock mutex (above) before checking condition)
+                if (!m_running.load(std::memory_order_acquire)) { //m_running is mutex protected, if it stopped running, exit the thread (lock mutex (above) before checking condition)
+                    break; //thread stopping criteria (empty and not running)
+                }
+                cv.wait(lock); // call lock.unlock() and blocks the current thread
+                //thread is now unblocked, and the lock is reacquired by invoking lock.lock()
+            }
+            continue;
+        }
+
+        //one system call submits the whole batch and waits for at least one completion
+        if (!ring.SubmitAndWait(numSubmittedThisBatch, 1)) {
+            m_noFatalErrorsOccurred = false; //a fatal error occurred
+            break;
+        }
+
+        uint64_t userData;
+        int32_t result;
+        while (ring.PopCqe(userData, result)) {
+            const unsigned int completedIndex = static_cast<unsigned int>(userData);
+            const unsigned int cbPtrIndex = threadIndex * CIRCULAR_INDEX_BUFFER_SIZE + completedIndex;
+            const bool wasRead = (m_circularBufferReadFromStoragePointers[cbPtrIndex].load(std::memory_order_acquire) != NULL);
+            const unsigned int runLength = slotRunLengthVec[completedIndex];
+            const std::size_t expectedSize = (wasRead && (!usingDirectIo)) ? GetReadSizeBytes(cbPtrIndex) : (runLength * SEGMENT_SIZE);
+            if (result < 0) {
+                LOG_ERROR(subprocess) << "BundleStorageManagerIoUring: error on disk " << threadIndex << ": " << strerror(-result);
+            }
+            else if (static_cast<std::size_t>(result) != expectedSize) {
+                LOG_ERROR(subprocess) << "BundleStorageManagerIoUring: error on disk " << threadIndex << ": transferred " << result
+                    << " bytes but expected " << expectedSize;
+            }
+            else if (wasRead && usingDirectIo) {
+                CopyReadPayloadToDestination(cbPtrIndex);
+            }
+            for (unsigned int j = 0; j < runLength; ++j) {
+                slotInFlightVec[completedIndex + j] = 0;
+                slotCompletedVec[completedIndex + j] = 1;
+            }
+            numSlotsInFlight -= runLength;
+        }
+
+        bool committedAny = false;
+        m_mutexMainThread.lock();
+        while (numSlotsSubmittedNotCommitted) {
+            const unsigned int commitIndex = cb.GetIndexForRead();
+            if (!slotCompletedVec[commitIndex]) {
+                break;
+            }
+            slotCompletedVec[commitIndex] = 0;
+            const unsigned int cbPtrIndex = threadIndex * CIRCULAR_INDEX_BUFFER_SIZE + commitIndex;
+            if (m_circularBufferReadFromStoragePointers[cbPtrIndex].load(std::memory_order_acquire) != NULL) { //was read from disk
+                m_circularBufferIsReadCompletedPointers[cbPtrIndex].load(std::memory_order_acquire)->store(true, std::memory_order_release);
+            }
+            cb.CommitRead();
+            --numSlotsSubmittedNotCommitted;
+            committedAny = true;
+        }
+        m_mutexMainThread.unlock();
+        if (committedAny) {
+            m_conditionVariableMainThread.notify_one();
+        }
+    }
+
+    if (!m_noFatalErrorsOccurred.load(std::memory_order_acquire)) {
+        StopAllDiskThreads(); //sets m_running = false;
+    }
+    //the kernel may still be writing to the ring's buffers, so reap anything outstanding before the ring is destroyed
+    while (numSlotsInFlight) {
+        if (!ring.SubmitAndWait(0, 1)) {
+            break;
+        }
+        uint64_t userData;
+        int32_t result;
+        while (ring.PopCqe(userData, result)) {
+            numSlotsInFlight -= slotRunLengthVec[static_cast<unsigned int>(userData)];
+        }
+    }
+    close(fileDescriptor);
+}
+
+//virtual function to be called immediately after a disk's circular buffer CommitWrite();
+void BundleStorageManagerIoUring::CommitWriteAndNotifyDiskOfWorkToDo_ThreadSafe(const unsigned int diskId) {
+    CircularIndexBufferSingleProducerSingleConsumerConfigurable& cb = m_circularIndexBuffersVec[diskId];
+    std::pair<boost::condition_variable, boost::mutex>& cvMutexPairRef = m_conditionVariablesPlusMutexesVec[diskId];
+    boost::condition_variable& cv = cvMutexPairRef.first;
+    boost::mutex& cvMutex = cvMutexPairRef.second;
+
+    cvMutex.lock();
+    cb.CommitWrite();
+    cvMutex.unlock();
+    cv.notify_one();
+}
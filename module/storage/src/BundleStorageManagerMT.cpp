@@ -12,6 +12,10 @@
  * See LICENSE.md in the source root directory for more information.
  */
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 #include "BundleStorageManagerMT.h"
 #include <string>
 #include <boost/filesystem/path.hpp>
@@ -54,6 +58,9 @@ void BundleStorageManagerMT::StopAllDiskThreads() {
 }
 
 BundleStorageManagerMT::~BundleStorageManagerMT() {
+    if (m_running && (!m_autoDeleteFilesOnExit)) {
+        FlushRamCache(); //bundles held only in RAM must be on disk for the next restore
+    }
     StopAllDiskThreads();
     for (unsigned int diskId = 0; diskId < M_NUM_STORAGE_DISKS; ++diskId) {
         if (m_threadPtrsVec[diskId]) {
@@ -92,10 +99,27 @@ void BundleStorageManagerMT::ThreadFunc(const unsigned int threadIndex) {
     const boost::filesystem::path& filePath = m_filePathsVec[threadIndex];
     const boost::filesystem::path::value_type* filePathCstr = filePath.c_str();
     LOG_INFO(subprocess) << ((m_successfullyRestoredFromDisk) ? "reopening " : "creating ") << filePath;
-    FILE * fileHandle = (m_successfullyRestoredFromDisk) ? 
 #ifdef _WIN32
+    if (m_storageConfigPtr->m_storageDiskConfigVector[threadIndex].useDirectIo) {
+        LOG_WARNING(subprocess) << "direct I/O is not supported by BundleStorageManagerMT on Windows (use asio_single_threaded), "
+            << "opening " << filePath << " with page cached I/O";
+    }
+    FILE * fileHandle = (m_successfullyRestoredFromDisk) ?
         _wfopen(filePathCstr, L"r+bR") : _wfopen(filePathCstr, L"w+bR");
 #else
+    //direct I/O bypasses stdio (and its user space buffering) in favor of positional reads/writes straight from the aligned segment buffers
+    int directIoFileDescriptor = -1;
+    if (m_storageConfigPtr->m_storageDiskConfigVector[threadIndex].useDirectIo) {
+        bool usingDirectIo;
+        directIoFileDescriptor = OpenDiskFileDescriptor(threadIndex, usingDirectIo);
+        if (directIoFileDescriptor < 0) {
+            LOG_ERROR(subprocess) << "error opening " << filePath;
+            m_noFatalErrorsOccurred = false; //a fatal error occurred
+            StopAllDiskThreads(); //sets m_running = false;
+            return;
+        }
+    }
+    FILE * fileHandle = (directIoFileDescriptor >= 0) ? NULL : (m_successfullyRestoredFromDisk) ?
         fopen(filePathCstr, "r+bR") : fopen(filePathCstr, "w+bR");
 #endif // _WIN32
 
@@ -121,7 +145,8 @@ void BundleStorageManagerMT::ThreadFunc(const unsigned int threadIndex) {
 
         boost::uint8_t * const data = &circularBufferBlockDataPtr[consumeIndex * SEGMENT_SIZE]; //expected data for testing when reading
         const segment_id_t segmentId = circularBufferSegmentIdsPtr[consumeIndex];
-        uint8_t * const readFromStorageDestPointer = m_circularBufferReadFromStoragePointers[threadIndex * CIRCULAR_INDEX_BUFFER_SIZE + consumeIndex].load(std::memory_order_acquire);
+        const unsigned int cbPtrIndex = threadIndex * CIRCULAR_INDEX_BUFFER_SIZE + consumeIndex;
+        uint8_t * const readFromStorageDestPointer = m_circularBufferReadFromStoragePointers[cbPtrIndex].load(std::memory_order_acquire);
         const bool isWriteToDisk = (readFromStorageDestPointer == NULL);
         std::atomic<bool> junk;
         std::atomic<bool>& isReadCompletedRef = (isWriteToDisk) ?
@@ -134,35 +159,68 @@ void BundleStorageManagerMT::ThreadFunc(const unsigned int threadIndex) {
         }
 
         const boost::uint64_t offsetBytes = static_cast<boost::uint64_t>(segmentId / M_NUM_STORAGE_DISKS) * SEGMENT_SIZE;
-#ifdef _MSC_VER 
-        //If successful, returns 0. Otherwise, it returns a nonzero value.
-        const bool seekSuccess = _fseeki64_nolock(fileHandle, offsetBytes, SEEK_SET) == 0;
-#elif (BOOST_OS_MACOS || BOOST_OS_BSD)
-        const bool seekSuccess = fseeko(fileHandle, offsetBytes, SEEK_SET) == 0;
-#else //Linux or other OS
-        //Upon successful completion, the fseek, fseeko and fseeko64 subroutine return a value of 0. Otherwise, it returns a value of -1
-        const bool seekSuccess = fseeko64(fileHandle, offsetBytes, SEEK_SET) == 0;
-#endif
-        
-        if (seekSuccess) {
+        //writes of segments adjacent on this disk (e.g. a multi-segment bundle) are coalesced into one write from adjacent slots
+        const unsigned int numSlotsConsumed = (isWriteToDisk) ? GetNumCoalescableWrites(threadIndex, consumeIndex, cb.NumInBuffer()) : 1;
+        const std::size_t writeSizeBytes = numSlotsConsumed * SEGMENT_SIZE;
+#ifndef _WIN32
+        if (directIoFileDescriptor >= 0) {
             if (isWriteToDisk) {
-                if (fwrite(data, 1, SEGMENT_SIZE, fileHandle) != SEGMENT_SIZE) {
+                if (pwrite(directIoFileDescriptor, data, writeSizeBytes, static_cast<off_t>(offsetBytes)) != static_cast<ssize_t>(writeSizeBytes)) {
                     LOG_ERROR(subprocess) << "BundleStorageManagerMT: error writing";
                 }
             }
             else { //read from disk
-                if (fread((void*)readFromStorageDestPointer, 1, SEGMENT_SIZE, fileHandle) != SEGMENT_SIZE) {
+                if (pread(directIoFileDescriptor, readFromStorageDestPointer, SEGMENT_SIZE, static_cast<off_t>(offsetBytes)) != static_cast<ssize_t>(SEGMENT_SIZE)) {
                     LOG_ERROR(subprocess) << "BundleStorageManagerMT: error reading";
                 }
+                else {
+                    CopyReadPayloadToDestination(cbPtrIndex);
+                }
             }
         }
-        else {
-            LOG_ERROR(subprocess) << "BundleStorageManagerMT: error seeking";
+        else
+#endif
+        {
+#ifdef _MSC_VER 
+            //If successful, returns 0. Otherwise, it returns a nonzero value.
+            const bool seekSuccess = _fseeki64_nolock(fileHandle, offsetBytes, SEEK_SET) == 0;
+#elif (BOOST_OS_MACOS || BOOST_OS_BSD)
+            const bool seekSuccess = fseeko(fileHandle, offsetBytes, SEEK_SET) == 0;
+#else //Linux or other OS
+            //Upon successful completion, the fseek, fseeko and fseeko64 subroutine return a value of 0. Otherwise, it returns a value of -1
+            const bool seekSuccess = fseeko64(fileHandle, offsetBytes, SEEK_SET) == 0;
+#endif
+
+            if (seekSuccess) {
+                if (isWriteToDisk) {
+                    if (fwrite(data, 1, writeSizeBytes, fileHandle) != writeSizeBytes) {
+                        LOG_ERROR(subprocess) << "BundleStorageManagerMT: error writing";
+                    }
+                }
+                else if (uint8_t * const payloadDestPointer = m_circularBufferReadPayloadDestPointers[cbPtrIndex]) { //read header to cache, payload to bundle
+                    const std::size_t payloadSize = m_circularBufferReadPayloadSizes[cbPtrIndex];
+                    if ((fread((void*)readFromStorageDestPointer, 1, SEGMENT_RESERVED_SPACE, fileHandle) != SEGMENT_RESERVED_SPACE)
+                        || (fread((void*)payloadDestPointer, 1, payloadSize, fileHandle) != payloadSize))
+                    {
+                        LOG_ERROR(subprocess) << "BundleStorageManagerMT: error reading";
+                    }
+                }
+                else { //read from disk
+                    if (fread((void*)readFromStorageDestPointer, 1, SEGMENT_SIZE, fileHandle) != SEGMENT_SIZE) {
+                        LOG_ERROR(subprocess) << "BundleStorageManagerMT: error reading";
+                    }
+                }
+            }
+            else {
+                LOG_ERROR(subprocess) << "BundleStorageManagerMT: error seeking";
+            }
         }
 
         m_mutexMainThread.lock();
         isReadCompletedRef.store(true, std::memory_order_release);
-        cb.CommitRead();
+        for (unsigned int i = 0; i < numSlotsConsumed; ++i) {
+            cb.CommitRead();
+        }
         m_mutexMainThread.unlock();
         m_conditionVariableMainThread.notify_one();
     }
@@ -171,6 +229,11 @@ void BundleStorageManagerMT::ThreadFunc(const unsigned int threadIndex) {
         fclose(fileHandle);
         fileHandle = NULL;
     }
+#ifndef _WIN32
+    if (directIoFileDescriptor >= 0) {
+        close(directIoFileDescriptor);
+    }
+#endif
 }
 
 //virtual function to be called immediately after a disk's circular buffer CommitWrite();
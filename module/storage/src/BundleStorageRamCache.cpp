@@ -0,0 +1,116 @@
+/**
+ * @file BundleStorageRamCache.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include "BundleStorageRamCache.h"
+#include <utility>
+
+BundleStorageRamCache::BundleStorageRamCache(const uint64_t capacityBytes) :
+    M_CAPACITY_BYTES(capacityBytes),
+    m_numBytes(0),
+    m_totalHits(0),
+    m_totalMisses(0),
+    m_totalBundlesFlushedToDisk(0),
+    m_totalBundlesErasedBeforeFlush(0) {}
+
+BundleStorageRamCache::~BundleStorageRamCache() {}
+
+bool BundleStorageRamCache::IsEnabled() const noexcept {
+    return (M_CAPACITY_BYTES != 0);
+}
+
+bool BundleStorageRamCache::CanHold(const uint64_t bundleSizeBytes) const noexcept {
+    return (bundleSizeBytes <= M_CAPACITY_BYTES) && IsEnabled();
+}
+
+bool BundleStorageRamCache::NeedsFlushToHold(const uint64_t bundleSizeBytes) const noexcept {
+    return ((m_numBytes + bundleSizeBytes) > M_CAPACITY_BYTES);
+}
+
+bool BundleStorageRamCache::Insert(const segment_id_t headSegmentId, const uint64_t custodyId, const uint8_t * data, const std::size_t size) {
+    if (NeedsFlushToHold(size) || m_headSegmentIdToCachedBundleMap.count(headSegmentId)) {
+        return false;
+    }
+    m_cachedBundlesOldestFirst.emplace_back();
+    cached_bundle_t & cachedBundle = m_cachedBundlesOldestFirst.back();
+    cachedBundle.headSegmentId = headSegmentId;
+    cachedBundle.custodyId = custodyId;
+    cachedBundle.bundleData.assign(data, data + size);
+    m_headSegmentIdToCachedBundleMap.emplace(headSegmentId, std::prev(m_cachedBundlesOldestFirst.end()));
+    m_numBytes += size;
+    return true;
+}
+
+const padded_vector_uint8_t * BundleStorageRamCache::Find(const segment_id_t headSegmentId) const {
+    std::unordered_map<segment_id_t, cached_bundle_list_t::iterator>::const_iterator it = m_headSegmentIdToCachedBundleMap.find(headSegmentId);
+    if (it == m_headSegmentIdToCachedBundleMap.cend()) {
+        return NULL;
+    }
+    return &it->second->bundleData;
+}
+
+bool BundleStorageRamCache::Contains(const segment_id_t headSegmentId) const {
+    return (m_headSegmentIdToCachedBundleMap.count(headSegmentId) != 0);
+}
+
+bool BundleStorageRamCache::Erase(const segment_id_t headSegmentId) {
+    std::unordered_map<segment_id_t, cached_bundle_list_t::iterator>::iterator it = m_headSegmentIdToCachedBundleMap.find(headSegmentId);
+    if (it == m_headSegmentIdToCachedBundleMap.end()) {
+        return false;
+    }
+    m_numBytes -= it->second->bundleData.size();
+    m_cachedBundlesOldestFirst.erase(it->second);
+    m_headSegmentIdToCachedBundleMap.erase(it);
+    ++m_totalBundlesErasedBeforeFlush;
+    return true;
+}
+
+bool BundleStorageRamCache::PopOldestForFlush(uint64_t & custodyId, padded_vector_uint8_t & bundleData) {
+    if (m_cachedBundlesOldestFirst.empty()) {
+        return false;
+    }
+    cached_bundle_t & oldest = m_cachedBundlesOldestFirst.front();
+    custodyId = oldest.custodyId;
+    bundleData = std::move(oldest.bundleData);
+    m_numBytes -= bundleData.size();
+    m_headSegmentIdToCachedBundleMap.erase(oldest.headSegmentId);
+    m_cachedBundlesOldestFirst.pop_front();
+    ++m_totalBundlesFlushedToDisk;
+    return true;
+}
+
+void BundleStorageRamCache::CountRead(const bool hit) noexcept {
+    if (hit) {
+        ++m_totalHits;
+    }
+    else {
+        ++m_totalMisses;
+    }
+}
+
+uint64_t BundleStorageRamCache::GetCapacityBytes() const noexcept {
+    return M_CAPACITY_BYTES;
+}
+uint64_t BundleStorageRamCache::GetNumBundles() const noexcept {
+    return m_cachedBundlesOldestFirst.size();
+}
+uint64_t BundleStorageRamCache::GetNumBytes() const noexcept {
+    return m_numBytes;
+}
+uint64_t BundleStorageRamCache::GetTotalHits() const noexcept {
+    return m_totalHits;
+}
+uint64_t BundleStorageRamCache::GetTotalMisses() const noexcept {
+    return m_totalMisses;
+}
+uint64_t BundleStorageRamCache::GetTotalBundlesFlushedToDisk() const noexcept {
+    return m_totalBundlesFlushedToDisk;
+}
+uint64_t BundleStorageRamCache::GetTotalBundlesErasedBeforeFlush() const noexcept {
+    return m_totalBundlesErasedBeforeFlush;
+}
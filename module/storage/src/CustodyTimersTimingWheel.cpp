@@ -0,0 +1,328 @@
+/**
+ * @file CustodyTimersTimingWheel.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include "CustodyTimersTimingWheel.h"
+#include <boost/multiprecision/cpp_int.hpp>
+#include <boost/multiprecision/detail/bitscan.hpp>
+
+CustodyTimersTimingWheel::CustodyTimersTimingWheel(const boost::posix_time::time_duration & timeout,
+    const boost::posix_time::time_duration & tickDuration) :
+    M_CUSTODY_TIMEOUT_DURATION(timeout),
+    M_TICK_DURATION((tickDuration.total_microseconds() > 0) ? tickDuration : boost::posix_time::microseconds(1)),
+    M_EPOCH(boost::posix_time::microsec_clock::universal_time()),
+    m_currentTick(0),
+    m_numTimersInWheel(0),
+    m_cascadeGeneration(0)
+{
+    for (unsigned int level = 0; level < NUM_LEVELS; ++level) {
+        m_slotOccupiedBitmasks[level] = 0;
+    }
+    for (uint32_t listId = 0; listId <= NUM_WHEEL_LISTS; ++listId) {
+        list_t & list = m_lists[listId];
+        list.head = NIL;
+        list.tail = NIL;
+        list.cascadeGeneration = 0;
+        list.cascadeLast = NIL;
+    }
+}
+
+CustodyTimersTimingWheel::~CustodyTimersTimingWheel() {}
+
+uint64_t CustodyTimersTimingWheel::TimeToTick(const boost::posix_time::ptime & t, const bool roundUp) const {
+    if (t <= M_EPOCH) {
+        return 0;
+    }
+    const uint64_t elapsedMicroseconds = static_cast<uint64_t>((t - M_EPOCH).total_microseconds());
+    const uint64_t tickMicroseconds = static_cast<uint64_t>(M_TICK_DURATION.total_microseconds());
+    return (roundUp) ? ((elapsedMicroseconds + (tickMicroseconds - 1)) / tickMicroseconds) : (elapsedMicroseconds / tickMicroseconds);
+}
+
+void CustodyTimersTimingWheel::InsertIntoList(const uint32_t nodeIndex, const uint32_t listId, const uint32_t prevNodeIndex) {
+    timer_node_t & node = m_nodes[nodeIndex];
+    list_t & list = m_lists[listId];
+    node.listId = listId;
+    node.prev = prevNodeIndex;
+    if (prevNodeIndex == NIL) {
+        node.next = list.head;
+        list.head = nodeIndex;
+    }
+    else {
+        node.next = m_nodes[prevNodeIndex].next;
+        m_nodes[prevNodeIndex].next = nodeIndex;
+    }
+    if (node.next == NIL) {
+        list.tail = nodeIndex;
+    }
+    else {
+        m_nodes[node.next].prev = nodeIndex;
+    }
+    if (listId < NUM_WHEEL_LISTS) {
+        ++m_numTimersInWheel;
+        m_slotOccupiedBitmasks[listId >> SLOT_BITS] |= (static_cast<uint64_t>(1) << (listId & SLOT_MASK));
+    }
+}
+
+void CustodyTimersTimingWheel::UnlinkFromList(const uint32_t nodeIndex) {
+    timer_node_t & node = m_nodes[nodeIndex];
+    list_t & list = m_lists[node.listId];
+    if (node.prev == NIL) {
+        list.head = node.next;
+    }
+    else {
+        m_nodes[node.prev].next = node.next;
+    }
+    if (node.next == NIL) {
+        list.tail = node.prev;
+    }
+    else {
+        m_nodes[node.next].prev = node.prev;
+    }
+    if (node.listId < NUM_WHEEL_LISTS) {
+        --m_numTimersInWheel;
+        if (list.head == NIL) {
+            m_slotOccupiedBitmasks[node.listId >> SLOT_BITS] &= ~(static_cast<uint64_t>(1) << (node.listId & SLOT_MASK));
+        }
+    }
+}
+
+void CustodyTimersTimingWheel::UnlinkFromDestExpiredList(const uint32_t nodeIndex) {
+    timer_node_t & node = m_nodes[nodeIndex];
+    list_t & list = m_destinations[node.destIndex].expiredList;
+    if (node.destPrev == NIL) {
+        list.head = node.destNext;
+    }
+    else {
+        m_nodes[node.destPrev].destNext = node.destNext;
+    }
+    if (node.destNext == NIL) {
+        list.tail = node.destPrev;
+    }
+    else {
+        m_nodes[node.destNext].destPrev = node.destPrev;
+    }
+}
+
+void CustodyTimersTimingWheel::AddToWheelOrExpire(const uint32_t nodeIndex, const bool isCascade) {
+    timer_node_t & node = m_nodes[nodeIndex];
+    //(a cascaded timer expiring this tick goes to the level 0 slot of this tick, which is expired next, so it stays in order)
+    if ((node.expiryTick <= m_currentTick) && (!isCascade)) {
+        //append to the expired list and to the expired list of its destination (both stay in expiry order)
+        InsertIntoList(nodeIndex, EXPIRED_LIST_ID, m_lists[EXPIRED_LIST_ID].tail);
+        list_t & destExpiredList = m_destinations[node.destIndex].expiredList;
+        node.destPrev = destExpiredList.tail;
+        node.destNext = NIL;
+        if (destExpiredList.tail == NIL) {
+            destExpiredList.head = nodeIndex;
+        }
+        else {
+            m_nodes[destExpiredList.tail].destNext = nodeIndex;
+        }
+        destExpiredList.tail = nodeIndex;
+        return;
+    }
+
+    //the lowest level whose slots (spanning 64^level ticks each) are within reach of the expiry,
+    //clamping to the last tick of the top level if the expiry is even further away (it is re-cascaded there until it is in reach)
+    static constexpr uint64_t MAX_TICKS_AHEAD = (static_cast<uint64_t>(1) << (SLOT_BITS * NUM_LEVELS)) - 1;
+    const uint64_t ticksAhead = node.expiryTick - m_currentTick;
+    const uint64_t slotTick = (ticksAhead > MAX_TICKS_AHEAD) ? (m_currentTick + MAX_TICKS_AHEAD) : node.expiryTick;
+    unsigned int level = 0;
+    while ((level < (NUM_LEVELS - 1)) && ((ticksAhead >> (SLOT_BITS * (level + 1))) != 0)) {
+        ++level;
+    }
+    const uint32_t listId = (level << SLOT_BITS) + static_cast<uint32_t>((slotTick >> (SLOT_BITS * level)) & SLOT_MASK);
+    list_t & list = m_lists[listId];
+    uint32_t prevNodeIndex = list.tail;
+    if (isCascade) {
+        //cascaded timers were started before any timer already in the slot, so they go in front (in their original order)
+        if (list.cascadeGeneration != m_cascadeGeneration) {
+            list.cascadeGeneration = m_cascadeGeneration;
+            prevNodeIndex = NIL;
+        }
+        else {
+            prevNodeIndex = list.cascadeLast;
+        }
+        list.cascadeLast = nodeIndex;
+    }
+    InsertIntoList(nodeIndex, listId, prevNodeIndex);
+}
+
+void CustodyTimersTimingWheel::Cascade(const unsigned int level) {
+    const uint32_t listId = (level << SLOT_BITS) + static_cast<uint32_t>((m_currentTick >> (SLOT_BITS * level)) & SLOT_MASK);
+    list_t & list = m_lists[listId];
+    uint32_t nodeIndex = list.head;
+    list.head = NIL;
+    list.tail = NIL;
+    m_slotOccupiedBitmasks[level] &= ~(static_cast<uint64_t>(1) << (listId & SLOT_MASK));
+    ++m_cascadeGeneration;
+    while (nodeIndex != NIL) {
+        const uint32_t nextNodeIndex = m_nodes[nodeIndex].next;
+        --m_numTimersInWheel;
+        AddToWheelOrExpire(nodeIndex, true);
+        nodeIndex = nextNodeIndex;
+    }
+}
+
+void CustodyTimersTimingWheel::AdvanceTo(const uint64_t tick) {
+    while (m_currentTick < tick) {
+        if (m_numTimersInWheel == 0) {
+            m_currentTick = tick;
+            return;
+        }
+        //skip straight to the next tick that has something to do: the next occupied slot of level 0,
+        //or else the next cascade of the lowest occupied level (levels below it being empty)
+        uint64_t nextTick;
+        if (m_slotOccupiedBitmasks[0]) {
+            const uint64_t currentSlot = m_currentTick & SLOT_MASK;
+            const uint64_t laterSlotsBitmask = (currentSlot == SLOT_MASK) ? 0 : (m_slotOccupiedBitmasks[0] & (~static_cast<uint64_t>(0) << (currentSlot + 1)));
+            nextTick = (laterSlotsBitmask) ?
+                ((m_currentTick & ~SLOT_MASK) + boost::multiprecision::detail::find_lsb<uint64_t>(laterSlotsBitmask)) :
+                ((m_currentTick | SLOT_MASK) + 1);
+        }
+        else {
+            unsigned int lowestOccupiedLevel = 1;
+            while (m_slotOccupiedBitmasks[lowestOccupiedLevel] == 0) {
+                ++lowestOccupiedLevel;
+            }
+            const uint64_t levelSpanMask = (static_cast<uint64_t>(1) << (SLOT_BITS * lowestOccupiedLevel)) - 1;
+            nextTick = (m_currentTick | levelSpanMask) + 1;
+        }
+        if (nextTick > tick) {
+            m_currentTick = tick;
+            return;
+        }
+        m_currentTick = nextTick;
+
+        //cascade the higher levels whose slot boundary this tick is (lowest level first),
+        //then expire (in order) the level 0 slot of this tick
+        for (unsigned int level = 1; level < NUM_LEVELS; ++level) {
+            if ((m_currentTick & ((static_cast<uint64_t>(1) << (SLOT_BITS * level)) - 1)) != 0) {
+                break;
+            }
+            Cascade(level);
+        }
+        const uint32_t listId = static_cast<uint32_t>(m_currentTick & SLOT_MASK);
+        while (m_lists[listId].head != NIL) {
+            const uint32_t nodeIndex = m_lists[listId].head;
+            UnlinkFromList(nodeIndex);
+            AddToWheelOrExpire(nodeIndex, false);
+        }
+    }
+}
+
+void CustodyTimersTimingWheel::FreeNode(const uint32_t nodeIndex) {
+    uint32_t removedNodeIndex;
+    m_mapCustodyIdToNodeIndex.GetValueAndRemove(m_nodes[nodeIndex].custodyId, removedNodeIndex);
+    --m_destinations[m_nodes[nodeIndex].destIndex].numTimers;
+    m_freeNodeIndices.push_back(nodeIndex);
+}
+
+uint64_t CustodyTimersTimingWheel::PopExpired(const uint32_t nodeIndex) {
+    const uint64_t custodyId = m_nodes[nodeIndex].custodyId;
+    UnlinkFromList(nodeIndex);
+    UnlinkFromDestExpiredList(nodeIndex);
+    FreeNode(nodeIndex);
+    return custodyId;
+}
+
+bool CustodyTimersTimingWheel::PollOneAndPopExpiredCustodyTimer(uint64_t & custodyId, const std::vector<cbhe_eid_t> & availableDestEids, const boost::posix_time::ptime & nowPtime) {
+    AdvanceTo(TimeToTick(nowPtime, false));
+    uint32_t lowestExpiryNodeIndex = NIL;
+    for (std::size_t i = 0; i < availableDestEids.size(); ++i) {
+        std::map<cbhe_eid_t, uint32_t>::const_iterator it = m_mapDestEidToDestIndex.find(availableDestEids[i]);
+        if (it != m_mapDestEidToDestIndex.cend()) {
+            const uint32_t nodeIndex = m_destinations[it->second].expiredList.head;
+            if ((nodeIndex != NIL) && ((lowestExpiryNodeIndex == NIL) || (m_nodes[nodeIndex].expiryTick < m_nodes[lowestExpiryNodeIndex].expiryTick))) {
+                lowestExpiryNodeIndex = nodeIndex;
+            }
+        }
+    }
+    if (lowestExpiryNodeIndex == NIL) {
+        return false;
+    }
+    custodyId = PopExpired(lowestExpiryNodeIndex);
+    return true;
+}
+
+bool CustodyTimersTimingWheel::PollOneAndPopAnyExpiredCustodyTimer(uint64_t & custodyId, const boost::posix_time::ptime & nowPtime) {
+    AdvanceTo(TimeToTick(nowPtime, false));
+    const uint32_t nodeIndex = m_lists[EXPIRED_LIST_ID].head;
+    if (nodeIndex == NIL) {
+        return false;
+    }
+    custodyId = PopExpired(nodeIndex);
+    return true;
+}
+
+bool CustodyTimersTimingWheel::StartCustodyTransferTimer(const cbhe_eid_t & finalDestEid, const uint64_t custodyId) {
+    const uint32_t nodeIndex = (m_freeNodeIndices.empty()) ? static_cast<uint32_t>(m_nodes.size()) : m_freeNodeIndices.back();
+    if (m_mapCustodyIdToNodeIndex.Insert(custodyId, nodeIndex) == NULL) {
+        return false; //already started
+    }
+    if (m_freeNodeIndices.empty()) {
+        m_nodes.emplace_back();
+    }
+    else {
+        m_freeNodeIndices.pop_back();
+    }
+
+    std::pair<std::map<cbhe_eid_t, uint32_t>::iterator, bool> destRetVal =
+        m_mapDestEidToDestIndex.emplace(finalDestEid, static_cast<uint32_t>(m_destinations.size()));
+    if (destRetVal.second) {
+        m_destinations.emplace_back();
+        destination_t & dest = m_destinations.back();
+        dest.eid = finalDestEid;
+        dest.expiredList.head = NIL;
+        dest.expiredList.tail = NIL;
+        dest.expiredList.cascadeGeneration = 0;
+        dest.expiredList.cascadeLast = NIL;
+        dest.numTimers = 0;
+    }
+    const uint32_t destIndex = destRetVal.first->second;
+    ++m_destinations[destIndex].numTimers;
+
+    timer_node_t & node = m_nodes[nodeIndex];
+    node.custodyId = custodyId;
+    node.expiryTick = TimeToTick(boost::posix_time::microsec_clock::universal_time() + M_CUSTODY_TIMEOUT_DURATION, true);
+    node.destIndex = destIndex;
+    node.destPrev = NIL;
+    node.destNext = NIL;
+    AddToWheelOrExpire(nodeIndex, false);
+    return true;
+}
+
+bool CustodyTimersTimingWheel::CancelCustodyTransferTimer(const cbhe_eid_t & finalDestEid, const uint64_t custodyId) {
+    const uint32_t * const nodeIndexPtr = m_mapCustodyIdToNodeIndex.GetValuePtr(custodyId);
+    if (nodeIndexPtr == NULL) {
+        return false;
+    }
+    const uint32_t nodeIndex = *nodeIndexPtr;
+    const timer_node_t & node = m_nodes[nodeIndex];
+    if (m_destinations[node.destIndex].eid != finalDestEid) {
+        return false;
+    }
+    UnlinkFromList(nodeIndex);
+    if (node.listId == EXPIRED_LIST_ID) {
+        UnlinkFromDestExpiredList(nodeIndex);
+    }
+    FreeNode(nodeIndex);
+    return true;
+}
+
+std::size_t CustodyTimersTimingWheel::GetNumCustodyTransferTimers() {
+    return m_mapCustodyIdToNodeIndex.GetSize();
+}
+
+std::size_t CustodyTimersTimingWheel::GetNumCustodyTransferTimers(const cbhe_eid_t & finalDestEid) {
+    std::map<cbhe_eid_t, uint32_t>::const_iterator it = m_mapDestEidToDestIndex.find(finalDestEid);
+    if (it != m_mapDestEidToDestIndex.cend()) {
+        return m_destinations[it->second].numTimers;
+    }
+    return 0;
+}
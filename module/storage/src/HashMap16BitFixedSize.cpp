@@ -213,6 +213,17 @@ std::size_t HashMap16BitFixedSize<keyType, valueType>::GetBucketSize(const uint1
     return size;
 }
 
+template <typename keyType, typename valueType>
+void HashMap16BitFixedSize<keyType, valueType>::GetKeys(std::vector<keyType> & keys) const {
+    keys.resize(0);
+    for (std::size_t i = 0; i < m_buckets.size(); ++i) {
+        const bucket_t & bucket = m_buckets[i];
+        for (typename bucket_t::const_iterator it = bucket.cbegin(); it != bucket.cend(); ++it) {
+            keys.push_back(it->first);
+        }
+    }
+}
+
 // Explicit template instantiation
 template class HashMap16BitFixedSize<cbhe_bundle_uuid_t, uint64_t>;
 template class HashMap16BitFixedSize<cbhe_bundle_uuid_nofragment_t, uint64_t>;
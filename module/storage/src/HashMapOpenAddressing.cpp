@@ -0,0 +1,287 @@
+/**
+ * @file HashMapOpenAddressing.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include "HashMapOpenAddressing.h"
+#ifdef USE_CRC32C_FAST
+# ifdef HAVE_SSE2NEON_H
+#include "sse2neon.h"
+# else
+#include <nmmintrin.h>
+# endif
+#endif
+#include <limits>
+#include "CatalogEntry.h"
+
+static constexpr std::size_t INITIAL_NUM_SLOTS = 1024; //must be a power of 2
+static constexpr unsigned int PAIR_BLOCK_SIZE_BITS = 12; //4096 key value pairs per block
+static constexpr uint32_t PAIR_BLOCK_INDEX_MASK = (1U << PAIR_BLOCK_SIZE_BITS) - 1;
+
+#ifndef USE_CRC32C_FAST
+//the 64-bit finalizer of MurmurHash3, so that every bit of the input affects the low bits used as the slot index
+static uint64_t Mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= UINT64_C(0xff51afd7ed558ccd);
+    x ^= x >> 33;
+    x *= UINT64_C(0xc4ceb9fe1a85ec53);
+    x ^= x >> 33;
+    return x;
+}
+static uint32_t Fold64(const uint64_t x) {
+    return (static_cast<uint32_t>(x >> 32)) ^ (static_cast<uint32_t>(x));
+}
+#endif
+
+template <typename keyType, typename valueType>
+HashMapOpenAddressing<keyType, valueType>::HashMapOpenAddressing() :
+    m_slots(INITIAL_NUM_SLOTS, slot_t()),
+    m_slotIndexMask(INITIAL_NUM_SLOTS - 1),
+    m_size(0),
+    m_numPairsTakenFromBlocks(0) {}
+
+template <typename keyType, typename valueType>
+HashMapOpenAddressing<keyType, valueType>::~HashMapOpenAddressing() {}
+
+template <typename keyType, typename valueType>
+uint32_t HashMapOpenAddressing<keyType, valueType>::GetHash(const cbhe_bundle_uuid_t & bundleUuid) {
+    const uint64_t v1 = bundleUuid.creationSeconds;
+    const uint64_t v2 = bundleUuid.sequence;
+    const uint64_t v3 = bundleUuid.srcEid.nodeId;
+    const uint64_t v4 = bundleUuid.srcEid.serviceId;
+    const uint64_t v5 = bundleUuid.fragmentOffset;
+    const uint64_t v6 = bundleUuid.dataLength;
+#ifdef USE_CRC32C_FAST
+    return static_cast<uint32_t>(
+        _mm_crc32_u64(_mm_crc32_u64(_mm_crc32_u64(_mm_crc32_u64(_mm_crc32_u64(_mm_crc32_u64(UINT32_MAX, v1), v2), v3), v4), v5), v6)
+    );
+#else
+    return Fold64(Mix64(Mix64(Mix64(Mix64(Mix64(Mix64(v1) ^ v2) ^ v3) ^ v4) ^ v5) ^ v6));
+#endif
+}
+
+template <typename keyType, typename valueType>
+uint32_t HashMapOpenAddressing<keyType, valueType>::GetHash(const cbhe_bundle_uuid_nofragment_t & bundleUuid) {
+    const uint64_t v1 = bundleUuid.creationSeconds;
+    const uint64_t v2 = bundleUuid.sequence;
+    const uint64_t v3 = bundleUuid.srcEid.nodeId;
+    const uint64_t v4 = bundleUuid.srcEid.serviceId;
+#ifdef USE_CRC32C_FAST
+    return static_cast<uint32_t>(_mm_crc32_u64(_mm_crc32_u64(_mm_crc32_u64(_mm_crc32_u64(UINT32_MAX, v1), v2), v3), v4));
+#else
+    return Fold64(Mix64(Mix64(Mix64(Mix64(v1) ^ v2) ^ v3) ^ v4));
+#endif
+}
+
+template <typename keyType, typename valueType>
+uint32_t HashMapOpenAddressing<keyType, valueType>::GetHash(const uint64_t key) {
+    //custody ids are mostly sequential, but still must be spread across the slots so that a run of
+    //ids removed or inserted together cannot form one long probe sequence
+#ifdef USE_CRC32C_FAST
+    return static_cast<uint32_t>(_mm_crc32_u64(UINT32_MAX, key));
+#else
+    return Fold64(Mix64(key));
+#endif
+}
+
+template <typename keyType, typename valueType>
+typename HashMapOpenAddressing<keyType, valueType>::key_value_pair_t & HashMapOpenAddressing<keyType, valueType>::PairAt(const uint32_t pairIndex) const {
+    return m_pairBlocks[pairIndex >> PAIR_BLOCK_SIZE_BITS][pairIndex & PAIR_BLOCK_INDEX_MASK];
+}
+
+//return the index of the slot holding key, or SIZE_MAX if key doesn't exist in the map
+template <typename keyType, typename valueType>
+std::size_t HashMapOpenAddressing<keyType, valueType>::FindSlotIndex(const uint32_t hash, const keyType & key) const {
+    for (std::size_t slotIndex = hash & m_slotIndexMask; ; slotIndex = (slotIndex + 1) & m_slotIndexMask) {
+        const slot_t & slot = m_slots[slotIndex];
+        if (slot.pairIndexPlusOne == 0) { //an empty slot ends the probe sequence, therefore not found
+            return SIZE_MAX;
+        }
+        else if ((slot.hash == hash) && (PairAt(slot.pairIndexPlusOne - 1).first == key)) {
+            return slotIndex;
+        }
+    }
+}
+
+//only the slots move, the key value pairs stay where they are
+template <typename keyType, typename valueType>
+void HashMapOpenAddressing<keyType, valueType>::Rehash(const std::size_t newNumSlots) {
+    std::vector<slot_t> oldSlots(newNumSlots, slot_t());
+    oldSlots.swap(m_slots);
+    m_slotIndexMask = newNumSlots - 1;
+    for (std::size_t i = 0; i < oldSlots.size(); ++i) {
+        const slot_t & oldSlot = oldSlots[i];
+        if (oldSlot.pairIndexPlusOne) {
+            std::size_t slotIndex = oldSlot.hash & m_slotIndexMask;
+            while (m_slots[slotIndex].pairIndexPlusOne) {
+                slotIndex = (slotIndex + 1) & m_slotIndexMask;
+            }
+            m_slots[slotIndex] = oldSlot;
+        }
+    }
+}
+
+template <typename keyType, typename valueType>
+void HashMapOpenAddressing<keyType, valueType>::Reserve(const std::size_t numElements) {
+    std::size_t newNumSlots = m_slots.size();
+    while ((numElements * 4) > (newNumSlots * 3)) {
+        newNumSlots *= 2;
+    }
+    if (newNumSlots != m_slots.size()) {
+        Rehash(newNumSlots);
+    }
+}
+
+//return ptr of inserted pair if inserted, NULL if already exists
+template <typename keyType, typename valueType>
+const typename HashMapOpenAddressing<keyType, valueType>::key_value_pair_t * HashMapOpenAddressing<keyType, valueType>::Insert(const keyType & key, const valueType & value) {
+    return Insert(GetHash(key), key, std::move(valueType(value)));
+}
+
+//return ptr of inserted pair if inserted, NULL if already exists
+template <typename keyType, typename valueType>
+const typename HashMapOpenAddressing<keyType, valueType>::key_value_pair_t * HashMapOpenAddressing<keyType, valueType>::Insert(const keyType & key, valueType && value) {
+    return Insert(GetHash(key), key, std::move(value));
+}
+
+//return ptr of inserted pair if inserted, NULL if already exists
+template <typename keyType, typename valueType>
+const typename HashMapOpenAddressing<keyType, valueType>::key_value_pair_t * HashMapOpenAddressing<keyType, valueType>::Insert(const uint32_t hash, const keyType & key, const valueType & value) {
+    return Insert(hash, key, std::move(valueType(value)));
+}
+
+//return ptr of inserted pair if inserted, NULL if already exists
+template <typename keyType, typename valueType>
+const typename HashMapOpenAddressing<keyType, valueType>::key_value_pair_t * HashMapOpenAddressing<keyType, valueType>::Insert(const uint32_t hash, const keyType & key, valueType && value) {
+    std::size_t slotIndex = hash & m_slotIndexMask;
+    for (; m_slots[slotIndex].pairIndexPlusOne; slotIndex = (slotIndex + 1) & m_slotIndexMask) {
+        const slot_t & slot = m_slots[slotIndex];
+        if ((slot.hash == hash) && (PairAt(slot.pairIndexPlusOne - 1).first == key)) { //equal, already exists
+            return NULL;
+        }
+    }
+    //not in map, slotIndex is the empty slot that ended the probe sequence
+    uint32_t pairIndex;
+    if (!m_freePairIndices.empty()) {
+        pairIndex = m_freePairIndices.back();
+        m_freePairIndices.pop_back();
+    }
+    else {
+        if (m_numPairsTakenFromBlocks == (std::numeric_limits<uint32_t>::max() - 1)) { //pairIndexPlusOne would overflow (more than 4 billion entries is not supported)
+            return NULL;
+        }
+        pairIndex = m_numPairsTakenFromBlocks++;
+        if ((pairIndex & PAIR_BLOCK_INDEX_MASK) == 0) {
+            m_pairBlocks.emplace_back(new key_value_pair_t[PAIR_BLOCK_INDEX_MASK + 1]);
+        }
+    }
+    key_value_pair_t & pair = PairAt(pairIndex);
+    pair.first = key;
+    pair.second = std::move(value);
+    ++m_size;
+    if ((m_size * 4) > (m_slots.size() * 3)) { //keep the load factor at or below 3/4
+        Rehash(m_slots.size() * 2);
+        slotIndex = hash & m_slotIndexMask;
+        while (m_slots[slotIndex].pairIndexPlusOne) {
+            slotIndex = (slotIndex + 1) & m_slotIndexMask;
+        }
+    }
+    slot_t & slot = m_slots[slotIndex];
+    slot.hash = hash;
+    slot.pairIndexPlusOne = pairIndex + 1;
+    return &pair;
+}
+
+//return true if exists, false if key doesn't exist in the map
+template <typename keyType, typename valueType>
+bool HashMapOpenAddressing<keyType, valueType>::GetValueAndRemove(const keyType & key, valueType & value) {
+    return GetValueAndRemove(GetHash(key), key, value);
+}
+
+//return true if exists, false if key doesn't exist in the map
+template <typename keyType, typename valueType>
+bool HashMapOpenAddressing<keyType, valueType>::GetValueAndRemove(const uint32_t hash, const keyType & key, valueType & value) {
+    std::size_t emptySlotIndex = FindSlotIndex(hash, key);
+    if (emptySlotIndex == SIZE_MAX) {
+        return false;
+    }
+    //key may refer to the pair being removed, so it must not be used beyond this point
+    const uint32_t pairIndex = m_slots[emptySlotIndex].pairIndexPlusOne - 1;
+    value = std::move(PairAt(pairIndex).second);
+    m_freePairIndices.push_back(pairIndex);
+    --m_size;
+
+    //backward shift deletion: move each following slot of the probe sequence back into the hole
+    //unless its own probe sequence starts after the hole (i.e. its home slot is within (hole, slot])
+    for (std::size_t slotIndex = (emptySlotIndex + 1) & m_slotIndexMask; m_slots[slotIndex].pairIndexPlusOne; slotIndex = (slotIndex + 1) & m_slotIndexMask) {
+        const std::size_t homeSlotIndex = m_slots[slotIndex].hash & m_slotIndexMask;
+        const bool homeIsWithinHoleToSlot = (emptySlotIndex <= slotIndex) ?
+            ((emptySlotIndex < homeSlotIndex) && (homeSlotIndex <= slotIndex)) :
+            ((emptySlotIndex < homeSlotIndex) || (homeSlotIndex <= slotIndex));
+        if (!homeIsWithinHoleToSlot) {
+            m_slots[emptySlotIndex] = m_slots[slotIndex];
+            emptySlotIndex = slotIndex;
+        }
+    }
+    m_slots[emptySlotIndex] = slot_t();
+    return true;
+}
+
+//return ptr if exists, NULL if key doesn't exist in the map
+template <typename keyType, typename valueType>
+valueType * HashMapOpenAddressing<keyType, valueType>::GetValuePtr(const keyType & key) {
+    return GetValuePtr(GetHash(key), key);
+}
+
+//return ptr if exists, NULL if key doesn't exist in the map
+template <typename keyType, typename valueType>
+valueType * HashMapOpenAddressing<keyType, valueType>::GetValuePtr(const uint32_t hash, const keyType & key) {
+    const std::size_t slotIndex = FindSlotIndex(hash, key);
+    if (slotIndex == SIZE_MAX) {
+        return NULL;
+    }
+    return &(PairAt(m_slots[slotIndex].pairIndexPlusOne - 1).second);
+}
+
+template <typename keyType, typename valueType>
+void HashMapOpenAddressing<keyType, valueType>::GetKeys(std::vector<keyType> & keys) const {
+    keys.resize(0);
+    keys.reserve(m_size);
+    for (std::size_t i = 0; i < m_slots.size(); ++i) {
+        const slot_t & slot = m_slots[i];
+        if (slot.pairIndexPlusOne) {
+            keys.push_back(PairAt(slot.pairIndexPlusOne - 1).first);
+        }
+    }
+}
+
+template <typename keyType, typename valueType>
+std::size_t HashMapOpenAddressing<keyType, valueType>::GetSize() const noexcept {
+    return m_size;
+}
+
+template <typename keyType, typename valueType>
+std::size_t HashMapOpenAddressing<keyType, valueType>::GetNumSlots() const noexcept {
+    return m_slots.size();
+}
+
+template <typename keyType, typename valueType>
+void HashMapOpenAddressing<keyType, valueType>::Clear() {
+    m_slots.assign(INITIAL_NUM_SLOTS, slot_t());
+    m_slots.shrink_to_fit();
+    m_slotIndexMask = INITIAL_NUM_SLOTS - 1;
+    m_size = 0;
+    m_pairBlocks.clear();
+    m_freePairIndices.clear();
+    m_numPairsTakenFromBlocks = 0;
+}
+
+// Explicit template instantiation
+template class HashMapOpenAddressing<cbhe_bundle_uuid_t, uint64_t>;
+template class HashMapOpenAddressing<cbhe_bundle_uuid_nofragment_t, uint64_t>;
+template class HashMapOpenAddressing<uint64_t, catalog_entry_t>;
+template class HashMapOpenAddressing<uint64_t, uint32_t>; //CustodyTimersTimingWheel
@@ -15,7 +15,9 @@
 #include <boost/multiprecision/cpp_int.hpp>
 #include <boost/multiprecision/detail/bitscan.hpp>
 #include <string>
+#include <bitset>
 #include <inttypes.h>
+#include <algorithm>
 #ifdef USE_BITTEST
 # include <immintrin.h>
 # ifdef HAVE_INTRIN_H
@@ -51,6 +53,27 @@ void MemoryManagerTreeArray::BackupDataToVector(memmanager_t & backup) const {
     backup = m_bitMasks;
 }
 
+bool MemoryManagerTreeArray::RestoreDataFromVector(const memmanager_t & backup) {
+    if (backup.size() != m_bitMasks.size()) {
+        return false;
+    }
+    for (std::size_t depthIndex = 0; depthIndex < m_bitMasks.size(); ++depthIndex) {
+        if (backup[depthIndex].size() != m_bitMasks[depthIndex].size()) {
+            return false;
+        }
+    }
+    //a leaf bit of 0 is an allocated segment (bits of segment ids >= M_MAX_SEGMENTS are never cleared)
+    const std::vector<uint64_t> & leafRow = backup[MAX_TREE_ARRAY_DEPTH - 1];
+    uint64_t numSegmentsAllocated = 0;
+    for (std::size_t i = 0; i < leafRow.size(); ++i) {
+        numSegmentsAllocated += 64 - std::bitset<64>(leafRow[i]).count();
+    }
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_bitMasks = backup;
+    m_numSegmentsAllocated = numSegmentsAllocated;
+    return true;
+}
+
 const memmanager_t & MemoryManagerTreeArray::GetVectorsConstRef() const {
     return m_bitMasks;
 }
@@ -228,9 +251,63 @@ bool MemoryManagerTreeArray::AllocateSegmentId_NotThreadSafe(const segment_id_t
     return true;
 }
 
+bool MemoryManagerTreeArray::AllocateContiguousSegments_NotThreadSafe(segment_id_chain_vec_t & segmentVec) {
+    const uint64_t numSegments = segmentVec.size();
+    if ((numSegments == 0) || (m_bitMasks[0][0] == 0)) return false; //bitmask of zero means full
+    //walk down the tree to the first free segment without allocating it
+    uint64_t firstFreeSegmentId = 0;
+    for (segment_id_t depthIndex = 0; depthIndex < MAX_TREE_ARRAY_DEPTH; ++depthIndex) {
+        firstFreeSegmentId = (firstFreeSegmentId << 6) | boost::multiprecision::detail::find_lsb<uint64_t>(m_bitMasks[depthIndex][firstFreeSegmentId]);
+    }
+    //scan the leaf row (a 1 bit is free) for the first long enough run
+    const std::vector<uint64_t> & leafRow = m_bitMasks[MAX_TREE_ARRAY_DEPTH - 1];
+    const uint64_t endLongIndex = std::min(static_cast<uint64_t>(leafRow.size()),
+        (firstFreeSegmentId + MEMORY_MANAGER_CONTIGUOUS_SEARCH_MAX_SEGMENTS + 63) >> 6);
+    uint64_t runStart = 0;
+    uint64_t runLength = 0;
+    for (uint64_t longIndex = firstFreeSegmentId >> 6; (longIndex < endLongIndex) && (runLength < numSegments); ++longIndex) {
+        const uint64_t leafLong = leafRow[longIndex];
+        if (leafLong == UINT64_MAX) { //all 64 free
+            if (runLength == 0) {
+                runStart = longIndex << 6;
+            }
+            runLength += 64;
+        }
+        else if (leafLong == 0) { //all 64 allocated
+            runLength = 0;
+        }
+        else {
+            for (unsigned int bitIndex = 0; (bitIndex < 64) && (runLength < numSegments); ++bitIndex) {
+                if ((leafLong >> bitIndex) & 1) {
+                    if (runLength == 0) {
+                        runStart = (longIndex << 6) | bitIndex;
+                    }
+                    ++runLength;
+                }
+                else {
+                    runLength = 0;
+                }
+            }
+        }
+    }
+    //leaf bits of segment ids >= M_MAX_SEGMENTS are never cleared, so a run may extend past the last segment
+    if ((runLength < numSegments) || ((runStart + numSegments) > M_MAX_SEGMENTS)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < numSegments; ++i) {
+        const segment_id_t segmentId = static_cast<segment_id_t>(runStart + i);
+        AllocateSegmentId_NotThreadSafe(segmentId); //free as verified above
+        segmentVec[i] = segmentId;
+    }
+    return true;
+}
+
 bool MemoryManagerTreeArray::AllocateSegments_ThreadSafe(segment_id_chain_vec_t & segmentVec) { //number of segments should be the vector size
     boost::mutex::scoped_lock lock(m_mutex);
     const std::size_t size = segmentVec.size();
+    if ((size > 1) && AllocateContiguousSegments_NotThreadSafe(segmentVec)) {
+        return true;
+    }
     for (std::size_t i = 0; i < size; ++i) {
         const segment_id_t segmentId = GetAndSetFirstFreeSegmentId_NotThreadSafe();
         if (segmentId != SEGMENT_ID_FULL) { //success
@@ -0,0 +1,583 @@
+/**
+ * @file StorageCatalogJournal.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include "StorageCatalogJournal.h"
+#include "BundleStorageConfig.h"
+#include "Logger.h"
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <boost/filesystem/operations.hpp>
+#include <boost/endian/conversion.hpp>
+#include <boost/crc.hpp>
+
+static constexpr hdtn::Logger::SubProcess subprocess = hdtn::Logger::SubProcess::storage;
+
+//file formats (all integers little endian):
+//  snapshot: magic[8], generation, maxSegments, numStorageDisks, numBitmapRows, {rowSize, row[rowSize]}..., numEntries, entry..., crc32 (of everything after the magic)
+//  journal:  magic[8], generation, record... where record = recordLength(u32), recordType(u8), payload[recordLength - 1], crc32 (of recordType and payload)
+//  entry:    custodyId, bundleSizeBytes, payloadSizeBytes, destNodeId, destServiceId, encodedAbsExpirationAndCustodyAndPriority, sequence,
+//            bundle uuid (6 integers if custody and fragmentation, 4 integers if custody and no fragmentation, else none), numSegments, segmentId...
+static const char SNAPSHOT_MAGIC[8] = { 'H','D','T','N','C','S','0','1' };
+static const char JOURNAL_MAGIC[8] = { 'H','D','T','N','C','J','0','1' };
+static constexpr uint8_t RECORD_TYPE_STORE = 1;
+static constexpr uint8_t RECORD_TYPE_REMOVE = 2;
+
+static void AppendU64(std::vector<uint8_t> & buf, const uint64_t value) {
+    const uint64_t valueLittleEndian = boost::endian::native_to_little(value);
+    const uint8_t * const p = reinterpret_cast<const uint8_t*>(&valueLittleEndian);
+    buf.insert(buf.end(), p, p + sizeof(valueLittleEndian));
+}
+static void AppendU32(std::vector<uint8_t> & buf, const uint32_t value) {
+    const uint32_t valueLittleEndian = boost::endian::native_to_little(value);
+    const uint8_t * const p = reinterpret_cast<const uint8_t*>(&valueLittleEndian);
+    buf.insert(buf.end(), p, p + sizeof(valueLittleEndian));
+}
+static uint32_t Crc32(const uint8_t * data, const std::size_t size) {
+    boost::crc_32_type crc;
+    crc.process_bytes(data, size);
+    return crc.checksum();
+}
+
+struct CatalogJournalBufferReader {
+    CatalogJournalBufferReader(const uint8_t * data, const std::size_t size) : m_ptr(data), m_end(data + size) {}
+    bool ReadU64(uint64_t & value) {
+        if (static_cast<std::size_t>(m_end - m_ptr) < sizeof(value)) {
+            return false;
+        }
+        memcpy(&value, m_ptr, sizeof(value));
+        boost::endian::little_to_native_inplace(value);
+        m_ptr += sizeof(value);
+        return true;
+    }
+    bool AtEnd() const {
+        return (m_ptr == m_end);
+    }
+    std::size_t BytesRemaining() const {
+        return static_cast<std::size_t>(m_end - m_ptr);
+    }
+    const uint8_t * m_ptr;
+    const uint8_t * const m_end;
+};
+
+static bool AppendCatalogEntry(std::vector<uint8_t> & buf, const uint64_t custodyId, const catalog_entry_t & catalogEntry) {
+    AppendU64(buf, custodyId);
+    AppendU64(buf, catalogEntry.bundleSizeBytes);
+    AppendU64(buf, catalogEntry.payloadSizeBytes);
+    AppendU64(buf, catalogEntry.destEid.nodeId);
+    AppendU64(buf, catalogEntry.destEid.serviceId);
+    AppendU64(buf, catalogEntry.encodedAbsExpirationAndCustodyAndPriority);
+    AppendU64(buf, catalogEntry.sequence);
+    if (catalogEntry.HasCustodyAndFragmentation()) {
+        const cbhe_bundle_uuid_t * uuidPtr = static_cast<const cbhe_bundle_uuid_t*>(catalogEntry.ptrUuidKeyInMap);
+        if (uuidPtr == NULL) {
+            return false;
+        }
+        AppendU64(buf, uuidPtr->creationSeconds);
+        AppendU64(buf, uuidPtr->sequence);
+        AppendU64(buf, uuidPtr->srcEid.nodeId);
+        AppendU64(buf, uuidPtr->srcEid.serviceId);
+        AppendU64(buf, uuidPtr->fragmentOffset);
+        AppendU64(buf, uuidPtr->dataLength);
+    }
+    else if (catalogEntry.HasCustodyAndNonFragmentation()) {
+        const cbhe_bundle_uuid_nofragment_t * uuidPtr = static_cast<const cbhe_bundle_uuid_nofragment_t*>(catalogEntry.ptrUuidKeyInMap);
+        if (uuidPtr == NULL) {
+            return false;
+        }
+        AppendU64(buf, uuidPtr->creationSeconds);
+        AppendU64(buf, uuidPtr->sequence);
+        AppendU64(buf, uuidPtr->srcEid.nodeId);
+        AppendU64(buf, uuidPtr->srcEid.serviceId);
+    }
+    AppendU64(buf, catalogEntry.segmentIdChainVec.size());
+    for (std::size_t i = 0; i < catalogEntry.segmentIdChainVec.size(); ++i) {
+        AppendU64(buf, catalogEntry.segmentIdChainVec[i]);
+    }
+    return true;
+}
+
+static bool ReadCatalogEntry(CatalogJournalBufferReader & reader, catalog_journal_restored_bundle_t & restoredBundle, const uint64_t maxSegments) {
+    catalog_entry_t & catalogEntry = restoredBundle.catalogEntry;
+    if (!(reader.ReadU64(restoredBundle.custodyId)
+        && reader.ReadU64(catalogEntry.bundleSizeBytes)
+        && reader.ReadU64(catalogEntry.payloadSizeBytes)
+        && reader.ReadU64(catalogEntry.destEid.nodeId)
+        && reader.ReadU64(catalogEntry.destEid.serviceId)
+        && reader.ReadU64(catalogEntry.encodedAbsExpirationAndCustodyAndPriority)
+        && reader.ReadU64(catalogEntry.sequence)))
+    {
+        return false;
+    }
+    cbhe_bundle_uuid_t & uuid = restoredBundle.bundleUuid;
+    uuid = cbhe_bundle_uuid_t();
+    if (catalogEntry.HasCustodyAndFragmentation()) {
+        if (!(reader.ReadU64(uuid.creationSeconds)
+            && reader.ReadU64(uuid.sequence)
+            && reader.ReadU64(uuid.srcEid.nodeId)
+            && reader.ReadU64(uuid.srcEid.serviceId)
+            && reader.ReadU64(uuid.fragmentOffset)
+            && reader.ReadU64(uuid.dataLength)))
+        {
+            return false;
+        }
+    }
+    else if (catalogEntry.HasCustodyAndNonFragmentation()) {
+        if (!(reader.ReadU64(uuid.creationSeconds)
+            && reader.ReadU64(uuid.sequence)
+            && reader.ReadU64(uuid.srcEid.nodeId)
+            && reader.ReadU64(uuid.srcEid.serviceId)))
+        {
+            return false;
+        }
+    }
+    uint64_t numSegments;
+    if (!reader.ReadU64(numSegments)) {
+        return false;
+    }
+    const uint64_t expectedNumSegments = (catalogEntry.bundleSizeBytes / BUNDLE_STORAGE_PER_SEGMENT_SIZE) + ((catalogEntry.bundleSizeBytes % BUNDLE_STORAGE_PER_SEGMENT_SIZE) == 0 ? 0 : 1);
+    if ((numSegments == 0) || (numSegments != expectedNumSegments) || (numSegments > (reader.BytesRemaining() / sizeof(uint64_t)))) {
+        return false;
+    }
+    catalogEntry.segmentIdChainVec.resize(numSegments);
+    for (uint64_t i = 0; i < numSegments; ++i) {
+        uint64_t segmentId;
+        if ((!reader.ReadU64(segmentId)) || (segmentId >= maxSegments)) {
+            return false;
+        }
+        catalogEntry.segmentIdChainVec[i] = static_cast<segment_id_t>(segmentId);
+    }
+    catalogEntry.ptrUuidKeyInMap = NULL;
+    return true;
+}
+
+StorageCatalogJournal::StorageCatalogJournal(const boost::filesystem::path & journalFilePath, const uint64_t maxSegments, const unsigned int numStorageDisks) :
+    M_JOURNAL_FILE_PATH(journalFilePath),
+    M_SNAPSHOT_FILE_PATH(boost::filesystem::path(journalFilePath).concat(".snapshot")),
+    M_MAX_SEGMENTS(maxSegments),
+    M_NUM_STORAGE_DISKS(numStorageDisks),
+    m_journalFileHandle(NULL),
+    m_generation(0),
+    m_numRecordsSinceSnapshot(0)
+{
+    //new generations must be greater than that of any existing file (even one that fails to load) so that
+    //a stale journal can never be mistaken for the one following a new snapshot
+    uint64_t generation;
+    if (ReadGeneration(M_SNAPSHOT_FILE_PATH, SNAPSHOT_MAGIC, generation)) {
+        m_generation = generation;
+    }
+    if (ReadGeneration(M_JOURNAL_FILE_PATH, JOURNAL_MAGIC, generation)) {
+        m_generation = std::max(m_generation, generation);
+    }
+}
+
+StorageCatalogJournal::~StorageCatalogJournal() {
+    CloseJournal();
+}
+
+uint64_t StorageCatalogJournal::GetNumRecordsSinceSnapshot() const noexcept {
+    return m_numRecordsSinceSnapshot;
+}
+uint64_t StorageCatalogJournal::GetGeneration() const noexcept {
+    return m_generation;
+}
+bool StorageCatalogJournal::IsOpen() const noexcept {
+    return (m_journalFileHandle != NULL);
+}
+const boost::filesystem::path & StorageCatalogJournal::GetJournalFilePath() const noexcept {
+    return M_JOURNAL_FILE_PATH;
+}
+const boost::filesystem::path & StorageCatalogJournal::GetSnapshotFilePath() const noexcept {
+    return M_SNAPSHOT_FILE_PATH;
+}
+
+void StorageCatalogJournal::CloseJournal() {
+    if (m_journalFileHandle) {
+        fclose(m_journalFileHandle);
+        m_journalFileHandle = NULL;
+    }
+}
+
+void StorageCatalogJournal::DeleteFiles() {
+    CloseJournal();
+    const boost::filesystem::path * const paths[2] = { &M_JOURNAL_FILE_PATH, &M_SNAPSHOT_FILE_PATH };
+    for (unsigned int i = 0; i < 2; ++i) {
+        boost::system::error_code ec;
+        if (boost::filesystem::remove(*paths[i], ec)) {
+            LOG_DEBUG(subprocess) << "deleted " << *paths[i];
+        }
+        else if (ec) {
+            LOG_ERROR(subprocess) << "unable to delete " << *paths[i] << ": " << ec.message();
+        }
+    }
+}
+
+void StorageCatalogJournal::Invalidate() {
+    CloseJournal();
+    //without a complete journal the snapshot no longer describes the disks, so the next restore must scan them
+    boost::system::error_code ec;
+    boost::filesystem::remove(M_SNAPSHOT_FILE_PATH, ec);
+    LOG_ERROR(subprocess) << "catalog journal " << M_JOURNAL_FILE_PATH << " disabled, the next restore will scan the disks";
+}
+
+bool StorageCatalogJournal::ReadFile(const boost::filesystem::path & filePath, std::vector<uint8_t> & fileContents) {
+    boost::system::error_code ec;
+    const uintmax_t fileSize = boost::filesystem::file_size(filePath, ec);
+    if (ec) {
+        return false;
+    }
+    FILE * fileHandle = fopen(filePath.string().c_str(), "rb");
+    if (fileHandle == NULL) {
+        return false;
+    }
+    fileContents.resize(static_cast<std::size_t>(fileSize));
+    const std::size_t bytesRead = (fileSize == 0) ? 0 : fread(fileContents.data(), 1, fileContents.size(), fileHandle);
+    fclose(fileHandle);
+    return (bytesRead == fileContents.size());
+}
+
+bool StorageCatalogJournal::ReadGeneration(const boost::filesystem::path & filePath, const char * expectedMagic, uint64_t & generation) {
+    FILE * fileHandle = fopen(filePath.string().c_str(), "rb");
+    if (fileHandle == NULL) {
+        return false;
+    }
+    uint8_t header[sizeof(SNAPSHOT_MAGIC) + sizeof(uint64_t)];
+    const bool success = (fread(header, 1, sizeof(header), fileHandle) == sizeof(header)) && (memcmp(header, expectedMagic, sizeof(SNAPSHOT_MAGIC)) == 0);
+    fclose(fileHandle);
+    if (success) {
+        CatalogJournalBufferReader reader(&header[sizeof(SNAPSHOT_MAGIC)], sizeof(uint64_t));
+        reader.ReadU64(generation);
+    }
+    return success;
+}
+
+bool StorageCatalogJournal::Load(MemoryManagerTreeArray & memoryManager, std::vector<catalog_journal_restored_bundle_t> & restoredBundlesVec) {
+    restoredBundlesVec.resize(0);
+
+    //the snapshot
+    std::vector<uint8_t> snapshotContents;
+    if (!ReadFile(M_SNAPSHOT_FILE_PATH, snapshotContents)) {
+        LOG_INFO(subprocess) << "no catalog snapshot found at " << M_SNAPSHOT_FILE_PATH;
+        return false;
+    }
+    if ((snapshotContents.size() < (sizeof(SNAPSHOT_MAGIC) + sizeof(uint32_t))) || (memcmp(snapshotContents.data(), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0)) {
+        LOG_ERROR(subprocess) << M_SNAPSHOT_FILE_PATH << " is not a catalog snapshot";
+        return false;
+    }
+    {
+        const std::size_t crcOffset = snapshotContents.size() - sizeof(uint32_t);
+        uint32_t expectedCrc;
+        memcpy(&expectedCrc, &snapshotContents[crcOffset], sizeof(expectedCrc));
+        boost::endian::little_to_native_inplace(expectedCrc);
+        if (Crc32(&snapshotContents[sizeof(SNAPSHOT_MAGIC)], crcOffset - sizeof(SNAPSHOT_MAGIC)) != expectedCrc) {
+            LOG_ERROR(subprocess) << "catalog snapshot " << M_SNAPSHOT_FILE_PATH << " failed its crc check";
+            return false;
+        }
+    }
+    CatalogJournalBufferReader snapshotReader(&snapshotContents[sizeof(SNAPSHOT_MAGIC)], snapshotContents.size() - sizeof(SNAPSHOT_MAGIC) - sizeof(uint32_t));
+    uint64_t snapshotGeneration, snapshotMaxSegments, snapshotNumStorageDisks, numBitmapRows;
+    if (!(snapshotReader.ReadU64(snapshotGeneration)
+        && snapshotReader.ReadU64(snapshotMaxSegments)
+        && snapshotReader.ReadU64(snapshotNumStorageDisks)
+        && snapshotReader.ReadU64(numBitmapRows)))
+    {
+        LOG_ERROR(subprocess) << "catalog snapshot " << M_SNAPSHOT_FILE_PATH << " is truncated";
+        return false;
+    }
+    if ((snapshotMaxSegments != M_MAX_SEGMENTS) || (snapshotNumStorageDisks != M_NUM_STORAGE_DISKS)) {
+        LOG_ERROR(subprocess) << "catalog snapshot " << M_SNAPSHOT_FILE_PATH << " was taken of " << snapshotNumStorageDisks << " disk(s) with "
+            << snapshotMaxSegments << " segments but storage is configured for " << M_NUM_STORAGE_DISKS << " disk(s) with " << M_MAX_SEGMENTS << " segments";
+        return false;
+    }
+    memmanager_t memoryManagerBackup;
+    if (numBitmapRows > MAX_TREE_ARRAY_DEPTH) {
+        LOG_ERROR(subprocess) << "catalog snapshot " << M_SNAPSHOT_FILE_PATH << " has an invalid segment bitmap";
+        return false;
+    }
+    memoryManagerBackup.resize(numBitmapRows);
+    for (uint64_t rowIndex = 0; rowIndex < numBitmapRows; ++rowIndex) {
+        uint64_t rowSize;
+        if ((!snapshotReader.ReadU64(rowSize)) || (rowSize > (snapshotReader.BytesRemaining() / sizeof(uint64_t)))) {
+            LOG_ERROR(subprocess) << "catalog snapshot " << M_SNAPSHOT_FILE_PATH << " is truncated";
+            return false;
+        }
+        std::vector<uint64_t> & row = memoryManagerBackup[rowIndex];
+        row.resize(rowSize);
+        for (uint64_t i = 0; i < rowSize; ++i) {
+            snapshotReader.ReadU64(row[i]);
+        }
+    }
+    if (!memoryManager.RestoreDataFromVector(memoryManagerBackup)) {
+        LOG_ERROR(subprocess) << "catalog snapshot " << M_SNAPSHOT_FILE_PATH << " has a segment bitmap that does not match the storage capacity";
+        return false;
+    }
+
+    //bundles in the order they will be cataloged, where bundles stored after the snapshot go last
+    std::map<uint64_t, catalog_journal_restored_bundle_t> orderToRestoredBundleMap;
+    std::unordered_map<uint64_t, uint64_t> custodyIdToOrderMap;
+    uint64_t nextOrder = 0;
+
+    uint64_t numSnapshotEntries;
+    if (!snapshotReader.ReadU64(numSnapshotEntries)) {
+        LOG_ERROR(subprocess) << "catalog snapshot " << M_SNAPSHOT_FILE_PATH << " is truncated";
+        return false;
+    }
+    uint64_t numSnapshotSegments = 0;
+    for (uint64_t entryIndex = 0; entryIndex < numSnapshotEntries; ++entryIndex) {
+        catalog_journal_restored_bundle_t restoredBundle;
+        if (!ReadCatalogEntry(snapshotReader, restoredBundle, M_MAX_SEGMENTS)) {
+            LOG_ERROR(subprocess) << "catalog snapshot " << M_SNAPSHOT_FILE_PATH << " has an invalid entry at index " << entryIndex;
+            return false;
+        }
+        const segment_id_chain_vec_t & segmentIdChainVec = restoredBundle.catalogEntry.segmentIdChainVec;
+        for (std::size_t i = 0; i < segmentIdChainVec.size(); ++i) {
+            if (memoryManager.IsSegmentFree(segmentIdChainVec[i])) {
+                LOG_ERROR(subprocess) << "catalog snapshot " << M_SNAPSHOT_FILE_PATH << " has an entry using segment " << segmentIdChainVec[i] << " which is free in its bitmap";
+                return false;
+            }
+        }
+        numSnapshotSegments += segmentIdChainVec.size();
+        if (!custodyIdToOrderMap.emplace(restoredBundle.custodyId, nextOrder).second) {
+            LOG_ERROR(subprocess) << "catalog snapshot " << M_SNAPSHOT_FILE_PATH << " has a duplicate custody id " << restoredBundle.custodyId;
+            return false;
+        }
+        orderToRestoredBundleMap.emplace(nextOrder++, std::move(restoredBundle));
+    }
+    if ((!snapshotReader.AtEnd()) || (numSnapshotSegments != memoryManager.GetNumAllocatedSegments_NotThreadSafe())) {
+        LOG_ERROR(subprocess) << "catalog snapshot " << M_SNAPSHOT_FILE_PATH << " entries do not match its segment bitmap";
+        return false;
+    }
+
+    //the journal records that follow the snapshot
+    uint64_t numJournalRecordsReplayed = 0;
+    std::vector<uint8_t> journalContents;
+    if ((!ReadFile(M_JOURNAL_FILE_PATH, journalContents)) || (journalContents.size() < (sizeof(JOURNAL_MAGIC) + sizeof(uint64_t)))
+        || (memcmp(journalContents.data(), JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0))
+    {
+        //the journal is created (with a valid header) after its snapshot and before any record can be logged
+        LOG_WARNING(subprocess) << "no valid catalog journal found at " << M_JOURNAL_FILE_PATH << ", restoring from the catalog snapshot only";
+    }
+    else {
+        CatalogJournalBufferReader journalReader(&journalContents[sizeof(JOURNAL_MAGIC)], journalContents.size() - sizeof(JOURNAL_MAGIC));
+        uint64_t journalGeneration = 0;
+        if (!journalReader.ReadU64(journalGeneration)) {
+            LOG_WARNING(subprocess) << "no valid catalog journal found at " << M_JOURNAL_FILE_PATH << ", restoring from the catalog snapshot only";
+        }
+        else if (journalGeneration < snapshotGeneration) {
+            //a crash occurred after the snapshot replaced the old one but before the new journal was started
+            LOG_INFO(subprocess) << "ignoring catalog journal generation " << journalGeneration << " which precedes catalog snapshot generation " << snapshotGeneration;
+        }
+        else if (journalGeneration > snapshotGeneration) {
+            LOG_ERROR(subprocess) << "catalog journal generation " << journalGeneration << " follows a missing catalog snapshot (have generation " << snapshotGeneration << ")";
+            return false;
+        }
+        else {
+            while (!journalReader.AtEnd()) {
+                //a crash while appending may leave a partial record at the end
+                uint32_t recordLength;
+                if (journalReader.BytesRemaining() < sizeof(recordLength)) {
+                    break;
+                }
+                memcpy(&recordLength, journalReader.m_ptr, sizeof(recordLength));
+                boost::endian::little_to_native_inplace(recordLength);
+                if ((recordLength == 0) || ((journalReader.BytesRemaining() - sizeof(recordLength)) < (static_cast<std::size_t>(recordLength) + sizeof(uint32_t)))) {
+                    break;
+                }
+                const uint8_t * const recordPtr = journalReader.m_ptr + sizeof(recordLength);
+                uint32_t expectedCrc;
+                memcpy(&expectedCrc, recordPtr + recordLength, sizeof(expectedCrc));
+                boost::endian::little_to_native_inplace(expectedCrc);
+                if (Crc32(recordPtr, recordLength) != expectedCrc) {
+                    break;
+                }
+                journalReader.m_ptr += sizeof(recordLength) + recordLength + sizeof(expectedCrc);
+
+                const uint8_t recordType = recordPtr[0];
+                CatalogJournalBufferReader recordReader(recordPtr + 1, recordLength - 1);
+                if (recordType == RECORD_TYPE_STORE) {
+                    catalog_journal_restored_bundle_t restoredBundle;
+                    if ((!ReadCatalogEntry(recordReader, restoredBundle, M_MAX_SEGMENTS)) || (!recordReader.AtEnd())) {
+                        LOG_ERROR(subprocess) << "catalog journal record " << numJournalRecordsReplayed << " is an invalid store record";
+                        return false;
+                    }
+                    const segment_id_chain_vec_t & segmentIdChainVec = restoredBundle.catalogEntry.segmentIdChainVec;
+                    for (std::size_t i = 0; i < segmentIdChainVec.size(); ++i) {
+                        if (!memoryManager.AllocateSegmentId_NotThreadSafe(segmentIdChainVec[i])) {
+                            LOG_ERROR(subprocess) << "catalog journal record " << numJournalRecordsReplayed << " stores to segment " << segmentIdChainVec[i] << " which is already in use";
+                            return false;
+                        }
+                    }
+                    if (!custodyIdToOrderMap.emplace(restoredBundle.custodyId, nextOrder).second) {
+                        LOG_ERROR(subprocess) << "catalog journal record " << numJournalRecordsReplayed << " stores duplicate custody id " << restoredBundle.custodyId;
+                        return false;
+                    }
+                    orderToRestoredBundleMap.emplace(nextOrder++, std::move(restoredBundle));
+                }
+                else if (recordType == RECORD_TYPE_REMOVE) {
+                    uint64_t custodyId;
+                    if ((!recordReader.ReadU64(custodyId)) || (!recordReader.AtEnd())) {
+                        LOG_ERROR(subprocess) << "catalog journal record " << numJournalRecordsReplayed << " is an invalid remove record";
+                        return false;
+                    }
+                    std::unordered_map<uint64_t, uint64_t>::iterator it = custodyIdToOrderMap.find(custodyId);
+                    if (it == custodyIdToOrderMap.end()) {
+                        LOG_ERROR(subprocess) << "catalog journal record " << numJournalRecordsReplayed << " removes unknown custody id " << custodyId;
+                        return false;
+                    }
+                    std::map<uint64_t, catalog_journal_restored_bundle_t>::iterator bundleIt = orderToRestoredBundleMap.find(it->second);
+                    const segment_id_chain_vec_t & segmentIdChainVec = bundleIt->second.catalogEntry.segmentIdChainVec;
+                    for (std::size_t i = 0; i < segmentIdChainVec.size(); ++i) {
+                        if (!memoryManager.FreeSegmentId_NotThreadSafe(segmentIdChainVec[i])) {
+                            LOG_ERROR(subprocess) << "catalog journal record " << numJournalRecordsReplayed << " frees segment " << segmentIdChainVec[i] << " which is not in use";
+                            return false;
+                        }
+                    }
+                    orderToRestoredBundleMap.erase(bundleIt);
+                    custodyIdToOrderMap.erase(it);
+                }
+                else {
+                    LOG_ERROR(subprocess) << "catalog journal record " << numJournalRecordsReplayed << " has unknown type " << static_cast<unsigned int>(recordType);
+                    return false;
+                }
+                ++numJournalRecordsReplayed;
+            }
+            if (!journalReader.AtEnd()) {
+                LOG_WARNING(subprocess) << "ignoring " << journalReader.BytesRemaining() << " bytes of a partially written record at the end of catalog journal " << M_JOURNAL_FILE_PATH;
+            }
+        }
+    }
+
+    restoredBundlesVec.reserve(orderToRestoredBundleMap.size());
+    for (std::map<uint64_t, catalog_journal_restored_bundle_t>::iterator it = orderToRestoredBundleMap.begin(); it != orderToRestoredBundleMap.end(); ++it) {
+        restoredBundlesVec.push_back(std::move(it->second));
+    }
+    LOG_INFO(subprocess) << "loaded catalog snapshot generation " << snapshotGeneration << " (" << numSnapshotEntries << " bundles) and replayed "
+        << numJournalRecordsReplayed << " catalog journal records for a catalog of " << restoredBundlesVec.size() << " bundles";
+    return true;
+}
+
+bool StorageCatalogJournal::WriteSnapshot(const memmanager_t & memoryManagerBackup, const std::vector<std::pair<uint64_t, const catalog_entry_t*> > & custodyIdsPlusEntries) {
+    CloseJournal();
+    const uint64_t newGeneration = m_generation + 1;
+
+    std::vector<uint8_t> snapshotContents;
+    {
+        std::size_t bitmapSize64s = 0;
+        for (std::size_t rowIndex = 0; rowIndex < memoryManagerBackup.size(); ++rowIndex) {
+            bitmapSize64s += memoryManagerBackup[rowIndex].size() + 1;
+        }
+        snapshotContents.reserve(sizeof(SNAPSHOT_MAGIC) + ((5 + bitmapSize64s + (custodyIdsPlusEntries.size() * 9)) * sizeof(uint64_t)) + sizeof(uint32_t));
+    }
+    snapshotContents.insert(snapshotContents.end(), SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + sizeof(SNAPSHOT_MAGIC));
+    AppendU64(snapshotContents, newGeneration);
+    AppendU64(snapshotContents, M_MAX_SEGMENTS);
+    AppendU64(snapshotContents, M_NUM_STORAGE_DISKS);
+    AppendU64(snapshotContents, memoryManagerBackup.size());
+    for (std::size_t rowIndex = 0; rowIndex < memoryManagerBackup.size(); ++rowIndex) {
+        const std::vector<uint64_t> & row = memoryManagerBackup[rowIndex];
+        AppendU64(snapshotContents, row.size());
+        for (std::size_t i = 0; i < row.size(); ++i) {
+            AppendU64(snapshotContents, row[i]);
+        }
+    }
+    AppendU64(snapshotContents, custodyIdsPlusEntries.size());
+    for (std::size_t i = 0; i < custodyIdsPlusEntries.size(); ++i) {
+        if (!AppendCatalogEntry(snapshotContents, custodyIdsPlusEntries[i].first, *custodyIdsPlusEntries[i].second)) {
+            LOG_ERROR(subprocess) << "cannot snapshot catalog entry with custody id " << custodyIdsPlusEntries[i].first << ": custody bundle has no uuid";
+            Invalidate();
+            return false;
+        }
+    }
+    AppendU32(snapshotContents, Crc32(&snapshotContents[sizeof(SNAPSHOT_MAGIC)], snapshotContents.size() - sizeof(SNAPSHOT_MAGIC)));
+
+    //write a temporary file then rename it over the old snapshot so that a crash leaves one complete snapshot or the other
+    const boost::filesystem::path tmpSnapshotFilePath = boost::filesystem::path(M_SNAPSHOT_FILE_PATH).concat(".tmp");
+    {
+        FILE * fileHandle = fopen(tmpSnapshotFilePath.string().c_str(), "wb");
+        if (fileHandle == NULL) {
+            LOG_ERROR(subprocess) << "unable to create " << tmpSnapshotFilePath;
+            Invalidate();
+            return false;
+        }
+        const bool success = (fwrite(snapshotContents.data(), 1, snapshotContents.size(), fileHandle) == snapshotContents.size()) && (fflush(fileHandle) == 0);
+        fclose(fileHandle);
+        if (!success) {
+            LOG_ERROR(subprocess) << "unable to write " << tmpSnapshotFilePath;
+            Invalidate();
+            return false;
+        }
+    }
+    boost::system::error_code ec;
+    boost::filesystem::rename(tmpSnapshotFilePath, M_SNAPSHOT_FILE_PATH, ec);
+    if (ec) {
+        LOG_ERROR(subprocess) << "unable to rename " << tmpSnapshotFilePath << " to " << M_SNAPSHOT_FILE_PATH << ": " << ec.message();
+        Invalidate();
+        return false;
+    }
+    m_generation = newGeneration;
+
+    //start the journal that follows this snapshot
+    m_journalFileHandle = fopen(M_JOURNAL_FILE_PATH.string().c_str(), "wb");
+    if (m_journalFileHandle == NULL) {
+        LOG_ERROR(subprocess) << "unable to create " << M_JOURNAL_FILE_PATH;
+        Invalidate();
+        return false;
+    }
+    m_recordBuffer.resize(0);
+    m_recordBuffer.insert(m_recordBuffer.end(), JOURNAL_MAGIC, JOURNAL_MAGIC + sizeof(JOURNAL_MAGIC));
+    AppendU64(m_recordBuffer, newGeneration);
+    if ((fwrite(m_recordBuffer.data(), 1, m_recordBuffer.size(), m_journalFileHandle) != m_recordBuffer.size()) || (fflush(m_journalFileHandle) != 0)) {
+        LOG_ERROR(subprocess) << "unable to write " << M_JOURNAL_FILE_PATH;
+        Invalidate();
+        return false;
+    }
+    m_numRecordsSinceSnapshot = 0;
+    LOG_DEBUG(subprocess) << "wrote catalog snapshot generation " << newGeneration << " (" << custodyIdsPlusEntries.size() << " bundles, " << snapshotContents.size() << " bytes)";
+    return true;
+}
+
+bool StorageCatalogJournal::LogStore(const uint64_t custodyId, const catalog_entry_t & catalogEntry) {
+    if (m_journalFileHandle == NULL) {
+        return false;
+    }
+    m_recordBuffer.resize(sizeof(uint32_t)); //record length filled in by AppendRecord
+    m_recordBuffer.push_back(RECORD_TYPE_STORE);
+    if (!AppendCatalogEntry(m_recordBuffer, custodyId, catalogEntry)) {
+        LOG_ERROR(subprocess) << "cannot journal catalog entry with custody id " << custodyId << ": custody bundle has no uuid";
+        Invalidate();
+        return false;
+    }
+    return AppendRecord();
+}
+
+bool StorageCatalogJournal::LogRemove(const uint64_t custodyId) {
+    if (m_journalFileHandle == NULL) {
+        return false;
+    }
+    m_recordBuffer.resize(sizeof(uint32_t)); //record length filled in by AppendRecord
+    m_recordBuffer.push_back(RECORD_TYPE_REMOVE);
+    AppendU64(m_recordBuffer, custodyId);
+    return AppendRecord();
+}
+
+bool StorageCatalogJournal::AppendRecord() {
+    const uint32_t recordLength = static_cast<uint32_t>(m_recordBuffer.size() - sizeof(uint32_t));
+    const uint32_t recordLengthLittleEndian = boost::endian::native_to_little(recordLength);
+    memcpy(m_recordBuffer.data(), &recordLengthLittleEndian, sizeof(recordLengthLittleEndian));
+    AppendU32(m_recordBuffer, Crc32(&m_recordBuffer[sizeof(uint32_t)], recordLength));
+    //flush every record so that a crash of this process loses at most the record being written
+    if ((fwrite(m_recordBuffer.data(), 1, m_recordBuffer.size(), m_journalFileHandle) != m_recordBuffer.size()) || (fflush(m_journalFileHandle) != 0)) {
+        LOG_ERROR(subprocess) << "unable to append to catalog journal " << M_JOURNAL_FILE_PATH;
+        Invalidate();
+        return false;
+    }
+    ++m_numRecordsSinceSnapshot;
+    return true;
+}
@@ -14,8 +14,11 @@
 
 #include "ZmqStorageInterface.h"
 #include "message.hpp"
+#include "ZmqBatchMessage.h"
+#include "SharedMemoryBundleTransport.h"
 #include "BundleStorageManagerMT.h"
 #include "BundleStorageManagerAsio.h"
+#include "BundleStorageManagerIoUring.h"
 #include "Logger.h"
 #include <map>
 #include <string>
@@ -34,7 +37,7 @@
 #include "codec/CustodyIdAllocator.h"
 #include "codec/CustodyTransferManager.h"
 #include "Uri.h"
-#include "CustodyTimers.h"
+#include "CustodyTimersTimingWheel.h"
 #include "codec/BundleViewV7.h"
 #include "ThreadNamer.h"
 #include "TelemetryServer.h"
@@ -81,7 +84,8 @@ struct ZmqStorageInterface::Impl : private boost::noncopyable {
             nextHopNodeId(0),
             linkIsUp(false),
             stateTryCutThrough(false),
-            bytesInPipeline(0)
+            bytesInPipeline(0),
+            awaitingSendGroupId(UINT64_MAX)
         {}
 
         uint64_t halfOfMaxBundlesInPipeline_StorageToEgressPath;
@@ -95,6 +99,7 @@ struct ZmqStorageInterface::Impl : private boost::noncopyable {
         map_id_to_ackdata_t mapIngressUniqueIdToIngressAckData;
         cut_through_queue_t cutThroughQueue;
         uint64_t bytesInPipeline;
+        uint64_t awaitingSendGroupId; //storage catalog index of the bundles awaiting send to eidVec (UINT64_MAX if not yet added)
         friend std::ostream& operator<<(std::ostream& os, const OutductInfo_t& o);
 
         bool IsOpportunisticLink() const noexcept {
@@ -122,8 +127,9 @@ private:
     bool WriteBundle(BundleViewV7 &bv, const uint64_t newCustodyId, cbhe_eid_t *bundleEidMaskPtr = NULL);
     bool WriteBundle(const PrimaryBlock& bundlePrimaryBlock,
         const uint64_t newCustodyId, const uint8_t* allData, const std::size_t allDataSize, uint64_t payloadSizeBytes, cbhe_eid_t *bundleEidMaskPtr = NULL);
-    uint64_t PeekOne(const std::vector<eid_plus_isanyserviceid_pair_t>& availableDestLinks);
-    uint64_t PeekOne(const std::vector<eid_plus_isanyserviceid_pair_t> & availableDestLinks, int &priority);
+    uint64_t PeekOne(const OutductInfo_t& info);
+    uint64_t PeekOne(const OutductInfo_t& info, int &priority);
+    void SetAwaitingSendGroup(OutductInfo_t& info);
     bool ReleaseOne_NoBlock(const OutductInfo_t& info, const uint64_t maxBundleSizeToRead, uint64_t& returnedBundleSize);
     void RepopulateUpLinksVec();
     void SetLinkDown(OutductInfo_t & info);
@@ -140,6 +146,12 @@ private:
     void DefaultSend(OutductInfo_t &info, uint64_t maxBundleSizeToRead, long &timeoutPoll);
     void PrioritySend(OutductInfo_t &info, uint64_t maxBundleSizeToRead, long &timeoutPoll);
     int GetQueueBundlePriority(CutThroughQueueData& qd);
+    bool ResolveBundleFromIngress(zmq::message_t& zmqBundleDataReceived);
+    uint8_t GetStorageUsedPercent() const;
+    bool SendBundlePartToEgress(zmq::message_t& zmqBundle);
+    void ProcessBundleFromIngress(hdtn::ToStorageHdr& toStorageHeader, zmq::message_t& zmqBundleDataReceived,
+        std::vector<hdtn::IngressUniqueIdAckRange>* batchedAcksToIngressPtr);
+    void SendBatchedAcksToIngress(std::vector<hdtn::IngressUniqueIdAckRange>& batchedAcksToIngress);
 
 public:
     StorageTelemetry_t m_telem;
@@ -157,6 +169,9 @@ private:
 
     std::unique_ptr<zmq::socket_t> m_zmqPushSock_connectingStorageToBoundRouterPtr;
     std::unique_ptr<zmq::socket_t> m_zmqRepSock_connectingTelemToFromBoundStoragePtr;
+    //distributed mode with sharedMemoryBundleTransport only (NULL otherwise)
+    std::unique_ptr<SharedMemoryBundleWriter> m_sharedMemoryBundleWriterPtr; //bundles to egress
+    std::unique_ptr<SharedMemoryBundleReader> m_sharedMemoryBundleReaderPtr; //bundles from ingress
 
     HdtnConfig m_hdtnConfig;
 
@@ -169,12 +184,15 @@ private:
     std::unique_ptr<BundleStorageManagerBase> m_bsmPtr;
     std::unique_ptr<CustodyIdAllocator> m_custodyIdAllocatorPtr;
     std::unique_ptr<CustodyTransferManager> m_ctmPtr;
-    std::unique_ptr<CustodyTimers> m_custodyTimersPtr;
+    std::unique_ptr<CustodyTimersTimingWheel> m_custodyTimersPtr;
     BundleViewV6 m_custodySignalRfc5050RenderedBundleView;
     BundleStorageManagerSession_ReadFromDisk m_sessionRead; //reuse this due to expensive heap allocation
     std::vector<OutductInfoPtr_t> m_vectorOutductInfo; //outductIndex to info
     std::map<uint64_t, OutductInfoPtr_t> m_mapOpportunisticNextHopNodeIdToOutductInfo;
     std::vector<OutductInfo_t*> m_vectorUpLinksOutductInfoPtrs; //outductIndex to info
+    std::vector<hdtn::ToStorageHdr> m_batchToStorageHeaders; //reused by each HDTN_MSGTYPE_STORE_BATCH
+    std::vector<zmq::message_t> m_batchBundles; //reused by each HDTN_MSGTYPE_STORE_BATCH
+    std::vector<hdtn::IngressUniqueIdAckRange> m_batchedAcksToIngress; //reused by each HDTN_MSGTYPE_STORE_BATCH
 
     //for blocking until worker-thread startup
     std::atomic<bool> m_workerThreadStartupInProgress;
@@ -348,6 +366,16 @@ bool ZmqStorageInterface::Impl::Init(const HdtnConfig & hdtnConfig, const HdtnDi
             LOG_ERROR(subprocess) << "error: cannot connect socket: " << ex.what();
             return false;
         }
+        if (hdtnDistributedConfig.m_sharedMemoryBundleTransport) {
+            m_sharedMemoryBundleReaderPtr = boost::make_unique<SharedMemoryBundleReader>();
+            m_sharedMemoryBundleWriterPtr = boost::make_unique<SharedMemoryBundleWriter>(
+                std::string("hdtn_storage_") + boost::lexical_cast<std::string>(hdtnDistributedConfig.m_zmqConnectingStorageToBoundEgressPortPath),
+                hdtnDistributedConfig.m_sharedMemoryNumSlots, hdtnDistributedConfig.m_sharedMemorySlotSizeBytes);
+            if (!m_sharedMemoryBundleWriterPtr->IsValid()) {
+                LOG_WARNING(subprocess) << "cannot create the shared memory for bundles to egress, sending them through zmq instead";
+                m_sharedMemoryBundleWriterPtr.reset();
+            }
+        }
     }
 
     m_zmqSubSock_boundReleaseToConnectingStoragePtr = boost::make_unique<zmq::socket_t>(*m_zmqContextPtr, zmq::socket_type::sub);
@@ -887,8 +915,8 @@ bool ZmqStorageInterface::Impl::WriteBundle(const PrimaryBlock& bundlePrimaryBlo
     return true;
 }
 
-uint64_t ZmqStorageInterface::Impl::PeekOne(const std::vector<eid_plus_isanyserviceid_pair_t> & availableDestLinks, int &priority) {
-    const uint64_t bytesToReadFromDisk = m_bsmPtr->PopTop(m_sessionRead, availableDestLinks);
+uint64_t ZmqStorageInterface::Impl::PeekOne(const OutductInfo_t& info, int &priority) {
+    const uint64_t bytesToReadFromDisk = m_bsmPtr->PopTopFromAwaitingSendGroup(m_sessionRead, info.awaitingSendGroupId);
     if (bytesToReadFromDisk == 0) { //no more of these links to read
         return 0; //no bytes to read
     }
@@ -901,9 +929,19 @@ uint64_t ZmqStorageInterface::Impl::PeekOne(const std::vector<eid_plus_isanyserv
 }
 
 //return number of bytes to read for specified links
-uint64_t ZmqStorageInterface::Impl::PeekOne(const std::vector<eid_plus_isanyserviceid_pair_t> & availableDestLinks) {
+uint64_t ZmqStorageInterface::Impl::PeekOne(const OutductInfo_t& info) {
     int priority = 0;
-    return PeekOne(availableDestLinks, priority);
+    return PeekOne(info, priority);
+}
+
+//index the bundles awaiting send to info.eidVec so they can be popped without scanning every destination
+void ZmqStorageInterface::Impl::SetAwaitingSendGroup(OutductInfo_t& info) {
+    if (info.awaitingSendGroupId == UINT64_MAX) {
+        info.awaitingSendGroupId = m_bsmPtr->AddAwaitingSendGroup(info.eidVec);
+    }
+    else if (!m_bsmPtr->UpdateAwaitingSendGroup(info.awaitingSendGroupId, info.eidVec)) {
+        LOG_ERROR(subprocess) << "unable to update the awaiting send group of " << info;
+    }
 }
 
 static void CustomCleanupToEgressHdr(void *data, void *hint) {
@@ -921,7 +959,7 @@ static void CustomCleanupPaddedVecUint8(void* data, void* hint) {
 
 bool ZmqStorageInterface::Impl::ReleaseOne_NoBlock(const OutductInfo_t& info, const uint64_t maxBundleSizeToRead, uint64_t& returnedBundleSize)
 {
-    const uint64_t bytesToReadFromDisk = m_bsmPtr->PopTop(m_sessionRead, info.eidVec);
+    const uint64_t bytesToReadFromDisk = m_bsmPtr->PopTopFromAwaitingSendGroup(m_sessionRead, info.awaitingSendGroupId);
     if (bytesToReadFromDisk == 0) { //no more of these links to read
         return false;
     }
@@ -966,7 +1004,7 @@ bool ZmqStorageInterface::Impl::ReleaseOne_NoBlock(const OutductInfo_t& info, co
         m_bsmPtr->ReturnTop(m_sessionRead);
         return false;
     }
-    if (!m_zmqPushSock_connectingStorageToBoundEgressPtr->send(std::move(zmqBundleDataMessageWithDataStolen), zmq::send_flags::dontwait)) {
+    if (!SendBundlePartToEgress(zmqBundleDataMessageWithDataStolen)) {
         LOG_ERROR(subprocess) << "zmq could not send bundle";
         m_bsmPtr->ReturnTop(m_sessionRead);
         return false;
@@ -1058,6 +1096,15 @@ void ZmqStorageInterface::Impl::SyncTelemetry() {
 
         m_telem.m_usedSpaceBytes = m_bsmPtr->GetUsedSpaceBytes();
         m_telem.m_freeSpaceBytes = m_bsmPtr->GetFreeSpaceBytes();
+        m_bsmPtr->GetDiskRestoreTelemetry(m_telem.m_diskRestoreTelemetryVec);
+
+        const BundleStorageRamCache& ramCache = m_bsmPtr->GetRamCacheConstRef();
+        m_telem.m_numBundlesInRamCache = ramCache.GetNumBundles();
+        m_telem.m_numBundleBytesInRamCache = ramCache.GetNumBytes();
+        m_telem.m_totalRamCacheHits = ramCache.GetTotalHits();
+        m_telem.m_totalRamCacheMisses = ramCache.GetTotalMisses();
+        m_telem.m_totalBundlesFlushedFromRamCacheToDisk = ramCache.GetTotalBundlesFlushedToDisk();
+        m_telem.m_totalBundlesErasedFromRamCacheBeforeFlush = ramCache.GetTotalBundlesErasedBeforeFlush();
     }
 }
 
@@ -1181,6 +1228,107 @@ void ZmqStorageInterface::Impl::DeleteExpiredBundles(const boost::posix_time::pt
     }
 }
 
+uint8_t ZmqStorageInterface::Impl::GetStorageUsedPercent() const {
+    const uint64_t totalCapacityBytes = m_bsmPtr->GetTotalCapacityBytes();
+    return (totalCapacityBytes) ? static_cast<uint8_t>((m_bsmPtr->GetUsedSpaceBytes() * 100) / totalCapacityBytes) : 0;
+}
+
+//replaces a bundle that ingress sent through shared memory with the bundle itself
+bool ZmqStorageInterface::Impl::ResolveBundleFromIngress(zmq::message_t& zmqBundleDataReceived) {
+    if (m_sharedMemoryBundleReaderPtr && (!m_sharedMemoryBundleReaderPtr->Resolve(zmqBundleDataReceived))) {
+        LOG_ERROR(subprocess) << "cannot open the shared memory of a bundle from ingress (ingress and storage must run on the same host), this bundle will be lost";
+        return false;
+    }
+    return true;
+}
+
+//sends the last part (the bundle) of a message to egress
+bool ZmqStorageInterface::Impl::SendBundlePartToEgress(zmq::message_t& zmqBundle) {
+    if (m_sharedMemoryBundleWriterPtr) {
+        return m_sharedMemoryBundleWriterPtr->Send(*m_zmqPushSock_connectingStorageToBoundEgressPtr, zmqBundle, zmq::send_flags::dontwait);
+    }
+    return static_cast<bool>(m_zmqPushSock_connectingStorageToBoundEgressPtr->send(std::move(zmqBundle), zmq::send_flags::dontwait));
+}
+
+void ZmqStorageInterface::Impl::ProcessBundleFromIngress(hdtn::ToStorageHdr& toStorageHeader, zmq::message_t& zmqBundleDataReceived,
+    std::vector<hdtn::IngressUniqueIdAckRange>* batchedAcksToIngressPtr)
+{
+    if ((toStorageHeader.dontStoreBundle)
+        && (toStorageHeader.outductIndex < m_vectorOutductInfo.size()) //if outductIndex is UINT64_MAX then bundle needs stored
+        && m_vectorOutductInfo[toStorageHeader.outductIndex]->linkIsUp)
+    {
+        //ack message to ingress is sent later (when egress acks the cut-through bundle)
+        //force natural/64-bit alignment
+        hdtn::StorageAckHdr* storageAckHdr = new hdtn::StorageAckHdr();
+        zmq::message_t zmqMessageStorageAckHdrWithDataStolen(storageAckHdr, sizeof(hdtn::StorageAckHdr), CustomCleanupStorageAckHdr, storageAckHdr);
+
+        //memset 0 not needed because all values set below
+        storageAckHdr->base.type = HDTN_MSGTYPE_STORAGE_ACK_TO_INGRESS;
+        storageAckHdr->base.flags = 0;
+        storageAckHdr->error = 0;
+        storageAckHdr->storageUsedPercent = GetStorageUsedPercent();
+        storageAckHdr->ingressUniqueId = toStorageHeader.ingressUniqueId;
+        storageAckHdr->outductIndex = toStorageHeader.outductIndex;
+
+        OutductInfo_t& info = *(m_vectorOutductInfo[toStorageHeader.outductIndex]);
+        info.cutThroughQueue.emplace(std::move(zmqBundleDataReceived),
+            std::move(zmqMessageStorageAckHdrWithDataStolen), toStorageHeader.finalDestEid, toStorageHeader.ingressUniqueId);
+        return;
+    }
+
+    //storageStats.inBytes += zmqBundleDataReceived.size();
+
+    cbhe_eid_t finalDestEidReturnedFromWrite;
+    const bool isCertainThatThisBundleHasNoCustodyOrIsNotAdminRecord = (toStorageHeader.isCustodyOrAdminRecord == 0);
+    Write(&zmqBundleDataReceived, finalDestEidReturnedFromWrite, false, isCertainThatThisBundleHasNoCustodyOrIsNotAdminRecord, &toStorageHeader.finalDestEid);
+
+    if (batchedAcksToIngressPtr) {
+        std::vector<hdtn::IngressUniqueIdAckRange>& ranges = *batchedAcksToIngressPtr;
+        if (ranges.empty() || (!ranges.back().TryAppend(toStorageHeader.ingressUniqueId, toStorageHeader.outductIndex))) {
+            ranges.push_back({ toStorageHeader.ingressUniqueId, 1, toStorageHeader.outductIndex });
+        }
+        return;
+    }
+
+    //send ack message to ingress
+    //force natural/64-bit alignment
+    hdtn::StorageAckHdr* storageAckHdr = new hdtn::StorageAckHdr();
+    zmq::message_t zmqMessageStorageAckHdrWithDataStolen(storageAckHdr, sizeof(hdtn::StorageAckHdr), CustomCleanupStorageAckHdr, storageAckHdr);
+
+    //memset 0 not needed because all values set below
+    storageAckHdr->base.type = HDTN_MSGTYPE_STORAGE_ACK_TO_INGRESS;
+    storageAckHdr->base.flags = 0;
+    storageAckHdr->error = 0;
+    storageAckHdr->storageUsedPercent = GetStorageUsedPercent();
+    storageAckHdr->ingressUniqueId = toStorageHeader.ingressUniqueId;
+    storageAckHdr->outductIndex = toStorageHeader.outductIndex;
+
+    //storageAckHdr->finalDestEid = finalDestEidReturnedFromWrite; //no longer needed as ingress decodes that
+
+    if (!m_zmqPushSock_connectingStorageToBoundIngressPtr->send(std::move(zmqMessageStorageAckHdrWithDataStolen), zmq::send_flags::dontwait)) {
+        LOG_ERROR(subprocess) << "zmq could not send ingress an ack from storage";
+    }
+}
+
+void ZmqStorageInterface::Impl::SendBatchedAcksToIngress(std::vector<hdtn::IngressUniqueIdAckRange>& batchedAcksToIngress) {
+    if (batchedAcksToIngress.empty()) {
+        return;
+    }
+    hdtn::StorageAckHdr storageAckHdr;
+    memset(&storageAckHdr, 0, sizeof(storageAckHdr));
+    storageAckHdr.base.type = HDTN_MSGTYPE_STORAGE_ACK_BATCH_TO_INGRESS;
+    storageAckHdr.storageUsedPercent = GetStorageUsedPercent();
+    zmq::message_t zmqMessageStorageAckHdr(&storageAckHdr, sizeof(storageAckHdr));
+    zmq::message_t zmqMessageRanges(batchedAcksToIngress.data(), batchedAcksToIngress.size() * sizeof(hdtn::IngressUniqueIdAckRange));
+    if (!m_zmqPushSock_connectingStorageToBoundIngressPtr->send(std::move(zmqMessageStorageAckHdr), zmq::send_flags::sndmore | zmq::send_flags::dontwait)) {
+        LOG_ERROR(subprocess) << "zmq could not send ingress a batched ack header from storage";
+    }
+    else if (!m_zmqPushSock_connectingStorageToBoundIngressPtr->send(std::move(zmqMessageRanges), zmq::send_flags::dontwait)) {
+        LOG_ERROR(subprocess) << "zmq could not send ingress a batched ack from storage";
+    }
+    batchedAcksToIngress.resize(0);
+}
+
 void ZmqStorageInterface::Impl::ThreadFunc() {
     ThreadNamer::SetThisThreadName("ZmqStorageInterface");
     
@@ -1191,7 +1339,7 @@ void ZmqStorageInterface::Impl::ThreadFunc() {
     m_bundleDeletionStatusReport.m_backBuffer.reserve(2000);
 
     m_custodyIdAllocatorPtr = boost::make_unique<CustodyIdAllocator>();
-    m_custodyTimersPtr = boost::make_unique<CustodyTimers>(boost::posix_time::milliseconds(m_hdtnConfig.m_retransmitBundleAfterNoCustodySignalMilliseconds));
+    m_custodyTimersPtr = boost::make_unique<CustodyTimersTimingWheel>(boost::posix_time::milliseconds(m_hdtnConfig.m_retransmitBundleAfterNoCustodySignalMilliseconds));
     const bool IS_HDTN_ACS_AWARE = m_hdtnConfig.m_isAcsAware;
     const uint64_t ACS_MAX_FILLS_PER_ACS_PACKET = m_hdtnConfig.m_acsMaxFillsPerAcsPacket;
     
@@ -1211,11 +1359,27 @@ void ZmqStorageInterface::Impl::ThreadFunc() {
         LOG_INFO(subprocess) << "[ZmqStorageInterface] Initializing BundleStorageManagerAsio ... ";
         m_bsmPtr = boost::make_unique<BundleStorageManagerAsio>(std::make_shared<StorageConfig>(m_hdtnConfig.m_storageConfig));
     }
+#ifdef STORAGE_IO_URING_ENABLED
+    else if (m_hdtnConfig.m_storageConfig.m_storageImplementation == "io_uring_multi_threaded") {
+        LOG_INFO(subprocess) << "[ZmqStorageInterface] Initializing BundleStorageManagerIoUring ... ";
+        m_bsmPtr = boost::make_unique<BundleStorageManagerIoUring>(std::make_shared<StorageConfig>(m_hdtnConfig.m_storageConfig));
+    }
+#endif
     else {
         LOG_ERROR(subprocess) << "error in hdtn::ZmqStorageInterface::ThreadFunc: invalid storage implementation " << m_hdtnConfig.m_storageConfig.m_storageImplementation;
         return;
     }
     m_bsmPtr->Start();
+    if (m_bsmPtr->m_successfullyRestoredFromDisk) {
+        //restored bundles keep their custody ids, so they must not be allocated to new bundles
+        std::vector<uint64_t> restoredCustodyIds;
+        m_bsmPtr->GetBundleStorageCatalogConstRef().GetCustodyIdsInSendOrder(restoredCustodyIds);
+        for (std::size_t i = 0; i < restoredCustodyIds.size(); ++i) {
+            m_custodyIdAllocatorPtr->InitializeAddUsedCustodyId(restoredCustodyIds[i]);
+        }
+        LOG_INFO(subprocess) << "restored " << restoredCustodyIds.size() << " bundles"
+            << ((m_bsmPtr->m_successfullyRestoredFromCatalogJournal) ? " from the catalog journal" : " from disk");
+    }
     
 
     
@@ -1489,6 +1653,7 @@ void ZmqStorageInterface::Impl::ThreadFunc() {
                                     const eid_plus_isanyserviceid_pair_t key(cbhe_eid_t(nodeId, 0), true); //true => any service id.. 0 is don't care
                                     outductInfo.eidVec.push_back(key);
                                 }
+                                SetAwaitingSendGroup(outductInfo);
                             }
                             
 
@@ -1550,6 +1715,7 @@ void ZmqStorageInterface::Impl::ThreadFunc() {
                         info.eidVec.resize(1);
                         const eid_plus_isanyserviceid_pair_t key(cbhe_eid_t(nodeId, 0), true); //true => any service id.. 0 is don't care
                         info.eidVec[0] = key;
+                        SetAwaitingSendGroup(info);
                         info.nextHopNodeId = nodeId;
                         info.linkIsUp = true;
                         info.outductIndex = UINT64_MAX;
@@ -1564,8 +1730,11 @@ void ZmqStorageInterface::Impl::ThreadFunc() {
                 }
                 else if (toStorageHeader.base.type == HDTN_MSGTYPE_STORAGE_REMOVE_OPPORTUNISTIC_LINK) {
                     const uint64_t nodeId = toStorageHeader.ingressUniqueId;
-                    const bool wasErased = (m_mapOpportunisticNextHopNodeIdToOutductInfo.erase(nodeId) == 1);
+                    std::map<uint64_t, OutductInfoPtr_t>::iterator it = m_mapOpportunisticNextHopNodeIdToOutductInfo.find(nodeId);
+                    const bool wasErased = (it != m_mapOpportunisticNextHopNodeIdToOutductInfo.end());
                     if (wasErased) {
+                        m_bsmPtr->RemoveAwaitingSendGroup(it->second->awaitingSendGroupId);
+                        m_mapOpportunisticNextHopNodeIdToOutductInfo.erase(it);
                         RepopulateUpLinksVec();
                     }
                     LOG_INFO(subprocess) << "Removing Opportunistic link from ingress connection.. finalDestEid ("
@@ -1580,41 +1749,24 @@ void ZmqStorageInterface::Impl::ThreadFunc() {
                     if (!m_zmqPullSock_boundIngressToConnectingStoragePtr->recv(zmqBundleDataReceived, zmq::recv_flags::none)) {
                         LOG_ERROR(subprocess) << "hdtn::ZmqStorageInterface::ThreadFunc (from ingress bundle data) message not received";
                     }
-                    else {
-                        //send ack message to ingress
-                        //force natural/64-bit alignment
-                        hdtn::StorageAckHdr* storageAckHdr = new hdtn::StorageAckHdr();
-                        zmq::message_t zmqMessageStorageAckHdrWithDataStolen(storageAckHdr, sizeof(hdtn::StorageAckHdr), CustomCleanupStorageAckHdr, storageAckHdr);
-
-                        //memset 0 not needed because all values set below
-                        storageAckHdr->base.type = HDTN_MSGTYPE_STORAGE_ACK_TO_INGRESS;
-                        storageAckHdr->base.flags = 0;
-                        storageAckHdr->error = 0;
-                        storageAckHdr->ingressUniqueId = toStorageHeader.ingressUniqueId;
-                        storageAckHdr->outductIndex = toStorageHeader.outductIndex;
-
-                        if ((toStorageHeader.dontStoreBundle)
-                            && (toStorageHeader.outductIndex < m_vectorOutductInfo.size()) //if outductIndex is UINT64_MAX then bundle needs stored
-                            && m_vectorOutductInfo[toStorageHeader.outductIndex]->linkIsUp)
-                        {
-                            OutductInfo_t& info = *(m_vectorOutductInfo[toStorageHeader.outductIndex]);
-                            info.cutThroughQueue.emplace(std::move(zmqBundleDataReceived),
-                                std::move(zmqMessageStorageAckHdrWithDataStolen), toStorageHeader.finalDestEid, toStorageHeader.ingressUniqueId);
-                        }
-                        else {
-                            //storageStats.inBytes += zmqBundleDataReceived.size();
-
-                            cbhe_eid_t finalDestEidReturnedFromWrite;
-                            const bool isCertainThatThisBundleHasNoCustodyOrIsNotAdminRecord = (toStorageHeader.isCustodyOrAdminRecord == 0);
-                            Write(&zmqBundleDataReceived, finalDestEidReturnedFromWrite, false, isCertainThatThisBundleHasNoCustodyOrIsNotAdminRecord, &toStorageHeader.finalDestEid);
-
-                            //storageAckHdr->finalDestEid = finalDestEidReturnedFromWrite; //no longer needed as ingress decodes that
-
-                            if (!m_zmqPushSock_connectingStorageToBoundIngressPtr->send(std::move(zmqMessageStorageAckHdrWithDataStolen), zmq::send_flags::dontwait)) {
-                                LOG_ERROR(subprocess) << "zmq could not send ingress an ack from storage";
-                            }
+                    else if (ResolveBundleFromIngress(zmqBundleDataReceived)) {
+                        ProcessBundleFromIngress(toStorageHeader, zmqBundleDataReceived, NULL);
+                    }
+                }
+                else if (toStorageHeader.base.type == HDTN_MSGTYPE_STORE_BATCH) {
+                    //process the whole batch in one pass, then ack all the stored bundles in one message
+                    if (!hdtn::ReceiveBatchMessage(*m_zmqPullSock_boundIngressToConnectingStoragePtr, m_batchToStorageHeaders, m_batchBundles)) {
+                        LOG_ERROR(subprocess) << "hdtn::ZmqStorageInterface::ThreadFunc malformed batch from ingress, processing only the "
+                            << m_batchBundles.size() << " bundles received";
+                    }
+                    m_batchedAcksToIngress.resize(0);
+                    for (std::size_t i = 0; i < m_batchBundles.size(); ++i) {
+                        if (ResolveBundleFromIngress(m_batchBundles[i])) {
+                            ProcessBundleFromIngress(m_batchToStorageHeaders[i], m_batchBundles[i], &m_batchedAcksToIngress);
                         }
                     }
+                    m_batchBundles.resize(0);
+                    SendBatchedAcksToIngress(m_batchedAcksToIngress);
                 }
                 else {
                     LOG_ERROR(subprocess) << "hdtn::ZmqStorageInterface::ThreadFunc (from ingress bundle data) unknown message type";
@@ -1758,7 +1910,7 @@ void ZmqStorageInterface::Impl::DoSendBundles(long & timeoutPoll) {
                 break; //return to zmq loop with zero timeout
             }
             else if (timeoutPoll != shortestTimeoutPoll1Ms) { //potentially clogged
-                if (PeekOne(info.eidVec) > 0) { //data available in storage for clogged links
+                if (PeekOne(info) > 0) { //data available in storage for clogged links
                     timeoutPoll = shortestTimeoutPoll1Ms; //shortest timeout 1ms as we wait for acks
                     ++m_totalEventsDataInStorageForCloggedLinks;
                 }
@@ -1781,7 +1933,7 @@ void ZmqStorageInterface::Impl::PrioritySend(OutductInfo_t &info, uint64_t maxBu
     }
 
     bool queueBundleSmallEnough = (info.cutThroughQueue.front().bundleToEgress.size() <= maxBundleSizeToRead);
-    if(!PeekOne(info.eidVec, storageBundlePriority)) {
+    if(!PeekOne(info, storageBundlePriority)) {
         if(queueBundleSmallEnough) {
             SendFromCutThroughQueue(info, timeoutPoll);
         }
@@ -1913,7 +2065,7 @@ void ZmqStorageInterface::Impl::SendFromCutThroughQueue(OutductInfo_t &info, lon
                     if (!m_zmqPushSock_connectingStorageToBoundEgressPtr->send(std::move(zmqMessageToEgressHdrWithDataStolen), zmq::send_flags::sndmore | zmq::send_flags::dontwait)) {
                         LOG_ERROR(subprocess) << "could not forward header of cut-through bundle to egress";
                     }
-                    else if (!m_zmqPushSock_connectingStorageToBoundEgressPtr->send(std::move(qd.bundleToEgress), zmq::send_flags::dontwait)) {
+                    else if (!SendBundlePartToEgress(qd.bundleToEgress)) {
                         LOG_ERROR(subprocess) << "could not forward cut-through bundle to egress";
                     }
                     //with cut through bundles, don't send an ack to ingress until fully sent confirmation ack from egress, hence the map below to defer that
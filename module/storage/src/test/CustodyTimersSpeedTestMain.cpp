@@ -0,0 +1,168 @@
+/**
+ * @file CustodyTimersSpeedTestMain.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * Microbenchmark comparing CustodyTimers and CustodyTimersTimingWheel the way storage uses them:
+ * starting a custody transfer timer for a large number of bundles (spread over many destinations),
+ * polling for an expired timer while none have expired (once per storage loop iteration),
+ * cancelling the timers (in random order, as custody signals arrive), and popping every expired timer.
+ */
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <boost/program_options.hpp>
+#include <boost/timer/timer.hpp>
+#include "CustodyTimers.h"
+#include "CustodyTimersTimingWheel.h"
+#include "Logger.h"
+
+static constexpr hdtn::Logger::SubProcess subprocess = hdtn::Logger::SubProcess::storage;
+
+struct CustodyTimersSpeedTestResult {
+    double startsPerSec;
+    double pollsPerSec;
+    double cancelsPerSec;
+    double expiredPopsPerSec;
+};
+
+static double OpsPerSec(const std::size_t numOps, const boost::timer::cpu_timer & timer) {
+    const double seconds = static_cast<double>(timer.elapsed().wall) * 1e-9;
+    return (seconds > 0.0) ? (static_cast<double>(numOps) / seconds) : 0.0;
+}
+
+template <typename custodyTimersType>
+static bool TestSpeed(const std::vector<cbhe_eid_t> & destEids, const std::vector<uint64_t> & shuffledCustodyIds,
+    const uint64_t numPolls, CustodyTimersSpeedTestResult & result)
+{
+    const std::size_t numTimers = shuffledCustodyIds.size();
+    uint64_t custodyId;
+    {
+        custodyTimersType ct(boost::posix_time::seconds(1000));
+        {
+            boost::timer::cpu_timer timer;
+            for (std::size_t i = 0; i < numTimers; ++i) {
+                if (!ct.StartCustodyTransferTimer(destEids[i % destEids.size()], i)) {
+                    LOG_ERROR(subprocess) << "start failed at " << i;
+                    return false;
+                }
+            }
+            timer.stop();
+            result.startsPerSec = OpsPerSec(numTimers, timer);
+        }
+        {
+            const boost::posix_time::ptime nowPtime = boost::posix_time::microsec_clock::universal_time();
+            boost::timer::cpu_timer timer;
+            for (uint64_t i = 0; i < numPolls; ++i) {
+                if (ct.PollOneAndPopAnyExpiredCustodyTimer(custodyId, nowPtime + boost::posix_time::microseconds(i))) {
+                    LOG_ERROR(subprocess) << "poll unexpectedly expired custody id " << custodyId;
+                    return false;
+                }
+            }
+            timer.stop();
+            result.pollsPerSec = OpsPerSec(numPolls, timer);
+        }
+        {
+            boost::timer::cpu_timer timer;
+            for (std::size_t i = 0; i < numTimers; ++i) {
+                const uint64_t cid = shuffledCustodyIds[i];
+                if (!ct.CancelCustodyTransferTimer(destEids[cid % destEids.size()], cid)) {
+                    LOG_ERROR(subprocess) << "cancel failed at " << i;
+                    return false;
+                }
+            }
+            timer.stop();
+            result.cancelsPerSec = OpsPerSec(numTimers, timer);
+        }
+    }
+    {
+        custodyTimersType ct(boost::posix_time::milliseconds(100));
+        for (std::size_t i = 0; i < numTimers; ++i) {
+            ct.StartCustodyTransferTimer(destEids[i % destEids.size()], i);
+        }
+        const boost::posix_time::ptime expiredPtime = boost::posix_time::microsec_clock::universal_time() + boost::posix_time::seconds(1);
+        boost::timer::cpu_timer timer;
+        std::size_t numPopped = 0;
+        while (ct.PollOneAndPopAnyExpiredCustodyTimer(custodyId, expiredPtime)) {
+            ++numPopped;
+        }
+        timer.stop();
+        if (numPopped != numTimers) {
+            LOG_ERROR(subprocess) << "popped " << numPopped << " of " << numTimers << " expired timers";
+            return false;
+        }
+        result.expiredPopsPerSec = OpsPerSec(numTimers, timer);
+    }
+    return true;
+}
+
+int main(int argc, const char* argv[]) {
+    hdtn::Logger::initializeWithProcess(hdtn::Logger::Process::storagespeedtest);
+
+    uint64_t numTimers;
+    uint64_t numDestinations;
+    uint64_t numPolls;
+    boost::program_options::options_description desc("Allowed options");
+    try {
+        desc.add_options()
+            ("help", "Produce help message.")
+            ("num-timers", boost::program_options::value<uint64_t>()->default_value(1000000), "Number of custody transfer timers to start, cancel, and expire.")
+            ("num-destinations", boost::program_options::value<uint64_t>()->default_value(100), "Number of final destinations the timers are spread over.")
+            ("num-polls", boost::program_options::value<uint64_t>()->default_value(1000000), "Number of polls while no timer has expired.");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc, boost::program_options::command_line_style::unix_style | boost::program_options::command_line_style::case_insensitive), vm);
+        boost::program_options::notify(vm);
+
+        if (vm.count("help")) {
+            LOG_INFO(subprocess) << desc;
+            return 1;
+        }
+        numTimers = vm["num-timers"].as<uint64_t>();
+        numDestinations = std::max<uint64_t>(vm["num-destinations"].as<uint64_t>(), 1);
+        numPolls = vm["num-polls"].as<uint64_t>();
+    }
+    catch (std::exception& e) {
+        LOG_ERROR(subprocess) << "error: " << e.what();
+        return 1;
+    }
+
+    std::vector<cbhe_eid_t> destEids;
+    for (uint64_t i = 0; i < numDestinations; ++i) {
+        destEids.emplace_back(100 + i, 1);
+    }
+    std::vector<uint64_t> shuffledCustodyIds(numTimers);
+    for (uint64_t i = 0; i < numTimers; ++i) {
+        shuffledCustodyIds[i] = i;
+    }
+    std::mt19937 gen(12345);
+    std::shuffle(shuffledCustodyIds.begin(), shuffledCustodyIds.end(), gen);
+
+    CustodyTimersSpeedTestResult listResult;
+    CustodyTimersSpeedTestResult wheelResult;
+    LOG_INFO(subprocess) << "testing CustodyTimers";
+    if (!TestSpeed<CustodyTimers>(destEids, shuffledCustodyIds, numPolls, listResult)) {
+        return 1;
+    }
+    LOG_INFO(subprocess) << "testing CustodyTimersTimingWheel";
+    if (!TestSpeed<CustodyTimersTimingWheel>(destEids, shuffledCustodyIds, numPolls, wheelResult)) {
+        return 1;
+    }
+    LOG_INFO(subprocess) << numTimers << " timers over " << numDestinations << " destinations (million operations/sec, CustodyTimers -> CustodyTimersTimingWheel):"
+        << " start " << (listResult.startsPerSec * 1e-6) << " -> " << (wheelResult.startsPerSec * 1e-6)
+        << " (" << (wheelResult.startsPerSec / listResult.startsPerSec) << "x),"
+        << " poll " << (listResult.pollsPerSec * 1e-6) << " -> " << (wheelResult.pollsPerSec * 1e-6)
+        << " (" << (wheelResult.pollsPerSec / listResult.pollsPerSec) << "x),"
+        << " cancel " << (listResult.cancelsPerSec * 1e-6) << " -> " << (wheelResult.cancelsPerSec * 1e-6)
+        << " (" << (wheelResult.cancelsPerSec / listResult.cancelsPerSec) << "x),"
+        << " pop expired " << (listResult.expiredPopsPerSec * 1e-6) << " -> " << (wheelResult.expiredPopsPerSec * 1e-6)
+        << " (" << (wheelResult.expiredPopsPerSec / listResult.expiredPopsPerSec) << "x)";
+    return 0;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file HashMapSpeedTestMain.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ *
+ * @section DESCRIPTION
+ *
+ * Microbenchmark comparing the storage catalog hash maps HashMap16BitFixedSize and HashMapOpenAddressing
+ * by inserting, looking up (in random order), and removing (in random order) a large number of entries
+ * keyed by bundle uuid (as for custody signals) and by custody id (as for the catalog entries).
+ */
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <boost/make_unique.hpp>
+#include <boost/program_options.hpp>
+#include <boost/timer/timer.hpp>
+#include "HashMap16BitFixedSize.h"
+#include "HashMapOpenAddressing.h"
+#include "CatalogEntry.h"
+#include "Logger.h"
+
+static constexpr hdtn::Logger::SubProcess subprocess = hdtn::Logger::SubProcess::storage;
+
+struct HashMapSpeedTestResult {
+    double insertsPerSec;
+    double lookupsPerSec;
+    double removesPerSec;
+};
+
+static double OpsPerSec(const std::size_t numOps, const boost::timer::cpu_timer & timer) {
+    const double seconds = static_cast<double>(timer.elapsed().wall) * 1e-9;
+    return (seconds > 0.0) ? (static_cast<double>(numOps) / seconds) : 0.0;
+}
+
+template <typename hashmapType, typename keyType, typename valueType>
+static bool TestSpeed(const std::vector<keyType> & keys, const std::vector<keyType> & shuffledKeys, HashMapSpeedTestResult & result) {
+    std::unique_ptr<hashmapType> hmPtr = boost::make_unique<hashmapType>(); //HashMap16BitFixedSize is too large for the stack
+    hashmapType & hm = *hmPtr;
+    {
+        boost::timer::cpu_timer timer;
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            if (!hm.Insert(keys[i], valueType())) {
+                LOG_ERROR(subprocess) << "insert failed at " << i;
+                return false;
+            }
+        }
+        timer.stop();
+        result.insertsPerSec = OpsPerSec(keys.size(), timer);
+    }
+    {
+        boost::timer::cpu_timer timer;
+        for (std::size_t i = 0; i < shuffledKeys.size(); ++i) {
+            if (!hm.GetValuePtr(shuffledKeys[i])) {
+                LOG_ERROR(subprocess) << "lookup failed at " << i;
+                return false;
+            }
+        }
+        timer.stop();
+        result.lookupsPerSec = OpsPerSec(shuffledKeys.size(), timer);
+    }
+    {
+        valueType value;
+        boost::timer::cpu_timer timer;
+        for (std::size_t i = 0; i < shuffledKeys.size(); ++i) {
+            if (!hm.GetValueAndRemove(shuffledKeys[i], value)) {
+                LOG_ERROR(subprocess) << "remove failed at " << i;
+                return false;
+            }
+        }
+        timer.stop();
+        result.removesPerSec = OpsPerSec(shuffledKeys.size(), timer);
+    }
+    return true;
+}
+
+template <typename keyType, typename valueType>
+static bool CompareHashMaps(const std::string & name, const std::vector<keyType> & keys) {
+    std::vector<keyType> shuffledKeys(keys);
+    std::mt19937 gen(12345);
+    std::shuffle(shuffledKeys.begin(), shuffledKeys.end(), gen);
+
+    HashMapSpeedTestResult fixedSizeResult;
+    HashMapSpeedTestResult openAddressingResult;
+    LOG_INFO(subprocess) << "testing HashMap16BitFixedSize<" << name << ">";
+    if (!TestSpeed<HashMap16BitFixedSize<keyType, valueType>, keyType, valueType>(keys, shuffledKeys, fixedSizeResult)) {
+        return false;
+    }
+    LOG_INFO(subprocess) << "testing HashMapOpenAddressing<" << name << ">";
+    if (!TestSpeed<HashMapOpenAddressing<keyType, valueType>, keyType, valueType>(keys, shuffledKeys, openAddressingResult)) {
+        return false;
+    }
+    LOG_INFO(subprocess) << name << " with " << keys.size() << " entries (million operations/sec, HashMap16BitFixedSize -> HashMapOpenAddressing):"
+        << " insert " << (fixedSizeResult.insertsPerSec * 1e-6) << " -> " << (openAddressingResult.insertsPerSec * 1e-6)
+        << " (" << (openAddressingResult.insertsPerSec / fixedSizeResult.insertsPerSec) << "x),"
+        << " lookup " << (fixedSizeResult.lookupsPerSec * 1e-6) << " -> " << (openAddressingResult.lookupsPerSec * 1e-6)
+        << " (" << (openAddressingResult.lookupsPerSec / fixedSizeResult.lookupsPerSec) << "x),"
+        << " remove " << (fixedSizeResult.removesPerSec * 1e-6) << " -> " << (openAddressingResult.removesPerSec * 1e-6)
+        << " (" << (openAddressingResult.removesPerSec / fixedSizeResult.removesPerSec) << "x)";
+    return true;
+}
+
+int main(int argc, const char* argv[]) {
+    hdtn::Logger::initializeWithProcess(hdtn::Logger::Process::storagespeedtest);
+
+    uint64_t numEntries;
+    boost::program_options::options_description desc("Allowed options");
+    try {
+        desc.add_options()
+            ("help", "Produce help message.")
+            ("num-entries", boost::program_options::value<uint64_t>()->default_value(10000000), "Number of entries to insert, look up, and remove.");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc, boost::program_options::command_line_style::unix_style | boost::program_options::command_line_style::case_insensitive), vm);
+        boost::program_options::notify(vm);
+
+        if (vm.count("help")) {
+            LOG_INFO(subprocess) << desc;
+            return 1;
+        }
+        numEntries = vm["num-entries"].as<uint64_t>();
+    }
+    catch (std::exception& e) {
+        LOG_ERROR(subprocess) << "error: " << e.what();
+        return 1;
+    }
+
+    //custody signals look up the custody id by bundle uuid (bundles from 10 sources, 1000 per second each)
+    {
+        std::vector<cbhe_bundle_uuid_nofragment_t> uuids;
+        uuids.reserve(numEntries);
+        for (uint64_t i = 0; i < numEntries; ++i) {
+            uuids.emplace_back(800000000 + (i / 10000), i / 10, 1 + (i % 10), 1); //creationSeconds, sequence, srcNodeId, srcServiceId
+        }
+        if (!CompareHashMaps<cbhe_bundle_uuid_nofragment_t, uint64_t>("cbhe_bundle_uuid_nofragment_t, uint64_t", uuids)) {
+            return 1;
+        }
+    }
+
+    //the catalog looks up the catalog entry by custody id (allocated sequentially)
+    {
+        std::vector<uint64_t> custodyIds;
+        custodyIds.reserve(numEntries);
+        for (uint64_t i = 0; i < numEntries; ++i) {
+            custodyIds.push_back(i);
+        }
+        if (!CompareHashMaps<uint64_t, catalog_entry_t>("uint64_t, catalog_entry_t", custodyIds)) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -15,7 +15,9 @@
 #include <string>
 #include "BundleStorageManagerMT.h"
 #include "BundleStorageManagerAsio.h"
+#include "BundleStorageManagerIoUring.h"
 #include <boost/make_unique.hpp>
+#include <boost/program_options.hpp>
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_int_distribution.hpp>
 #include <boost/timer/timer.hpp>
@@ -58,7 +60,7 @@ struct TestFile {
 //two days
 #define NUMBER_OF_EXPIRATIONS (86400*2)
 
-bool TestSpeed(BundleStorageManagerBase & bsm) {
+static bool TestSpeed(BundleStorageManagerBase & bsm, double & gigaBitsPerSecReadAvg, double & gigaBitsPerSecWriteAvg) {
     boost::random::mt19937 gen(static_cast<unsigned int>(std::time(0)));
     const boost::random::uniform_int_distribution<> distLinkId(0, 9);
     const boost::random::uniform_int_distribution<> distFileId(0, 9);
@@ -66,8 +68,6 @@ bool TestSpeed(BundleStorageManagerBase & bsm) {
     const boost::random::uniform_int_distribution<> distAbsExpiration(0, NUMBER_OF_EXPIRATIONS - 1);
     const boost::random::uniform_int_distribution<> distTotalBundleSize(1, 65536);
 
-    g_sigHandler.Start();
-
     static const cbhe_eid_t DEST_LINKS[10] = {
         cbhe_eid_t(1,1),
         cbhe_eid_t(2,1),
@@ -221,24 +221,131 @@ bool TestSpeed(BundleStorageManagerBase & bsm) {
         }
     }
 
+    gigaBitsPerSecReadAvg = gigaBitsPerSecReadDoubleAvg / NUM_TESTS;
+    gigaBitsPerSecWriteAvg = gigaBitsPerSecWriteDoubleAvg / NUM_TESTS;
     if (g_running.load(std::memory_order_acquire)) {
-        LOG_DEBUG(subprocess) << "Read avg GBits/sec=" << gigaBitsPerSecReadDoubleAvg / NUM_TESTS;
-        LOG_DEBUG(subprocess) << "Write avg GBits/sec=" << gigaBitsPerSecWriteDoubleAvg / NUM_TESTS;
+        LOG_DEBUG(subprocess) << "Read avg GBits/sec=" << gigaBitsPerSecReadAvg;
+        LOG_DEBUG(subprocess) << "Write avg GBits/sec=" << gigaBitsPerSecWriteAvg;
     }
     return true;
 
 }
 
-
-int main() {
-    hdtn::Logger::initializeWithProcess(hdtn::Logger::Process::storagespeedtest);
+static std::unique_ptr<BundleStorageManagerBase> CreateBundleStorageManager(const std::string & storageImplementation, const StorageConfig_ptr & storageConfigPtr) {
     std::unique_ptr<BundleStorageManagerBase> bsmPtr;
-    if (true) {
-        boost::make_unique<BundleStorageManagerMT>();
+    if (storageImplementation == "stdio_multi_threaded") {
+        bsmPtr = boost::make_unique<BundleStorageManagerMT>(storageConfigPtr);
     }
+    else if (storageImplementation == "asio_single_threaded") {
+        bsmPtr = boost::make_unique<BundleStorageManagerAsio>(storageConfigPtr);
+    }
+#ifdef STORAGE_IO_URING_ENABLED
+    else if (storageImplementation == "io_uring_multi_threaded") {
+        bsmPtr = boost::make_unique<BundleStorageManagerIoUring>(storageConfigPtr);
+    }
+#endif
     else {
-        boost::make_unique<BundleStorageManagerAsio>();
+        LOG_ERROR(subprocess) << "invalid or unsupported storage implementation " << storageImplementation;
+    }
+    return bsmPtr;
+}
+
+int main(int argc, const char* argv[]) {
+    hdtn::Logger::initializeWithProcess(hdtn::Logger::Process::storagespeedtest);
+
+    boost::filesystem::path storageConfigFilePath;
+    std::vector<std::string> storageImplementations;
+    bool compareDirectIo = false;
+    boost::program_options::options_description desc("Allowed options");
+    try {
+        desc.add_options()
+            ("help", "Produce help message.")
+            ("storage-config-file", boost::program_options::value<boost::filesystem::path>()->default_value("storageConfig.json"), "Storage Configuration File.")
+            ("storage-implementation", boost::program_options::value<std::vector<std::string> >()->multitoken(),
+                "Storage implementation(s) to test (default: every implementation compiled in). "
+                "The first one tested is the baseline that the others are compared against.")
+            ("compare-direct-io", "Test each storage implementation twice, first through the page cache and then with direct I/O on every disk "
+                "(otherwise each disk's useDirectIo setting from the config file is used).");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc, boost::program_options::command_line_style::unix_style | boost::program_options::command_line_style::case_insensitive), vm);
+        boost::program_options::notify(vm);
+
+        if (vm.count("help")) {
+            LOG_INFO(subprocess) << desc;
+            return 1;
+        }
+        storageConfigFilePath = vm["storage-config-file"].as<boost::filesystem::path>();
+        compareDirectIo = (vm.count("compare-direct-io") != 0);
+        if (vm.count("storage-implementation")) {
+            storageImplementations = vm["storage-implementation"].as<std::vector<std::string> >();
+        }
+        else {
+            storageImplementations = { "stdio_multi_threaded", "asio_single_threaded"
+#ifdef STORAGE_IO_URING_ENABLED
+                , "io_uring_multi_threaded"
+#endif
+            };
+        }
+    }
+    catch (std::exception& e) {
+        LOG_ERROR(subprocess) << "error: " << e.what();
+        return 1;
+    }
+
+    //each test run is an implementation plus (when comparing) whether to force direct I/O off (0) or on (1) for every disk, or -1 to use the config file
+    std::vector<std::pair<std::string, int> > testRunsVec;
+    for (std::size_t i = 0; i < storageImplementations.size(); ++i) {
+        if (compareDirectIo) {
+            testRunsVec.emplace_back(storageImplementations[i], 0);
+            testRunsVec.emplace_back(storageImplementations[i], 1);
+        }
+        else {
+            testRunsVec.emplace_back(storageImplementations[i], -1);
+        }
+    }
+
+    g_sigHandler.Start();
+    std::vector<std::string> testRunNamesVec;
+    std::vector<std::pair<double, double> > readWriteRatesVec;
+    for (std::size_t i = 0; (i < testRunsVec.size()) && g_running.load(std::memory_order_acquire); ++i) {
+        const std::string & storageImplementation = testRunsVec[i].first;
+        const int forceDirectIo = testRunsVec[i].second;
+        StorageConfig_ptr storageConfigPtr = StorageConfig::CreateFromJsonFilePath(storageConfigFilePath);
+        if (!storageConfigPtr) {
+            LOG_ERROR(subprocess) << "cannot open storage json config file: " << storageConfigFilePath;
+            return 1;
+        }
+        storageConfigPtr->m_tryToRestoreFromDisk = false;
+        storageConfigPtr->m_autoDeleteFilesOnExit = true;
+        std::string testRunName = storageImplementation;
+        if (forceDirectIo >= 0) {
+            for (std::size_t diskId = 0; diskId < storageConfigPtr->m_storageDiskConfigVector.size(); ++diskId) {
+                storageConfigPtr->m_storageDiskConfigVector[diskId].useDirectIo = (forceDirectIo != 0);
+            }
+            testRunName += (forceDirectIo) ? " (direct I/O)" : " (page cache)";
+        }
+        std::unique_ptr<BundleStorageManagerBase> bsmPtr = CreateBundleStorageManager(storageImplementation, storageConfigPtr);
+        if (!bsmPtr) {
+            return 1;
+        }
+        LOG_INFO(subprocess) << "testing " << testRunName;
+        double gigaBitsPerSecReadAvg = 0.0, gigaBitsPerSecWriteAvg = 0.0;
+        if (!TestSpeed(*bsmPtr, gigaBitsPerSecReadAvg, gigaBitsPerSecWriteAvg)) {
+            LOG_ERROR(subprocess) << testRunName << " speed test failed";
+            return 1;
+        }
+        testRunNamesVec.push_back(std::move(testRunName));
+        readWriteRatesVec.emplace_back(gigaBitsPerSecReadAvg, gigaBitsPerSecWriteAvg);
+    }
+
+    for (std::size_t i = 0; i < readWriteRatesVec.size(); ++i) {
+        const double readRate = readWriteRatesVec[i].first;
+        const double writeRate = readWriteRatesVec[i].second;
+        LOG_INFO(subprocess) << testRunNamesVec[i] << ": Read avg GBits/sec=" << readRate
+            << " (" << (readRate / readWriteRatesVec[0].first) << "x " << testRunNamesVec[0] << ")"
+            << ", Write avg GBits/sec=" << writeRate
+            << " (" << (writeRate / readWriteRatesVec[0].second) << "x " << testRunNamesVec[0] << ")";
     }
-    LOG_INFO(subprocess) << TestSpeed(*bsmPtr);
     return 0;
 }
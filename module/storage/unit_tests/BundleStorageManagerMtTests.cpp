@@ -15,6 +15,7 @@
 #include <boost/test/unit_test.hpp>
 #include "BundleStorageManagerMT.h"
 #include "BundleStorageManagerAsio.h"
+#include "BundleStorageManagerIoUring.h"
 #include <iostream>
 #include <string>
 #include <boost/random/mersenne_twister.hpp>
@@ -22,6 +23,7 @@
 #include <boost/timer/timer.hpp>
 #include <memory>
 #include <boost/make_unique.hpp>
+#include <boost/filesystem/operations.hpp>
 #include "SignalHandler.h"
 #include "Environment.h"
 #include "Sdnv.h"
@@ -35,6 +37,11 @@ static const uint64_t PRIMARY_SRC_SVC = 1;
 //static const uint64_t PRIMARY_TIME = 1000;
 //static const uint64_t PRIMARY_LIFETIME = 2000;
 static const uint64_t PRIMARY_SEQ = 1;
+#ifdef STORAGE_IO_URING_ENABLED
+static constexpr unsigned int NUM_BSM_IMPLEMENTATIONS = 3; //MT, Asio, IoUring
+#else
+static constexpr unsigned int NUM_BSM_IMPLEMENTATIONS = 2; //MT, Asio
+#endif
 static bool GenerateBundle(padded_vector_uint8_t& bundle, const Bpv6CbhePrimaryBlock & primary, const uint64_t targetBundleSize, uint8_t startChar) {
     BundleViewV6 bv;
     bv.m_primaryBlockView.header = primary;
@@ -100,7 +107,10 @@ static bool GenerateBundleV7(padded_vector_uint8_t& bundle, const Bpv7CbhePrimar
 
 BOOST_AUTO_TEST_CASE(BundleStorageManagerAllTestCase)
 {
-    for (unsigned int whichBsm = 0; whichBsm < 2; ++whichBsm) {
+    //run every implementation through the page cache, then again with direct I/O
+    for (unsigned int testRun = 0; testRun < (NUM_BSM_IMPLEMENTATIONS * 2); ++testRun) {
+        const unsigned int whichBsm = testRun % NUM_BSM_IMPLEMENTATIONS;
+        const bool useDirectIo = (testRun >= NUM_BSM_IMPLEMENTATIONS);
         boost::random::mt19937 gen(static_cast<unsigned int>(std::time(0)));
         const boost::random::uniform_int_distribution<> distRandomData(0, 255);
         const boost::random::uniform_int_distribution<> distLinkId(0, 9);
@@ -138,14 +148,24 @@ BOOST_AUTO_TEST_CASE(BundleStorageManagerAllTestCase)
         StorageConfig_ptr ptrStorageConfig = StorageConfig::CreateFromJsonFilePath(Environment::GetPathHdtnSourceRoot() / "config_files" / "storage" / "storageConfigRelativePaths.json");
         ptrStorageConfig->m_tryToRestoreFromDisk = false; //manually set this json entry
         ptrStorageConfig->m_autoDeleteFilesOnExit = true; //manually set this json entry
+        for (std::size_t diskId = 0; diskId < ptrStorageConfig->m_storageDiskConfigVector.size(); ++diskId) {
+            ptrStorageConfig->m_storageDiskConfigVector[diskId].useDirectIo = useDirectIo;
+        }
+        std::cout << ((useDirectIo) ? "(direct I/O) " : "(page cache) ");
         if (whichBsm == 0) {
             std::cout << "create BundleStorageManagerMT" << std::endl;
             bsmPtr = boost::make_unique<BundleStorageManagerMT>(ptrStorageConfig);
         }
-        else {
+        else if (whichBsm == 1) {
             std::cout << "create BundleStorageManagerAsio" << std::endl;
             bsmPtr = boost::make_unique<BundleStorageManagerAsio>(ptrStorageConfig);
         }
+#ifdef STORAGE_IO_URING_ENABLED
+        else {
+            std::cout << "create BundleStorageManagerIoUring" << std::endl;
+            bsmPtr = boost::make_unique<BundleStorageManagerIoUring>(ptrStorageConfig);
+        }
+#endif
         BundleStorageManagerBase & bsm = *bsmPtr;
 
         bsm.Start();
@@ -251,8 +271,10 @@ BOOST_AUTO_TEST_CASE(BundleStorageManagerAllTestCase)
 
 BOOST_AUTO_TEST_CASE(BundleStorageManagerAll_RestoreFromDisk_TestCase)
 {
+    //restore by scanning the disks, then restore from the catalog journal (which shall give identical results)
+    for (unsigned int useCatalogJournal = 0; useCatalogJournal <= 1; ++useCatalogJournal) {
     for (unsigned int whichBundleVersion = 6; whichBundleVersion <= 7; ++whichBundleVersion) {
-        for (unsigned int whichBsm = 0; whichBsm < 2; ++whichBsm) {
+        for (unsigned int whichBsm = 0; whichBsm < NUM_BSM_IMPLEMENTATIONS; ++whichBsm) {
             boost::random::mt19937 gen(static_cast<unsigned int>(std::time(0)));
             const boost::random::uniform_int_distribution<> distRandomData(0, 255);
             const boost::random::uniform_int_distribution<> distPriorityIndex(0, 2);
@@ -316,14 +338,24 @@ BOOST_AUTO_TEST_CASE(BundleStorageManagerAll_RestoreFromDisk_TestCase)
                 StorageConfig_ptr ptrStorageConfig = StorageConfig::CreateFromJsonFilePath(Environment::GetPathHdtnSourceRoot() / "config_files" / "storage" / "storageConfigRelativePaths.json");
                 ptrStorageConfig->m_tryToRestoreFromDisk = false; //manually set this json entry
                 ptrStorageConfig->m_autoDeleteFilesOnExit = false; //manually set this json entry
+                if (useCatalogJournal) {
+                    ptrStorageConfig->m_catalogJournalFilePath = "storeCatalog.journal";
+                    ptrStorageConfig->m_catalogSnapshotIntervalRecords = 4; //compact several times while writing
+                }
                 if (whichBsm == 0) {
                     std::cout << "create BundleStorageManagerMT for Restore" << std::endl;
                     bsmPtr = boost::make_unique<BundleStorageManagerMT>(ptrStorageConfig);
                 }
-                else {
+                else if (whichBsm == 1) {
                     std::cout << "create BundleStorageManagerAsio for Restore" << std::endl;
                     bsmPtr = boost::make_unique<BundleStorageManagerAsio>(ptrStorageConfig);
                 }
+#ifdef STORAGE_IO_URING_ENABLED
+                else {
+                    std::cout << "create BundleStorageManagerIoUring for Restore" << std::endl;
+                    bsmPtr = boost::make_unique<BundleStorageManagerIoUring>(ptrStorageConfig);
+                }
+#endif
                 BundleStorageManagerBase & bsm = *bsmPtr;
 
                 bsm.Start();
@@ -411,26 +443,56 @@ BOOST_AUTO_TEST_CASE(BundleStorageManagerAll_RestoreFromDisk_TestCase)
                 StorageConfig_ptr ptrStorageConfig = StorageConfig::CreateFromJsonFilePath(Environment::GetPathHdtnSourceRoot() / "config_files" / "storage" / "storageConfigRelativePaths.json");
                 ptrStorageConfig->m_tryToRestoreFromDisk = true; //manually set this json entry
                 ptrStorageConfig->m_autoDeleteFilesOnExit = true; //manually set this json entry
+                if (useCatalogJournal) {
+                    ptrStorageConfig->m_catalogJournalFilePath = "storeCatalog.journal";
+                }
                 if (whichBsm == 0) {
                     std::cout << "create BundleStorageManagerMT for Restore" << std::endl;
                     bsmPtr = boost::make_unique<BundleStorageManagerMT>(ptrStorageConfig);
                 }
-                else {
+                else if (whichBsm == 1) {
                     std::cout << "create BundleStorageManagerAsio for Restore" << std::endl;
                     bsmPtr = boost::make_unique<BundleStorageManagerAsio>(ptrStorageConfig);
                 }
+#ifdef STORAGE_IO_URING_ENABLED
+                else {
+                    std::cout << "create BundleStorageManagerIoUring for Restore" << std::endl;
+                    bsmPtr = boost::make_unique<BundleStorageManagerIoUring>(ptrStorageConfig);
+                }
+#endif
                 BundleStorageManagerBase & bsm = *bsmPtr;
 
 
 
                 //BOOST_REQUIRE(!bsm.GetMemoryManagerConstRef().IsBackupEqual(backup));
                 BOOST_REQUIRE_MESSAGE(bsm.m_successfullyRestoredFromDisk, "error restoring from disk");
+                BOOST_REQUIRE_EQUAL(bsm.m_successfullyRestoredFromCatalogJournal, (useCatalogJournal != 0));
                 BOOST_REQUIRE(bsm.GetMemoryManagerConstRef().IsBackupEqual(backup));
                 std::cout << "restored\n";
                 BOOST_REQUIRE_EQUAL(bsm.m_totalBundlesRestored, (15 - 1));
                 BOOST_REQUIRE_EQUAL(bsm.m_totalBytesRestored, bytesWritten);
                 BOOST_REQUIRE_EQUAL(bsm.m_totalSegmentsRestored, totalSegmentsWritten);
 
+                //per disk restore telemetry shall add up to the totals (there is none when the disks were not scanned)
+                if (!useCatalogJournal) {
+                    std::vector<StorageDiskRestoreTelemetry_t> diskRestoreTelemetryVec;
+                    bsm.GetDiskRestoreTelemetry(diskRestoreTelemetryVec);
+                    BOOST_REQUIRE_EQUAL(diskRestoreTelemetryVec.size(), bsm.M_NUM_STORAGE_DISKS);
+                    uint64_t telemBundlesRestored = 0, telemBytesRestored = 0, telemSegmentsRestored = 0;
+                    for (std::size_t diskId = 0; diskId < diskRestoreTelemetryVec.size(); ++diskId) {
+                        const StorageDiskRestoreTelemetry_t& telem = diskRestoreTelemetryVec[diskId];
+                        BOOST_REQUIRE_EQUAL(telem.m_diskIndex, diskId);
+                        BOOST_REQUIRE(telem.m_restoreCompleted);
+                        BOOST_REQUIRE_EQUAL(telem.m_bytesScanned, telem.m_totalBytesToScan);
+                        telemBundlesRestored += telem.m_bundlesRestored;
+                        telemBytesRestored += telem.m_bundleBytesRestored;
+                        telemSegmentsRestored += telem.m_segmentsRestored;
+                    }
+                    BOOST_REQUIRE_EQUAL(telemBundlesRestored, bsm.m_totalBundlesRestored);
+                    BOOST_REQUIRE_EQUAL(telemBytesRestored, bsm.m_totalBytesRestored);
+                    BOOST_REQUIRE_EQUAL(telemSegmentsRestored, bsm.m_totalSegmentsRestored);
+                }
+
                 bsm.Start();
 
 
@@ -472,6 +534,158 @@ BOOST_AUTO_TEST_CASE(BundleStorageManagerAll_RestoreFromDisk_TestCase)
 
 
             }
+            if (useCatalogJournal) {
+                BOOST_REQUIRE(!boost::filesystem::exists("storeCatalog.journal")); //auto deleted on exit
+                BOOST_REQUIRE(!boost::filesystem::exists("storeCatalog.journal.snapshot"));
+            }
+        }
+    }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(BundleStorageManagerAll_RamCache_TestCase)
+{
+    static const uint64_t BUNDLE_SIZE = (2 * BUNDLE_STORAGE_PER_SEGMENT_SIZE) + 1; //3 segments
+    static const uint64_t NUM_BUNDLES_CACHED = 3;
+    const std::vector<cbhe_eid_t> availableDestLinks = { cbhe_eid_t(1,1) };
+    for (unsigned int whichBsm = 0; whichBsm < NUM_BSM_IMPLEMENTATIONS; ++whichBsm) {
+        std::map<uint64_t, padded_vector_uint8_t> mapCustodyIdToBundleData;
+        std::map<uint64_t, Bpv6CbhePrimaryBlock> mapCustodyIdToPrimary;
+        for (uint64_t custodyId = 0; custodyId <= 9; ++custodyId) {
+            Bpv6CbhePrimaryBlock & primary = mapCustodyIdToPrimary[custodyId];
+            primary.SetZero();
+            primary.m_bundleProcessingControlFlags = BPV6_BUNDLEFLAG::PRIORITY_BULK | (BPV6_BUNDLEFLAG::SINGLETON | BPV6_BUNDLEFLAG::NOFRAGMENT);
+            if (custodyId == 9) {
+                primary.m_bundleProcessingControlFlags |= BPV6_BUNDLEFLAG::CUSTODY_REQUESTED;
+            }
+            primary.m_sourceNodeId.Set(PRIMARY_SRC_NODE, PRIMARY_SRC_SVC);
+            primary.m_destinationEid = availableDestLinks[0];
+            primary.m_custodianEid.SetZero();
+            primary.m_creationTimestamp.secondsSinceStartOfYear2000 = 0;
+            primary.m_lifetimeSeconds = custodyId + 1; //popped in custody id order
+            primary.m_creationTimestamp.sequenceNumber = custodyId;
+            BOOST_REQUIRE(GenerateBundle(mapCustodyIdToBundleData[custodyId], primary, BUNDLE_SIZE, static_cast<uint8_t>(custodyId)));
+        }
+
+        std::unique_ptr<BundleStorageManagerBase> bsmPtr;
+        StorageConfig_ptr ptrStorageConfig = StorageConfig::CreateFromJsonFilePath(Environment::GetPathHdtnSourceRoot() / "config_files" / "storage" / "storageConfigRelativePaths.json");
+        ptrStorageConfig->m_tryToRestoreFromDisk = false; //manually set this json entry
+        ptrStorageConfig->m_autoDeleteFilesOnExit = false; //manually set this json entry
+        ptrStorageConfig->m_catalogJournalFilePath = "storeCatalog.journal";
+        ptrStorageConfig->m_catalogSnapshotIntervalRecords = 2; //compact while bundles are cached
+        ptrStorageConfig->m_ramCacheCapacityBytes = NUM_BUNDLES_CACHED * BUNDLE_SIZE;
+        if (whichBsm == 0) {
+            std::cout << "create BundleStorageManagerMT for RAM cache" << std::endl;
+            bsmPtr = boost::make_unique<BundleStorageManagerMT>(ptrStorageConfig);
+        }
+        else if (whichBsm == 1) {
+            std::cout << "create BundleStorageManagerAsio for RAM cache" << std::endl;
+            bsmPtr = boost::make_unique<BundleStorageManagerAsio>(ptrStorageConfig);
+        }
+#ifdef STORAGE_IO_URING_ENABLED
+        else {
+            std::cout << "create BundleStorageManagerIoUring for RAM cache" << std::endl;
+            bsmPtr = boost::make_unique<BundleStorageManagerIoUring>(ptrStorageConfig);
+        }
+#endif
+        BundleStorageManagerBase & bsm = *bsmPtr;
+        const BundleStorageRamCache & ramCache = bsm.GetRamCacheConstRef();
+        BOOST_REQUIRE(ramCache.IsEnabled());
+        bsm.Start();
+
+        //the RAM cache holds the newest bundles, older ones are flushed to disk
+        for (uint64_t custodyId = 0; custodyId < 8; ++custodyId) {
+            BundleStorageManagerSession_WriteToDisk sessionWrite;
+            const padded_vector_uint8_t & bundle = mapCustodyIdToBundleData[custodyId];
+            BOOST_REQUIRE_EQUAL(bsm.Push(sessionWrite, mapCustodyIdToPrimary[custodyId], bundle.size(), 0), 3);
+            BOOST_REQUIRE_EQUAL(bsm.PushAllSegments(sessionWrite, mapCustodyIdToPrimary[custodyId], custodyId, bundle.data(), bundle.size()), bundle.size());
+            BOOST_REQUIRE_EQUAL(ramCache.GetNumBundles(), std::min(custodyId + 1, NUM_BUNDLES_CACHED));
+            BOOST_REQUIRE_EQUAL(ramCache.GetTotalBundlesFlushedToDisk(), (custodyId + 1) - ramCache.GetNumBundles());
+        }
+        BOOST_REQUIRE_EQUAL(ramCache.GetNumBytes(), NUM_BUNDLES_CACHED * BUNDLE_SIZE);
+
+        //the flushed bundles are read from disk (misses)
+        BundleStorageManagerSession_ReadFromDisk sessionRead;
+        padded_vector_uint8_t dataReadBack;
+        for (uint64_t custodyId = 0; custodyId < 5; ++custodyId) {
+            BOOST_REQUIRE_EQUAL(bsm.PopTop(sessionRead, availableDestLinks), BUNDLE_SIZE);
+            BOOST_REQUIRE_EQUAL(sessionRead.custodyId, custodyId);
+            BOOST_REQUIRE(bsm.ReadAllSegments(sessionRead, dataReadBack));
+            BOOST_REQUIRE(dataReadBack == mapCustodyIdToBundleData[custodyId]);
+            BOOST_REQUIRE(bsm.RemoveReadBundleFromDisk(sessionRead));
+        }
+        BOOST_REQUIRE_EQUAL(ramCache.GetTotalHits(), 0);
+        BOOST_REQUIRE_EQUAL(ramCache.GetTotalMisses(), 5);
+
+        //a bundle flushed to disk while being read from the RAM cache is read from disk thereafter
+        {
+            BOOST_REQUIRE_EQUAL(bsm.PopTop(sessionRead, availableDestLinks), BUNDLE_SIZE);
+            BOOST_REQUIRE_EQUAL(sessionRead.custodyId, 5);
+            dataReadBack.assign(BUNDLE_SIZE, 0);
+            std::size_t totalBytesRead = bsm.TopSegment(sessionRead, dataReadBack.data());
+            BOOST_REQUIRE_EQUAL(totalBytesRead, BUNDLE_STORAGE_PER_SEGMENT_SIZE);
+            BOOST_REQUIRE_EQUAL(ramCache.GetTotalHits(), 1);
+            BundleStorageManagerSession_WriteToDisk sessionWrite;
+            const padded_vector_uint8_t & bundle = mapCustodyIdToBundleData[8];
+            BOOST_REQUIRE_EQUAL(bsm.Push(sessionWrite, mapCustodyIdToPrimary[8], bundle.size(), 0), 3);
+            BOOST_REQUIRE_EQUAL(bsm.PushAllSegments(sessionWrite, mapCustodyIdToPrimary[8], 8, bundle.data(), bundle.size()), bundle.size());
+            BOOST_REQUIRE_EQUAL(ramCache.GetTotalBundlesFlushedToDisk(), 6); //custody id 5
+            while (totalBytesRead < BUNDLE_SIZE) {
+                totalBytesRead += bsm.TopSegment(sessionRead, &dataReadBack[totalBytesRead]);
+            }
+            BOOST_REQUIRE_EQUAL(totalBytesRead, BUNDLE_SIZE);
+            BOOST_REQUIRE(dataReadBack == mapCustodyIdToBundleData[5]);
+            BOOST_REQUIRE(bsm.RemoveReadBundleFromDisk(sessionRead));
+        }
+
+        //a cached bundle deleted from storage is never written to disk
+        BOOST_REQUIRE_EQUAL(bsm.PopTop(sessionRead, availableDestLinks), BUNDLE_SIZE);
+        BOOST_REQUIRE_EQUAL(sessionRead.custodyId, 6);
+        BOOST_REQUIRE(bsm.ReadAllSegments(sessionRead, dataReadBack));
+        BOOST_REQUIRE(dataReadBack == mapCustodyIdToBundleData[6]);
+        BOOST_REQUIRE(bsm.RemoveReadBundleFromDisk(sessionRead));
+        BOOST_REQUIRE_EQUAL(ramCache.GetTotalHits(), 2);
+        BOOST_REQUIRE_EQUAL(ramCache.GetTotalMisses(), 5);
+        BOOST_REQUIRE_EQUAL(ramCache.GetTotalBundlesErasedBeforeFlush(), 1);
+        BOOST_REQUIRE_EQUAL(ramCache.GetNumBundles(), 2); //custody ids 7 and 8 are flushed on exit
+        BOOST_REQUIRE_EQUAL(ramCache.GetTotalBundlesFlushedToDisk(), 6);
+
+        //a bundle requesting custody transfer bypasses the RAM cache (written straight to disk)
+        {
+            BundleStorageManagerSession_WriteToDisk sessionWrite;
+            const padded_vector_uint8_t & bundle = mapCustodyIdToBundleData[9];
+            BOOST_REQUIRE_EQUAL(bsm.Push(sessionWrite, mapCustodyIdToPrimary[9], bundle.size(), 0), 3);
+            BOOST_REQUIRE_EQUAL(bsm.PushAllSegments(sessionWrite, mapCustodyIdToPrimary[9], 9, bundle.data(), bundle.size()), bundle.size());
+            BOOST_REQUIRE_EQUAL(ramCache.GetNumBundles(), 2);
+            BOOST_REQUIRE_EQUAL(ramCache.GetTotalBundlesFlushedToDisk(), 6);
+        }
+        bsmPtr.reset();
+
+        ptrStorageConfig->m_tryToRestoreFromDisk = true;
+        ptrStorageConfig->m_autoDeleteFilesOnExit = true;
+        if (whichBsm == 0) {
+            bsmPtr = boost::make_unique<BundleStorageManagerMT>(ptrStorageConfig);
+        }
+        else if (whichBsm == 1) {
+            bsmPtr = boost::make_unique<BundleStorageManagerAsio>(ptrStorageConfig);
+        }
+#ifdef STORAGE_IO_URING_ENABLED
+        else {
+            bsmPtr = boost::make_unique<BundleStorageManagerIoUring>(ptrStorageConfig);
+        }
+#endif
+        BundleStorageManagerBase & bsmRestored = *bsmPtr;
+        BOOST_REQUIRE(bsmRestored.m_successfullyRestoredFromCatalogJournal);
+        BOOST_REQUIRE_EQUAL(bsmRestored.m_totalBundlesRestored, 3);
+        bsmRestored.Start();
+        for (uint64_t custodyId = 7; custodyId <= 9; ++custodyId) {
+            BOOST_REQUIRE_EQUAL(bsmRestored.PopTop(sessionRead, availableDestLinks), BUNDLE_SIZE);
+            BOOST_REQUIRE_EQUAL(sessionRead.custodyId, custodyId);
+            BOOST_REQUIRE(bsmRestored.ReadAllSegments(sessionRead, dataReadBack));
+            BOOST_REQUIRE(dataReadBack == mapCustodyIdToBundleData[custodyId]);
+            BOOST_REQUIRE(bsmRestored.RemoveReadBundleFromDisk(sessionRead));
         }
+        BOOST_REQUIRE_EQUAL(bsmRestored.GetRamCacheConstRef().GetTotalMisses(), 3);
+        BOOST_REQUIRE_EQUAL(bsmRestored.GetUsedSpaceBytes(), 0);
     }
 }
@@ -337,3 +337,75 @@ BOOST_AUTO_TEST_CASE(MemoryManagerTreeArrayFullTestCase)
         BOOST_REQUIRE(t.AllocateSegmentId_NotThreadSafe(i));
     }
 }
+
+BOOST_AUTO_TEST_CASE(MemoryManagerTreeArrayRestoreFromVectorTestCase)
+{
+    const uint64_t MAX_SEGMENTS = (64 * 64 * 64) + 5;
+    MemoryManagerTreeArray t(MAX_SEGMENTS);
+    for (segment_id_t i = 0; i < MAX_SEGMENTS; i += 3) {
+        BOOST_REQUIRE(t.AllocateSegmentId_NotThreadSafe(i));
+    }
+    memmanager_t backup;
+    t.BackupDataToVector(backup);
+
+    MemoryManagerTreeArray t2(MAX_SEGMENTS);
+    BOOST_REQUIRE(t2.RestoreDataFromVector(backup));
+    BOOST_REQUIRE(t2.IsBackupEqual(backup));
+    BOOST_REQUIRE_EQUAL(t2.GetNumAllocatedSegments_NotThreadSafe(), t.GetNumAllocatedSegments_NotThreadSafe());
+    for (segment_id_t i = 0; i < MAX_SEGMENTS; ++i) {
+        BOOST_REQUIRE_EQUAL(t2.IsSegmentFree(i), ((i % 3) != 0));
+    }
+    //the restored tree shall continue to allocate the first free segment
+    BOOST_REQUIRE_EQUAL(t2.GetAndSetFirstFreeSegmentId_NotThreadSafe(), 1);
+
+    //a backup from a different sized tree shall be rejected
+    MemoryManagerTreeArray t3(64);
+    BOOST_REQUIRE(!t3.RestoreDataFromVector(backup));
+    BOOST_REQUIRE_EQUAL(t3.GetNumAllocatedSegments_NotThreadSafe(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(MemoryManagerTreeArrayContiguousAllocationTestCase)
+{
+    const uint64_t MAX_SEGMENTS = (64 * 64) + 5;
+    MemoryManagerTreeArray t(MAX_SEGMENTS);
+    //fragment the first 200 segments: every third segment is free
+    for (segment_id_t i = 0; i < 200; ++i) {
+        BOOST_REQUIRE(t.AllocateSegmentId_NotThreadSafe(i));
+    }
+    for (segment_id_t i = 0; i < 200; i += 3) {
+        BOOST_REQUIRE(t.FreeSegmentId_NotThreadSafe(i));
+    }
+    //a multi-segment allocation skips the holes and takes a contiguous run
+    segment_id_chain_vec_t segmentVec(100);
+    BOOST_REQUIRE(t.AllocateSegments_ThreadSafe(segmentVec));
+    BOOST_REQUIRE_EQUAL(segmentVec.size(), 100);
+    for (std::size_t i = 0; i < segmentVec.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(segmentVec[i], 200 + i);
+    }
+    //a single segment allocation still fills the first hole
+    segment_id_chain_vec_t singleVec(1);
+    BOOST_REQUIRE(t.AllocateSegments_ThreadSafe(singleVec));
+    BOOST_REQUIRE_EQUAL(singleVec[0], 0);
+    //freeing 7 and 8 joins them with the hole at 6, so a run of 2 is taken from the start of it (leaving 8 as a hole)
+    BOOST_REQUIRE(t.FreeSegmentId_NotThreadSafe(7));
+    BOOST_REQUIRE(t.FreeSegmentId_NotThreadSafe(8));
+    segment_id_chain_vec_t pairVec(2);
+    BOOST_REQUIRE(t.AllocateSegments_ThreadSafe(pairVec));
+    BOOST_REQUIRE_EQUAL(pairVec[0], 6);
+    BOOST_REQUIRE_EQUAL(pairVec[1], 7);
+    //a run can never extend past the last segment
+    const uint64_t numFreeAtEnd = MAX_SEGMENTS - 300;
+    segment_id_chain_vec_t tooLargeVec(numFreeAtEnd + 1);
+    BOOST_REQUIRE(!t.AllocateContiguousSegments_NotThreadSafe(tooLargeVec));
+    //with no long enough run, allocation falls back to first fit (using up the holes first)
+    const uint64_t numHoles = 66; //segments 3, 8, 9, 12, ..., 198
+    segment_id_chain_vec_t fallbackVec(numFreeAtEnd + 1);
+    BOOST_REQUIRE(t.AllocateSegments_ThreadSafe(fallbackVec));
+    BOOST_REQUIRE_EQUAL(fallbackVec.front(), 3);
+    BOOST_REQUIRE_EQUAL(fallbackVec[numHoles], 300);
+    BOOST_REQUIRE_EQUAL(t.GetNumAllocatedSegments_NotThreadSafe(), 300 - numHoles + numFreeAtEnd + 1);
+    //full
+    segment_id_chain_vec_t fullVec(numHoles);
+    BOOST_REQUIRE(!t.AllocateSegments_ThreadSafe(fullVec));
+    BOOST_REQUIRE(fullVec.empty());
+}
@@ -0,0 +1,125 @@
+/**
+ * @file TestBatchMessages.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "message.hpp"
+#include "ZmqBatchMessage.h"
+#include "zmq.hpp"
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(IngressUniqueIdAckRangeTryAppendTestCase)
+{
+    hdtn::IngressUniqueIdAckRange range = { 10, 1, 3 };
+    BOOST_REQUIRE(range.TryAppend(11, 3)); //next consecutive id, same outduct
+    BOOST_REQUIRE_EQUAL(range.numIngressUniqueIds, 2);
+    BOOST_REQUIRE(!range.TryAppend(13, 3)); //gap
+    BOOST_REQUIRE(!range.TryAppend(11, 3)); //already in range
+    BOOST_REQUIRE(!range.TryAppend(12, 4)); //consecutive but different outduct
+    BOOST_REQUIRE(!range.TryAppend(12, UINT64_MAX)); //consecutive but stored (no outduct)
+    BOOST_REQUIRE_EQUAL(range.numIngressUniqueIds, 2);
+    BOOST_REQUIRE(range.TryAppend(12, 3));
+    BOOST_REQUIRE_EQUAL(range.firstIngressUniqueId, 10);
+    BOOST_REQUIRE_EQUAL(range.numIngressUniqueIds, 3);
+    BOOST_REQUIRE_EQUAL(range.outductIndex, 3);
+}
+
+static bool ReceiveBatchHeader(zmq::socket_t& socket, hdtn::ToStorageHdr& batchHdr) {
+    const zmq::recv_buffer_result_t res = socket.recv(zmq::mutable_buffer(&batchHdr, sizeof(batchHdr)), zmq::recv_flags::none);
+    return res && (!res->truncated()) && (res->size == sizeof(batchHdr));
+}
+
+BOOST_AUTO_TEST_CASE(StoreBatchMessageRoundTripTestCase)
+{
+    zmq::context_t ctx;
+    zmq::socket_t sender(ctx, zmq::socket_type::pair);
+    zmq::socket_t receiver(ctx, zmq::socket_type::pair);
+    receiver.bind("inproc://TestStoreBatchMessage");
+    sender.connect("inproc://TestStoreBatchMessage");
+
+    static const std::vector<std::string> BUNDLE_STRINGS = { "bundle zero", "b1", "bundle number two" };
+    std::vector<hdtn::ToStorageHdr> headers(BUNDLE_STRINGS.size());
+    std::vector<zmq::message_t> bundles;
+    for (std::size_t i = 0; i < BUNDLE_STRINGS.size(); ++i) {
+        headers[i].base.type = HDTN_MSGTYPE_STORE;
+        headers[i].ingressUniqueId = 100 + i;
+        headers[i].outductIndex = (i == 2) ? UINT64_MAX : 7;
+        headers[i].dontStoreBundle = (i == 0);
+        headers[i].finalDestEid.Set(10 + i, 1);
+        bundles.emplace_back(BUNDLE_STRINGS[i].data(), BUNDLE_STRINGS[i].size());
+    }
+    BOOST_REQUIRE_EQUAL(hdtn::SendBatchMessage(sender, HDTN_MSGTYPE_STORE_BATCH, headers, bundles), BUNDLE_STRINGS.size());
+
+    hdtn::ToStorageHdr batchHdr;
+    BOOST_REQUIRE(ReceiveBatchHeader(receiver, batchHdr));
+    BOOST_REQUIRE_EQUAL(batchHdr.base.type, HDTN_MSGTYPE_STORE_BATCH);
+    std::vector<hdtn::ToStorageHdr> receivedHeaders;
+    std::vector<zmq::message_t> receivedBundles;
+    BOOST_REQUIRE(hdtn::ReceiveBatchMessage(receiver, receivedHeaders, receivedBundles));
+    BOOST_REQUIRE_EQUAL(receivedHeaders.size(), BUNDLE_STRINGS.size());
+    BOOST_REQUIRE_EQUAL(receivedBundles.size(), BUNDLE_STRINGS.size());
+    for (std::size_t i = 0; i < BUNDLE_STRINGS.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(receivedHeaders[i].base.type, HDTN_MSGTYPE_STORE);
+        BOOST_REQUIRE_EQUAL(receivedHeaders[i].ingressUniqueId, 100 + i);
+        BOOST_REQUIRE_EQUAL(receivedHeaders[i].outductIndex, headers[i].outductIndex);
+        BOOST_REQUIRE_EQUAL(receivedHeaders[i].dontStoreBundle, headers[i].dontStoreBundle);
+        BOOST_REQUIRE(receivedHeaders[i].finalDestEid == headers[i].finalDestEid);
+        BOOST_REQUIRE_EQUAL(receivedBundles[i].to_string(), BUNDLE_STRINGS[i]);
+    }
+    BOOST_REQUIRE(!receiver.get(zmq::sockopt::rcvmore));
+}
+
+BOOST_AUTO_TEST_CASE(MalformedBatchMessageIsDiscardedTestCase)
+{
+    zmq::context_t ctx;
+    zmq::socket_t sender(ctx, zmq::socket_type::pair);
+    zmq::socket_t receiver(ctx, zmq::socket_type::pair);
+    receiver.bind("inproc://TestMalformedBatchMessage");
+    sender.connect("inproc://TestMalformedBatchMessage");
+
+    hdtn::ToStorageHdr batchHdr = hdtn::ToStorageHdr();
+    batchHdr.base.type = HDTN_MSGTYPE_STORE_BATCH;
+    hdtn::ToStorageHdr nextHdr = hdtn::ToStorageHdr();
+    nextHdr.base.type = HDTN_MSGTYPE_STORE;
+    nextHdr.ingressUniqueId = 5555;
+    static const std::string BUNDLE_STRING("bundle");
+
+    //headers part not a multiple of the header size, followed by a bundle part
+    BOOST_REQUIRE(sender.send(zmq::const_buffer(&batchHdr, sizeof(batchHdr)), zmq::send_flags::sndmore));
+    BOOST_REQUIRE(sender.send(zmq::const_buffer(&batchHdr, sizeof(batchHdr) - 1), zmq::send_flags::sndmore));
+    BOOST_REQUIRE(sender.send(zmq::const_buffer(BUNDLE_STRING.data(), BUNDLE_STRING.size()), zmq::send_flags::none));
+    //one header followed by two bundle parts
+    BOOST_REQUIRE(sender.send(zmq::const_buffer(&batchHdr, sizeof(batchHdr)), zmq::send_flags::sndmore));
+    BOOST_REQUIRE(sender.send(zmq::const_buffer(&nextHdr, sizeof(nextHdr)), zmq::send_flags::sndmore));
+    BOOST_REQUIRE(sender.send(zmq::const_buffer(BUNDLE_STRING.data(), BUNDLE_STRING.size()), zmq::send_flags::sndmore));
+    BOOST_REQUIRE(sender.send(zmq::const_buffer(BUNDLE_STRING.data(), BUNDLE_STRING.size()), zmq::send_flags::none));
+    //then a well formed single header message
+    BOOST_REQUIRE(sender.send(zmq::const_buffer(&nextHdr, sizeof(nextHdr)), zmq::send_flags::none));
+
+    std::vector<hdtn::ToStorageHdr> receivedHeaders;
+    std::vector<zmq::message_t> receivedBundles;
+    hdtn::ToStorageHdr receivedHdr;
+
+    BOOST_REQUIRE(ReceiveBatchHeader(receiver, receivedHdr));
+    BOOST_REQUIRE_EQUAL(receivedHdr.base.type, HDTN_MSGTYPE_STORE_BATCH);
+    BOOST_REQUIRE(!hdtn::ReceiveBatchMessage(receiver, receivedHeaders, receivedBundles));
+    BOOST_REQUIRE(receivedBundles.empty());
+
+    BOOST_REQUIRE(ReceiveBatchHeader(receiver, receivedHdr));
+    BOOST_REQUIRE_EQUAL(receivedHdr.base.type, HDTN_MSGTYPE_STORE_BATCH);
+    BOOST_REQUIRE(!hdtn::ReceiveBatchMessage(receiver, receivedHeaders, receivedBundles));
+    BOOST_REQUIRE_EQUAL(receivedBundles.size(), 1); //the bundle matching the one header is still usable
+    BOOST_REQUIRE_EQUAL(receivedHeaders[0].ingressUniqueId, 5555);
+
+    //the socket is not out of sync: the next recv is the next message's header
+    BOOST_REQUIRE(ReceiveBatchHeader(receiver, receivedHdr));
+    BOOST_REQUIRE_EQUAL(receivedHdr.base.type, HDTN_MSGTYPE_STORE);
+    BOOST_REQUIRE_EQUAL(receivedHdr.ingressUniqueId, 5555);
+    BOOST_REQUIRE(!receiver.get(zmq::sockopt::rcvmore));
+}
@@ -18,6 +18,8 @@
 #include <string>
 #include <inttypes.h>
 #include <set>
+#include <random>
+#include <algorithm>
 #include "codec/bpv6.h"
 #include "codec/bpv7.h"
 
@@ -411,3 +413,107 @@ BOOST_AUTO_TEST_CASE(BundleStorageCatalogMaxExpiredCase)
     }
 }
 
+
+BOOST_AUTO_TEST_CASE(BundleStorageCatalogAwaitingSendGroupTestCase)
+{
+    //the same random workload is applied to two catalogs, popping one by scanning the available destinations
+    //and the other from its indexed awaiting send group, which must yield the same bundles in the same order
+    //(expirations are unique across destinations so that neither pop has to break a tie)
+    BundleStorageCatalog bscScan;
+    BundleStorageCatalog bscGroup;
+    std::vector<std::pair<cbhe_eid_t, bool> > availableDests = {
+        { cbhe_eid_t(10, 1), false },
+        { cbhe_eid_t(11, 0), true },
+        { cbhe_eid_t(12, 5), false },
+        { cbhe_eid_t(12, 0), true } //also contains 12.5
+    };
+    const std::vector<std::pair<cbhe_eid_t, bool> > otherAvailableDests = { { cbhe_eid_t(13, 0), true } };
+    const uint64_t groupId = bscGroup.AddAwaitingSendGroup(availableDests); //before any of its destinations exist
+    const uint64_t otherGroupId = bscGroup.AddAwaitingSendGroup(otherAvailableDests);
+    BOOST_REQUIRE_NE(groupId, otherGroupId);
+    BOOST_REQUIRE(!bscGroup.UpdateAwaitingSendGroup(otherGroupId + 1, otherAvailableDests));
+
+    const cbhe_eid_t destEids[7] = { cbhe_eid_t(10, 1), cbhe_eid_t(10, 2), cbhe_eid_t(11, 1), cbhe_eid_t(11, 2), cbhe_eid_t(12, 5), cbhe_eid_t(12, 6), cbhe_eid_t(13, 1) };
+    const BPV6_BUNDLEFLAG priorities[3] = { BPV6_BUNDLEFLAG::PRIORITY_BULK, BPV6_BUNDLEFLAG::PRIORITY_NORMAL, BPV6_BUNDLEFLAG::PRIORITY_EXPEDITED };
+    std::mt19937 gen(12345);
+    std::vector<uint64_t> awaitingSendCustodyIds;
+    uint64_t nextCustodyId = 0;
+    uint64_t numPopped = 0;
+    for (unsigned int iteration = 0; iteration < 20000; ++iteration) {
+        if (iteration == 10000) {
+            availableDests = { { cbhe_eid_t(10, 0), true }, { cbhe_eid_t(11, 2), false } };
+            BOOST_REQUIRE(bscGroup.UpdateAwaitingSendGroup(groupId, availableDests));
+        }
+        const unsigned int action = gen() % 4;
+        if ((action <= 1) || awaitingSendCustodyIds.empty()) { //add
+            const uint64_t custodyId = nextCustodyId++;
+            Bpv6CbhePrimaryBlock primary;
+            CreatePrimaryV6(primary, cbhe_eid_t(500, 500), destEids[gen() % 7], true, 1000 + custodyId, custodyId, priorities[gen() % 3]);
+            for (unsigned int whichCatalog = 0; whichCatalog < 2; ++whichCatalog) {
+                catalog_entry_t catalogEntryToTake;
+                catalogEntryToTake.Init(primary, 1000, 800, 1, NULL);
+                catalogEntryToTake.segmentIdChainVec = { static_cast<segment_id_t>(custodyId) };
+                BundleStorageCatalog & bsc = (whichCatalog == 0) ? bscScan : bscGroup;
+                BOOST_REQUIRE(bsc.CatalogIncomingBundleForStore(catalogEntryToTake, primary, custodyId, BundleStorageCatalog::DUPLICATE_EXPIRY_ORDER::FIFO));
+            }
+            awaitingSendCustodyIds.push_back(custodyId);
+        }
+        else if (action == 2) { //pop, then either return it or delete it
+            uint64_t custodyIdScan;
+            uint64_t custodyIdGroup;
+            catalog_entry_t * entryScan = bscScan.PopEntryFromAwaitingSend(custodyIdScan, availableDests);
+            catalog_entry_t * entryGroup = bscGroup.PopEntryFromAwaitingSendGroup(custodyIdGroup, groupId);
+            BOOST_REQUIRE_EQUAL((entryScan == NULL), (entryGroup == NULL));
+            if (entryScan) {
+                BOOST_REQUIRE_EQUAL(custodyIdScan, custodyIdGroup);
+                ++numPopped;
+                if (gen() % 2) {
+                    BOOST_REQUIRE(bscScan.ReturnEntryToAwaitingSend(*entryScan, custodyIdScan));
+                    BOOST_REQUIRE(bscGroup.ReturnEntryToAwaitingSend(*entryGroup, custodyIdGroup));
+                }
+                else {
+                    BOOST_REQUIRE(bscScan.Remove(custodyIdScan, false).first);
+                    BOOST_REQUIRE(bscGroup.Remove(custodyIdGroup, false).first);
+                    awaitingSendCustodyIds.erase(std::find(awaitingSendCustodyIds.begin(), awaitingSendCustodyIds.end(), custodyIdScan));
+                }
+            }
+        }
+        else { //delete a random bundle that is awaiting send
+            const std::size_t index = gen() % awaitingSendCustodyIds.size();
+            const uint64_t custodyId = awaitingSendCustodyIds[index];
+            awaitingSendCustodyIds[index] = awaitingSendCustodyIds.back();
+            awaitingSendCustodyIds.pop_back();
+            BOOST_REQUIRE(bscScan.Remove(custodyId, true).first);
+            BOOST_REQUIRE(bscGroup.Remove(custodyId, true).first);
+        }
+    }
+    BOOST_REQUIRE_GT(numPopped, 1000);
+
+    //drain both groups
+    for (unsigned int whichGroup = 0; whichGroup < 2; ++whichGroup) {
+        const std::vector<std::pair<cbhe_eid_t, bool> > & dests = (whichGroup == 0) ? availableDests : otherAvailableDests;
+        const uint64_t id = (whichGroup == 0) ? groupId : otherGroupId;
+        uint64_t numDrained = 0;
+        while (true) {
+            uint64_t custodyIdScan;
+            uint64_t custodyIdGroup;
+            catalog_entry_t * entryScan = bscScan.PopEntryFromAwaitingSend(custodyIdScan, dests);
+            catalog_entry_t * entryGroup = bscGroup.PopEntryFromAwaitingSendGroup(custodyIdGroup, id);
+            BOOST_REQUIRE_EQUAL((entryScan == NULL), (entryGroup == NULL));
+            if (entryScan == NULL) {
+                break;
+            }
+            BOOST_REQUIRE_EQUAL(custodyIdScan, custodyIdGroup);
+            ++numDrained;
+        }
+        BOOST_REQUIRE_GT(numDrained, 0);
+    }
+
+    uint64_t custodyId;
+    BOOST_REQUIRE(bscGroup.RemoveAwaitingSendGroup(groupId));
+    BOOST_REQUIRE(!bscGroup.RemoveAwaitingSendGroup(groupId));
+    BOOST_REQUIRE(bscGroup.PopEntryFromAwaitingSendGroup(custodyId, groupId) == NULL);
+    //bundles for 12.6 are in neither group
+    const std::vector<std::pair<cbhe_eid_t, bool> > remainingDests = { { cbhe_eid_t(12, 6), false } };
+    BOOST_REQUIRE(bscGroup.PopEntryFromAwaitingSend(custodyId, remainingDests) != NULL);
+}
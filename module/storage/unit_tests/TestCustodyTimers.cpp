@@ -15,10 +15,11 @@
 #include <boost/test/unit_test.hpp>
 #include <iostream>
 #include "CustodyTimers.h"
+#include "CustodyTimersTimingWheel.h"
 #include <boost/thread.hpp>
 
-    
-BOOST_AUTO_TEST_CASE(CustodyTimersTestCase)
+template <typename CustodyTimersType>
+static void CustodyTimersTest()
 {
     static const cbhe_eid_t EID1(5, 5);
     static const cbhe_eid_t EID2(10, 5);
@@ -29,7 +30,7 @@ BOOST_AUTO_TEST_CASE(CustodyTimersTestCase)
 
     //never expire
     {
-        CustodyTimers ct(boost::posix_time::seconds(10000));
+        CustodyTimersType ct(boost::posix_time::seconds(10000));
         const boost::posix_time::ptime nowPtime = boost::posix_time::microsec_clock::universal_time();
         BOOST_REQUIRE_EQUAL(ct.GetNumCustodyTransferTimers(), 0);
         BOOST_REQUIRE_EQUAL(ct.GetNumCustodyTransferTimers(EID1), 0);
@@ -72,7 +73,7 @@ BOOST_AUTO_TEST_CASE(CustodyTimersTestCase)
 
     //always expire
     {
-        CustodyTimers ct(boost::posix_time::seconds(0));
+        CustodyTimersType ct(boost::posix_time::seconds(0));
         BOOST_REQUIRE_EQUAL(ct.GetNumCustodyTransferTimers(), 0);
         BOOST_REQUIRE_EQUAL(ct.GetNumCustodyTransferTimers(EID1), 0);
         BOOST_REQUIRE_EQUAL(ct.GetNumCustodyTransferTimers(EID2), 0);
@@ -158,6 +159,82 @@ BOOST_AUTO_TEST_CASE(CustodyTimersTestCase)
         BOOST_REQUIRE_GE(returnedCid, 1);
         BOOST_REQUIRE_LE(returnedCid, 10 + 200);
     }
+}
+
+BOOST_AUTO_TEST_CASE(CustodyTimersTestCase)
+{
+    CustodyTimersTest<CustodyTimers>();
+}
+
+BOOST_AUTO_TEST_CASE(CustodyTimersTimingWheelTestCase)
+{
+    CustodyTimersTest<CustodyTimersTimingWheel>();
 
+    static const cbhe_eid_t EID1(5, 5);
+    static const cbhe_eid_t EID2(10, 5);
+    static const std::vector<cbhe_eid_t> JUST_EID2_AVAILABLE_VEC = { EID2 };
 
+    //expiries many wheel levels away (polled with future times) are cascaded down and expire in fifo order, never early
+    {
+        const boost::posix_time::time_duration timeout = boost::posix_time::seconds(10000);
+        CustodyTimersTimingWheel ct(timeout);
+        const boost::posix_time::ptime startPtime = boost::posix_time::microsec_clock::universal_time();
+        for (uint64_t cid = 1; cid <= 10; ++cid) {
+            BOOST_REQUIRE(ct.StartCustodyTransferTimer(EID1, cid));
+            BOOST_REQUIRE(ct.StartCustodyTransferTimer(EID2, cid + 100));
+            boost::this_thread::sleep(boost::posix_time::milliseconds(2)); //spread over several ticks
+        }
+        const boost::posix_time::ptime lastStartPtime = boost::posix_time::microsec_clock::universal_time();
+        uint64_t returnedCid = 0;
+        for (boost::posix_time::time_duration t = boost::posix_time::seconds(1); t < timeout; t *= 2) {
+            BOOST_REQUIRE(!ct.PollOneAndPopAnyExpiredCustodyTimer(returnedCid, startPtime + t));
+        }
+        BOOST_REQUIRE(!ct.PollOneAndPopAnyExpiredCustodyTimer(returnedCid, startPtime + timeout - boost::posix_time::milliseconds(1)));
+        BOOST_REQUIRE(ct.CancelCustodyTransferTimer(EID1, 5)); //cancel from the wheel
+        BOOST_REQUIRE(!ct.CancelCustodyTransferTimer(EID2, 6)); //wrong destination
+        BOOST_REQUIRE_EQUAL(ct.GetNumCustodyTransferTimers(), 19);
+        const boost::posix_time::ptime allExpiredPtime = lastStartPtime + timeout + boost::posix_time::milliseconds(1);
+        for (uint64_t cid = 101; cid <= 110; ++cid) {
+            BOOST_REQUIRE(ct.PollOneAndPopExpiredCustodyTimer(returnedCid, JUST_EID2_AVAILABLE_VEC, allExpiredPtime));
+            BOOST_REQUIRE_EQUAL(returnedCid, cid); //fifo order
+        }
+        BOOST_REQUIRE(!ct.PollOneAndPopExpiredCustodyTimer(returnedCid, JUST_EID2_AVAILABLE_VEC, allExpiredPtime));
+        BOOST_REQUIRE(ct.CancelCustodyTransferTimer(EID1, 6)); //cancel from the expired list
+        for (uint64_t cid = 1; cid <= 10; ++cid) {
+            if ((cid == 5) || (cid == 6)) {
+                continue;
+            }
+            BOOST_REQUIRE(ct.PollOneAndPopAnyExpiredCustodyTimer(returnedCid, allExpiredPtime));
+            BOOST_REQUIRE_EQUAL(returnedCid, cid); //fifo order
+        }
+        BOOST_REQUIRE(!ct.PollOneAndPopAnyExpiredCustodyTimer(returnedCid, allExpiredPtime));
+        BOOST_REQUIRE_EQUAL(ct.GetNumCustodyTransferTimers(), 0);
+        BOOST_REQUIRE_EQUAL(ct.GetNumCustodyTransferTimers(EID1), 0);
+
+        //timers started with an expiry the wheel has already advanced past expire immediately (nodes are reused)
+        for (uint64_t cid = 1; cid <= 10; ++cid) {
+            BOOST_REQUIRE(ct.StartCustodyTransferTimer(EID1, cid));
+        }
+        BOOST_REQUIRE_EQUAL(ct.GetNumCustodyTransferTimers(EID1), 10);
+        for (uint64_t cid = 1; cid <= 10; ++cid) {
+            BOOST_REQUIRE(ct.PollOneAndPopAnyExpiredCustodyTimer(returnedCid, allExpiredPtime));
+            BOOST_REQUIRE_EQUAL(returnedCid, cid); //fifo order
+        }
+        BOOST_REQUIRE_EQUAL(ct.GetNumCustodyTransferTimers(), 0);
+    }
+
+    //an expiry beyond the reach of the top level (about 2 years at 1 ms ticks) is held there until it is in reach
+    {
+        const boost::posix_time::time_duration timeout = boost::posix_time::hours(24 * 365 * 3);
+        CustodyTimersTimingWheel ct(timeout);
+        const boost::posix_time::ptime startPtime = boost::posix_time::microsec_clock::universal_time();
+        BOOST_REQUIRE(ct.StartCustodyTransferTimer(EID1, 1));
+        uint64_t returnedCid = 0;
+        for (boost::posix_time::time_duration t = boost::posix_time::hours(1); t < timeout; t += boost::posix_time::hours(24 * 30)) {
+            BOOST_REQUIRE(!ct.PollOneAndPopAnyExpiredCustodyTimer(returnedCid, startPtime + t));
+        }
+        BOOST_REQUIRE(!ct.PollOneAndPopAnyExpiredCustodyTimer(returnedCid, startPtime + timeout - boost::posix_time::seconds(1)));
+        BOOST_REQUIRE(ct.PollOneAndPopAnyExpiredCustodyTimer(returnedCid, startPtime + timeout + boost::posix_time::seconds(1)));
+        BOOST_REQUIRE_EQUAL(returnedCid, 1);
+    }
 }
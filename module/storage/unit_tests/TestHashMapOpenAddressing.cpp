@@ -0,0 +1,160 @@
+/**
+ * @file TestHashMapOpenAddressing.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "HashMapOpenAddressing.h"
+#include "CatalogEntry.h"
+#include <vector>
+#include <set>
+#include <algorithm>
+
+extern template class HashMapOpenAddressing<cbhe_bundle_uuid_t, uint64_t>;
+extern template class HashMapOpenAddressing<cbhe_bundle_uuid_nofragment_t, uint64_t>;
+extern template class HashMapOpenAddressing<uint64_t, catalog_entry_t>;
+
+BOOST_AUTO_TEST_CASE(HashMapOpenAddressingUuidTestCase)
+{
+    typedef HashMapOpenAddressing<cbhe_bundle_uuid_t, uint64_t> hashmap_t;
+    hashmap_t hm;
+    std::vector<cbhe_bundle_uuid_t> uuids;
+    for (uint64_t i = 0; i < 5000; ++i) {
+        uuids.emplace_back(1000 + (i / 100), i, 10, 20, i * 3, 100); //creationSeconds, sequence, srcNodeId, srcServiceId, fragmentOffset, dataLength
+    }
+    const std::size_t initialNumSlots = hm.GetNumSlots();
+    std::vector<const hashmap_t::key_value_pair_t *> insertedPtrs;
+    for (std::size_t i = 0; i < uuids.size(); ++i) {
+        const hashmap_t::key_value_pair_t * p = hm.Insert(uuids[i], i);
+        BOOST_REQUIRE(p != NULL);
+        BOOST_REQUIRE(p->first == uuids[i]);
+        BOOST_REQUIRE_EQUAL(p->second, i);
+        insertedPtrs.push_back(p);
+        BOOST_REQUIRE(hm.Insert(uuids[i], i + 1) == NULL); //already exists
+    }
+    BOOST_REQUIRE_EQUAL(hm.GetSize(), uuids.size());
+    BOOST_REQUIRE_GT(hm.GetNumSlots(), initialNumSlots); //grew
+    BOOST_REQUIRE_LE(hm.GetSize() * 4, hm.GetNumSlots() * 3);
+
+    //pointers returned by Insert remain valid after the table grows
+    for (std::size_t i = 0; i < uuids.size(); ++i) {
+        BOOST_REQUIRE(insertedPtrs[i]->first == uuids[i]);
+        uint64_t * valuePtr = hm.GetValuePtr(uuids[i]);
+        BOOST_REQUIRE(valuePtr == &insertedPtrs[i]->second);
+        BOOST_REQUIRE_EQUAL(*valuePtr, i);
+    }
+    BOOST_REQUIRE(hm.GetValuePtr(cbhe_bundle_uuid_t(1, 2, 3, 4, 5, 6)) == NULL);
+
+    //remove every third using the key stored in the map (as the catalog does with ptrUuidKeyInMap),
+    //everything else must still be found (tests backward shift deletion)
+    for (std::size_t i = 0; i < uuids.size(); i += 3) {
+        uint64_t value = 0;
+        BOOST_REQUIRE(hm.GetValueAndRemove(insertedPtrs[i]->first, value));
+        BOOST_REQUIRE_EQUAL(value, i);
+        BOOST_REQUIRE(!hm.GetValueAndRemove(uuids[i], value)); //already removed
+    }
+    for (std::size_t i = 0; i < uuids.size(); ++i) {
+        uint64_t * valuePtr = hm.GetValuePtr(uuids[i]);
+        if ((i % 3) == 0) {
+            BOOST_REQUIRE(valuePtr == NULL);
+        }
+        else {
+            BOOST_REQUIRE(valuePtr != NULL);
+            BOOST_REQUIRE_EQUAL(*valuePtr, i);
+        }
+    }
+    BOOST_REQUIRE_EQUAL(hm.GetSize(), uuids.size() - ((uuids.size() + 2) / 3));
+
+    //reinsert (reuses the removed key value pairs)
+    for (std::size_t i = 0; i < uuids.size(); i += 3) {
+        BOOST_REQUIRE(hm.Insert(uuids[i], i + 100000) != NULL);
+    }
+    BOOST_REQUIRE_EQUAL(hm.GetSize(), uuids.size());
+    std::vector<cbhe_bundle_uuid_t> keys;
+    hm.GetKeys(keys);
+    BOOST_REQUIRE_EQUAL(keys.size(), uuids.size());
+    std::sort(keys.begin(), keys.end());
+    std::vector<cbhe_bundle_uuid_t> sortedUuids(uuids);
+    std::sort(sortedUuids.begin(), sortedUuids.end());
+    BOOST_REQUIRE(keys == sortedUuids);
+
+    hm.Clear();
+    BOOST_REQUIRE_EQUAL(hm.GetSize(), 0);
+    BOOST_REQUIRE_EQUAL(hm.GetNumSlots(), initialNumSlots);
+    BOOST_REQUIRE(hm.GetValuePtr(uuids[1]) == NULL);
+    BOOST_REQUIRE(hm.Insert(uuids[1], 1) != NULL);
+}
+
+BOOST_AUTO_TEST_CASE(HashMapOpenAddressingCollisionTestCase)
+{
+    //bypass the hashing algorithm so that every key shares a probe sequence (or wraps around the end of the slots)
+    typedef HashMapOpenAddressing<cbhe_bundle_uuid_nofragment_t, uint64_t> hashmap_t;
+    for (unsigned int whichHash = 0; whichHash < 2; ++whichHash) {
+        const uint32_t HASH = (whichHash == 0) ? 1 : UINT32_MAX;
+        hashmap_t hm;
+        for (uint64_t i = 0; i < 100; ++i) {
+            BOOST_REQUIRE(hm.Insert(HASH, cbhe_bundle_uuid_nofragment_t(1000, i, 10, 20), i) != NULL);
+        }
+        for (uint64_t i = 0; i < 100; ++i) {
+            BOOST_REQUIRE(hm.Insert(HASH, cbhe_bundle_uuid_nofragment_t(1000, i, 10, 20), i) == NULL);
+        }
+        //remove from the middle, the front, and the back of the shared probe sequence
+        const uint64_t toRemove[3] = { 50, 0, 99 };
+        for (unsigned int j = 0; j < 3; ++j) {
+            uint64_t value = 0;
+            BOOST_REQUIRE(hm.GetValueAndRemove(HASH, cbhe_bundle_uuid_nofragment_t(1000, toRemove[j], 10, 20), value));
+            BOOST_REQUIRE_EQUAL(value, toRemove[j]);
+        }
+        for (uint64_t i = 0; i < 100; ++i) {
+            uint64_t * valuePtr = hm.GetValuePtr(HASH, cbhe_bundle_uuid_nofragment_t(1000, i, 10, 20));
+            if ((i == 0) || (i == 50) || (i == 99)) {
+                BOOST_REQUIRE(valuePtr == NULL);
+            }
+            else {
+                BOOST_REQUIRE(valuePtr != NULL);
+                BOOST_REQUIRE_EQUAL(*valuePtr, i);
+            }
+        }
+        BOOST_REQUIRE_EQUAL(hm.GetSize(), 97);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(HashMapOpenAddressingCustodyIdTestCase)
+{
+    typedef HashMapOpenAddressing<uint64_t, catalog_entry_t> hashmap_t;
+    hashmap_t hm;
+    hm.Reserve(20000);
+    const std::size_t numSlotsAfterReserve = hm.GetNumSlots();
+    BOOST_REQUIRE_GE(numSlotsAfterReserve * 3, 20000 * 4);
+    std::set<uint64_t> expectedKeys;
+    for (uint64_t custodyId = 0; custodyId < 20000; ++custodyId) {
+        catalog_entry_t entry;
+        entry.bundleSizeBytes = custodyId;
+        entry.segmentIdChainVec.assign(1, static_cast<segment_id_t>(custodyId));
+        BOOST_REQUIRE(hm.Insert(custodyId, std::move(entry)) != NULL);
+        expectedKeys.insert(custodyId);
+    }
+    BOOST_REQUIRE_EQUAL(hm.GetNumSlots(), numSlotsAfterReserve); //no rehash needed
+    //remove a contiguous run of custody ids
+    for (uint64_t custodyId = 5000; custodyId < 15000; ++custodyId) {
+        catalog_entry_t entry;
+        BOOST_REQUIRE(hm.GetValueAndRemove(custodyId, entry));
+        BOOST_REQUIRE_EQUAL(entry.bundleSizeBytes, custodyId);
+        BOOST_REQUIRE_EQUAL(entry.segmentIdChainVec.size(), 1);
+        BOOST_REQUIRE_EQUAL(entry.segmentIdChainVec[0], custodyId);
+        expectedKeys.erase(custodyId);
+    }
+    std::vector<uint64_t> keys;
+    hm.GetKeys(keys);
+    BOOST_REQUIRE(std::set<uint64_t>(keys.begin(), keys.end()) == expectedKeys);
+    for (std::set<uint64_t>::const_iterator it = expectedKeys.cbegin(); it != expectedKeys.cend(); ++it) {
+        catalog_entry_t * entryPtr = hm.GetValuePtr(*it);
+        BOOST_REQUIRE(entryPtr != NULL);
+        BOOST_REQUIRE_EQUAL(entryPtr->bundleSizeBytes, *it);
+    }
+    BOOST_REQUIRE(hm.GetValuePtr(10000) == NULL);
+}
@@ -0,0 +1,237 @@
+/**
+ * @file TestStorageCatalogJournal.cpp
+ * @author  agent <agent@local>
+ *
+ * @section LICENSE
+ * Released under the NASA Open Source Agreement (NOSA)
+ * See LICENSE.md in the source root directory for more information.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "StorageCatalogJournal.h"
+#include "BundleStorageConfig.h"
+#include <boost/filesystem/operations.hpp>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+static const boost::filesystem::path TEST_JOURNAL_PATH("testStorageCatalog.journal");
+static constexpr uint64_t TEST_MAX_SEGMENTS = 1000;
+static constexpr unsigned int TEST_NUM_DISKS = 2;
+
+//a bundle occupying numSegments segments, with custody (and no fragmentation) if uuidPtr is not NULL
+static catalog_entry_t MakeEntry(MemoryManagerTreeArray & mm, const uint64_t numSegments, const uint64_t destNodeId, const cbhe_bundle_uuid_nofragment_t * uuidPtr) {
+    catalog_entry_t entry;
+    entry.bundleSizeBytes = (numSegments * BUNDLE_STORAGE_PER_SEGMENT_SIZE) - 1;
+    entry.payloadSizeBytes = entry.bundleSizeBytes - 50;
+    entry.destEid.Set(destNodeId, 1);
+    entry.encodedAbsExpirationAndCustodyAndPriority = 2 | (12345 << 4);
+    if (uuidPtr) {
+        entry.encodedAbsExpirationAndCustodyAndPriority |= (1U << 3);
+    }
+    entry.sequence = destNodeId * 10;
+    entry.ptrUuidKeyInMap = uuidPtr;
+    entry.segmentIdChainVec.resize(numSegments);
+    BOOST_REQUIRE(mm.AllocateSegments_ThreadSafe(entry.segmentIdChainVec));
+    return entry;
+}
+
+static void CopyTestFile(const boost::filesystem::path & from, const boost::filesystem::path & to) {
+    std::ifstream in(from.string(), std::ios::binary);
+    std::ofstream out(to.string(), std::ios::binary | std::ios::trunc);
+    out << in.rdbuf();
+}
+
+static bool EntriesMatch(const catalog_entry_t & original, const catalog_journal_restored_bundle_t & restored) {
+    return (original.bundleSizeBytes == restored.catalogEntry.bundleSizeBytes)
+        && (original.payloadSizeBytes == restored.catalogEntry.payloadSizeBytes)
+        && (original.destEid == restored.catalogEntry.destEid)
+        && (original.encodedAbsExpirationAndCustodyAndPriority == restored.catalogEntry.encodedAbsExpirationAndCustodyAndPriority)
+        && (original.sequence == restored.catalogEntry.sequence)
+        && (original.segmentIdChainVec == restored.catalogEntry.segmentIdChainVec);
+}
+
+BOOST_AUTO_TEST_CASE(StorageCatalogJournalSnapshotPlusJournalTestCase)
+{
+    boost::filesystem::remove(TEST_JOURNAL_PATH);
+    boost::filesystem::remove(boost::filesystem::path(TEST_JOURNAL_PATH).concat(".snapshot"));
+
+    MemoryManagerTreeArray mm(TEST_MAX_SEGMENTS);
+    const cbhe_bundle_uuid_nofragment_t uuid1(1000, 1, 5, 1);
+    const cbhe_bundle_uuid_nofragment_t uuid3(1000, 3, 5, 1);
+    const catalog_entry_t e1 = MakeEntry(mm, 3, 101, &uuid1);
+    const catalog_entry_t e2 = MakeEntry(mm, 1, 102, NULL);
+    const catalog_entry_t e3 = MakeEntry(mm, 2, 103, &uuid3);
+    const catalog_entry_t e4 = MakeEntry(mm, 4, 104, NULL);
+
+    {
+        StorageCatalogJournal journal(TEST_JOURNAL_PATH, TEST_MAX_SEGMENTS, TEST_NUM_DISKS);
+        BOOST_REQUIRE(!journal.IsOpen());
+        BOOST_REQUIRE(!journal.LogRemove(1)); //not open until the first snapshot
+
+        //snapshot e1 and e2 (the bitmap must describe exactly the snapshot entries)
+        MemoryManagerTreeArray mmSnapshot(TEST_MAX_SEGMENTS);
+        for (std::size_t i = 0; i < e1.segmentIdChainVec.size(); ++i) {
+            BOOST_REQUIRE(mmSnapshot.AllocateSegmentId_NotThreadSafe(e1.segmentIdChainVec[i]));
+        }
+        for (std::size_t i = 0; i < e2.segmentIdChainVec.size(); ++i) {
+            BOOST_REQUIRE(mmSnapshot.AllocateSegmentId_NotThreadSafe(e2.segmentIdChainVec[i]));
+        }
+        memmanager_t backup;
+        mmSnapshot.BackupDataToVector(backup);
+        std::vector<std::pair<uint64_t, const catalog_entry_t*> > entries;
+        entries.emplace_back(11, &e1);
+        entries.emplace_back(12, &e2);
+        BOOST_REQUIRE(journal.WriteSnapshot(backup, entries));
+        BOOST_REQUIRE(journal.IsOpen());
+        BOOST_REQUIRE_EQUAL(journal.GetGeneration(), 1);
+
+        //journal e3 and e4 stored, then e1 removed
+        BOOST_REQUIRE(journal.LogStore(13, e3));
+        BOOST_REQUIRE(journal.LogStore(14, e4));
+        BOOST_REQUIRE(journal.LogRemove(11));
+        BOOST_REQUIRE_EQUAL(journal.GetNumRecordsSinceSnapshot(), 3);
+    }
+
+    //restore (as if the process crashed without taking a final snapshot)
+    {
+        StorageCatalogJournal journal(TEST_JOURNAL_PATH, TEST_MAX_SEGMENTS, TEST_NUM_DISKS);
+        BOOST_REQUIRE_EQUAL(journal.GetGeneration(), 1);
+        MemoryManagerTreeArray mmRestored(TEST_MAX_SEGMENTS);
+        std::vector<catalog_journal_restored_bundle_t> restored;
+        BOOST_REQUIRE(journal.Load(mmRestored, restored));
+        BOOST_REQUIRE_EQUAL(restored.size(), 3);
+        BOOST_REQUIRE_EQUAL(restored[0].custodyId, 12);
+        BOOST_REQUIRE(EntriesMatch(e2, restored[0]));
+        BOOST_REQUIRE_EQUAL(restored[1].custodyId, 13);
+        BOOST_REQUIRE(EntriesMatch(e3, restored[1]));
+        BOOST_REQUIRE(cbhe_bundle_uuid_nofragment_t(restored[1].bundleUuid) == uuid3);
+        BOOST_REQUIRE_EQUAL(restored[2].custodyId, 14);
+        BOOST_REQUIRE(EntriesMatch(e4, restored[2]));
+        BOOST_REQUIRE(restored[2].catalogEntry.ptrUuidKeyInMap == NULL);
+
+        //segments of e2, e3, e4 are allocated, e1's are free
+        BOOST_REQUIRE_EQUAL(mmRestored.GetNumAllocatedSegments_NotThreadSafe(), 1 + 2 + 4);
+        for (std::size_t i = 0; i < e1.segmentIdChainVec.size(); ++i) {
+            BOOST_REQUIRE(mmRestored.IsSegmentFree(e1.segmentIdChainVec[i]));
+        }
+        for (std::size_t i = 0; i < e4.segmentIdChainVec.size(); ++i) {
+            BOOST_REQUIRE(!mmRestored.IsSegmentFree(e4.segmentIdChainVec[i]));
+        }
+
+        //a mismatched storage configuration is rejected
+        StorageCatalogJournal journalOtherDisks(TEST_JOURNAL_PATH, TEST_MAX_SEGMENTS, TEST_NUM_DISKS + 1);
+        MemoryManagerTreeArray mmOther(TEST_MAX_SEGMENTS);
+        BOOST_REQUIRE(!journalOtherDisks.Load(mmOther, restored));
+    }
+
+    //a partially written record at the end of the journal is ignored
+    {
+        const uintmax_t journalSize = boost::filesystem::file_size(TEST_JOURNAL_PATH);
+        FILE * f = fopen(TEST_JOURNAL_PATH.string().c_str(), "ab");
+        BOOST_REQUIRE(f != NULL);
+        const uint8_t tornRecord[7] = { 40, 0, 0, 0, 1, 14, 0 };
+        BOOST_REQUIRE_EQUAL(fwrite(tornRecord, 1, sizeof(tornRecord), f), sizeof(tornRecord));
+        fclose(f);
+        BOOST_REQUIRE_EQUAL(boost::filesystem::file_size(TEST_JOURNAL_PATH), journalSize + sizeof(tornRecord));
+
+        StorageCatalogJournal journal(TEST_JOURNAL_PATH, TEST_MAX_SEGMENTS, TEST_NUM_DISKS);
+        MemoryManagerTreeArray mmRestored(TEST_MAX_SEGMENTS);
+        std::vector<catalog_journal_restored_bundle_t> restored;
+        BOOST_REQUIRE(journal.Load(mmRestored, restored));
+        BOOST_REQUIRE_EQUAL(restored.size(), 3);
+
+        //a new snapshot of the restored catalog starts the next generation with an empty journal
+        std::vector<std::pair<uint64_t, const catalog_entry_t*> > entries;
+        for (std::size_t i = 0; i < restored.size(); ++i) {
+            if (restored[i].custodyId == 13) {
+                restored[i].catalogEntry.ptrUuidKeyInMap = &uuid3; //normally set when cataloged
+            }
+            entries.emplace_back(restored[i].custodyId, &restored[i].catalogEntry);
+        }
+        memmanager_t backup;
+        mmRestored.BackupDataToVector(backup);
+        BOOST_REQUIRE(journal.WriteSnapshot(backup, entries));
+        BOOST_REQUIRE_EQUAL(journal.GetGeneration(), 2);
+        BOOST_REQUIRE_EQUAL(journal.GetNumRecordsSinceSnapshot(), 0);
+        BOOST_REQUIRE(journal.LogRemove(12));
+    }
+    {
+        StorageCatalogJournal journal(TEST_JOURNAL_PATH, TEST_MAX_SEGMENTS, TEST_NUM_DISKS);
+        MemoryManagerTreeArray mmRestored(TEST_MAX_SEGMENTS);
+        std::vector<catalog_journal_restored_bundle_t> restored;
+        BOOST_REQUIRE(journal.Load(mmRestored, restored));
+        BOOST_REQUIRE_EQUAL(restored.size(), 2);
+        BOOST_REQUIRE_EQUAL(restored[0].custodyId, 13);
+        BOOST_REQUIRE_EQUAL(restored[1].custodyId, 14);
+        BOOST_REQUIRE_EQUAL(mmRestored.GetNumAllocatedSegments_NotThreadSafe(), 2 + 4);
+
+        journal.DeleteFiles();
+        BOOST_REQUIRE(!boost::filesystem::exists(journal.GetJournalFilePath()));
+        BOOST_REQUIRE(!boost::filesystem::exists(journal.GetSnapshotFilePath()));
+        BOOST_REQUIRE(!journal.Load(mmRestored, restored));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(StorageCatalogJournalStaleJournalTestCase)
+{
+    MemoryManagerTreeArray mm(TEST_MAX_SEGMENTS);
+    const catalog_entry_t e1 = MakeEntry(mm, 2, 101, NULL);
+    const catalog_entry_t e2 = MakeEntry(mm, 1, 102, NULL);
+    memmanager_t backupWithE1;
+    {
+        MemoryManagerTreeArray mmSnapshot(TEST_MAX_SEGMENTS);
+        for (std::size_t i = 0; i < e1.segmentIdChainVec.size(); ++i) {
+            BOOST_REQUIRE(mmSnapshot.AllocateSegmentId_NotThreadSafe(e1.segmentIdChainVec[i]));
+        }
+        mmSnapshot.BackupDataToVector(backupWithE1);
+    }
+    std::vector<std::pair<uint64_t, const catalog_entry_t*> > entries;
+    entries.emplace_back(1, &e1);
+    const boost::filesystem::path snapshotPath = boost::filesystem::path(TEST_JOURNAL_PATH).concat(".snapshot");
+    const boost::filesystem::path savedJournalPath = boost::filesystem::path(TEST_JOURNAL_PATH).concat(".saved");
+
+    {
+        StorageCatalogJournal journal(TEST_JOURNAL_PATH, TEST_MAX_SEGMENTS, TEST_NUM_DISKS);
+        journal.DeleteFiles();
+        BOOST_REQUIRE(journal.WriteSnapshot(backupWithE1, entries));
+        BOOST_REQUIRE(journal.LogStore(2, e2));
+        //keep a copy of the generation 1 journal
+        CopyTestFile(TEST_JOURNAL_PATH, savedJournalPath);
+        //snapshot again (generation 2) without e2
+        BOOST_REQUIRE(journal.WriteSnapshot(backupWithE1, entries));
+        BOOST_REQUIRE_EQUAL(journal.GetGeneration(), 2);
+    }
+
+    //simulate a crash after the generation 2 snapshot was written but before its journal was created:
+    //the generation 1 journal record storing e2 must not be replayed onto the generation 2 snapshot
+    CopyTestFile(savedJournalPath, TEST_JOURNAL_PATH);
+    {
+        StorageCatalogJournal journal(TEST_JOURNAL_PATH, TEST_MAX_SEGMENTS, TEST_NUM_DISKS);
+        BOOST_REQUIRE_EQUAL(journal.GetGeneration(), 2);
+        MemoryManagerTreeArray mmRestored(TEST_MAX_SEGMENTS);
+        std::vector<catalog_journal_restored_bundle_t> restored;
+        BOOST_REQUIRE(journal.Load(mmRestored, restored));
+        BOOST_REQUIRE_EQUAL(restored.size(), 1);
+        BOOST_REQUIRE_EQUAL(restored[0].custodyId, 1);
+        BOOST_REQUIRE_EQUAL(mmRestored.GetNumAllocatedSegments_NotThreadSafe(), 2);
+    }
+
+    //a journal newer than the snapshot means the snapshot it follows is missing
+    {
+        StorageCatalogJournal journal(TEST_JOURNAL_PATH, TEST_MAX_SEGMENTS, TEST_NUM_DISKS);
+        BOOST_REQUIRE(journal.WriteSnapshot(backupWithE1, entries)); //generation 3
+        CopyTestFile(TEST_JOURNAL_PATH, savedJournalPath);
+        BOOST_REQUIRE(journal.WriteSnapshot(backupWithE1, entries)); //generation 4
+    }
+    CopyTestFile(savedJournalPath, snapshotPath); //not a snapshot
+    {
+        StorageCatalogJournal journal(TEST_JOURNAL_PATH, TEST_MAX_SEGMENTS, TEST_NUM_DISKS);
+        BOOST_REQUIRE_EQUAL(journal.GetGeneration(), 4);
+        MemoryManagerTreeArray mmRestored(TEST_MAX_SEGMENTS);
+        std::vector<catalog_journal_restored_bundle_t> restored;
+        BOOST_REQUIRE(!journal.Load(mmRestored, restored));
+        journal.DeleteFiles();
+    }
+    boost::filesystem::remove(savedJournalPath);
+}
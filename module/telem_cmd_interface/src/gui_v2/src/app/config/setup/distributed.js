@@ -144,5 +144,29 @@ export const distributedConfigFields = [
         dataType: "number", 
         inputType: InputTypes.TextField,
         required: true
+    },
+    {
+        name: "sharedMemoryBundleTransport",
+        label: "Shared Memory Bundle Transport (modules on one host)",
+        default: false,
+        dataType: "boolean",
+        inputType: InputTypes.Switch,
+        required: false
+    },
+    {
+        name: "sharedMemoryNumSlots",
+        label: "Shared Memory Number Of Slots",
+        default: 128,
+        dataType: "number",
+        inputType: InputTypes.TextField,
+        required: false
+    },
+    {
+        name: "sharedMemorySlotSizeBytes",
+        label: "Shared Memory Slot Size Bytes",
+        default: 1048576,
+        dataType: "number",
+        inputType: InputTypes.TextField,
+        required: false
     }
 ]
\ No newline at end of file
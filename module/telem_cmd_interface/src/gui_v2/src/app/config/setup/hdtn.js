@@ -38,6 +38,21 @@ export const convergenceLayerOptions = [
     }
 ]
 
+export const egressSchedulerOptions = [
+    {
+        label: "FIFO",
+        value: "fifo"
+    },
+    {
+        label: "Strict Priority",
+        value: "priority"
+    },
+    {
+        label: "Deficit Round Robin",
+        value: "drr"
+    }
+]
+
 /*
     Induct Configurations
 */
@@ -123,6 +138,30 @@ export const outductVectorFields = [
         inputType: InputTypes.TextField, 
         required: true 
     },
+    {
+        name: "egressScheduler", 
+        label: "Egress Scheduler", 
+        default: "fifo", 
+        inputType: InputTypes.Select, 
+        required: false,
+        options: egressSchedulerOptions
+    },
+    {
+        name: "egressSchedulerQuantumBytes", 
+        label: "Egress Scheduler DRR Quantum (Bytes)", 
+        default: 1048576, 
+        dataType: "number", 
+        inputType: InputTypes.TextField, 
+        required: false 
+    },
+    {
+        name: "egressSchedulerMaxBundlesInOutduct", 
+        label: "Egress Scheduler Max Bundles In Outduct (0 = Half the Pipeline)", 
+        default: 0, 
+        dataType: "number", 
+        inputType: InputTypes.TextField, 
+        required: false 
+    },
     {
         name: "bpEncapLocalSocketOrPipePath", 
         label: "BP Encap Local Socket Or Pipe Path", 
@@ -171,6 +210,14 @@ export const storageDiskConfigVectorFields = [
         dataType: "string", 
         inputType: InputTypes.TextField, 
         required: true 
+    },
+    { 
+        name: "useDirectIo", 
+        label: "Use Direct I/O (Bypass Page Cache)", 
+        default: false, 
+        dataType: "boolean", 
+        inputType: InputTypes.Switch, 
+        required: false 
     }
 ]
 
@@ -189,6 +236,10 @@ export const storageConfigFields = [
             {
                 label: "STDIO Multithreaded",
                 value: "stdio_multi_threaded"
+            },
+            {
+                label: "IO_URING Multithreaded (Linux only)",
+                value: "io_uring_multi_threaded"
             }
         ]
     },
@@ -237,6 +288,30 @@ export const storageConfigFields = [
             },
         ]
     },
+    {
+        name: "catalogJournalFilePath", 
+        label: "Catalog Journal File Path (Empty To Disable)", 
+        default: "", 
+        dataType: "string", 
+        inputType: InputTypes.TextField, 
+        required: false 
+    },
+    {
+        name: "catalogSnapshotIntervalRecords", 
+        label: "Catalog Snapshot Interval (Journal Records)", 
+        default: 100000, 
+        dataType: "number", 
+        inputType: InputTypes.TextField, 
+        required: false 
+    },
+    {
+        name: "ramCacheCapacityBytes", 
+        label: "RAM Cache Capacity Bytes (0 To Disable, Custody Bundles Always Go To Disk)", 
+        default: 0, 
+        dataType: "number", 
+        inputType: InputTypes.TextField, 
+        required: false 
+    },
     {
         name: "storageDiskConfigVector",
         label: "Storage Disk Config Vectors",
@@ -371,6 +446,78 @@ export const hdtnConfigFields = [
         inputType: InputTypes.Switch, 
         required: true 
     },
+    { 
+        name: "numIngressWorkerThreads", 
+        label: "Ingress Worker Threads (0 To Process On Induct Threads)", 
+        default: 0, 
+        dataType: "number", 
+        inputType: InputTypes.TextField, 
+        required: false 
+    },
+    { 
+        name: "maxIngressBatchBundles", 
+        label: "Max Ingress Batch Bundles (0 To Disable Batching)", 
+        default: 0, 
+        dataType: "number", 
+        inputType: InputTypes.TextField, 
+        required: false 
+    },
+    { 
+        name: "ingressBatchLatencyMicroseconds", 
+        label: "Ingress Batch Latency (Microseconds)", 
+        default: 1000, 
+        dataType: "number", 
+        inputType: InputTypes.TextField, 
+        required: false 
+    },
+    { 
+        name: "egressWorkerThreadPerOutduct", 
+        label: "Egress Worker Thread Per Outduct", 
+        default: false, 
+        dataType: "boolean", 
+        inputType: InputTypes.Switch, 
+        required: false 
+    },
+    { 
+        name: "oneProcessDirectOutductForward", 
+        label: "One-Process Direct Outduct Forward (Non-Custody Bundles)", 
+        default: false, 
+        dataType: "boolean", 
+        inputType: InputTypes.Switch, 
+        required: false 
+    },
+    { 
+        name: "ingressAdmissionControl", 
+        label: "Ingress Admission Control (Early Drop Under Overload)", 
+        default: false, 
+        dataType: "boolean", 
+        inputType: InputTypes.Switch, 
+        required: false 
+    },
+    { 
+        name: "ingressAdmissionStorageFullPercent", 
+        label: "Ingress Admission Storage Full (Percent)", 
+        default: 90, 
+        dataType: "number", 
+        inputType: InputTypes.TextField, 
+        required: false 
+    },
+    { 
+        name: "ingressAdmissionMaxBundlesPerSecondPerSource", 
+        label: "Ingress Admission Max Bundles Per Second Per Source (0 For No Limit)", 
+        default: 0, 
+        dataType: "number", 
+        inputType: InputTypes.TextField, 
+        required: false 
+    },
+    { 
+        name: "routerMaxMultipathRoutes", 
+        label: "Router Max Multipath Routes (0 For One Next Hop)", 
+        default: 0, 
+        dataType: "number", 
+        inputType: InputTypes.TextField, 
+        required: false 
+    },
     { 
         name: "maxLtpReceiveUdpPacketSizeBytes", 
         label: "Max LTP Receive UDP Packet Size (Bytes)", 